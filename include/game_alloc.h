@@ -0,0 +1,159 @@
+#ifndef GAME_ALLOC_H
+#define GAME_ALLOC_H
+
+// 記憶體配置的統計 (選用)：依子系統 (模擬、繪製、音效、介面) 與遊戲階段 (主選單、倒數、遊戲中、結束畫面)
+// 計算配置次數、位元組數與存活的物件，並標記發生在模擬移動之中的配置，用來維持零配置的遊戲迴圈。
+// 子系統是執行緒區域的範圍 (game_alloc_enter / game_alloc_leave)，階段是整個程式共用的狀態。
+// 配置的來源：
+//   Windows 除錯版 C 執行階段：_CrtSetAllocHook 攔截所有經過 CRT 的配置 (包含 GLib 與 GStreamer)；
+//     攔截函式無法標記配置，釋放以釋放當下的範圍計算，存活數只列出合計。
+//   Linux (glibc)：以 -DGAME_ALLOC_INTERPOSE 建置時替換 malloc / calloc / realloc / free 與 memalign 系列；
+//     每個配置的標頭記錄配置時的子系統，釋放計回同一個子系統，存活數依子系統列出。
+//   其他情況可由程式自行呼叫 game_alloc_record / game_alloc_record_free。
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 結構定義 ]========================
+// 子系統
+typedef enum {
+    ALLOC_SUB_OTHER = 0,      // 未設定範圍的執行緒 (背景執行緒等)
+    ALLOC_SUB_SIM,            // 模擬：移動定時器、電腦玩家與網路同步
+    ALLOC_SUB_RENDER,         // 繪製
+    ALLOC_SUB_AUDIO,          // 音效管線 (含 GStreamer 的串流執行緒)
+    ALLOC_SUB_UI,             // 介面：事件處理、按鈕與對話框
+    ALLOC_SUB_COUNT
+} GameAllocSubsystem;
+
+// 遊戲階段
+typedef enum {
+    ALLOC_PHASE_MENU = 0,     // 主選單與遊戲介紹
+    ALLOC_PHASE_COUNTDOWN,    // 倒數
+    ALLOC_PHASE_PLAYING,      // 遊戲中 (含暫停)
+    ALLOC_PHASE_GAME_OVER,    // 結束畫面
+    ALLOC_PHASE_COUNT
+} GameAllocPhase;
+
+// 一組計數
+typedef struct {
+    uint64_t allocs;          // 配置次數 (realloc 計為一次釋放與一次配置)
+    uint64_t frees;           // 釋放次數
+    uint64_t bytes;           // 配置的位元組數
+    uint64_t freed_bytes;     // 釋放的位元組數
+} GameAllocCounts;
+
+// 統計的快照
+typedef struct {
+    GameAllocCounts counts[ALLOC_SUB_COUNT][ALLOC_PHASE_COUNT];
+    uint64_t tick_allocs[ALLOC_SUB_COUNT];  // 模擬移動之中的配置次數 (依子系統)
+    uint64_t tick_bytes;                    // 模擬移動之中配置的位元組數
+    uint64_t ticks;                         // 模擬移動的次數
+    uint64_t dirty_ticks;                   // 有配置的模擬移動次數
+    bool tagged;                            // 釋放是否計入配置時的子系統 (否則為釋放當下的子系統)
+} GameAllocSnapshot;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 開始記錄配置 (安裝這個建置可用的攔截方式)。
+ *
+ * @return 有可用的攔截方式時返回true；否則只記錄 game_alloc_record 的呼叫。
+ */
+bool game_alloc_start(void);
+
+/**
+ * @brief 停止記錄配置 (已累計的統計保留)。
+ */
+void game_alloc_stop(void);
+
+/**
+ * @brief 是否正在記錄。
+ *
+ * @return 正在記錄時返回true。
+ */
+bool game_alloc_enabled(void);
+
+/**
+ * @brief 進入子系統的範圍 (目前執行緒)。
+ *
+ * @param subsystem 子系統。
+ * @return 原本的子系統，交給 game_alloc_leave 恢復。
+ */
+GameAllocSubsystem game_alloc_enter(GameAllocSubsystem subsystem);
+
+/**
+ * @brief 離開子系統的範圍，恢復原本的子系統。
+ *
+ * @param previous game_alloc_enter 返回的子系統。
+ */
+void game_alloc_leave(GameAllocSubsystem previous);
+
+/**
+ * @brief 設定目前的遊戲階段。
+ *
+ * @param phase 遊戲階段。
+ */
+void game_alloc_set_phase(GameAllocPhase phase);
+
+/**
+ * @brief 開始一次模擬移動 (目前執行緒)，之後的配置都會被標記。
+ */
+void game_alloc_tick_begin(void);
+
+/**
+ * @brief 結束一次模擬移動。
+ *
+ * @return 這次移動之中的配置次數。
+ */
+uint64_t game_alloc_tick_end(void);
+
+/**
+ * @brief 記錄一次配置 (攔截函式或程式自行呼叫)。
+ *
+ * @param bytes 位元組數。
+ */
+void game_alloc_record(size_t bytes);
+
+/**
+ * @brief 記錄一次釋放。
+ *
+ * @param bytes 位元組數 (不明時為0)。
+ */
+void game_alloc_record_free(size_t bytes);
+
+/**
+ * @brief 讀取目前的統計 (其他執行緒可以同時記錄)。
+ *
+ * @param snapshot 輸出。
+ */
+void game_alloc_read(GameAllocSnapshot* snapshot);
+
+/**
+ * @brief 取得子系統的名稱。
+ *
+ * @param subsystem 子系統。
+ * @return 名稱。
+ */
+const char* game_alloc_subsystem_name(GameAllocSubsystem subsystem);
+
+/**
+ * @brief 取得遊戲階段的名稱。
+ *
+ * @param phase 遊戲階段。
+ * @return 名稱。
+ */
+const char* game_alloc_phase_name(GameAllocPhase phase);
+
+/**
+ * @brief 輸出統計表：每個子系統與階段的配置、釋放與位元組數，各子系統的存活物件，以及模擬移動之中的配置。
+ *
+ * @param snapshot 快照。
+ * @param out 輸出。
+ */
+void game_alloc_write(const GameAllocSnapshot* snapshot, FILE* out);
+
+#endif // GAME_ALLOC_H
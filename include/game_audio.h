@@ -0,0 +1,36 @@
+#ifndef GAME_AUDIO_H
+#define GAME_AUDIO_H
+
+// 音效管線的建立：只依賴 GStreamer，不使用 GTK。
+// 內嵌的音效資料經由 appsrc 交給解碼器 (不經過檔案系統)，最後輸出到呼叫端提供的 sink；
+// 介面層以 autoaudiosink 播放，無介面的效能測試以 fakesink 量測同一份程式碼。
+
+#include <gst/gst.h>
+
+//========================[ 結構定義 ]========================
+// 一個播放中的音效
+typedef struct {
+    GstElement* pipeline; // GStreamer的pipeline元素
+    gboolean loop;        // 是否循環播放
+    GBytes* bytes;        // 音效資料 (指向內嵌資源，不複製)
+    gsize   offset;       // appsrc 下一次推送的位元組位置
+} GameSound;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立音效管線 appsrc → decodebin → audioconvert → audioresample → volume → sink。
+ *
+ * 管線建立後尚未開始播放，呼叫端設定 Bus 的處理後再切換到 PLAYING。
+ * appsrc 的回調直接引用 sound，sound 必須存活到管線釋放為止。
+ *
+ * @param sound 音效：呼叫端設定 bytes 與 loop，成功時設定 pipeline 並把 offset 歸零。
+ * @param volume_level 音量大小，範圍通常為0.0到1.0。
+ * @param sink 輸出元件 (取得擁有權，失敗時一併釋放；NULL 視為建立失敗)。
+ * @return 成功時返回TRUE。
+ */
+gboolean game_audio_pipeline_new(GameSound* sound, float volume_level, GstElement* sink);
+
+#endif // GAME_AUDIO_H
@@ -0,0 +1,122 @@
+#ifndef GAME_BATCH_H
+#define GAME_BATCH_H
+
+// 批次模擬：同時推進大量彼此獨立的單人遊戲，用於調整速度、障礙物與計分。
+// 每局的蛇頭、方向、長度、食物等以「陣列結構」(structure of arrays) 存放，
+// 移動與邊界循環的計算在所有遊戲間以同一個迴圈完成，編譯器可以向量化。
+// 碰撞改用每局一張的佔用網格查表，規則與 game_step_player 相同：
+// 以相同種子開局、輸入相同方向時，每一局的結果都與 GameState 版本一致。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+// 佔用網格的內容
+#define BATCH_CELL_EMPTY 0
+#define BATCH_CELL_SNAKE 1
+#define BATCH_CELL_WALL  2
+
+//========================[ 結構定義 ]========================
+// 一批遊戲的狀態 (所有陣列都來自同一個記憶體區塊)
+typedef struct {
+    GameArena arena;          // 所有陣列的來源
+    GameState scratch;        // 開局用的暫存狀態 (以 game_new_single 產生初始局面)
+    int count;                // 遊戲數
+    int width, height;        // 網格尺寸
+    int cells;                // 每局的格子總數
+    bool slow_on_eat;         // 吃到果實是否降低速度
+
+    // 每局一個元素的陣列
+    int32_t*  head_x;         // 蛇頭X座標
+    int32_t*  head_y;         // 蛇頭Y座標
+    uint8_t*  direction;      // 目前的移動方向
+    uint8_t*  next_direction; // 下一步的移動方向
+    uint8_t*  alive;          // 是否存活 (1/0)
+    int32_t*  length;         // 蛇身節點數
+    int32_t*  ring_head;      // 蛇頭在環狀緩衝區中的索引
+    int32_t*  open_cells;     // 不是牆的格子數 (蛇填滿時結束該局)
+    int32_t*  food_x;         // 食物X座標
+    int32_t*  food_y;         // 食物Y座標
+    int32_t*  score;          // 分數
+    int32_t*  interval;       // 移動間隔 (毫秒)
+    int32_t*  elapsed_ms;     // 已經過的遊戲時間 (毫秒)，死亡後不再增加
+    uint64_t* rng_state;      // 亂數狀態
+
+    // 每局 cells 個元素的陣列
+    int32_t*  body;           // 蛇身環狀緩衝區 (格子索引 y * width + x)
+    uint8_t*  grid;           // 佔用網格
+
+    int alive_count;          // 存活的遊戲數
+    uint64_t ticks;           // 累計移動步數 (所有遊戲合計)
+} GameBatch;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立批次模擬的函式。
+ *
+ * 一次配置所有遊戲需要的記憶體，之後重新開局不再配置。
+ *
+ * @param batch 批次狀態。
+ * @param count 遊戲數。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_batch_init(GameBatch* batch, int count, int width, int height);
+
+/**
+ * @brief 釋放批次模擬的函式。
+ *
+ * @param batch 批次狀態。
+ */
+void game_batch_free(GameBatch* batch);
+
+/**
+ * @brief 重新開始所有遊戲的函式。
+ *
+ * 第i局以種子 seed + i 開局，與 game_seed + game_new_single 的局面相同。
+ *
+ * @param batch 批次狀態。
+ * @param seed 第一局的亂數種子。
+ */
+void game_batch_reset(GameBatch* batch, uint64_t seed);
+
+/**
+ * @brief 改變指定遊戲下一步方向的函式。
+ *
+ * 規則與 game_turn 相同，不允許直接改為與下一步方向相反的方向。
+ *
+ * @param batch 批次狀態。
+ * @param g 遊戲索引。
+ * @param dir 新的方向。
+ */
+void game_batch_turn(GameBatch* batch, int g, Direction dir);
+
+/**
+ * @brief 讓所有存活的遊戲移動一步的函式。
+ *
+ * @param batch 批次狀態。
+ * @return 移動後仍存活的遊戲數。
+ */
+int game_batch_step(GameBatch* batch);
+
+/**
+ * @brief 檢查指定遊戲的格子是否被蛇或牆佔用的函式。
+ *
+ * @param batch 批次狀態。
+ * @param g 遊戲索引。
+ * @param x X座標 (須在網格內)。
+ * @param y Y座標 (須在網格內)。
+ * @return 被佔用時返回true。
+ */
+static inline bool game_batch_blocked(const GameBatch* batch, int g, int x, int y)
+{
+    return batch->grid[(size_t)g * batch->cells + (size_t)y * batch->width + x] != BATCH_CELL_EMPTY;
+}
+
+#endif // GAME_BATCH_H
@@ -0,0 +1,105 @@
+#ifndef GAME_BOT_H
+#define GAME_BOT_H
+
+// 電腦玩家與無介面對戰：電腦玩家在自己的每一步之前決定方向，
+// game_play_match 依兩位玩家各自的移動間隔排程，使用與雙人模式相同的規則與勝負判定。
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 結構定義 ]========================
+typedef struct GameBot GameBot;
+
+// 決定下一步方向的函式
+typedef Direction (*GameBotFn)(const GameState* game, int player, GameBot* bot);
+
+// 電腦玩家
+struct GameBot {
+    const char* name;     // 名稱
+    GameBotFn decide;     // 決定方向的函式
+    uint64_t rng_state;   // 電腦玩家自己的亂數狀態 (不影響遊戲的亂數)
+    long budget_work;     // 每一步思考的工作量上限 (距離場的格子數或搜尋的模擬次數，0 表示使用預設值)
+    long budget_us;       // 每一步思考的時間上限 (微秒，0 表示不限制)
+    void* data;           // 電腦玩家的私有資料 (由 game_bot_free 釋放)
+};
+
+// 一場對戰的結果
+typedef struct {
+    int  winner;                  // 贏家標識 (1: 玩家1, 2: 玩家2, 0: 平局)
+    int  score[MAX_PLAYERS];      // 分數
+    long survival_ms[MAX_PLAYERS]; // 存活時間 (毫秒)
+    long duration_ms;             // 對戰的遊戲時間 (毫秒)
+    long steps;                   // 兩位玩家的總步數
+} GameMatchResult;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立內建電腦玩家的函式。
+ *
+ * 可用的名稱：random (隨機但避開碰撞)、straight (直走，快撞到時才轉向)、
+ * greedy (朝食物前進並避開碰撞)、autopilot (沿距離場的最短路徑前往食物)、
+ * mcts (蒙地卡羅樹搜尋，budget_work 為每步的模擬次數)。
+ *
+ * @param bot 要初始化的電腦玩家。
+ * @param name 名稱。
+ * @return 名稱有效時返回true。
+ */
+bool game_bot_init(GameBot* bot, const char* name);
+
+/**
+ * @brief 釋放電腦玩家私有資料的函式。
+ *
+ * @param bot 電腦玩家。
+ */
+void game_bot_free(GameBot* bot);
+
+/**
+ * @brief 通知電腦玩家開始新的一局的函式。
+ *
+ * 新的一局、讀檔或開始接手控制時呼叫，丟棄上一局留下的狀態。
+ *
+ * @param bot 電腦玩家。
+ */
+void game_bot_reset(GameBot* bot);
+
+/**
+ * @brief 預先配置電腦玩家在這個局面需要的記憶體的函式。
+ *
+ * 距離場、搜尋器與障礙物的牆層原本在第一次決定方向時才配置；
+ * 在開局或開始接手控制時 (移動之外) 呼叫，之後的每一步都不需要配置記憶體。
+ *
+ * @param bot 電腦玩家。
+ * @param game 遊戲狀態。
+ * @return 成功返回true；配置失敗時返回false (決定方向時仍會改用貪婪策略)。
+ */
+bool game_bot_prepare(GameBot* bot, const GameState* game);
+
+/**
+ * @brief 進行一場無介面雙人對戰的函式。
+ *
+ * 以 seed 開始新的雙人遊戲，直到兩位玩家都死亡或遊戲時間超過 max_ms，
+ * 再以 game_decide_winner 判定勝負 (時間到時仍存活的玩家以目前的遊戲時間計算存活時間)。
+ *
+ * @param game 遊戲狀態 (重複使用其記憶體區塊)。
+ * @param seed 本場的亂數種子。
+ * @param bots 兩位電腦玩家。
+ * @param max_ms 遊戲時間上限 (毫秒)。
+ * @return 對戰結果。
+ */
+GameMatchResult game_play_match(GameState* game, uint64_t seed, GameBot* bots[MAX_PLAYERS], long max_ms);
+
+/**
+ * @brief 檢查玩家往指定方向前進是否安全的函式。
+ *
+ * @param game 遊戲狀態。
+ * @param player 玩家索引。
+ * @param dir 方向。
+ * @return 不會碰撞時返回true。
+ */
+bool game_bot_safe(const GameState* game, int player, Direction dir);
+
+#endif // GAME_BOT_H
@@ -0,0 +1,469 @@
+#ifndef GAME_CORE_H
+#define GAME_CORE_H
+
+// 遊戲規則核心：不依賴 GTK / GStreamer，只使用標準 C。
+// 每一局遊戲的所有記憶體 (蛇身、障礙物以及介面層的暫存資料) 都來自
+// GameState 擁有的 GameArena，結束或重新開始一局時只需重置一次。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 常數 ]========================
+// 定義遊戲格子的寬度與高度
+#define GRID_WIDTH   40
+#define GRID_HEIGHT  20
+// 定義蛇移動的最大時間間隔 (毫秒)
+#define MAX_INTERVAL 250 // 最大移動間隔 (毫秒)
+// 蛇移動的初始時間間隔 (毫秒)
+#define START_INTERVAL 100
+// 障礙物的分區數量與每區數量
+#define OBSTACLE_ZONES    4
+#define OBSTACLES_PER_ZONE 2
+#define MAX_OBSTACLES (OBSTACLE_ZONES * OBSTACLES_PER_ZONE)
+// 最多玩家數
+#define MAX_PLAYERS 2
+// 保留給介面層 (例如閃爍效果) 的每局記憶體 (位元組)
+#define GAME_ARENA_SHELL_BYTES 1024
+
+//========================[ 結構定義 ]========================
+// 定義障礙物的結構，包括位置和尺寸
+typedef struct {
+    int x, y;
+    int width, height;
+} Obstacle;
+
+// 定義點的結構，用於表示蛇的節點和食物的位置
+typedef struct {
+    int x, y;
+} Point;
+
+// 蛇的移動方向
+typedef enum {
+    DIR_UP = 0,
+    DIR_DOWN,
+    DIR_LEFT,
+    DIR_RIGHT
+} Direction;
+
+// Zobrist 雜湊的項目種類
+typedef enum {
+    GAME_HASH_GAME = 1,    // 網格尺寸、玩家數與規則
+    GAME_HASH_OBSTACLE,    // 障礙物
+    GAME_HASH_BODY,        // 蛇身的格子 (每位玩家各自的鍵)
+    GAME_HASH_HEAD,        // 蛇頭的格子
+    GAME_HASH_PLAYER,      // 方向、下一步方向、存活、移動間隔與分數
+    GAME_HASH_ELAPSED,     // 已經過的遊戲時間
+    GAME_HASH_FOOD,        // 食物的格子
+    GAME_HASH_RNG          // 亂數狀態
+} GameHashKind;
+
+// 單步更新的結果
+typedef enum {
+    GAME_EVENT_NONE = 0,   // 正常移動
+    GAME_EVENT_ATE,        // 吃到果實
+    GAME_EVENT_DIED        // 發生碰撞而死亡
+} GameEvent;
+
+// 碰撞的原因 (網格上下左右相連，沒有邊牆，障礙物就是牆)
+typedef enum {
+    GAME_COLLISION_NONE = 0,   // 沒有碰撞
+    GAME_COLLISION_SELF,       // 撞到自己
+    GAME_COLLISION_OBSTACLE,   // 撞到障礙物
+    GAME_COLLISION_OTHER       // 撞到另一條蛇
+} GameCollision;
+
+// 每局遊戲的記憶體區塊：以指標遞增配置，重置時整塊一次釋放
+typedef struct {
+    unsigned char* base;        // 區塊起始位址
+    size_t capacity;            // 區塊大小 (位元組)
+    size_t used;                // 本局已使用的位元組
+    size_t high_water;          // 歷來使用量的最高值
+    unsigned long allocs;       // 本局的配置次數
+    unsigned long total_allocs; // 累計的配置次數
+    unsigned long resets;       // 重置次數
+    unsigned long failures;     // 空間不足而失敗的次數
+} GameArena;
+
+// 蛇身：環狀緩衝區，索引 head 為蛇頭，依序往後為身體
+typedef struct {
+    Point* cells;  // 節點陣列 (來自 GameArena)
+    int capacity;  // 最多節點數 (等於格子總數)
+    int head;      // 蛇頭所在的索引
+    int length;    // 目前的節點數
+} SnakeBody;
+
+// 玩家狀態
+typedef struct {
+    SnakeBody body;           // 蛇身
+    Direction direction;      // 目前的移動方向
+    Direction next_direction; // 下一步的移動方向 (玩家輸入)
+    int  score;               // 分數
+    int  interval;            // 移動間隔 (毫秒)
+    bool alive;               // 是否存活
+    long elapsed_ms;          // 已經過的遊戲時間 (毫秒)
+    long survival_ms;         // 死亡時的存活時間 (遊戲時間的毫秒，顯示與比較時以 game_survival_seconds 換成秒)
+    GameCollision death_cause; // 死亡的原因 (存活時為 GAME_COLLISION_NONE)
+} Player;
+
+// 一局遊戲的完整狀態
+typedef struct {
+    GameArena arena;          // 本局所有記憶體的來源
+    int width, height;        // 網格尺寸
+    int player_count;         // 玩家數 (1: 單人模式, 2: 雙人模式)
+    bool slow_on_eat;         // 吃到果實是否降低速度 (雙人模式)
+    Player players[MAX_PLAYERS];
+    Obstacle* obstacles;      // 障礙物陣列 (來自 GameArena)
+    int obstacle_count;       // 障礙物數量
+    Point food;               // 食物的位置
+    int winner;               // 贏家標識 (1: 玩家1, 2: 玩家2, 0: 平局)
+    uint64_t rng_state;       // 本局的亂數狀態 (障礙物、方向、食物皆由此產生)
+    uint64_t body_hash;       // 蛇身格子與障礙物的 Zobrist 雜湊 (加入蛇頭、移除蛇尾時增量更新)
+    long food_spawns;         // 本局生成食物的次數 (統計，不影響規則)
+    long food_retries;        // 本局生成食物時落在蛇身或障礙物上而重抽的次數 (統計)
+} GameState;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/* 記憶體區塊 */
+
+/**
+ * @brief 建立記憶體區塊的函式。
+ *
+ * @param arena 要初始化的記憶體區塊。
+ * @param capacity 區塊大小 (位元組)。
+ * @return 配置成功返回true；否則返回false。
+ */
+bool game_arena_init(GameArena* arena, size_t capacity);
+
+/**
+ * @brief 釋放記憶體區塊的函式。
+ *
+ * @param arena 要釋放的記憶體區塊。
+ */
+void game_arena_free(GameArena* arena);
+
+/**
+ * @brief 從記憶體區塊配置空間的函式。
+ *
+ * 以16位元組對齊，不會呼叫malloc。
+ *
+ * @param arena 記憶體區塊。
+ * @param size 需要的位元組數。
+ * @return 配置到的位址；空間不足時返回NULL。
+ */
+void* game_arena_alloc(GameArena* arena, size_t size);
+
+/**
+ * @brief 重置記憶體區塊的函式。
+ *
+ * 一次釋放本局所有配置，時間複雜度為O(1)。
+ *
+ * @param arena 記憶體區塊。
+ */
+void game_arena_reset(GameArena* arena);
+
+
+/* 遊戲狀態 */
+
+/**
+ * @brief 初始化遊戲狀態的函式。
+ *
+ * 依網格尺寸一次配置好整局需要的記憶體區塊，之後每局只重置不再配置。
+ *
+ * @param game 遊戲狀態。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_state_init(GameState* game, int width, int height);
+
+/**
+ * @brief 釋放遊戲狀態的函式。
+ *
+ * @param game 遊戲狀態。
+ */
+void game_state_free(GameState* game);
+
+/**
+ * @brief 改變網格尺寸的函式。
+ *
+ * 尺寸不同時重新配置記憶體區塊 (會結束目前這一局)。
+ *
+ * @param game 遊戲狀態。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_state_resize(GameState* game, int width, int height);
+
+/**
+ * @brief 設定亂數種子的函式。
+ *
+ * 相同的種子與相同的輸入會產生完全相同的遊戲過程。
+ *
+ * @param game 遊戲狀態。
+ * @param seed 亂數種子。
+ */
+void game_seed(GameState* game, uint64_t seed);
+
+/**
+ * @brief 從遊戲的亂數狀態取得 [0, n) 範圍內整數的函式。
+ *
+ * @param game 遊戲狀態。
+ * @param n 範圍上限 (須大於0)。
+ * @return 亂數。
+ */
+int game_random(GameState* game, int n);
+
+/**
+ * @brief 結束目前這一局的函式。
+ *
+ * 重置記憶體區塊並清空蛇與障礙物，不會逐一釋放節點。
+ *
+ * @param game 遊戲狀態。
+ */
+void game_clear(GameState* game);
+
+/**
+ * @brief 開始空白的一局的函式。
+ *
+ * 重置記憶體區塊並配置蛇身與障礙物的空間，但不放置蛇、障礙物與食物。
+ *
+ * @param game 遊戲狀態。
+ * @param player_count 玩家數 (1 或 2)。
+ */
+void game_begin(GameState* game, int player_count);
+
+/**
+ * @brief 開始新的單人遊戲的函式。
+ *
+ * 設置蛇的初始位置與隨機方向，並生成障礙物和食物。
+ *
+ * @param game 遊戲狀態。
+ */
+void game_new_single(GameState* game);
+
+/**
+ * @brief 開始新的雙人遊戲的函式。
+ *
+ * 設置兩條蛇的初始位置與隨機方向，並生成障礙物和食物。
+ *
+ * @param game 遊戲狀態。
+ */
+void game_new_multi(GameState* game);
+
+
+/* 規則 */
+
+/**
+ * @brief 改變玩家下一步方向的函式。
+ *
+ * 不允許直接改為與下一步方向相反的方向。
+ *
+ * @param game 遊戲狀態。
+ * @param player 玩家索引 (0 或 1)。
+ * @param dir 新的方向。
+ */
+void game_turn(GameState* game, int player, Direction dir);
+
+/**
+ * @brief 讓指定玩家的蛇移動一步的函式。
+ *
+ * 計算新蛇頭 (含邊界循環)、檢查碰撞、處理食物的食用與蛇尾的移除。
+ *
+ * @param game 遊戲狀態。
+ * @param player 玩家索引 (0 或 1)。
+ * @return 本步發生的事件。
+ */
+GameEvent game_step_player(GameState* game, int player);
+
+/**
+ * @brief 檢查蛇頭是否發生碰撞的函式。
+ *
+ * 檢查蛇頭是否與自身、障礙物或其他存活的蛇重疊。
+ *
+ * @param game 遊戲狀態。
+ * @param player 玩家索引。
+ * @param head 新蛇頭的位置。
+ * @return 如果發生碰撞，返回true；否則返回false。
+ */
+bool game_check_collision(const GameState* game, int player, Point head);
+
+/**
+ * @brief 判定蛇頭碰撞的原因的函式。
+ *
+ * 與 game_check_collision 的判定相同，依自撞、障礙物、其他蛇的順序回報第一個成立的原因。
+ *
+ * @param game 遊戲狀態。
+ * @param player 玩家索引。
+ * @param head 新蛇頭的位置。
+ * @return 碰撞的原因；沒有碰撞時返回 GAME_COLLISION_NONE。
+ */
+GameCollision game_collision_cause(const GameState* game, int player, Point head);
+
+/**
+ * @brief 檢查位置是否在障礙物上的函式。
+ *
+ * @param game 遊戲狀態。
+ * @param p 要檢查的位置。
+ * @return 如果在障礙物上，返回true；否則返回false。
+ */
+bool game_hits_obstacle(const GameState* game, Point p);
+
+/**
+ * @brief 生成食物的函式。
+ *
+ * 隨機選擇一個不在存活的蛇或障礙物上的位置。
+ *
+ * @param game 遊戲狀態。
+ */
+void game_generate_food(GameState* game);
+
+/**
+ * @brief 分區生成障礙物的函式 (開局時呼叫，附加到目前的障礙物之後)。
+ *
+ * 地圖分成四區，每區嘗試放置固定數量的障礙物，不放在排除的位置附近。
+ *
+ * @param game 遊戲狀態。
+ * @param initial_positions 需要避開的位置 (蛇的初始位置)。
+ * @param initial_count 位置的數量。
+ */
+void game_generate_obstacles(GameState* game, const Point* initial_positions, int initial_count);
+
+/**
+ * @brief 判定雙人模式勝負的函式。
+ *
+ * 優先比較分數，分數相同時比較存活秒數，都相同則為平局。
+ *
+ * @param game 遊戲狀態。
+ * @return 贏家標識 (1: 玩家1, 2: 玩家2, 0: 平局)，同時存入game->winner。
+ */
+int game_decide_winner(GameState* game);
+
+/**
+ * @brief 取得遊戲狀態 64 位元雜湊的函式。
+ *
+ * 蛇身格子的部分隨每次移動增量更新，蛇頭、方向、分數、食物與亂數狀態等純量在此合併，
+ * 時間複雜度為O(1)。相同的局面 (含亂數狀態) 一定得到相同的雜湊，
+ * 可用於重播驗證、連線對戰的不同步檢查以及搜尋的置換表。
+ *
+ * @param game 遊戲狀態。
+ * @return 雜湊值。
+ */
+uint64_t game_hash(const GameState* game);
+
+/**
+ * @brief 重新計算蛇身與障礙物雜湊的函式。
+ *
+ * 直接修改蛇身或障礙物 (例如讀取快照) 之後呼叫，時間複雜度為O(蛇長)。
+ *
+ * @param game 遊戲狀態。
+ * @return 重新計算的 body_hash (同時存入 game->body_hash)。
+ */
+uint64_t game_rehash(GameState* game);
+
+/**
+ * @brief 取得下一個移動的玩家的函式。
+ *
+ * 依各玩家的遊戲時間加上移動間隔排序，時間相同時玩家1優先，與兩個定時器的觸發順序相同。
+ *
+ * @param game 遊戲狀態。
+ * @return 玩家索引；所有玩家都死亡時返回-1。
+ */
+int game_next_mover(const GameState* game);
+
+/**
+ * @brief 檢查是否所有玩家都已死亡的函式。
+ *
+ * @param game 遊戲狀態。
+ * @return 所有玩家都死亡時返回true。
+ */
+bool game_all_dead(const GameState* game);
+
+/**
+ * @brief 以 xorshift64* 取得 [0, n) 範圍內整數的函式。
+ *
+ * game_random 與批次模擬共用，相同的狀態產生相同的亂數序列。
+ *
+ * @param state 亂數狀態 (不可為0)。
+ * @param n 範圍上限 (須大於0)。
+ * @return 亂數。
+ */
+static inline int game_rng_next(uint64_t* state, int n)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    uint32_t r = (uint32_t)((x * 0x2545F4914F6CDD1Dull) >> 32);
+    return (int)(((uint64_t)r * (uint32_t)n) >> 32);
+}
+
+/**
+ * @brief 取得 Zobrist 雜湊項目的鍵的函式。
+ *
+ * 以 splitmix64 由項目種類、玩家與數值直接算出，不需要依網格尺寸建表，
+ * 遊戲狀態與精簡狀態 (GameSim) 共用，兩者的雜湊可以直接比較。
+ *
+ * @param kind 項目種類 (GameHashKind)。
+ * @param player 玩家索引 (與玩家無關的項目為0)。
+ * @param value 數值 (格子索引、打包的欄位等)。
+ * @return 鍵。
+ */
+static inline uint64_t game_hash_key(int kind, int player, uint64_t value)
+{
+    uint64_t z = value ^ ((uint64_t)(kind * MAX_PLAYERS + player + 1) * 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief 打包玩家純量欄位作為雜湊數值的函式。
+ *
+ * @param direction 目前的移動方向。
+ * @param next_direction 下一步的移動方向。
+ * @param alive 是否存活。
+ * @param interval 移動間隔。
+ * @param score 分數。
+ * @return 打包後的數值。
+ */
+static inline uint64_t game_hash_pack_player(int direction, int next_direction, bool alive, int interval, int score)
+{
+    return (uint64_t)direction | (uint64_t)next_direction << 2 | (uint64_t)alive << 4
+        | (uint64_t)(uint16_t)interval << 8 | (uint64_t)(uint32_t)score << 24;
+}
+
+/**
+ * @brief 取得蛇身第i個節點的函式 (0 為蛇頭)。
+ *
+ * @param body 蛇身。
+ * @param i 節點索引。
+ * @return 節點的位置。
+ */
+static inline Point snake_body_at(const SnakeBody* body, int i)
+{
+    int idx = body->head + i;
+    if (idx >= body->capacity) idx -= body->capacity;
+    return body->cells[idx];
+}
+
+/**
+ * @brief 把存活時間換成秒的函式 (結束畫面與勝負判定的單位)。
+ *
+ * 存活時間是遊戲時間：每一步累加移動間隔，不含倒數與暫停；舊版以 time(NULL) 計算牆上時鐘的秒數，
+ * 顯示與同分時的比較仍以整秒為單位 (捨去不足一秒的部分)。
+ *
+ * @param survival_ms 存活時間 (毫秒)。
+ * @return 存活秒數。
+ */
+static inline long game_survival_seconds(long survival_ms)
+{
+    return survival_ms / 1000;
+}
+
+#endif // GAME_CORE_H
@@ -0,0 +1,90 @@
+#ifndef GAME_DRAW_H
+#define GAME_DRAW_H
+
+// 遊戲畫面的繪製：只依賴 Cairo 與遊戲規則核心，不使用 GTK。
+// 介面層的 draw_game 與無介面的效能測試 (繪製到離屏影像) 呼叫同一份程式碼。
+
+#include <stdbool.h>
+#include <cairo.h>
+#include "game_core.h"
+#include "game_perf.h"
+#include "game_world.h"
+
+//========================[ 結構定義 ]========================
+// 顏色 (0~1)
+typedef struct {
+    double red, green, blue, alpha;
+} GameDrawColor;
+
+// 介面層的顯示狀態
+typedef struct {
+    bool hidden[MAX_PLAYERS]; // 死亡閃爍中目前隱藏的蛇
+    bool started;             // 倒數是否已結束
+    int countdown;            // 倒數值
+    bool show_go;             // 是否顯示「開始」字樣
+    const char* badge;        // 分數後附加的狀態文字 (可為NULL)
+} GameDrawInfo;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 繪製單人模式遊戲畫面的函式。
+ *
+ * 繪製單人模式下的遊戲元素，包括背景、食物、障礙物、蛇、分數和倒數計時。
+ *
+ * @param cr Cairo繪圖上下文。
+ * @param game 遊戲狀態。
+ * @param info 介面層的顯示狀態。
+ * @param width 畫布的寬度。
+ * @param height 畫布的高度。
+ * @param cell_size 每個格子的大小（像素）。
+ */
+void game_draw_single(cairo_t* cr, const GameState* game, const GameDrawInfo* info,
+    int width, int height, double cell_size);
+
+/**
+ * @brief 繪製雙人模式遊戲畫面的函式。
+ *
+ * 繪製雙人模式下的遊戲元素，包括背景、食物、障礙物、兩條蛇、分數和倒數計時。
+ *
+ * @param cr Cairo繪圖上下文。
+ * @param game 遊戲狀態。
+ * @param info 介面層的顯示狀態。
+ * @param width 畫布的寬度。
+ * @param height 畫布的高度。
+ * @param cell_size 每個格子的大小（像素）。
+ */
+void game_draw_multi(cairo_t* cr, const GameState* game, const GameDrawInfo* info,
+    int width, int height, double cell_size);
+
+/**
+ * @brief 繪製無盡模式遊戲畫面的函式。
+ *
+ * 只繪製與鏡頭視窗重疊的常駐區塊 (牆、未吃掉的食物與區塊邊界) 以及視窗內的蛇節點，
+ * 工作量與蛇移動的距離無關。
+ *
+ * @param cr Cairo繪圖上下文。
+ * @param world 世界狀態。
+ * @param info 介面層的顯示狀態。
+ * @param width 畫布的寬度。
+ * @param height 畫布的高度。
+ * @param cell_size 每個格子的大小（像素）。
+ */
+void game_draw_world(cairo_t* cr, const GameWorld* world, const GameDrawInfo* info,
+    int width, int height, double cell_size);
+
+/**
+ * @brief 在畫面右上角繪製效能疊加層。
+ *
+ * 以半透明底色顯示 game_perf_format 的文字，下方以長條圖顯示最近的畫面繪製時間。
+ *
+ * @param cr Cairo繪圖上下文。
+ * @param perf 疊加層的資料。
+ * @param width 畫布的寬度。
+ * @param budget_ms 長條圖的滿格 (毫秒)，超過的長條以紅色顯示。
+ */
+void game_draw_perf(cairo_t* cr, const GamePerf* perf, int width, double budget_ms);
+
+#endif // GAME_DRAW_H
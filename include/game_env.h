@@ -0,0 +1,129 @@
+#ifndef GAME_ENV_H
+#define GAME_ENV_H
+
+// 強化學習用的批次環境：一次 reset / step 一整批彼此獨立的遊戲，
+// 每局使用一個 GameState，規則、計時與勝負判定與單人 / 雙人模式完全相同。
+// 觀測值直接寫入呼叫端提供的位元壓縮平面 (每格 1 位元)，step 期間不配置任何記憶體。
+//
+// 一次 step 把遊戲時間推進到下一個移動時刻：在該時刻到期的玩家 (依玩家1、玩家2 的順序) 各移動一步。
+// 動作以 game_turn 套用，與鍵盤輸入相同：尚未輪到移動的玩家，方向在下一次移動時才生效。
+// 某局結束時自動以下一個種子重新開局，dones 標記結束的局，觀測值已是新一局的第一個畫面。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+// 觀測平面 (每位玩家各一組，以該玩家的視角)
+enum {
+    GAME_ENV_PLANE_WALL = 0,   // 障礙物
+    GAME_ENV_PLANE_OWN,        // 自己的蛇身 (含蛇頭)
+    GAME_ENV_PLANE_OTHER,      // 其他存活的蛇
+    GAME_ENV_PLANE_FOOD,       // 食物
+    GAME_ENV_PLANE_HEAD,       // 自己的蛇頭
+    GAME_ENV_PLANES
+};
+
+// 動作：0-3 為 Direction，GAME_ENV_NOOP 表示保持目前的方向
+#define GAME_ENV_NOOP 4
+
+// 一局的結束狀態 (dones)
+#define GAME_ENV_RUNNING   0   // 進行中
+#define GAME_ENV_TERMINAL  1   // 所有玩家都死亡
+#define GAME_ENV_TRUNCATED 2   // 遊戲時間超過 max_ms
+
+//========================[ 結構定義 ]========================
+// 一批環境
+typedef struct {
+    GameArena arena;          // 環境陣列的來源
+    GameState* games;         // 每個環境的遊戲狀態
+    int count;                // 環境數
+    int player_count;         // 每局的玩家數 (1: 單人模式, 2: 雙人模式)
+    int width, height;        // 網格尺寸
+    int plane_words;          // 每個平面的 64 位元字數 ((width * height + 63) / 64)
+    uint64_t* walls;          // 每個環境預先算好的障礙物平面
+    uint32_t* episode;        // 每個環境已開始的局數
+    uint64_t seed;            // 第一個環境第一局的種子
+
+    long max_ms;              // 每局的遊戲時間上限 (毫秒，0 表示不限制)
+    float reward_food;        // 吃到果實 (分數 +1) 的獎勵
+    float reward_death;       // 死亡的獎勵
+
+    uint64_t steps;           // 累計的 step 次數 (所有環境合計)
+    uint64_t episodes;        // 累計結束的局數
+} GameEnv;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立一批環境的函式。
+ *
+ * 一次配置所有環境需要的記憶體，之後 reset / step 不再配置。
+ *
+ * @param env 環境。
+ * @param count 環境數。
+ * @param player_count 每局的玩家數 (1 或 2)。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_env_init(GameEnv* env, int count, int player_count, int width, int height);
+
+/**
+ * @brief 釋放環境的函式。
+ *
+ * @param env 環境。
+ */
+void game_env_free(GameEnv* env);
+
+/**
+ * @brief 取得每位玩家觀測值大小的函式。
+ *
+ * 觀測緩衝區依 [環境][玩家][平面][字] 排列，總共需要 count * player_count 倍的字數。
+ *
+ * @param env 環境。
+ * @return 每位玩家的 64 位元字數 (GAME_ENV_PLANES * plane_words)。
+ */
+size_t game_env_obs_words(const GameEnv* env);
+
+/**
+ * @brief 重新開始所有環境的函式。
+ *
+ * 環境i的第k局以種子 seed + i + k * count 開局，與執行緒數和執行順序無關。
+ *
+ * @param env 環境。
+ * @param seed 種子。
+ * @param obs 觀測緩衝區 (可為NULL)。
+ */
+void game_env_reset(GameEnv* env, uint64_t seed, uint64_t* obs);
+
+/**
+ * @brief 讓所有環境前進一步的函式。
+ *
+ * @param env 環境。
+ * @param actions 每位玩家的動作 ([環境][玩家])。
+ * @param rewards 每位玩家本步的獎勵 ([環境][玩家])。
+ * @param dones 每個環境的結束狀態 (GAME_ENV_RUNNING / TERMINAL / TRUNCATED)。
+ * @param obs 觀測緩衝區 (可為NULL)。
+ */
+void game_env_step(GameEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones, uint64_t* obs);
+
+/**
+ * @brief 讀取觀測平面中一個格子的函式。
+ *
+ * @param plane 平面的起始位址。
+ * @param width 網格寬度。
+ * @param x X座標。
+ * @param y Y座標。
+ * @return 該格的位元為1時返回true。
+ */
+static inline bool game_env_bit(const uint64_t* plane, int width, int x, int y)
+{
+    int c = y * width + x;
+    return (plane[c >> 6] >> (c & 63)) & 1;
+}
+
+#endif // GAME_ENV_H
@@ -0,0 +1,36 @@
+#ifndef GAME_FILE_H
+#define GAME_FILE_H
+
+// 跨平台的檔案開啟，不依賴 GTK。
+// MSVC 在 /sdl 下把 fopen 視為錯誤 (C4996)，而且 fopen 只接受目前的字碼頁；
+// 遊戲的路徑都是 UTF-8 (glib)，所以 Windows 上轉成寬字元後以 _wfsopen 開啟。
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <share.h>
+#include <windows.h>
+#endif
+
+/**
+ * @brief 開啟檔案。
+ *
+ * @param path 檔案路徑 (UTF-8)。
+ * @param mode 與 fopen 相同的模式字串。
+ * @return 檔案，失敗時回傳 NULL。
+ */
+static inline FILE* game_fopen(const char* path, const char* mode)
+{
+#ifdef _WIN32
+    wchar_t wpath[MAX_PATH];
+    wchar_t wmode[8];
+    if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, MAX_PATH) == 0) return NULL;
+    if (MultiByteToWideChar(CP_UTF8, 0, mode, -1, wmode, 8) == 0) return NULL;
+    // _SH_DENYNO 與 fopen 相同，不鎖定檔案
+    return _wfsopen(wpath, wmode, _SH_DENYNO);
+#else
+    return fopen(path, mode);
+#endif
+}
+
+#endif // GAME_FILE_H
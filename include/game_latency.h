@@ -0,0 +1,186 @@
+#ifndef GAME_LATENCY_H
+#define GAME_LATENCY_H
+
+// 端到端的輸入延遲：從按鍵事件 (視窗系統的事件時間) 到轉向後的蛇頭第一次呈現在螢幕上。
+// 每個改變方向的按鍵依序經過四個時間點：
+//   事件時間 → 介面執行緒處理按鍵 → 套用轉向的移動 → 包含該次移動的畫面呈現
+// 分成三段 (排隊、等待移動、畫面) 與總延遲，依模式與玩家累計到直方圖 (微秒，與 game_metrics 相同的對數刻度)。
+// 只依賴遊戲規則核心，介面層與無介面的延遲測試呼叫同一份程式碼。
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+#include "game_metrics.h"
+
+//========================[ 常數 ]========================
+#define GAME_LATENCY_INFLIGHT 8               // 每位玩家同時在途 (已套用、尚未呈現) 的轉向數
+#define GAME_LATENCY_TIMEOUT_US 1000000       // 超過這個時間仍未套用的轉向視為遺失 (微秒)
+
+//========================[ 結構定義 ]========================
+// 模式
+typedef enum {
+    LATENCY_MODE_SINGLE = 0,  // 單人
+    LATENCY_MODE_MULTI,       // 本機雙人
+    LATENCY_MODE_NET,         // 網路雙人 (包含輸入延遲)
+    LATENCY_MODE_ENDLESS,     // 無盡模式 (蛇在 GameWorld 中)
+    LATENCY_MODE_COUNT
+} GameLatencyMode;
+
+// 延遲的區段
+typedef enum {
+    LATENCY_STAGE_QUEUE = 0,  // 事件時間到介面執行緒處理按鍵
+    LATENCY_STAGE_TICK,       // 處理按鍵到套用轉向的移動
+    LATENCY_STAGE_FRAME,      // 套用轉向到畫面呈現
+    LATENCY_STAGE_TOTAL,      // 事件時間到畫面呈現
+    LATENCY_STAGE_COUNT
+} GameLatencyStage;
+
+// 轉向的狀態
+typedef enum {
+    LATENCY_TURN_FREE = 0,    // 未使用
+    LATENCY_TURN_WAITING,     // 等待套用的移動
+    LATENCY_TURN_APPLIED,     // 已套用，等待下一次繪製
+    LATENCY_TURN_DRAWN        // 已繪製，等待畫面呈現
+} GameLatencyTurnState;
+
+// 一次轉向
+typedef struct {
+    GameLatencyTurnState state;
+    GameLatencyMode mode;
+    Direction dir;            // 轉向後的方向
+    int64_t key_us;           // 事件時間 (微秒，單調時鐘)
+    int64_t handled_us;       // 介面執行緒處理按鍵的時間
+    int64_t applied_us;       // 套用轉向的移動完成的時間
+    int64_t drawn_us;         // 繪製完成的時間
+    int64_t frame;            // 繪製所在的畫面編號
+} GameLatencyTurn;
+
+// 延遲的統計
+typedef struct {
+    GameLatencyTurn turns[MAX_PLAYERS][GAME_LATENCY_INFLIGHT];  // 在途的轉向 (每位玩家最多一個等待移動)
+    GameMetricsHistogram histograms[LATENCY_MODE_COUNT][MAX_PLAYERS][LATENCY_STAGE_COUNT];
+    long superseded;          // 套用前被下一個按鍵取代的轉向
+    long lost;                // 逾時或在途數已滿而放棄的轉向
+    long unstamped;           // 事件時間無法換算 (時鐘不同) 而以處理時間代替的按鍵
+    float last_total_ms;      // 最後一次完成的總延遲 (毫秒)
+} GameLatency;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 初始化空的延遲統計。
+ *
+ * @param latency 延遲統計。
+ */
+void game_latency_init(GameLatency* latency);
+
+/**
+ * @brief 放棄所有在途的轉向 (開新局或切換模式時呼叫)，已累計的直方圖保留。
+ *
+ * @param latency 延遲統計。
+ */
+void game_latency_clear_inflight(GameLatency* latency);
+
+/**
+ * @brief 把視窗系統的事件時間 (毫秒，32位元) 換算成單調時鐘。
+ *
+ * 事件時間與單調時鐘同為開機後的毫秒數 (Wayland、X11 與 Windows)；
+ * 差距為負或超過一秒時視為不同的時鐘，返回 now_us。
+ *
+ * @param event_ms 事件時間。
+ * @param now_us 目前的單調時鐘 (微秒)。
+ * @param ok 輸出：是否換算成功 (可為NULL)。
+ * @return 事件時間 (微秒，單調時鐘)。
+ */
+int64_t game_latency_event_time(uint32_t event_ms, int64_t now_us, bool* ok);
+
+/**
+ * @brief 記錄一個改變方向的按鍵。
+ *
+ * 同一位玩家尚未套用的轉向會被取代。
+ *
+ * @param latency 延遲統計。
+ * @param mode 模式。
+ * @param player 玩家。
+ * @param dir 轉向後的方向。
+ * @param key_us 事件時間 (微秒)。
+ * @param handled_us 處理按鍵的時間 (微秒)。
+ */
+void game_latency_key(GameLatency* latency, GameLatencyMode mode, int player, Direction dir,
+    int64_t key_us, int64_t handled_us);
+
+/**
+ * @brief 在一位玩家移動之後呼叫，蛇頭朝向等待中的方向時記為已套用。
+ *
+ * @param latency 延遲統計。
+ * @param game 移動後的遊戲狀態。
+ * @param player 移動的玩家。
+ * @param now_us 目前的時間 (微秒)。
+ */
+void game_latency_tick(GameLatency* latency, const GameState* game, int player, int64_t now_us);
+
+/**
+ * @brief 同 game_latency_tick，直接傳入移動後的蛇頭方向 (蛇不在 GameState 中時使用，例如無盡模式)。
+ *
+ * @param latency 延遲統計。
+ * @param player 移動的玩家。
+ * @param direction 移動後的方向。
+ * @param now_us 目前的時間 (微秒)。
+ */
+void game_latency_tick_direction(GameLatency* latency, int player, Direction direction, int64_t now_us);
+
+/**
+ * @brief 在繪製一個畫面之後呼叫，已套用的轉向記為在這個畫面繪製。
+ *
+ * @param latency 延遲統計。
+ * @param frame 畫面編號 (遞增)。
+ * @param drawn_us 繪製完成的時間 (微秒)。
+ */
+void game_latency_frame(GameLatency* latency, int64_t frame, int64_t drawn_us);
+
+/**
+ * @brief 取得等待呈現的最舊畫面編號。
+ *
+ * @param latency 延遲統計。
+ * @return 畫面編號；沒有時返回-1。
+ */
+int64_t game_latency_oldest_frame(const GameLatency* latency);
+
+/**
+ * @brief 記錄一個畫面的呈現時間，完成在這個畫面繪製的轉向。
+ *
+ * @param latency 延遲統計。
+ * @param frame 畫面編號。
+ * @param presented_us 呈現的時間 (微秒)；不明時傳入0，以繪製完成的時間代替。
+ * @return 完成的轉向數。
+ */
+int game_latency_present(GameLatency* latency, int64_t frame, int64_t presented_us);
+
+/**
+ * @brief 取得模式的名稱。
+ *
+ * @param mode 模式。
+ * @return 名稱。
+ */
+const char* game_latency_mode_name(GameLatencyMode mode);
+
+/**
+ * @brief 取得區段的名稱。
+ *
+ * @param stage 區段。
+ * @return 名稱。
+ */
+const char* game_latency_stage_name(GameLatencyStage stage);
+
+/**
+ * @brief 輸出每個模式與玩家的百分位數表 (毫秒)，沒有樣本的組合不輸出。
+ *
+ * @param latency 延遲統計。
+ * @param out 輸出。
+ */
+void game_latency_write(const GameLatency* latency, FILE* out);
+
+#endif // GAME_LATENCY_H
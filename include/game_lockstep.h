@@ -0,0 +1,261 @@
+#ifndef GAME_LOCKSTEP_H
+#define GAME_LOCKSTEP_H
+
+// 確定性同步 (deterministic lockstep) 的網路雙人對戰：
+// 兩端以相同的種子各自執行同一局雙人模式，之後只交換轉向輸入。
+// 「一格」是一次移動 (由 game_next_mover 決定誰移動，與重播的 step 相同)：
+// 第 f 次移動之前，兩端都套用兩位玩家在第 f 格的輸入，因此局面完全一致。
+// 本機在執行第 f 次移動時取樣目前的方向作為第 f + delay 格的輸入，
+// 輸入延遲讓封包有 delay 次移動的時間抵達；對方的輸入還沒到時就停下來等待 (stall)。
+// 本模組只負責協定與同步邏輯，不接觸通訊端：呼叫端把 game_lockstep_write 產生的封包送出，
+// 收到的封包交給 game_lockstep_read，並以自己的單調時鐘 (毫秒) 驅動 game_lockstep_advance。
+//
+// 封包 (小端序)：
+//   HELLO  01 對局 版本 玩家 延遲 已收到 種子(8)                         共14位元組
+//   INPUT  02|旗標 對局 數量 第一格(2) 已收到(2) [時間戳(2) 回應(2) 回應前的等待(2)]
+//          [比對格(2) 雜湊(4)] 方向 (每個2位元)
+// 格數只傳低16位元，接收端以最接近預期值的方式還原；平常一個封包只有8位元組。
+// HELLO 的延遲欄位最高位元表示回溯模式。
+//
+// 回溯 (rollback) 模式：本機輸入不必延遲 (delay 可為0)，對方還沒到的輸入以最後一個已知輸入預測
+// (即「方向不變」)，最多領先 rollback_frames 格。以預測模擬的每一格之前先把局面寫進快照環
+// (game_snapshot_write)；對方的實際輸入與預測不同時，在下一次推進前以 game_snapshot_restore
+// 回到該格並重新模擬到目前的格數。檢查點的雜湊只在兩端輸入都已確認的格數上送出與比對。
+// 兩端的輸入一旦確認，結果與確定性同步完全相同。
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+#include "game_replay.h"
+
+//========================[ 常數 ]========================
+#define GAME_LOCKSTEP_VERSION 2
+#define GAME_LOCKSTEP_DEFAULT_DELAY 3   // 預設的輸入延遲 (移動次數)
+#define GAME_LOCKSTEP_MAX_DELAY 32      // 輸入延遲的上限
+#define GAME_LOCKSTEP_WINDOW 256        // 輸入環形緩衝區的格數
+#define GAME_LOCKSTEP_MAX_BATCH 64      // 一個封包最多帶的輸入數
+#define GAME_LOCKSTEP_CHECK_EVERY 32    // 每隔幾次移動比對一次局面雜湊
+#define GAME_LOCKSTEP_CHECKS 8          // 保留的本機雜湊數
+#define GAME_LOCKSTEP_MAX_PACKET 64     // 封包的最大位元組數
+#define GAME_LOCKSTEP_NO_INPUT 0xFF     // 這一格沒有輸入
+#define GAME_LOCKSTEP_DEFAULT_ROLLBACK 16 // 回溯模式預設最多以預測領先的格數
+#define GAME_LOCKSTEP_MAX_ROLLBACK 64     // 回溯格數的上限
+
+//========================[ 結構定義 ]========================
+// 連線階段
+typedef enum {
+    LOCKSTEP_CONNECTING = 0,  // 交換 HELLO
+    LOCKSTEP_RUNNING,         // 對局中
+    LOCKSTEP_OVER,            // 兩位玩家都已死亡
+    LOCKSTEP_DESYNC           // 局面雜湊不一致，停止推進
+} GameLockstepPhase;
+
+// 統計
+typedef struct {
+    double rtt_ms;            // 平滑後的往返時間 (毫秒)
+    double rtt_min_ms;        // 最小往返時間
+    double rtt_max_ms;        // 最大往返時間
+    long rtt_samples;         // 往返時間的樣本數
+    long stalls;              // 因等待對方輸入而停下的次數
+    double stall_ms;          // 等待的總時間 (毫秒)
+    double input_delay_ms;    // 本機輸入從取樣到套用的平均遊戲時間 (毫秒)
+    long input_delay_samples;
+    long packets_sent, bytes_sent;
+    long packets_received, bytes_received;
+    long inputs_sent;         // 送出的輸入數 (含重送)
+    long desync_frame;        // 雜湊不一致的格數 (-1 表示沒有)
+    // 回溯模式
+    long predicted_frames;    // 第一次模擬時以預測的對方輸入模擬的移動次數 (重新模擬另計在 resim_frames)
+    long rollbacks;           // 回溯次數 (預測錯誤)
+    long rollback_depth_max;  // 最深的一次回溯 (格數)
+    long rollback_depth_total;// 回溯格數的總和
+    long resim_frames;        // 回溯後重新模擬的移動次數
+    long corrections;         // 重新模擬後畫面 (蛇身、食物、分數、存活) 與原本不同的次數
+} GameLockstepStats;
+
+// 一端的同步狀態
+typedef struct {
+    GameState* game;          // 對局的遊戲狀態 (由呼叫端擁有)
+    GameReplay* record;       // 記錄實際套用的轉向 (可為NULL)
+    int local;                // 本機玩家索引 (0 為主機，決定種子、輸入延遲與模式)
+    int delay;                // 輸入延遲 (移動次數，回溯模式可為0)
+    uint64_t seed;            // 本局的種子
+    uint8_t match;            // 對局編號，不同編號的封包被忽略
+    GameLockstepPhase phase;
+
+    bool hello_received;      // 已收到對方的 HELLO
+    bool peer_ready;          // 對方已收到本機的 HELLO
+    bool hello_pending;       // 下一個封包需要是 HELLO
+
+    long frame;               // 已完成的移動次數
+    long simulated;           // 模擬過的最遠格數 (回溯後重新模擬時 frame 會小於它)
+    long local_count;         // 已產生的本機輸入格數
+    long remote_count;        // 已連續收到的對方輸入格數
+    long remote_acked;        // 對方已連續收到的本機輸入格數
+    long sent_count;          // 上次送出時的 local_count
+    Direction local_dir;      // 目前的本機方向，下一次取樣時使用
+    uint8_t inputs[MAX_PLAYERS][GAME_LOCKSTEP_WINDOW];  // 每格的方向 (依格數取餘數)
+    double sampled_ms[GAME_LOCKSTEP_WINDOW];            // 本機輸入取樣時的遊戲時間
+    double sent_ms[GAME_LOCKSTEP_WINDOW];               // 本機輸入最後一次送出的本機時間 (決定何時重送)
+
+    double origin_ms;         // 本機時鐘減去遊戲時間 (停下等待時往後移)
+    bool stalled;             // 是否正在等待對方輸入
+    double stall_start_ms;    // 開始等待的時間
+    double last_send_ms;      // 上次送出封包的時間
+    bool ack_pending;         // 收到新的對方輸入，還沒回應確認
+    double ack_due_ms;        // 最晚送出確認的時間 (下一次移動的輸入封包很快就會帶著確認時等到那時)
+
+    bool have_stamp;          // 是否收到過對方的時間戳
+    uint16_t peer_stamp;      // 最近收到的對方時間戳 (毫秒的低16位元)
+    double peer_stamp_at_ms;  // 收到該時間戳的本機時間
+
+    uint32_t checks[GAME_LOCKSTEP_CHECKS]; // 本機在檢查點的局面雜湊
+    long check_sent;          // 已送出的最後一個檢查點
+    long pending_check_frame; // 對方領先時暫存的檢查點 (-1 表示沒有)
+    uint32_t pending_check;
+
+    // 回溯模式 (rollback_frames 為0時是確定性同步)
+    int rollback_frames;      // 最多以預測領先已確認輸入的格數
+    unsigned char* snapshots; // 快照環 (rollback_frames 個，每個 snapshot_stride 位元組)
+    size_t snapshot_stride;   // 每個快照的位元組數 (開頭 8 位元組是格數)
+    long rollback_from;       // 需要從這一格重新模擬 (-1 表示不需要)
+    uint8_t predicted[GAME_LOCKSTEP_WINDOW]; // 模擬時使用的對方輸入預測
+
+    GameLockstepStats stats;
+} GameLockstep;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 準備一局網路對戰，之後以 HELLO 交換設定。
+ *
+ * 主機 (玩家0) 的種子、輸入延遲與模式為準；客戶端的 seed、delay 與模式在收到主機的 HELLO 後被覆寫。
+ * record 與回溯模式的設定 (game_lockstep_set_rollback) 會保留到下一局。
+ *
+ * @param ls 同步狀態。
+ * @param game 遊戲狀態 (網格尺寸由呼叫端設定，兩端必須相同)。
+ * @param local 本機玩家索引 (0 或 1)。
+ * @param delay 輸入延遲 (移動次數)。
+ * @param seed 種子。
+ * @param match 對局編號 (再來一局時遞增)。
+ */
+void game_lockstep_init(GameLockstep* ls, GameState* game, int local, int delay, uint64_t seed, uint8_t match);
+
+/**
+ * @brief 切換回溯模式的函式 (在 game_lockstep_init 之後、連線開始前呼叫)。
+ *
+ * 依網格尺寸配置快照環；frames 為0時回到確定性同步並釋放快照環。
+ *
+ * @param ls 同步狀態。
+ * @param frames 最多以預測領先的格數 (1 ~ GAME_LOCKSTEP_MAX_ROLLBACK)。
+ * @return 成功返回true；配置失敗時返回false (模式不變)。
+ */
+bool game_lockstep_set_rollback(GameLockstep* ls, int frames);
+
+/**
+ * @brief 釋放快照環的函式。
+ *
+ * @param ls 同步狀態。
+ */
+void game_lockstep_free(GameLockstep* ls);
+
+/**
+ * @brief 取得兩端輸入都已確認的移動次數。
+ *
+ * 確定性同步時等於 frame；回溯模式時之後的局面仍可能因回溯而改變。
+ *
+ * @param ls 同步狀態。
+ * @return 已確認的移動次數。
+ */
+long game_lockstep_confirmed(const GameLockstep* ls);
+
+/**
+ * @brief 設定本機玩家目前的方向 (下一次取樣時使用)。
+ *
+ * @param ls 同步狀態。
+ * @param dir 方向。
+ */
+void game_lockstep_set_input(GameLockstep* ls, Direction dir);
+
+/**
+ * @brief 讓遊戲時間停止 ms 毫秒 (倒數或暫停期間呼叫)，之後的移動不會一次補上。
+ *
+ * @param ls 同步狀態。
+ * @param ms 停止的毫秒數。
+ */
+void game_lockstep_hold(GameLockstep* ls, double ms);
+
+/**
+ * @brief 處理待處理的回溯 (回溯模式)。
+ *
+ * 收到與預測不同的對方輸入後，回到該格的快照並重新模擬到目前的格數；
+ * 讀完一批封包後先呼叫，讓電腦玩家或畫面看到修正後的局面 (game_lockstep_advance 也會呼叫)。
+ *
+ * @param ls 同步狀態。
+ */
+void game_lockstep_reconcile(GameLockstep* ls);
+
+/**
+ * @brief 推進一次移動。
+ *
+ * 遊戲時間到了而且兩位玩家在這一格的輸入都已知時，套用輸入並讓 game_next_mover 選出的玩家移動一步。
+ * 回溯模式下對方的輸入可以是預測值；有待處理的回溯時先回到該格並重新模擬
+ * (重新模擬的移動不回報事件，呼叫端可比較 stats.rollbacks 得知局面被修正)。
+ *
+ * @param ls 同步狀態。
+ * @param now_ms 本機的單調時鐘 (毫秒)。
+ * @param event 輸出的移動結果 (可為NULL)。
+ * @return 移動的玩家索引；還不能移動時返回 -1；對局結束 (或不一致) 時返回 -2。
+ */
+int game_lockstep_advance(GameLockstep* ls, double now_ms, GameEvent* event);
+
+/**
+ * @brief 下一次需要呼叫 game_lockstep_advance 的時間。
+ *
+ * @param ls 同步狀態。
+ * @param now_ms 本機的單調時鐘 (毫秒)。
+ * @return 距離下一次移動的毫秒數 (等待對方輸入或未開始時返回 -1)。
+ */
+double game_lockstep_wait_ms(const GameLockstep* ls, double now_ms);
+
+/**
+ * @brief 判斷現在是否需要送出封包 (有新的輸入，或到了重送 / 保持連線的時間)。
+ *
+ * @param ls 同步狀態。
+ * @param now_ms 本機的單調時鐘 (毫秒)。
+ * @return 需要送出時返回 true。
+ */
+bool game_lockstep_should_send(const GameLockstep* ls, double now_ms);
+
+/**
+ * @brief 產生下一個要送出的封包。
+ *
+ * @param ls 同步狀態。
+ * @param buffer 輸出的封包 (至少 GAME_LOCKSTEP_MAX_PACKET 位元組)。
+ * @param now_ms 本機的單調時鐘 (毫秒)。
+ * @return 封包的位元組數。
+ */
+int game_lockstep_write(GameLockstep* ls, uint8_t* buffer, double now_ms);
+
+/**
+ * @brief 處理收到的封包。
+ *
+ * @param ls 同步狀態。
+ * @param data 封包內容。
+ * @param length 位元組數。
+ * @param now_ms 本機的單調時鐘 (毫秒)。
+ * @return 封包有效 (屬於這一局) 時返回 true。
+ */
+bool game_lockstep_read(GameLockstep* ls, const uint8_t* data, int length, double now_ms);
+
+/**
+ * @brief 判斷對局是否已結束，且對方已收到它需要的所有本機輸入。
+ *
+ * @param ls 同步狀態。
+ * @return 可以停止送出封包時返回 true。
+ */
+bool game_lockstep_finished(const GameLockstep* ls);
+
+#endif // GAME_LOCKSTEP_H
@@ -0,0 +1,108 @@
+#ifndef GAME_MCTS_H
+#define GAME_MCTS_H
+
+// 蒙地卡羅樹搜尋 (MCTS)：每次決策從目前的局面建立精簡狀態 (GameSim)，
+// 每一次模擬複製一份後沿搜尋樹選擇自己的方向 (UCB1)，離開樹後雙方都以快速的策略走到視野上限，
+// 再依分數與存活評估結果並回傳到路徑上的節點。
+// 樹只記錄自己的方向序列 (開迴路)：對手與食物位置由模擬決定，每次模擬使用不同的食物亂數，
+// 搜尋不會看到遊戲真正的亂數。兩位玩家依各自的移動間隔輪流移動，與 game_play_match 相同。
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+#include "game_sim.h"
+
+//========================[ 常數 ]========================
+// 預設每次決策的模擬次數 (未設定模擬次數與時間上限時使用)
+#define MCTS_DEFAULT_ITERATIONS 512
+// 預設的節點池大小
+#define MCTS_DEFAULT_NODES (1 << 16)
+
+//========================[ 結構定義 ]========================
+// 搜尋樹的節點 (以自己的方向為邊)
+typedef struct {
+    int32_t  child[4];        // 各方向的子節點 (-1 表示尚未展開)
+    uint32_t visits;          // 經過次數
+    float    value;           // 評估值總和 (0: 輸, 1: 贏)
+} MctsNode;
+
+// 搜尋器
+typedef struct {
+    int width, height;        // 網格尺寸
+    size_t sim_size;          // 精簡狀態的大小
+    GameSim* root;            // 目前局面
+    GameSim* scratch;         // 模擬用的副本
+
+    GameSimWalls* walls;      // 目前這一局的牆層
+    Obstacle walls_key[MAX_OBSTACLES]; // 建立牆層時的障礙物 (不同時重建)
+    int walls_key_count;
+
+    MctsNode* nodes;          // 節點池 (每次決策重新使用)
+    int node_capacity;
+    int node_count;
+
+    int horizon;              // 每次模擬最多的移動步數 (雙方合計)
+    float exploration;        // UCB1 的探索係數
+
+    // 統計
+    unsigned long decisions;      // 決策次數
+    unsigned long long rollouts;  // 累計模擬次數
+    unsigned long last_rollouts;  // 上一次決策的模擬次數
+    double total_us;              // 累計決策時間 (微秒)
+    long last_us;                 // 上一次決策的時間 (微秒)
+    long max_us;                  // 單次決策的最長時間 (微秒)
+} MctsSearch;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立搜尋器的函式。
+ *
+ * @param search 搜尋器。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @param node_capacity 節點池大小 (0 表示使用預設值)。
+ * @return 成功返回true；網格太大或配置失敗時返回false。
+ */
+bool mcts_search_init(MctsSearch* search, int width, int height, int node_capacity);
+
+/**
+ * @brief 釋放搜尋器的函式。
+ *
+ * @param search 搜尋器。
+ */
+void mcts_search_free(MctsSearch* search);
+
+/**
+ * @brief 依目前局面的障礙物準備牆層的函式。
+ *
+ * 障礙物與上次相同時不做任何事；mcts_search_choose 會自行呼叫，
+ * 在開局時先呼叫可以讓搜尋中不需要配置記憶體。
+ *
+ * @param search 搜尋器。
+ * @param game 遊戲狀態。
+ * @return 成功返回true；網格尺寸不符或配置失敗時返回false。
+ */
+bool mcts_search_sync_walls(MctsSearch* search, const GameState* game);
+
+/**
+ * @brief 以 MCTS 為玩家選擇下一步方向的函式。
+ *
+ * 模擬次數達到 max_iterations 或時間超過 budget_us 時停止 (兩者都為0時使用預設的模擬次數)。
+ * 只設定模擬次數時結果與機器速度無關。
+ *
+ * @param search 搜尋器。
+ * @param game 遊戲狀態。
+ * @param player 玩家索引。
+ * @param rng 搜尋用的亂數狀態 (不可為0)。
+ * @param max_iterations 模擬次數上限 (0 表示不限制)。
+ * @param budget_us 時間上限 (微秒，0 表示不限制)。
+ * @param dir 選擇的方向。
+ * @return 至少完成一次模擬時返回true；否則不修改 dir。
+ */
+bool mcts_search_choose(MctsSearch* search, const GameState* game, int player, uint64_t* rng,
+    long max_iterations, long budget_us, Direction* dir);
+
+#endif // GAME_MCTS_H
@@ -0,0 +1,224 @@
+#ifndef GAME_METRICS_H
+#define GAME_METRICS_H
+
+// 遊戲統計：固定的一組計數器與直方圖，記錄遊戲實際的運作情形 (每局的移動次數、蛇身長度、
+// 食物重抽次數、各種死亡原因、暫停次數與倒數時間)。
+// 每個執行緒第一次記錄時配置自己的分區，寫入只由該執行緒進行，不需要鎖也不共用快取行；
+// 讀取時把所有分區加總，因此記錄點只需要一次執行緒區域變數的讀取與一次加法。
+// 另外以 GameMetricsGame 累計一局的摘要，結束時附加到 CSV 或 JSON lines 檔案。
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+#define GAME_METRICS_BUCKETS 256  // 直方圖的桶數 (對數刻度，每個2的冪次分成8桶)
+
+//========================[ 結構定義 ]========================
+// 計數器
+typedef enum {
+    METRIC_GAMES = 0,         // 結束的局數
+    METRIC_TICKS,             // 移動次數 (所有玩家合計)
+    METRIC_FOOD_EATEN,        // 吃到的果實
+    METRIC_FOOD_SPAWNS,       // 生成食物的次數
+    METRIC_FOOD_RETRIES,      // 生成食物時重抽的次數
+    METRIC_DEATH_SELF,        // 撞到自己
+    METRIC_DEATH_OBSTACLE,    // 撞到障礙物
+    METRIC_DEATH_OTHER,       // 撞到另一條蛇
+    METRIC_PAUSES,            // 暫停次數
+    METRIC_PAUSE_MS,          // 暫停的總時間 (毫秒)
+    METRIC_COUNTDOWN_MS,      // 倒數的總時間 (毫秒)
+    METRIC_COUNTER_COUNT
+} GameMetricCounter;
+
+// 直方圖
+typedef enum {
+    METRIC_HIST_TICKS = 0,    // 每局的移動次數
+    METRIC_HIST_LENGTH,       // 每次移動後的蛇身長度
+    METRIC_HIST_FOOD_RETRIES, // 每局的食物重抽次數
+    METRIC_HIST_GAME_MS,      // 每局的遊戲時間 (毫秒，不含倒數與暫停)
+    METRIC_HIST_PAUSE_MS,     // 每次暫停的時間 (毫秒)
+    METRIC_HIST_COUNTDOWN_MS, // 每次倒數的時間 (毫秒)
+    METRIC_HIST_COUNT
+} GameMetricHistogram;
+
+// 加總後的直方圖
+typedef struct {
+    uint64_t count;           // 樣本數
+    uint64_t sum;             // 樣本總和
+    uint64_t max;             // 最大值
+    uint64_t buckets[GAME_METRICS_BUCKETS];
+} GameMetricsHistogram;
+
+// 加總所有執行緒後的快照
+typedef struct {
+    uint64_t counters[METRIC_COUNTER_COUNT];
+    GameMetricsHistogram histograms[METRIC_HIST_COUNT];
+    int threads;              // 曾經記錄過的執行緒數
+} GameMetricsSnapshot;
+
+// 一局的摘要 (由執行這一局的執行緒累計)
+typedef struct {
+    const char* mode;         // 模式名稱 (字串常數)
+    uint64_t seed;            // 種子 (不明時為0)
+    int player_count;
+    int64_t started;          // 開始的時間 (Unix 時間，秒)
+    long ticks;               // 移動次數
+    uint64_t length_sum;      // 每次移動後的蛇身長度總和
+    int length_max;           // 最長的蛇身
+    long food_eaten;          // 吃到的果實
+    long food_spawns;         // 生成食物的次數
+    long food_retries;        // 生成食物時重抽的次數
+    int deaths[4];            // 依 GameCollision 分類的死亡次數 (索引0不使用)
+    int pauses;               // 暫停次數
+    long pause_ms;            // 暫停的總時間 (毫秒)
+    long countdown_ms;        // 倒數的總時間 (毫秒)
+    long game_ms;             // 遊戲時間 (毫秒，最長存活的玩家)
+    int scores[MAX_PLAYERS];  // 分數
+    int winner;               // 贏家 (雙人模式)
+    bool finished;            // 是否已結算
+} GameMetricsGame;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/* 記錄 (任何執行緒) */
+
+/**
+ * @brief 增加計數器。
+ *
+ * @param counter 計數器。
+ * @param value 增加的值。
+ */
+void game_metrics_add(GameMetricCounter counter, uint64_t value);
+
+/**
+ * @brief 記錄一個直方圖樣本。
+ *
+ * @param histogram 直方圖。
+ * @param value 樣本。
+ */
+void game_metrics_observe(GameMetricHistogram histogram, uint64_t value);
+
+/**
+ * @brief 取得直方圖中某個值所在的桶。
+ *
+ * @param value 值。
+ * @return 桶的索引。
+ */
+int game_metrics_bucket(uint64_t value);
+
+
+/* 讀取 */
+
+/**
+ * @brief 加總所有執行緒的分區 (其他執行緒可以同時記錄，讀到的是接近當下的值)。
+ *
+ * @param snapshot 輸出。
+ */
+void game_metrics_read(GameMetricsSnapshot* snapshot);
+
+/**
+ * @brief 估計直方圖的百分位數。
+ *
+ * @param histogram 直方圖。
+ * @param quantile 0~1。
+ * @return 該桶的上限；沒有樣本時返回0。
+ */
+uint64_t game_metrics_percentile(const GameMetricsHistogram* histogram, double quantile);
+
+/**
+ * @brief 取得計數器的名稱。
+ *
+ * @param counter 計數器。
+ * @return 名稱 (snake_case)。
+ */
+const char* game_metrics_counter_name(GameMetricCounter counter);
+
+/**
+ * @brief 取得直方圖的名稱。
+ *
+ * @param histogram 直方圖。
+ * @return 名稱 (snake_case)。
+ */
+const char* game_metrics_histogram_name(GameMetricHistogram histogram);
+
+/**
+ * @brief 把快照寫成一行 JSON (計數器，以及各直方圖的樣本數、平均、p50、p99 與最大值)。
+ *
+ * @param snapshot 快照。
+ * @param out 輸出。
+ * @return 成功返回true。
+ */
+bool game_metrics_write_snapshot(const GameMetricsSnapshot* snapshot, FILE* out);
+
+
+/* 每局的摘要 */
+
+/**
+ * @brief 開始一局的摘要。
+ *
+ * @param summary 摘要。
+ * @param mode 模式名稱 (字串常數)。
+ * @param seed 種子 (不明時為0)。
+ * @param player_count 玩家數。
+ * @param started 開始的時間 (Unix 時間，秒)。
+ */
+void game_metrics_game_begin(GameMetricsGame* summary, const char* mode, uint64_t seed, int player_count, int64_t started);
+
+/**
+ * @brief 記錄一次移動 (在 game_step_player 之後呼叫)。
+ *
+ * @param summary 摘要。
+ * @param game 遊戲狀態。
+ * @param player 移動的玩家。
+ * @param event 移動的結果。
+ */
+void game_metrics_game_tick(GameMetricsGame* summary, const GameState* game, int player, GameEvent event);
+
+/**
+ * @brief 記錄一次暫停。
+ *
+ * @param summary 摘要。
+ * @param ms 暫停的時間 (毫秒)。
+ */
+void game_metrics_game_pause(GameMetricsGame* summary, long ms);
+
+/**
+ * @brief 記錄一次倒數。
+ *
+ * @param summary 摘要。
+ * @param ms 倒數的時間 (毫秒)。
+ */
+void game_metrics_game_countdown(GameMetricsGame* summary, long ms);
+
+/**
+ * @brief 結算一局：以最終局面計算死亡原因、分數與食物統計，並加入全域的計數器與直方圖。
+ *
+ * 重複呼叫時不做任何事。
+ *
+ * @param summary 摘要。
+ * @param game 最終的遊戲狀態。
+ */
+void game_metrics_game_end(GameMetricsGame* summary, const GameState* game);
+
+/**
+ * @brief 把一局的摘要附加到檔案。
+ *
+ * 路徑以 .csv 結尾時寫成 CSV (空檔案先寫標題列)，否則寫成一行 JSON。
+ *
+ * @param summary 已結算的摘要。
+ * @param path 輸出檔案路徑。
+ * @return 成功返回true。
+ */
+bool game_metrics_game_append(const GameMetricsGame* summary, const char* path);
+
+/**
+ * @brief 釋放所有執行緒的分區 (程式結束前、其他執行緒都停止後呼叫)。
+ */
+void game_metrics_shutdown(void);
+
+#endif // GAME_METRICS_H
@@ -0,0 +1,151 @@
+#ifndef GAME_NET_H
+#define GAME_NET_H
+
+// 網路傳輸：非阻塞的 UDP 通訊端 (Windows 使用 Winsock，其他平台使用 BSD socket)。
+// 內建延遲 / 遺失模擬：開啟後送出的封包先放進佇列，依設定的延遲 (加上隨機抖動) 才真正送出，
+// 並以設定的機率直接丟棄，用來在本機回送位址 (loopback) 上測試網路對戰。
+// 只處理 IPv4 與不超過 GAME_NET_MAX_PACKET 位元組的封包。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 常數 ]========================
+#define GAME_NET_MAX_PACKET 512   // 單一封包的最大位元組數
+#define GAME_NET_MAX_DELAYED 1024 // 延遲佇列最多保留的封包數
+
+//========================[ 結構定義 ]========================
+// IPv4 位址 (主機位元組順序)
+typedef struct {
+    uint32_t ip;
+    uint16_t port;
+} GameNetAddress;
+
+// 延遲佇列中的封包
+typedef struct {
+    int64_t deliver_us;       // 送出的時間 (game_net_now_us)
+    GameNetAddress to;        // 目的地
+    uint16_t length;          // 位元組數 (0 表示空位)
+    unsigned char data[GAME_NET_MAX_PACKET];
+} GameNetDelayed;
+
+// 延遲 / 遺失模擬的設定
+typedef struct {
+    int latency_ms;           // 單向延遲 (毫秒)
+    int jitter_ms;            // 延遲的隨機抖動上限 (毫秒)，抖動可能使封包亂序
+    double loss;              // 遺失機率 (0~1)
+    uint64_t rng_state;       // 模擬用的亂數狀態
+} GameNetShim;
+
+// 一個 UDP 通訊端
+typedef struct {
+    intptr_t socket;          // 通訊端 (-1 表示未開啟)
+    uint16_t port;            // 綁定的本機埠號
+    GameNetShim shim;         // 延遲 / 遺失模擬 (latency、jitter、loss 皆為0時不使用佇列)
+    GameNetDelayed* delayed;  // 延遲佇列 (第一次需要時配置)
+    int delayed_count;
+    // 統計 (遺失模擬丟棄的封包算在 packets_dropped，不算在送出)
+    uint64_t packets_sent, bytes_sent;
+    uint64_t packets_received, bytes_received;
+    uint64_t packets_dropped;
+} GameNet;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 初始化網路程式庫 (Windows 需要，其他平台不做任何事)。
+ *
+ * @return 成功返回 true。
+ */
+bool game_net_startup(void);
+
+/**
+ * @brief 釋放網路程式庫。
+ */
+void game_net_cleanup(void);
+
+/**
+ * @brief 開啟並綁定一個非阻塞的 UDP 通訊端。
+ *
+ * @param net 通訊端。
+ * @param port 本機埠號 (0 表示由系統指定)。
+ * @return 成功返回 true。
+ */
+bool game_net_open(GameNet* net, int port);
+
+/**
+ * @brief 關閉通訊端並丟棄延遲佇列中的封包。
+ *
+ * @param net 通訊端。
+ */
+void game_net_close(GameNet* net);
+
+/**
+ * @brief 解析 IPv4 位址或主機名稱。
+ *
+ * @param host 位址或主機名稱。
+ * @param port 埠號。
+ * @param address 輸出的位址。
+ * @return 成功返回 true。
+ */
+bool game_net_resolve(const char* host, int port, GameNetAddress* address);
+
+/**
+ * @brief 設定送出方向的延遲 / 遺失模擬。
+ *
+ * @param net 通訊端。
+ * @param latency_ms 單向延遲 (毫秒)。
+ * @param jitter_ms 延遲的隨機抖動上限 (毫秒)。
+ * @param loss 遺失機率 (0~1)。
+ * @param seed 模擬用的種子。
+ */
+void game_net_set_shim(GameNet* net, int latency_ms, int jitter_ms, double loss, uint64_t seed);
+
+/**
+ * @brief 送出一個封包 (開啟模擬時可能延後送出或丟棄)。
+ *
+ * @param net 通訊端。
+ * @param to 目的地。
+ * @param data 內容。
+ * @param length 位元組數 (不超過 GAME_NET_MAX_PACKET)。
+ * @return 封包已送出、排入佇列或被模擬丟棄時返回 true，通訊端錯誤時返回 false。
+ */
+bool game_net_send(GameNet* net, const GameNetAddress* to, const void* data, size_t length);
+
+/**
+ * @brief 接收一個封包 (非阻塞)。
+ *
+ * @param net 通訊端。
+ * @param buffer 輸出的內容。
+ * @param capacity 緩衝區大小。
+ * @param from 輸出的來源位址 (可為NULL)。
+ * @return 位元組數，沒有封包時返回 -1。
+ */
+int game_net_recv(GameNet* net, void* buffer, size_t capacity, GameNetAddress* from);
+
+/**
+ * @brief 送出延遲佇列中已到時間的封包。
+ *
+ * @param net 通訊端。
+ */
+void game_net_flush(GameNet* net);
+
+/**
+ * @brief 等待封包到達，最多 timeout_ms 毫秒 (延遲佇列中的封包到時間時提早返回)。
+ *
+ * @param net 通訊端。
+ * @param timeout_ms 最長等待時間 (毫秒)。
+ * @return 有封包可以接收時返回 true。
+ */
+bool game_net_wait(GameNet* net, int timeout_ms);
+
+/**
+ * @brief 取得網路用的單調時鐘。
+ *
+ * @return 微秒。
+ */
+int64_t game_net_now_us(void);
+
+#endif // GAME_NET_H
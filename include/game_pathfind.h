@@ -0,0 +1,120 @@
+#ifndef GAME_PATHFIND_H
+#define GAME_PATHFIND_H
+
+// 自動駕駛用的距離場：記錄每個格子沿可通行格子 (含邊界循環) 到食物的最短步數。
+// 距離場不會每一步重算：蛇頭進入的格子與蛇尾離開的格子會轉成「佔用 / 釋放」事件，
+// 釋放時只向外傳播變短的距離，佔用時只讓原本依賴該格的格子失效再重新傳播。
+// 只有食物移動或新的一局時才從食物重新展開，而且同樣分散在多次更新中完成。
+// 每次更新都有工作量與時間上限，未完成的工作留到下一次，不會拖慢遊戲迴圈。
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+// 無法到達的距離
+#define PATH_DIST_INF 0x3FFFFFFF
+
+//========================[ 結構定義 ]========================
+// 距離場
+typedef struct {
+    int width, height, cells;  // 網格尺寸
+
+    int32_t*  dist;            // 到食物的距離 (stamp 與 generation 相同時才有效)
+    uint32_t* stamp;           // 距離的世代標記，重新展開時不需清除整個陣列
+    uint32_t  generation;      // 目前的世代
+    uint8_t*  blocked;         // 佔用網格 (蛇身與障礙物)
+    uint8_t*  affected;        // 佔用事件中失效的格子
+    uint8_t*  queued;          // 是否已在傳播佇列中
+
+    int32_t*  relax;           // 傳播佇列 (環狀)
+    int relax_head, relax_count;
+    int32_t*  inval;           // 失效檢查佇列 (環狀)
+    int inval_head, inval_count;
+    int32_t*  affected_list;   // 失效的格子清單
+    int affected_count;
+    int reseed_clear;          // 重新設定失效格子的進度 (第一輪：清除距離)
+    int reseed_fill;           // 重新設定失效格子的進度 (第二輪：由鄰格推得距離)
+    int32_t*  events;          // 尚未套用的佔用 / 釋放事件 (環狀，cell * 2 + 是否佔用)
+    int event_head, event_count;
+
+    Point food;                // 距離場的目標
+    int   tracked_head[MAX_PLAYERS];   // 上次同步時各蛇的蛇頭索引
+    int   tracked_length[MAX_PLAYERS]; // 上次同步時各蛇的長度
+    bool  tracked_alive[MAX_PLAYERS];  // 上次同步時各蛇是否存活
+    bool  synced;              // 是否已與遊戲狀態同步過
+
+    long work_limit;           // 每次更新的工作量上限 (處理的格子數)
+    long time_limit_us;        // 每次更新的時間上限 (微秒，0 表示不限制；設定後結果與機器速度有關)
+
+    // 統計
+    unsigned long updates;     // 更新次數
+    unsigned long unsettled;   // 更新結束時仍有未完成工作的次數
+    unsigned long rebuilds;    // 從食物重新展開的次數
+    unsigned long long work;   // 累計工作量
+    long max_update_us;        // 單次更新的最長時間 (微秒)
+} PathField;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立距離場的函式。
+ *
+ * @param field 距離場。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 配置成功返回true；否則返回false。
+ */
+bool path_field_init(PathField* field, int width, int height);
+
+/**
+ * @brief 釋放距離場的函式。
+ *
+ * @param field 距離場。
+ */
+void path_field_free(PathField* field);
+
+/**
+ * @brief 丟棄距離場，下一次更新時重新讀取整個遊戲狀態的函式。
+ *
+ * 新的一局、讀檔或開始接手控制時呼叫。
+ *
+ * @param field 距離場。
+ */
+void path_field_invalidate(PathField* field);
+
+/**
+ * @brief 與遊戲狀態同步並在工作量與時間上限內更新距離場的函式。
+ *
+ * @param field 距離場。
+ * @param game 遊戲狀態。
+ * @return 距離場已完全更新時返回true。
+ */
+bool path_field_update(PathField* field, const GameState* game);
+
+/**
+ * @brief 取得格子到食物距離的函式。
+ *
+ * @param field 距離場。
+ * @param x X座標。
+ * @param y Y座標。
+ * @return 距離；無法到達或尚未計算時返回 PATH_DIST_INF。
+ */
+int path_field_distance(const PathField* field, int x, int y);
+
+/**
+ * @brief 依距離場為玩家選擇下一步方向的函式。
+ *
+ * 只考慮不會碰撞的方向，選擇距離最短者 (相同時保持原方向)。
+ *
+ * @param field 距離場。
+ * @param game 遊戲狀態。
+ * @param player 玩家索引。
+ * @param dir 選擇的方向。
+ * @return 有任何安全方向可以到達食物時返回true；否則不修改 dir。
+ */
+bool path_field_choose(const PathField* field, const GameState* game, int player, Direction* dir);
+
+#endif // GAME_PATHFIND_H
@@ -0,0 +1,91 @@
+#ifndef GAME_PERF_H
+#define GAME_PERF_H
+
+// 效能疊加層的資料：每個量測項目保留最近 GAME_PERF_RING 個樣本的環形緩衝區。
+// 記錄只寫入一個浮點數並移動索引，不配置記憶體也不排序；
+// 只有在繪製疊加層時才複製視窗內的樣本並計算平均、p50、p99 與最大值，
+// 因此關閉疊加層時的成本只有記錄本身，開啟時也不會影響它量測的項目。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 常數 ]========================
+#define GAME_PERF_RING 256        // 每個項目保留的樣本數 (2的冪次)
+#define GAME_PERF_MAX_LINES 8     // 疊加層的最多行數
+#define GAME_PERF_LINE_BYTES 80   // 每行的最多位元組數
+
+//========================[ 結構定義 ]========================
+// 量測項目 (皆為毫秒)
+typedef enum {
+    PERF_FRAME = 0,           // 繪製一個畫面的時間 (不含疊加層本身)
+    PERF_FRAME_INTERVAL,      // 相鄰兩次繪製的間隔 (換算 FPS)
+    PERF_TICK,                // 一次移動 (定時器回調) 的時間
+    PERF_TICK_JITTER,         // 移動定時器實際觸發時間與預定時間 (上一次觸發加上目前的移動間隔) 的差距
+    PERF_INPUT,               // 轉向的按鍵事件到畫面呈現的延遲 (game_latency)
+    PERF_SERIES_COUNT
+} GamePerfSeries;
+
+// 一個項目的環形緩衝區
+typedef struct {
+    float samples[GAME_PERF_RING];
+    uint32_t head;            // 累計寫入的樣本數
+} GamePerfRing;
+
+// 視窗內樣本的統計
+typedef struct {
+    int count;                // 樣本數
+    float last;               // 最新的樣本
+    float mean, p50, p99, max;
+} GamePerfStats;
+
+// 疊加層的所有資料
+typedef struct {
+    GamePerfRing series[PERF_SERIES_COUNT];
+    int voices;               // 目前播放中的音效管線數
+    bool visible;             // 是否顯示疊加層
+} GamePerf;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 記錄一個樣本 (覆寫最舊的樣本)。
+ *
+ * @param perf 疊加層的資料。
+ * @param series 量測項目。
+ * @param value 樣本 (毫秒)。
+ */
+void game_perf_push(GamePerf* perf, GamePerfSeries series, float value);
+
+/**
+ * @brief 計算一個項目目前視窗內的統計。
+ *
+ * @param perf 疊加層的資料。
+ * @param series 量測項目。
+ * @param stats 輸出。
+ */
+void game_perf_stats(const GamePerf* perf, GamePerfSeries series, GamePerfStats* stats);
+
+/**
+ * @brief 取得一個項目最近的樣本 (由舊到新)，供繪製走勢圖。
+ *
+ * @param perf 疊加層的資料。
+ * @param series 量測項目。
+ * @param out 輸出。
+ * @param capacity 輸出的大小。
+ * @return 樣本數。
+ */
+int game_perf_recent(const GamePerf* perf, GamePerfSeries series, float* out, int capacity);
+
+/**
+ * @brief 把目前的統計排成疊加層的文字。
+ *
+ * @param perf 疊加層的資料。
+ * @param lines 輸出的文字。
+ * @return 行數。
+ */
+int game_perf_format(const GamePerf* perf, char lines[GAME_PERF_MAX_LINES][GAME_PERF_LINE_BYTES]);
+
+#endif // GAME_PERF_H
@@ -0,0 +1,134 @@
+#ifndef GAME_REPLAY_H
+#define GAME_REPLAY_H
+
+// 重播：一局遊戲只需要記錄網格尺寸、玩家數、種子與輸入序列即可完整重現。
+// 輸入以「第幾次移動之前」標記：播放時在第 step 次移動前套用所有標記為 step 的轉向，
+// 再讓 game_next_mover 選出的玩家移動一步，與實際遊戲中輸入和移動的先後順序相同。
+// 以純文字存檔，方便把縮小後的失敗案例或回歸測試的語料直接放進版本控制。
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+#define GAME_REPLAY_MAGIC "snake-replay" // 檔案第一行的識別字
+#define GAME_REPLAY_VERSION 1            // 格式版本
+
+//========================[ 結構定義 ]========================
+// 一次轉向輸入
+typedef struct {
+    uint32_t step;            // 在第幾次移動之前套用 (從0開始)
+    uint8_t  player;          // 玩家索引
+    uint8_t  direction;       // 方向 (Direction)
+} GameReplayInput;
+
+// 一局的重播
+typedef struct {
+    int width, height;        // 網格尺寸
+    int player_count;         // 玩家數 (1: 單人模式, 2: 雙人模式)
+    uint64_t seed;            // 本局的種子 (game_seed)
+    long steps;               // 最多播放的移動次數 (所有玩家合計)
+    GameReplayInput* inputs;  // 依 step 排序的輸入
+    int input_count;
+    int input_capacity;
+} GameReplay;
+
+// 播放位置
+typedef struct {
+    const GameReplay* replay;
+    GameState* game;
+    long step;                // 已完成的移動次數
+    int next_input;           // 下一個尚未套用的輸入
+} GameReplayCursor;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 建立空白重播的函式。
+ *
+ * @param replay 重播。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @param player_count 玩家數。
+ * @param seed 種子。
+ */
+void game_replay_init(GameReplay* replay, int width, int height, int player_count, uint64_t seed);
+
+/**
+ * @brief 釋放重播輸入的函式。
+ *
+ * @param replay 重播。
+ */
+void game_replay_free(GameReplay* replay);
+
+/**
+ * @brief 複製重播的函式。
+ *
+ * @param dst 目的地 (已初始化或全為0)，原有的輸入會被取代。
+ * @param src 來源。
+ * @return 成功返回true；配置失敗時返回false。
+ */
+bool game_replay_copy(GameReplay* dst, const GameReplay* src);
+
+/**
+ * @brief 在重播尾端加入一次輸入的函式。
+ *
+ * @param replay 重播。
+ * @param step 在第幾次移動之前套用 (不可小於最後一個輸入的 step)。
+ * @param player 玩家索引。
+ * @param dir 方向。
+ * @return 成功返回true；配置失敗或 step 倒退時返回false。
+ */
+bool game_replay_add(GameReplay* replay, long step, int player, Direction dir);
+
+/**
+ * @brief 移除第 step 次移動 (含) 之後的輸入的函式。
+ *
+ * 連線對戰回溯到較早的移動時呼叫，之後重新模擬的輸入再以 game_replay_add 加入。
+ *
+ * @param replay 重播。
+ * @param step 第一個要移除的移動次數。
+ */
+void game_replay_truncate(GameReplay* replay, long step);
+
+/**
+ * @brief 以重播的設定開始一局並建立播放位置的函式。
+ *
+ * @param cursor 播放位置。
+ * @param replay 重播 (播放期間不可修改)。
+ * @param game 遊戲狀態 (尺寸不同時會重新配置)。
+ * @return 成功返回true；配置失敗或設定無效時返回false。
+ */
+bool game_replay_start(GameReplayCursor* cursor, const GameReplay* replay, GameState* game);
+
+/**
+ * @brief 套用本次移動前的輸入並讓下一位玩家移動一步的函式。
+ *
+ * @param cursor 播放位置。
+ * @param event 本步發生的事件 (可為NULL)。
+ * @return 移動的玩家索引；所有玩家都死亡或已達 steps 時返回-1。
+ */
+int game_replay_next(GameReplayCursor* cursor, GameEvent* event);
+
+/**
+ * @brief 把重播寫成文字的函式。
+ *
+ * @param replay 重播。
+ * @param out 輸出串流。
+ * @return 成功返回true。
+ */
+bool game_replay_write(const GameReplay* replay, FILE* out);
+
+/**
+ * @brief 從文字讀取重播的函式。
+ *
+ * @param replay 重播 (已初始化或全為0)，原有的輸入會被取代。
+ * @param in 輸入串流。
+ * @return 成功返回true；格式錯誤或配置失敗時返回false。
+ */
+bool game_replay_read(GameReplay* replay, FILE* in);
+
+#endif // GAME_REPLAY_H
@@ -0,0 +1,176 @@
+#ifndef GAME_ROOM_H
+#define GAME_ROOM_H
+
+// 伺服器權威 (authoritative) 的雙人對戰房間與訊息格式：不接觸通訊端，也不建立執行緒。
+// 房間以伺服器的時鐘驅動一局雙人模式，規則與介面層的 update_player1 / update_player2 /
+// end_two_player_game 相同：game_next_mover 依遊戲時間選出移動的玩家、game_step_player 移動並判定碰撞，
+// 兩位玩家都死亡後以 game_decide_winner 結算。客戶端只送出轉向，伺服器每次移動後廣播結果。
+//
+// 訊息 (小端序)，第一個位元組是整個訊息的長度，TCP 與 UDP 使用相同的格式：
+//   JOIN     長度 01 版本 客戶端編號(4)                                           7位元組
+//   INPUT    長度 02 房間(4) 玩家 序號(2) 方向 時間戳(4)                          14位元組
+//   WELCOME  長度 81 房間(4) 玩家 寬 高 種子(8)                                   17位元組
+//   MOVE     長度 82 旗標 格數(4) 玩家 方向 事件 蛇頭x y 食物x y 分數(2)x2
+//            已套用序號(2) [時間戳回應(4)]                                         20/24位元組
+//   OVER     長度 83 贏家 分數(2)x2 格數(4)                                        11位元組
+// MOVE 依收件人不同：已套用序號是收件人自己最後一個生效的輸入，收件人的蛇在這一步
+// 套用了新輸入時附上該輸入的時間戳，客戶端可以量出輸入到廣播的往返時間。
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+#define GAME_ROOM_VERSION 1
+#define GAME_ROOM_MAX_MESSAGE 32      // 單一訊息的最大位元組數
+#define GAME_ROOM_MAX_MOVES 6000      // 一局的移動上限 (兩條蛇都沿著沒有障礙物的列直行時不會結束)
+#define GAME_ROOM_START_DELAY_MS 500  // 建立房間到第一次移動的時間，讓兩位玩家收到 WELCOME
+
+//========================[ 結構定義 ]========================
+// 訊息種類
+typedef enum {
+    ROOM_MSG_JOIN = 0x01,     // 客戶端要求配對
+    ROOM_MSG_INPUT = 0x02,    // 客戶端轉向
+    ROOM_MSG_WELCOME = 0x81,  // 配對完成
+    ROOM_MSG_MOVE = 0x82,     // 一次移動的結果
+    ROOM_MSG_OVER = 0x83      // 對局結束
+} GameRoomMessageType;
+
+// 解碼後的訊息 (只有該種類用到的欄位有效)
+typedef struct {
+    uint8_t type;             // GameRoomMessageType
+    uint32_t client_id;       // JOIN
+    uint32_t room;            // INPUT、WELCOME
+    uint8_t player;           // INPUT、WELCOME：玩家索引；MOVE：移動的玩家
+    uint16_t seq;             // INPUT：序號；MOVE：收件人最後生效的序號
+    uint8_t direction;        // INPUT：新方向；MOVE：移動的方向
+    uint32_t stamp;           // INPUT：客戶端時間戳；MOVE：回應的時間戳 (has_echo 時)
+    bool has_echo;            // MOVE 是否帶有時間戳回應
+    uint8_t width, height;    // WELCOME
+    uint64_t seed;            // WELCOME
+    uint32_t frame;           // MOVE、OVER：已完成的移動次數
+    uint8_t event;            // MOVE：GameEvent
+    uint8_t head_x, head_y;   // MOVE：新蛇頭
+    uint8_t food_x, food_y;   // MOVE：食物
+    int16_t scores[MAX_PLAYERS]; // MOVE、OVER
+    uint8_t winner;           // OVER
+} GameRoomMessage;
+
+// 一個房間
+typedef struct {
+    uint32_t id;              // 房間編號 (由伺服器決定)
+    GameState game;           // 這一局的遊戲狀態 (房間重複使用時保留記憶體區塊)
+    uint64_t seed;            // 這一局的種子
+    double origin_ms;         // 遊戲時間0對應的伺服器時鐘 (毫秒)
+    long frame;               // 已完成的移動次數
+    bool over;                // 是否已結束
+    uint16_t seq[MAX_PLAYERS];          // 各玩家最後收到的輸入序號
+    bool has_input[MAX_PLAYERS];        // 是否收到過輸入
+    uint32_t stamp[MAX_PLAYERS];        // 最後一個輸入的時間戳
+    bool echo_pending[MAX_PLAYERS];     // 下一次該玩家移動時回應時間戳
+    double input_at_ms[MAX_PLAYERS];    // 尚未生效的輸入最早的收到時間 (-1 表示沒有，呼叫端廣播該玩家的移動後清除)
+} GameRoom;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/* 訊息 */
+
+/**
+ * @brief 編碼一個訊息。
+ *
+ * @param message 訊息。
+ * @param buffer 輸出 (至少 GAME_ROOM_MAX_MESSAGE 位元組)。
+ * @return 位元組數；未知的種類返回0。
+ */
+int game_room_encode(const GameRoomMessage* message, uint8_t* buffer);
+
+/**
+ * @brief 從資料流開頭解碼一個訊息。
+ *
+ * @param data 資料。
+ * @param length 可用的位元組數。
+ * @param message 輸出的訊息。
+ * @return 用掉的位元組數；資料還不完整時返回0；格式錯誤時返回-1。
+ */
+int game_room_decode(const uint8_t* data, int length, GameRoomMessage* message);
+
+
+/* 房間 */
+
+/**
+ * @brief 開始房間的一局 (房間第一次使用前須全為0)。
+ *
+ * @param room 房間。
+ * @param id 房間編號。
+ * @param seed 種子。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @param now_ms 伺服器時鐘 (毫秒)，第一次移動在 GAME_ROOM_START_DELAY_MS 之後。
+ * @return 成功返回true；配置失敗時返回false。
+ */
+bool game_room_start(GameRoom* room, uint32_t id, uint64_t seed, int width, int height, double now_ms);
+
+/**
+ * @brief 釋放房間的記憶體。
+ *
+ * @param room 房間。
+ */
+void game_room_free(GameRoom* room);
+
+/**
+ * @brief 套用玩家的轉向 (與按鍵相同，立即以 game_turn 改變下一步方向)。
+ *
+ * 序號不比最後收到的新 (重送或亂序) 時忽略。
+ *
+ * @param room 房間。
+ * @param player 玩家索引。
+ * @param seq 序號。
+ * @param dir 方向。
+ * @param stamp 客戶端時間戳 (原樣回應)。
+ * @param now_ms 收到的時間。
+ * @return 輸入被採用時返回true。
+ */
+bool game_room_input(GameRoom* room, int player, uint16_t seq, Direction dir, uint32_t stamp, double now_ms);
+
+/**
+ * @brief 取得下一次移動的時間。
+ *
+ * @param room 房間。
+ * @return 伺服器時鐘 (毫秒)；已結束時返回-1。
+ */
+double game_room_due_ms(const GameRoom* room);
+
+/**
+ * @brief 移動一步 (已到時間時)。
+ *
+ * 兩位玩家都死亡或達到 GAME_ROOM_MAX_MOVES 時結算並標記結束。
+ *
+ * @param room 房間。
+ * @param now_ms 伺服器時鐘 (毫秒)。
+ * @param event 輸出的事件 (可為NULL)。
+ * @return 移動的玩家索引；還沒到時間返回-1；已結束返回-2。
+ */
+int game_room_step(GameRoom* room, double now_ms, GameEvent* event);
+
+/**
+ * @brief 產生給某位玩家的 MOVE 訊息 (清除該玩家待回應的時間戳)。
+ *
+ * @param room 房間。
+ * @param mover 剛移動的玩家。
+ * @param event 移動的事件。
+ * @param recipient 收件的玩家。
+ * @param message 輸出的訊息。
+ */
+void game_room_move_message(GameRoom* room, int mover, GameEvent event, int recipient, GameRoomMessage* message);
+
+/**
+ * @brief 產生 OVER 訊息。
+ *
+ * @param room 房間。
+ * @param message 輸出的訊息。
+ */
+void game_room_over_message(const GameRoom* room, GameRoomMessage* message);
+
+#endif // GAME_ROOM_H
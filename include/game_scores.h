@@ -0,0 +1,156 @@
+#ifndef GAME_SCORES_H
+#define GAME_SCORES_H
+
+// 最高分紀錄：每局結束時把成績附加到只增不改的紀錄檔，記憶體中維護查詢用的索引。
+// 紀錄檔由固定大小的檔頭與固定大小的紀錄組成 (與 GameScoreRecord 的記憶體配置相同)，
+// 每筆紀錄帶有檢查碼：寫到一半就當機時，載入會停在最後一筆完整的紀錄，並回報需要修復。
+// 壓縮只保留索引需要的紀錄 (每個網格尺寸的最佳成績，以及總排行榜)，
+// 先寫到暫存檔再以改名取代原檔，任何時刻當機都不會失去已寫入的成績。
+// 保留的紀錄最多是網格尺寸數加上 GAME_SCORES_TOP 筆，紀錄檔因此不會超過保留筆數加上 GAME_SCORES_COMPACT_MIN 左右。
+// 每局的地圖 (種子) 都不同，最佳成績不以種子分組；種子仍記錄在成績中，可用來重現該局。
+// 本模組不建立執行緒：介面層在背景執行緒呼叫載入、附加與壓縮，索引的插入與查詢都是常數或對數時間。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 常數 ]========================
+#define GAME_SCORES_MAGIC   "SHHS"        // 檔案識別碼
+#define GAME_SCORES_VERSION 1             // 格式版本，改變配置時遞增
+#define GAME_SCORES_TOP     100           // 總排行榜保留的筆數
+#define GAME_SCORES_COMPACT_MIN 4096      // 紀錄檔至少有這麼多筆不需要的紀錄才壓縮
+
+//========================[ 結構定義 ]========================
+// 一局的成績 (紀錄檔中的一筆，32位元組)
+typedef struct {
+    uint64_t seed;            // 本局的種子 (game_seed，可用 game_replay 重現同一張地圖)
+    int64_t  time;            // 結束的時間 (Unix 時間，秒)
+    int32_t  score;           // 分數
+    uint16_t width, height;   // 網格尺寸
+    uint16_t length;          // 死亡時的蛇身長度
+    uint16_t flags;           // 保留 (0)
+    uint32_t check;           // 前 28 個位元組的檢查碼 (寫入時計算)
+} GameScoreRecord;
+
+// 紀錄檔的檔頭
+typedef struct {
+    char     magic[4];        // GAME_SCORES_MAGIC
+    uint16_t version;         // GAME_SCORES_VERSION
+    uint16_t record_size;     // sizeof(GameScoreRecord)
+} GameScoreHeader;
+
+// 記憶體中的索引
+typedef struct {
+    GameScoreRecord* best;    // 每個網格尺寸的最佳成績 (開放定址雜湊表，width 為0表示空位)
+    size_t best_capacity;     // 雜湊表的大小 (2的冪次)
+    size_t best_count;        // 已使用的位置
+    GameScoreRecord top[GAME_SCORES_TOP]; // 總排行榜 (分數由高到低，同分時較早的在前)
+    int top_count;
+    // 載入與附加的統計
+    long records;             // 紀錄檔中的紀錄數 (不含損壞的部分)
+    long torn;                // 載入時在檔尾發現的不完整或損壞的位元組數
+} GameScores;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/* 索引 */
+
+/**
+ * @brief 初始化空的索引。
+ *
+ * @param scores 索引。
+ */
+void game_scores_init(GameScores* scores);
+
+/**
+ * @brief 釋放索引的記憶體。
+ *
+ * @param scores 索引。
+ */
+void game_scores_free(GameScores* scores);
+
+/**
+ * @brief 把一局的成績加入索引 (不寫入檔案)。
+ *
+ * @param scores 索引。
+ * @param record 成績。
+ * @return 在總排行榜的名次 (從1開始)；沒有進入排行榜時返回0；配置失敗時返回-1。
+ */
+int game_scores_insert(GameScores* scores, const GameScoreRecord* record);
+
+/**
+ * @brief 查詢某個網格尺寸的最佳成績。
+ *
+ * @param scores 索引。
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 最佳成績；沒有紀錄時返回NULL。
+ */
+const GameScoreRecord* game_scores_best(const GameScores* scores, int width, int height);
+
+/**
+ * @brief 取得總排行榜。
+ *
+ * @param scores 索引。
+ * @param count 輸出的筆數 (最多 GAME_SCORES_TOP)。
+ * @return 分數由高到低排序的成績。
+ */
+const GameScoreRecord* game_scores_top(const GameScores* scores, int* count);
+
+/**
+ * @brief 計算壓縮後會保留的紀錄數。
+ *
+ * @param scores 索引。
+ * @return 紀錄數。
+ */
+long game_scores_live(const GameScores* scores);
+
+
+/* 紀錄檔 */
+
+/**
+ * @brief 載入紀錄檔並加入索引。
+ *
+ * 檔案不存在時視為空的紀錄檔。檔尾不完整或檢查碼不符時停止載入，
+ * 以 scores->torn 回報損壞的位元組數 (應呼叫 game_scores_compact 修復)。
+ *
+ * @param scores 索引 (已初始化)。
+ * @param path 紀錄檔路徑。
+ * @return 成功返回true；無法讀取、檔頭錯誤或配置失敗時返回false。
+ */
+bool game_scores_load(GameScores* scores, const char* path);
+
+/**
+ * @brief 把一筆成績附加到紀錄檔 (檔案不存在時建立)。
+ *
+ * 載入時發現損壞的檔尾 (scores->torn 大於0) 時，必須先以 game_scores_compact 修復才能附加。
+ *
+ * @param path 紀錄檔路徑。
+ * @param record 成績 (檢查碼在寫入時計算)。
+ * @param sync 是否等待資料寫到磁碟後才返回。
+ * @return 成功返回true。
+ */
+bool game_scores_append(const char* path, const GameScoreRecord* record, bool sync);
+
+/**
+ * @brief 檢查紀錄檔是否值得壓縮。
+ *
+ * @param scores 索引 (records 為紀錄檔目前的紀錄數)。
+ * @return 有損壞的檔尾，或不需要的紀錄超過 GAME_SCORES_COMPACT_MIN 且超過保留的紀錄數時返回true。
+ */
+bool game_scores_should_compact(const GameScores* scores);
+
+/**
+ * @brief 以索引需要的紀錄重寫紀錄檔。
+ *
+ * 先寫到「路徑.tmp」並等待寫到磁碟，再以改名取代原檔。成功後 scores->records 更新為保留的紀錄數。
+ *
+ * @param scores 索引。
+ * @param path 紀錄檔路徑。
+ * @return 成功返回true；失敗時原檔不變。
+ */
+bool game_scores_compact(GameScores* scores, const char* path);
+
+#endif // GAME_SCORES_H
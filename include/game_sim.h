@@ -0,0 +1,212 @@
+#ifndef GAME_SIM_H
+#define GAME_SIM_H
+
+// 搜尋用的精簡遊戲狀態：整個局面放在一塊連續記憶體中 (標頭、佔用位元圖、兩條蛇的環狀緩衝區)，
+// 以 game_sim_copy (一次 memcpy) 複製，不含任何指向自身的指標。
+// 障礙物不會在一局中改變，放在多個狀態共用、有參考計數的牆層 (GameSimWalls)，複製狀態時只複製指標；
+// 需要修改牆的狀態以 game_sim_set_wall 先取得自己的副本再寫入 (寫入時複製)。
+// 規則、計時與亂數與 game_step_player / game_generate_food 相同：
+// 以 game_sim_from_state 建立後輸入相同的方向，結果與 GameState 逐步一致。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+// 格子索引以 16 位元存放，網格最多 65535 格
+#define GAME_SIM_MAX_CELLS 65535
+
+//========================[ 結構定義 ]========================
+// 共用的牆層 (唯讀，寫入時複製)
+typedef struct {
+    int refcount;             // 持有此牆層的狀態數
+    int width, height;        // 網格尺寸
+    int words;                // 位元圖的 64 位元字數
+    uint64_t bits[];          // 牆的位元圖
+} GameSimWalls;
+
+// 精簡的玩家狀態
+typedef struct {
+    uint16_t head;            // 蛇頭在環狀緩衝區中的索引
+    uint16_t length;          // 蛇身節點數
+    uint8_t  direction;       // 目前的移動方向
+    uint8_t  next_direction;  // 下一步的移動方向
+    uint8_t  alive;           // 是否存活
+    uint8_t  pad;
+    int32_t  score;           // 分數
+    int32_t  interval;        // 移動間隔 (毫秒)
+    int32_t  elapsed_ms;      // 已經過的遊戲時間 (毫秒)
+    int32_t  survival_ms;     // 死亡時的存活時間 (毫秒)
+} GameSimPlayer;
+
+// 精簡的遊戲狀態 (大小由 game_sim_size 決定，之後緊接佔用位元圖與蛇身)
+typedef struct {
+    uint32_t size;            // 整個狀態的位元組數
+    uint16_t width, height;   // 網格尺寸
+    uint16_t words;           // 佔用位元圖的 64 位元字數
+    uint8_t  player_count;    // 玩家數
+    uint8_t  slow_on_eat;     // 吃到果實是否降低速度
+    uint8_t  owns_walls;      // 是否持有牆層的參考 (複製出的狀態為借用)
+    uint8_t  pad[3];
+    uint32_t cells;           // 格子總數 (也是每條蛇環狀緩衝區的容量)
+    uint32_t food;            // 食物的格子索引
+    uint64_t rng_state;       // 亂數狀態
+    uint64_t body_hash;       // 蛇身與障礙物的雜湊 (與 GameState 的 body_hash 相同)
+    GameSimWalls* walls;      // 牆層
+    GameSimPlayer players[MAX_PLAYERS];
+    uint64_t occupied[];      // 存活的蛇佔用的格子 (之後為 MAX_PLAYERS 個 uint16_t 環狀緩衝區)
+} GameSim;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 從遊戲狀態的障礙物建立牆層的函式。
+ *
+ * @param game 遊戲狀態。
+ * @return 參考計數為1的牆層；配置失敗時返回NULL。
+ */
+GameSimWalls* game_sim_walls_from_state(const GameState* game);
+
+/**
+ * @brief 放開牆層參考的函式 (計數歸零時釋放)。
+ *
+ * @param walls 牆層 (可為NULL)。
+ */
+void game_sim_walls_release(GameSimWalls* walls);
+
+/**
+ * @brief 計算精簡狀態大小的函式。
+ *
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 位元組數；網格超過 GAME_SIM_MAX_CELLS 時返回0。
+ */
+size_t game_sim_size(int width, int height);
+
+/**
+ * @brief 從遊戲狀態建立精簡狀態的函式。
+ *
+ * 精簡狀態持有 walls 的一個參考，不再使用時以 game_sim_release 放開。
+ *
+ * @param sim 精簡狀態 (至少 game_sim_size 個位元組，8 位元組對齊)。
+ * @param game 遊戲狀態。
+ * @param walls 與遊戲狀態的障礙物相同的牆層。
+ */
+void game_sim_from_state(GameSim* sim, const GameState* game, GameSimWalls* walls);
+
+/**
+ * @brief 放開精簡狀態持有的牆層參考的函式。
+ *
+ * @param sim 精簡狀態。
+ */
+void game_sim_release(GameSim* sim);
+
+/**
+ * @brief 複製精簡狀態的函式。
+ *
+ * 只複製一次記憶體，牆層為借用：複製出的狀態不可比來源的牆層活得更久，
+ * 除非之後以 game_sim_set_wall 取得自己的牆層 (此時須以 game_sim_release 放開)。
+ *
+ * @param dst 目的地 (至少 src->size 個位元組)。
+ * @param src 來源。
+ */
+static inline void game_sim_copy(GameSim* dst, const GameSim* src)
+{
+    memcpy(dst, src, src->size);
+    dst->owns_walls = 0;
+}
+
+/**
+ * @brief 修改一個牆格的函式 (寫入時複製)。
+ *
+ * 牆層被其他狀態共用或為借用時，先複製一份屬於自己的牆層再修改。
+ *
+ * @param sim 精簡狀態。
+ * @param x X座標。
+ * @param y Y座標。
+ * @param wall 是否為牆。
+ * @return 成功返回true；配置失敗時返回false。
+ */
+bool game_sim_set_wall(GameSim* sim, int x, int y, bool wall);
+
+/**
+ * @brief 改變玩家下一步方向的函式 (規則與 game_turn 相同)。
+ *
+ * @param sim 精簡狀態。
+ * @param player 玩家索引。
+ * @param dir 新的方向。
+ */
+void game_sim_turn(GameSim* sim, int player, Direction dir);
+
+/**
+ * @brief 讓指定玩家的蛇移動一步的函式 (規則與 game_step_player 相同)。
+ *
+ * @param sim 精簡狀態。
+ * @param player 玩家索引。
+ * @return 本步發生的事件。
+ */
+GameEvent game_sim_step(GameSim* sim, int player);
+
+/**
+ * @brief 取得精簡狀態 64 位元雜湊的函式 (與 game_hash 相同)。
+ *
+ * 與建立時的遊戲狀態走相同的步驟後，雜湊與 game_hash 相等，可作為搜尋的置換表鍵。
+ * 以 game_sim_set_wall 修改的牆格不計入雜湊。
+ *
+ * @param sim 精簡狀態。
+ * @return 雜湊值。
+ */
+uint64_t game_sim_hash(const GameSim* sim);
+
+/**
+ * @brief 取得下一個移動的玩家的函式 (與 game_next_mover 相同)。
+ *
+ * @param sim 精簡狀態。
+ * @return 玩家索引；所有玩家都死亡時返回-1。
+ */
+int game_sim_next_mover(const GameSim* sim);
+
+/**
+ * @brief 計算蛇頭往指定方向前進一格後的格子索引的函式 (含邊界循環)。
+ *
+ * @param sim 精簡狀態。
+ * @param player 玩家索引。
+ * @param dir 方向。
+ * @return 格子索引。
+ */
+int game_sim_next_cell(const GameSim* sim, int player, Direction dir);
+
+/**
+ * @brief 取得蛇身第i個節點格子索引的函式 (0 為蛇頭)。
+ *
+ * @param sim 精簡狀態。
+ * @param player 玩家索引。
+ * @param i 節點索引。
+ * @return 格子索引。
+ */
+static inline int game_sim_body_at(const GameSim* sim, int player, int i)
+{
+    const uint16_t* ring = (const uint16_t*)(sim->occupied + sim->words) + (size_t)player * sim->cells;
+    int idx = sim->players[player].head + i;
+    if (idx >= (int)sim->cells) idx -= (int)sim->cells;
+    return ring[idx];
+}
+
+/**
+ * @brief 檢查格子是否被牆或存活的蛇佔用的函式。
+ *
+ * @param sim 精簡狀態。
+ * @param cell 格子索引。
+ * @return 被佔用時返回true。
+ */
+static inline bool game_sim_blocked(const GameSim* sim, int cell)
+{
+    uint64_t bit = 1ull << (cell & 63);
+    return ((sim->occupied[cell >> 6] | sim->walls->bits[cell >> 6]) & bit) != 0;
+}
+
+#endif // GAME_SIM_H
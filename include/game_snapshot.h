@@ -0,0 +1,140 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+// 快速存檔：把一局遊戲的完整狀態寫成版本化的二進位快照。
+// 檔案由固定大小的檔頭、障礙物陣列與各玩家的蛇身陣列組成，
+// 陣列的記憶體配置與 Obstacle / Point 完全相同 (小端序、32位元整數)，
+// 因此可以直接映射 (mmap) 後載入：只需檢查檔頭，再以 memcpy 整塊複製，
+// 不需要逐一解析節點。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+#define GAME_SNAPSHOT_MAGIC   "SHSN"     // 檔案識別碼
+#define GAME_SNAPSHOT_VERSION 2          // 格式版本，改變配置時遞增
+#define GAME_SNAPSHOT_ENDIAN  0x01020304u // 以原生位元組順序寫入，用來偵測不同的位元組順序
+
+//========================[ 結構定義 ]========================
+// 介面層的狀態：倒數階段與定時器剩餘時間，隨遊戲狀態一起存檔
+typedef struct {
+    int32_t mode;                             // 介面層定義的遊戲模式
+    int32_t countdown;                        // 倒數值
+    int32_t show_go;                          // 是否顯示「開始」字樣
+    int32_t started;                          // 倒數是否已結束
+    int64_t countdown_remaining_us;           // 倒數定時器的剩餘時間 (微秒)，-1 表示未啟動
+    int64_t step_remaining_us[MAX_PLAYERS];   // 各玩家移動定時器的剩餘時間 (微秒)，-1 表示未啟動
+} GameSession;
+
+// 每位玩家的固定大小紀錄 (蛇身另外存放)
+typedef struct {
+    int32_t direction;        // 目前的移動方向
+    int32_t next_direction;   // 尚未套用的玩家輸入
+    int32_t score;            // 分數
+    int32_t interval;         // 移動間隔 (毫秒)
+    int32_t alive;            // 是否存活
+    int32_t length;           // 蛇身節點數
+    int32_t death_cause;      // 死亡的原因 (GameCollision)
+    int64_t elapsed_ms;       // 已經過的遊戲時間 (毫秒)
+    int64_t survival_ms;      // 死亡時的存活時間 (毫秒)
+} GameSnapshotPlayer;
+
+// 快照檔頭，之後依序接著 obstacle_count 個 Obstacle 與各玩家的蛇身 (蛇頭在前)
+typedef struct {
+    char     magic[4];        // GAME_SNAPSHOT_MAGIC
+    uint32_t version;         // GAME_SNAPSHOT_VERSION
+    uint32_t header_size;     // sizeof(GameSnapshotHeader)
+    uint32_t endian;          // GAME_SNAPSHOT_ENDIAN
+    uint64_t total_size;      // 整個快照的位元組數
+    uint64_t rng_state;       // 亂數狀態
+    int32_t  width, height;   // 網格尺寸
+    int32_t  player_count;    // 玩家數
+    int32_t  slow_on_eat;     // 吃到果實是否降低速度
+    int32_t  food_x, food_y;  // 食物的位置
+    int32_t  obstacle_count;  // 障礙物數量
+    int32_t  winner;          // 贏家標識
+    GameSession session;      // 介面層的狀態
+    GameSnapshotPlayer players[MAX_PLAYERS];
+} GameSnapshotHeader;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 計算快照大小的函式。
+ *
+ * @param game 遊戲狀態。
+ * @return 快照需要的位元組數。
+ */
+size_t game_snapshot_size(const GameState* game);
+
+/**
+ * @brief 計算指定網格尺寸的快照最多需要多少位元組的函式。
+ *
+ * 用於預先配置固定大小的快照緩衝區 (例如回溯用的快照環)。
+ *
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 障礙物與蛇身都達到上限時的快照大小。
+ */
+size_t game_snapshot_capacity(int width, int height);
+
+/**
+ * @brief 將遊戲狀態寫入記憶體中快照的函式。
+ *
+ * 蛇身以最多兩次 memcpy 從環狀緩衝區寫出 (蛇頭在前)。
+ *
+ * @param game 遊戲狀態。
+ * @param session 介面層的狀態 (可為NULL)。
+ * @param buffer 輸出緩衝區 (須8位元組對齊)。
+ * @param capacity 緩衝區大小。
+ * @return 寫入的位元組數；緩衝區不足時返回0。
+ */
+size_t game_snapshot_write(const GameState* game, const GameSession* session,
+    void* buffer, size_t capacity);
+
+/**
+ * @brief 檢查快照是否有效的函式。
+ *
+ * 檢查檔頭與各區段的大小，以及每個障礙物與蛇身節點都在網格之內 (存活的蛇至少有一節)，
+ * 通過檢查的快照載入後不會有超出網格的座標。
+ *
+ * @param data 快照資料 (可以是映射的檔案)。
+ * @param size 資料大小。
+ * @return 有效時返回檔頭；否則返回NULL。
+ */
+const GameSnapshotHeader* game_snapshot_validate(const void* data, size_t size);
+
+/**
+ * @brief 從快照載入遊戲狀態的函式。
+ *
+ * 網格尺寸不同時會重新配置記憶體區塊；蛇身與障礙物以 memcpy 整塊複製。
+ * 快照檢查失敗時遊戲狀態不會被改變。
+ *
+ * @param game 遊戲狀態。
+ * @param session 介面層的狀態 (可為NULL)。
+ * @param data 快照資料 (可以是映射的檔案)。
+ * @param size 資料大小。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_snapshot_read(GameState* game, GameSession* session,
+    const void* data, size_t size);
+
+/**
+ * @brief 在原地載入快照的函式 (供連線對戰的回溯使用)。
+ *
+ * 不重置記憶體區塊，介面層在本局配置的資料 (例如閃爍效果) 保持有效；
+ * 網格尺寸與玩家數必須與目前這一局相同，不載入介面層的狀態。
+ * 快照檢查失敗時遊戲狀態不會被改變。
+ *
+ * @param game 遊戲狀態 (已以 game_begin 或 game_new_* 配置好蛇身與障礙物的空間)。
+ * @param data 快照資料 (以 game_snapshot_write 寫出)。
+ * @param size 資料大小。
+ * @return 成功返回true；否則返回false。
+ */
+bool game_snapshot_restore(GameState* game, const void* data, size_t size);
+
+#endif // GAME_SNAPSHOT_H
@@ -0,0 +1,185 @@
+#ifndef GAME_SPECTATE_H
+#define GAME_SPECTATE_H
+
+// 觀戰串流：把雙人模式的局面編碼成增量封包，每次移動只送出改變的部分
+// (新的蛇頭格子、移除的蛇尾數、食物的新位置、分數的變化)，並定期送出完整的關鍵影格讓中途加入的觀眾同步。
+// 編碼端只比較蛇身環狀緩衝區的蛇頭索引與長度，就能得知加入的蛇頭與移除的蛇尾，不需要在規則中加入掛鉤。
+// 封包的內容與觀眾無關：伺服器每次移動只編碼一次，所有觀眾共用同一個緩衝區。
+// 解碼端把封包套用到自己的 GameState，介面層直接以 game_draw_multi 繪製。
+//
+// 封包 (小端序，格子以 y*寬+x 的兩位元組表示，數量為 varint)：
+//   WATCH  A0 版本 房間(4) 旗標                                      觀眾 -> 伺服器，房間0表示任一
+//   KEY    A1 房間(4) 影格(4) 寬 高 玩家數 障礙物數 贏家 [x y w h]... 食物(2)
+//          每位玩家：存活|方向<<1 分數(2) 長度(2) [蛇頭(2) 往蛇尾的方向(每格2位元)]
+//   DELTA  A2 房間(4) 影格(4) 旗標(玩家1|玩家2|食物) [食物(2)]
+//          每位有變化的玩家：旗標(蛇頭|蛇尾|分數|死亡) [數量 方向(每格2位元)] [數量] [分數差(zigzag)]
+//   OVER   A3 房間(4) 影格(4) 贏家
+// 種類的值都大於 game_room 訊息的長度上限，兩者可以在同一個通訊端上區分。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+#define GAME_SPECTATE_VERSION 1
+#define GAME_SPECTATE_KEYFRAME_INTERVAL 100 // 每隔多少影格送一次關鍵影格給所有觀眾
+#define GAME_SPECTATE_WATCH_BYTES 7         // WATCH 的位元組數
+#define GAME_SPECTATE_OVER_BYTES 10         // OVER 的位元組數
+#define GAME_SPECTATE_WATCH_KEY 0x01        // WATCH 旗標：需要關鍵影格 (剛加入或偵測到遺漏)
+
+//========================[ 結構定義 ]========================
+// 封包種類
+typedef enum {
+    SPECTATE_WATCH = 0xA0,
+    SPECTATE_KEYFRAME = 0xA1,
+    SPECTATE_DELTA = 0xA2,
+    SPECTATE_OVER = 0xA3
+} GameSpectateType;
+
+// 套用封包的結果
+typedef enum {
+    SPECTATE_IGNORED = 0,     // 舊的或重複的封包
+    SPECTATE_APPLIED,         // 已套用
+    SPECTATE_GAP,             // 有遺漏的影格，等待下一個關鍵影格
+    SPECTATE_INVALID          // 格式錯誤
+} GameSpectateResult;
+
+// 編碼端記住的上一次送出的局面
+typedef struct {
+    bool primed;              // 是否已編碼過關鍵影格 (之後才能編碼增量)
+    uint32_t keyframe_at;     // 上一個關鍵影格的影格編號
+    int head[MAX_PLAYERS];    // 蛇身環狀緩衝區的蛇頭索引
+    int length[MAX_PLAYERS];  // 蛇身長度
+    Point head_cell[MAX_PLAYERS]; // 蛇頭的格子
+    int score[MAX_PLAYERS];
+    bool alive[MAX_PLAYERS];
+    Point food;
+} GameSpectateEncoder;
+
+// 觀眾端的局面
+typedef struct {
+    GameState game;           // 套用串流後的局面 (直接交給 game_draw_multi)
+    uint32_t room;            // 目前觀看的房間
+    uint32_t frame;           // 最後套用的影格
+    bool synced;              // 已套用關鍵影格且之後沒有遺漏
+    bool over;                // 已收到 OVER
+    // 統計
+    uint64_t packets, bytes;
+    uint64_t keyframes, deltas, gaps;
+} GameSpectateView;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/* 編碼 (伺服器) */
+
+/**
+ * @brief 取得關鍵影格的最大位元組數。
+ *
+ * @param width 網格寬度。
+ * @param height 網格高度。
+ * @return 位元組數。
+ */
+size_t game_spectate_keyframe_capacity(int width, int height);
+
+/**
+ * @brief 重置編碼端 (新的一局)，下一個封包必須是關鍵影格。
+ *
+ * @param enc 編碼端。
+ */
+void game_spectate_encoder_reset(GameSpectateEncoder* enc);
+
+/**
+ * @brief 檢查是否該送出定期的關鍵影格。
+ *
+ * @param enc 編碼端。
+ * @param frame 目前的影格。
+ * @return 尚未送出過關鍵影格或已超過 GAME_SPECTATE_KEYFRAME_INTERVAL 時返回true。
+ */
+bool game_spectate_keyframe_due(const GameSpectateEncoder* enc, uint32_t frame);
+
+/**
+ * @brief 編碼關鍵影格 (完整局面)，並記住這個局面。
+ *
+ * @param enc 編碼端。
+ * @param game 遊戲狀態。
+ * @param room 房間編號。
+ * @param frame 影格編號 (已完成的移動次數)。
+ * @param out 輸出。
+ * @param capacity 輸出的大小 (game_spectate_keyframe_capacity 即足夠)。
+ * @return 位元組數；空間不足時返回-1。
+ */
+int game_spectate_encode_keyframe(GameSpectateEncoder* enc, const GameState* game,
+    uint32_t room, uint32_t frame, uint8_t* out, size_t capacity);
+
+/**
+ * @brief 編碼自上一個封包以來的變化，並記住目前的局面。
+ *
+ * @param enc 編碼端。
+ * @param game 遊戲狀態。
+ * @param room 房間編號。
+ * @param frame 影格編號 (必須是上一個封包的下一個影格，觀眾以此偵測遺漏)。
+ * @param out 輸出。
+ * @param capacity 輸出的大小。
+ * @return 位元組數；無法以增量表示 (尚未送出關鍵影格、蛇頭不相鄰或空間不足) 時返回-1，應改送關鍵影格。
+ */
+int game_spectate_encode_delta(GameSpectateEncoder* enc, const GameState* game,
+    uint32_t room, uint32_t frame, uint8_t* out, size_t capacity);
+
+/**
+ * @brief 編碼對局結束。
+ *
+ * @param room 房間編號。
+ * @param frame 影格編號。
+ * @param winner 贏家 (0: 平局, 1: 玩家1, 2: 玩家2)。
+ * @param out 輸出 (至少 GAME_SPECTATE_OVER_BYTES 位元組)。
+ * @return 位元組數。
+ */
+int game_spectate_encode_over(uint32_t room, uint32_t frame, int winner, uint8_t* out);
+
+/**
+ * @brief 編碼觀看要求。
+ *
+ * @param room 房間編號 (0 表示任一)。
+ * @param flags 旗標 (GAME_SPECTATE_WATCH_KEY)。
+ * @param out 輸出 (至少 GAME_SPECTATE_WATCH_BYTES 位元組)。
+ * @return 位元組數。
+ */
+int game_spectate_encode_watch(uint32_t room, uint8_t flags, uint8_t* out);
+
+/**
+ * @brief 解碼觀看要求。
+ *
+ * @param data 資料。
+ * @param length 位元組數。
+ * @param room 輸出的房間編號。
+ * @param flags 輸出的旗標。
+ * @return 格式正確時返回true。
+ */
+bool game_spectate_decode_watch(const uint8_t* data, size_t length, uint32_t* room, uint8_t* flags);
+
+
+/* 解碼 (觀眾) */
+
+/**
+ * @brief 套用一個封包到觀眾端的局面。
+ *
+ * 關鍵影格隨時可以套用 (也用於切換房間)；增量只在影格連續時套用，否則標記為未同步直到下一個關鍵影格。
+ *
+ * @param view 觀眾端的局面 (第一次使用前須全為0)。
+ * @param data 封包。
+ * @param length 位元組數。
+ * @return 結果。
+ */
+GameSpectateResult game_spectate_apply(GameSpectateView* view, const uint8_t* data, size_t length);
+
+/**
+ * @brief 釋放觀眾端的局面。
+ *
+ * @param view 觀眾端的局面。
+ */
+void game_spectate_view_free(GameSpectateView* view);
+
+#endif // GAME_SPECTATE_H
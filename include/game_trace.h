@@ -0,0 +1,112 @@
+#ifndef GAME_TRACE_H
+#define GAME_TRACE_H
+
+// 效能追蹤：記錄遊戲迴圈中的時間區段 (移動、繪製、按鍵、倒數、音效管線)，
+// 並輸出為 Chrome / Perfetto 可讀取的 trace event JSON (chrome://tracing 或 ui.perfetto.dev)。
+// 每個執行緒第一次記錄時配置自己的環形緩衝區，寫入只由該執行緒進行，不需要鎖；
+// 緩衝區滿了就覆寫最舊的事件，因此輸出的是最近一段時間的紀錄。
+// 未啟用時 game_trace_begin 只讀取一個旗標，記錄點的成本可以忽略。
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//========================[ 常數 ]========================
+#define GAME_TRACE_DEFAULT_EVENTS (1 << 16) // 每個執行緒預設保留的事件數
+#define GAME_TRACE_NO_ARG INT32_MIN          // 事件沒有附加數值
+
+//========================[ 結構定義 ]========================
+// 一個事件：dur_ns < 0 表示瞬間事件
+typedef struct {
+    const char* category;     // 分類 (字串常數，只記錄指標)
+    const char* name;         // 名稱 (字串常數，只記錄指標)
+    int64_t start_ns;         // 開始時間 (相對於追蹤開始，奈秒)
+    int64_t dur_ns;           // 持續時間 (奈秒)
+    int32_t arg;              // 附加數值，GAME_TRACE_NO_ARG 表示沒有
+} GameTraceEvent;
+
+// 是否正在記錄 (只由 game_trace_start / game_trace_stop 修改)
+extern volatile int game_trace_enabled;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 開始記錄。
+ *
+ * 第一次呼叫時決定每個執行緒的緩衝區大小，之後再呼叫只會重新啟用記錄。
+ *
+ * @param events_per_thread 每個執行緒保留的事件數 (0 表示預設值)。
+ */
+void game_trace_start(size_t events_per_thread);
+
+/**
+ * @brief 停止記錄，已記錄的事件保留到 game_trace_shutdown。
+ */
+void game_trace_stop(void);
+
+/**
+ * @brief 取得追蹤用的單調時鐘。
+ *
+ * @return 從追蹤開始經過的奈秒數 (至少為1，0 保留給「未記錄」)。
+ */
+int64_t game_trace_now(void);
+
+/**
+ * @brief 記錄一個從 start_ns 開始、到現在結束的時間區段。
+ *
+ * @param category 分類 (必須是字串常數)。
+ * @param name 名稱 (必須是字串常數)。
+ * @param start_ns game_trace_begin 返回的開始時間。
+ * @param arg 附加數值，GAME_TRACE_NO_ARG 表示沒有。
+ */
+void game_trace_record(const char* category, const char* name, int64_t start_ns, int32_t arg);
+
+/**
+ * @brief 記錄一個瞬間事件。
+ *
+ * @param category 分類 (必須是字串常數)。
+ * @param name 名稱 (必須是字串常數)。
+ * @param arg 附加數值，GAME_TRACE_NO_ARG 表示沒有。
+ */
+void game_trace_instant(const char* category, const char* name, int32_t arg);
+
+/**
+ * @brief 設定目前執行緒在追蹤檢視器中顯示的名稱。
+ *
+ * @param name 名稱 (必須是字串常數)。
+ */
+void game_trace_thread_name(const char* name);
+
+/**
+ * @brief 把所有執行緒目前的紀錄寫成 trace event JSON。
+ *
+ * 可以在記錄中呼叫；其他執行緒在寫出期間覆寫的事件會被略過。
+ *
+ * @param path 輸出檔案路徑。
+ * @return 寫出的事件數，失敗時返回 -1。
+ */
+long game_trace_dump(const char* path);
+
+/**
+ * @brief 停止記錄並釋放所有緩衝區 (程式結束前、其他執行緒都停止後呼叫)。
+ */
+void game_trace_shutdown(void);
+
+//==============================================================
+// 記錄點
+//==============================================================
+// 開始一個區段：未啟用時返回0，對應的 game_trace_end 不做任何事
+static inline int64_t game_trace_begin(void)
+{
+    return game_trace_enabled ? game_trace_now() : 0;
+}
+
+// 結束 game_trace_begin 開始的區段
+static inline void game_trace_end(const char* category, const char* name, int64_t start_ns, int32_t arg)
+{
+    if (start_ns) game_trace_record(category, name, start_ns, arg);
+}
+
+#endif // GAME_TRACE_H
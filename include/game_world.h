@@ -0,0 +1,185 @@
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+// 無盡模式的世界：沒有邊界的單人地圖，不依賴 GTK / Cairo。
+// 世界切成固定大小的區塊，每個區塊的牆與食物只由 (種子, 區塊座標) 決定，
+// 鏡頭接近時才生成，離開很遠時移出常駐區；移出的區塊只保留已吃掉的食物 (壓縮紀錄)，
+// 再次接近時重新生成並套用。所有記憶體都在 GameWorld 之內 (固定大小，不配置)，
+// 每一步與每個畫面的工作量只與視窗大小和蛇長上限有關，與移動的距離無關。
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "game_core.h"
+
+//========================[ 常數 ]========================
+// 區塊的邊長 (格)
+#define WORLD_CHUNK_SIZE 16
+// 鏡頭的視窗 (格)，與一般模式的網格相同
+#define WORLD_VIEW_WIDTH  GRID_WIDTH
+#define WORLD_VIEW_HEIGHT GRID_HEIGHT
+// 鏡頭跟隨：蛇頭與視窗邊緣至少保持的距離 (格)
+#define WORLD_CAMERA_MARGIN_X 12
+#define WORLD_CAMERA_MARGIN_Y 6
+// 視窗外預先生成的區塊圈數，與超過多少圈才移出常駐區 (兩者的差避免在邊界來回生成)
+#define WORLD_GENERATE_MARGIN 1
+#define WORLD_KEEP_MARGIN     2
+// 常駐區塊的數量 (視窗最多跨 4x3 個區塊，加上保留的外圈為 8x7)
+#define WORLD_ACTIVE_CHUNKS 64
+// 每個區塊的牆與食物數量上限
+#define WORLD_WALLS_MAX 3
+#define WORLD_FOOD_MAX  3
+// 壓縮紀錄的雜湊表大小 (2的次方) 與紀錄數上限 (負載不超過一半)
+#define WORLD_PACKED_SLOTS 8192
+#define WORLD_PACKED_MAX   4096
+// 壓縮紀錄已滿時，從時鐘指針開始取樣的紀錄數 (丟棄其中離蛇頭最遠的一筆)
+#define WORLD_PACKED_SAMPLES 8
+// 蛇長的上限 (之後吃到食物只加分)
+#define WORLD_MAX_LENGTH 1024
+
+//========================[ 結構定義 ]========================
+// 區塊內的一面牆 (區塊內的座標，不跨越區塊的外圈)
+typedef struct {
+    uint8_t x, y;
+    uint8_t width, height;
+} WorldWall;
+
+// 常駐的區塊
+typedef struct {
+    int32_t cx, cy;               // 區塊座標
+    bool used;                    // 是否使用中
+    uint8_t wall_count;
+    uint8_t food_count;
+    uint8_t eaten;                // 已吃掉的食物 (位元遮罩)
+    WorldWall walls[WORLD_WALLS_MAX];
+    uint8_t food[WORLD_FOOD_MAX]; // 食物的格子 (區塊內的索引 y * WORLD_CHUNK_SIZE + x)
+} WorldChunk;
+
+// 不在常駐區的區塊的壓縮紀錄：牆與食物的位置由種子重新生成，只保存已吃掉的食物
+typedef struct {
+    int32_t cx, cy;
+    uint8_t eaten;                // 0 表示空位 (沒有吃過食物的區塊不需要紀錄)
+} WorldPacked;
+
+// 區塊座標的範圍 (含兩端)
+typedef struct {
+    int32_t x0, y0, x1, y1;
+} WorldRange;
+
+// 統計 (不影響規則)
+typedef struct {
+    long steps;                   // 移動次數
+    long generated;               // 生成的區塊數
+    long evicted;                 // 移出常駐區的區塊數
+    long packed;                  // 寫入壓縮紀錄的區塊數
+    long restored;                // 從壓縮紀錄還原的區塊數
+    long dropped;                 // 壓縮紀錄已滿而丟棄的區塊數 (再次接近時食物重新出現)
+    int  max_distance;            // 蛇頭離出生點最遠的距離 (格，曼哈頓距離)
+} GameWorldStats;
+
+// 無盡模式的完整狀態
+typedef struct {
+    uint64_t seed;                // 世界的種子
+    // 蛇：環狀緩衝區，索引 head 為蛇頭
+    Point body[WORLD_MAX_LENGTH];
+    int head;
+    int length;
+    Direction direction;          // 目前的移動方向
+    Direction next_direction;     // 下一步的移動方向 (玩家輸入)
+    int score;
+    int interval;                 // 移動間隔 (毫秒)
+    bool alive;
+    long elapsed_ms;              // 已經過的遊戲時間 (毫秒)
+    GameCollision death_cause;
+    // 鏡頭：視窗左上角的世界座標
+    Point camera;
+    // 常駐的區塊
+    WorldChunk chunks[WORLD_ACTIVE_CHUNKS];
+    int chunk_count;
+    int last_chunk;               // 上次找到的區塊 (蛇頭通常停留在同一個區塊)
+    WorldRange generated;         // 目前已生成的範圍
+    // 壓縮紀錄 (線性探測的雜湊表)
+    WorldPacked packed[WORLD_PACKED_SLOTS];
+    int packed_count;
+    uint32_t packed_hand;         // 丟棄時取樣的時鐘指針
+    GameWorldStats stats;
+} GameWorld;
+
+//==============================================================
+// 函式宣告
+//==============================================================
+
+/**
+ * @brief 開始新的無盡模式：清空所有區塊與紀錄，蛇出生在原點區塊的中央。
+ *
+ * @param world 世界狀態。
+ * @param seed 世界的種子 (同一個種子就是同一張地圖)。
+ */
+void game_world_new(GameWorld* world, uint64_t seed);
+
+/**
+ * @brief 改變下一步的方向，不允許直接反向。
+ *
+ * @param world 世界狀態。
+ * @param dir 新的方向。
+ */
+void game_world_turn(GameWorld* world, Direction dir);
+
+/**
+ * @brief 移動一步：檢查碰撞與食物，之後更新鏡頭與常駐的區塊。
+ *
+ * @param world 世界狀態。
+ * @return 這一步的結果。
+ */
+GameEvent game_world_step(GameWorld* world);
+
+/**
+ * @brief 判定蛇頭移動到某格時的碰撞原因。
+ *
+ * 不在常駐區的格子以種子重新生成區塊來判定 (不修改世界)。
+ *
+ * @param world 世界狀態。
+ * @param p 世界座標。
+ * @return 碰撞原因 (自撞或撞牆)。
+ */
+GameCollision game_world_collision_cause(const GameWorld* world, Point p);
+
+/**
+ * @brief 取得與視窗重疊的區塊範圍。
+ *
+ * @param world 世界狀態。
+ * @return 區塊座標的範圍。
+ */
+WorldRange game_world_visible(const GameWorld* world);
+
+/**
+ * @brief 蛇頭離出生點的距離。
+ *
+ * @param world 世界狀態。
+ * @return 曼哈頓距離 (格)。
+ */
+int game_world_distance(const GameWorld* world);
+
+/**
+ * @brief 輸出區塊與壓縮紀錄的統計。
+ *
+ * @param world 世界狀態。
+ * @param out 輸出。
+ */
+void game_world_write_stats(const GameWorld* world, FILE* out);
+
+/**
+ * @brief 取得蛇的第 i 個節點 (0 為蛇頭)。
+ *
+ * @param world 世界狀態。
+ * @param i 節點索引。
+ * @return 節點的世界座標。
+ */
+static inline Point game_world_body_at(const GameWorld* world, int i)
+{
+    int idx = world->head + i;
+    if (idx >= WORLD_MAX_LENGTH) idx -= WORLD_MAX_LENGTH;
+    return world->body[idx];
+}
+
+#endif // GAME_WORLD_H
@@ -0,0 +1,413 @@
+#ifdef GAME_ALLOC_INTERPOSE
+#define _GNU_SOURCE // memalign, valloc, pvalloc
+#endif
+#include "game_alloc.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#define ALLOC_THREAD_LOCAL __declspec(thread)
+#if defined(_DEBUG)
+#include <crtdbg.h>
+#define ALLOC_CRT_HOOK 1
+#endif
+#else
+#define ALLOC_THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef GAME_ALLOC_INTERPOSE
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include <unistd.h>
+#define ALLOC_TAGGED 1
+#endif
+
+//========================[ 全域變數 ]========================
+static volatile int alloc_enabled = 0;                              // 是否正在記錄
+static volatile int alloc_phase = ALLOC_PHASE_MENU;                 // 目前的遊戲階段
+static volatile uint64_t alloc_counts[ALLOC_SUB_COUNT][ALLOC_PHASE_COUNT][4]; // 與 GameAllocCounts 相同的順序
+static volatile uint64_t alloc_tick_allocs[ALLOC_SUB_COUNT];
+static volatile uint64_t alloc_tick_bytes = 0;
+static volatile uint64_t alloc_ticks = 0;
+static volatile uint64_t alloc_dirty_ticks = 0;
+
+static ALLOC_THREAD_LOCAL int alloc_subsystem = ALLOC_SUB_OTHER;    // 目前執行緒的子系統
+static ALLOC_THREAD_LOCAL bool alloc_in_tick = false;               // 目前執行緒是否在模擬移動之中
+static ALLOC_THREAD_LOCAL uint64_t alloc_tick_count = 0;            // 這次移動之中的配置次數
+
+static const char* const subsystem_names[ALLOC_SUB_COUNT] = { "other", "sim", "render", "audio", "ui" };
+static const char* const phase_names[ALLOC_PHASE_COUNT] = { "menu", "countdown", "playing", "game_over" };
+
+//==============================================================
+// [ 平台相關 ]
+//==============================================================
+// 計數可能由多個執行緒同時增加 (GStreamer 的串流執行緒)
+#ifdef _WIN32
+static void alloc_add(volatile uint64_t* p, uint64_t value)
+{
+    InterlockedExchangeAdd64((volatile LONG64*)p, (LONG64)value);
+}
+#else
+static void alloc_add(volatile uint64_t* p, uint64_t value)
+{
+    __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+}
+#endif
+
+#ifdef ALLOC_CRT_HOOK
+static _CRT_ALLOC_HOOK alloc_previous_hook = NULL;
+
+// 除錯版 C 執行階段的配置攔截 (不可在此配置記憶體)
+static int __cdecl alloc_crt_hook(int type, void* data, size_t size, int block,
+    long request, const unsigned char* file, int line)
+{
+    if (block != _CRT_BLOCK) { // CRT 內部的配置不計入
+        size_t old_size = (data && type != _HOOK_ALLOC) ? _msize_dbg(data, block) : 0;
+        if (type == _HOOK_ALLOC) game_alloc_record(size);
+        else if (type == _HOOK_REALLOC) {
+            game_alloc_record_free(old_size);
+            game_alloc_record(size);
+        }
+        else if (type == _HOOK_FREE && data) game_alloc_record_free(old_size);
+    }
+    return alloc_previous_hook ? alloc_previous_hook(type, data, size, block, request, file, line) : TRUE;
+}
+#endif
+
+#ifdef GAME_ALLOC_INTERPOSE
+// 以 glibc 的內部配置函式替換整個程式的配置函式。
+// 每個配置前加上標頭，記錄配置時的子系統與位元組數，釋放時計回同一個子系統
+// (例如音效管線在介面的範圍釋放)，因此各子系統的存活數不會因為跨子系統釋放而為負。
+// 對齊的配置 (memalign 系列) 也必須替換，否則 free 會讀到不存在的標頭。
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* p, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void  __libc_free(void* p);
+
+// 配置的標頭 (緊接在使用者指標之前，大小維持 malloc 的對齊)
+typedef struct {
+    uint32_t offset;          // 使用者指標與 glibc 配置起點的距離
+    uint16_t subsystem;       // 配置時的子系統
+    uint16_t recorded;        // 配置時是否正在記錄 (未記錄的配置釋放時也不計入)
+    size_t size;              // 要求的位元組數
+} AllocHeader;
+
+#define ALLOC_HEADER_SIZE 16
+typedef char alloc_check_header[(sizeof(AllocHeader) <= ALLOC_HEADER_SIZE) ? 1 : -1];
+
+static void alloc_record_free_in(int subsystem, size_t bytes);
+
+// 取得使用者指標的標頭
+static AllocHeader* alloc_header(void* p)
+{
+    return (AllocHeader*)((char*)p - ALLOC_HEADER_SIZE);
+}
+
+// 在 glibc 的配置上寫入標頭並記錄，返回使用者指標
+static void* alloc_wrap(void* base, size_t offset, size_t size)
+{
+    if (!base) return NULL;
+    char* p = (char*)base + offset;
+    AllocHeader* h = alloc_header(p);
+    h->offset = (uint32_t)offset;
+    h->subsystem = (uint16_t)alloc_subsystem;
+    h->recorded = alloc_enabled != 0;
+    h->size = size;
+    if (h->recorded) game_alloc_record(size);
+    return p;
+}
+
+// 記錄釋放 (計入配置時的子系統)
+static void alloc_unwrap(void* p)
+{
+    AllocHeader* h = alloc_header(p);
+    if (h->recorded && alloc_enabled) alloc_record_free_in(h->subsystem, h->size);
+}
+
+// 對齊的配置：使用者指標前保留一個對齊單位放標頭
+static void* alloc_aligned(size_t alignment, size_t size)
+{
+    if (alignment < ALLOC_HEADER_SIZE) alignment = ALLOC_HEADER_SIZE;
+    if ((alignment & (alignment - 1)) != 0 || alignment > UINT32_MAX || size > SIZE_MAX - alignment) {
+        errno = EINVAL;
+        return NULL;
+    }
+    return alloc_wrap(__libc_memalign(alignment, size + alignment), alignment, size);
+}
+
+void* malloc(size_t size)
+{
+    if (size > SIZE_MAX - ALLOC_HEADER_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return alloc_wrap(__libc_malloc(size + ALLOC_HEADER_SIZE), ALLOC_HEADER_SIZE, size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    if (size != 0 && n > (SIZE_MAX - ALLOC_HEADER_SIZE) / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return alloc_wrap(__libc_calloc(1, n * size + ALLOC_HEADER_SIZE), ALLOC_HEADER_SIZE, n * size);
+}
+
+void free(void* p)
+{
+    if (!p) return;
+    alloc_unwrap(p);
+    __libc_free((char*)p - alloc_header(p)->offset);
+}
+
+void* realloc(void* old, size_t size)
+{
+    if (!old) return malloc(size);
+    if (size == 0) {
+        free(old);
+        return NULL;
+    }
+    AllocHeader* h = alloc_header(old);
+    if (h->offset != ALLOC_HEADER_SIZE) {
+        // 對齊的配置：複製到一般的配置
+        void* p = malloc(size);
+        if (!p) return NULL;
+        memcpy(p, old, h->size < size ? h->size : size);
+        free(old);
+        return p;
+    }
+    if (size > SIZE_MAX - ALLOC_HEADER_SIZE) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    AllocHeader previous = *h;
+    void* base = __libc_realloc((char*)old - ALLOC_HEADER_SIZE, size + ALLOC_HEADER_SIZE);
+    if (!base) return NULL;
+    if (previous.recorded && alloc_enabled) alloc_record_free_in(previous.subsystem, previous.size);
+    return alloc_wrap(base, ALLOC_HEADER_SIZE, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = alloc_aligned(alignment, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    return alloc_aligned(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    return alloc_aligned(alignment, size);
+}
+
+void* valloc(size_t size)
+{
+    return alloc_aligned((size_t)sysconf(_SC_PAGESIZE), size);
+}
+
+void* pvalloc(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return alloc_aligned(page, (size + page - 1) & ~(page - 1));
+}
+
+// 使用者指標的可用大小就是要求的大小
+size_t malloc_usable_size(void* p)
+{
+    return p ? alloc_header(p)->size : 0;
+}
+#endif
+
+//==============================================================
+// [ 設定 ]
+//==============================================================
+// 開始記錄配置
+bool game_alloc_start(void)
+{
+    alloc_enabled = 1;
+#ifdef ALLOC_CRT_HOOK
+    if (!alloc_previous_hook) alloc_previous_hook = _CrtSetAllocHook(alloc_crt_hook);
+    return true;
+#elif defined(GAME_ALLOC_INTERPOSE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 停止記錄配置
+void game_alloc_stop(void)
+{
+    alloc_enabled = 0;
+}
+
+// 是否正在記錄
+bool game_alloc_enabled(void)
+{
+    return alloc_enabled != 0;
+}
+
+// 進入子系統的範圍
+GameAllocSubsystem game_alloc_enter(GameAllocSubsystem subsystem)
+{
+    GameAllocSubsystem previous = (GameAllocSubsystem)alloc_subsystem;
+    alloc_subsystem = subsystem;
+    return previous;
+}
+
+// 離開子系統的範圍
+void game_alloc_leave(GameAllocSubsystem previous)
+{
+    alloc_subsystem = previous;
+}
+
+// 設定目前的遊戲階段
+void game_alloc_set_phase(GameAllocPhase phase)
+{
+    alloc_phase = phase;
+}
+
+// 開始一次模擬移動
+void game_alloc_tick_begin(void)
+{
+    alloc_in_tick = true;
+    alloc_tick_count = 0;
+}
+
+// 結束一次模擬移動
+uint64_t game_alloc_tick_end(void)
+{
+    alloc_in_tick = false;
+    if (alloc_enabled) {
+        alloc_add(&alloc_ticks, 1);
+        if (alloc_tick_count > 0) alloc_add(&alloc_dirty_ticks, 1);
+    }
+    return alloc_tick_count;
+}
+
+//==============================================================
+// [ 記錄 ]
+//==============================================================
+// 記錄一次配置
+void game_alloc_record(size_t bytes)
+{
+    if (!alloc_enabled) return;
+    volatile uint64_t* c = alloc_counts[alloc_subsystem][alloc_phase];
+    alloc_add(&c[0], 1);
+    alloc_add(&c[2], bytes);
+    if (alloc_in_tick) {
+        alloc_tick_count++;
+        alloc_add(&alloc_tick_allocs[alloc_subsystem], 1);
+        alloc_add(&alloc_tick_bytes, bytes);
+    }
+}
+
+// 記錄一次釋放 (計入指定的子系統，階段為釋放當下的階段)
+static void alloc_record_free_in(int subsystem, size_t bytes)
+{
+    if (!alloc_enabled) return;
+    volatile uint64_t* c = alloc_counts[subsystem][alloc_phase];
+    alloc_add(&c[1], 1);
+    alloc_add(&c[3], bytes);
+}
+
+// 記錄一次釋放
+void game_alloc_record_free(size_t bytes)
+{
+    alloc_record_free_in(alloc_subsystem, bytes);
+}
+
+//==============================================================
+// [ 讀取與輸出 ]
+//==============================================================
+// 讀取目前的統計
+void game_alloc_read(GameAllocSnapshot* snapshot)
+{
+    for (int s = 0; s < ALLOC_SUB_COUNT; s++) {
+        for (int p = 0; p < ALLOC_PHASE_COUNT; p++) {
+            GameAllocCounts* out = &snapshot->counts[s][p];
+            out->allocs = alloc_counts[s][p][0];
+            out->frees = alloc_counts[s][p][1];
+            out->bytes = alloc_counts[s][p][2];
+            out->freed_bytes = alloc_counts[s][p][3];
+        }
+        snapshot->tick_allocs[s] = alloc_tick_allocs[s];
+    }
+    snapshot->tick_bytes = alloc_tick_bytes;
+    snapshot->ticks = alloc_ticks;
+    snapshot->dirty_ticks = alloc_dirty_ticks;
+#ifdef ALLOC_TAGGED
+    snapshot->tagged = true;
+#else
+    snapshot->tagged = false;
+#endif
+}
+
+// 取得子系統的名稱
+const char* game_alloc_subsystem_name(GameAllocSubsystem subsystem)
+{
+    return (subsystem >= 0 && subsystem < ALLOC_SUB_COUNT) ? subsystem_names[subsystem] : "unknown";
+}
+
+// 取得遊戲階段的名稱
+const char* game_alloc_phase_name(GameAllocPhase phase)
+{
+    return (phase >= 0 && phase < ALLOC_PHASE_COUNT) ? phase_names[phase] : "unknown";
+}
+
+// 輸出統計表
+void game_alloc_write(const GameAllocSnapshot* snapshot, FILE* out)
+{
+    fprintf(out, "%-7s %-10s %10s %10s %12s %12s\n", "subsys", "phase", "allocs", "frees", "bytes", "freed");
+    for (int s = 0; s < ALLOC_SUB_COUNT; s++) {
+        for (int p = 0; p < ALLOC_PHASE_COUNT; p++) {
+            const GameAllocCounts* c = &snapshot->counts[s][p];
+            if (c->allocs == 0 && c->frees == 0) continue;
+            fprintf(out, "%-7s %-10s %10llu %10llu %12llu %12llu\n", subsystem_names[s], phase_names[p],
+                (unsigned long long)c->allocs, (unsigned long long)c->frees,
+                (unsigned long long)c->bytes, (unsigned long long)c->freed_bytes);
+        }
+    }
+
+    // 存活的物件：配置與釋放的差。釋放有標頭記錄配置時的子系統時才能依子系統列出，
+    // 否則釋放以釋放當下的範圍計算，只有合計有意義
+    fputs("live:", out);
+    int64_t total_objects = 0, total_bytes = 0;
+    for (int s = 0; s < ALLOC_SUB_COUNT; s++) {
+        int64_t objects = 0, bytes = 0;
+        for (int p = 0; p < ALLOC_PHASE_COUNT; p++) {
+            const GameAllocCounts* c = &snapshot->counts[s][p];
+            objects += (int64_t)(c->allocs - c->frees);
+            bytes += (int64_t)(c->bytes - c->freed_bytes);
+        }
+        total_objects += objects;
+        total_bytes += bytes;
+        if (snapshot->tagged) {
+            fprintf(out, " %s %lld (%lld bytes)%s", subsystem_names[s], (long long)objects, (long long)bytes,
+                s + 1 < ALLOC_SUB_COUNT ? "," : "\n");
+        }
+    }
+    if (!snapshot->tagged) {
+        fprintf(out, " total %lld (%lld bytes), not split by subsystem in this build\n",
+            (long long)total_objects, (long long)total_bytes);
+    }
+
+    uint64_t tick_total = 0;
+    for (int s = 0; s < ALLOC_SUB_COUNT; s++) tick_total += snapshot->tick_allocs[s];
+    fprintf(out, "ticks: %llu, with allocations %llu (%llu allocs, %llu bytes",
+        (unsigned long long)snapshot->ticks, (unsigned long long)snapshot->dirty_ticks,
+        (unsigned long long)tick_total, (unsigned long long)snapshot->tick_bytes);
+    for (int s = 0; s < ALLOC_SUB_COUNT; s++) {
+        if (snapshot->tick_allocs[s]) {
+            fprintf(out, "; %s %llu", subsystem_names[s], (unsigned long long)snapshot->tick_allocs[s]);
+        }
+    }
+    fputs(")\n", out);
+}
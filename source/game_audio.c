@@ -0,0 +1,121 @@
+#include "game_audio.h"
+
+#include <gst/app/gstappsrc.h>
+
+//==============================================================
+// [ 回調 ]
+//==============================================================
+// appsrc 需要資料時，將剩餘的音效資料包裝成 GstBuffer 推送 (零複製)
+static void on_asset_need_data(GstElement* appsrc, guint length, gpointer data)
+{
+    GameSound* sound = (GameSound*)data;
+    gsize size = 0;
+    const guint8* bytes = g_bytes_get_data(sound->bytes, &size);
+
+    if (sound->offset >= size) {
+        GstFlowReturn ret;
+        g_signal_emit_by_name(appsrc, "end-of-stream", &ret);
+        return;
+    }
+
+    // 直接引用內嵌資源的記憶體，由 GBytes 的參考計數管理生命週期
+    GstBuffer* buf = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+        (gpointer)bytes, size, sound->offset, size - sound->offset,
+        g_bytes_ref(sound->bytes), (GDestroyNotify)g_bytes_unref);
+    GST_BUFFER_OFFSET(buf) = sound->offset;
+    sound->offset = size;
+
+    GstFlowReturn ret;
+    g_signal_emit_by_name(appsrc, "push-buffer", buf, &ret);
+    gst_buffer_unref(buf);
+}
+
+// appsrc 被要求跳轉 (例如循環播放時回到開頭)
+static gboolean on_asset_seek_data(GstElement* appsrc, guint64 offset, gpointer data)
+{
+    GameSound* sound = (GameSound*)data;
+    sound->offset = (gsize)offset;
+    return TRUE;
+}
+
+// 解碼器 pad 新增回調，用於動態連接解碼後的音頻流
+static void on_pad_added(GstElement* src, GstPad* new_pad, gpointer data)
+{
+    GstElement* audioconvert = (GstElement*)data; // 獲取 audioconvert 元件
+    GstPad* sink_pad = gst_element_get_static_pad(audioconvert, "sink"); // 獲取 sink pad
+    GstPadLinkReturn ret;
+
+    if (gst_pad_is_linked(sink_pad)) {
+        gst_object_unref(sink_pad);
+        return; // 如果已經連接，則不做任何操作
+    }
+
+    // 嘗試連接新 pad 到 audioconvert 的 sink pad
+    ret = gst_pad_link(new_pad, sink_pad);
+    if (GST_PAD_LINK_FAILED(ret)) {
+        g_printerr("Failed to link decodebin to audioconvert.\n");
+    }
+
+    gst_object_unref(sink_pad);
+}
+
+//==============================================================
+// [ 管線 ]
+//==============================================================
+// 建立音效管線
+gboolean game_audio_pipeline_new(GameSound* sound, float volume_level, GstElement* sink)
+{
+    // 創建 GStreamer 的 Pipeline 元件與必要的元件
+    GstElement* pipeline = gst_pipeline_new(NULL);
+    GstElement* appsrc = gst_element_factory_make("appsrc", "asset-source");      // 記憶體來源
+    GstElement* decodebin = gst_element_factory_make("decodebin", "decoder");      // 解碼器
+    GstElement* audioconvert = gst_element_factory_make("audioconvert", "converter"); // 音頻轉換器
+    GstElement* audioresample = gst_element_factory_make("audioresample", "resampler"); // 音頻重採樣器
+    GstElement* volume = gst_element_factory_make("volume", "volume");             // 音量控制器
+
+    if (!pipeline || !appsrc || !decodebin || !audioconvert || !audioresample || !volume || !sink) {
+        g_printerr("Failed to create GStreamer elements.\n");
+        // 尚未加入管線的元件各自釋放
+        GstElement* elements[] = { pipeline, appsrc, decodebin, audioconvert, audioresample, volume, sink };
+        for (size_t i = 0; i < G_N_ELEMENTS(elements); i++) {
+            if (elements[i]) gst_object_unref(gst_object_ref_sink(elements[i]));
+        }
+        return FALSE;
+    }
+
+    // 設置記憶體來源的屬性：以位元組為單位、可隨機存取，總長度為音效大小
+    sound->offset = 0;
+    g_object_set(G_OBJECT(appsrc),
+        "stream-type", GST_APP_STREAM_TYPE_RANDOM_ACCESS,
+        "format", GST_FORMAT_BYTES,
+        "size", (gint64)g_bytes_get_size(sound->bytes),
+        NULL);
+    g_signal_connect(appsrc, "need-data", G_CALLBACK(on_asset_need_data), sound);
+    g_signal_connect(appsrc, "seek-data", G_CALLBACK(on_asset_seek_data), sound);
+
+    // 設置音量
+    g_object_set(G_OBJECT(volume), "volume", volume_level, NULL);
+
+    // 將元素添加到 Pipeline 中 (之後由管線擁有)
+    gst_bin_add_many(GST_BIN(pipeline), appsrc, decodebin, audioconvert, audioresample, volume, sink, NULL);
+
+    // 連接 appsrc 到 decodebin
+    if (!gst_element_link(appsrc, decodebin)) {
+        g_printerr("Failed to link appsrc to decodebin.\n");
+        gst_object_unref(pipeline);
+        return FALSE;
+    }
+
+    // 連接 decodebin 的 pad 到 audioconvert
+    g_signal_connect(decodebin, "pad-added", G_CALLBACK(on_pad_added), audioconvert);
+
+    // 連接 audioconvert -> audioresample -> volume -> sink
+    if (!gst_element_link_many(audioconvert, audioresample, volume, sink, NULL)) {
+        g_printerr("Failed to link audio elements to sink.\n");
+        gst_object_unref(pipeline);
+        return FALSE;
+    }
+
+    sound->pipeline = pipeline;
+    return TRUE;
+}
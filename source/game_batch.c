@@ -0,0 +1,254 @@
+#include "game_batch.h"
+
+#include <string.h>
+
+// 每個陣列配置時保留的對齊空間
+#define BATCH_ALIGN 16
+
+// 告訴編譯器各陣列互不重疊，移動迴圈才能向量化 (MSVC 的 C 編譯器使用 __restrict)
+#if defined(_MSC_VER)
+#define BATCH_RESTRICT __restrict
+#else
+#define BATCH_RESTRICT restrict
+#endif
+
+//==============================================================
+// [ 建立 / 釋放 ]
+//==============================================================
+// 依遊戲數與網格尺寸計算需要的記憶體大小
+static size_t game_batch_size(int count, int cells)
+{
+    size_t n = (size_t)count;
+    size_t per_game = 2 * sizeof(int32_t)      // head_x, head_y
+        + 3 * sizeof(uint8_t)                  // direction, next_direction, alive
+        + 8 * sizeof(int32_t)                  // length ... elapsed_ms
+        + sizeof(uint64_t);                    // rng_state
+    size_t per_cell = sizeof(int32_t) + sizeof(uint8_t); // body, grid
+    return n * per_game + n * (size_t)cells * per_cell + 20 * BATCH_ALIGN;
+}
+
+// 建立批次模擬
+bool game_batch_init(GameBatch* batch, int count, int width, int height)
+{
+    memset(batch, 0, sizeof(*batch));
+    if (count <= 0 || width <= 0 || height <= 0) return false;
+
+    batch->count = count;
+    batch->width = width;
+    batch->height = height;
+    batch->cells = width * height;
+
+    if (!game_state_init(&batch->scratch, width, height)) return false;
+    if (!game_arena_init(&batch->arena, game_batch_size(count, batch->cells))) {
+        game_state_free(&batch->scratch);
+        return false;
+    }
+
+    GameArena* a = &batch->arena;
+    size_t n = (size_t)count;
+    batch->head_x = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->head_y = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->direction = (uint8_t*)game_arena_alloc(a, n);
+    batch->next_direction = (uint8_t*)game_arena_alloc(a, n);
+    batch->alive = (uint8_t*)game_arena_alloc(a, n);
+    batch->length = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->ring_head = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->open_cells = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->food_x = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->food_y = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->score = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->interval = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->elapsed_ms = (int32_t*)game_arena_alloc(a, n * sizeof(int32_t));
+    batch->rng_state = (uint64_t*)game_arena_alloc(a, n * sizeof(uint64_t));
+    batch->body = (int32_t*)game_arena_alloc(a, n * (size_t)batch->cells * sizeof(int32_t));
+    batch->grid = (uint8_t*)game_arena_alloc(a, n * (size_t)batch->cells);
+
+    if (a->failures > 0) {
+        game_batch_free(batch);
+        return false;
+    }
+    return true;
+}
+
+// 釋放批次模擬
+void game_batch_free(GameBatch* batch)
+{
+    game_arena_free(&batch->arena);
+    game_state_free(&batch->scratch);
+    memset(batch, 0, sizeof(*batch));
+}
+
+//==============================================================
+// [ 開局 ]
+//==============================================================
+// 重新開始所有遊戲：以 GameState 產生初始局面，再搬到陣列結構
+void game_batch_reset(GameBatch* batch, uint64_t seed)
+{
+    GameState* s = &batch->scratch;
+    int w = batch->width;
+
+    for (int g = 0; g < batch->count; g++) {
+        game_seed(s, seed + (uint64_t)g);
+        game_new_single(s);
+
+        uint8_t* grid = batch->grid + (size_t)g * batch->cells;
+        memset(grid, BATCH_CELL_EMPTY, (size_t)batch->cells);
+
+        // 標記牆 (障礙物可能重疊，以網格計算實際的牆格數)
+        int walls = 0;
+        for (int i = 0; i < s->obstacle_count; i++) {
+            const Obstacle* obs = &s->obstacles[i];
+            for (int y = obs->y; y < obs->y + obs->height; y++) {
+                for (int x = obs->x; x < obs->x + obs->width; x++) {
+                    uint8_t* c = &grid[y * w + x];
+                    if (*c != BATCH_CELL_WALL) {
+                        *c = BATCH_CELL_WALL;
+                        walls++;
+                    }
+                }
+            }
+        }
+
+        const Player* pl = &s->players[0];
+        Point head = snake_body_at(&pl->body, 0);
+        int cell = head.y * w + head.x;
+        grid[cell] = BATCH_CELL_SNAKE;
+        batch->body[(size_t)g * batch->cells] = cell;
+
+        batch->head_x[g] = head.x;
+        batch->head_y[g] = head.y;
+        batch->direction[g] = (uint8_t)pl->direction;
+        batch->next_direction[g] = (uint8_t)pl->next_direction;
+        batch->alive[g] = 1;
+        batch->length[g] = 1;
+        batch->ring_head[g] = 0;
+        batch->open_cells[g] = batch->cells - walls;
+        batch->food_x[g] = s->food.x;
+        batch->food_y[g] = s->food.y;
+        batch->score[g] = 0;
+        batch->interval[g] = pl->interval;
+        batch->elapsed_ms[g] = 0;
+        batch->rng_state[g] = s->rng_state;
+    }
+    game_clear(s);
+
+    batch->alive_count = batch->count;
+    batch->ticks = 0;
+}
+
+//==============================================================
+// [ 規則 ]
+//==============================================================
+// 改變指定遊戲下一步的方向，不允許直接反向
+void game_batch_turn(GameBatch* batch, int g, Direction dir)
+{
+    static const uint8_t opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    if (batch->next_direction[g] != opposite[dir]) {
+        batch->next_direction[g] = (uint8_t)dir;
+    }
+}
+
+// 生成食物：與 game_generate_food 使用相同的亂數序列，改以佔用網格檢查
+static bool batch_generate_food(GameBatch* batch, int g, const uint8_t* grid)
+{
+    // 蛇已填滿所有空格，沒有位置可以放食物
+    if (batch->length[g] >= batch->open_cells[g]) return false;
+
+    uint64_t* rng = &batch->rng_state[g];
+    int x, y;
+    do {
+        x = game_rng_next(rng, batch->width);
+        y = game_rng_next(rng, batch->height);
+    } while (grid[y * batch->width + x] != BATCH_CELL_EMPTY);
+    batch->food_x[g] = x;
+    batch->food_y[g] = y;
+    return true;
+}
+
+// 套用方向、移動蛇頭並處理邊界循環 (沒有分支，可跨遊戲向量化)
+static void batch_move_heads(int n, int w, int h,
+    const uint8_t* BATCH_RESTRICT alive, const uint8_t* BATCH_RESTRICT next,
+    const int32_t* BATCH_RESTRICT interval, uint8_t* BATCH_RESTRICT dir,
+    int32_t* BATCH_RESTRICT hx, int32_t* BATCH_RESTRICT hy, int32_t* BATCH_RESTRICT elapsed)
+{
+    for (int g = 0; g < n; g++) {
+        int a = alive[g];
+        int d = dir[g] + (next[g] - dir[g]) * a; // 死亡的遊戲保持原方向
+        int dx = (d == DIR_RIGHT) - (d == DIR_LEFT);
+        int dy = (d == DIR_DOWN) - (d == DIR_UP);
+        int x = hx[g] + dx * a;
+        int y = hy[g] + dy * a;
+        x += (x < 0) * w - (x >= w) * w;
+        y += (y < 0) * h - (y >= h) * h;
+        dir[g] = (uint8_t)d;
+        hx[g] = x;
+        hy[g] = y;
+        elapsed[g] += interval[g] * a;
+    }
+}
+
+// 讓所有存活的遊戲移動一步
+int game_batch_step(GameBatch* batch)
+{
+    const int n = batch->count;
+    const int w = batch->width;
+    const int h = batch->height;
+    const int cells = batch->cells;
+
+    // 第一階段：套用方向、移動蛇頭並處理邊界循環
+    int32_t* hx = batch->head_x;
+    int32_t* hy = batch->head_y;
+    batch_move_heads(n, w, h, batch->alive, batch->next_direction, batch->interval,
+        batch->direction, hx, hy, batch->elapsed_ms);
+
+    // 第二階段：碰撞、蛇身與食物 (每局只存取自己的網格與蛇身)
+    int stepped = 0;
+    for (int g = 0; g < n; g++) {
+        if (!batch->alive[g]) continue;
+        stepped++;
+
+        uint8_t* grid = batch->grid + (size_t)g * cells;
+        int32_t* body = batch->body + (size_t)g * cells;
+        int cell = hy[g] * w + hx[g];
+
+        // 撞到自己或牆 (移動前的蛇尾仍在網格上，與 game_check_collision 相同)
+        if (grid[cell] != BATCH_CELL_EMPTY) {
+            // 與 GameState 相同，死亡時蛇身不再移動，蛇頭留在原位
+            int old_head = body[batch->ring_head[g]];
+            hx[g] = old_head % w;
+            hy[g] = old_head / w;
+            batch->alive[g] = 0;
+            batch->alive_count--;
+            continue;
+        }
+
+        // 添加新的蛇頭
+        int rh = batch->ring_head[g];
+        rh = (rh == 0) ? cells - 1 : rh - 1;
+        body[rh] = cell;
+        batch->ring_head[g] = rh;
+        grid[cell] = BATCH_CELL_SNAKE;
+        batch->length[g]++;
+
+        if (hx[g] == batch->food_x[g] && hy[g] == batch->food_y[g]) {
+            batch->score[g]++;
+            if (batch->slow_on_eat && batch->interval[g] < MAX_INTERVAL) {
+                batch->interval[g] += 5;
+            }
+            if (!batch_generate_food(batch, g, grid)) {
+                batch->alive[g] = 0;
+                batch->alive_count--;
+            }
+        }
+        else {
+            // 移除蛇尾
+            int tail = rh + batch->length[g] - 1;
+            if (tail >= cells) tail -= cells;
+            grid[body[tail]] = BATCH_CELL_EMPTY;
+            batch->length[g]--;
+        }
+    }
+
+    batch->ticks += (uint64_t)stepped;
+    return batch->alive_count;
+}
@@ -0,0 +1,272 @@
+#include "game_bot.h"
+#include "game_pathfind.h"
+#include "game_mcts.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================
+// [ 共用工具 ]
+//==============================================================
+// 與各方向相反的方向
+static const Direction opposite_dir[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+
+// 計算蛇頭往指定方向前進一格後的位置 (含邊界循環)
+static Point bot_next_head(const GameState* game, int player, Direction dir)
+{
+    Point p = snake_body_at(&game->players[player].body, 0);
+    switch (dir) {
+    case DIR_UP:    p.y--; break;
+    case DIR_DOWN:  p.y++; break;
+    case DIR_LEFT:  p.x--; break;
+    case DIR_RIGHT: p.x++; break;
+    }
+    if (p.x < 0) p.x = game->width - 1;
+    else if (p.x >= game->width) p.x = 0;
+    if (p.y < 0) p.y = game->height - 1;
+    else if (p.y >= game->height) p.y = 0;
+    return p;
+}
+
+// 檢查玩家往指定方向前進是否安全
+bool game_bot_safe(const GameState* game, int player, Direction dir)
+{
+    if (dir == opposite_dir[game->players[player].next_direction]) return false;
+    return !game_check_collision(game, player, bot_next_head(game, player, dir));
+}
+
+// 電腦玩家自己的亂數 ([0, n))
+static int bot_random(GameBot* bot, int n)
+{
+    return game_rng_next(&bot->rng_state, n);
+}
+
+//==============================================================
+// [ 內建電腦玩家 ]
+//==============================================================
+// 隨機：從安全的方向中隨機選一個，約八成機率保持原方向
+static Direction bot_random_decide(const GameState* game, int player, GameBot* bot)
+{
+    Direction cur = game->players[player].next_direction;
+    if (bot_random(bot, 5) != 0 && game_bot_safe(game, player, cur)) return cur;
+
+    Direction safe[4];
+    int n = 0;
+    for (int d = 0; d < 4; d++) {
+        if (game_bot_safe(game, player, (Direction)d)) safe[n++] = (Direction)d;
+    }
+    return n > 0 ? safe[bot_random(bot, n)] : cur;
+}
+
+// 直走：快撞到時才轉向，依序嘗試左轉與右轉
+static Direction bot_straight_decide(const GameState* game, int player, GameBot* bot)
+{
+    (void)bot;
+    Direction cur = game->players[player].next_direction;
+    if (game_bot_safe(game, player, cur)) return cur;
+    for (int d = 0; d < 4; d++) {
+        if (game_bot_safe(game, player, (Direction)d)) return (Direction)d;
+    }
+    return cur;
+}
+
+// 貪婪：朝食物最近的方向前進 (考慮邊界循環)，不安全時改走其他安全的方向
+static Direction bot_greedy_decide(const GameState* game, int player, GameBot* bot)
+{
+    (void)bot;
+    const Player* pl = &game->players[player];
+    Point h = snake_body_at(&pl->body, 0);
+    int dx = game->food.x - h.x;
+    int dy = game->food.y - h.y;
+    if (dx > game->width / 2) dx -= game->width;
+    else if (dx < -game->width / 2) dx += game->width;
+    if (dy > game->height / 2) dy -= game->height;
+    else if (dy < -game->height / 2) dy += game->height;
+
+    // 先走距離較遠的軸，再走另一軸，最後保持原方向或任何安全的方向
+    Direction horiz = dx > 0 ? DIR_RIGHT : DIR_LEFT;
+    Direction vert = dy > 0 ? DIR_DOWN : DIR_UP;
+    Direction order[7];
+    int n = 0;
+    int adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;
+    if (adx >= ady) {
+        if (dx != 0) order[n++] = horiz;
+        if (dy != 0) order[n++] = vert;
+    }
+    else {
+        if (dy != 0) order[n++] = vert;
+        if (dx != 0) order[n++] = horiz;
+    }
+    order[n++] = pl->next_direction;
+    for (int d = 0; d < 4; d++) order[n++] = (Direction)d;
+
+    for (int i = 0; i < n; i++) {
+        if (game_bot_safe(game, player, order[i])) return order[i];
+    }
+    return pl->next_direction;
+}
+
+// 取得自動駕駛的距離場 (第一次使用或網格尺寸改變時才配置)，失敗時返回NULL
+static PathField* autopilot_field(GameBot* bot, const GameState* game)
+{
+    PathField* field = (PathField*)bot->data;
+
+    // 第一次使用或網格尺寸改變時才配置距離場
+    if (field && (field->width != game->width || field->height != game->height)) {
+        path_field_free(field);
+        free(field);
+        field = NULL;
+    }
+    if (!field) {
+        field = (PathField*)malloc(sizeof(PathField));
+        if (!field || !path_field_init(field, game->width, game->height)) {
+            free(field);
+            bot->data = NULL;
+            return NULL;
+        }
+        bot->data = field;
+    }
+    return field;
+}
+
+// 自動駕駛：沿距離場的最短路徑前往食物，距離場尚未涵蓋任何安全方向時改用貪婪策略
+static Direction bot_autopilot_decide(const GameState* game, int player, GameBot* bot)
+{
+    PathField* field = autopilot_field(bot, game);
+    if (!field) return bot_greedy_decide(game, player, bot);
+
+    if (bot->budget_work > 0) field->work_limit = bot->budget_work;
+    field->time_limit_us = bot->budget_us;
+    path_field_update(field, game);
+
+    Direction dir;
+    if (path_field_choose(field, game, player, &dir)) return dir;
+    return bot_greedy_decide(game, player, bot);
+}
+
+// 取得蒙地卡羅樹搜尋的搜尋器 (第一次使用或網格尺寸改變時才配置)，失敗時返回NULL
+static MctsSearch* mcts_searcher(GameBot* bot, const GameState* game)
+{
+    MctsSearch* search = (MctsSearch*)bot->data;
+
+    // 第一次使用或網格尺寸改變時才配置搜尋器
+    if (search && (search->width != game->width || search->height != game->height)) {
+        mcts_search_free(search);
+        free(search);
+        search = NULL;
+    }
+    if (!search) {
+        search = (MctsSearch*)malloc(sizeof(MctsSearch));
+        if (!search || !mcts_search_init(search, game->width, game->height, 0)) {
+            free(search);
+            bot->data = NULL;
+            return NULL;
+        }
+        bot->data = search;
+    }
+    return search;
+}
+
+// 蒙地卡羅樹搜尋：在模擬次數與時間上限內搜尋，無法搜尋時改用貪婪策略
+static Direction bot_mcts_decide(const GameState* game, int player, GameBot* bot)
+{
+    MctsSearch* search = mcts_searcher(bot, game);
+    if (!search) return bot_greedy_decide(game, player, bot);
+
+    Direction dir;
+    if (mcts_search_choose(search, game, player, &bot->rng_state, bot->budget_work, bot->budget_us, &dir)) {
+        return dir;
+    }
+    return bot_greedy_decide(game, player, bot);
+}
+
+// 建立內建電腦玩家
+bool game_bot_init(GameBot* bot, const char* name)
+{
+    memset(bot, 0, sizeof(*bot));
+    if (strcmp(name, "random") == 0) bot->decide = bot_random_decide;
+    else if (strcmp(name, "straight") == 0) bot->decide = bot_straight_decide;
+    else if (strcmp(name, "greedy") == 0) bot->decide = bot_greedy_decide;
+    else if (strcmp(name, "autopilot") == 0) bot->decide = bot_autopilot_decide;
+    else if (strcmp(name, "mcts") == 0) bot->decide = bot_mcts_decide;
+    else return false;
+    bot->name = name;
+    bot->rng_state = 1;
+    return true;
+}
+
+// 釋放電腦玩家的私有資料
+void game_bot_free(GameBot* bot)
+{
+    if (bot->decide == bot_autopilot_decide && bot->data) {
+        path_field_free((PathField*)bot->data);
+        free(bot->data);
+    }
+    else if (bot->decide == bot_mcts_decide && bot->data) {
+        mcts_search_free((MctsSearch*)bot->data);
+        free(bot->data);
+    }
+    bot->data = NULL;
+}
+
+// 開始新的一局：距離場下一次使用時重新同步
+void game_bot_reset(GameBot* bot)
+{
+    if (bot->decide == bot_autopilot_decide && bot->data) {
+        path_field_invalidate((PathField*)bot->data);
+    }
+}
+
+// 預先配置電腦玩家在這個局面需要的記憶體
+bool game_bot_prepare(GameBot* bot, const GameState* game)
+{
+    if (bot->decide == bot_autopilot_decide) return autopilot_field(bot, game) != NULL;
+    if (bot->decide == bot_mcts_decide) {
+        MctsSearch* search = mcts_searcher(bot, game);
+        return search && mcts_search_sync_walls(search, game);
+    }
+    return true;
+}
+
+//==============================================================
+// [ 無介面對戰 ]
+//==============================================================
+// 進行一場無介面雙人對戰
+GameMatchResult game_play_match(GameState* game, uint64_t seed, GameBot* bots[MAX_PLAYERS], long max_ms)
+{
+    GameMatchResult result;
+    memset(&result, 0, sizeof(result));
+
+    game_seed(game, seed);
+    game_new_multi(game);
+
+    // 電腦玩家的亂數由本場的種子衍生，與座位有關，與執行順序無關
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        bots[i]->rng_state = (seed ^ 0xD1B54A32D192ED03ull) * (2 * (uint64_t)i + 3) | 1;
+        game_bot_reset(bots[i]);
+    }
+
+    for (;;) {
+        int p = game_next_mover(game);
+        if (p < 0) break;
+        Player* pl = &game->players[p];
+        if (pl->elapsed_ms + pl->interval > max_ms) break;
+
+        game_turn(game, p, bots[p]->decide(game, p, bots[p]));
+        game_step_player(game, p);
+        result.steps++;
+    }
+
+    // 時間到時仍存活的玩家，以目前的遊戲時間作為存活時間
+    long duration = 0;
+    for (int i = 0; i < game->player_count; i++) {
+        Player* pl = &game->players[i];
+        if (pl->alive) pl->survival_ms = pl->elapsed_ms;
+        if (pl->survival_ms > duration) duration = pl->survival_ms;
+        result.score[i] = pl->score;
+        result.survival_ms[i] = pl->survival_ms;
+    }
+    result.winner = game_decide_winner(game);
+    result.duration_ms = duration;
+    return result;
+}
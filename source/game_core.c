@@ -0,0 +1,538 @@
+#include "game_core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================
+// [ 記憶體區塊 ]
+//==============================================================
+// 配置時的對齊大小
+#define ARENA_ALIGN 16
+
+// 建立記憶體區塊 (整個程式只呼叫一次 malloc)
+bool game_arena_init(GameArena* arena, size_t capacity)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->base = (unsigned char*)malloc(capacity);
+    if (!arena->base) {
+        return false;
+    }
+    arena->capacity = capacity;
+    return true;
+}
+
+// 釋放記憶體區塊
+void game_arena_free(GameArena* arena)
+{
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
+
+// 從記憶體區塊配置空間，以指標遞增的方式，不會逐一釋放
+void* game_arena_alloc(GameArena* arena, size_t size)
+{
+    size_t start = (arena->used + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+    if (start > arena->capacity || size > arena->capacity - start) {
+        arena->failures++;
+        return NULL;
+    }
+    arena->used = start + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+    arena->allocs++;
+    arena->total_allocs++;
+    return arena->base + start;
+}
+
+// 重置記憶體區塊，本局所有配置一次失效
+void game_arena_reset(GameArena* arena)
+{
+    if (arena->used == 0) return; // 沒有配置時不需要重置
+    arena->used = 0;
+    arena->allocs = 0;
+    arena->resets++;
+}
+
+//==============================================================
+// [ 蛇身環狀緩衝區 ]
+//==============================================================
+// 在玩家的蛇頭前加入新節點，同時更新蛇身雜湊
+static void snake_body_push_head(GameState* game, int player, Point p)
+{
+    SnakeBody* body = &game->players[player].body;
+    body->head = (body->head == 0) ? body->capacity - 1 : body->head - 1;
+    body->cells[body->head] = p;
+    body->length++;
+    game->body_hash ^= game_hash_key(GAME_HASH_BODY, player, (uint64_t)(p.y * game->width + p.x));
+}
+
+// 移除玩家的蛇尾，同時更新蛇身雜湊
+static void snake_body_pop_tail(GameState* game, int player)
+{
+    SnakeBody* body = &game->players[player].body;
+    if (body->length == 0) return;
+    Point t = snake_body_at(body, body->length - 1);
+    body->length--;
+    game->body_hash ^= game_hash_key(GAME_HASH_BODY, player, (uint64_t)(t.y * game->width + t.x));
+}
+
+// 檢查位置是否與蛇身重疊，從第 from 個節點開始檢查
+static bool snake_body_contains(const SnakeBody* body, Point p, int from)
+{
+    for (int i = from; i < body->length; i++) {
+        Point seg = snake_body_at(body, i);
+        if (seg.x == p.x && seg.y == p.y) return true;
+    }
+    return false;
+}
+
+//==============================================================
+// [ 遊戲狀態 ]
+//==============================================================
+// 依網格尺寸計算每局需要的記憶體大小
+static size_t game_arena_size(int width, int height)
+{
+    size_t cells = (size_t)width * (size_t)height;
+    return MAX_PLAYERS * (cells * sizeof(Point) + ARENA_ALIGN)
+        + MAX_OBSTACLES * sizeof(Obstacle) + ARENA_ALIGN
+        + GAME_ARENA_SHELL_BYTES;
+}
+
+// 初始化遊戲狀態
+bool game_state_init(GameState* game, int width, int height)
+{
+    memset(game, 0, sizeof(*game));
+    game->width = width;
+    game->height = height;
+    game_seed(game, 0); // 預設種子，介面層通常會再以時間重新設定
+    return game_arena_init(&game->arena, game_arena_size(width, height));
+}
+
+// 改變網格尺寸，必要時重新配置記憶體區塊
+bool game_state_resize(GameState* game, int width, int height)
+{
+    if (game->width == width && game->height == height && game->arena.base) {
+        return true;
+    }
+    uint64_t rng_state = game->rng_state;
+    game_arena_free(&game->arena);
+    if (!game_state_init(game, width, height)) {
+        return false;
+    }
+    game->rng_state = rng_state;
+    return true;
+}
+
+// 釋放遊戲狀態
+void game_state_free(GameState* game)
+{
+    game_arena_free(&game->arena);
+    memset(game, 0, sizeof(*game));
+}
+
+// 結束目前這一局：重置記憶體區塊與所有遊戲資料
+void game_clear(GameState* game)
+{
+    game_arena_reset(&game->arena);
+    memset(game->players, 0, sizeof(game->players));
+    game->player_count = 0;
+    game->slow_on_eat = false;
+    game->obstacles = NULL;
+    game->obstacle_count = 0;
+    game->food.x = 0;
+    game->food.y = 0;
+    game->winner = 0;
+    game->body_hash = 0;
+    game->food_spawns = 0;
+    game->food_retries = 0;
+}
+
+// 開始新的一局：從記憶體區塊切出蛇身與障礙物需要的空間
+void game_begin(GameState* game, int player_count)
+{
+    game_clear(game);
+    game->player_count = player_count;
+
+    int cells = game->width * game->height;
+    for (int i = 0; i < player_count; i++) {
+        Player* pl = &game->players[i];
+        pl->body.cells = (Point*)game_arena_alloc(&game->arena, (size_t)cells * sizeof(Point));
+        pl->body.capacity = cells;
+        pl->body.head = 0;
+        pl->body.length = 0;
+        pl->interval = START_INTERVAL;
+        pl->alive = true;
+    }
+    game->obstacles = (Obstacle*)game_arena_alloc(&game->arena, MAX_OBSTACLES * sizeof(Obstacle));
+    game->obstacle_count = 0;
+}
+
+//==============================================================
+// [ 亂數 ]
+//==============================================================
+// 設定亂數種子 (以 splitmix64 打散，避免種子為0)
+void game_seed(GameState* game, uint64_t seed)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    game->rng_state = z ? z : 0x9E3779B97F4A7C15ull;
+}
+
+// 回傳 [0, n) 範圍內的整數
+int game_random(GameState* game, int n)
+{
+    return game_rng_next(&game->rng_state, n);
+}
+
+// 隨機選擇一個方向
+static Direction random_direction(GameState* game)
+{
+    return (Direction)game_random(game, 4);
+}
+
+//==============================================================
+// [障礙物]
+//==============================================================
+// 檢查障礙物生成的位置是否有效，不與排除的位置重疊
+static bool is_obstacle_valid(int x, int y, int w, int h, const Point* excluded, int excluded_count)
+{
+    // 與蛇初始位置不要太近
+    for (int i = 0; i < excluded_count; i++) {
+        const Point* p = &excluded[i];
+        float obs_cx = x + (float)w / 2;
+        float obs_cy = y + (float)h / 2;
+        float dx = obs_cx - p->x;
+        float dy = obs_cy - p->y;
+        float dist2 = dx * dx + dy * dy;
+        if (dist2 < 16.0f) { // 距離平方小於16，表示距離小於4
+            return false;
+        }
+    }
+    return true;
+}
+
+// 分區生成障礙物，每個區域生成一定數量的障礙物
+void game_generate_obstacles(GameState* game, const Point* initial_positions, int initial_count)
+{
+    int w_grid = game->width;
+    int h_grid = game->height;
+
+    for (int zone = 0; zone < OBSTACLE_ZONES; zone++) {
+        int x_min, x_max, y_min, y_max;
+        switch (zone) {
+        case 0:
+            x_min = 0;  x_max = w_grid / 2 - 1;  y_min = 0;   y_max = h_grid / 2 - 1;
+            break;
+        case 1:
+            x_min = w_grid / 2; x_max = w_grid - 1;  y_min = 0;   y_max = h_grid / 2 - 1;
+            break;
+        case 2:
+            x_min = 0;  x_max = w_grid / 2 - 1;  y_min = h_grid / 2;  y_max = h_grid - 1;
+            break;
+        default:
+            x_min = w_grid / 2; x_max = w_grid - 1;  y_min = h_grid / 2;  y_max = h_grid - 1;
+            break;
+        }
+
+        for (int i = 0; i < OBSTACLES_PER_ZONE; i++) {
+            int attempts = 0;
+            int max_attempts = 500;
+            while (attempts < max_attempts) {
+                int w = game_random(game, 3) + 1; // 隨機寬度 1~3
+                int h = game_random(game, 3) + 1; // 隨機高度 1~3
+                if ((x_max - x_min + 1) <= w || (y_max - y_min + 1) <= h) {
+                    attempts++;
+                    continue;
+                }
+                int rx = x_min + game_random(game, (x_max - x_min + 1) - w); // 隨機X位置
+                int ry = y_min + game_random(game, (y_max - y_min + 1) - h); // 隨機Y位置
+
+                // 檢查障礙物位置是否有效
+                if (is_obstacle_valid(rx, ry, w, h, initial_positions, initial_count)) {
+                    Obstacle* obs = &game->obstacles[game->obstacle_count++];
+                    obs->x = rx;
+                    obs->y = ry;
+                    obs->width = w;
+                    obs->height = h;
+                    game->body_hash ^= game_hash_key(GAME_HASH_OBSTACLE, 0,
+                        (uint64_t)rx | (uint64_t)ry << 16 | (uint64_t)w << 32 | (uint64_t)h << 48);
+                    break;
+                }
+                attempts++;
+            }
+        }
+    }
+}
+
+//==============================================================
+// [ 開局 ]
+//==============================================================
+// 開始新的單人遊戲
+void game_new_single(GameState* game)
+{
+    game_begin(game, 1);
+    game->slow_on_eat = false;
+
+    // 蛇初始位置設置在網格中心
+    Player* pl = &game->players[0];
+    Point h = { game->width / 2, game->height / 2 };
+    snake_body_push_head(game, 0, h);
+
+    // 隨機初始方向
+    pl->direction = random_direction(game);
+    pl->next_direction = pl->direction;
+
+    // 避免障礙物生成在蛇附近
+    game_generate_obstacles(game, &h, 1);
+    game_generate_food(game);
+}
+
+// 開始新的雙人遊戲
+void game_new_multi(GameState* game)
+{
+    game_begin(game, 2);
+    game->slow_on_eat = true;
+
+    // 玩家1 初始位置設置在左側四分之一處，玩家2 在右側四分之三處
+    Point heads[2] = {
+        { game->width / 4, game->height / 2 },
+        { (game->width * 3) / 4, game->height / 2 },
+    };
+    for (int i = 0; i < 2; i++) {
+        snake_body_push_head(game, i, heads[i]);
+    }
+
+    // 隨機初始方向
+    for (int i = 0; i < 2; i++) {
+        game->players[i].direction = random_direction(game);
+        game->players[i].next_direction = game->players[i].direction;
+    }
+
+    // 避免障礙物生成在蛇附近
+    game_generate_obstacles(game, heads, 2);
+    game_generate_food(game);
+}
+
+//==============================================================
+// [ 規則 ]
+//==============================================================
+// 改變玩家下一步的方向，不允許直接反向
+void game_turn(GameState* game, int player, Direction dir)
+{
+    static const Direction opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    Player* pl = &game->players[player];
+    if (pl->next_direction != opposite[dir]) {
+        pl->next_direction = dir;
+    }
+}
+
+// 檢查位置是否在障礙物上
+bool game_hits_obstacle(const GameState* game, Point p)
+{
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        if (p.x >= obs->x && p.x < obs->x + obs->width &&
+            p.y >= obs->y && p.y < obs->y + obs->height) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 檢查蛇頭是否與自身、障礙物或其他存活的蛇發生碰撞
+bool game_check_collision(const GameState* game, int player, Point head)
+{
+    return game_collision_cause(game, player, head) != GAME_COLLISION_NONE;
+}
+
+// 判定蛇頭碰撞的原因
+GameCollision game_collision_cause(const GameState* game, int player, Point head)
+{
+    // 自撞 (不含目前的蛇頭)
+    if (snake_body_contains(&game->players[player].body, head, 1)) return GAME_COLLISION_SELF;
+    // 撞障礙物
+    if (game_hits_obstacle(game, head)) return GAME_COLLISION_OBSTACLE;
+    // 撞到另一條蛇
+    for (int i = 0; i < game->player_count; i++) {
+        if (i == player || !game->players[i].alive) continue;
+        if (snake_body_contains(&game->players[i].body, head, 0)) return GAME_COLLISION_OTHER;
+    }
+    return GAME_COLLISION_NONE;
+}
+
+// 生成食物，避開存活的蛇與障礙物
+void game_generate_food(GameState* game)
+{
+    bool valid = false;
+    game->food_spawns++;
+    while (!valid) {
+        game->food.x = game_random(game, game->width);  // 隨機X位置
+        game->food.y = game_random(game, game->height); // 隨機Y位置
+        valid = true;
+
+        // 檢查食物是否與蛇重疊
+        for (int i = 0; i < game->player_count && valid; i++) {
+            if (!game->players[i].alive) continue;
+            if (snake_body_contains(&game->players[i].body, game->food, 0)) valid = false;
+        }
+        // 檢查食物是否與障礙物重疊
+        if (valid && game_hits_obstacle(game, game->food)) {
+            valid = false;
+        }
+        if (!valid) game->food_retries++;
+    }
+}
+
+// 讓指定玩家的蛇移動一步
+GameEvent game_step_player(GameState* game, int player)
+{
+    Player* pl = &game->players[player];
+    if (!pl->alive || pl->body.length == 0) return GAME_EVENT_NONE;
+
+    // 經過一個移動間隔
+    pl->elapsed_ms += pl->interval;
+
+    // 更新方向
+    pl->direction = pl->next_direction;
+
+    // 計算新的蛇頭位置
+    Point nh = snake_body_at(&pl->body, 0);
+    switch (pl->direction) {
+    case DIR_UP:    nh.y--; break;
+    case DIR_DOWN:  nh.y++; break;
+    case DIR_LEFT:  nh.x--; break;
+    case DIR_RIGHT: nh.x++; break;
+    }
+    // 處理邊界循環
+    if (nh.x < 0) nh.x = game->width - 1;
+    else if (nh.x >= game->width) nh.x = 0;
+    if (nh.y < 0) nh.y = game->height - 1;
+    else if (nh.y >= game->height) nh.y = 0;
+
+    // 檢查碰撞
+    GameCollision cause = game_collision_cause(game, player, nh);
+    if (cause != GAME_COLLISION_NONE) {
+        pl->death_cause = cause;
+        pl->alive = false;
+        pl->survival_ms = pl->elapsed_ms;
+        return GAME_EVENT_DIED;
+    }
+
+    // 添加新的蛇頭
+    snake_body_push_head(game, player, nh);
+
+    // 檢查是否吃到食物
+    if (nh.x == game->food.x && nh.y == game->food.y) {
+        pl->score++;
+        // 降低速度 (增加移動間隔)
+        if (game->slow_on_eat && pl->interval < MAX_INTERVAL) {
+            pl->interval += 5;
+        }
+        game_generate_food(game);
+        return GAME_EVENT_ATE;
+    }
+
+    // 移除蛇尾
+    snake_body_pop_tail(game, player);
+    return GAME_EVENT_NONE;
+}
+
+// 遊戲狀態的雜湊：增量維護的蛇身雜湊加上各項純量
+uint64_t game_hash(const GameState* game)
+{
+    uint64_t h = game->body_hash;
+    h ^= game_hash_key(GAME_HASH_GAME, 0, (uint64_t)game->width | (uint64_t)game->height << 24
+        | (uint64_t)game->player_count << 48 | (uint64_t)game->slow_on_eat << 56);
+    for (int i = 0; i < game->player_count; i++) {
+        const Player* pl = &game->players[i];
+        if (pl->body.length > 0) {
+            Point hd = snake_body_at(&pl->body, 0);
+            h ^= game_hash_key(GAME_HASH_HEAD, i, (uint64_t)(hd.y * game->width + hd.x));
+        }
+        h ^= game_hash_key(GAME_HASH_PLAYER, i,
+            game_hash_pack_player(pl->direction, pl->next_direction, pl->alive, pl->interval, pl->score));
+        h ^= game_hash_key(GAME_HASH_ELAPSED, i, (uint64_t)pl->elapsed_ms);
+    }
+    h ^= game_hash_key(GAME_HASH_FOOD, 0, (uint64_t)(game->food.y * game->width + game->food.x));
+    h ^= game_hash_key(GAME_HASH_RNG, 0, game->rng_state);
+    return h;
+}
+
+// 從蛇身與障礙物重新計算蛇身雜湊
+uint64_t game_rehash(GameState* game)
+{
+    uint64_t h = 0;
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        h ^= game_hash_key(GAME_HASH_OBSTACLE, 0, (uint64_t)obs->x | (uint64_t)obs->y << 16
+            | (uint64_t)obs->width << 32 | (uint64_t)obs->height << 48);
+    }
+    for (int p = 0; p < game->player_count; p++) {
+        const SnakeBody* body = &game->players[p].body;
+        for (int i = 0; i < body->length; i++) {
+            Point c = snake_body_at(body, i);
+            h ^= game_hash_key(GAME_HASH_BODY, p, (uint64_t)(c.y * game->width + c.x));
+        }
+    }
+    game->body_hash = h;
+    return h;
+}
+
+// 判定雙人模式的勝負
+int game_decide_winner(GameState* game)
+{
+    const Player* p1 = &game->players[0];
+    const Player* p2 = &game->players[1];
+    long alive1 = game_survival_seconds(p1->survival_ms); // 以秒為單位比較存活時間
+    long alive2 = game_survival_seconds(p2->survival_ms);
+
+    // 根據分數決定勝利者
+    if (p1->score > p2->score) {
+        game->winner = 1;
+    }
+    else if (p2->score > p1->score) {
+        game->winner = 2;
+    }
+    // 分數相同，根據存活時間決定
+    else if (alive1 > alive2) {
+        game->winner = 1;
+    }
+    else if (alive2 > alive1) {
+        game->winner = 2;
+    }
+    else {
+        game->winner = 0; // 0 表示平局
+    }
+    return game->winner;
+}
+
+// 取得下一個移動的玩家
+int game_next_mover(const GameState* game)
+{
+    int next = -1;
+    long best = 0;
+    for (int i = 0; i < game->player_count; i++) {
+        const Player* pl = &game->players[i];
+        if (!pl->alive) continue;
+        long due = pl->elapsed_ms + pl->interval;
+        if (next < 0 || due < best) {
+            next = i;
+            best = due;
+        }
+    }
+    return next;
+}
+
+// 檢查是否所有玩家都已死亡
+bool game_all_dead(const GameState* game)
+{
+    for (int i = 0; i < game->player_count; i++) {
+        if (game->players[i].alive) return false;
+    }
+    return true;
+}
@@ -0,0 +1,308 @@
+#include "game_draw.h"
+
+#include <stdio.h>
+
+//==============================================================
+// [ 繪圖：蛇/牆/果實 ]
+//==============================================================
+// 繪製蛇的一個節點，包括身體和陰影
+static void draw_snake_segment(cairo_t* cr, double x, double y, double size,
+    GameDrawColor body, GameDrawColor shadow)
+{
+    // 繪製陰影
+    cairo_set_source_rgba(cr, shadow.red, shadow.green, shadow.blue, shadow.alpha);
+    double off = 2; // 偏移量，用於創建陰影效果
+    cairo_rectangle(cr, x + off, y + off, size, size);
+    cairo_fill(cr);
+
+    // 繪製蛇本體
+    cairo_set_source_rgba(cr, body.red, body.green, body.blue, body.alpha);
+    cairo_rectangle(cr, x, y, size, size);
+    cairo_fill(cr);
+}
+
+// 繪製食物，包括本體和陰影
+static void draw_food(cairo_t* cr, double x, double y, double size)
+{
+    // 繪製陰影
+    cairo_set_source_rgb(cr, 0.5, 0.0, 0.0); // 深紅色
+    cairo_rectangle(cr, x + 2, y + 2, size, size);
+    cairo_fill(cr);
+
+    // 繪製食物本體 (紅色)
+    cairo_set_source_rgb(cr, 1.0, 0.0, 0.0); // 紅色
+    cairo_rectangle(cr, x, y, size, size);
+    cairo_fill(cr);
+}
+
+// 繪製牆壁，包括本體和陰影
+static void draw_wall(cairo_t* cr, double x, double y, double w, double h)
+{
+    // 繪製陰影
+    cairo_set_source_rgb(cr, 0.2, 0.2, 0.2); // 灰色
+    cairo_rectangle(cr, x + 2, y + 2, w, h);
+    cairo_fill(cr);
+
+    // 繪製牆本體
+    cairo_set_source_rgb(cr, 0.5, 0.5, 0.5); // 較亮的灰色
+    cairo_rectangle(cr, x, y, w, h);
+    cairo_fill(cr);
+}
+
+//==============================================================
+// [ 繪製各模式 ]
+//==============================================================
+// 繪製單人模式的遊戲畫面
+void game_draw_single(cairo_t* cr, const GameState* game, const GameDrawInfo* info,
+    int width, int height, double cell_size)
+{
+    // 設置背景顏色
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1); // 深灰色
+    cairo_paint(cr);
+
+    // 繪製食物
+    draw_food(cr, game->food.x * cell_size, game->food.y * cell_size, cell_size);
+
+    // 繪製障礙物
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        draw_wall(cr, obs->x * cell_size, obs->y * cell_size,
+            obs->width * cell_size, obs->height * cell_size);
+    }
+
+    // 繪製蛇 (綠色)，死亡閃爍中隱藏時不繪製
+    GameDrawColor body_green = { 0.0,1.0,0.0,1.0 };      // 蛇身體顏色
+    GameDrawColor shadow_green = { 0.0,0.4,0.0,1.0 };    // 蛇陰影顏色
+    const SnakeBody* body = &game->players[0].body;
+    for (int i = 0; i < body->length && !info->hidden[0]; i++) {
+        Point seg = snake_body_at(body, i);
+        draw_snake_segment(cr, seg.x * cell_size, seg.y * cell_size,
+            cell_size, body_green, shadow_green);
+    }
+
+    // 繪製分數
+    cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+    // 設置字體為 "Cubic 11"
+    cairo_select_font_face(cr, "Cubic 11",
+        CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 16);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "分數: %d%s", game->players[0].score,
+        info->badge ? info->badge : "");
+    cairo_move_to(cr, 10, 25); // 設置文字位置
+    cairo_show_text(cr, buf);   // 顯示文字
+
+    // 繪製倒數
+    if (!info->started) {
+        cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+        cairo_set_font_size(cr, 40);       // 大字體
+        if (info->countdown > 0) {
+            char cbuf[8];
+            snprintf(cbuf, sizeof(cbuf), "%d", info->countdown);
+            cairo_move_to(cr, width / 2 - 20, height / 2); // 設置文字位置
+            cairo_show_text(cr, cbuf);                     // 顯示倒數數字
+        }
+        else if (info->show_go && !info->started) {
+            cairo_move_to(cr, width / 2 - 30, height / 2);
+            cairo_show_text(cr, "開始！");                   // 顯示「開始！」字樣
+        }
+    }
+}
+
+// 繪製雙人模式的遊戲畫面
+void game_draw_multi(cairo_t* cr, const GameState* game, const GameDrawInfo* info,
+    int width, int height, double cell_size)
+{
+    // 設置背景顏色
+    cairo_set_source_rgb(cr, 0.12, 0.12, 0.12); // 深灰色
+    cairo_paint(cr);
+
+    // 繪製食物
+    draw_food(cr, game->food.x * cell_size, game->food.y * cell_size, cell_size);
+
+    // 繪製障礙物
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        draw_wall(cr, obs->x * cell_size, obs->y * cell_size,
+            obs->width * cell_size, obs->height * cell_size);
+    }
+
+    // 繪製玩家1的蛇 (綠色) 與玩家2的蛇 (橘色)，死亡閃爍中隱藏時不繪製
+    GameDrawColor bodies[2] = { { 0.0,1.0,0.0,1.0 }, { 1.0,0.5,0.0,1.0 } };   // 蛇身體顏色
+    GameDrawColor shadows[2] = { { 0.0,0.4,0.0,1.0 }, { 0.4,0.2,0.0,1.0 } };  // 蛇陰影顏色
+    for (int p = 0; p < 2; p++) {
+        const SnakeBody* body = &game->players[p].body;
+        for (int i = 0; i < body->length && !info->hidden[p]; i++) {
+            Point seg = snake_body_at(body, i);
+            draw_snake_segment(cr, seg.x * cell_size, seg.y * cell_size,
+                cell_size, bodies[p], shadows[p]);
+        }
+    }
+
+    // 繪製分數
+    cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+    // 設置字體為 "Cubic 11"
+    cairo_select_font_face(cr, "Cubic 11",
+        CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 16);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "玩家1:%d   玩家2:%d%s", game->players[0].score, game->players[1].score,
+        info->badge ? info->badge : "");
+    cairo_move_to(cr, 10, 25); // 設置文字位置
+    cairo_show_text(cr, buf);   // 顯示分數
+
+    // 繪製倒數
+    if (!info->started) {
+        cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+        cairo_set_font_size(cr, 40);       // 大字體
+        if (info->countdown > 0) {
+            char cbuf[8];
+            snprintf(cbuf, sizeof(cbuf), "%d", info->countdown);
+            cairo_move_to(cr, width / 2 - 20, height / 2); // 設置文字位置
+            cairo_show_text(cr, cbuf);                     // 顯示倒數數字
+        }
+        else if (info->show_go && !info->started) {
+            cairo_move_to(cr, width / 2 - 30, height / 2);
+            cairo_show_text(cr, "開始！");                   // 顯示「開始！」字樣
+        }
+    }
+}
+
+// 繪製無盡模式的遊戲畫面 (只繪製鏡頭視窗內的區塊與蛇節點)
+void game_draw_world(cairo_t* cr, const GameWorld* world, const GameDrawInfo* info,
+    int width, int height, double cell_size)
+{
+    // 設置背景顏色
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1); // 深灰色
+    cairo_paint(cr);
+
+    // 視窗以外的部分不繪製
+    cairo_save(cr);
+    cairo_rectangle(cr, 0, 0, WORLD_VIEW_WIDTH * cell_size, WORLD_VIEW_HEIGHT * cell_size);
+    cairo_clip(cr);
+
+    // 繪製區塊邊界 (牆不會碰到邊界，這些線也是永遠暢通的通道)
+    WorldRange visible = game_world_visible(world);
+    Point cam = world->camera;
+    cairo_set_source_rgb(cr, 0.14, 0.14, 0.14);
+    cairo_set_line_width(cr, 1);
+    for (int32_t cx = visible.x0; cx <= visible.x1; cx++) {
+        double x = ((double)cx * WORLD_CHUNK_SIZE - cam.x) * cell_size + 0.5;
+        cairo_move_to(cr, x, 0);
+        cairo_line_to(cr, x, WORLD_VIEW_HEIGHT * cell_size);
+    }
+    for (int32_t cy = visible.y0; cy <= visible.y1; cy++) {
+        double y = ((double)cy * WORLD_CHUNK_SIZE - cam.y) * cell_size + 0.5;
+        cairo_move_to(cr, 0, y);
+        cairo_line_to(cr, WORLD_VIEW_WIDTH * cell_size, y);
+    }
+    cairo_stroke(cr);
+
+    // 繪製與視窗重疊的常駐區塊的障礙物與食物
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+        const WorldChunk* c = &world->chunks[i];
+        if (!c->used || c->cx < visible.x0 || c->cx > visible.x1 || c->cy < visible.y0 || c->cy > visible.y1) continue;
+        double ox = ((double)c->cx * WORLD_CHUNK_SIZE - cam.x) * cell_size;
+        double oy = ((double)c->cy * WORLD_CHUNK_SIZE - cam.y) * cell_size;
+        for (int w = 0; w < c->wall_count; w++) {
+            const WorldWall* wall = &c->walls[w];
+            draw_wall(cr, ox + wall->x * cell_size, oy + wall->y * cell_size,
+                wall->width * cell_size, wall->height * cell_size);
+        }
+        for (int f = 0; f < c->food_count; f++) {
+            if (c->eaten & (1u << f)) continue;
+            draw_food(cr, ox + (c->food[f] % WORLD_CHUNK_SIZE) * cell_size,
+                oy + (c->food[f] / WORLD_CHUNK_SIZE) * cell_size, cell_size);
+        }
+    }
+
+    // 繪製視窗內的蛇節點 (綠色)，死亡閃爍中隱藏時不繪製
+    GameDrawColor body_green = { 0.0,1.0,0.0,1.0 };      // 蛇身體顏色
+    GameDrawColor shadow_green = { 0.0,0.4,0.0,1.0 };    // 蛇陰影顏色
+    for (int i = 0; i < world->length && !info->hidden[0]; i++) {
+        Point seg = game_world_body_at(world, i);
+        int x = seg.x - cam.x, y = seg.y - cam.y;
+        if (x < 0 || x >= WORLD_VIEW_WIDTH || y < 0 || y >= WORLD_VIEW_HEIGHT) continue;
+        draw_snake_segment(cr, x * cell_size, y * cell_size, cell_size, body_green, shadow_green);
+    }
+    cairo_restore(cr);
+
+    // 繪製分數與離出生點的距離
+    cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+    // 設置字體為 "Cubic 11"
+    cairo_select_font_face(cr, "Cubic 11",
+        CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 16);
+    char buf[96];
+    snprintf(buf, sizeof(buf), "分數: %d   距離: %d%s", world->score, game_world_distance(world),
+        info->badge ? info->badge : "");
+    cairo_move_to(cr, 10, 25); // 設置文字位置
+    cairo_show_text(cr, buf);   // 顯示文字
+
+    // 繪製倒數
+    if (!info->started) {
+        cairo_set_source_rgb(cr, 1, 1, 1); // 白色
+        cairo_set_font_size(cr, 40);       // 大字體
+        if (info->countdown > 0) {
+            char cbuf[8];
+            snprintf(cbuf, sizeof(cbuf), "%d", info->countdown);
+            cairo_move_to(cr, width / 2 - 20, height / 2); // 設置文字位置
+            cairo_show_text(cr, cbuf);                     // 顯示倒數數字
+        }
+        else if (info->show_go && !info->started) {
+            cairo_move_to(cr, width / 2 - 30, height / 2);
+            cairo_show_text(cr, "開始！");                   // 顯示「開始！」字樣
+        }
+    }
+}
+
+//==============================================================
+// [ 效能疊加層 ]
+//==============================================================
+#define PERF_PANEL_WIDTH 300.0   // 疊加層的寬度
+#define PERF_LINE_HEIGHT 15.0    // 每行文字的高度
+#define PERF_GRAPH_HEIGHT 32.0   // 長條圖的高度
+#define PERF_GRAPH_BARS 128      // 長條圖的長條數
+
+// 在畫面右上角繪製效能疊加層
+void game_draw_perf(cairo_t* cr, const GamePerf* perf, int width, double budget_ms)
+{
+    char lines[GAME_PERF_MAX_LINES][GAME_PERF_LINE_BYTES];
+    int count = game_perf_format(perf, lines);
+    float frames[PERF_GRAPH_BARS];
+    int bars = game_perf_recent(perf, PERF_FRAME, frames, PERF_GRAPH_BARS);
+
+    double x = width - PERF_PANEL_WIDTH - 8;
+    double y = 8;
+    double panel_height = count * PERF_LINE_HEIGHT + PERF_GRAPH_HEIGHT + 14;
+
+    cairo_save(cr);
+    // 半透明底色
+    cairo_set_source_rgba(cr, 0, 0, 0, 0.7);
+    cairo_rectangle(cr, x, y, PERF_PANEL_WIDTH, panel_height);
+    cairo_fill(cr);
+
+    // 文字 (等寬字型，數字對齊)
+    cairo_set_source_rgb(cr, 0.8, 1.0, 0.8);
+    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 11);
+    for (int i = 0; i < count; i++) {
+        cairo_move_to(cr, x + 6, y + 4 + (i + 1) * PERF_LINE_HEIGHT - 3);
+        cairo_show_text(cr, lines[i]);
+    }
+
+    // 畫面繪製時間的長條圖，超過預算的以紅色顯示
+    double graph_y = y + count * PERF_LINE_HEIGHT + 8;
+    double bar_width = (PERF_PANEL_WIDTH - 12) / PERF_GRAPH_BARS;
+    for (int i = 0; i < bars; i++) {
+        double ratio = budget_ms > 0 ? frames[i] / budget_ms : 0.0;
+        bool over = ratio > 1.0;
+        if (over) ratio = 1.0;
+        double h = ratio * PERF_GRAPH_HEIGHT;
+        if (over) cairo_set_source_rgb(cr, 1.0, 0.3, 0.3);
+        else cairo_set_source_rgb(cr, 0.3, 0.8, 1.0);
+        cairo_rectangle(cr, x + 6 + i * bar_width, graph_y + PERF_GRAPH_HEIGHT - h, bar_width, h);
+        cairo_fill(cr);
+    }
+    cairo_restore(cr);
+}
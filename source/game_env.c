@@ -0,0 +1,200 @@
+#include "game_env.h"
+
+#include <string.h>
+
+// 每個陣列配置時保留的對齊空間
+#define ENV_ALIGN 16
+
+//==============================================================
+// [ 建立 / 釋放 ]
+//==============================================================
+// 建立一批環境
+bool game_env_init(GameEnv* env, int count, int player_count, int width, int height)
+{
+    memset(env, 0, sizeof(*env));
+    if (count <= 0 || player_count < 1 || player_count > MAX_PLAYERS || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    env->count = count;
+    env->player_count = player_count;
+    env->width = width;
+    env->height = height;
+    env->plane_words = (width * height + 63) / 64;
+    env->reward_food = 1.0f;
+    env->reward_death = -1.0f;
+
+    size_t n = (size_t)count;
+    size_t size = n * sizeof(GameState)
+        + n * (size_t)env->plane_words * sizeof(uint64_t)
+        + n * sizeof(uint32_t) + 3 * ENV_ALIGN;
+    if (!game_arena_init(&env->arena, size)) return false;
+
+    env->games = (GameState*)game_arena_alloc(&env->arena, n * sizeof(GameState));
+    env->walls = (uint64_t*)game_arena_alloc(&env->arena, n * (size_t)env->plane_words * sizeof(uint64_t));
+    env->episode = (uint32_t*)game_arena_alloc(&env->arena, n * sizeof(uint32_t));
+    if (env->arena.failures > 0) {
+        game_arena_free(&env->arena);
+        memset(env, 0, sizeof(*env));
+        return false;
+    }
+    memset(env->games, 0, n * sizeof(GameState));
+
+    for (int i = 0; i < count; i++) {
+        if (!game_state_init(&env->games[i], width, height)) {
+            game_env_free(env);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 釋放環境
+void game_env_free(GameEnv* env)
+{
+    if (env->games) {
+        for (int i = 0; i < env->count; i++) game_state_free(&env->games[i]);
+    }
+    game_arena_free(&env->arena);
+    memset(env, 0, sizeof(*env));
+}
+
+// 每位玩家觀測值的字數
+size_t game_env_obs_words(const GameEnv* env)
+{
+    return (size_t)GAME_ENV_PLANES * (size_t)env->plane_words;
+}
+
+//==============================================================
+// [ 觀測值 ]
+//==============================================================
+static inline void plane_set(uint64_t* plane, int c)
+{
+    plane[c >> 6] |= 1ull << (c & 63);
+}
+
+// 寫入環境i所有玩家的觀測平面
+static void env_write_obs(const GameEnv* env, int i, uint64_t* obs)
+{
+    const GameState* g = &env->games[i];
+    int words = env->plane_words;
+    int w = env->width;
+    uint64_t* base = obs + (size_t)i * env->player_count * game_env_obs_words(env);
+
+    for (int p = 0; p < env->player_count; p++) {
+        uint64_t* planes = base + (size_t)p * game_env_obs_words(env);
+        memcpy(planes + GAME_ENV_PLANE_WALL * words, env->walls + (size_t)i * words, (size_t)words * sizeof(uint64_t));
+        memset(planes + GAME_ENV_PLANE_OWN * words, 0, (size_t)(GAME_ENV_PLANES - 1) * words * sizeof(uint64_t));
+
+        plane_set(planes + GAME_ENV_PLANE_FOOD * words, g->food.y * w + g->food.x);
+
+        // 死亡的蛇不會再阻擋任何玩家，不寫入平面
+        for (int q = 0; q < g->player_count; q++) {
+            const Player* pl = &g->players[q];
+            if (!pl->alive) continue;
+            uint64_t* plane = planes + (q == p ? GAME_ENV_PLANE_OWN : GAME_ENV_PLANE_OTHER) * words;
+            for (int k = 0; k < pl->body.length; k++) {
+                Point s = snake_body_at(&pl->body, k);
+                plane_set(plane, s.y * w + s.x);
+            }
+            if (q == p) {
+                Point h = snake_body_at(&pl->body, 0);
+                plane_set(planes + GAME_ENV_PLANE_HEAD * words, h.y * w + h.x);
+            }
+        }
+    }
+}
+
+//==============================================================
+// [ 開局 ]
+//==============================================================
+// 以環境i目前的局數開始新的一局，並預先算好障礙物平面
+static void env_begin(GameEnv* env, int i)
+{
+    GameState* g = &env->games[i];
+    game_seed(g, env->seed + (uint64_t)i + (uint64_t)env->episode[i] * (uint64_t)env->count);
+    env->episode[i]++;
+    if (env->player_count == 1) game_new_single(g);
+    else game_new_multi(g);
+
+    uint64_t* walls = env->walls + (size_t)i * env->plane_words;
+    memset(walls, 0, (size_t)env->plane_words * sizeof(uint64_t));
+    for (int k = 0; k < g->obstacle_count; k++) {
+        const Obstacle* obs = &g->obstacles[k];
+        for (int y = obs->y; y < obs->y + obs->height; y++) {
+            for (int x = obs->x; x < obs->x + obs->width; x++) {
+                plane_set(walls, y * env->width + x);
+            }
+        }
+    }
+}
+
+// 重新開始所有環境
+void game_env_reset(GameEnv* env, uint64_t seed, uint64_t* obs)
+{
+    env->seed = seed;
+    memset(env->episode, 0, (size_t)env->count * sizeof(uint32_t));
+    for (int i = 0; i < env->count; i++) {
+        env_begin(env, i);
+        if (obs) env_write_obs(env, i, obs);
+    }
+}
+
+//==============================================================
+// [ 前進一步 ]
+//==============================================================
+// 讓所有環境前進一步
+void game_env_step(GameEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones, uint64_t* obs)
+{
+    int players = env->player_count;
+
+    for (int i = 0; i < env->count; i++) {
+        GameState* g = &env->games[i];
+        const uint8_t* act = actions + (size_t)i * players;
+        float* rew = rewards + (size_t)i * players;
+
+        // 套用動作 (與鍵盤輸入相同，不允許直接反向)
+        for (int p = 0; p < players; p++) {
+            rew[p] = 0.0f;
+            if (act[p] < GAME_ENV_NOOP && g->players[p].alive) game_turn(g, p, (Direction)act[p]);
+        }
+
+        // 找出下一個移動時刻，在該時刻到期的玩家依序移動 (與兩個定時器的觸發順序相同)
+        long due = -1;
+        for (int p = 0; p < players; p++) {
+            const Player* pl = &g->players[p];
+            long t = pl->elapsed_ms + pl->interval;
+            if (pl->alive && (due < 0 || t < due)) due = t;
+        }
+        bool movers[MAX_PLAYERS] = { false };
+        for (int p = 0; p < players; p++) {
+            const Player* pl = &g->players[p];
+            movers[p] = pl->alive && pl->elapsed_ms + pl->interval == due;
+        }
+        for (int p = 0; p < players; p++) {
+            if (!movers[p]) continue;
+            GameEvent ev = game_step_player(g, p);
+            if (ev == GAME_EVENT_ATE) rew[p] += env->reward_food;
+            else if (ev == GAME_EVENT_DIED) rew[p] += env->reward_death;
+        }
+
+        // 判斷這一局是否結束
+        uint8_t done = GAME_ENV_RUNNING;
+        if (game_all_dead(g)) done = GAME_ENV_TERMINAL;
+        else if (env->max_ms > 0) {
+            done = GAME_ENV_TRUNCATED;
+            for (int p = 0; p < players; p++) {
+                const Player* pl = &g->players[p];
+                if (pl->alive && pl->elapsed_ms + pl->interval <= env->max_ms) done = GAME_ENV_RUNNING;
+            }
+        }
+        dones[i] = done;
+
+        if (done != GAME_ENV_RUNNING) {
+            env->episodes++;
+            env_begin(env, i);
+        }
+        if (obs) env_write_obs(env, i, obs);
+    }
+    env->steps += (uint64_t)env->count;
+}
@@ -0,0 +1,192 @@
+#include "game_latency.h"
+
+#include <string.h>
+
+static const char* const mode_names[LATENCY_MODE_COUNT] = { "single", "multi", "net", "endless" };
+static const char* const stage_names[LATENCY_STAGE_COUNT] = { "queue", "tick", "frame", "total" };
+
+//==============================================================
+// [ 初始化 ]
+//==============================================================
+// 初始化空的延遲統計
+void game_latency_init(GameLatency* latency)
+{
+    memset(latency, 0, sizeof(*latency));
+}
+
+// 放棄所有在途的轉向
+void game_latency_clear_inflight(GameLatency* latency)
+{
+    memset(latency->turns, 0, sizeof(latency->turns));
+}
+
+// 把視窗系統的事件時間換算成單調時鐘
+int64_t game_latency_event_time(uint32_t event_ms, int64_t now_us, bool* ok)
+{
+    // 以32位元相減，事件時間回繞時仍得到正確的差距
+    uint32_t age_ms = (uint32_t)(now_us / 1000) - event_ms;
+    bool valid = age_ms <= 1000;
+    if (ok) *ok = valid;
+    if (!valid) return now_us;
+    return now_us - (int64_t)age_ms * 1000;
+}
+
+//==============================================================
+// [ 記錄 ]
+//==============================================================
+// 加入一個樣本 (微秒)
+static void observe(GameMetricsHistogram* hist, int64_t value)
+{
+    uint64_t v = value > 0 ? (uint64_t)value : 0;
+    hist->count++;
+    hist->sum += v;
+    if (v > hist->max) hist->max = v;
+    hist->buckets[game_metrics_bucket(v)]++;
+}
+
+// 完成一次轉向
+static void finish(GameLatency* latency, int player, GameLatencyTurn* turn, int64_t presented_us)
+{
+    // 事件時間以毫秒為單位，可能比處理時間晚一點點
+    int64_t key_us = turn->key_us < turn->handled_us ? turn->key_us : turn->handled_us;
+    GameMetricsHistogram* h = latency->histograms[turn->mode][player];
+    observe(&h[LATENCY_STAGE_QUEUE], turn->handled_us - key_us);
+    observe(&h[LATENCY_STAGE_TICK], turn->applied_us - turn->handled_us);
+    observe(&h[LATENCY_STAGE_FRAME], presented_us - turn->applied_us);
+    observe(&h[LATENCY_STAGE_TOTAL], presented_us - key_us);
+    latency->last_total_ms = (float)(presented_us - key_us) / 1000.0f;
+    turn->state = LATENCY_TURN_FREE;
+}
+
+// 記錄一個改變方向的按鍵
+void game_latency_key(GameLatency* latency, GameLatencyMode mode, int player, Direction dir,
+    int64_t key_us, int64_t handled_us)
+{
+    GameLatencyTurn* turns = latency->turns[player];
+    GameLatencyTurn* slot = NULL;
+    for (int i = 0; i < GAME_LATENCY_INFLIGHT && !slot; i++) {
+        if (turns[i].state == LATENCY_TURN_WAITING) {
+            // 移動之前又按了一次：畫面上只會出現最後一次的方向
+            latency->superseded++;
+            slot = &turns[i];
+        }
+    }
+    for (int i = 0; i < GAME_LATENCY_INFLIGHT && !slot; i++) {
+        if (turns[i].state == LATENCY_TURN_FREE) slot = &turns[i];
+    }
+    if (!slot) {
+        latency->lost++;
+        return;
+    }
+    slot->state = LATENCY_TURN_WAITING;
+    slot->mode = mode;
+    slot->dir = dir;
+    slot->key_us = key_us;
+    slot->handled_us = handled_us;
+}
+
+// 一位玩家移動之後，蛇頭朝向等待中的方向時記為已套用
+void game_latency_tick(GameLatency* latency, const GameState* game, int player, int64_t now_us)
+{
+    game_latency_tick_direction(latency, player, game->players[player].direction, now_us);
+}
+
+// 同上，直接以移動後的方向比對
+void game_latency_tick_direction(GameLatency* latency, int player, Direction direction, int64_t now_us)
+{
+    GameLatencyTurn* turns = latency->turns[player];
+    for (int i = 0; i < GAME_LATENCY_INFLIGHT; i++) {
+        GameLatencyTurn* turn = &turns[i];
+        if (turn->state != LATENCY_TURN_WAITING) continue;
+        if (direction == turn->dir) {
+            turn->state = LATENCY_TURN_APPLIED;
+            turn->applied_us = now_us;
+        }
+        // 網路模式的輸入在延遲數格之後才套用，之前的移動仍是舊的方向；太久沒有套用時放棄
+        else if (now_us - turn->handled_us > GAME_LATENCY_TIMEOUT_US) {
+            turn->state = LATENCY_TURN_FREE;
+            latency->lost++;
+        }
+    }
+}
+
+// 繪製一個畫面之後，已套用的轉向記為在這個畫面繪製
+void game_latency_frame(GameLatency* latency, int64_t frame, int64_t drawn_us)
+{
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int i = 0; i < GAME_LATENCY_INFLIGHT; i++) {
+            GameLatencyTurn* turn = &latency->turns[p][i];
+            if (turn->state != LATENCY_TURN_APPLIED) continue;
+            turn->state = LATENCY_TURN_DRAWN;
+            turn->frame = frame;
+            turn->drawn_us = drawn_us;
+        }
+    }
+}
+
+// 取得等待呈現的最舊畫面編號
+int64_t game_latency_oldest_frame(const GameLatency* latency)
+{
+    int64_t oldest = -1;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int i = 0; i < GAME_LATENCY_INFLIGHT; i++) {
+            const GameLatencyTurn* turn = &latency->turns[p][i];
+            if (turn->state == LATENCY_TURN_DRAWN && (oldest < 0 || turn->frame < oldest)) oldest = turn->frame;
+        }
+    }
+    return oldest;
+}
+
+// 記錄一個畫面的呈現時間，完成在這個畫面繪製的轉向
+int game_latency_present(GameLatency* latency, int64_t frame, int64_t presented_us)
+{
+    int done = 0;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        for (int i = 0; i < GAME_LATENCY_INFLIGHT; i++) {
+            GameLatencyTurn* turn = &latency->turns[p][i];
+            if (turn->state != LATENCY_TURN_DRAWN || turn->frame != frame) continue;
+            // 呈現時間不明 (或早於繪製完成，表示時鐘不可靠) 時以繪製完成的時間代替
+            finish(latency, p, turn, presented_us >= turn->drawn_us ? presented_us : turn->drawn_us);
+            done++;
+        }
+    }
+    return done;
+}
+
+//==============================================================
+// [ 輸出 ]
+//==============================================================
+// 取得模式的名稱
+const char* game_latency_mode_name(GameLatencyMode mode)
+{
+    return (mode >= 0 && mode < LATENCY_MODE_COUNT) ? mode_names[mode] : "unknown";
+}
+
+// 取得區段的名稱
+const char* game_latency_stage_name(GameLatencyStage stage)
+{
+    return (stage >= 0 && stage < LATENCY_STAGE_COUNT) ? stage_names[stage] : "unknown";
+}
+
+// 輸出每個模式與玩家的百分位數表 (毫秒)
+void game_latency_write(const GameLatency* latency, FILE* out)
+{
+    fprintf(out, "%-7s %6s %-6s %7s %8s %8s %8s %8s\n",
+        "mode", "player", "stage", "count", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (int m = 0; m < LATENCY_MODE_COUNT; m++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            const GameMetricsHistogram* h = latency->histograms[m][p];
+            if (h[LATENCY_STAGE_TOTAL].count == 0) continue;
+            for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+                fprintf(out, "%-7s %6d %-6s %7llu %8.2f %8.2f %8.2f %8.2f\n",
+                    mode_names[m], p + 1, stage_names[s], (unsigned long long)h[s].count,
+                    game_metrics_percentile(&h[s], 0.50) / 1000.0,
+                    game_metrics_percentile(&h[s], 0.90) / 1000.0,
+                    game_metrics_percentile(&h[s], 0.99) / 1000.0,
+                    h[s].max / 1000.0);
+            }
+        }
+    }
+    fprintf(out, "superseded %ld, lost %ld, unstamped %ld\n",
+        latency->superseded, latency->lost, latency->unstamped);
+}
@@ -0,0 +1,591 @@
+#include "game_lockstep.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "game_snapshot.h"
+
+// 封包種類與旗標
+#define PACKET_HELLO  0x01
+#define PACKET_INPUT  0x02
+#define PACKET_TYPE   0x0F
+#define FLAG_TIMING   0x10   // 帶有往返時間的時間戳
+#define FLAG_CHECK    0x20   // 帶有檢查點的局面雜湊
+#define FLAG_ECHO     0x40   // 時間戳的回應有效
+
+// 重送 (尚未知道往返時間時) 與保持連線的間隔 (毫秒)
+#define HELLO_INTERVAL_MS  100.0
+#define RESEND_INTERVAL_MS 30.0
+#define IDLE_INTERVAL_MS   100.0
+// 收到新的輸入後，確認最多等待的時間 (毫秒)：下一次移動在這之內時由該次的輸入封包帶著確認，
+// 否則立即送出只有確認的封包；重送的等待時間要包含這一段。
+// 兩位玩家以相同間隔同時移動，輸入成對送出，取一個移動間隔才不會每對之間都多一個確認封包
+#define ACK_DELAY_MS       ((double)START_INTERVAL)
+// 每隔幾個封包帶一次時間戳
+#define TIMING_EVERY 8
+// HELLO 延遲欄位中表示回溯模式的位元
+#define HELLO_ROLLBACK 0x80
+
+//==============================================================
+// [ 編碼 ]
+//==============================================================
+static void put_u16(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint32_t get_u16(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+// 以最接近 expected 的方式還原只傳低16位元的格數
+static long unwrap_frame(long expected, uint32_t low)
+{
+    return expected + (int16_t)(uint16_t)(low - (uint32_t)expected);
+}
+
+//==============================================================
+// [ 對局 ]
+//==============================================================
+// 準備一局網路對戰
+void game_lockstep_init(GameLockstep* ls, GameState* game, int local, int delay, uint64_t seed, uint8_t match)
+{
+    GameReplay* record = ls->record;
+    int rollback_frames = ls->rollback_frames;
+    unsigned char* snapshots = ls->snapshots;
+    size_t snapshot_stride = ls->snapshot_stride;
+    memset(ls, 0, sizeof(*ls));
+    ls->game = game;
+    ls->record = record;
+    ls->rollback_frames = rollback_frames;
+    ls->snapshots = snapshots;
+    ls->snapshot_stride = snapshot_stride;
+    ls->local = local ? 1 : 0;
+    ls->delay = delay < 0 ? 0 : (delay > GAME_LOCKSTEP_MAX_DELAY ? GAME_LOCKSTEP_MAX_DELAY : delay);
+    ls->seed = seed;
+    ls->match = match;
+    ls->phase = LOCKSTEP_CONNECTING;
+    ls->last_send_ms = -1e9;
+    ls->pending_check_frame = -1;
+    ls->rollback_from = -1;
+    ls->stats.desync_frame = -1;
+}
+
+// 切換回溯模式
+bool game_lockstep_set_rollback(GameLockstep* ls, int frames)
+{
+    if (frames <= 0) {
+        game_lockstep_free(ls);
+        return true;
+    }
+    if (frames > GAME_LOCKSTEP_MAX_ROLLBACK) frames = GAME_LOCKSTEP_MAX_ROLLBACK;
+
+    // 每個快照之前放 8 位元組的格數，整個位置保持 8 位元組對齊
+    size_t stride = (sizeof(int64_t) + game_snapshot_capacity(ls->game->width, ls->game->height) + 7) & ~(size_t)7;
+    if (!ls->snapshots || stride != ls->snapshot_stride || frames != ls->rollback_frames) {
+        unsigned char* snapshots = (unsigned char*)malloc(stride * (size_t)frames);
+        if (!snapshots) return false;
+        free(ls->snapshots);
+        ls->snapshots = snapshots;
+    }
+    ls->snapshot_stride = stride;
+    ls->rollback_frames = frames;
+    return true;
+}
+
+// 釋放快照環
+void game_lockstep_free(GameLockstep* ls)
+{
+    free(ls->snapshots);
+    ls->snapshots = NULL;
+    ls->snapshot_stride = 0;
+    ls->rollback_frames = 0;
+}
+
+// 兩端輸入都已確認的移動次數
+long game_lockstep_confirmed(const GameLockstep* ls)
+{
+    return ls->frame < ls->remote_count ? ls->frame : ls->remote_count;
+}
+
+// 這一格還不能模擬：確定性同步需要對方的輸入，回溯模式最多以預測領先 rollback_frames 格
+static bool lockstep_blocked(const GameLockstep* ls)
+{
+    return ls->frame - ls->remote_count >= (long)ls->rollback_frames;
+}
+
+// 快照環中存放第 frame 格之前局面的位置
+static unsigned char* lockstep_snapshot(const GameLockstep* ls, long frame)
+{
+    return ls->snapshots + (size_t)(frame % ls->rollback_frames) * ls->snapshot_stride;
+}
+
+// 兩端都收到對方的 HELLO 後開始對局：前 delay 格沒有輸入
+static void lockstep_start(GameLockstep* ls, double now_ms)
+{
+    GameState* game = ls->game;
+    game_seed(game, ls->seed);
+    game_new_multi(game);
+
+    // 確定性同步至少延遲一格，否則兩端都在等對方還沒產生的輸入
+    if (ls->rollback_frames == 0 && ls->delay < 1) ls->delay = 1;
+    ls->phase = LOCKSTEP_RUNNING;
+    ls->frame = ls->simulated = 0;
+    ls->local_count = ls->remote_count = ls->remote_acked = ls->sent_count = ls->delay;
+    memset(ls->inputs, GAME_LOCKSTEP_NO_INPUT, sizeof(ls->inputs));
+    ls->local_dir = game->players[ls->local].direction;
+    ls->origin_ms = now_ms;
+    ls->stalled = false;
+    ls->check_sent = 0;
+    ls->pending_check_frame = -1;
+    ls->rollback_from = -1;
+
+    if (ls->record) {
+        ls->record->width = game->width;
+        ls->record->height = game->height;
+        ls->record->player_count = game->player_count;
+        ls->record->seed = ls->seed;
+        ls->record->steps = 0;
+        ls->record->input_count = 0;
+    }
+}
+
+// 設定本機玩家目前的方向
+void game_lockstep_set_input(GameLockstep* ls, Direction dir)
+{
+    ls->local_dir = dir;
+}
+
+// 讓遊戲時間停止
+void game_lockstep_hold(GameLockstep* ls, double ms)
+{
+    ls->origin_ms += ms;
+}
+
+// 比對對方送來的檢查點雜湊
+static void lockstep_compare(GameLockstep* ls, long check_frame, uint32_t hash)
+{
+    if (check_frame <= 0 || check_frame % GAME_LOCKSTEP_CHECK_EVERY != 0) return;
+    if (check_frame > game_lockstep_confirmed(ls) || (ls->rollback_from >= 0 && check_frame > ls->rollback_from)) {
+        // 對方領先 (或本機在該格的局面還可能回溯)，等本機確認該格再比對
+        ls->pending_check_frame = check_frame;
+        ls->pending_check = hash;
+        return;
+    }
+    if (ls->frame - check_frame >= (long)GAME_LOCKSTEP_CHECK_EVERY * GAME_LOCKSTEP_CHECKS) return; // 已不在保留範圍
+    if (ls->checks[(check_frame / GAME_LOCKSTEP_CHECK_EVERY) % GAME_LOCKSTEP_CHECKS] != hash) {
+        ls->phase = LOCKSTEP_DESYNC;
+        ls->stats.desync_frame = check_frame;
+    }
+}
+
+// 比對先前暫存的檢查點
+static void lockstep_compare_pending(GameLockstep* ls)
+{
+    long check_frame = ls->pending_check_frame;
+    if (check_frame < 0 || check_frame > game_lockstep_confirmed(ls)) return;
+    if (ls->rollback_from >= 0 && check_frame > ls->rollback_from) return;
+    ls->pending_check_frame = -1;
+    lockstep_compare(ls, check_frame, ls->pending_check);
+}
+
+// 畫面上看得到的部分 (蛇身、食物、分數與存活) 的雜湊，用來判斷回溯是否改變了畫面
+static uint64_t lockstep_visual_hash(const GameState* game)
+{
+    uint64_t hash = game->body_hash
+        ^ game_hash_key(GAME_HASH_FOOD, 0, (uint64_t)(game->food.y * game->width + game->food.x));
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        hash ^= game_hash_key(GAME_HASH_PLAYER, p, (uint64_t)(uint32_t)pl->score | (uint64_t)pl->alive << 32);
+    }
+    return hash;
+}
+
+// 套用第 frame 格的輸入並讓 mover 移動一步 (推進與重新模擬共用)
+static GameEvent lockstep_step(GameLockstep* ls, int mover)
+{
+    GameState* game = ls->game;
+    int remote = 1 - ls->local;
+    int slot = (int)(ls->frame % GAME_LOCKSTEP_WINDOW);
+    bool predicted = ls->frame >= ls->remote_count;
+    if (predicted) {
+        // 對方的輸入還沒到：先存下這一格之前的局面，再假設對方的方向不變
+        unsigned char* snapshot = lockstep_snapshot(ls, ls->frame);
+        *(int64_t*)snapshot = ls->frame;
+        game_snapshot_write(game, NULL, snapshot + sizeof(int64_t), ls->snapshot_stride - sizeof(int64_t));
+        ls->predicted[slot] = ls->remote_count > 0
+            ? ls->inputs[remote][(ls->remote_count - 1) % GAME_LOCKSTEP_WINDOW] : GAME_LOCKSTEP_NO_INPUT;
+        if (ls->frame >= ls->simulated) ls->stats.predicted_frames++;
+    }
+
+    // 套用兩位玩家在這一格的輸入
+    for (int p = 0; p < game->player_count; p++) {
+        uint8_t dir = (p == remote && predicted) ? ls->predicted[slot] : ls->inputs[p][slot];
+        if (dir == GAME_LOCKSTEP_NO_INPUT) continue;
+        if (ls->record && (Direction)dir != game->players[p].next_direction) {
+            game_replay_add(ls->record, ls->frame, p, (Direction)dir);
+        }
+        game_turn(game, p, (Direction)dir);
+    }
+
+    GameEvent e = game_step_player(game, mover);
+    ls->frame++;
+    if (ls->frame > ls->simulated) ls->simulated = ls->frame;
+    if (ls->record) ls->record->steps = ls->frame;
+
+    // 檢查點：記錄局面雜湊 (回溯重新模擬時覆寫)
+    if (ls->frame % GAME_LOCKSTEP_CHECK_EVERY == 0) {
+        ls->checks[(ls->frame / GAME_LOCKSTEP_CHECK_EVERY) % GAME_LOCKSTEP_CHECKS] = (uint32_t)game_hash(game);
+    }
+    return e;
+}
+
+// 處理待處理的回溯
+void game_lockstep_reconcile(GameLockstep* ls)
+{
+    if (ls->rollback_from < 0 || ls->phase != LOCKSTEP_RUNNING) return;
+    long from = ls->rollback_from;
+    long target = ls->frame;
+    ls->rollback_from = -1;
+
+    // 回到預測錯誤的那一格之前
+    GameState* game = ls->game;
+    uint64_t shown = lockstep_visual_hash(game);
+    const unsigned char* snapshot = lockstep_snapshot(ls, from);
+    const GameSnapshotHeader* h = (const GameSnapshotHeader*)(snapshot + sizeof(int64_t));
+    if (*(const int64_t*)snapshot != from || !game_snapshot_restore(game, h, (size_t)h->total_size)) {
+        // 快照已被覆寫 (領先的格數受 rollback_frames 限制，不應發生)，無法修正
+        ls->phase = LOCKSTEP_DESYNC;
+        ls->stats.desync_frame = from;
+        return;
+    }
+    ls->frame = from;
+    if (ls->record) game_replay_truncate(ls->record, from);
+
+    // 以修正後的輸入 (仍未到的部分重新預測) 模擬回原本的格數
+    GameLockstepStats* st = &ls->stats;
+    while (ls->frame < target) {
+        int mover = game_next_mover(game);
+        if (mover < 0) break;
+        lockstep_step(ls, mover);
+        st->resim_frames++;
+    }
+    st->rollbacks++;
+    st->rollback_depth_total += target - from;
+    if (target - from > st->rollback_depth_max) st->rollback_depth_max = target - from;
+    if (lockstep_visual_hash(game) != shown) st->corrections++;
+    lockstep_compare_pending(ls);
+}
+
+// 推進一次移動
+int game_lockstep_advance(GameLockstep* ls, double now_ms, GameEvent* event)
+{
+    if (ls->phase == LOCKSTEP_CONNECTING) return -1;
+    game_lockstep_reconcile(ls);
+    if (ls->phase != LOCKSTEP_RUNNING) return -2;
+
+    GameState* game = ls->game;
+    int mover = game_next_mover(game);
+    if (mover < 0) {
+        // 回溯模式下的死亡可能來自預測，輸入都確認後才結束
+        if (ls->remote_count < ls->frame) return -1;
+        ls->phase = LOCKSTEP_OVER;
+        return -2;
+    }
+
+    // 遊戲時間還沒到
+    const Player* pl = &game->players[mover];
+    double due = (double)(pl->elapsed_ms + pl->interval);
+    if (now_ms - ls->origin_ms < due) return -1;
+
+    // 對方的輸入還沒到 (回溯模式為領先太多)，或本機尚未被確認的輸入已填滿緩衝區
+    if (lockstep_blocked(ls) || ls->local_count - ls->remote_acked >= GAME_LOCKSTEP_WINDOW) {
+        if (!ls->stalled) {
+            ls->stalled = true;
+            ls->stall_start_ms = now_ms;
+            ls->stats.stalls++;
+        }
+        return -1;
+    }
+    if (ls->stalled) {
+        // 等待的時間不計入遊戲時間，之後的移動不會一次補上
+        double waited = now_ms - ls->stall_start_ms;
+        ls->stats.stall_ms += waited;
+        ls->origin_ms += waited;
+        ls->stalled = false;
+    }
+
+    // 取樣本機方向，作為 delay 格之後的輸入
+    long sample = ls->frame + ls->delay;
+    if (ls->local_count == sample) {
+        ls->inputs[ls->local][sample % GAME_LOCKSTEP_WINDOW] = (uint8_t)ls->local_dir;
+        ls->sampled_ms[sample % GAME_LOCKSTEP_WINDOW] = due;
+        ls->local_count++;
+    }
+    if (ls->frame >= ls->delay) {
+        GameLockstepStats* st = &ls->stats;
+        st->input_delay_samples++;
+        st->input_delay_ms += (due - ls->sampled_ms[ls->frame % GAME_LOCKSTEP_WINDOW] - st->input_delay_ms)
+            / st->input_delay_samples;
+    }
+
+    GameEvent e = lockstep_step(ls, mover);
+    if (event) *event = e;
+    lockstep_compare_pending(ls);
+    return mover;
+}
+
+// 距離下一次移動的時間
+double game_lockstep_wait_ms(const GameLockstep* ls, double now_ms)
+{
+    if (ls->phase != LOCKSTEP_RUNNING || lockstep_blocked(ls)) return -1.0;
+    int mover = game_next_mover(ls->game);
+    if (mover < 0) return ls->remote_count < ls->frame ? -1.0 : 0.0;
+    const Player* pl = &ls->game->players[mover];
+    double wait = (double)(pl->elapsed_ms + pl->interval) - (now_ms - ls->origin_ms);
+    return wait > 0.0 ? wait : 0.0;
+}
+
+// 對局結束且對方已收到需要的所有本機輸入
+bool game_lockstep_finished(const GameLockstep* ls)
+{
+    return (ls->phase == LOCKSTEP_OVER || ls->phase == LOCKSTEP_DESYNC) && ls->remote_acked >= ls->frame;
+}
+
+//==============================================================
+// [ 封包 ]
+//==============================================================
+// 重送前等待確認的時間：一個往返時間加上對方延後確認的時間
+static double lockstep_resend_ms(const GameLockstep* ls)
+{
+    double resend = (ls->stats.rtt_samples ? ls->stats.rtt_ms * 1.25 : 0.0) + ACK_DELAY_MS;
+    return resend > RESEND_INTERVAL_MS ? resend : RESEND_INTERVAL_MS;
+}
+
+// 對方尚未確認的第一個輸入是否到了重送的時間
+static bool lockstep_resend_due(const GameLockstep* ls, double now_ms)
+{
+    return ls->remote_acked < ls->sent_count
+        && now_ms - ls->sent_ms[ls->remote_acked % GAME_LOCKSTEP_WINDOW] >= lockstep_resend_ms(ls);
+}
+
+// 是否需要送出封包
+bool game_lockstep_should_send(const GameLockstep* ls, double now_ms)
+{
+    double since = now_ms - ls->last_send_ms;
+    if (ls->hello_pending) return true;
+    if (ls->phase == LOCKSTEP_CONNECTING) return since >= HELLO_INTERVAL_MS;
+    if (ls->local_count > ls->sent_count) return true;
+    if (ls->ack_pending && now_ms >= ls->ack_due_ms) return true;
+    if (lockstep_resend_due(ls, now_ms)) return true;
+    if (ls->stalled) return since >= lockstep_resend_ms(ls);
+    return since >= IDLE_INTERVAL_MS;
+}
+
+// 產生下一個要送出的封包
+int game_lockstep_write(GameLockstep* ls, uint8_t* buffer, double now_ms)
+{
+    int length;
+    if (ls->phase == LOCKSTEP_CONNECTING || ls->hello_pending) {
+        buffer[0] = PACKET_HELLO;
+        buffer[1] = ls->match;
+        buffer[2] = GAME_LOCKSTEP_VERSION;
+        buffer[3] = (uint8_t)ls->local;
+        buffer[4] = (uint8_t)(ls->delay | (ls->rollback_frames ? HELLO_ROLLBACK : 0));
+        buffer[5] = ls->hello_received ? 1 : 0;
+        put_u32(buffer + 6, (uint32_t)ls->seed);
+        put_u32(buffer + 10, (uint32_t)(ls->seed >> 32));
+        length = 14;
+        ls->hello_pending = false;
+    }
+    else {
+        // 確認逾時 (或在等待對方) 時從對方尚未確認的第一格開始重送，否則只送出新的輸入
+        // (前面的輸入遺失時，對方會丟棄不連續的輸入，等之後的重送)
+        long first = (lockstep_resend_due(ls, now_ms) || ls->stalled) ? ls->remote_acked : ls->sent_count;
+        long count = ls->local_count - first;
+        if (count > GAME_LOCKSTEP_MAX_BATCH) count = GAME_LOCKSTEP_MAX_BATCH;
+        uint8_t flags = 0;
+        length = 7;
+
+        // 只有確認的封包不帶時間戳 (保持連線的封包帶著，維持往返時間的樣本)
+        if (ls->stats.packets_sent % TIMING_EVERY == 0 || (count == 0 && !ls->ack_pending)) {
+            flags |= FLAG_TIMING;
+            put_u16(buffer + length, (uint32_t)(int64_t)now_ms & 0xFFFF);
+            if (ls->have_stamp) {
+                flags |= FLAG_ECHO;
+                double age = now_ms - ls->peer_stamp_at_ms;
+                put_u16(buffer + length + 2, ls->peer_stamp);
+                put_u16(buffer + length + 4, age < 0xFFFF ? (uint32_t)age : 0xFFFF);
+            }
+            else {
+                put_u16(buffer + length + 2, 0);
+                put_u16(buffer + length + 4, 0);
+            }
+            length += 6;
+        }
+
+        // 只送出已確認 (不會再回溯) 的檢查點
+        long check = game_lockstep_confirmed(ls) / GAME_LOCKSTEP_CHECK_EVERY * GAME_LOCKSTEP_CHECK_EVERY;
+        if (check > ls->check_sent && (ls->rollback_from < 0 || check <= ls->rollback_from)) {
+            flags |= FLAG_CHECK;
+            put_u16(buffer + length, (uint32_t)check & 0xFFFF);
+            put_u32(buffer + length + 2, ls->checks[(check / GAME_LOCKSTEP_CHECK_EVERY) % GAME_LOCKSTEP_CHECKS]);
+            length += 6;
+            ls->check_sent = check;
+        }
+
+        // 方向每個2位元
+        memset(buffer + length, 0, (size_t)(count + 3) / 4);
+        for (long i = 0; i < count; i++) {
+            uint8_t dir = ls->inputs[ls->local][(first + i) % GAME_LOCKSTEP_WINDOW] & 3;
+            buffer[length + i / 4] |= (uint8_t)(dir << ((i % 4) * 2));
+        }
+        length += (int)(count + 3) / 4;
+        for (long i = 0; i < count; i++) ls->sent_ms[(first + i) % GAME_LOCKSTEP_WINDOW] = now_ms;
+
+        buffer[0] = PACKET_INPUT | flags;
+        buffer[1] = ls->match;
+        buffer[2] = (uint8_t)count;
+        put_u16(buffer + 3, (uint32_t)first & 0xFFFF);
+        put_u16(buffer + 5, (uint32_t)ls->remote_count & 0xFFFF);
+        if (first + count > ls->sent_count) ls->sent_count = first + count;
+        ls->ack_pending = false;
+        ls->stats.inputs_sent += count;
+    }
+
+    ls->last_send_ms = now_ms;
+    ls->stats.packets_sent++;
+    ls->stats.bytes_sent += length;
+    return length;
+}
+
+// 處理 HELLO
+static bool lockstep_read_hello(GameLockstep* ls, const uint8_t* data, int length, double now_ms)
+{
+    if (length < 14 || data[2] != GAME_LOCKSTEP_VERSION || data[3] != 1 - ls->local) return false;
+    if (ls->phase == LOCKSTEP_CONNECTING && ls->local != 0) {
+        // 客戶端採用主機的種子、輸入延遲與模式
+        int delay = data[4] & ~HELLO_ROLLBACK;
+        bool rollback = (data[4] & HELLO_ROLLBACK) != 0;
+        if (rollback != (ls->rollback_frames > 0)
+            && !game_lockstep_set_rollback(ls, rollback ? GAME_LOCKSTEP_DEFAULT_ROLLBACK : 0)) return false;
+        ls->delay = delay > GAME_LOCKSTEP_MAX_DELAY ? GAME_LOCKSTEP_MAX_DELAY : delay;
+        ls->seed = (uint64_t)get_u32(data + 6) | ((uint64_t)get_u32(data + 10) << 32);
+    }
+    ls->hello_received = true;
+    if (data[5]) ls->peer_ready = true;
+    else ls->hello_pending = true; // 對方還沒收到本機的 HELLO
+
+    if (ls->phase == LOCKSTEP_CONNECTING && ls->peer_ready) lockstep_start(ls, now_ms);
+    return true;
+}
+
+// 處理 INPUT
+static bool lockstep_read_input(GameLockstep* ls, const uint8_t* data, int length, double now_ms)
+{
+    if (length < 7) return false;
+    if (ls->phase == LOCKSTEP_CONNECTING) {
+        // 對方已開始，表示它收到了本機的 HELLO
+        if (!ls->hello_received) return false;
+        ls->peer_ready = true;
+        lockstep_start(ls, now_ms);
+    }
+
+    uint8_t flags = data[0];
+    long count = data[2];
+    long first = unwrap_frame(ls->remote_count, get_u16(data + 3));
+    long ack = unwrap_frame(ls->remote_acked, get_u16(data + 5));
+    int offset = 7;
+    if (flags & FLAG_TIMING) offset += 6;
+    if (flags & FLAG_CHECK) offset += 6;
+    if (length < offset + (int)(count + 3) / 4) return false;
+
+    if (ack > ls->remote_acked && ack <= ls->local_count) ls->remote_acked = ack;
+
+    offset = 7;
+    if (flags & FLAG_TIMING) {
+        uint16_t now16 = (uint16_t)((int64_t)now_ms & 0xFFFF);
+        if (flags & FLAG_ECHO) {
+            // 往返時間 = 現在 - 本機送出的時間戳 - 對方收到後等待的時間
+            double rtt = (double)(uint16_t)(now16 - (uint16_t)get_u16(data + offset + 2))
+                - (double)get_u16(data + offset + 4);
+            if (rtt >= 0.0 && rtt < 10000.0) {
+                GameLockstepStats* st = &ls->stats;
+                st->rtt_ms = st->rtt_samples ? st->rtt_ms * 0.875 + rtt * 0.125 : rtt;
+                if (st->rtt_samples == 0 || rtt < st->rtt_min_ms) st->rtt_min_ms = rtt;
+                if (rtt > st->rtt_max_ms) st->rtt_max_ms = rtt;
+                st->rtt_samples++;
+            }
+        }
+        ls->have_stamp = true;
+        ls->peer_stamp = (uint16_t)get_u16(data + offset);
+        ls->peer_stamp_at_ms = now_ms;
+        offset += 6;
+    }
+    if (flags & FLAG_CHECK) {
+        lockstep_compare(ls, unwrap_frame(ls->frame, get_u16(data + offset)), get_u32(data + offset + 2));
+        offset += 6;
+    }
+
+    // 只接受緊接在已收到之後、且不會覆寫尚未套用的格子的輸入
+    int remote = 1 - ls->local;
+    for (long i = 0; i < count; i++) {
+        long f = first + i;
+        if (f < ls->remote_count) continue;
+        if (f > ls->remote_count || f - ls->frame >= GAME_LOCKSTEP_WINDOW) break;
+        int slot = (int)(f % GAME_LOCKSTEP_WINDOW);
+        ls->inputs[remote][slot] = (data[offset + i / 4] >> ((i % 4) * 2)) & 3;
+        ls->remote_count++;
+        // 回溯模式：這一格已經以預測模擬過，預測錯誤時之後要從這一格重新模擬
+        if (f < ls->frame && ls->inputs[remote][slot] != ls->predicted[slot]
+            && (ls->rollback_from < 0 || f < ls->rollback_from)) {
+            ls->rollback_from = f;
+        }
+    }
+
+    // 收到輸入 (重送的舊輸入表示確認遺失) 時回應確認：
+    // 下一次移動很快就到時由該次的輸入封包帶著，否則立即送出
+    if (count > 0) {
+        double wait = game_lockstep_wait_ms(ls, now_ms);
+        double due = now_ms + ((wait >= 0.0 && wait <= ACK_DELAY_MS) ? wait : 0.0);
+        if (!ls->ack_pending || due < ls->ack_due_ms) ls->ack_due_ms = due;
+        ls->ack_pending = true;
+    }
+    lockstep_compare_pending(ls);
+    return true;
+}
+
+// 處理收到的封包
+bool game_lockstep_read(GameLockstep* ls, const uint8_t* data, int length, double now_ms)
+{
+    if (length < 3 || data[1] != ls->match) return false;
+    bool ok;
+    switch (data[0] & PACKET_TYPE) {
+    case PACKET_HELLO:
+        ok = lockstep_read_hello(ls, data, length, now_ms);
+        break;
+    case PACKET_INPUT:
+        ok = lockstep_read_input(ls, data, length, now_ms);
+        break;
+    default:
+        ok = false;
+        break;
+    }
+    if (ok) {
+        ls->stats.packets_received++;
+        ls->stats.bytes_received += length;
+    }
+    return ok;
+}
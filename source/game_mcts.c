@@ -0,0 +1,305 @@
+#include "game_mcts.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 每完成這麼多次模擬檢查一次時間
+#define MCTS_CLOCK_INTERVAL 16
+// 預設的模擬視野 (雙方合計的移動步數)
+#define MCTS_DEFAULT_HORIZON 60
+
+//==============================================================
+// [ 工具 ]
+//==============================================================
+// 目前時間 (微秒)
+static long long mcts_now_us(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 與各方向相反的方向
+static const uint8_t mcts_opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+
+// 從搜尋的亂數衍生一個新的亂數狀態 (splitmix64，不會為0)
+static uint64_t mcts_split(uint64_t* rng)
+{
+    uint64_t z = (*rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+//==============================================================
+// [ 建立 / 釋放 ]
+//==============================================================
+// 建立搜尋器
+bool mcts_search_init(MctsSearch* search, int width, int height, int node_capacity)
+{
+    memset(search, 0, sizeof(*search));
+    search->sim_size = game_sim_size(width, height);
+    if (search->sim_size == 0) return false;
+
+    search->width = width;
+    search->height = height;
+    search->node_capacity = node_capacity > 0 ? node_capacity : MCTS_DEFAULT_NODES;
+    search->horizon = MCTS_DEFAULT_HORIZON;
+    search->exploration = 0.3f;
+
+    // 精簡狀態以 uint64_t 陣列配置，保證 8 位元組對齊
+    search->root = (GameSim*)calloc(search->sim_size / sizeof(uint64_t), sizeof(uint64_t));
+    search->scratch = (GameSim*)calloc(search->sim_size / sizeof(uint64_t), sizeof(uint64_t));
+    search->nodes = (MctsNode*)malloc((size_t)search->node_capacity * sizeof(MctsNode));
+    if (!search->root || !search->scratch || !search->nodes) {
+        mcts_search_free(search);
+        return false;
+    }
+    return true;
+}
+
+// 釋放搜尋器
+void mcts_search_free(MctsSearch* search)
+{
+    if (search->root && search->root->walls) game_sim_release(search->root);
+    game_sim_walls_release(search->walls);
+    free(search->root);
+    free(search->scratch);
+    free(search->nodes);
+    memset(search, 0, sizeof(*search));
+}
+
+//==============================================================
+// [ 模擬 ]
+//==============================================================
+// 兩個格子在環狀網格上的曼哈頓距離
+static int mcts_distance(const GameSim* sim, int a, int b)
+{
+    int w = sim->width, h = sim->height;
+    int dx = abs(a % w - b % w), dy = abs(a / w - b / w);
+    if (dx > w - dx) dx = w - dx;
+    if (dy > h - dy) dy = h - dy;
+    return dx + dy;
+}
+
+// 模擬用的快速策略：大多走向食物，其餘保持原方向或隨機，都只考慮安全的方向
+static Direction mcts_rollout_policy(const GameSim* sim, int player, uint64_t* rng)
+{
+    const GameSimPlayer* sp = &sim->players[player];
+    Direction safe[4];
+    int dist[4];
+    int n = 0, best = -1;
+    for (int d = 0; d < 4; d++) {
+        if (d == mcts_opposite[sp->next_direction]) continue;
+        int c = game_sim_next_cell(sim, player, (Direction)d);
+        if (game_sim_blocked(sim, c)) continue;
+        dist[n] = mcts_distance(sim, c, (int)sim->food);
+        if (best < 0 || dist[n] < dist[best]) best = n;
+        safe[n++] = (Direction)d;
+    }
+    if (n == 0) return (Direction)sp->next_direction;
+
+    int r = game_rng_next(rng, 8);
+    if (r < 6) return safe[best];
+    if (r < 7) {
+        for (int i = 0; i < n; i++) {
+            if (safe[i] == (Direction)sp->next_direction) return safe[i];
+        }
+    }
+    return safe[game_rng_next(rng, n)];
+}
+
+// 以自己的角度評估模擬結束時的局面 (0: 輸, 1: 贏)
+static float mcts_evaluate(const GameSim* sim, int me, int start_score)
+{
+    const GameSimPlayer* a = &sim->players[me];
+    // 存活時離食物越近越好 (同分的局面之間以此區分，讓搜尋往食物前進)
+    float near = 0.0f;
+    if (a->alive) {
+        int d = mcts_distance(sim, game_sim_body_at(sim, me, 0), (int)sim->food);
+        near = 0.05f * (1.0f - (float)d / (sim->width / 2 + sim->height / 2));
+    }
+    if (sim->player_count == 1) {
+        float gain = (float)(a->score - start_score);
+        return (a->alive ? 0.45f : 0.0f) + 0.5f * gain / (gain + 2.0f) + near;
+    }
+
+    const GameSimPlayer* b = &sim->players[1 - me];
+    int diff = a->score - b->score;
+    if (!a->alive && !b->alive) {
+        // 與 game_decide_winner 相同：先比分數，再比存活秒數
+        if (diff != 0) return diff > 0 ? 1.0f : 0.0f;
+        long sa = game_survival_seconds(a->survival_ms), sb = game_survival_seconds(b->survival_ms);
+        return sa > sb ? 1.0f : (sa < sb ? 0.0f : 0.5f);
+    }
+    if (!a->alive) return diff > 0 ? 0.5f : 0.0f;    // 對手還能繼續得分
+    if (!b->alive) return diff >= 0 ? 1.0f : 0.6f;  // 自己還能追上
+    // 雙方都存活：以分數差與本次模擬中自己多吃到的果實評估
+    float d = (diff + (a->score - start_score)) / 4.0f;
+    if (d > 1.0f) d = 1.0f;
+    else if (d < -1.0f) d = -1.0f;
+    return 0.475f + 0.4f * d + near;
+}
+
+// 取得節點 (沒有空間時返回-1)
+static int mcts_new_node(MctsSearch* s)
+{
+    if (s->node_count >= s->node_capacity) return -1;
+    MctsNode* n = &s->nodes[s->node_count];
+    n->child[0] = n->child[1] = n->child[2] = n->child[3] = -1;
+    n->visits = 0;
+    n->value = 0.0f;
+    return s->node_count++;
+}
+
+// 以 UCB1 選擇子節點，尚有未展開的方向時隨機展開其中一個 (expanded 設為true，節點池已滿時返回-1)
+static int mcts_select(MctsSearch* s, int node, uint8_t reverse, uint64_t* rng, Direction* dir, bool* expanded)
+{
+    MctsNode* n = &s->nodes[node];
+    Direction unexpanded[4];
+    int m = 0;
+    for (int d = 0; d < 4; d++) {
+        if (d != reverse && n->child[d] < 0) unexpanded[m++] = (Direction)d;
+    }
+    *expanded = m > 0;
+    if (m > 0) {
+        int c = mcts_new_node(s);
+        *dir = unexpanded[game_rng_next(rng, m)];
+        if (c >= 0) s->nodes[node].child[*dir] = c;
+        return c;
+    }
+
+    float log_n = logf((float)n->visits);
+    float best = -1.0f;
+    int chosen = -1;
+    for (int d = 0; d < 4; d++) {
+        if (d == reverse) continue;
+        const MctsNode* c = &s->nodes[n->child[d]];
+        float ucb = c->value / c->visits + s->exploration * sqrtf(log_n / c->visits);
+        if (ucb > best) {
+            best = ucb;
+            chosen = d;
+        }
+    }
+    *dir = (Direction)chosen;
+    return n->child[chosen];
+}
+
+// 一次模擬：選擇、展開、快速走完並回傳評估值
+static void mcts_iterate(MctsSearch* s, int me, uint64_t* rng)
+{
+    GameSim* sim = s->scratch;
+    game_sim_copy(sim, s->root);
+    sim->rng_state = mcts_split(rng); // 搜尋不使用遊戲真正的食物亂數
+
+    int path[MCTS_DEFAULT_HORIZON + 1];
+    int depth = 0;
+    int node = 0;
+    path[depth++] = 0;
+    bool in_tree = true;
+    int start_score = sim->players[me].score;
+
+    for (int steps = 0; steps < s->horizon; steps++) {
+        int p = game_sim_next_mover(sim);
+        if (p < 0) break;
+        if (p == me && in_tree) {
+            // 在樹中：沿 UCB1 往下，展開一個新節點後離開樹
+            Direction d;
+            bool expanded;
+            node = mcts_select(s, node, mcts_opposite[sim->players[me].next_direction], rng, &d, &expanded);
+            game_sim_turn(sim, me, d);
+            if (node >= 0) path[depth++] = node;
+            if (node < 0 || expanded) in_tree = false;
+        }
+        else {
+            game_sim_turn(sim, p, mcts_rollout_policy(sim, p, rng));
+        }
+        game_sim_step(sim, p);
+    }
+
+    float v = mcts_evaluate(sim, me, start_score);
+    for (int i = 0; i < depth; i++) {
+        s->nodes[path[i]].visits++;
+        s->nodes[path[i]].value += v;
+    }
+}
+
+//==============================================================
+// [ 決策 ]
+//==============================================================
+// 依目前局面的障礙物準備牆層
+bool mcts_search_sync_walls(MctsSearch* search, const GameState* game)
+{
+    if (game->width != search->width || game->height != search->height) return false;
+
+    // 障礙物改變 (新的一局) 時才重建牆層
+    if (!search->walls || search->walls_key_count != game->obstacle_count
+        || memcmp(search->walls_key, game->obstacles, (size_t)game->obstacle_count * sizeof(Obstacle)) != 0)
+    {
+        GameSimWalls* walls = game_sim_walls_from_state(game);
+        if (!walls) return false;
+        game_sim_walls_release(search->walls);
+        search->walls = walls;
+        search->walls_key_count = game->obstacle_count;
+        memcpy(search->walls_key, game->obstacles, (size_t)game->obstacle_count * sizeof(Obstacle));
+    }
+    return true;
+}
+
+// 以 MCTS 選擇方向
+bool mcts_search_choose(MctsSearch* search, const GameState* game, int player, uint64_t* rng,
+    long max_iterations, long budget_us, Direction* dir)
+{
+    long long start = mcts_now_us();
+    if (!mcts_search_sync_walls(search, game)) return false;
+    if (search->root->walls) game_sim_release(search->root);
+    game_sim_from_state(search->root, game, search->walls);
+
+    if (max_iterations <= 0 && budget_us <= 0) max_iterations = MCTS_DEFAULT_ITERATIONS;
+    if (search->horizon > MCTS_DEFAULT_HORIZON) search->horizon = MCTS_DEFAULT_HORIZON;
+    search->node_count = 0;
+    mcts_new_node(search);
+
+    long iterations = 0;
+    while (max_iterations <= 0 || iterations < max_iterations) {
+        if (budget_us > 0 && iterations % MCTS_CLOCK_INTERVAL == 0 && iterations > 0
+            && mcts_now_us() - start >= budget_us) {
+            break;
+        }
+        mcts_iterate(search, player, rng);
+        iterations++;
+    }
+
+    // 選擇經過次數最多的方向 (相同時選平均評估值較高者)
+    const MctsNode* root = &search->nodes[0];
+    int best = -1;
+    for (int d = 0; d < 4; d++) {
+        int c = root->child[d];
+        if (c < 0) continue;
+        const MctsNode* n = &search->nodes[c];
+        if (n->visits == 0) continue;
+        if (best < 0) {
+            best = d;
+            continue;
+        }
+        const MctsNode* b = &search->nodes[root->child[best]];
+        if (n->visits > b->visits || (n->visits == b->visits && n->value / n->visits > b->value / b->visits)) {
+            best = d;
+        }
+    }
+
+    long elapsed = (long)(mcts_now_us() - start);
+    search->decisions++;
+    search->rollouts += (unsigned long long)iterations;
+    search->last_rollouts = (unsigned long)iterations;
+    search->total_us += (double)elapsed;
+    search->last_us = elapsed;
+    if (elapsed > search->max_us) search->max_us = elapsed;
+
+    if (best < 0) return false;
+    *dir = (Direction)best;
+    return true;
+}
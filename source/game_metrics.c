@@ -0,0 +1,351 @@
+#include "game_metrics.h"
+#include "game_file.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <intrin.h>
+#define METRICS_THREAD_LOCAL __declspec(thread)
+#else
+#define METRICS_THREAD_LOCAL _Thread_local
+#endif
+
+//========================[ 結構定義 ]========================
+// 一個執行緒的分區：只有擁有的執行緒寫入，其他執行緒讀取時可能讀到稍舊的值
+typedef struct MetricsShard {
+    struct MetricsShard* next;    // 所有分區串成的鏈結串列 (只在前端插入)
+    volatile uint64_t counters[METRIC_COUNTER_COUNT];
+    volatile uint64_t count[METRIC_HIST_COUNT];
+    volatile uint64_t sum[METRIC_HIST_COUNT];
+    volatile uint64_t max[METRIC_HIST_COUNT];
+    volatile uint64_t buckets[METRIC_HIST_COUNT][GAME_METRICS_BUCKETS];
+} MetricsShard;
+
+//========================[ 全域變數 ]========================
+static MetricsShard* volatile metrics_shards = NULL;           // 所有執行緒的分區
+static METRICS_THREAD_LOCAL MetricsShard* metrics_local = NULL; // 目前執行緒的分區
+
+static const char* const counter_names[METRIC_COUNTER_COUNT] = {
+    "games", "ticks", "food_eaten", "food_spawns", "food_retries",
+    "death_self", "death_obstacle", "death_other", "pauses", "pause_ms", "countdown_ms"
+};
+
+static const char* const histogram_names[METRIC_HIST_COUNT] = {
+    "ticks_per_game", "length", "food_retries_per_game", "game_ms", "pause_ms", "countdown_ms"
+};
+
+//==============================================================
+// [ 平台相關 ]
+//==============================================================
+// 64位元的讀寫在 x64 / ARM64 上以對齊的存取即為原子操作，只需避免編譯器合併或拆開存取
+#ifdef _WIN32
+static uint64_t metrics_load(const volatile uint64_t* p)
+{
+    return *p;
+}
+
+static void metrics_store(volatile uint64_t* p, uint64_t value)
+{
+    *p = value;
+}
+
+static bool metrics_push_shard(MetricsShard* shard)
+{
+    MetricsShard* first = metrics_shards;
+    shard->next = first;
+    return InterlockedCompareExchangePointer((PVOID volatile*)&metrics_shards, shard, first) == first;
+}
+
+static int floor_log2(uint64_t value)
+{
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (int)index;
+}
+#else
+static uint64_t metrics_load(const volatile uint64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static void metrics_store(volatile uint64_t* p, uint64_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+}
+
+static bool metrics_push_shard(MetricsShard* shard)
+{
+    MetricsShard* first = __atomic_load_n(&metrics_shards, __ATOMIC_ACQUIRE);
+    shard->next = first;
+    return __atomic_compare_exchange_n(&metrics_shards, &first, shard, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+
+static int floor_log2(uint64_t value)
+{
+    return 63 - __builtin_clzll(value);
+}
+#endif
+
+//==============================================================
+// [ 記錄 ]
+//==============================================================
+// 取得目前執行緒的分區 (第一次時配置並加入串列)
+static MetricsShard* metrics_shard(void)
+{
+    MetricsShard* shard = metrics_local;
+    if (shard) return shard;
+    shard = (MetricsShard*)calloc(1, sizeof(MetricsShard));
+    if (!shard) return NULL;
+    while (!metrics_push_shard(shard)) {
+    }
+    metrics_local = shard;
+    return shard;
+}
+
+// 值所在的桶：小於8的值各自一桶，之後每個2的冪次分成8桶
+int game_metrics_bucket(uint64_t value)
+{
+    if (value < 8) return (int)value;
+    int e = floor_log2(value);
+    int bucket = (e - 2) * 8 + (int)((value >> (e - 3)) & 7);
+    return bucket < GAME_METRICS_BUCKETS ? bucket : GAME_METRICS_BUCKETS - 1;
+}
+
+// 桶的上限
+static uint64_t bucket_upper(int bucket)
+{
+    if (bucket < 8) return (uint64_t)bucket;
+    int e = bucket / 8 + 2;
+    uint64_t lower = (uint64_t)(8 + bucket % 8) << (e - 3);
+    return lower + ((uint64_t)1 << (e - 3)) - 1;
+}
+
+// 增加計數器
+void game_metrics_add(GameMetricCounter counter, uint64_t value)
+{
+    MetricsShard* shard = metrics_shard();
+    if (!shard) return;
+    metrics_store(&shard->counters[counter], shard->counters[counter] + value);
+}
+
+// 記錄一個直方圖樣本
+void game_metrics_observe(GameMetricHistogram histogram, uint64_t value)
+{
+    MetricsShard* shard = metrics_shard();
+    if (!shard) return;
+    volatile uint64_t* bucket = &shard->buckets[histogram][game_metrics_bucket(value)];
+    metrics_store(bucket, *bucket + 1);
+    metrics_store(&shard->count[histogram], shard->count[histogram] + 1);
+    metrics_store(&shard->sum[histogram], shard->sum[histogram] + value);
+    if (value > shard->max[histogram]) metrics_store(&shard->max[histogram], value);
+}
+
+//==============================================================
+// [ 讀取 ]
+//==============================================================
+// 加總所有執行緒的分區
+void game_metrics_read(GameMetricsSnapshot* snapshot)
+{
+    memset(snapshot, 0, sizeof(*snapshot));
+    for (MetricsShard* shard = metrics_shards; shard; shard = shard->next) {
+        snapshot->threads++;
+        for (int c = 0; c < METRIC_COUNTER_COUNT; c++) {
+            snapshot->counters[c] += metrics_load(&shard->counters[c]);
+        }
+        for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+            GameMetricsHistogram* out = &snapshot->histograms[h];
+            out->count += metrics_load(&shard->count[h]);
+            out->sum += metrics_load(&shard->sum[h]);
+            uint64_t max = metrics_load(&shard->max[h]);
+            if (max > out->max) out->max = max;
+            for (int b = 0; b < GAME_METRICS_BUCKETS; b++) {
+                out->buckets[b] += metrics_load(&shard->buckets[h][b]);
+            }
+        }
+    }
+}
+
+// 估計直方圖的百分位數
+uint64_t game_metrics_percentile(const GameMetricsHistogram* histogram, double quantile)
+{
+    // 以桶的內容計算總數，與 count 在讀取期間的些微差異無關
+    uint64_t total = 0;
+    for (int b = 0; b < GAME_METRICS_BUCKETS; b++) total += histogram->buckets[b];
+    if (total == 0) return 0;
+    uint64_t target = (uint64_t)(quantile * (double)total);
+    if (target >= total) target = total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < GAME_METRICS_BUCKETS; b++) {
+        seen += histogram->buckets[b];
+        if (seen > target) {
+            uint64_t upper = bucket_upper(b);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+// 取得計數器的名稱
+const char* game_metrics_counter_name(GameMetricCounter counter)
+{
+    return counter >= 0 && counter < METRIC_COUNTER_COUNT ? counter_names[counter] : "unknown";
+}
+
+// 取得直方圖的名稱
+const char* game_metrics_histogram_name(GameMetricHistogram histogram)
+{
+    return histogram >= 0 && histogram < METRIC_HIST_COUNT ? histogram_names[histogram] : "unknown";
+}
+
+// 把快照寫成一行 JSON
+bool game_metrics_write_snapshot(const GameMetricsSnapshot* snapshot, FILE* out)
+{
+    fprintf(out, "{\"threads\":%d", snapshot->threads);
+    for (int c = 0; c < METRIC_COUNTER_COUNT; c++) {
+        fprintf(out, ",\"%s\":%llu", counter_names[c], (unsigned long long)snapshot->counters[c]);
+    }
+    for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+        const GameMetricsHistogram* hist = &snapshot->histograms[h];
+        fprintf(out, ",\"%s\":{\"count\":%llu,\"mean\":%.2f,\"p50\":%llu,\"p99\":%llu,\"max\":%llu}",
+            histogram_names[h], (unsigned long long)hist->count,
+            hist->count ? (double)hist->sum / (double)hist->count : 0.0,
+            (unsigned long long)game_metrics_percentile(hist, 0.50),
+            (unsigned long long)game_metrics_percentile(hist, 0.99),
+            (unsigned long long)hist->max);
+    }
+    fputs("}\n", out);
+    return fflush(out) == 0 && !ferror(out);
+}
+
+// 釋放所有執行緒的分區
+void game_metrics_shutdown(void)
+{
+    MetricsShard* shard = metrics_shards;
+    metrics_shards = NULL;
+    while (shard) {
+        MetricsShard* next = shard->next;
+        free(shard);
+        shard = next;
+    }
+    metrics_local = NULL;
+}
+
+//==============================================================
+// [ 每局的摘要 ]
+//==============================================================
+// 開始一局的摘要
+void game_metrics_game_begin(GameMetricsGame* summary, const char* mode, uint64_t seed, int player_count, int64_t started)
+{
+    metrics_shard(); // 在開局時配置目前執行緒的分區，移動中的記錄不需要配置記憶體
+    memset(summary, 0, sizeof(*summary));
+    summary->mode = mode;
+    summary->seed = seed;
+    summary->player_count = player_count;
+    summary->started = started;
+}
+
+// 記錄一次移動
+void game_metrics_game_tick(GameMetricsGame* summary, const GameState* game, int player, GameEvent event)
+{
+    if (summary->finished || player < 0 || player >= game->player_count) return;
+    int length = game->players[player].body.length;
+    summary->ticks++;
+    summary->length_sum += (uint64_t)length;
+    if (length > summary->length_max) summary->length_max = length;
+    game_metrics_add(METRIC_TICKS, 1);
+    game_metrics_observe(METRIC_HIST_LENGTH, (uint64_t)length);
+    if (event == GAME_EVENT_ATE) {
+        summary->food_eaten++;
+        game_metrics_add(METRIC_FOOD_EATEN, 1);
+    }
+}
+
+// 記錄一次暫停
+void game_metrics_game_pause(GameMetricsGame* summary, long ms)
+{
+    if (ms < 0) ms = 0;
+    summary->pauses++;
+    summary->pause_ms += ms;
+    game_metrics_add(METRIC_PAUSES, 1);
+    game_metrics_add(METRIC_PAUSE_MS, (uint64_t)ms);
+    game_metrics_observe(METRIC_HIST_PAUSE_MS, (uint64_t)ms);
+}
+
+// 記錄一次倒數
+void game_metrics_game_countdown(GameMetricsGame* summary, long ms)
+{
+    if (ms < 0) ms = 0;
+    summary->countdown_ms += ms;
+    game_metrics_add(METRIC_COUNTDOWN_MS, (uint64_t)ms);
+    game_metrics_observe(METRIC_HIST_COUNTDOWN_MS, (uint64_t)ms);
+}
+
+// 結算一局
+void game_metrics_game_end(GameMetricsGame* summary, const GameState* game)
+{
+    if (summary->finished) return;
+    summary->finished = true;
+    summary->food_spawns = game->food_spawns;
+    summary->food_retries = game->food_retries;
+    summary->winner = game->winner;
+    for (int i = 0; i < game->player_count && i < MAX_PLAYERS; i++) {
+        const Player* pl = &game->players[i];
+        summary->scores[i] = pl->score;
+        long ms = pl->alive ? pl->elapsed_ms : pl->survival_ms;
+        if (ms > summary->game_ms) summary->game_ms = ms;
+        if (!pl->alive && pl->death_cause != GAME_COLLISION_NONE) summary->deaths[pl->death_cause]++;
+    }
+
+    game_metrics_add(METRIC_GAMES, 1);
+    game_metrics_add(METRIC_FOOD_SPAWNS, (uint64_t)summary->food_spawns);
+    game_metrics_add(METRIC_FOOD_RETRIES, (uint64_t)summary->food_retries);
+    game_metrics_add(METRIC_DEATH_SELF, (uint64_t)summary->deaths[GAME_COLLISION_SELF]);
+    game_metrics_add(METRIC_DEATH_OBSTACLE, (uint64_t)summary->deaths[GAME_COLLISION_OBSTACLE]);
+    game_metrics_add(METRIC_DEATH_OTHER, (uint64_t)summary->deaths[GAME_COLLISION_OTHER]);
+    game_metrics_observe(METRIC_HIST_TICKS, (uint64_t)summary->ticks);
+    game_metrics_observe(METRIC_HIST_FOOD_RETRIES, (uint64_t)summary->food_retries);
+    game_metrics_observe(METRIC_HIST_GAME_MS, (uint64_t)summary->game_ms);
+}
+
+// 路徑是否以 .csv 結尾
+static bool is_csv_path(const char* path)
+{
+    size_t length = strlen(path);
+    return length >= 4 && (strcmp(path + length - 4, ".csv") == 0 || strcmp(path + length - 4, ".CSV") == 0);
+}
+
+// 把一局的摘要附加到檔案
+bool game_metrics_game_append(const GameMetricsGame* summary, const char* path)
+{
+    FILE* out = game_fopen(path, "a");
+    if (!out) return false;
+    double avg_length = summary->ticks ? (double)summary->length_sum / (double)summary->ticks : 0.0;
+    if (is_csv_path(path)) {
+        fseek(out, 0, SEEK_END);
+        if (ftell(out) == 0) {
+            fputs("started,mode,seed,players,ticks,avg_length,max_length,food_eaten,food_spawns,food_retries,"
+                "death_self,death_obstacle,death_other,pauses,pause_ms,countdown_ms,game_ms,score1,score2,winner\n", out);
+        }
+        fprintf(out, "%lld,%s,%llu,%d,%ld,%.2f,%d,%ld,%ld,%ld,%d,%d,%d,%d,%ld,%ld,%ld,%d,%d,%d\n",
+            (long long)summary->started, summary->mode, (unsigned long long)summary->seed, summary->player_count,
+            summary->ticks, avg_length, summary->length_max, summary->food_eaten, summary->food_spawns,
+            summary->food_retries, summary->deaths[GAME_COLLISION_SELF], summary->deaths[GAME_COLLISION_OBSTACLE],
+            summary->deaths[GAME_COLLISION_OTHER], summary->pauses, summary->pause_ms, summary->countdown_ms,
+            summary->game_ms, summary->scores[0], summary->scores[1], summary->winner);
+    }
+    else {
+        fprintf(out, "{\"started\":%lld,\"mode\":\"%s\",\"seed\":%llu,\"players\":%d,\"ticks\":%ld,"
+            "\"avg_length\":%.2f,\"max_length\":%d,\"food_eaten\":%ld,\"food_spawns\":%ld,\"food_retries\":%ld,"
+            "\"deaths\":{\"self\":%d,\"obstacle\":%d,\"other\":%d},\"pauses\":%d,\"pause_ms\":%ld,"
+            "\"countdown_ms\":%ld,\"game_ms\":%ld,\"scores\":[%d,%d],\"winner\":%d}\n",
+            (long long)summary->started, summary->mode, (unsigned long long)summary->seed, summary->player_count,
+            summary->ticks, avg_length, summary->length_max, summary->food_eaten, summary->food_spawns,
+            summary->food_retries, summary->deaths[GAME_COLLISION_SELF], summary->deaths[GAME_COLLISION_OBSTACLE],
+            summary->deaths[GAME_COLLISION_OTHER], summary->pauses, summary->pause_ms, summary->countdown_ms,
+            summary->game_ms, summary->scores[0], summary->scores[1], summary->winner);
+    }
+    bool ok = !ferror(out);
+    return fclose(out) == 0 && ok;
+}
@@ -0,0 +1,277 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // clock_gettime, getaddrinfo
+#endif
+#include "game_net.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "game_core.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32.lib")
+#endif
+typedef SOCKET net_socket_t;
+#define NET_INVALID INVALID_SOCKET
+#define net_close_socket closesocket
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+typedef int net_socket_t;
+#define NET_INVALID (-1)
+#define net_close_socket close
+#endif
+
+//==============================================================
+// [ 平台相關 ]
+//==============================================================
+// 初始化網路程式庫
+bool game_net_startup(void)
+{
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+// 釋放網路程式庫
+void game_net_cleanup(void)
+{
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// 網路用的單調時鐘 (微秒)
+int64_t game_net_now_us(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (int64_t)((double)counter.QuadPart * 1e6 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+// 把通訊端設為非阻塞
+static bool net_set_nonblocking(net_socket_t s)
+{
+#ifdef _WIN32
+    u_long on = 1;
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// 位址轉換
+static struct sockaddr_in net_to_sockaddr(const GameNetAddress* address)
+{
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(address->ip);
+    sa.sin_port = htons(address->port);
+    return sa;
+}
+
+//==============================================================
+// [ 開啟 / 關閉 ]
+//==============================================================
+// 開啟並綁定非阻塞的 UDP 通訊端
+bool game_net_open(GameNet* net, int port)
+{
+    memset(net, 0, sizeof(*net));
+    net->socket = -1;
+
+    net_socket_t s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == NET_INVALID) return false;
+
+    GameNetAddress any = { 0, (uint16_t)port };
+    struct sockaddr_in sa = net_to_sockaddr(&any);
+    if (bind(s, (struct sockaddr*)&sa, sizeof(sa)) != 0 || !net_set_nonblocking(s)) {
+        net_close_socket(s);
+        return false;
+    }
+
+    // 取得系統指定的埠號
+    socklen_t length = sizeof(sa);
+    if (getsockname(s, (struct sockaddr*)&sa, &length) == 0) {
+        net->port = ntohs(sa.sin_port);
+    }
+    net->socket = (intptr_t)s;
+    return true;
+}
+
+// 關閉通訊端
+void game_net_close(GameNet* net)
+{
+    if (net->socket != -1) net_close_socket((net_socket_t)net->socket);
+    net->socket = -1;
+    free(net->delayed);
+    net->delayed = NULL;
+    net->delayed_count = 0;
+}
+
+// 解析位址或主機名稱
+bool game_net_resolve(const char* host, int port, GameNetAddress* address)
+{
+    struct addrinfo hints, *result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, NULL, &hints, &result) != 0 || !result) return false;
+    const struct sockaddr_in* sa = (const struct sockaddr_in*)result->ai_addr;
+    address->ip = ntohl(sa->sin_addr.s_addr);
+    address->port = (uint16_t)port;
+    freeaddrinfo(result);
+    return true;
+}
+
+//==============================================================
+// [ 延遲 / 遺失模擬 ]
+//==============================================================
+// 設定送出方向的模擬
+void game_net_set_shim(GameNet* net, int latency_ms, int jitter_ms, double loss, uint64_t seed)
+{
+    net->shim.latency_ms = latency_ms > 0 ? latency_ms : 0;
+    net->shim.jitter_ms = jitter_ms > 0 ? jitter_ms : 0;
+    net->shim.loss = loss > 0.0 ? loss : 0.0;
+    net->shim.rng_state = seed;
+}
+
+// 直接送出
+static bool net_send_now(GameNet* net, const GameNetAddress* to, const void* data, size_t length)
+{
+    struct sockaddr_in sa = net_to_sockaddr(to);
+    int sent = (int)sendto((net_socket_t)net->socket, (const char*)data, (int)length, 0,
+        (struct sockaddr*)&sa, sizeof(sa));
+    if (sent < 0) {
+        // 送出緩衝區已滿視同遺失，由上層的重送處理
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK) {
+#else
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+#endif
+            net->packets_dropped++;
+            return true;
+        }
+        return false;
+    }
+    net->packets_sent++;
+    net->bytes_sent += length;
+    return true;
+}
+
+// 送出一個封包
+bool game_net_send(GameNet* net, const GameNetAddress* to, const void* data, size_t length)
+{
+    if (net->socket == -1 || length > GAME_NET_MAX_PACKET) return false;
+    GameNetShim* shim = &net->shim;
+    if (shim->latency_ms == 0 && shim->jitter_ms == 0 && shim->loss == 0.0) {
+        return net_send_now(net, to, data, length);
+    }
+
+    if (shim->loss > 0.0 && game_rng_next(&shim->rng_state, 1000000) < (int)(shim->loss * 1000000.0)) {
+        net->packets_dropped++;
+        return true;
+    }
+
+    int64_t delay_us = (int64_t)shim->latency_ms * 1000;
+    if (shim->jitter_ms > 0) delay_us += game_rng_next(&shim->rng_state, shim->jitter_ms * 1000 + 1);
+
+    if (!net->delayed) {
+        net->delayed = (GameNetDelayed*)calloc(GAME_NET_MAX_DELAYED, sizeof(GameNetDelayed));
+        if (!net->delayed) return false;
+    }
+    if (net->delayed_count == GAME_NET_MAX_DELAYED) {
+        net->packets_dropped++; // 佇列已滿，視同遺失
+        return true;
+    }
+    GameNetDelayed* slot = net->delayed;
+    while (slot->length != 0) slot++;
+    slot->deliver_us = game_net_now_us() + delay_us;
+    slot->to = *to;
+    slot->length = (uint16_t)length;
+    memcpy(slot->data, data, length);
+    net->delayed_count++;
+    return true;
+}
+
+// 送出延遲佇列中已到時間的封包
+void game_net_flush(GameNet* net)
+{
+    if (net->delayed_count == 0) return;
+    int64_t now = game_net_now_us();
+    for (int i = 0; i < GAME_NET_MAX_DELAYED && net->delayed_count > 0; i++) {
+        GameNetDelayed* slot = &net->delayed[i];
+        if (slot->length == 0 || slot->deliver_us > now) continue;
+        net_send_now(net, &slot->to, slot->data, slot->length);
+        slot->length = 0;
+        net->delayed_count--;
+    }
+}
+
+//==============================================================
+// [ 接收 ]
+//==============================================================
+// 接收一個封包
+int game_net_recv(GameNet* net, void* buffer, size_t capacity, GameNetAddress* from)
+{
+    if (net->socket == -1) return -1;
+    struct sockaddr_in sa;
+    socklen_t length = sizeof(sa);
+    int received = (int)recvfrom((net_socket_t)net->socket, (char*)buffer, (int)capacity, 0,
+        (struct sockaddr*)&sa, &length);
+    if (received < 0) return -1;
+    if (from) {
+        from->ip = ntohl(sa.sin_addr.s_addr);
+        from->port = ntohs(sa.sin_port);
+    }
+    net->packets_received++;
+    net->bytes_received += (uint64_t)received;
+    return received;
+}
+
+// 等待封包到達 (延遲佇列中的封包到時間時提早返回)
+bool game_net_wait(GameNet* net, int timeout_ms)
+{
+    if (net->socket == -1) return false;
+    int64_t timeout_us = (int64_t)(timeout_ms > 0 ? timeout_ms : 0) * 1000;
+    if (net->delayed_count > 0) {
+        int64_t now = game_net_now_us();
+        for (int i = 0; i < GAME_NET_MAX_DELAYED; i++) {
+            const GameNetDelayed* slot = &net->delayed[i];
+            if (slot->length == 0) continue;
+            int64_t wait = slot->deliver_us - now;
+            if (wait < timeout_us) timeout_us = wait > 0 ? wait : 0;
+        }
+    }
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET((net_socket_t)net->socket, &readable);
+    struct timeval tv;
+    tv.tv_sec = (long)(timeout_us / 1000000);
+    tv.tv_usec = (long)(timeout_us % 1000000);
+    int ready = select((int)net->socket + 1, &readable, NULL, NULL, &tv);
+    game_net_flush(net);
+    return ready > 0;
+}
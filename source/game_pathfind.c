@@ -0,0 +1,446 @@
+#include "game_pathfind.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 每處理這麼多格子檢查一次時間
+#define PATH_CLOCK_INTERVAL 256
+// 預設的每次更新上限
+#define PATH_DEFAULT_WORK   (1L << 20)
+
+//==============================================================
+// [ 工具 ]
+//==============================================================
+// 目前時間 (微秒)
+static long long path_now_us(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 取得距離 (世代不同視為無法到達)
+static int field_get(const PathField* f, int c)
+{
+    return f->stamp[c] == f->generation ? f->dist[c] : PATH_DIST_INF;
+}
+
+static void field_set(PathField* f, int c, int d)
+{
+    f->dist[c] = d;
+    f->stamp[c] = f->generation;
+}
+
+// 取得格子的四個鄰格 (含邊界循環)
+static void field_neighbors(const PathField* f, int c, int out[4])
+{
+    int w = f->width;
+    int x = c % w;
+    out[0] = c >= w ? c - w : c + f->cells - w;           // 上
+    out[1] = c + w < f->cells ? c + w : c + w - f->cells; // 下
+    out[2] = x > 0 ? c - 1 : c + w - 1;                   // 左
+    out[3] = x < w - 1 ? c + 1 : c - w + 1;               // 右
+}
+
+// 由可通行的鄰格推得的最短距離
+static int field_best_neighbor(const PathField* f, int c)
+{
+    int nb[4];
+    field_neighbors(f, c, nb);
+    int best = PATH_DIST_INF;
+    for (int i = 0; i < 4; i++) {
+        if (f->blocked[nb[i]] || f->affected[nb[i]]) continue;
+        int d = field_get(f, nb[i]);
+        if (d < best) best = d;
+    }
+    return best == PATH_DIST_INF ? PATH_DIST_INF : best + 1;
+}
+
+// 加入傳播佇列
+static void relax_push(PathField* f, int c)
+{
+    if (f->queued[c]) return;
+    f->queued[c] = 1;
+    int tail = f->relax_head + f->relax_count;
+    if (tail >= f->cells) tail -= f->cells;
+    f->relax[tail] = c;
+    f->relax_count++;
+}
+
+// 標記失效並加入失效檢查佇列
+static void inval_push(PathField* f, int c)
+{
+    f->affected[c] = 1;
+    f->affected_list[f->affected_count++] = c;
+    int tail = f->inval_head + f->inval_count;
+    if (tail >= f->cells) tail -= f->cells;
+    f->inval[tail] = c;
+    f->inval_count++;
+}
+
+//==============================================================
+// [ 建立 / 釋放 ]
+//==============================================================
+// 建立距離場
+bool path_field_init(PathField* field, int width, int height)
+{
+    memset(field, 0, sizeof(*field));
+    field->width = width;
+    field->height = height;
+    field->cells = width * height;
+    size_t n = (size_t)field->cells;
+
+    field->dist = (int32_t*)malloc(n * sizeof(int32_t));
+    field->stamp = (uint32_t*)malloc(n * sizeof(uint32_t));
+    field->blocked = (uint8_t*)malloc(n);
+    field->affected = (uint8_t*)malloc(n);
+    field->queued = (uint8_t*)malloc(n);
+    field->relax = (int32_t*)malloc(n * sizeof(int32_t));
+    field->inval = (int32_t*)malloc(n * sizeof(int32_t));
+    field->affected_list = (int32_t*)malloc(n * sizeof(int32_t));
+    field->events = (int32_t*)malloc(n * sizeof(int32_t));
+    field->generation = 1;
+    field->work_limit = PATH_DEFAULT_WORK;
+
+    if (!field->dist || !field->stamp || !field->blocked || !field->affected || !field->queued
+        || !field->relax || !field->inval || !field->affected_list || !field->events) {
+        path_field_free(field);
+        return false;
+    }
+
+    // 配置時先寫入一次，避免遊戲中第一次存取新的記憶體分頁時才發生缺頁而超過時間上限
+    memset(field->dist, 0, n * sizeof(int32_t));
+    memset(field->stamp, 0, n * sizeof(uint32_t));
+    memset(field->blocked, 0, n);
+    memset(field->affected, 0, n);
+    memset(field->queued, 0, n);
+    memset(field->relax, 0, n * sizeof(int32_t));
+    memset(field->inval, 0, n * sizeof(int32_t));
+    memset(field->affected_list, 0, n * sizeof(int32_t));
+    memset(field->events, 0, n * sizeof(int32_t));
+    return true;
+}
+
+// 釋放距離場
+void path_field_free(PathField* field)
+{
+    free(field->dist);
+    free(field->stamp);
+    free(field->blocked);
+    free(field->affected);
+    free(field->queued);
+    free(field->relax);
+    free(field->inval);
+    free(field->affected_list);
+    free(field->events);
+    memset(field, 0, sizeof(*field));
+}
+
+// 丟棄距離場，下一次更新時重新同步
+void path_field_invalidate(PathField* field)
+{
+    field->synced = false;
+}
+
+//==============================================================
+// [ 重新展開 ]
+//==============================================================
+// 從食物重新展開：換一個世代即可讓所有舊距離失效
+static void field_rebuild(PathField* f, Point food)
+{
+    // 清空進行中的工作，尚未套用的事件直接寫入佔用網格
+    for (int i = 0; i < f->relax_count; i++) {
+        int idx = f->relax_head + i;
+        if (idx >= f->cells) idx -= f->cells;
+        f->queued[f->relax[idx]] = 0;
+    }
+    f->relax_head = f->relax_count = 0;
+    for (int i = 0; i < f->affected_count; i++) f->affected[f->affected_list[i]] = 0;
+    f->affected_count = f->inval_head = f->inval_count = 0;
+    f->reseed_clear = f->reseed_fill = 0;
+    for (int i = 0; i < f->event_count; i++) {
+        int idx = f->event_head + i;
+        if (idx >= f->cells) idx -= f->cells;
+        f->blocked[f->events[idx] >> 1] = (uint8_t)(f->events[idx] & 1);
+    }
+    f->event_head = f->event_count = 0;
+
+    if (++f->generation == 0) {
+        memset(f->stamp, 0, (size_t)f->cells * sizeof(uint32_t));
+        f->generation = 1;
+    }
+    f->food = food;
+    f->rebuilds++;
+
+    int c = food.y * f->width + food.x;
+    if (!f->blocked[c]) {
+        field_set(f, c, 0);
+        relax_push(f, c);
+    }
+}
+
+// 從遊戲狀態重新建立佔用網格並記錄各蛇的位置
+static void field_resync(PathField* f, const GameState* game)
+{
+    memset(f->blocked, 0, (size_t)f->cells);
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        for (int y = obs->y; y < obs->y + obs->height; y++) {
+            for (int x = obs->x; x < obs->x + obs->width; x++) {
+                f->blocked[y * f->width + x] = 1;
+            }
+        }
+    }
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        f->tracked_alive[p] = pl->alive;
+        f->tracked_head[p] = pl->body.head;
+        f->tracked_length[p] = pl->body.length;
+        if (!pl->alive) continue;
+        for (int i = 0; i < pl->body.length; i++) {
+            Point s = snake_body_at(&pl->body, i);
+            f->blocked[s.y * f->width + s.x] = 1;
+        }
+    }
+    f->event_head = f->event_count = 0;
+    f->synced = true;
+    field_rebuild(f, game->food);
+}
+
+//==============================================================
+// [ 事件 ]
+//==============================================================
+// 加入佔用 / 釋放事件，佇列已滿時返回false
+static bool event_push(PathField* f, int c, int block)
+{
+    if (f->event_count >= f->cells) return false;
+    int tail = f->event_head + f->event_count;
+    if (tail >= f->cells) tail -= f->cells;
+    f->events[tail] = c * 2 + block;
+    f->event_count++;
+    return true;
+}
+
+// 比較遊戲狀態與上次同步的位置，把蛇的移動轉成事件。
+// 所有蛇的釋放事件都排在佔用事件之前，一條蛇離開的格子被另一條蛇進入時結果仍然正確。
+static bool field_observe(PathField* f, const GameState* game)
+{
+    int moved[MAX_PLAYERS] = { 0 };
+
+    // 第一輪：釋放
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        const SnakeBody* body = &pl->body;
+        int cap = body->capacity;
+
+        if (!f->tracked_alive[p]) continue;
+
+        // 蛇頭往環狀緩衝區前方移動了 m 格
+        int m = f->tracked_head[p] - body->head;
+        if (m < 0) m += cap;
+        if (m + f->tracked_length[p] > cap) return false; // 舊的節點已被覆寫
+        moved[p] = m;
+
+        // 以新蛇頭為基準：舊蛇身為 [m, m + 舊長度)，新蛇身為 [0, 新長度)，其餘為離開的格子。
+        // 死亡的蛇不再是障礙物，整條蛇身連同離開的格子一起釋放
+        int end = m + f->tracked_length[p];
+        int from = pl->alive ? body->length : 0;
+        if (!pl->alive) moved[p] = 0;
+        for (int i = from; i < end; i++) {
+            Point s = snake_body_at(body, i);
+            if (!event_push(f, s.y * f->width + s.x, 0)) return false;
+        }
+    }
+
+    // 第二輪：佔用新的蛇頭 (蛇身 [0, min(m, 新長度)) 為新進入的格子)
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        int fresh = moved[p] < pl->body.length ? moved[p] : pl->body.length;
+        for (int i = 0; i < fresh; i++) {
+            Point s = snake_body_at(&pl->body, i);
+            if (!event_push(f, s.y * f->width + s.x, 1)) return false;
+        }
+        f->tracked_alive[p] = pl->alive;
+        f->tracked_head[p] = pl->body.head;
+        f->tracked_length[p] = pl->body.length;
+    }
+    return true;
+}
+
+// 套用一個事件
+static void field_apply_event(PathField* f, int ev)
+{
+    int c = ev >> 1;
+    if (ev & 1) {
+        // 佔用：依賴這一格的格子失效
+        if (f->blocked[c]) return;
+        f->blocked[c] = 1;
+        if (field_get(f, c) != PATH_DIST_INF) inval_push(f, c);
+    }
+    else {
+        // 釋放：由鄰格推得距離後向外傳播
+        if (!f->blocked[c]) return;
+        f->blocked[c] = 0;
+        int d = field_best_neighbor(f, c);
+        if (d < field_get(f, c)) {
+            field_set(f, c, d);
+            relax_push(f, c);
+        }
+    }
+}
+
+//==============================================================
+// [ 更新 ]
+//==============================================================
+// 處理一個失效檢查：沒有其他支撐的下游格子也失效
+static void field_step_inval(PathField* f)
+{
+    int u = f->inval[f->inval_head];
+    if (++f->inval_head >= f->cells) f->inval_head = 0;
+    f->inval_count--;
+
+    int du = field_get(f, u);
+    int nb[4];
+    field_neighbors(f, u, nb);
+    for (int i = 0; i < 4; i++) {
+        int v = nb[i];
+        if (f->blocked[v] || f->affected[v] || field_get(f, v) != du + 1) continue;
+
+        // 檢查 v 是否還有其他距離少1的鄰格
+        int vn[4];
+        field_neighbors(f, v, vn);
+        bool supported = false;
+        for (int k = 0; k < 4 && !supported; k++) {
+            int w = vn[k];
+            supported = !f->blocked[w] && !f->affected[w] && field_get(f, w) == du;
+        }
+        if (!supported) inval_push(f, v);
+    }
+}
+
+// 處理一個失效格子的重新設定 (先全部清除，再由鄰格推得距離)
+static void field_step_reseed(PathField* f)
+{
+    if (f->reseed_clear < f->affected_count) {
+        field_set(f, f->affected_list[f->reseed_clear++], PATH_DIST_INF);
+        return;
+    }
+    int c = f->affected_list[f->reseed_fill++];
+    f->affected[c] = 0;
+    if (!f->blocked[c]) {
+        int d = field_best_neighbor(f, c);
+        if (d != PATH_DIST_INF) {
+            field_set(f, c, d);
+            relax_push(f, c);
+        }
+    }
+    if (f->reseed_fill == f->affected_count) {
+        f->affected_count = f->reseed_clear = f->reseed_fill = 0;
+    }
+}
+
+// 處理一個傳播：讓鄰格的距離變短
+static void field_step_relax(PathField* f)
+{
+    int u = f->relax[f->relax_head];
+    if (++f->relax_head >= f->cells) f->relax_head = 0;
+    f->relax_count--;
+    f->queued[u] = 0;
+
+    int du = field_get(f, u);
+    if (du == PATH_DIST_INF || f->blocked[u]) return;
+    int nb[4];
+    field_neighbors(f, u, nb);
+    for (int i = 0; i < 4; i++) {
+        int v = nb[i];
+        if (f->blocked[v] || f->affected[v]) continue;
+        if (du + 1 < field_get(f, v)) {
+            field_set(f, v, du + 1);
+            relax_push(f, v);
+        }
+    }
+}
+
+// 與遊戲狀態同步並在上限內更新距離場
+bool path_field_update(PathField* field, const GameState* game)
+{
+    long long start = path_now_us();
+    field->updates++;
+
+    if (!field->synced || !field_observe(field, game)) {
+        field_resync(field, game);
+    }
+    else if (game->food.x != field->food.x || game->food.y != field->food.y) {
+        field_rebuild(field, game->food);
+    }
+
+    long work = 0;
+    bool settled = false;
+    while (work < field->work_limit) {
+        if (field->time_limit_us > 0 && work % PATH_CLOCK_INTERVAL == PATH_CLOCK_INTERVAL - 1
+            && path_now_us() - start >= field->time_limit_us) {
+            break;
+        }
+        // 失效檢查完成後才重新設定，重新設定完成後才傳播，全部完成後才套用下一個事件
+        if (field->inval_count > 0) field_step_inval(field);
+        else if (field->affected_count > 0) field_step_reseed(field);
+        else if (field->relax_count > 0) field_step_relax(field);
+        else if (field->event_count > 0) {
+            int ev = field->events[field->event_head];
+            if (++field->event_head >= field->cells) field->event_head = 0;
+            field->event_count--;
+            field_apply_event(field, ev);
+        }
+        else {
+            settled = true;
+            break;
+        }
+        work++;
+    }
+
+    if (!settled) field->unsettled++;
+    field->work += (unsigned long long)work;
+    long elapsed = (long)(path_now_us() - start);
+    if (elapsed > field->max_update_us) field->max_update_us = elapsed;
+    return settled;
+}
+
+//==============================================================
+// [ 查詢 ]
+//==============================================================
+// 取得格子到食物的距離
+int path_field_distance(const PathField* field, int x, int y)
+{
+    int c = y * field->width + x;
+    if (field->blocked[c]) return PATH_DIST_INF;
+    return field_get(field, c);
+}
+
+// 依距離場為玩家選擇下一步方向
+bool path_field_choose(const PathField* field, const GameState* game, int player, Direction* dir)
+{
+    static const Direction opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    const Player* pl = &game->players[player];
+    Point h = snake_body_at(&pl->body, 0);
+    int c = h.y * field->width + h.x;
+    int nb[4];
+    field_neighbors(field, c, nb);
+
+    int best = PATH_DIST_INF;
+    Direction choice = pl->next_direction;
+    for (int d = 0; d < 4; d++) {
+        if ((Direction)d == opposite[pl->next_direction]) continue;
+        Point p = { nb[d] % field->width, nb[d] / field->width };
+        if (game_check_collision(game, player, p)) continue;
+        int dist = field_get(field, nb[d]);
+        if (field->affected[nb[d]]) dist = PATH_DIST_INF;
+        if (dist < best || (dist == best && dist != PATH_DIST_INF && (Direction)d == pl->next_direction)) {
+            best = dist;
+            choice = (Direction)d;
+        }
+    }
+    if (best == PATH_DIST_INF) return false;
+    *dir = choice;
+    return true;
+}
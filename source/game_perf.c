@@ -0,0 +1,111 @@
+#include "game_perf.h"
+
+#include <stdio.h>
+
+typedef char perf_check_ring[(GAME_PERF_RING & (GAME_PERF_RING - 1)) == 0 ? 1 : -1];
+
+//==============================================================
+// [ 記錄 ]
+//==============================================================
+// 記錄一個樣本
+void game_perf_push(GamePerf* perf, GamePerfSeries series, float value)
+{
+    GamePerfRing* ring = &perf->series[series];
+    ring->samples[ring->head & (GAME_PERF_RING - 1)] = value;
+    ring->head++;
+}
+
+//==============================================================
+// [ 統計 ]
+//==============================================================
+// 把第 k 小的樣本移到位置 k，左邊都不大於它、右邊都不小於它 (快速選擇，不配置記憶體)
+static void select_nth(float* v, int lo, int hi, int k)
+{
+    while (lo < hi) {
+        float pivot = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                float t = v[i];
+                v[i] = v[j];
+                v[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else return;
+    }
+}
+
+// 取得一個項目最近的樣本 (由舊到新)
+int game_perf_recent(const GamePerf* perf, GamePerfSeries series, float* out, int capacity)
+{
+    const GamePerfRing* ring = &perf->series[series];
+    uint32_t count = ring->head < GAME_PERF_RING ? ring->head : GAME_PERF_RING;
+    if (count > (uint32_t)capacity) count = (uint32_t)capacity;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = ring->samples[(ring->head - count + i) & (GAME_PERF_RING - 1)];
+    }
+    return (int)count;
+}
+
+// 計算一個項目目前視窗內的統計
+void game_perf_stats(const GamePerf* perf, GamePerfSeries series, GamePerfStats* stats)
+{
+    float sorted[GAME_PERF_RING];      // 選擇時會重排的副本
+    int count = game_perf_recent(perf, series, sorted, GAME_PERF_RING);
+    stats->count = count;
+    if (count == 0) {
+        stats->last = stats->mean = stats->p50 = stats->p99 = stats->max = 0.0f;
+        return;
+    }
+    stats->last = sorted[count - 1];
+    double sum = 0.0;
+    float max = sorted[0];
+    for (int i = 0; i < count; i++) {
+        sum += sorted[i];
+        if (sorted[i] > max) max = sorted[i];
+    }
+    // 只需要兩個百分位數：先選出 p50，p99 只在它右邊的部分選擇
+    int mid = count / 2, high = (count * 99) / 100;
+    select_nth(sorted, 0, count - 1, mid);
+    select_nth(sorted, mid, count - 1, high);
+    stats->mean = (float)(sum / count);
+    stats->p50 = sorted[mid];
+    stats->p99 = sorted[high];
+    stats->max = max;
+}
+
+// 把目前的統計排成疊加層的文字
+int game_perf_format(const GamePerf* perf, char lines[GAME_PERF_MAX_LINES][GAME_PERF_LINE_BYTES])
+{
+    GamePerfStats frame, interval, tick, jitter, input;
+    game_perf_stats(perf, PERF_FRAME, &frame);
+    game_perf_stats(perf, PERF_FRAME_INTERVAL, &interval);
+    game_perf_stats(perf, PERF_TICK, &tick);
+    game_perf_stats(perf, PERF_TICK_JITTER, &jitter);
+    game_perf_stats(perf, PERF_INPUT, &input);
+
+    int n = 0;
+    snprintf(lines[n++], GAME_PERF_LINE_BYTES, "FPS %5.1f  (interval p99 %.1f ms)",
+        interval.mean > 0.0f ? 1000.0f / interval.mean : 0.0f, interval.p99);
+    snprintf(lines[n++], GAME_PERF_LINE_BYTES, "frame  %6.2f ms  p99 %6.2f  max %6.2f",
+        frame.p50, frame.p99, frame.max);
+    snprintf(lines[n++], GAME_PERF_LINE_BYTES, "tick   %6.3f ms  p99 %6.3f  max %6.3f",
+        tick.p50, tick.p99, tick.max);
+    snprintf(lines[n++], GAME_PERF_LINE_BYTES, "jitter %6.2f ms  p99 %6.2f  max %6.2f",
+        jitter.p50, jitter.p99, jitter.max);
+    if (input.count > 0) {
+        snprintf(lines[n++], GAME_PERF_LINE_BYTES, "input  %6.2f ms  p99 %6.2f  (%d turns)",
+            input.p50, input.p99, input.count);
+    }
+    else {
+        snprintf(lines[n++], GAME_PERF_LINE_BYTES, "input       -");
+    }
+    snprintf(lines[n++], GAME_PERF_LINE_BYTES, "audio  %d voices", perf->voices);
+    return n;
+}
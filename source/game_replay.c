@@ -0,0 +1,243 @@
+#include "game_replay.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 方向在文字檔中的代號 (依 Direction 的順序)
+static const char replay_dir_names[4] = { 'U', 'D', 'L', 'R' };
+
+//==============================================================
+// [ 建立 / 釋放 ]
+//==============================================================
+// 建立空白重播
+void game_replay_init(GameReplay* replay, int width, int height, int player_count, uint64_t seed)
+{
+    memset(replay, 0, sizeof(*replay));
+    replay->width = width;
+    replay->height = height;
+    replay->player_count = player_count;
+    replay->seed = seed;
+}
+
+// 釋放重播輸入
+void game_replay_free(GameReplay* replay)
+{
+    free(replay->inputs);
+    memset(replay, 0, sizeof(*replay));
+}
+
+// 確保輸入陣列至少有 count 個空間
+static bool replay_reserve(GameReplay* replay, int count)
+{
+    if (count <= replay->input_capacity) return true;
+    int capacity = replay->input_capacity ? replay->input_capacity : 64;
+    while (capacity < count) capacity *= 2;
+    GameReplayInput* inputs = (GameReplayInput*)realloc(replay->inputs, (size_t)capacity * sizeof(GameReplayInput));
+    if (!inputs) return false;
+    replay->inputs = inputs;
+    replay->input_capacity = capacity;
+    return true;
+}
+
+// 複製重播
+bool game_replay_copy(GameReplay* dst, const GameReplay* src)
+{
+    if (!replay_reserve(dst, src->input_count)) return false;
+    GameReplayInput* inputs = dst->inputs;
+    int capacity = dst->input_capacity;
+    *dst = *src;
+    dst->inputs = inputs;
+    dst->input_capacity = capacity;
+    if (src->input_count > 0) memcpy(dst->inputs, src->inputs, (size_t)src->input_count * sizeof(GameReplayInput));
+    return true;
+}
+
+// 在尾端加入一次輸入
+bool game_replay_add(GameReplay* replay, long step, int player, Direction dir)
+{
+    if (step < 0 || step > UINT32_MAX) return false;
+    if (replay->input_count > 0 && (uint32_t)step < replay->inputs[replay->input_count - 1].step) return false;
+    if (!replay_reserve(replay, replay->input_count + 1)) return false;
+    GameReplayInput* in = &replay->inputs[replay->input_count++];
+    in->step = (uint32_t)step;
+    in->player = (uint8_t)player;
+    in->direction = (uint8_t)dir;
+    return true;
+}
+
+// 移除從第 step 次移動開始的輸入
+void game_replay_truncate(GameReplay* replay, long step)
+{
+    while (replay->input_count > 0 && (long)replay->inputs[replay->input_count - 1].step >= step) {
+        replay->input_count--;
+    }
+    if (replay->steps > step) replay->steps = step;
+}
+
+//==============================================================
+// [ 播放 ]
+//==============================================================
+// 開始一局並建立播放位置
+bool game_replay_start(GameReplayCursor* cursor, const GameReplay* replay, GameState* game)
+{
+    if (replay->player_count < 1 || replay->player_count > MAX_PLAYERS) return false;
+    if (replay->width < 4 || replay->height < 4) return false;
+    if (!game_state_resize(game, replay->width, replay->height)) return false;
+
+    game_seed(game, replay->seed);
+    if (replay->player_count == 1) game_new_single(game);
+    else game_new_multi(game);
+
+    cursor->replay = replay;
+    cursor->game = game;
+    cursor->step = 0;
+    cursor->next_input = 0;
+    return true;
+}
+
+// 套用輸入後移動一步
+int game_replay_next(GameReplayCursor* cursor, GameEvent* event)
+{
+    const GameReplay* replay = cursor->replay;
+    GameState* game = cursor->game;
+    if (cursor->step >= replay->steps) return -1;
+
+    // 輸入只改變方向，不影響輪到誰移動；所有玩家都死亡時不再套用輸入，局面停在最後一步
+    int player = game_next_mover(game);
+    if (player < 0) return -1;
+
+    // 套用本次移動之前的所有輸入 (超出範圍的輸入不影響局面)
+    while (cursor->next_input < replay->input_count
+        && replay->inputs[cursor->next_input].step <= (uint32_t)cursor->step)
+    {
+        const GameReplayInput* in = &replay->inputs[cursor->next_input++];
+        if (in->player < game->player_count && in->direction < 4) {
+            game_turn(game, in->player, (Direction)in->direction);
+        }
+    }
+
+    GameEvent e = game_step_player(game, player);
+    if (event) *event = e;
+    cursor->step++;
+    return player;
+}
+
+//==============================================================
+// [ 文字存檔 ]
+//==============================================================
+// 把重播寫成文字
+bool game_replay_write(const GameReplay* replay, FILE* out)
+{
+    fprintf(out, "%s %d\n", GAME_REPLAY_MAGIC, GAME_REPLAY_VERSION);
+    fprintf(out, "grid %d %d\n", replay->width, replay->height);
+    fprintf(out, "players %d\n", replay->player_count);
+    fprintf(out, "seed %llu\n", (unsigned long long)replay->seed);
+    fprintf(out, "steps %ld\n", replay->steps);
+    for (int i = 0; i < replay->input_count; i++) {
+        const GameReplayInput* in = &replay->inputs[i];
+        fprintf(out, "turn %u %u %c\n", (unsigned)in->step, (unsigned)in->player,
+            replay_dir_names[in->direction & 3]);
+    }
+    fprintf(out, "end\n");
+    return !ferror(out);
+}
+
+// 把一行切成以空白分隔的欄位 (就地修改；不使用 sscanf / strtok，MSVC 的 /sdl 把它們視為錯誤)，返回欄位數
+static int replay_split(char* line, char* fields[], int max)
+{
+    int count = 0;
+    char* p = line;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0') return count;
+        if (count == max) return max + 1; // 欄位過多
+        fields[count++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+        if (*p) *p++ = '\0';
+    }
+}
+
+// 解析整個欄位為十進位整數 (範圍 min~max)
+static bool replay_parse_long(const char* text, long min, long max, long* out)
+{
+    char* end;
+    errno = 0;
+    long value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || value < min || value > max) return false;
+    *out = value;
+    return true;
+}
+
+// 解析整個欄位為十進位無號整數
+static bool replay_parse_u64(const char* text, uint64_t* out)
+{
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || *text == '-' || errno == ERANGE) return false;
+    *out = value;
+    return true;
+}
+
+// 從文字讀取重播 (# 開頭的行為註解，可出現在識別字之前)
+bool game_replay_read(GameReplay* replay, FILE* in)
+{
+    char line[256];
+    char* fields[4];
+    long version = 0;
+    do {
+        if (!fgets(line, sizeof(line), in)) return false;
+    } while (line[0] == '#');
+    if (replay_split(line, fields, 2) != 2
+        || strcmp(fields[0], GAME_REPLAY_MAGIC) != 0
+        || !replay_parse_long(fields[1], 0, INT_MAX, &version) || version != GAME_REPLAY_VERSION)
+    {
+        return false;
+    }
+
+    replay->width = replay->height = replay->player_count = 0;
+    replay->seed = 0;
+    replay->steps = 0;
+    replay->input_count = 0;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#') continue;
+        int count = replay_split(line, fields, 4);
+        if (count == 0) continue;
+        const char* key = fields[0];
+        if (strcmp(key, "end") == 0) return replay->player_count > 0;
+
+        bool ok;
+        long a, b;
+        if (strcmp(key, "grid") == 0) {
+            ok = count == 3 && replay_parse_long(fields[1], INT_MIN, INT_MAX, &a)
+                && replay_parse_long(fields[2], INT_MIN, INT_MAX, &b);
+            if (ok) {
+                replay->width = (int)a;
+                replay->height = (int)b;
+            }
+        }
+        else if (strcmp(key, "players") == 0) {
+            ok = count == 2 && replay_parse_long(fields[1], INT_MIN, INT_MAX, &a);
+            if (ok) replay->player_count = (int)a;
+        }
+        else if (strcmp(key, "seed") == 0) {
+            ok = count == 2 && replay_parse_u64(fields[1], &replay->seed);
+        }
+        else if (strcmp(key, "steps") == 0) {
+            ok = count == 2 && replay_parse_long(fields[1], LONG_MIN, LONG_MAX, &replay->steps);
+        }
+        else if (strcmp(key, "turn") == 0) {
+            ok = count == 4 && replay_parse_long(fields[1], LONG_MIN, LONG_MAX, &a)
+                && replay_parse_long(fields[2], 0, MAX_PLAYERS - 1, &b) && fields[3][1] == '\0';
+            const char* name = ok ? memchr(replay_dir_names, fields[3][0], sizeof(replay_dir_names)) : NULL;
+            ok = name && game_replay_add(replay, a, (int)b, (Direction)(name - replay_dir_names));
+        }
+        else {
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+    return false; // 缺少 end
+}
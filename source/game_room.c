@@ -0,0 +1,277 @@
+#include "game_room.h"
+
+#include <string.h>
+
+// MOVE 的旗標
+#define MOVE_FLAG_ECHO 0x01  // 帶有時間戳回應
+
+//==============================================================
+// [ 編碼 ]
+//==============================================================
+static void put_u16(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static uint32_t get_u16(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+// 編碼一個訊息
+int game_room_encode(const GameRoomMessage* m, uint8_t* buffer)
+{
+    int length;
+    buffer[1] = m->type;
+    switch (m->type) {
+    case ROOM_MSG_JOIN:
+        buffer[2] = GAME_ROOM_VERSION;
+        put_u32(buffer + 3, m->client_id);
+        length = 7;
+        break;
+    case ROOM_MSG_INPUT:
+        put_u32(buffer + 2, m->room);
+        buffer[6] = m->player;
+        put_u16(buffer + 7, m->seq);
+        buffer[9] = m->direction;
+        put_u32(buffer + 10, m->stamp);
+        length = 14;
+        break;
+    case ROOM_MSG_WELCOME:
+        put_u32(buffer + 2, m->room);
+        buffer[6] = m->player;
+        buffer[7] = m->width;
+        buffer[8] = m->height;
+        put_u32(buffer + 9, (uint32_t)m->seed);
+        put_u32(buffer + 13, (uint32_t)(m->seed >> 32));
+        length = 17;
+        break;
+    case ROOM_MSG_MOVE:
+        buffer[2] = m->has_echo ? MOVE_FLAG_ECHO : 0;
+        put_u32(buffer + 3, m->frame);
+        buffer[7] = m->player;
+        buffer[8] = m->direction;
+        buffer[9] = m->event;
+        buffer[10] = m->head_x;
+        buffer[11] = m->head_y;
+        buffer[12] = m->food_x;
+        buffer[13] = m->food_y;
+        put_u16(buffer + 14, (uint16_t)m->scores[0]);
+        put_u16(buffer + 16, (uint16_t)m->scores[1]);
+        put_u16(buffer + 18, m->seq);
+        length = 20;
+        if (m->has_echo) {
+            put_u32(buffer + 20, m->stamp);
+            length = 24;
+        }
+        break;
+    case ROOM_MSG_OVER:
+        buffer[2] = m->winner;
+        put_u16(buffer + 3, (uint16_t)m->scores[0]);
+        put_u16(buffer + 5, (uint16_t)m->scores[1]);
+        put_u32(buffer + 7, m->frame);
+        length = 11;
+        break;
+    default:
+        return 0;
+    }
+    buffer[0] = (uint8_t)length;
+    return length;
+}
+
+// 從資料流開頭解碼一個訊息
+int game_room_decode(const uint8_t* data, int length, GameRoomMessage* m)
+{
+    if (length < 2) return 0;
+    int size = data[0];
+    if (size < 2 || size > GAME_ROOM_MAX_MESSAGE) return -1;
+    if (length < size) return 0;
+
+    memset(m, 0, sizeof(*m));
+    m->type = data[1];
+    switch (m->type) {
+    case ROOM_MSG_JOIN:
+        if (size != 7 || data[2] != GAME_ROOM_VERSION) return -1;
+        m->client_id = get_u32(data + 3);
+        break;
+    case ROOM_MSG_INPUT:
+        if (size != 14 || data[6] >= MAX_PLAYERS || data[9] > DIR_RIGHT) return -1;
+        m->room = get_u32(data + 2);
+        m->player = data[6];
+        m->seq = (uint16_t)get_u16(data + 7);
+        m->direction = data[9];
+        m->stamp = get_u32(data + 10);
+        break;
+    case ROOM_MSG_WELCOME:
+        if (size != 17 || data[6] >= MAX_PLAYERS) return -1;
+        m->room = get_u32(data + 2);
+        m->player = data[6];
+        m->width = data[7];
+        m->height = data[8];
+        m->seed = (uint64_t)get_u32(data + 9) | ((uint64_t)get_u32(data + 13) << 32);
+        break;
+    case ROOM_MSG_MOVE:
+        m->has_echo = (data[2] & MOVE_FLAG_ECHO) != 0;
+        if (size != (m->has_echo ? 24 : 20)) return -1;
+        m->frame = get_u32(data + 3);
+        m->player = data[7];
+        m->direction = data[8];
+        m->event = data[9];
+        m->head_x = data[10];
+        m->head_y = data[11];
+        m->food_x = data[12];
+        m->food_y = data[13];
+        m->scores[0] = (int16_t)get_u16(data + 14);
+        m->scores[1] = (int16_t)get_u16(data + 16);
+        m->seq = (uint16_t)get_u16(data + 18);
+        if (m->has_echo) m->stamp = get_u32(data + 20);
+        break;
+    case ROOM_MSG_OVER:
+        if (size != 11) return -1;
+        m->winner = data[2];
+        m->scores[0] = (int16_t)get_u16(data + 3);
+        m->scores[1] = (int16_t)get_u16(data + 5);
+        m->frame = get_u32(data + 7);
+        break;
+    default:
+        return -1;
+    }
+    return size;
+}
+
+//==============================================================
+// [ 房間 ]
+//==============================================================
+// 開始房間的一局
+bool game_room_start(GameRoom* room, uint32_t id, uint64_t seed, int width, int height, double now_ms)
+{
+    // 記憶體區塊在房間重複使用時保留，只在尺寸改變時重新配置
+    if (!game_state_resize(&room->game, width, height)) return false;
+    room->id = id;
+    room->seed = seed;
+    game_seed(&room->game, seed);
+    game_new_multi(&room->game);
+    room->origin_ms = now_ms + GAME_ROOM_START_DELAY_MS;
+    room->frame = 0;
+    room->over = false;
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        room->seq[p] = 0;
+        room->has_input[p] = false;
+        room->stamp[p] = 0;
+        room->echo_pending[p] = false;
+        room->input_at_ms[p] = -1.0;
+    }
+    return true;
+}
+
+// 釋放房間的記憶體
+void game_room_free(GameRoom* room)
+{
+    game_state_free(&room->game);
+}
+
+// 套用玩家的轉向
+bool game_room_input(GameRoom* room, int player, uint16_t seq, Direction dir, uint32_t stamp, double now_ms)
+{
+    if (room->over || player < 0 || player >= MAX_PLAYERS || !room->game.players[player].alive) return false;
+    if (room->has_input[player] && (int16_t)(uint16_t)(seq - room->seq[player]) <= 0) return false;
+    room->has_input[player] = true;
+    room->seq[player] = seq;
+    room->stamp[player] = stamp;
+    room->echo_pending[player] = true;
+    if (room->input_at_ms[player] < 0.0) room->input_at_ms[player] = now_ms;
+    game_turn(&room->game, player, dir);
+    return true;
+}
+
+// 下一次移動的時間
+double game_room_due_ms(const GameRoom* room)
+{
+    if (room->over) return -1.0;
+    int mover = game_next_mover(&room->game);
+    if (mover < 0) return room->origin_ms;
+    const Player* pl = &room->game.players[mover];
+    return room->origin_ms + (double)(pl->elapsed_ms + pl->interval);
+}
+
+// 結算 (與 end_two_player_game 相同：比較分數，同分比較存活時間)
+static void room_finish(GameRoom* room)
+{
+    GameState* game = &room->game;
+    for (int p = 0; p < game->player_count; p++) {
+        // 達到移動上限時仍存活的玩家以目前的遊戲時間作為存活時間
+        if (game->players[p].alive) game->players[p].survival_ms = game->players[p].elapsed_ms;
+    }
+    game_decide_winner(game);
+    room->over = true;
+}
+
+// 移動一步
+int game_room_step(GameRoom* room, double now_ms, GameEvent* event)
+{
+    if (room->over) return -2;
+    GameState* game = &room->game;
+    int mover = game_next_mover(game);
+    if (mover < 0) {
+        room_finish(room);
+        return -2;
+    }
+    const Player* pl = &game->players[mover];
+    if (now_ms < room->origin_ms + (double)(pl->elapsed_ms + pl->interval)) return -1;
+
+    GameEvent e = game_step_player(game, mover);
+    if (event) *event = e;
+    room->frame++;
+    if (game_all_dead(game) || room->frame >= GAME_ROOM_MAX_MOVES) room_finish(room);
+    return mover;
+}
+
+// 產生給某位玩家的 MOVE 訊息
+void game_room_move_message(GameRoom* room, int mover, GameEvent event, int recipient, GameRoomMessage* m)
+{
+    const GameState* game = &room->game;
+    const Player* pl = &game->players[mover];
+    Point head = snake_body_at(&pl->body, 0);
+    memset(m, 0, sizeof(*m));
+    m->type = ROOM_MSG_MOVE;
+    m->frame = (uint32_t)room->frame;
+    m->player = (uint8_t)mover;
+    m->direction = (uint8_t)pl->direction;
+    m->event = (uint8_t)event;
+    m->head_x = (uint8_t)head.x;
+    m->head_y = (uint8_t)head.y;
+    m->food_x = (uint8_t)game->food.x;
+    m->food_y = (uint8_t)game->food.y;
+    m->scores[0] = (int16_t)game->players[0].score;
+    m->scores[1] = (int16_t)game->players[1].score;
+    m->seq = room->seq[recipient];
+    // 收件人的蛇這一步用上了新的輸入：回應時間戳
+    if (mover == recipient && room->echo_pending[recipient]) {
+        m->has_echo = true;
+        m->stamp = room->stamp[recipient];
+        room->echo_pending[recipient] = false;
+    }
+}
+
+// 產生 OVER 訊息
+void game_room_over_message(const GameRoom* room, GameRoomMessage* m)
+{
+    memset(m, 0, sizeof(*m));
+    m->type = ROOM_MSG_OVER;
+    m->winner = (uint8_t)room->game.winner;
+    m->scores[0] = (int16_t)room->game.players[0].score;
+    m->scores[1] = (int16_t)room->game.players[1].score;
+    m->frame = (uint32_t)room->frame;
+}
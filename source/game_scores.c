@@ -0,0 +1,332 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L // fileno, fsync
+#endif
+#include "game_scores.h"
+#include "game_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#define scores_fsync(fd) _commit(fd)
+#define scores_fileno(file) _fileno(file)
+#else
+#include <unistd.h>
+#define scores_fsync(fd) fsync(fd)
+#define scores_fileno(file) fileno(file)
+#endif
+
+// 紀錄檔的記憶體配置必須與結構完全相同，才能整塊讀寫
+typedef char scores_check_record[(sizeof(GameScoreRecord) == 32) ? 1 : -1];
+typedef char scores_check_header[(sizeof(GameScoreHeader) == 8) ? 1 : -1];
+
+#define SCORES_CHECKED_BYTES offsetof(GameScoreRecord, check) // 檢查碼涵蓋的位元組數
+#define SCORES_READ_BATCH 4096                                 // 載入時一次讀取的紀錄數
+#define SCORES_MIN_CAPACITY 64                                 // 雜湊表的初始大小
+
+//==============================================================
+// [ 紀錄 ]
+//==============================================================
+// 紀錄的檢查碼 (FNV-1a)
+static uint32_t record_check(const GameScoreRecord* record)
+{
+    const unsigned char* p = (const unsigned char*)record;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < SCORES_CHECKED_BYTES; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+// 排行榜的順序：分數高的在前，同分時較早的在前，再以種子區分
+static bool record_better(const GameScoreRecord* a, const GameScoreRecord* b)
+{
+    if (a->score != b->score) return a->score > b->score;
+    if (a->time != b->time) return a->time < b->time;
+    return a->seed < b->seed;
+}
+
+// 兩筆紀錄是否相同 (不比較檢查碼)
+static bool record_equal(const GameScoreRecord* a, const GameScoreRecord* b)
+{
+    return memcmp(a, b, SCORES_CHECKED_BYTES) == 0;
+}
+
+//==============================================================
+// [ 索引 ]
+//==============================================================
+// 網格尺寸的雜湊
+static size_t best_slot(int width, int height, size_t capacity)
+{
+    uint64_t z = ((uint64_t)(uint16_t)width << 16) | (uint16_t)height;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (size_t)z & (capacity - 1);
+}
+
+// 找出紀錄所在或應放入的位置
+static GameScoreRecord* best_find(GameScoreRecord* table, size_t capacity, int width, int height)
+{
+    size_t i = best_slot(width, height, capacity);
+    for (;;) {
+        GameScoreRecord* r = &table[i];
+        if (r->width == 0 || (r->width == width && r->height == height)) return r;
+        i = (i + 1) & (capacity - 1);
+    }
+}
+
+// 擴大雜湊表 (使用率維持在 3/4 以下)
+static bool best_grow(GameScores* scores)
+{
+    size_t capacity = scores->best_capacity ? scores->best_capacity * 2 : SCORES_MIN_CAPACITY;
+    GameScoreRecord* table = (GameScoreRecord*)calloc(capacity, sizeof(GameScoreRecord));
+    if (!table) return false;
+    for (size_t i = 0; i < scores->best_capacity; i++) {
+        const GameScoreRecord* r = &scores->best[i];
+        if (r->width) *best_find(table, capacity, r->width, r->height) = *r;
+    }
+    free(scores->best);
+    scores->best = table;
+    scores->best_capacity = capacity;
+    return true;
+}
+
+// 初始化空的索引
+void game_scores_init(GameScores* scores)
+{
+    memset(scores, 0, sizeof(*scores));
+}
+
+// 釋放索引的記憶體
+void game_scores_free(GameScores* scores)
+{
+    free(scores->best);
+    game_scores_init(scores);
+}
+
+// 把一局的成績加入索引
+int game_scores_insert(GameScores* scores, const GameScoreRecord* record)
+{
+    if (record->width == 0) return -1;
+
+    // 每個網格尺寸的最佳成績
+    if ((scores->best_count + 1) * 4 > scores->best_capacity * 3 && !best_grow(scores)) return -1;
+    GameScoreRecord* slot = best_find(scores->best, scores->best_capacity, record->width, record->height);
+    if (slot->width == 0) {
+        *slot = *record;
+        scores->best_count++;
+    }
+    else if (record_better(record, slot)) {
+        *slot = *record;
+    }
+
+    // 總排行榜：以二分搜尋找到名次後插入
+    int n = scores->top_count;
+    if (n == GAME_SCORES_TOP && !record_better(record, &scores->top[n - 1])) return 0;
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (record_better(record, &scores->top[mid])) hi = mid;
+        else lo = mid + 1;
+    }
+    if (n == GAME_SCORES_TOP) n--;
+    memmove(&scores->top[lo + 1], &scores->top[lo], (size_t)(n - lo) * sizeof(GameScoreRecord));
+    scores->top[lo] = *record;
+    scores->top_count = n + 1;
+    return lo + 1;
+}
+
+// 查詢某個網格尺寸的最佳成績
+const GameScoreRecord* game_scores_best(const GameScores* scores, int width, int height)
+{
+    if (scores->best_count == 0 || width <= 0) return NULL;
+    const GameScoreRecord* r = best_find(scores->best, scores->best_capacity, width, height);
+    return r->width ? r : NULL;
+}
+
+// 取得總排行榜
+const GameScoreRecord* game_scores_top(const GameScores* scores, int* count)
+{
+    *count = scores->top_count;
+    return scores->top;
+}
+
+// 排行榜上的紀錄是否已經是該網格尺寸的最佳成績 (壓縮時不重複寫入)
+static bool top_is_best(const GameScores* scores, const GameScoreRecord* record)
+{
+    const GameScoreRecord* best = game_scores_best(scores, record->width, record->height);
+    return best && record_equal(best, record);
+}
+
+// 計算壓縮後會保留的紀錄數
+long game_scores_live(const GameScores* scores)
+{
+    long live = (long)scores->best_count;
+    for (int i = 0; i < scores->top_count; i++) {
+        if (!top_is_best(scores, &scores->top[i])) live++;
+    }
+    return live;
+}
+
+//==============================================================
+// [ 紀錄檔 ]
+//==============================================================
+// 載入紀錄檔並加入索引
+bool game_scores_load(GameScores* scores, const char* path)
+{
+    scores->records = 0;
+    scores->torn = 0;
+    FILE* file = game_fopen(path, "rb");
+    if (!file) return true; // 還沒有紀錄
+
+    GameScoreHeader header;
+    size_t got = fread(&header, 1, sizeof(header), file);
+    if (got < sizeof(header)) {
+        // 建立檔案時就當機：視為空的紀錄檔
+        scores->torn = (long)got;
+        fclose(file);
+        return true;
+    }
+    if (memcmp(header.magic, GAME_SCORES_MAGIC, sizeof(header.magic)) != 0
+        || header.version != GAME_SCORES_VERSION || header.record_size != sizeof(GameScoreRecord)) {
+        fclose(file);
+        return false;
+    }
+
+    GameScoreRecord* batch = (GameScoreRecord*)malloc(SCORES_READ_BATCH * sizeof(GameScoreRecord));
+    if (!batch) {
+        fclose(file);
+        return false;
+    }
+    bool ok = true;
+    for (;;) {
+        size_t bytes = fread(batch, 1, SCORES_READ_BATCH * sizeof(GameScoreRecord), file);
+        size_t count = bytes / sizeof(GameScoreRecord);
+        size_t i = 0;
+        for (; i < count; i++) {
+            if (batch[i].check != record_check(&batch[i]) || batch[i].width == 0) break;
+            if (game_scores_insert(scores, &batch[i]) < 0) {
+                ok = false;
+                break;
+            }
+            scores->records++;
+        }
+        if (!ok) break;
+        if (i < count || bytes % sizeof(GameScoreRecord) != 0) {
+            // 第一筆損壞的紀錄之後的內容都不採用
+            long valid = (long)(sizeof(header) + (size_t)scores->records * sizeof(GameScoreRecord));
+            fseek(file, 0, SEEK_END);
+            scores->torn = ftell(file) - valid;
+            break;
+        }
+        if (bytes < SCORES_READ_BATCH * sizeof(GameScoreRecord)) break;
+    }
+    if (ferror(file)) ok = false;
+    free(batch);
+    fclose(file);
+    return ok;
+}
+
+// 寫出並等待資料寫到磁碟
+static bool scores_flush(FILE* file, bool sync)
+{
+    if (fflush(file) != 0) return false;
+    return !sync || scores_fsync(scores_fileno(file)) == 0;
+}
+
+// 寫入檔頭
+static bool write_header(FILE* file)
+{
+    GameScoreHeader header;
+    memcpy(header.magic, GAME_SCORES_MAGIC, sizeof(header.magic));
+    header.version = GAME_SCORES_VERSION;
+    header.record_size = (uint16_t)sizeof(GameScoreRecord);
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+// 寫入一筆紀錄 (計算檢查碼)
+static bool write_record(FILE* file, const GameScoreRecord* record)
+{
+    GameScoreRecord r = *record;
+    r.check = record_check(&r);
+    return fwrite(&r, sizeof(r), 1, file) == 1;
+}
+
+// 把一筆成績附加到紀錄檔
+bool game_scores_append(const char* path, const GameScoreRecord* record, bool sync)
+{
+    FILE* file = game_fopen(path, "ab");
+    if (!file) return false;
+    bool ok = true;
+    fseek(file, 0, SEEK_END);
+    if (ftell(file) == 0) ok = write_header(file);
+    ok = ok && write_record(file, record);
+    ok = scores_flush(file, sync) && ok;
+    return fclose(file) == 0 && ok;
+}
+
+// 檢查紀錄檔是否值得壓縮
+bool game_scores_should_compact(const GameScores* scores)
+{
+    if (scores->torn > 0) return true;
+    long live = game_scores_live(scores);
+    long garbage = scores->records - live;
+    return garbage >= GAME_SCORES_COMPACT_MIN && garbage > live;
+}
+
+// 以暫存檔取代原檔
+static bool replace_file(const char* from, const char* to)
+{
+#ifdef _WIN32
+    // 路徑是 UTF-8，與 game_fopen 相同轉成寬字元
+    wchar_t wfrom[MAX_PATH];
+    wchar_t wto[MAX_PATH];
+    if (MultiByteToWideChar(CP_UTF8, 0, from, -1, wfrom, MAX_PATH) == 0) return false;
+    if (MultiByteToWideChar(CP_UTF8, 0, to, -1, wto, MAX_PATH) == 0) return false;
+    return MoveFileExW(wfrom, wto, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+// 以索引需要的紀錄重寫紀錄檔
+bool game_scores_compact(GameScores* scores, const char* path)
+{
+    size_t length = strlen(path);
+    char* tmp = (char*)malloc(length + 5);
+    if (!tmp) return false;
+    memcpy(tmp, path, length);
+    memcpy(tmp + length, ".tmp", 5);
+
+    FILE* file = game_fopen(tmp, "wb");
+    if (!file) {
+        free(tmp);
+        return false;
+    }
+    long written = 0;
+    bool ok = write_header(file);
+    for (size_t i = 0; ok && i < scores->best_capacity; i++) {
+        if (scores->best[i].width == 0) continue;
+        ok = write_record(file, &scores->best[i]);
+        written++;
+    }
+    for (int i = 0; ok && i < scores->top_count; i++) {
+        if (top_is_best(scores, &scores->top[i])) continue;
+        ok = write_record(file, &scores->top[i]);
+        written++;
+    }
+    ok = scores_flush(file, true) && ok;
+    ok = fclose(file) == 0 && ok;
+    ok = ok && replace_file(tmp, path);
+    if (!ok) remove(tmp);
+    else {
+        scores->records = written;
+        scores->torn = 0;
+    }
+    free(tmp);
+    return ok;
+}
@@ -0,0 +1,255 @@
+#include "game_sim.h"
+
+#include <stdlib.h>
+
+//==============================================================
+// [ 牆層 ]
+//==============================================================
+// 配置參考計數為1的空白牆層
+static GameSimWalls* walls_new(int width, int height)
+{
+    int words = (width * height + 63) / 64;
+    GameSimWalls* walls = (GameSimWalls*)calloc(1, sizeof(GameSimWalls) + (size_t)words * sizeof(uint64_t));
+    if (!walls) return NULL;
+    walls->refcount = 1;
+    walls->width = width;
+    walls->height = height;
+    walls->words = words;
+    return walls;
+}
+
+// 從遊戲狀態的障礙物建立牆層
+GameSimWalls* game_sim_walls_from_state(const GameState* game)
+{
+    GameSimWalls* walls = walls_new(game->width, game->height);
+    if (!walls) return NULL;
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* obs = &game->obstacles[i];
+        for (int y = obs->y; y < obs->y + obs->height; y++) {
+            for (int x = obs->x; x < obs->x + obs->width; x++) {
+                int c = y * game->width + x;
+                walls->bits[c >> 6] |= 1ull << (c & 63);
+            }
+        }
+    }
+    return walls;
+}
+
+// 放開牆層參考
+void game_sim_walls_release(GameSimWalls* walls)
+{
+    if (walls && --walls->refcount == 0) free(walls);
+}
+
+//==============================================================
+// [ 建立 / 複製 ]
+//==============================================================
+// 計算精簡狀態大小 (標頭 + 佔用位元圖 + 蛇身環狀緩衝區，補齊到 8 位元組)
+size_t game_sim_size(int width, int height)
+{
+    long cells = (long)width * height;
+    if (width <= 0 || height <= 0 || cells > GAME_SIM_MAX_CELLS) return 0;
+    size_t words = ((size_t)cells + 63) / 64;
+    size_t size = sizeof(GameSim) + words * sizeof(uint64_t) + MAX_PLAYERS * (size_t)cells * sizeof(uint16_t);
+    return (size + 7) & ~(size_t)7;
+}
+
+static inline uint16_t* sim_ring(GameSim* sim, int player)
+{
+    return (uint16_t*)(sim->occupied + sim->words) + (size_t)player * sim->cells;
+}
+
+static inline void occupy(GameSim* sim, int c)
+{
+    sim->occupied[c >> 6] |= 1ull << (c & 63);
+}
+
+static inline void vacate(GameSim* sim, int c)
+{
+    sim->occupied[c >> 6] &= ~(1ull << (c & 63));
+}
+
+// 從遊戲狀態建立精簡狀態
+void game_sim_from_state(GameSim* sim, const GameState* game, GameSimWalls* walls)
+{
+    size_t size = game_sim_size(game->width, game->height);
+    memset(sim, 0, size);
+    sim->size = (uint32_t)size;
+    sim->width = (uint16_t)game->width;
+    sim->height = (uint16_t)game->height;
+    sim->cells = (uint32_t)(game->width * game->height);
+    sim->words = (uint16_t)((sim->cells + 63) / 64);
+    sim->player_count = (uint8_t)game->player_count;
+    sim->slow_on_eat = game->slow_on_eat;
+    sim->food = (uint32_t)(game->food.y * game->width + game->food.x);
+    sim->rng_state = game->rng_state;
+    sim->body_hash = game->body_hash;
+    sim->walls = walls;
+    sim->owns_walls = 1;
+    walls->refcount++;
+
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        GameSimPlayer* sp = &sim->players[p];
+        sp->head = 0;
+        sp->length = (uint16_t)pl->body.length;
+        sp->direction = (uint8_t)pl->direction;
+        sp->next_direction = (uint8_t)pl->next_direction;
+        sp->alive = pl->alive;
+        sp->score = pl->score;
+        sp->interval = pl->interval;
+        sp->elapsed_ms = (int32_t)pl->elapsed_ms;
+        sp->survival_ms = (int32_t)pl->survival_ms;
+
+        uint16_t* ring = sim_ring(sim, p);
+        for (int i = 0; i < pl->body.length; i++) {
+            Point s = snake_body_at(&pl->body, i);
+            ring[i] = (uint16_t)(s.y * game->width + s.x);
+            if (pl->alive) occupy(sim, ring[i]);
+        }
+    }
+}
+
+// 放開牆層參考
+void game_sim_release(GameSim* sim)
+{
+    if (sim->owns_walls) game_sim_walls_release(sim->walls);
+    sim->owns_walls = 0;
+    sim->walls = NULL;
+}
+
+// 修改一個牆格 (寫入時複製)
+bool game_sim_set_wall(GameSim* sim, int x, int y, bool wall)
+{
+    if (!sim->owns_walls || sim->walls->refcount > 1) {
+        GameSimWalls* copy = walls_new(sim->width, sim->height);
+        if (!copy) return false;
+        memcpy(copy->bits, sim->walls->bits, (size_t)copy->words * sizeof(uint64_t));
+        if (sim->owns_walls) game_sim_walls_release(sim->walls);
+        sim->walls = copy;
+        sim->owns_walls = 1;
+    }
+    int c = y * sim->width + x;
+    if (wall) sim->walls->bits[c >> 6] |= 1ull << (c & 63);
+    else sim->walls->bits[c >> 6] &= ~(1ull << (c & 63));
+    return true;
+}
+
+//==============================================================
+// [ 規則 ]
+//==============================================================
+// 與各方向相反的方向
+static const uint8_t sim_opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+
+// 改變玩家下一步的方向，不允許直接反向
+void game_sim_turn(GameSim* sim, int player, Direction dir)
+{
+    GameSimPlayer* sp = &sim->players[player];
+    if ((uint8_t)dir != sim_opposite[sp->next_direction]) sp->next_direction = (uint8_t)dir;
+}
+
+// 蛇頭往指定方向前進一格後的格子 (含邊界循環)
+int game_sim_next_cell(const GameSim* sim, int player, Direction dir)
+{
+    int c = game_sim_body_at(sim, player, 0);
+    int w = sim->width, h = sim->height;
+    int x = c % w, y = c / w;
+    switch (dir) {
+    case DIR_UP:    y = (y == 0) ? h - 1 : y - 1; break;
+    case DIR_DOWN:  y = (y == h - 1) ? 0 : y + 1; break;
+    case DIR_LEFT:  x = (x == 0) ? w - 1 : x - 1; break;
+    case DIR_RIGHT: x = (x == w - 1) ? 0 : x + 1; break;
+    }
+    return y * w + x;
+}
+
+// 生成食物，避開存活的蛇與牆 (亂數的取用順序與 game_generate_food 相同)
+static void sim_generate_food(GameSim* sim)
+{
+    for (;;) {
+        int x = game_rng_next(&sim->rng_state, sim->width);
+        int y = game_rng_next(&sim->rng_state, sim->height);
+        int c = y * sim->width + x;
+        if (!game_sim_blocked(sim, c)) {
+            sim->food = (uint32_t)c;
+            return;
+        }
+    }
+}
+
+// 讓指定玩家的蛇移動一步
+GameEvent game_sim_step(GameSim* sim, int player)
+{
+    GameSimPlayer* sp = &sim->players[player];
+    if (!sp->alive || sp->length == 0) return GAME_EVENT_NONE;
+
+    sp->elapsed_ms += sp->interval;
+    sp->direction = sp->next_direction;
+    int nh = game_sim_next_cell(sim, player, (Direction)sp->direction);
+
+    // 存活的蛇不會重疊，佔用位元圖即可判斷自撞 (含蛇尾)、撞牆與撞到另一條蛇
+    uint16_t* ring = sim_ring(sim, player);
+    if (game_sim_blocked(sim, nh)) {
+        sp->alive = 0;
+        sp->survival_ms = sp->elapsed_ms;
+        // 死亡的蛇不再阻擋任何玩家
+        for (int i = 0; i < sp->length; i++) vacate(sim, game_sim_body_at(sim, player, i));
+        return GAME_EVENT_DIED;
+    }
+
+    // 添加新的蛇頭
+    sp->head = (uint16_t)(sp->head == 0 ? sim->cells - 1 : sp->head - 1u);
+    ring[sp->head] = (uint16_t)nh;
+    sp->length++;
+    occupy(sim, nh);
+    sim->body_hash ^= game_hash_key(GAME_HASH_BODY, player, (uint64_t)nh);
+
+    if ((uint32_t)nh == sim->food) {
+        sp->score++;
+        if (sim->slow_on_eat && sp->interval < MAX_INTERVAL) sp->interval += 5;
+        sim_generate_food(sim);
+        return GAME_EVENT_ATE;
+    }
+
+    // 移除蛇尾
+    sp->length--;
+    int tail = game_sim_body_at(sim, player, sp->length);
+    vacate(sim, tail);
+    sim->body_hash ^= game_hash_key(GAME_HASH_BODY, player, (uint64_t)tail);
+    return GAME_EVENT_NONE;
+}
+
+// 精簡狀態的雜湊 (項目與 game_hash 相同)
+uint64_t game_sim_hash(const GameSim* sim)
+{
+    uint64_t h = sim->body_hash;
+    h ^= game_hash_key(GAME_HASH_GAME, 0, (uint64_t)sim->width | (uint64_t)sim->height << 24
+        | (uint64_t)sim->player_count << 48 | (uint64_t)sim->slow_on_eat << 56);
+    for (int i = 0; i < sim->player_count; i++) {
+        const GameSimPlayer* sp = &sim->players[i];
+        if (sp->length > 0) h ^= game_hash_key(GAME_HASH_HEAD, i, (uint64_t)game_sim_body_at(sim, i, 0));
+        h ^= game_hash_key(GAME_HASH_PLAYER, i,
+            game_hash_pack_player(sp->direction, sp->next_direction, sp->alive, sp->interval, sp->score));
+        h ^= game_hash_key(GAME_HASH_ELAPSED, i, (uint64_t)sp->elapsed_ms);
+    }
+    h ^= game_hash_key(GAME_HASH_FOOD, 0, sim->food);
+    h ^= game_hash_key(GAME_HASH_RNG, 0, sim->rng_state);
+    return h;
+}
+
+// 取得下一個移動的玩家
+int game_sim_next_mover(const GameSim* sim)
+{
+    int next = -1;
+    int32_t best = 0;
+    for (int i = 0; i < sim->player_count; i++) {
+        const GameSimPlayer* sp = &sim->players[i];
+        if (!sp->alive) continue;
+        int32_t due = sp->elapsed_ms + sp->interval;
+        if (next < 0 || due < best) {
+            next = i;
+            best = due;
+        }
+    }
+    return next;
+}
@@ -0,0 +1,225 @@
+#include "game_snapshot.h"
+
+#include <string.h>
+
+// 快照的記憶體配置必須與結構完全相同，才能直接映射後以 memcpy 載入
+typedef char snapshot_check_int[(sizeof(int) == 4) ? 1 : -1];
+typedef char snapshot_check_point[(sizeof(Point) == 8) ? 1 : -1];
+typedef char snapshot_check_obstacle[(sizeof(Obstacle) == 16) ? 1 : -1];
+typedef char snapshot_check_header[(sizeof(GameSnapshotHeader) % 8 == 0) ? 1 : -1];
+
+// 快照允許的最大格子數 (避免損壞的檔頭要求過大的記憶體)
+#define SNAPSHOT_MAX_CELLS (1 << 26)
+
+//==============================================================
+// [ 大小計算 ]
+//==============================================================
+// 依檔頭內容計算快照大小
+static size_t snapshot_size_for(int obstacle_count, const int* lengths, int player_count)
+{
+    size_t size = sizeof(GameSnapshotHeader) + (size_t)obstacle_count * sizeof(Obstacle);
+    for (int i = 0; i < player_count; i++) {
+        size += (size_t)lengths[i] * sizeof(Point);
+    }
+    return size;
+}
+
+// 計算快照大小
+size_t game_snapshot_size(const GameState* game)
+{
+    int lengths[MAX_PLAYERS] = { 0 };
+    for (int i = 0; i < game->player_count; i++) {
+        lengths[i] = game->players[i].body.length;
+    }
+    return snapshot_size_for(game->obstacle_count, lengths, game->player_count);
+}
+
+// 計算指定網格尺寸的快照最多需要的大小
+size_t game_snapshot_capacity(int width, int height)
+{
+    return sizeof(GameSnapshotHeader) + (size_t)MAX_OBSTACLES * sizeof(Obstacle)
+        + (size_t)MAX_PLAYERS * (size_t)width * (size_t)height * sizeof(Point);
+}
+
+//==============================================================
+// [ 存檔 ]
+//==============================================================
+// 將遊戲狀態寫入記憶體中的快照
+size_t game_snapshot_write(const GameState* game, const GameSession* session,
+    void* buffer, size_t capacity)
+{
+    size_t size = game_snapshot_size(game);
+    if (capacity < size) return 0;
+
+    unsigned char* out = (unsigned char*)buffer;
+    GameSnapshotHeader* h = (GameSnapshotHeader*)out;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, GAME_SNAPSHOT_MAGIC, sizeof(h->magic));
+    h->version = GAME_SNAPSHOT_VERSION;
+    h->header_size = (uint32_t)sizeof(GameSnapshotHeader);
+    h->endian = GAME_SNAPSHOT_ENDIAN;
+    h->total_size = (uint64_t)size;
+    h->rng_state = game->rng_state;
+    h->width = game->width;
+    h->height = game->height;
+    h->player_count = game->player_count;
+    h->slow_on_eat = game->slow_on_eat;
+    h->food_x = game->food.x;
+    h->food_y = game->food.y;
+    h->obstacle_count = game->obstacle_count;
+    h->winner = game->winner;
+    if (session) {
+        h->session = *session;
+    }
+    else {
+        h->session.countdown_remaining_us = -1;
+        for (int i = 0; i < MAX_PLAYERS; i++) h->session.step_remaining_us[i] = -1;
+    }
+
+    out += sizeof(GameSnapshotHeader);
+    if (game->obstacle_count > 0) {
+        memcpy(out, game->obstacles, (size_t)game->obstacle_count * sizeof(Obstacle));
+        out += (size_t)game->obstacle_count * sizeof(Obstacle);
+    }
+
+    for (int i = 0; i < game->player_count; i++) {
+        const Player* pl = &game->players[i];
+        GameSnapshotPlayer* sp = &h->players[i];
+        sp->direction = pl->direction;
+        sp->next_direction = pl->next_direction;
+        sp->score = pl->score;
+        sp->interval = pl->interval;
+        sp->alive = pl->alive;
+        sp->length = pl->body.length;
+        sp->death_cause = pl->death_cause;
+        sp->elapsed_ms = pl->elapsed_ms;
+        sp->survival_ms = pl->survival_ms;
+
+        // 環狀緩衝區最多分成兩段，依蛇頭到蛇尾的順序寫出
+        const SnakeBody* body = &pl->body;
+        int first = body->capacity - body->head;
+        if (first > body->length) first = body->length;
+        memcpy(out, body->cells + body->head, (size_t)first * sizeof(Point));
+        out += (size_t)first * sizeof(Point);
+        if (body->length > first) {
+            memcpy(out, body->cells, (size_t)(body->length - first) * sizeof(Point));
+            out += (size_t)(body->length - first) * sizeof(Point);
+        }
+    }
+    return size;
+}
+
+//==============================================================
+// [ 讀檔 ]
+//==============================================================
+// 檢查快照的檔頭與各區段大小
+const GameSnapshotHeader* game_snapshot_validate(const void* data, size_t size)
+{
+    if (!data || size < sizeof(GameSnapshotHeader)) return NULL;
+    if (((uintptr_t)data & 7) != 0) return NULL; // 映射的檔案與 malloc 的緩衝區都滿足對齊
+
+    const GameSnapshotHeader* h = (const GameSnapshotHeader*)data;
+    if (memcmp(h->magic, GAME_SNAPSHOT_MAGIC, sizeof(h->magic)) != 0) return NULL;
+    if (h->version != GAME_SNAPSHOT_VERSION) return NULL;
+    if (h->header_size != sizeof(GameSnapshotHeader)) return NULL;
+    if (h->endian != GAME_SNAPSHOT_ENDIAN) return NULL;
+    if (h->total_size != (uint64_t)size) return NULL;
+
+    if (h->width <= 0 || h->height <= 0) return NULL;
+    if ((int64_t)h->width * h->height > SNAPSHOT_MAX_CELLS) return NULL;
+    if (h->player_count < 1 || h->player_count > MAX_PLAYERS) return NULL;
+    if (h->obstacle_count < 0 || h->obstacle_count > MAX_OBSTACLES) return NULL;
+    if (h->food_x < 0 || h->food_x >= h->width || h->food_y < 0 || h->food_y >= h->height) return NULL;
+
+    int cells = h->width * h->height;
+    int lengths[MAX_PLAYERS] = { 0 };
+    for (int i = 0; i < h->player_count; i++) {
+        const GameSnapshotPlayer* sp = &h->players[i];
+        if (sp->length < 0 || sp->length > cells) return NULL;
+        if (sp->direction < DIR_UP || sp->direction > DIR_RIGHT) return NULL;
+        if (sp->next_direction < DIR_UP || sp->next_direction > DIR_RIGHT) return NULL;
+        if (sp->interval <= 0) return NULL;
+        if (sp->alive && sp->length < 1) return NULL; // 存活的蛇至少有蛇頭
+        lengths[i] = sp->length;
+    }
+    if (snapshot_size_for(h->obstacle_count, lengths, h->player_count) != size) return NULL;
+
+    // 障礙物與蛇身會直接交給碰撞檢查、電腦玩家的網格與繪製，必須都在網格之內
+    const Obstacle* obstacles = (const Obstacle*)((const unsigned char*)h + sizeof(GameSnapshotHeader));
+    for (int i = 0; i < h->obstacle_count; i++) {
+        const Obstacle* obs = &obstacles[i];
+        if (obs->width <= 0 || obs->height <= 0) return NULL;
+        if (obs->x < 0 || obs->y < 0 || obs->width > h->width - obs->x || obs->height > h->height - obs->y) return NULL;
+    }
+    const Point* cell = (const Point*)(obstacles + h->obstacle_count);
+    for (int i = 0; i < h->player_count; i++) {
+        for (int j = 0; j < lengths[i]; j++, cell++) {
+            if (cell->x < 0 || cell->x >= h->width || cell->y < 0 || cell->y >= h->height) return NULL;
+        }
+    }
+    return h;
+}
+
+// 把已檢查的快照複製到已配置好蛇身與障礙物空間的遊戲狀態
+static void snapshot_load(GameState* game, const GameSnapshotHeader* h)
+{
+    game->rng_state = h->rng_state;
+    game->slow_on_eat = h->slow_on_eat != 0;
+    game->food.x = h->food_x;
+    game->food.y = h->food_y;
+    game->winner = h->winner;
+
+    const unsigned char* in = (const unsigned char*)h + sizeof(GameSnapshotHeader);
+    memcpy(game->obstacles, in, (size_t)h->obstacle_count * sizeof(Obstacle));
+    game->obstacle_count = h->obstacle_count;
+    in += (size_t)h->obstacle_count * sizeof(Obstacle);
+
+    for (int i = 0; i < h->player_count; i++) {
+        const GameSnapshotPlayer* sp = &h->players[i];
+        Player* pl = &game->players[i];
+        pl->direction = (Direction)sp->direction;
+        pl->next_direction = (Direction)sp->next_direction;
+        pl->score = sp->score;
+        pl->interval = sp->interval;
+        pl->alive = sp->alive != 0;
+        pl->death_cause = sp->death_cause >= GAME_COLLISION_SELF && sp->death_cause <= GAME_COLLISION_OTHER
+            ? (GameCollision)sp->death_cause : GAME_COLLISION_NONE;
+        pl->elapsed_ms = (long)sp->elapsed_ms;
+        pl->survival_ms = (long)sp->survival_ms;
+
+        // 蛇身已依蛇頭到蛇尾的順序存放，整塊複製到環狀緩衝區的開頭
+        memcpy(pl->body.cells, in, (size_t)sp->length * sizeof(Point));
+        pl->body.head = 0;
+        pl->body.length = sp->length;
+        in += (size_t)sp->length * sizeof(Point);
+    }
+    game_rehash(game);
+}
+
+// 從快照載入遊戲狀態
+bool game_snapshot_read(GameState* game, GameSession* session,
+    const void* data, size_t size)
+{
+    const GameSnapshotHeader* h = game_snapshot_validate(data, size);
+    if (!h) return false;
+
+    if (!game_state_resize(game, h->width, h->height)) return false;
+    game_begin(game, h->player_count);
+    if (!game->obstacles) return false;
+
+    snapshot_load(game, h);
+    if (session) {
+        *session = h->session;
+    }
+    return true;
+}
+
+// 在原地載入快照 (不重置記憶體區塊)
+bool game_snapshot_restore(GameState* game, const void* data, size_t size)
+{
+    const GameSnapshotHeader* h = game_snapshot_validate(data, size);
+    if (!h || !game->obstacles) return false;
+    if (h->width != game->width || h->height != game->height || h->player_count != game->player_count) return false;
+    snapshot_load(game, h);
+    return true;
+}
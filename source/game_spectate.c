@@ -0,0 +1,515 @@
+#include "game_spectate.h"
+
+#include <string.h>
+
+// DELTA 的旗標
+#define DELTA_PLAYER0 0x01   // 玩家1有變化 (玩家2為 0x02)
+#define DELTA_FOOD    0x04   // 食物移動
+// DELTA 中每位玩家的旗標
+#define PLAYER_HEADS  0x01   // 加入了蛇頭
+#define PLAYER_TAILS  0x02   // 移除了蛇尾
+#define PLAYER_SCORE  0x04   // 分數改變
+#define PLAYER_DIED   0x08   // 死亡
+
+//==============================================================
+// [ 位元組讀寫 ]
+//==============================================================
+// 輸出位置 (超出容量時 ok 為false)
+typedef struct {
+    uint8_t* p;
+    uint8_t* end;
+    bool ok;
+} Writer;
+
+// 輸入位置 (資料不足時 ok 為false)
+typedef struct {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok;
+} Reader;
+
+static void put_u8(Writer* w, uint32_t v)
+{
+    if (w->p >= w->end) {
+        w->ok = false;
+        return;
+    }
+    *w->p++ = (uint8_t)v;
+}
+
+static void put_u16(Writer* w, uint32_t v)
+{
+    put_u8(w, v & 0xFF);
+    put_u8(w, (v >> 8) & 0xFF);
+}
+
+static void put_u32(Writer* w, uint32_t v)
+{
+    put_u16(w, v & 0xFFFF);
+    put_u16(w, v >> 16);
+}
+
+static void put_varint(Writer* w, uint32_t v)
+{
+    while (v >= 0x80) {
+        put_u8(w, (v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    put_u8(w, v);
+}
+
+static uint32_t get_u8(Reader* r)
+{
+    if (r->p >= r->end) {
+        r->ok = false;
+        return 0;
+    }
+    return *r->p++;
+}
+
+static uint32_t get_u16(Reader* r)
+{
+    uint32_t lo = get_u8(r);
+    return lo | (get_u8(r) << 8);
+}
+
+static uint32_t get_u32(Reader* r)
+{
+    uint32_t lo = get_u16(r);
+    return lo | (get_u16(r) << 16);
+}
+
+static uint32_t get_varint(Reader* r)
+{
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint32_t b = get_u8(r);
+        v |= (b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    r->ok = false;
+    return 0;
+}
+
+static uint32_t zigzag(int v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int unzigzag(uint32_t v)
+{
+    return (int)(v >> 1) ^ -(int)(v & 1);
+}
+
+// 每個位元組放4個2位元的方向
+typedef struct {
+    uint8_t bits;
+    int count;
+} DirPacker;
+
+static void pack_dir(Writer* w, DirPacker* pk, int dir)
+{
+    pk->bits |= (uint8_t)(dir << (pk->count * 2));
+    if (++pk->count == 4) {
+        put_u8(w, pk->bits);
+        pk->bits = 0;
+        pk->count = 0;
+    }
+}
+
+static void pack_flush(Writer* w, DirPacker* pk)
+{
+    if (pk->count > 0) put_u8(w, pk->bits);
+    pk->bits = 0;
+    pk->count = 0;
+}
+
+static int unpack_dir(Reader* r, DirPacker* pk)
+{
+    if (pk->count == 0) {
+        pk->bits = (uint8_t)get_u8(r);
+        pk->count = 4;
+    }
+    int dir = pk->bits & 3;
+    pk->bits >>= 2;
+    pk->count--;
+    return dir;
+}
+
+//==============================================================
+// [ 格子與方向 ]
+//==============================================================
+// 相鄰格子之間的方向 (含邊界循環)；不相鄰時返回-1
+static int step_dir(Point a, Point b, int width, int height)
+{
+    if (a.y == b.y) {
+        if ((a.x + 1) % width == b.x) return DIR_RIGHT;
+        if ((b.x + 1) % width == a.x) return DIR_LEFT;
+    }
+    if (a.x == b.x) {
+        if ((a.y + 1) % height == b.y) return DIR_DOWN;
+        if ((b.y + 1) % height == a.y) return DIR_UP;
+    }
+    return -1;
+}
+
+// 往指定方向走一格 (含邊界循環)
+static Point step_cell(Point p, int dir, int width, int height)
+{
+    switch (dir) {
+    case DIR_UP:    p.y = (p.y + height - 1) % height; break;
+    case DIR_DOWN:  p.y = (p.y + 1) % height;          break;
+    case DIR_LEFT:  p.x = (p.x + width - 1) % width;   break;
+    default:        p.x = (p.x + 1) % width;           break;
+    }
+    return p;
+}
+
+static void put_cell(Writer* w, Point p, int width)
+{
+    put_u16(w, (uint32_t)(p.y * width + p.x));
+}
+
+static bool get_cell(Reader* r, const GameState* game, Point* p)
+{
+    uint32_t v = get_u16(r);
+    if (v >= (uint32_t)(game->width * game->height)) return false;
+    p->x = (int)(v % (uint32_t)game->width);
+    p->y = (int)(v / (uint32_t)game->width);
+    return true;
+}
+
+//==============================================================
+// [ 編碼 ]
+//==============================================================
+// 關鍵影格的最大位元組數
+size_t game_spectate_keyframe_capacity(int width, int height)
+{
+    // 所有蛇身的格子合計不超過格子總數，每格2位元，每位玩家最多多用一個位元組
+    return 14 + 4 * MAX_OBSTACLES + 2 + MAX_PLAYERS * 8 + (size_t)width * (size_t)height / 4 + 1;
+}
+
+// 重置編碼端
+void game_spectate_encoder_reset(GameSpectateEncoder* enc)
+{
+    memset(enc, 0, sizeof(*enc));
+}
+
+// 是否該送出定期的關鍵影格
+bool game_spectate_keyframe_due(const GameSpectateEncoder* enc, uint32_t frame)
+{
+    return !enc->primed || frame - enc->keyframe_at >= GAME_SPECTATE_KEYFRAME_INTERVAL;
+}
+
+// 記住目前的局面
+static void encoder_remember(GameSpectateEncoder* enc, const GameState* game)
+{
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        enc->head[p] = pl->body.head;
+        enc->length[p] = pl->body.length;
+        enc->head_cell[p] = pl->body.length > 0 ? snake_body_at(&pl->body, 0) : (Point){ 0, 0 };
+        enc->score[p] = pl->score;
+        enc->alive[p] = pl->alive;
+    }
+    enc->food = game->food;
+}
+
+// 編碼關鍵影格
+int game_spectate_encode_keyframe(GameSpectateEncoder* enc, const GameState* game,
+    uint32_t room, uint32_t frame, uint8_t* out, size_t capacity)
+{
+    Writer w = { out, out + capacity, true };
+    put_u8(&w, SPECTATE_KEYFRAME);
+    put_u32(&w, room);
+    put_u32(&w, frame);
+    put_u8(&w, (uint32_t)game->width);
+    put_u8(&w, (uint32_t)game->height);
+    put_u8(&w, (uint32_t)game->player_count);
+    put_u8(&w, (uint32_t)game->obstacle_count);
+    put_u8(&w, (uint32_t)game->winner);
+    for (int i = 0; i < game->obstacle_count; i++) {
+        const Obstacle* o = &game->obstacles[i];
+        put_u8(&w, (uint32_t)o->x);
+        put_u8(&w, (uint32_t)o->y);
+        put_u8(&w, (uint32_t)o->width);
+        put_u8(&w, (uint32_t)o->height);
+    }
+    put_cell(&w, game->food, game->width);
+
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        const SnakeBody* body = &pl->body;
+        put_u8(&w, (uint32_t)pl->alive | (uint32_t)pl->direction << 1);
+        put_u16(&w, (uint16_t)pl->score);
+        put_u16(&w, (uint32_t)body->length);
+        if (body->length == 0) continue;
+        // 蛇頭的格子，之後是每一節往蛇尾的方向
+        Point prev = snake_body_at(body, 0);
+        put_cell(&w, prev, game->width);
+        DirPacker pk = { 0, 0 };
+        for (int i = 1; i < body->length; i++) {
+            Point cell = snake_body_at(body, i);
+            int dir = step_dir(prev, cell, game->width, game->height);
+            if (dir < 0) return -1; // 蛇身不連續 (不會發生在規則產生的局面)
+            pack_dir(&w, &pk, dir);
+            prev = cell;
+        }
+        pack_flush(&w, &pk);
+    }
+    if (!w.ok) return -1;
+
+    encoder_remember(enc, game);
+    enc->primed = true;
+    enc->keyframe_at = frame;
+    return (int)(w.p - out);
+}
+
+// 編碼自上一個封包以來的變化
+int game_spectate_encode_delta(GameSpectateEncoder* enc, const GameState* game,
+    uint32_t room, uint32_t frame, uint8_t* out, size_t capacity)
+{
+    if (!enc->primed) return -1;
+    Writer w = { out, out + capacity, true };
+    put_u8(&w, SPECTATE_DELTA);
+    put_u32(&w, room);
+    put_u32(&w, frame);
+    uint8_t* flags_at = w.p;
+    put_u8(&w, 0);
+    uint8_t flags = 0;
+    if (game->food.x != enc->food.x || game->food.y != enc->food.y) {
+        flags |= DELTA_FOOD;
+        put_cell(&w, game->food, game->width);
+    }
+
+    for (int p = 0; p < game->player_count; p++) {
+        const Player* pl = &game->players[p];
+        const SnakeBody* body = &pl->body;
+        // 蛇頭索引每加入一節往前一格，長度差扣掉加入的節數就是移除的蛇尾數
+        int pushes = (enc->head[p] - body->head + body->capacity) % body->capacity;
+        int removed = pushes - (body->length - enc->length[p]);
+        if (removed < 0 || removed > enc->length[p] + pushes || pushes >= body->capacity) return -1;
+        int score_delta = pl->score - enc->score[p];
+        bool died = enc->alive[p] && !pl->alive;
+        if (pl->alive && !enc->alive[p]) return -1; // 復活只能以關鍵影格表示
+
+        uint8_t pflags = (uint8_t)((pushes > 0 ? PLAYER_HEADS : 0) | (removed > 0 ? PLAYER_TAILS : 0)
+            | (score_delta != 0 ? PLAYER_SCORE : 0) | (died ? PLAYER_DIED : 0));
+        if (!pflags) continue;
+        flags |= (uint8_t)(DELTA_PLAYER0 << p);
+        put_u8(&w, pflags);
+        if (pushes > 0) {
+            // 從舊的蛇頭依序走到新的蛇頭
+            put_varint(&w, (uint32_t)pushes);
+            DirPacker pk = { 0, 0 };
+            Point prev = enc->head_cell[p];
+            for (int i = pushes - 1; i >= 0; i--) {
+                Point cell = snake_body_at(body, i);
+                int dir = step_dir(prev, cell, game->width, game->height);
+                if (dir < 0) return -1;
+                pack_dir(&w, &pk, dir);
+                prev = cell;
+            }
+            pack_flush(&w, &pk);
+        }
+        if (removed > 0) put_varint(&w, (uint32_t)removed);
+        if (score_delta != 0) put_varint(&w, zigzag(score_delta));
+    }
+    if (!w.ok) return -1;
+
+    *flags_at = flags;
+    encoder_remember(enc, game);
+    return (int)(w.p - out);
+}
+
+// 編碼對局結束
+int game_spectate_encode_over(uint32_t room, uint32_t frame, int winner, uint8_t* out)
+{
+    Writer w = { out, out + GAME_SPECTATE_OVER_BYTES, true };
+    put_u8(&w, SPECTATE_OVER);
+    put_u32(&w, room);
+    put_u32(&w, frame);
+    put_u8(&w, (uint32_t)winner);
+    return GAME_SPECTATE_OVER_BYTES;
+}
+
+// 編碼觀看要求
+int game_spectate_encode_watch(uint32_t room, uint8_t flags, uint8_t* out)
+{
+    Writer w = { out, out + GAME_SPECTATE_WATCH_BYTES, true };
+    put_u8(&w, SPECTATE_WATCH);
+    put_u8(&w, GAME_SPECTATE_VERSION);
+    put_u32(&w, room);
+    put_u8(&w, flags);
+    return GAME_SPECTATE_WATCH_BYTES;
+}
+
+// 解碼觀看要求
+bool game_spectate_decode_watch(const uint8_t* data, size_t length, uint32_t* room, uint8_t* flags)
+{
+    if (length != GAME_SPECTATE_WATCH_BYTES || data[0] != SPECTATE_WATCH || data[1] != GAME_SPECTATE_VERSION) {
+        return false;
+    }
+    Reader r = { data + 2, data + length, true };
+    *room = get_u32(&r);
+    *flags = (uint8_t)get_u8(&r);
+    return r.ok;
+}
+
+//==============================================================
+// [ 解碼 ]
+//==============================================================
+// 在蛇頭前加入一節
+static void view_push_head(SnakeBody* body, Point p)
+{
+    body->head = (body->head == 0) ? body->capacity - 1 : body->head - 1;
+    body->cells[body->head] = p;
+    body->length++;
+}
+
+// 套用關鍵影格
+static GameSpectateResult apply_keyframe(GameSpectateView* view, Reader* r, uint32_t room, uint32_t frame)
+{
+    int width = (int)get_u8(r), height = (int)get_u8(r);
+    int player_count = (int)get_u8(r), obstacle_count = (int)get_u8(r), winner = (int)get_u8(r);
+    if (!r->ok || width < 2 || height < 2 || player_count < 1 || player_count > MAX_PLAYERS
+        || obstacle_count > MAX_OBSTACLES || winner > 2) return SPECTATE_INVALID;
+
+    // 記憶體區塊只在網格尺寸改變時重新配置，之後每個關鍵影格只重置
+    GameState* game = &view->game;
+    view->synced = false;
+    if (!game_state_resize(game, width, height)) return SPECTATE_INVALID;
+    game_begin(game, player_count);
+    if (!game->obstacles) return SPECTATE_INVALID;
+    game->winner = winner;
+    for (int i = 0; i < obstacle_count; i++) {
+        Obstacle* o = &game->obstacles[i];
+        o->x = (int)get_u8(r);
+        o->y = (int)get_u8(r);
+        o->width = (int)get_u8(r);
+        o->height = (int)get_u8(r);
+    }
+    game->obstacle_count = obstacle_count;
+    if (!get_cell(r, game, &game->food)) return SPECTATE_INVALID;
+
+    for (int p = 0; p < player_count; p++) {
+        Player* pl = &game->players[p];
+        uint32_t state = get_u8(r);
+        pl->alive = (state & 1) != 0;
+        pl->direction = pl->next_direction = (Direction)((state >> 1) & 3);
+        pl->score = (int16_t)get_u16(r);
+        int length = (int)get_u16(r);
+        SnakeBody* body = &pl->body;
+        body->head = 0;
+        body->length = 0;
+        if (length > body->capacity) return SPECTATE_INVALID;
+        if (length == 0) continue;
+        // 由蛇頭往蛇尾依序放入環狀緩衝區的開頭
+        Point cell;
+        if (!get_cell(r, game, &cell)) return SPECTATE_INVALID;
+        body->cells[0] = cell;
+        DirPacker pk = { 0, 0 };
+        for (int i = 1; i < length; i++) {
+            cell = step_cell(cell, unpack_dir(r, &pk), width, height);
+            body->cells[i] = cell;
+        }
+        body->length = length;
+    }
+    if (!r->ok) return SPECTATE_INVALID;
+
+    view->room = room;
+    view->frame = frame;
+    view->synced = true;
+    view->over = false;
+    view->keyframes++;
+    return SPECTATE_APPLIED;
+}
+
+// 套用增量
+static GameSpectateResult apply_delta(GameSpectateView* view, Reader* r)
+{
+    GameState* game = &view->game;
+    uint32_t flags = get_u8(r);
+    if (flags & DELTA_FOOD) {
+        if (!get_cell(r, game, &game->food)) return SPECTATE_INVALID;
+    }
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        if (!(flags & (DELTA_PLAYER0 << p))) continue;
+        if (p >= game->player_count) return SPECTATE_INVALID;
+        Player* pl = &game->players[p];
+        SnakeBody* body = &pl->body;
+        uint32_t pflags = get_u8(r);
+        if (pflags & PLAYER_HEADS) {
+            uint32_t n = get_varint(r);
+            if (body->length == 0 || n > (uint32_t)(body->capacity - body->length)) return SPECTATE_INVALID;
+            DirPacker pk = { 0, 0 };
+            Point cell = snake_body_at(body, 0);
+            for (uint32_t i = 0; i < n && r->ok; i++) {
+                int dir = unpack_dir(r, &pk);
+                cell = step_cell(cell, dir, game->width, game->height);
+                view_push_head(body, cell);
+                pl->direction = pl->next_direction = (Direction)dir;
+            }
+        }
+        if (pflags & PLAYER_TAILS) {
+            uint32_t n = get_varint(r);
+            if (n > (uint32_t)body->length) return SPECTATE_INVALID;
+            body->length -= (int)n;
+        }
+        if (pflags & PLAYER_SCORE) pl->score += unzigzag(get_varint(r));
+        if (pflags & PLAYER_DIED) pl->alive = false;
+    }
+    return r->ok ? SPECTATE_APPLIED : SPECTATE_INVALID;
+}
+
+// 套用一個封包
+GameSpectateResult game_spectate_apply(GameSpectateView* view, const uint8_t* data, size_t length)
+{
+    Reader r = { data, data + length, true };
+    uint32_t type = get_u8(&r);
+    uint32_t room = get_u32(&r), frame = get_u32(&r);
+    if (!r.ok) return SPECTATE_INVALID;
+    view->packets++;
+    view->bytes += length;
+
+    GameSpectateResult result;
+    switch (type) {
+    case SPECTATE_KEYFRAME:
+        // 同一個房間中比目前舊的關鍵影格 (亂序) 忽略
+        if (view->synced && room == view->room && (int32_t)(frame - view->frame) <= 0) return SPECTATE_IGNORED;
+        result = apply_keyframe(view, &r, room, frame);
+        break;
+    case SPECTATE_DELTA:
+        if (!view->synced || room != view->room) return SPECTATE_IGNORED;
+        if ((int32_t)(frame - view->frame) <= 0) return SPECTATE_IGNORED;
+        if (frame != view->frame + 1) {
+            view->synced = false;
+            view->gaps++;
+            return SPECTATE_GAP;
+        }
+        result = apply_delta(view, &r);
+        if (result == SPECTATE_APPLIED) {
+            view->frame = frame;
+            view->deltas++;
+        }
+        break;
+    case SPECTATE_OVER:
+        if (room != view->room) return SPECTATE_IGNORED;
+        view->game.winner = (int)get_u8(&r);
+        view->over = true;
+        result = r.ok ? SPECTATE_APPLIED : SPECTATE_INVALID;
+        break;
+    default:
+        return SPECTATE_INVALID;
+    }
+    // 格式錯誤之後的增量無法信任，等待下一個關鍵影格
+    if (result == SPECTATE_INVALID) view->synced = false;
+    return result;
+}
+
+// 釋放觀眾端的局面
+void game_spectate_view_free(GameSpectateView* view)
+{
+    game_state_free(&view->game);
+    memset(view, 0, sizeof(*view));
+}
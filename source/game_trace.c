@@ -0,0 +1,263 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#endif
+#include "game_trace.h"
+#include "game_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#include <time.h>
+#define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+//========================[ 結構定義 ]========================
+// 一個執行緒的環形緩衝區：只有擁有的執行緒寫入，head 是累計寫入的事件數
+typedef struct TraceRing {
+    struct TraceRing* next;   // 所有緩衝區串成的鏈結串列 (只在前端插入)
+    const char* thread_name;  // 顯示名稱 (可為NULL)
+    int tid;                  // 追蹤檔中的執行緒編號
+    size_t mask;              // 容量 - 1 (容量為2的冪次)
+    volatile int64_t head;    // 已寫入的事件數 (以 release 寫入、acquire 讀取)
+    GameTraceEvent events[];
+} TraceRing;
+
+//========================[ 全域變數 ]========================
+volatile int game_trace_enabled = 0;
+
+static TraceRing* volatile trace_rings = NULL;   // 所有執行緒的緩衝區
+static volatile int32_t trace_next_tid = 0;      // 下一個執行緒編號
+static size_t trace_capacity = 0;                // 每個緩衝區的容量 (0 表示尚未開始過)
+static int64_t trace_origin = 0;                 // 追蹤開始時的時鐘值 (奈秒)
+static TRACE_THREAD_LOCAL TraceRing* trace_local = NULL; // 目前執行緒的緩衝區
+
+//==============================================================
+// [ 平台相關 ]
+//==============================================================
+#ifdef _WIN32
+static int64_t trace_clock_ns(void)
+{
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (int64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+}
+
+static int64_t trace_load_acquire(volatile int64_t* p)
+{
+    return InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+}
+
+static void trace_store_release(volatile int64_t* p, int64_t value)
+{
+    InterlockedExchange64((volatile LONG64*)p, value);
+}
+
+static void trace_fence(void)
+{
+    MemoryBarrier();
+}
+
+static int32_t trace_increment(volatile int32_t* p)
+{
+    return InterlockedIncrement((volatile LONG*)p);
+}
+
+static bool trace_push_ring(TraceRing* ring)
+{
+    TraceRing* first = trace_rings;
+    ring->next = first;
+    return InterlockedCompareExchangePointer((PVOID volatile*)&trace_rings, ring, first) == first;
+}
+#else
+static int64_t trace_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int64_t trace_load_acquire(volatile int64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void trace_store_release(volatile int64_t* p, int64_t value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+static void trace_fence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static int32_t trace_increment(volatile int32_t* p)
+{
+    return __atomic_add_fetch(p, 1, __ATOMIC_RELAXED);
+}
+
+static bool trace_push_ring(TraceRing* ring)
+{
+    TraceRing* first = __atomic_load_n(&trace_rings, __ATOMIC_ACQUIRE);
+    ring->next = first;
+    return __atomic_compare_exchange_n(&trace_rings, &first, ring, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+#endif
+
+//==============================================================
+// [ 記錄 ]
+//==============================================================
+// 開始記錄
+void game_trace_start(size_t events_per_thread)
+{
+    if (trace_capacity == 0) {
+        size_t wanted = events_per_thread ? events_per_thread : GAME_TRACE_DEFAULT_EVENTS;
+        size_t capacity = 1;
+        while (capacity < wanted) capacity *= 2;
+        trace_capacity = capacity;
+        trace_origin = trace_clock_ns();
+    }
+    game_trace_enabled = 1;
+}
+
+// 停止記錄
+void game_trace_stop(void)
+{
+    game_trace_enabled = 0;
+}
+
+// 從追蹤開始經過的奈秒數
+int64_t game_trace_now(void)
+{
+    int64_t t = trace_clock_ns() - trace_origin;
+    return t > 0 ? t : 1;
+}
+
+// 取得目前執行緒的緩衝區，第一次使用時配置並以無鎖的方式加入串列
+static TraceRing* trace_ring(void)
+{
+    if (trace_local) return trace_local;
+    if (trace_capacity == 0) return NULL;
+
+    TraceRing* ring = (TraceRing*)malloc(sizeof(TraceRing) + trace_capacity * sizeof(GameTraceEvent));
+    if (!ring) return NULL;
+    ring->thread_name = NULL;
+    ring->tid = trace_increment(&trace_next_tid);
+    ring->mask = trace_capacity - 1;
+    ring->head = 0;
+    while (!trace_push_ring(ring)) {}
+    trace_local = ring;
+    return ring;
+}
+
+// 寫入一個事件：先寫內容，再以 release 公開新的 head
+static void trace_write(const char* category, const char* name, int64_t start_ns, int64_t dur_ns, int32_t arg)
+{
+    TraceRing* ring = trace_ring();
+    if (!ring) return;
+    int64_t head = ring->head; // 只有本執行緒寫入 head
+    GameTraceEvent* e = &ring->events[(size_t)head & ring->mask];
+    e->category = category;
+    e->name = name;
+    e->start_ns = start_ns;
+    e->dur_ns = dur_ns;
+    e->arg = arg;
+    trace_store_release(&ring->head, head + 1);
+}
+
+// 記錄到現在結束的時間區段
+void game_trace_record(const char* category, const char* name, int64_t start_ns, int32_t arg)
+{
+    trace_write(category, name, start_ns, game_trace_now() - start_ns, arg);
+}
+
+// 記錄瞬間事件
+void game_trace_instant(const char* category, const char* name, int32_t arg)
+{
+    if (!game_trace_enabled) return;
+    trace_write(category, name, game_trace_now(), -1, arg);
+}
+
+// 設定目前執行緒的名稱
+void game_trace_thread_name(const char* name)
+{
+    TraceRing* ring = trace_ring();
+    if (ring) ring->thread_name = name;
+}
+
+//==============================================================
+// [ 輸出 ]
+//==============================================================
+// 寫出一個事件 (時間以微秒為單位)
+static void trace_write_event(FILE* out, int tid, const GameTraceEvent* e, bool* first)
+{
+    fprintf(out, "%s\n{\"pid\":1,\"tid\":%d,\"cat\":\"%s\",\"name\":\"%s\",\"ts\":%.3f",
+        *first ? "" : ",", tid, e->category, e->name, (double)e->start_ns / 1000.0);
+    if (e->dur_ns >= 0) fprintf(out, ",\"ph\":\"X\",\"dur\":%.3f", (double)e->dur_ns / 1000.0);
+    else fprintf(out, ",\"ph\":\"i\",\"s\":\"t\"");
+    if (e->arg != GAME_TRACE_NO_ARG) fprintf(out, ",\"args\":{\"value\":%d}", (int)e->arg);
+    fprintf(out, "}");
+    *first = false;
+}
+
+// 寫出所有執行緒的紀錄
+long game_trace_dump(const char* path)
+{
+    FILE* out = game_fopen(path, "w");
+    if (!out) return -1;
+
+    GameTraceEvent* copy = trace_capacity ? (GameTraceEvent*)malloc(trace_capacity * sizeof(GameTraceEvent)) : NULL;
+    long count = 0;
+    bool first = true;
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (TraceRing* ring = trace_rings; ring && copy; ring = ring->next) {
+        if (ring->thread_name) {
+            fprintf(out, "%s\n{\"pid\":1,\"tid\":%d,\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", ring->tid, ring->thread_name);
+            first = false;
+        }
+
+        // 先複製再檢查：複製期間被擁有者覆寫的舊事件不輸出
+        int64_t capacity = (int64_t)ring->mask + 1;
+        int64_t end = trace_load_acquire(&ring->head);
+        int64_t begin = end > capacity ? end - capacity : 0;
+        for (int64_t i = begin; i < end; i++) {
+            copy[i - begin] = ring->events[(size_t)i & ring->mask];
+        }
+        trace_fence();
+        int64_t now = trace_load_acquire(&ring->head);
+        int64_t valid = now > capacity ? now - capacity : 0;
+        for (int64_t i = valid > begin ? valid : begin; i < end; i++) {
+            trace_write_event(out, ring->tid, &copy[i - begin], &first);
+            count++;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    free(copy);
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0) ok = false;
+    return ok ? count : -1;
+}
+
+// 停止記錄並釋放所有緩衝區
+void game_trace_shutdown(void)
+{
+    game_trace_enabled = 0;
+    TraceRing* ring = trace_rings;
+    trace_rings = NULL;
+    while (ring) {
+        TraceRing* next = ring->next;
+        free(ring);
+        ring = next;
+    }
+    trace_local = NULL;
+    trace_capacity = 0;
+    trace_next_tid = 0;
+}
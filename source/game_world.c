@@ -0,0 +1,417 @@
+#include "game_world.h"
+
+#include <string.h>
+
+// 由種子衍生亂數時使用的鍵 (與 GameHashKind 不重疊)
+#define WORLD_KEY_CHUNK  32
+#define WORLD_KEY_PACKED 33
+#define WORLD_KEY_SPAWN  34
+
+#define WORLD_CHUNK_CELLS (WORLD_CHUNK_SIZE * WORLD_CHUNK_SIZE)
+#define WORLD_PACKED_MASK (WORLD_PACKED_SLOTS - 1)
+
+//==============================================================
+// [ 座標 ]
+//==============================================================
+// 世界座標所在的區塊 (向下取整，負座標也正確)
+static int32_t chunk_of(int v)
+{
+    return v >= 0 ? v / WORLD_CHUNK_SIZE : -((-v + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE);
+}
+
+// 區塊座標打包成雜湊的數值
+static uint64_t chunk_coords(int32_t cx, int32_t cy)
+{
+    return (uint64_t)(uint32_t)cx << 32 | (uint32_t)cy;
+}
+
+// 兩個區塊之間的距離 (區塊數，切比雪夫距離)
+static int64_t chunk_distance(int32_t ax, int32_t ay, int32_t bx, int32_t by)
+{
+    int64_t dx = (int64_t)ax - bx, dy = (int64_t)ay - by;
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+    return dx > dy ? dx : dy;
+}
+
+// 鏡頭視窗加上外圈的區塊範圍
+static WorldRange chunk_range(const GameWorld* world, int margin)
+{
+    WorldRange r;
+    r.x0 = chunk_of(world->camera.x) - margin;
+    r.y0 = chunk_of(world->camera.y) - margin;
+    r.x1 = chunk_of(world->camera.x + WORLD_VIEW_WIDTH - 1) + margin;
+    r.y1 = chunk_of(world->camera.y + WORLD_VIEW_HEIGHT - 1) + margin;
+    return r;
+}
+
+static bool range_contains(const WorldRange* r, int32_t cx, int32_t cy)
+{
+    return cx >= r->x0 && cx <= r->x1 && cy >= r->y0 && cy <= r->y1;
+}
+
+//==============================================================
+// [ 區塊的生成 ]
+//==============================================================
+// 區塊內的格子是否在牆上
+static bool chunk_has_wall(const WorldChunk* c, int lx, int ly)
+{
+    for (int i = 0; i < c->wall_count; i++) {
+        const WorldWall* w = &c->walls[i];
+        if (lx >= w->x && lx < w->x + w->width && ly >= w->y && ly < w->y + w->height) return true;
+    }
+    return false;
+}
+
+// 只由種子與區塊座標生成牆與食物 (同一個區塊每次生成的結果都相同)
+static void chunk_generate(uint64_t seed, int32_t cx, int32_t cy, WorldChunk* c)
+{
+    uint64_t rng = game_hash_key(WORLD_KEY_CHUNK, 0, seed ^ game_hash_key(WORLD_KEY_CHUNK, 1, chunk_coords(cx, cy))) | 1;
+    c->cx = cx;
+    c->cy = cy;
+    c->used = true;
+    c->eaten = 0;
+    c->wall_count = 0;
+    c->food_count = 0;
+
+    // 牆不碰到區塊的外圈，區塊之間永遠有相連的通道；出生的區塊沒有牆
+    bool spawn = cx == 0 && cy == 0;
+    int walls = spawn ? 0 : game_rng_next(&rng, WORLD_WALLS_MAX + 1);
+    for (int i = 0; i < walls; i++) {
+        WorldWall* w = &c->walls[c->wall_count++];
+        w->width = (uint8_t)(1 + game_rng_next(&rng, 4));
+        w->height = (uint8_t)(1 + game_rng_next(&rng, 4));
+        w->x = (uint8_t)(1 + game_rng_next(&rng, WORLD_CHUNK_SIZE - w->width - 1));
+        w->y = (uint8_t)(1 + game_rng_next(&rng, WORLD_CHUNK_SIZE - w->height - 1));
+    }
+
+    // 食物避開牆、其他食物與出生的格子，重抽次數有上限
+    int spawn_cell = (WORLD_CHUNK_SIZE / 2) * WORLD_CHUNK_SIZE + WORLD_CHUNK_SIZE / 2;
+    int food = 1 + game_rng_next(&rng, WORLD_FOOD_MAX);
+    for (int i = 0; i < food; i++) {
+        for (int tries = 0; tries < 8; tries++) {
+            int cell = game_rng_next(&rng, WORLD_CHUNK_CELLS);
+            bool ok = !chunk_has_wall(c, cell % WORLD_CHUNK_SIZE, cell / WORLD_CHUNK_SIZE)
+                && !(spawn && cell == spawn_cell);
+            for (int j = 0; j < c->food_count && ok; j++) ok = c->food[j] != cell;
+            if (ok) {
+                c->food[c->food_count++] = (uint8_t)cell;
+                break;
+            }
+        }
+    }
+}
+
+//==============================================================
+// [ 壓縮紀錄 ]
+//==============================================================
+static uint32_t packed_slot(int32_t cx, int32_t cy)
+{
+    return (uint32_t)game_hash_key(WORLD_KEY_PACKED, 0, chunk_coords(cx, cy)) & WORLD_PACKED_MASK;
+}
+
+// 尋找區塊的紀錄，沒有時返回-1
+static int packed_find(const GameWorld* world, int32_t cx, int32_t cy)
+{
+    for (uint32_t i = packed_slot(cx, cy);; i = (i + 1) & WORLD_PACKED_MASK) {
+        const WorldPacked* e = &world->packed[i];
+        if (e->eaten == 0) return -1;
+        if (e->cx == cx && e->cy == cy) return (int)i;
+    }
+}
+
+// 移除一筆紀錄：把之後同一串的紀錄往前移 (線性探測不使用墓碑)
+static void packed_remove(GameWorld* world, uint32_t i)
+{
+    for (uint32_t j = (i + 1) & WORLD_PACKED_MASK;; j = (j + 1) & WORLD_PACKED_MASK) {
+        const WorldPacked* e = &world->packed[j];
+        if (e->eaten == 0) break;
+        // 本來的位置在 i 之前 (環狀) 的紀錄才能移到 i
+        uint32_t home = packed_slot(e->cx, e->cy);
+        if (((j - home) & WORLD_PACKED_MASK) >= ((j - i) & WORLD_PACKED_MASK)) {
+            world->packed[i] = *e;
+            i = j;
+        }
+    }
+    world->packed[i].eaten = 0;
+    world->packed_count--;
+}
+
+// 紀錄已滿：從時鐘指針開始取樣幾筆，丟棄離蛇頭最遠的一筆
+static void packed_drop(GameWorld* world)
+{
+    Point h = game_world_body_at(world, 0);
+    int32_t hx = chunk_of(h.x), hy = chunk_of(h.y);
+    uint32_t i = world->packed_hand, best = i;
+    int64_t best_distance = -1;
+    for (int found = 0; found < WORLD_PACKED_SAMPLES; i = (i + 1) & WORLD_PACKED_MASK) {
+        const WorldPacked* e = &world->packed[i];
+        if (e->eaten == 0) continue;
+        found++;
+        int64_t d = chunk_distance(e->cx, e->cy, hx, hy);
+        if (d > best_distance) {
+            best_distance = d;
+            best = i;
+        }
+    }
+    world->packed_hand = i;
+    packed_remove(world, best);
+    world->stats.dropped++;
+}
+
+// 寫入移出常駐區的區塊 (常駐中的區塊不會有紀錄)
+static void packed_store(GameWorld* world, int32_t cx, int32_t cy, uint8_t eaten)
+{
+    if (world->packed_count >= WORLD_PACKED_MAX) packed_drop(world);
+    uint32_t i = packed_slot(cx, cy);
+    while (world->packed[i].eaten != 0) i = (i + 1) & WORLD_PACKED_MASK;
+    world->packed[i].cx = cx;
+    world->packed[i].cy = cy;
+    world->packed[i].eaten = eaten;
+    world->packed_count++;
+    world->stats.packed++;
+}
+
+//==============================================================
+// [ 常駐的區塊 ]
+//==============================================================
+// 尋找常駐的區塊，沒有時返回-1
+static int chunk_find(const GameWorld* world, int32_t cx, int32_t cy)
+{
+    const WorldChunk* last = &world->chunks[world->last_chunk];
+    if (last->used && last->cx == cx && last->cy == cy) return world->last_chunk;
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+        const WorldChunk* c = &world->chunks[i];
+        if (c->used && c->cx == cx && c->cy == cy) return i;
+    }
+    return -1;
+}
+
+// 把區塊移出常駐區，吃過食物的區塊寫入壓縮紀錄
+static void chunk_evict(GameWorld* world, int i)
+{
+    WorldChunk* c = &world->chunks[i];
+    if (c->eaten) packed_store(world, c->cx, c->cy, c->eaten);
+    c->used = false;
+    world->chunk_count--;
+    world->stats.evicted++;
+}
+
+// 生成區塊並套用壓縮紀錄
+static int chunk_activate(GameWorld* world, int32_t cx, int32_t cy)
+{
+    int slot = -1;
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS && slot < 0; i++) {
+        if (!world->chunks[i].used) slot = i;
+    }
+    if (slot < 0) {
+        // 常駐區已滿 (保留的外圈不超過上限時不會發生)：移出離蛇頭最遠的區塊
+        Point h = game_world_body_at(world, 0);
+        int64_t best_distance = -1;
+        for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+            const WorldChunk* c = &world->chunks[i];
+            int64_t d = chunk_distance(c->cx, c->cy, chunk_of(h.x), chunk_of(h.y));
+            if (d > best_distance) {
+                best_distance = d;
+                slot = i;
+            }
+        }
+        chunk_evict(world, slot);
+    }
+
+    WorldChunk* c = &world->chunks[slot];
+    chunk_generate(world->seed, cx, cy, c);
+    int packed = packed_find(world, cx, cy);
+    if (packed >= 0) {
+        c->eaten = world->packed[packed].eaten;
+        packed_remove(world, (uint32_t)packed);
+        world->stats.restored++;
+    }
+    world->chunk_count++;
+    world->stats.generated++;
+    return slot;
+}
+
+// 取得區塊，不在常駐區時生成
+static WorldChunk* chunk_at(GameWorld* world, int32_t cx, int32_t cy)
+{
+    int i = chunk_find(world, cx, cy);
+    if (i < 0) i = chunk_activate(world, cx, cy);
+    world->last_chunk = i;
+    return &world->chunks[i];
+}
+
+// 鏡頭跨過區塊邊界時，移出保留範圍外的區塊並生成新進入範圍的區塊
+static void update_chunks(GameWorld* world)
+{
+    WorldRange want = chunk_range(world, WORLD_GENERATE_MARGIN);
+    if (memcmp(&want, &world->generated, sizeof(want)) == 0) return;
+
+    WorldRange keep = chunk_range(world, WORLD_KEEP_MARGIN);
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+        const WorldChunk* c = &world->chunks[i];
+        if (c->used && !range_contains(&keep, c->cx, c->cy)) chunk_evict(world, i);
+    }
+    for (int32_t cy = want.y0; cy <= want.y1; cy++) {
+        for (int32_t cx = want.x0; cx <= want.x1; cx++) {
+            if (chunk_find(world, cx, cy) < 0) chunk_activate(world, cx, cy);
+        }
+    }
+    world->generated = want;
+}
+
+// 鏡頭跟隨蛇頭：蛇頭進入視窗邊緣的範圍時才捲動
+static void camera_follow(GameWorld* world)
+{
+    Point h = game_world_body_at(world, 0);
+    Point* cam = &world->camera;
+    if (h.x < cam->x + WORLD_CAMERA_MARGIN_X) cam->x = h.x - WORLD_CAMERA_MARGIN_X;
+    else if (h.x > cam->x + WORLD_VIEW_WIDTH - 1 - WORLD_CAMERA_MARGIN_X) cam->x = h.x - (WORLD_VIEW_WIDTH - 1 - WORLD_CAMERA_MARGIN_X);
+    if (h.y < cam->y + WORLD_CAMERA_MARGIN_Y) cam->y = h.y - WORLD_CAMERA_MARGIN_Y;
+    else if (h.y > cam->y + WORLD_VIEW_HEIGHT - 1 - WORLD_CAMERA_MARGIN_Y) cam->y = h.y - (WORLD_VIEW_HEIGHT - 1 - WORLD_CAMERA_MARGIN_Y);
+}
+
+//==============================================================
+// [ 規則 ]
+//==============================================================
+// 開始新的無盡模式
+void game_world_new(GameWorld* world, uint64_t seed)
+{
+    memset(world, 0, sizeof(*world));
+    world->seed = seed;
+    world->interval = START_INTERVAL;
+    world->alive = true;
+    world->death_cause = GAME_COLLISION_NONE;
+
+    // 蛇出生在原點區塊的中央，方向由種子決定
+    Point h = { WORLD_CHUNK_SIZE / 2, WORLD_CHUNK_SIZE / 2 };
+    world->body[0] = h;
+    world->length = 1;
+    uint64_t rng = game_hash_key(WORLD_KEY_SPAWN, 0, seed) | 1;
+    world->direction = (Direction)game_rng_next(&rng, 4);
+    world->next_direction = world->direction;
+
+    // 鏡頭以蛇頭為中心，生成周圍的區塊 (空的範圍使第一次更新一定會生成)
+    world->camera.x = h.x - WORLD_VIEW_WIDTH / 2;
+    world->camera.y = h.y - WORLD_VIEW_HEIGHT / 2;
+    world->generated.x0 = 1;
+    world->generated.x1 = 0;
+    update_chunks(world);
+}
+
+// 改變下一步的方向，不允許直接反向
+void game_world_turn(GameWorld* world, Direction dir)
+{
+    static const Direction opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    if (world->next_direction != opposite[dir]) {
+        world->next_direction = dir;
+    }
+}
+
+// 判定蛇頭移動到某格時的碰撞原因
+GameCollision game_world_collision_cause(const GameWorld* world, Point p)
+{
+    // 自撞 (不含目前的蛇頭)
+    for (int i = 1; i < world->length; i++) {
+        Point seg = game_world_body_at(world, i);
+        if (seg.x == p.x && seg.y == p.y) return GAME_COLLISION_SELF;
+    }
+
+    // 撞牆：不在常駐區的區塊暫時生成 (牆只由種子決定)
+    int32_t cx = chunk_of(p.x), cy = chunk_of(p.y);
+    int i = chunk_find(world, cx, cy);
+    WorldChunk temp;
+    const WorldChunk* c = &world->chunks[i >= 0 ? i : 0];
+    if (i < 0) {
+        chunk_generate(world->seed, cx, cy, &temp);
+        c = &temp;
+    }
+    if (chunk_has_wall(c, p.x - cx * WORLD_CHUNK_SIZE, p.y - cy * WORLD_CHUNK_SIZE)) return GAME_COLLISION_OBSTACLE;
+    return GAME_COLLISION_NONE;
+}
+
+// 蛇頭所在的格子有未吃掉的食物時吃掉
+static bool world_eat(GameWorld* world, Point p)
+{
+    int32_t cx = chunk_of(p.x), cy = chunk_of(p.y);
+    WorldChunk* c = chunk_at(world, cx, cy);
+    int cell = (p.y - cy * WORLD_CHUNK_SIZE) * WORLD_CHUNK_SIZE + (p.x - cx * WORLD_CHUNK_SIZE);
+    for (int i = 0; i < c->food_count; i++) {
+        if (!(c->eaten & (1u << i)) && c->food[i] == cell) {
+            c->eaten |= (uint8_t)(1u << i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 移動一步
+GameEvent game_world_step(GameWorld* world)
+{
+    if (!world->alive || world->length == 0) return GAME_EVENT_NONE;
+
+    // 經過一個移動間隔
+    world->elapsed_ms += world->interval;
+
+    // 更新方向並計算新的蛇頭位置 (沒有邊界)
+    world->direction = world->next_direction;
+    Point nh = game_world_body_at(world, 0);
+    switch (world->direction) {
+    case DIR_UP:    nh.y--; break;
+    case DIR_DOWN:  nh.y++; break;
+    case DIR_LEFT:  nh.x--; break;
+    case DIR_RIGHT: nh.x++; break;
+    }
+
+    // 檢查碰撞
+    GameCollision cause = game_world_collision_cause(world, nh);
+    if (cause != GAME_COLLISION_NONE) {
+        world->death_cause = cause;
+        world->alive = false;
+        return GAME_EVENT_DIED;
+    }
+    world->stats.steps++;
+
+    // 吃到食物時變長；已達上限時照常移除蛇尾 (先移除，新的蛇頭才不會覆蓋蛇尾)
+    bool ate = world_eat(world, nh);
+    if (ate) world->score++;
+    if (!ate || world->length == WORLD_MAX_LENGTH) world->length--;
+    world->head = (world->head == 0) ? WORLD_MAX_LENGTH - 1 : world->head - 1;
+    world->body[world->head] = nh;
+    world->length++;
+
+    int distance = game_world_distance(world);
+    if (distance > world->stats.max_distance) world->stats.max_distance = distance;
+
+    camera_follow(world);
+    update_chunks(world);
+    return ate ? GAME_EVENT_ATE : GAME_EVENT_NONE;
+}
+
+//==============================================================
+// [ 查詢與輸出 ]
+//==============================================================
+// 取得與視窗重疊的區塊範圍
+WorldRange game_world_visible(const GameWorld* world)
+{
+    return chunk_range(world, 0);
+}
+
+// 蛇頭離出生點的距離
+int game_world_distance(const GameWorld* world)
+{
+    Point h = game_world_body_at(world, 0);
+    int dx = h.x - WORLD_CHUNK_SIZE / 2, dy = h.y - WORLD_CHUNK_SIZE / 2;
+    return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+}
+
+// 輸出區塊與壓縮紀錄的統計
+void game_world_write_stats(const GameWorld* world, FILE* out)
+{
+    const GameWorldStats* s = &world->stats;
+    fprintf(out, "world: %ld steps, distance %d (max %d), length %d, score %d\n",
+        s->steps, game_world_distance(world), s->max_distance, world->length, world->score);
+    fprintf(out, "chunks: %d/%d active, %ld generated, %ld evicted; packed %d/%d (%ld stored, %ld restored, %ld dropped); %zu bytes\n",
+        world->chunk_count, WORLD_ACTIVE_CHUNKS, s->generated, s->evicted,
+        world->packed_count, WORLD_PACKED_MAX, s->packed, s->restored, s->dropped, sizeof(*world));
+}
@@ -9,13 +9,21 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <windows.h>
-
-//========================[ 常數 ]========================
-// 定義遊戲格子的寬度與高度
-#define GRID_WIDTH   40
-#define GRID_HEIGHT  20
-// 定義蛇移動的最大時間間隔 (毫秒)
-#define MAX_INTERVAL 250 // 最大移動間隔 (毫秒)
+#include "game_core.h"
+#include "game_snapshot.h"
+#include "game_bot.h"
+#include "game_draw.h"
+#include "game_trace.h"
+#include "game_net.h"
+#include "game_lockstep.h"
+#include "game_spectate.h"
+#include "game_scores.h"
+#include "game_metrics.h"
+#include "game_perf.h"
+#include "game_latency.h"
+#include "game_alloc.h"
+#include "game_world.h"
+#include "game_audio.h"
 
 //========================[ 遊戲模式 ]========================
 // 定義遊戲的不同模式，包括無模式、主菜單、單人模式、雙人模式和遊戲介紹模式
@@ -28,16 +36,28 @@ typedef enum {
 } GameMode;
 
 //========================[ 結構定義 ]========================
-// 定義障礙物的結構，包括位置和尺寸
+// 定義可暫停的遊戲定時器，暫停時記錄剩餘時間，恢復時精確地重新排程
 typedef struct {
-    int x, y;
-    int width, height;
-} Obstacle;
+    guint       id;         // GLib 定時器的ID (0 表示未啟動)
+    guint       interval;   // 觸發間隔 (毫秒)
+    gint64      deadline;   // 下一次觸發的時間 (單調時鐘，微秒)
+    gint64      remaining;  // 暫停時距離下一次觸發的剩餘時間 (微秒)
+    gboolean    suspended;  // 是否處於暫停狀態
+    gboolean    resuming;   // 下一次觸發是否為恢復後的單次觸發
+    GSourceFunc func;       // 觸發時呼叫的更新函式
+} GameTimer;
+
+// 交給最高分紀錄背景執行緒的工作
+typedef enum {
+    SCORE_JOB_APPEND,       // 附加一筆成績
+    SCORE_JOB_COMPACT,      // 壓縮紀錄檔
+    SCORE_JOB_QUIT          // 處理完先前的工作後結束
+} ScoreJobKind;
 
-// 定義點的結構，用於表示蛇的節點和食物的位置
 typedef struct {
-    int x, y;
-} Point;
+    ScoreJobKind    kind;
+    GameScoreRecord record; // SCORE_JOB_APPEND 的成績
+} ScoreJob;
 
 //========================[ 全域變數 ]========================
 
@@ -47,72 +67,161 @@ static GtkWidget* main_menu = NULL;         // 主菜單視圖
 static GtkWidget* pause_dialog = NULL;      // 暫停對話框
 static GtkWidget* stack = NULL;             // GtkStack 用於管理不同的視圖
 
+// 喚醒次數統計 (所有定時器回調都會計入)
+static guint64  wakeup_total = 0;            // 累計的喚醒次數
+static guint    wakeup_window_count = 0;     // 目前統計區間內的喚醒次數
+static gint64   wakeup_window_start = 0;     // 目前統計區間的開始時間 (微秒)
+static double   wakeups_per_second = 0.0;    // 上一個統計區間的每秒喚醒次數
+static gboolean wakeup_stats_enabled = FALSE; // 是否輸出喚醒統計 (環境變數 SNAKE_WAKEUP_STATS)
+static gchar*   trace_path = NULL;           // 效能追蹤的輸出路徑 (環境變數 SNAKE_TRACE)，NULL 表示不記錄
+
 // 倒數計時相關的全域變數
 static int      countdown = 3;               // 倒數計時的初始值
 static gboolean show_go = FALSE;            // 是否顯示「開始」字樣
 static gboolean game_started = FALSE;       // 遊戲是否已開始
-static guint    countdown_timer_id = 0;      // 倒數計時器的ID
+static GameTimer countdown_timer = { 0 };    // 倒數計時器
 
 // 遊戲模式相關的全域變數
 static GameMode current_mode = MODE_MENU;    // 當前的遊戲模式
 static gboolean game_over = FALSE;           // 遊戲是否結束
 static gboolean paused = FALSE;              // 遊戲是否暫停
 
-// 通用障礙物的全域變數
-static GList* obstacles = NULL;               // 存放所有障礙物的鏈表
+// 目前這一局的遊戲狀態 (蛇、障礙物、食物、分數)，記憶體來自其擁有的 GameArena
+static GameState game;
+static gboolean arena_stats_enabled = FALSE;  // 是否輸出記憶體統計 (環境變數 SNAKE_ARENA_STATS)
+
+// 自動駕駛 (P 鍵切換)：單人模式由距離場接手玩家的蛇，雙人模式由樹搜尋擔任玩家2
+static GameBot autopilot;
+static GameBot opponent;
+static gboolean autopilot_enabled = FALSE;
 
 //=== 單人模式相關的全域變數 ===
-static GList* snake_single = NULL;            // 單人模式下蛇的節點鏈表
-static Point   food_single;                   // 單人模式下食物的位置
-static int     direction_single = GDK_KEY_Right;       // 單人模式下蛇的當前移動方向
-static int     next_direction_single = GDK_KEY_Right;  // 單人模式下蛇的下個移動方向
-static int     score_single = 0;              // 單人模式下的分數
 static GtkWidget* canvas_single = NULL;       // 單人模式的繪圖區域
-static int    current_interval_single = 100; // 單人模式下蛇移動的當前時間間隔
-static guint  single_timer_id = 0;            // 單人模式的定時器ID
-static gboolean player_single_alive = TRUE;   // 單人模式下蛇是否存活
+static GameTimer single_timer = { 0 };        // 單人模式的定時器
+static gboolean  endless_enabled = FALSE;     // 單人模式是否為無盡模式 (世界由區塊組成，鏡頭跟隨蛇頭)
+static GameWorld world;                       // 無盡模式的世界 (固定大小，不配置記憶體)
 
 //=== 雙人模式相關的全域變數 ===
-static GList* snake1 = NULL;                  // 玩家1的蛇節點鏈表
-static GList* snake2 = NULL;                  // 玩家2的蛇節點鏈表
 // 玩家1使用WASD鍵，玩家2使用方向鍵
-static int    direction1 = GDK_KEY_d;         // 玩家1的當前移動方向
-static int    next_direction1 = GDK_KEY_d;    // 玩家1的下個移動方向
-static int    direction2 = GDK_KEY_Left;      // 玩家2的當前移動方向
-static int    next_direction2 = GDK_KEY_Left; // 玩家2的下個移動方向
-static Point  food_multi;                      // 雙人模式下食物的位置
-static int    score1 = 0;                      // 玩家1的分數
-static int    score2 = 0;                      // 玩家2的分數
-static gboolean player1_alive = TRUE;         // 玩家1是否存活
-static gboolean player2_alive = TRUE;         // 玩家2是否存活
-static int    winner = 0;                      // 贏家標識 (1: 玩家1, 2: 玩家2, 0: 平局)
-
-// === 雙人模式相關的時間變數 ===
-static time_t start_time_multi = 0;            // 雙人模式開始時間，用於計算存活秒數
-static time_t dead_time_player1 = 0;           // 玩家1的存活秒數
-static time_t dead_time_player2 = 0;           // 玩家2的存活秒數
-
 static GtkWidget* canvas_multi = NULL;         // 雙人模式的繪圖區域
-static int    current_interval_player1 = 100; // 玩家1的移動時間間隔
-static int    current_interval_player2 = 100; // 玩家2的移動時間間隔
-static guint  player1_timer_id = 0;           // 玩家1的定時器ID
-static guint  player2_timer_id = 0;           // 玩家2的定時器ID
+static GameTimer player1_timer = { 0 };       // 玩家1的定時器
+static GameTimer player2_timer = { 0 };       // 玩家2的定時器
+
+//=== 網路雙人模式 (環境變數 SNAKE_NET=玩家:本機埠號:對方位址:對方埠號[:輸入延遲]) ===
+// 兩端各自執行同一局，只交換轉向輸入 (game_lockstep)；WASD 與方向鍵都控制本機的蛇
+// SNAKE_NET_ROLLBACK=格數 時主機改用回溯模式：本機輸入立即生效，對方的輸入先預測，猜錯時回溯修正
+static gboolean       net_enabled = FALSE;    // 雙人模式是否經由網路對戰
+static GameNet        net_socket;             // UDP 通訊端
+static GameNetAddress net_peer;               // 對方的位址
+static int            net_player = 0;         // 本機玩家索引 (0 為主機)
+static int            net_delay = GAME_LOCKSTEP_DEFAULT_DELAY; // 輸入延遲 (移動次數)
+static int            net_rollback = 0;       // 回溯模式最多預測的格數 (0 為確定性同步)
+static gboolean       net_death_shown[MAX_PLAYERS] = { FALSE }; // 已為目前局面中的死亡啟動閃爍
+static uint8_t        net_match = 0;          // 對局編號 (兩端依相同順序再來一局)
+static GameLockstep   lockstep;               // 同步狀態
+static GameTimer      net_timer = { 0 };      // 收發封包並推進遊戲的定時器
+static gint64         net_last_tick = 0;      // 上次收發封包的時間 (微秒)
+
+//=== 觀戰模式 (環境變數 SNAKE_SPECTATE=伺服器位址:埠號[:房間]) ===
+// 雙人模式改為觀看 snake_server 上的對局：套用伺服器送出的增量串流，對局結束後自動改看另一個房間
+#define SPECTATE_RETRY_US   (200 * 1000)      // 遺漏影格後再次要求關鍵影格的間隔
+#define SPECTATE_RESEND_US  (1000 * 1000)     // 尚未收到串流時重送 WATCH 的間隔
+#define SPECTATE_RENEW_US   (2000 * 1000)     // 續訂的間隔 (伺服器在 6 秒沒有續訂後移除觀眾)
+#define SPECTATE_SILENCE_US (5000 * 1000)     // 超過此時間沒有串流時重新向大廳要求
+static gboolean         spectate_enabled = FALSE;
+static GameNet          spectate_socket;        // UDP 通訊端
+static GameNetAddress   spectate_server;        // 伺服器大廳的位址
+static GameNetAddress   spectate_worker;        // 目前房間所在的工作執行緒位址 (收到串流後得知)
+static uint32_t         spectate_room = 0;      // 指定的房間 (0 表示任一)
+static gboolean         spectate_joined = FALSE; // 是否正在收到串流
+static GameSpectateView spectate_view;          // 套用串流後的局面
+static GameTimer        spectate_timer = { 0 }; // 收取串流的定時器
+static gint64           spectate_watch_at = 0;  // 上次送出 WATCH 的時間 (微秒)
+static gint64           spectate_heard_at = 0;  // 上次收到串流的時間 (微秒)
+
+//=== 遊戲結束畫面 (只建立一次，每局重複使用) ===
+static GtkWidget* game_over_label_single = NULL;  // 單人模式結束畫面的結果標籤
+static GtkWidget* game_over_label_multi = NULL;   // 雙人模式結束畫面的結果標籤
+static GtkWidget* rematch_btn_single = NULL;      // 單人模式的「再來一局」按鈕
+static GtkWidget* rematch_btn_multi = NULL;       // 雙人模式的「再來一局」按鈕
+
+// 再來一局的反應時間量測 (按鍵到第一個倒數畫面)
+static gint64 rematch_requested_at = 0;           // 要求再來一局的時間 (微秒)，0 表示沒有待量測的要求
+static gint64 rematch_latency_max = 0;            // 量測到的最大反應時間 (微秒)
+
+// 最高分紀錄 (使用者資料目錄的 SnakeHero/scores.log)：紀錄檔的讀寫都在背景執行緒，
+// 介面執行緒只更新記憶體中的索引，結束畫面不會等待磁碟
+static GameScores*  scores = NULL;              // 索引 (背景執行緒載入完成前為NULL)
+static GArray*      scores_pending = NULL;      // 載入完成前結束的對局 (GameScoreRecord)
+static GThread*     scores_thread = NULL;       // 讀寫紀錄檔的背景執行緒
+static GAsyncQueue* scores_queue = NULL;        // 交給背景執行緒的工作 (ScoreJob)
+static gchar*       scores_path = NULL;         // 紀錄檔路徑
+static uint64_t     single_seed = 0;            // 目前單人局的種子
+static gboolean     single_recordable = FALSE;  // 本局的成績是否列入紀錄 (讀檔或使用過自動駕駛的對局不列入)
+
+// 遊戲統計 (環境變數 SNAKE_METRICS=路徑.csv 或 路徑.jsonl 時每局結束附加一筆摘要，F10 輸出目前的統計快照)
+static GameMetricsGame metrics_game;            // 本局的摘要 (mode 為NULL表示不記錄，例如觀戰)
+static gchar*  metrics_path = NULL;             // 每局摘要的輸出路徑
+static gint64  countdown_started_at = 0;        // 倒數開始的時間 (微秒)
+static gint64  countdown_paused_us = 0;         // 倒數期間暫停的時間 (微秒)
+static gint64  paused_at = 0;                   // 暫停開始的時間 (微秒)，0 表示未暫停
+
+// 效能疊加層 (F3 切換，環境變數 SNAKE_PERF_OVERLAY 時一開始就顯示)：樣本一律記錄到固定大小的環形緩衝區，
+// 只有顯示時才計算統計，疊加層本身的繪製不計入畫面時間
+#define PERF_FRAME_BUDGET_MS (1000.0 / 60.0)    // 長條圖的滿格 (60Hz 的一個畫面)
+static GamePerf perf;                           // 疊加層的資料
+static gint64   perf_last_frame_at = 0;         // 上一次繪製的時間 (微秒)
+
+// 端到端的輸入延遲：按鍵的事件時間 → 套用轉向的移動 → 轉向後第一次呈現的畫面 (GdkFrameClock 的呈現時間)，
+// 依模式與玩家累計，F10 與結束時輸出百分位數
+#define LATENCY_PRESENT_WAIT_FRAMES 8            // 等待畫面時序完成的最多畫面數
+static GameLatency input_latency;
+
+// 記憶體配置統計 (環境變數 SNAKE_ALLOC_STATS)：依子系統與遊戲階段計數，標記移動定時器之中的配置
+#define ALLOC_REPORT_LIMIT 20                   // 立即列出的有配置的移動數
+static long alloc_flagged_ticks = 0;            // 已列出的有配置的移動數
+
+//=== 死亡閃爍相關的全域變數 ===
+static gboolean snake_hidden[MAX_PLAYERS] = { FALSE };   // 閃爍中目前是否隱藏蛇
+static gboolean flicker_done[MAX_PLAYERS] = { FALSE };   // 死亡閃爍是否已結束
+static guint    flicker_timer_ids[MAX_PLAYERS] = { 0 };  // 閃爍定時器的ID
 
 //=== 固定網格尺寸 ===
 static double CELL_SIZE = 45.0;                // 單位格子的大小 (像素)
 
 //=== 音效管理相關的結構和變數 ===
-typedef struct {
-    GstElement* pipeline; // GStreamer的pipeline元素
-    gboolean loop;        // 是否循環播放
-} SoundData;
+// 管線由 game_audio 建立 (見 game_audio.h)
+typedef GameSound SoundData;
+
+// 內嵌於執行檔的音效資源 (見 snake_hero.gresource.xml)
+typedef enum {
+    SOUND_BUTTON_CLICK = 0,        // 按鈕點擊
+    SOUND_COUNTDOWN,               // 倒數 3~1
+    SOUND_EAT_FRUIT,               // 吃到果實
+    SOUND_MAIN_MENU_BACKGROUND,    // 主選單背景音樂
+    SOUND_SNAKE_DIE,               // 蛇死亡
+    SOUND_COUNT
+} SoundAsset;
+
+// 各音效在 GResource 中的路徑
+static const char* const sound_asset_paths[SOUND_COUNT] = {
+    "/com/example/snakegame/Musics/button_click.mp3",
+    "/com/example/snakegame/Musics/countdown_3_to_1.mp3",
+    "/com/example/snakegame/Musics/eat_fruit.mp3",
+    "/com/example/snakegame/Musics/main_menu_background.mp3",
+    "/com/example/snakegame/Musics/snake_die.mp3",
+};
+
+// 啟動時查詢一次的音效資料，之後播放不再查詢資源或檔案系統
+static GBytes* sound_assets[SOUND_COUNT] = { NULL };
 
 // 全域變數來管理主選單背景音樂
 static SoundData* main_menu_music = NULL;
-// 全域變數來管理遊戲背景音樂
-static SoundData* game_background_music = NULL;
 // 全域變數來管理倒數音效
 static SoundData* countdown_music = NULL;
+// 移動定時器中觸發的音效 (以 SoundAsset 為位元)，建立管線會配置記憶體，留到定時器之後的閒置回調才播放
+static guint pending_sounds = 0;
+static guint pending_sounds_source = 0;
 
 //==============================================================
 // 函式宣告
@@ -120,28 +229,76 @@ static SoundData* countdown_music = NULL;
 
 /* 音效播放相關函式 */
 
+/**
+ * @brief 載入內嵌音效資源的函式。
+ *
+ * 從編譯進執行檔的GResource中取得所有音效資料並快取，只需在啟動時呼叫一次。
+ *
+ * @return 如果所有音效都存在，返回TRUE；否則返回FALSE。
+ */
+static gboolean load_sound_assets(void);
+
 /**
  * @brief 播放音效的函式。
  *
- * 此函式使用GStreamer播放指定的音效檔案。
+ * 此函式使用GStreamer播放指定的內嵌音效，資料經由appsrc直接交給解碼器，不經過檔案系統。
  *
- * @param filename 音效檔案的路徑。
+ * @param asset 要播放的音效。
  * @param loop 是否循環播放音效。
  * @param volume_level 音量大小，範圍通常為0.0到1.0。
  * @return 返回SoundData結構的指標，用於後續控制音效。
  */
-static SoundData* play_sound_effect(const char* filename, gboolean loop, float volume_level);
+static SoundData* play_sound_effect(SoundAsset asset, gboolean loop, float volume_level);
+
+/**
+ * @brief 在移動定時器中要求播放音效的函式。
+ *
+ * 只記錄要播放的音效 (不配置記憶體)，由 game_timer_fire 在定時器結束後排入閒置回調播放，
+ * 同一次移動中重複的音效只播放一次。
+ *
+ * @param asset 要播放的音效 (不循環，音量 1.0)。
+ */
+static void queue_sound_effect(SoundAsset asset);
+
+/**
+ * @brief 播放定時器中累積的音效的閒置回調。
+ *
+ * @param data 未使用。
+ * @return 一律移除來源。
+ */
+static gboolean play_queued_sounds(gpointer data);
+
+/**
+ * @brief 建立並啟動音效管線的函式。
+ *
+ * 由 play_sound_effect 呼叫，整個建立過程在效能追蹤中記錄為一個區段。
+ *
+ * @param asset 要播放的音效。
+ * @param loop 是否循環播放音效。
+ * @param volume_level 音量大小，範圍通常為0.0到1.0。
+ * @return 返回SoundData結構的指標，失敗時返回NULL。
+ */
+static SoundData* create_sound_effect(SoundAsset asset, gboolean loop, float volume_level);
+
+/**
+ * @brief 音效管線釋放時的回調，更新效能疊加層的音效數。
+ *
+ * @param data 未使用。
+ * @param pipeline 已釋放的管線。
+ */
+static void on_voice_finalized(gpointer data, GObject* pipeline);
 
 /**
- * @brief 當GStreamer解碼器新增pad時的回調函式。
+ * @brief 音效管線的同步訊息回調 (在送出訊息的執行緒呼叫)。
  *
- * 此函式負責將解碼後的音頻流連接到後續的處理元件。
+ * GStreamer 的串流執行緒開始時，把該執行緒的記憶體配置歸入音效子系統。
  *
- * @param src 來源的GstElement。
- * @param new_pad 新增加的GstPad。
- * @param data 用於連接的目標元件（通常是audioconvert）。
+ * @param bus 音效管線的Bus。
+ * @param msg 訊息。
+ * @param data 未使用。
+ * @return 一律交給一般的訊息處理。
  */
-static void on_pad_added(GstElement* src, GstPad* new_pad, gpointer data);
+static GstBusSyncReply on_audio_sync_message(GstBus* bus, GstMessage* msg, gpointer data);
 
 
 /* 其他函式宣告 */
@@ -156,6 +313,16 @@ static void on_pad_added(GstElement* src, GstPad* new_pad, gpointer data);
  */
 static void on_single_mode_clicked(GtkButton* button, gpointer user_data);
 
+/**
+ * @brief 無盡模式按鈕的回調函式。
+ *
+ * 以單人模式的流程開始無盡模式：沒有邊界的世界，鏡頭跟隨蛇頭。
+ *
+ * @param button 被點擊的按鈕。
+ * @param user_data 傳遞的使用者資料 (GtkStack)。
+ */
+static void on_endless_mode_clicked(GtkButton* button, gpointer user_data);
+
 /**
  * @brief 雙人模式按鈕點擊事件的回調函式。
  *
@@ -183,6 +350,16 @@ static void show_main_menu(void);
  */
 static void on_back_to_menu_clicked(GtkButton* button, gpointer user_data);
 
+/**
+ * @brief 再來一局按鈕點擊事件的回調函式。
+ *
+ * 在遊戲結束畫面中，以相同模式立即重新開始，只重置遊戲狀態而不重建任何視圖。
+ *
+ * @param button 被點擊的GtkButton，由鍵盤觸發時為NULL。
+ * @param user_data 無特定用途，可為NULL。
+ */
+static void on_rematch_clicked(GtkButton* button, gpointer user_data);
+
 /**
  * @brief 退出遊戲按鈕點擊事件的回調函式。
  *
@@ -211,50 +388,111 @@ static void create_pause_dialog(void);
 static void on_resume_game(GtkButton* btn, gpointer user_data);
 
 
-/* 倒數計時相關函式 */
+/* 快速存檔相關函式 */
 
 /**
- * @brief 開始倒數計時的函式。
+ * @brief 快速存檔的函式 (F5)。
  *
- * 初始化倒數計時的相關變數，並設置定時器以每隔一定時間更新倒數狀態。
+ * 將目前這一局的完整狀態 (含倒數階段與定時器剩餘時間) 寫成二進位快照。
  */
-static void start_countdown(void);
+static void quick_save(void);
 
 /**
- * @brief 倒數計時的定時器回調函式。
+ * @brief 快速讀檔的函式 (F9)。
  *
- * 每次定時器觸發時，更新倒數值或開始遊戲。
+ * 映射快照檔案後載入，並以存檔時的剩餘時間重新排程定時器。
+ */
+static void quick_load(void);
+
+
+/* 環境變數 */
+
+/**
+ * @brief 解析環境變數中的一個整數欄位 (整個欄位都必須是十進位整數)。
  *
- * @param data 無特定用途，可為NULL。
- * @return 返回TRUE以繼續定時器，返回FALSE以停止定時器。
+ * @param text 欄位文字。
+ * @param out 輸出。
+ * @return 解析成功返回TRUE；否則返回FALSE且不修改輸出。
  */
-static gboolean countdown_tick(gpointer data);
+static gboolean parse_env_int(const gchar* text, int* out);
+
+/* 效能追蹤相關函式 */
+
+/**
+ * @brief 寫出效能追蹤的函式 (F12 或程式結束時)。
+ *
+ * 把目前記錄的時間區段寫成 Chrome / Perfetto 的 trace event JSON。
+ */
+static void dump_trace(void);
+
 
+/* 定時器排程相關函式 */
 
-/* 障礙物生成相關函式 */
+/**
+ * @brief 啟動遊戲定時器的函式。
+ *
+ * 以指定的間隔週期性地呼叫更新函式；若定時器已在執行，會先停止再重新排程。
+ *
+ * @param timer 要啟動的定時器。
+ * @param interval 觸發間隔 (毫秒)。
+ * @param func 每次觸發時呼叫的更新函式。
+ */
+static void game_timer_start(GameTimer* timer, guint interval, GSourceFunc func);
+
+/**
+ * @brief 停止遊戲定時器的函式。
+ *
+ * @param timer 要停止的定時器，未啟動時不做任何事。
+ */
+static void game_timer_stop(GameTimer* timer);
+
+/**
+ * @brief 暫停所有遊戲定時器的函式。
+ *
+ * 記錄每個定時器距離下一次觸發的剩餘時間並移除定時器，暫停期間不會再喚醒程式。
+ */
+static void suspend_game_timers(void);
+
+/**
+ * @brief 恢復所有遊戲定時器的函式。
+ *
+ * 以暫停時記錄的剩餘時間重新排程，之後恢復為原本的間隔。
+ */
+static void resume_game_timers(void);
 
 /**
- * @brief 檢查障礙物生成位置是否有效的函式。
+ * @brief 記錄一次喚醒的函式。
  *
- * 確保障礙物不會生成在被排除的位置（例如蛇的初始位置附近）。
+ * 所有定時器回調都會呼叫，用於統計每秒喚醒次數。
+ */
+static void note_wakeup(void);
+
+/**
+ * @brief 取得每秒喚醒次數的函式。
+ *
+ * @return 最近一個統計區間內定時器回調的每秒次數。
+ */
+static double get_wakeups_per_second(void);
+
+
+/* 倒數計時相關函式 */
+
+/**
+ * @brief 開始倒數計時的函式。
  *
- * @param x 障礙物左上角的X坐標。
- * @param y 障礙物左上角的Y坐標。
- * @param w 障礙物的寬度。
- * @param h 障礙物的高度。
- * @param excluded_positions 不允許生成障礙物的位置鏈表。
- * @return 如果位置有效，返回TRUE；否則返回FALSE。
+ * 初始化倒數計時的相關變數，並設置定時器以每隔一定時間更新倒數狀態。
  */
-static gboolean is_obstacle_valid(int x, int y, int w, int h, GList* excluded_positions);
+static void start_countdown(void);
 
 /**
- * @brief 生成障礙物的函式。
+ * @brief 倒數計時的定時器回調函式。
  *
- * 在遊戲地圖上隨機生成一定數量的障礙物，並避免與排除的位置重疊。
+ * 每次定時器觸發時，更新倒數值或開始遊戲。
  *
- * @param initial_positions 初始位置的鏈表，用於避免障礙物生成在這些位置。
+ * @param data 無特定用途，可為NULL。
+ * @return 返回TRUE以繼續定時器，返回FALSE以停止定時器。
  */
-static void generate_obstacles(GList* initial_positions);
+static gboolean countdown_tick(gpointer data);
 
 
 /* 單人遊戲相關函式 */
@@ -277,28 +515,45 @@ static void init_single_game(void);
 static gboolean update_game_single(gpointer data);
 
 /**
- * @brief 生成單人模式下食物的位置。
+ * @brief 更新無盡模式狀態的定時器回調函式。
+ *
+ * 移動蛇並檢查碰撞與食物，之後由 game_world 更新鏡頭與常駐的區塊。
+ *
+ * @param data 無特定用途，可為NULL。
+ * @return 返回TRUE以繼續定時器，返回FALSE以停止定時器。
+ */
+static gboolean update_game_endless(gpointer data);
+
+/**
+ * @brief 顯示單人模式遊戲結束畫面的函式。
  *
- * 隨機選擇一個有效的位置生成食物，確保食物不會出現在蛇或障礙物上。
+ * 當蛇死亡後，顯示遊戲結束畫面並顯示最終分數。
  */
-static void generate_food_single(void);
+static void show_game_over_screen_single(void);
 
 /**
- * @brief 檢查單人模式下蛇是否發生碰撞。
+ * @brief 記錄單人局的成績。
  *
- * 檢查蛇頭是否與自身或障礙物發生碰撞。
+ * 在介面執行緒更新記憶體中的索引，把寫入紀錄檔的工作交給背景執行緒。
  *
- * @param head 蛇頭的位置。
- * @return 如果發生碰撞，返回TRUE；否則返回FALSE。
+ * @param record 成績。
+ * @param previous_best 輸出同一個網格尺寸先前的最佳分數 (沒有紀錄時為-1)。
+ * @return 在總排行榜的名次 (從1開始)；沒有進入排行榜或索引尚未載入時返回0。
  */
-static gboolean check_collision_single(Point* head);
+static int record_score(const GameScoreRecord* record, int* previous_best);
 
 /**
- * @brief 顯示單人模式遊戲結束畫面的函式。
+ * @brief 開始本局的統計摘要。
  *
- * 當蛇死亡後，顯示遊戲結束畫面並顯示最終分數。
+ * @param mode 模式名稱 (字串常數)。
+ * @param seed 種子 (不明時為0)。
  */
-static void show_game_over_screen_single(void);
+static void begin_game_metrics(const char* mode, uint64_t seed);
+
+/**
+ * @brief 結算本局的統計，設置 SNAKE_METRICS 時把摘要附加到該檔案。
+ */
+static void finish_game_metrics(void);
 
 /**
  * @brief 單人模式下蛇死亡的處理函式。
@@ -338,33 +593,24 @@ static gboolean update_player1(gpointer data);
 static gboolean update_player2(gpointer data);
 
 /**
- * @brief 生成雙人模式下食物的位置。
- *
- * 隨機選擇一個有效的位置生成食物，確保食物不會出現在任何一條蛇或障礙物上。
- */
-static void generate_food_multi(void);
-
-/**
- * @brief 檢查蛇是否自撞的函式。
+ * @brief 網路雙人模式的定時器回調函式。
  *
- * 檢查指定蛇的蛇頭是否與自身的身體節點重疊。
+ * 收取對方的輸入、在遊戲時間到了且兩端的輸入都已知時推進遊戲，並送出本機的輸入。
  *
- * @param head 蛇頭的位置。
- * @param snake 蛇的節點鏈表。
- * @return 如果自撞，返回TRUE；否則返回FALSE。
+ * @param data 無特定用途，可為NULL。
+ * @return 返回TRUE以繼續定時器，返回FALSE以停止定時器。
  */
-static gboolean check_self_collision(Point* head, GList* snake);
+static gboolean update_network(gpointer data);
 
 /**
- * @brief 檢查蛇是否撞到另一條蛇的函式。
+ * @brief 觀戰模式的定時器回調函式。
  *
- * 檢查指定蛇的蛇頭是否與另一條蛇的任何節點重疊。
+ * 收取伺服器的串流並套用到觀眾的局面，遺漏影格時要求關鍵影格，定期續訂，對局結束後改看另一個房間。
  *
- * @param head 蛇頭的位置。
- * @param snake 另一條蛇的節點鏈表。
- * @return 如果撞到另一條蛇，返回TRUE；否則返回FALSE。
+ * @param data 無特定用途，可為NULL。
+ * @return 返回TRUE以繼續定時器，返回FALSE以停止定時器。
  */
-static gboolean check_snake_collision(Point* head, GList* snake);
+static gboolean update_spectate(gpointer data);
 
 /**
  * @brief 顯示雙人模式遊戲結束畫面的函式。
@@ -397,68 +643,27 @@ static void end_two_player_game(void);
 static void draw_game(GtkDrawingArea* area, cairo_t* cr, int width, int height, gpointer user_data);
 
 /**
- * @brief 繪製單人模式遊戲畫面的函式。
- *
- * 繪製單人模式下的遊戲元素，包括背景、食物、障礙物、蛇、分數和倒數計時。
- *
- * @param cr Cairo繪圖上下文。
- * @param width 畫布的寬度。
- * @param height 畫布的高度。
- * @param cell_size 每個格子的大小（像素）。
- */
-static void draw_single_mode(cairo_t* cr, int width, int height, double cell_size);
-
-/**
- * @brief 繪製雙人模式遊戲畫面的函式。
- *
- * 繪製雙人模式下的遊戲元素，包括背景、食物、障礙物、兩條蛇、分數和倒數計時。
- *
- * @param cr Cairo繪圖上下文。
- * @param width 畫布的寬度。
- * @param height 畫布的高度。
- * @param cell_size 每個格子的大小（像素）。
- */
-static void draw_multi_mode(cairo_t* cr, int width, int height, double cell_size);
-
-/**
- * @brief 繪製蛇的一個節點的函式。
+ * @brief 輸入延遲的畫面記錄。
  *
- * 繪製蛇的身體節點，包括陰影和本體顏色，以增強視覺效果。
+ * 把已套用的轉向記為在目前的畫面 (GdkFrameClock 的畫面編號) 繪製，
+ * 並以先前畫面的呈現時間結算它們的延遲。
  *
- * @param cr Cairo繪圖上下文。
- * @param x 節點的X坐標（像素）。
- * @param y 節點的Y坐標（像素）。
- * @param size 節點的大小（像素）。
- * @param body 蛇身體的顏色。
- * @param shadow 蛇陰影的顏色。
+ * @param area 繪製中的GtkDrawingArea。
+ * @param drawn_at 繪製完成的時間 (微秒)。
  */
-static void draw_snake_segment(cairo_t* cr, double x, double y, double size,
-    GdkRGBA body, GdkRGBA shadow);
+static void track_latency_frame(GtkDrawingArea* area, gint64 drawn_at);
 
 /**
- * @brief 繪製食物的函式。
- *
- * 繪製食物的位置，包括陰影和本體顏色，以增強視覺效果。
- *
- * @param cr Cairo繪圖上下文。
- * @param x 食物的X坐標（像素）。
- * @param y 食物的Y坐標（像素）。
- * @param size 食物的大小（像素）。
+ * @brief 依目前的模式與遊戲狀態更新記憶體配置統計的遊戲階段。
  */
-static void draw_food(cairo_t* cr, double x, double y, double size);
+static void update_alloc_phase(void);
 
 /**
- * @brief 繪製牆壁的函式。
+ * @brief 在移動之外預先配置目前接手控制的電腦玩家需要的記憶體。
  *
- * 繪製障礙物的位置，包括陰影和本體顏色，以增強視覺效果。
- *
- * @param cr Cairo繪圖上下文。
- * @param x 牆壁左上角的X坐標（像素）。
- * @param y 牆壁左上角的Y坐標（像素）。
- * @param w 牆壁的寬度（像素）。
- * @param h 牆壁的高度（像素）。
+ * 開局、讀檔與開啟自動駕駛時呼叫，移動定時器中的決策不需要配置記憶體。
  */
-static void draw_wall(cairo_t* cr, double x, double y, double w, double h);
+static void prepare_bots(void);
 
 
 /* 鍵盤按鍵處理副程式 */
@@ -479,6 +684,16 @@ static gboolean on_key_press(GtkEventControllerKey* controller,
     guint keyval, guint keycode,
     GdkModifierType state, gpointer user_data);
 
+/**
+ * @brief 依按鍵更新遊戲狀態的函式。
+ *
+ * 由 on_key_press 呼叫，整個處理過程在效能追蹤中記錄為一個區段。
+ *
+ * @param keyval 按鍵的GDK鍵值。
+ * @return 如果事件被處理，返回TRUE；否則返回FALSE。
+ */
+static gboolean handle_key_press(guint keyval);
+
 
 /* 主選單與介紹模式按鈕相關函式 */
 
@@ -493,26 +708,12 @@ static gboolean on_key_press(GtkEventControllerKey* controller,
 static void on_intro_mode_clicked(GtkButton* button, gpointer user_data);
 
 
-/* 隨機方向生成相關函式 */
-
-/**
- * @brief 生成隨機方向的函式。
- *
- * 隨機選擇一個方向鍵（上、下、左、右）作為蛇的初始移動方向。
- *
- * @return 返回選擇的GDK鍵值，代表蛇的移動方向。
- */
-static int get_random_direction(void);
-
-
 //==============================================================
 // [蛇閃爍機制] - 定義
 //==============================================================
-// 定義用於蛇閃爍效果的結構
+// 定義用於蛇閃爍效果的結構 (配置自本局的 GameArena)
 typedef struct {
-    GList** snake_ref;       // 要閃爍的蛇 (鏈表)
-    gboolean* snake_alive;   // 該蛇對應的存活狀態
-    GList* original_snake_data; // 原始蛇的數據
+    int player;              // 要閃爍的玩家索引
     int flicker_count;       // 閃爍計數
     int flicker_max;         // 最大閃爍次數
     GtkWidget* draw_canvas;  // 用於重繪的畫布
@@ -521,33 +722,35 @@ typedef struct {
 // 閃爍效果的回調函式
 static gboolean do_flicker_snake(gpointer data);
 
+// 閃爍結束後的處理：隱藏蛇並檢查是否需要結束遊戲
+static void finish_flicker_snake(int player);
+
 // 啟動蛇閃爍機制
-static void start_flicker_snake(GList** snake_ref, gboolean* snake_alive, GtkWidget* draw_canvas)
+static void start_flicker_snake(int player, GtkWidget* draw_canvas)
 {
-    FlickerData* fd = (FlickerData*)malloc(sizeof(FlickerData));
-    fd->snake_ref = snake_ref;
-    fd->snake_alive = snake_alive;
-    fd->original_snake_data = *snake_ref; // 保留蛇的身體
+    FlickerData* fd = (FlickerData*)game_arena_alloc(&game.arena, sizeof(FlickerData));
+    if (!fd) {
+        // 記憶體區塊不足時略過閃爍效果
+        finish_flicker_snake(player);
+        return;
+    }
+    fd->player = player;
     fd->flicker_count = 0;
     fd->flicker_max = 4;  // 閃爍次數 
     fd->draw_canvas = draw_canvas;
 
     // 啟動閃爍定時器，每300毫秒呼叫一次do_flicker_snake
-    g_timeout_add(300, do_flicker_snake, fd);
+    flicker_timer_ids[player] = g_timeout_add(300, do_flicker_snake, fd);
 }
 
 // 每次呼叫 do_flicker_snake
 static gboolean do_flicker_snake(gpointer data)
 {
     FlickerData* fd = (FlickerData*)data;
+    note_wakeup();
 
-    // 如果目前蛇存在 => 隱藏；不存在 => 還原
-    if (*(fd->snake_ref)) {
-        *(fd->snake_ref) = NULL;
-    }
-    else {
-        *(fd->snake_ref) = fd->original_snake_data;
-    }
+    // 如果目前蛇顯示 => 隱藏；隱藏 => 還原
+    snake_hidden[fd->player] = !snake_hidden[fd->player];
 
     // 重繪畫布
     if (fd->draw_canvas) {
@@ -555,49 +758,263 @@ static gboolean do_flicker_snake(gpointer data)
     }
 
     fd->flicker_count++;
-    // 閃爍到指定次數 => 真正刪除蛇並設置為死亡
+    // 閃爍到指定次數 => 隱藏蛇並結束閃爍
     if (fd->flicker_count >= fd->flicker_max) {
-        // 只設置為死亡，不釋放內存
-        *(fd->snake_alive) = FALSE;
-
-        // 將蛇從列表中移除
-        if (*(fd->snake_ref)) {
-            // 將蛇列表清空並釋放內存
-            for (GList* iter = *(fd->snake_ref); iter; iter = iter->next) {
-                free(iter->data);
-            }
-            g_list_free(*(fd->snake_ref));
-            *(fd->snake_ref) = NULL;
-        }
+        // fd 屬於本局的記憶體區塊，隨本局一起釋放
+        flicker_timer_ids[fd->player] = 0;
+        finish_flicker_snake(fd->player);
+        return FALSE; // 結束定時器
+    }
 
-        free(fd);
+    return TRUE; // 繼續定時器
+}
 
-        // 檢查是否需要結束遊戲
-        if (current_mode == MODE_MULTI) {
-            if (!player1_alive && !player2_alive) {
-                end_two_player_game();
-            }
+// 閃爍結束後的處理
+static void finish_flicker_snake(int player)
+{
+    snake_hidden[player] = TRUE;
+    flicker_done[player] = TRUE;
+
+    // 檢查是否需要結束遊戲
+    if (current_mode == MODE_MULTI) {
+        // 網路對戰等兩端輸入都確認 (回溯模式下死亡不會再被修正) 才結算
+        if (game_all_dead(&game) && flicker_done[0] && flicker_done[1]
+            && (!net_enabled || lockstep.phase == LOCKSTEP_OVER)) {
+            end_two_player_game();
         }
-        else if (current_mode == MODE_SINGLE) { // 單人模式處理
-            game_over = TRUE;
+    }
+    else if (current_mode == MODE_SINGLE) { // 單人模式處理
+        game_over = TRUE;
+        update_alloc_phase();
 
-            if (single_timer_id) {
-                g_source_remove(single_timer_id);
-                single_timer_id = 0;
-            }
+        game_timer_stop(&single_timer);
+
+        gtk_widget_queue_draw(canvas_single);
+        show_game_over_screen_single();
+    }
+}
+
+//==============================================================
+// [ 效能追蹤 ]
+//==============================================================
+// 寫出效能追蹤 (覆寫同一個檔案，可在 chrome://tracing 或 ui.perfetto.dev 開啟)
+static void dump_trace(void)
+{
+    if (!trace_path) return;
+    long count = game_trace_dump(trace_path);
+    if (count < 0) {
+        g_printerr("Failed to write trace: %s\n", trace_path);
+        return;
+    }
+    g_print("trace: %ld events written to %s\n", count, trace_path);
+}
 
-            gtk_widget_queue_draw(canvas_single);
-            show_game_over_screen_single();
+//==============================================================
+// [ 定時器排程 ]
+//==============================================================
+// 記錄一次喚醒，每滿一秒更新一次每秒喚醒次數
+static void note_wakeup(void)
+{
+    gint64 now = g_get_monotonic_time();
+    if (wakeup_window_start == 0) {
+        wakeup_window_start = now;
+    }
+    wakeup_total++;
+    wakeup_window_count++;
+
+    gint64 elapsed = now - wakeup_window_start;
+    if (elapsed >= G_USEC_PER_SEC) {
+        wakeups_per_second = (double)wakeup_window_count * G_USEC_PER_SEC / (double)elapsed;
+        wakeup_window_count = 0;
+        wakeup_window_start = now;
+        if (wakeup_stats_enabled) {
+            g_print("wakeups/s: %.1f (total %" G_GUINT64_FORMAT ")\n", wakeups_per_second, wakeup_total);
         }
+    }
+}
 
-        return FALSE; // 結束定時器
+// 取得每秒喚醒次數；閒置超過一秒時以目前區間計算，讓數值隨閒置降為0
+static double get_wakeups_per_second(void)
+{
+    if (wakeup_window_start == 0) return 0.0;
+    gint64 elapsed = g_get_monotonic_time() - wakeup_window_start;
+    if (elapsed >= G_USEC_PER_SEC) {
+        return (double)wakeup_window_count * G_USEC_PER_SEC / (double)elapsed;
     }
+    return wakeups_per_second;
+}
 
-    return TRUE; // 繼續定時器
+// 定時器在效能追蹤中的名稱與附加數值 (倒數值或玩家編號)
+static const char* game_timer_trace_name(const GameTimer* timer, int32_t* arg)
+{
+    if (timer == &countdown_timer) {
+        *arg = countdown;
+        return "countdown";
+    }
+    if (timer == &net_timer) {
+        *arg = (int32_t)lockstep.frame;
+        return "net";
+    }
+    if (timer == &spectate_timer) {
+        *arg = (int32_t)spectate_view.frame;
+        return "spectate";
+    }
+    *arg = (timer == &player2_timer) ? 1 : 0;
+    return "tick";
+}
+
+// 所有遊戲定時器共用的回調，負責統計喚醒與恢復後的重新排程
+static gboolean game_timer_fire(gpointer data)
+{
+    GameTimer* timer = (GameTimer*)data;
+    guint id = timer->id;
+    gboolean resuming = timer->resuming;
+    timer->resuming = FALSE;
+
+    note_wakeup();
+    int32_t trace_arg;
+    const char* trace_name = game_timer_trace_name(timer, &trace_arg);
+    int64_t trace_start = game_trace_begin();
+    gint64 fired_at = g_get_monotonic_time();
+    gint64 lateness = fired_at - timer->deadline; // 更新函式可能重新排程，先計算
+    gboolean simulating = timer != &countdown_timer;
+    GameAllocSubsystem alloc_scope = game_alloc_enter(simulating ? ALLOC_SUB_SIM : ALLOC_SUB_UI);
+    if (simulating) game_alloc_tick_begin();
+    gboolean again = timer->func(NULL);
+    uint64_t tick_allocs = simulating ? game_alloc_tick_end() : 0;
+    game_alloc_leave(alloc_scope);
+    game_trace_end("timer", trace_name, trace_start, trace_arg);
+
+    // 這次移動觸發的音效在定時器之外建立管線
+    if (pending_sounds != 0 && pending_sounds_source == 0)
+        pending_sounds_source = g_idle_add(play_queued_sounds, NULL);
+
+    // 移動之中的配置 (遊戲迴圈應為零配置)，只立即列出前幾次，其餘計入統計
+    if (tick_allocs > 0 && alloc_flagged_ticks < ALLOC_REPORT_LIMIT) {
+        alloc_flagged_ticks++;
+        g_printerr("alloc: %llu allocations inside %s timer (arg %d)%s\n",
+            (unsigned long long)tick_allocs, trace_name, trace_arg,
+            alloc_flagged_ticks == ALLOC_REPORT_LIMIT ? ", further ticks are only counted" : "");
+    }
+
+    // 移動定時器 (本機或網路) 的執行時間，以及與預定時間 (依目前的移動間隔排程) 的差距
+    if (timer != &countdown_timer && timer != &spectate_timer) {
+        game_perf_push(&perf, PERF_TICK, (float)(g_get_monotonic_time() - fired_at) / 1000.0f);
+        game_perf_push(&perf, PERF_TICK_JITTER, (float)(lateness < 0 ? -lateness : lateness) / 1000.0f);
+    }
+
+    // 更新函式自行停止或重新啟動了定時器，這個來源已不再使用
+    if (timer->id != id) return G_SOURCE_REMOVE;
+    if (!again) {
+        timer->id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    timer->deadline = now + (gint64)timer->interval * 1000;
+    if (resuming) {
+        // 恢復後的單次觸發已完成，改回原本的週期
+        int64_t rearm_start = game_trace_begin();
+        timer->id = g_timeout_add(timer->interval, game_timer_fire, timer);
+        game_trace_end("timer", "rearm", rearm_start, (int32_t)timer->interval);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+// 啟動遊戲定時器
+static void game_timer_start(GameTimer* timer, guint interval, GSourceFunc func)
+{
+    int64_t trace_start = game_trace_begin();
+    game_timer_stop(timer);
+    timer->interval = interval;
+    timer->func = func;
+    timer->deadline = g_get_monotonic_time() + (gint64)interval * 1000;
+    timer->id = g_timeout_add(interval, game_timer_fire, timer);
+    game_trace_end("timer", "rearm", trace_start, (int32_t)interval);
+}
+
+// 停止遊戲定時器 (同時清除暫停狀態)
+static void game_timer_stop(GameTimer* timer)
+{
+    if (timer->id) {
+        g_source_remove(timer->id);
+        timer->id = 0;
+    }
+    timer->suspended = FALSE;
+    timer->resuming = FALSE;
+}
+
+// 暫停單一定時器，記錄剩餘時間
+static void game_timer_suspend(GameTimer* timer)
+{
+    if (!timer->id) return;
+    gint64 remaining = timer->deadline - g_get_monotonic_time();
+    timer->remaining = remaining > 0 ? remaining : 0;
+    timer->suspended = TRUE;
+    g_source_remove(timer->id);
+    timer->id = 0;
+}
+
+// 恢復單一定時器，先以剩餘時間觸發一次
+static void game_timer_resume(GameTimer* timer)
+{
+    if (!timer->suspended) return;
+    timer->suspended = FALSE;
+    timer->resuming = TRUE;
+    timer->deadline = g_get_monotonic_time() + timer->remaining;
+    timer->id = g_timeout_add((guint)((timer->remaining + 999) / 1000), game_timer_fire, timer);
+}
+
+// 暫停所有遊戲定時器
+static void suspend_game_timers(void)
+{
+    paused_at = g_get_monotonic_time();
+    game_timer_suspend(&countdown_timer);
+    game_timer_suspend(&single_timer);
+    game_timer_suspend(&player1_timer);
+    game_timer_suspend(&player2_timer);
+}
+
+// 恢復所有遊戲定時器
+static void resume_game_timers(void)
+{
+    // 暫停期間沒有定時器觸發，此時的數值應趨近於0
+    if (wakeup_stats_enabled) {
+        g_print("wakeups/s while paused: %.2f\n", get_wakeups_per_second());
+    }
+
+    // 暫停的時間計入本局的統計 (倒數中的暫停不算倒數時間)
+    if (paused_at) {
+        gint64 paused_us = g_get_monotonic_time() - paused_at;
+        paused_at = 0;
+        if (!game_started) countdown_paused_us += paused_us;
+        if (metrics_game.mode) game_metrics_game_pause(&metrics_game, (long)(paused_us / 1000));
+    }
+
+    game_timer_resume(&countdown_timer);
+    game_timer_resume(&single_timer);
+    game_timer_resume(&player1_timer);
+    game_timer_resume(&player2_timer);
+}
+
+// 倒數結束後才啟動移動定時器，倒數期間不會空轉
+static void start_game_timers(void)
+{
+    if (current_mode == MODE_SINGLE && endless_enabled) {
+        game_timer_start(&single_timer, world.interval, update_game_endless);
+    }
+    else if (current_mode == MODE_SINGLE) {
+        game_timer_start(&single_timer, game.players[0].interval, update_game_single);
+    }
+    else if (current_mode == MODE_MULTI && !net_enabled) { // 網路對戰由 net_timer 推進
+        game_timer_start(&player1_timer, game.players[0].interval, update_player1);
+        game_timer_start(&player2_timer, game.players[1].interval, update_player2);
+    }
 }
 
 //==============================================================
-// [ 倒數機制 ] (500ms interval)
+// [ 倒數機制 ] (940ms interval)
 //==============================================================
 // 啟動倒數計時
 static void start_countdown(void)
@@ -605,26 +1022,21 @@ static void start_countdown(void)
     countdown = 3;            // 設定倒數初始值為3
     show_go = FALSE;          // 不顯示「開始」字樣
     game_started = FALSE;     // 遊戲尚未開始
-    if (countdown_timer_id) {
-        g_source_remove(countdown_timer_id); // 移除之前的定時器
-        countdown_timer_id = 0;
-    }
+    update_alloc_phase();
 
     // 播放倒數音效，設定不循環播放，音量為1.0
-    countdown_music = play_sound_effect("Musics/countdown_3_to_1.mp3", FALSE, 1.0); // 不循環
+    countdown_music = play_sound_effect(SOUND_COUNTDOWN, FALSE, 1.0); // 不循環
 
-    // 每940毫秒呼叫一次倒數計時器
-    countdown_timer_id = g_timeout_add(940, countdown_tick, NULL);
+    // 每940毫秒呼叫一次倒數計時器 (會先移除之前的定時器)
+    countdown_started_at = g_get_monotonic_time();
+    countdown_paused_us = 0;
+    game_timer_start(&countdown_timer, 940, countdown_tick);
 }
 
 // 倒數計時的回調函式
 static gboolean countdown_tick(gpointer data)
 {
-    if (paused) {
-        // 如果遊戲暫停，停止倒數計時
-        return TRUE; // 繼續定時器，但不執行任何操作
-    }
-
+    // 暫停時倒數定時器已被暫停，不會觸發此函式
     if (countdown > 0) {
         countdown--; // 減少倒數值
     }
@@ -633,13 +1045,16 @@ static gboolean countdown_tick(gpointer data)
     }
     else {
         game_started = TRUE; // 遊戲開始
-        countdown_timer_id = 0;
-
-        // 播放遊戲背景音樂 (循環，音量一半)
-        if (current_mode == MODE_SINGLE || current_mode == MODE_MULTI) {
-            game_background_music = play_sound_effect("Musics/game_background.mp3", TRUE, 0.5); // 循環且音量一半
+        update_alloc_phase();
+        prepare_bots();
+        if (metrics_game.mode) {
+            gint64 countdown_us = g_get_monotonic_time() - countdown_started_at - countdown_paused_us;
+            game_metrics_game_countdown(&metrics_game, (long)(countdown_us / 1000));
         }
 
+        // 啟動蛇的移動定時器
+        start_game_timers();
+
         return FALSE; // 停止定時器
     }
 
@@ -660,80 +1075,59 @@ static gboolean countdown_tick(gpointer data)
 //==============================================================
 // [共同 / 清理 / 回主選單 / 離開 / 暫停]
 //==============================================================
-// 清理遊戲資料，包括蛇、障礙物、分數等
-static void clear_game_data(void)
+// 依目前的模式與遊戲狀態更新記憶體配置統計的遊戲階段
+static void update_alloc_phase(void)
 {
-    // 釋放「單人」蛇的記憶體
-    if (snake_single) {
-        for (GList* iter = snake_single; iter; iter = iter->next) {
-            free(iter->data);
-        }
-        g_list_free(snake_single);
-        snake_single = NULL;
+    GameAllocPhase phase = ALLOC_PHASE_MENU;
+    if (current_mode == MODE_SINGLE || current_mode == MODE_MULTI) {
+        phase = game_over ? ALLOC_PHASE_GAME_OVER : (game_started ? ALLOC_PHASE_PLAYING : ALLOC_PHASE_COUNTDOWN);
     }
-    // 釋放「雙人」蛇1的記憶體
-    if (snake1) {
-        for (GList* iter = snake1; iter; iter = iter->next) {
-            free(iter->data);
-        }
-        g_list_free(snake1);
-        snake1 = NULL;
+    game_alloc_set_phase(phase);
+}
+
+// 預先配置目前接手控制的電腦玩家 (單人與網路模式為自動駕駛，本機雙人為電腦對手)
+static void prepare_bots(void)
+{
+    if (!autopilot_enabled || spectate_enabled) return;
+    if (current_mode == MODE_SINGLE || (current_mode == MODE_MULTI && net_enabled)) {
+        game_bot_prepare(&autopilot, &game);
     }
-    // 釋放「雙人」蛇2的記憶體
-    if (snake2) {
-        for (GList* iter = snake2; iter; iter = iter->next) {
-            free(iter->data);
-        }
-        g_list_free(snake2);
-        snake2 = NULL;
+    else if (current_mode == MODE_MULTI) {
+        game_bot_prepare(&opponent, &game);
     }
-    // 釋放障礙物的記憶體
-    if (obstacles) {
-        for (GList* iter = obstacles; iter; iter = iter->next) {
-            free(iter->data);
+}
+
+// 清理遊戲資料，包括蛇、障礙物、分數等
+static void clear_game_data(void)
+{
+    // 停止閃爍定時器 (閃爍資料屬於本局的記憶體區塊)
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (flicker_timer_ids[i]) {
+            g_source_remove(flicker_timer_ids[i]);
+            flicker_timer_ids[i] = 0;
         }
-        g_list_free(obstacles);
-        obstacles = NULL;
+        snake_hidden[i] = FALSE;
+        flicker_done[i] = FALSE;
     }
+    game_latency_clear_inflight(&input_latency); // 上一局未呈現的轉向不再計算
 
-    // 重置分數
-    score_single = 0;
-    score1 = 0; score2 = 0;
-
-    // 清空死亡/生存時間
-    dead_time_player1 = 0;
-    dead_time_player2 = 0;
-    start_time_multi = 0;
-
-    // 重置移動方向
-    direction_single = GDK_KEY_Right;
-    next_direction_single = GDK_KEY_Right;
-    direction1 = GDK_KEY_d;
-    next_direction1 = GDK_KEY_d;
-    direction2 = GDK_KEY_Left;
-    next_direction2 = GDK_KEY_Left;
+    // 輸出本局的記憶體使用統計
+    if (arena_stats_enabled && game.arena.allocs > 0) {
+        g_print("arena: %lu allocs, %zu/%zu bytes used (high water %zu), %lu resets, %lu failures\n",
+            game.arena.allocs, game.arena.used, game.arena.capacity,
+            game.arena.high_water, game.arena.resets, game.arena.failures);
+    }
 
-    // 重置時間間隔
-    current_interval_single = 100; // 單人模式的移動間隔
-    current_interval_player1 = 100; // 玩家1的移動間隔
-    current_interval_player2 = 100; // 玩家2的移動間隔
+    // 一次釋放本局的蛇、障礙物並重置分數、方向與移動間隔
+    game_clear(&game);
 
     // 移除所有定時器
-    if (single_timer_id) { g_source_remove(single_timer_id);    single_timer_id = 0; }
-    if (player1_timer_id) { g_source_remove(player1_timer_id);   player1_timer_id = 0; }
-    if (player2_timer_id) { g_source_remove(player2_timer_id);   player2_timer_id = 0; }
-    if (countdown_timer_id) { g_source_remove(countdown_timer_id); countdown_timer_id = 0; }
-
-    // 重置單人模式蛇的生存狀態
-    player_single_alive = TRUE;
-
-    // 停止遊戲背景音樂
-    if (game_background_music) {
-        gst_element_set_state(game_background_music->pipeline, GST_STATE_NULL);
-        gst_object_unref(game_background_music->pipeline);
-        free(game_background_music);
-        game_background_music = NULL;
-    }
+    game_timer_stop(&single_timer);
+    game_timer_stop(&player1_timer);
+    game_timer_stop(&player2_timer);
+    game_timer_stop(&countdown_timer);
+    game_timer_stop(&net_timer);
+    game_timer_stop(&spectate_timer);
 
     // 停止倒數音效
     if (countdown_music) {
@@ -745,6 +1139,7 @@ static void clear_game_data(void)
 
     // 重置狀態變數
     game_started = FALSE;
+    paused_at = 0;
     countdown = 3;
     show_go = FALSE;
 }
@@ -753,16 +1148,15 @@ static void clear_game_data(void)
 static void on_back_to_menu_clicked(GtkButton* button, gpointer user_data)
 {
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 清理遊戲資料
     clear_game_data();
     game_over = FALSE;
     paused = FALSE;
     current_mode = MODE_MENU;
-    player1_alive = TRUE;
-    player2_alive = TRUE;
-    winner = 0;
+    endless_enabled = FALSE;
+    update_alloc_phase();
 
     // 如果暫停對話框存在，則銷毀它
     if (pause_dialog) {
@@ -770,22 +1164,11 @@ static void on_back_to_menu_clicked(GtkButton* button, gpointer user_data)
         pause_dialog = NULL;
     }
 
-    // 從GtkStack中移除各種遊戲相關的視圖
+    // 遊戲與結束畫面保留在GtkStack中，下次直接重複使用
     GtkStack* stack_ptr = GTK_STACK(stack);
-    GtkWidget* game_single = gtk_stack_get_child_by_name(stack_ptr, "game_single");
-    if (game_single) gtk_stack_remove(stack_ptr, game_single);
 
-    GtkWidget* game_multi = gtk_stack_get_child_by_name(stack_ptr, "game_multi");
-    if (game_multi) gtk_stack_remove(stack_ptr, game_multi);
-
-    GtkWidget* game_over_single = gtk_stack_get_child_by_name(stack_ptr, "game_over_single");
-    if (game_over_single) gtk_stack_remove(stack_ptr, game_over_single);
-
-    GtkWidget* game_over_multi = gtk_stack_get_child_by_name(stack_ptr, "game_over_multi");
-    if (game_over_multi) gtk_stack_remove(stack_ptr, game_over_multi);
-
-    // 播放主選單背景音樂 (循環，音量一半)
-    main_menu_music = play_sound_effect("Musics/main_menu_background.mp3", TRUE, 0.5); // 循環且音量一半
+    // 播放主選單背景音樂 (循環，音量一半)
+    main_menu_music = play_sound_effect(SOUND_MAIN_MENU_BACKGROUND, TRUE, 0.5); // 循環且音量一半
 
     // 顯示主選單視圖
     gtk_stack_set_visible_child_name(stack_ptr, "main_menu");
@@ -806,7 +1189,7 @@ static void stop_main_menu_music(void)
 static void on_quit_clicked(GtkButton* button, gpointer user_data)
 {
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 獲取應用程序並退出
     GtkApplication* app = GTK_APPLICATION(gtk_window_get_application(GTK_WINDOW(window)));
@@ -818,21 +1201,13 @@ static void create_pause_dialog(void)
 {
     if (pause_dialog) return; // 如果已經存在暫停對話框，則不重複創建
 
-    // 暫停遊戲背景音樂
-    if (game_background_music) {
-        gst_element_set_state(game_background_music->pipeline, GST_STATE_PAUSED);
-    }
-
     // 暫停倒數音效
     if (countdown_music) {
         gst_element_set_state(countdown_music->pipeline, GST_STATE_PAUSED);
     }
 
-    // 暫停倒數計時器
-    if (countdown_timer_id) {
-        g_source_remove(countdown_timer_id);
-        countdown_timer_id = 0;
-    }
+    // 暫停倒數與移動定時器，暫停期間不再喚醒
+    suspend_game_timers();
 
     // 創建暫停對話框
     pause_dialog = gtk_window_new();
@@ -863,7 +1238,7 @@ static void create_pause_dialog(void)
     g_signal_connect(back_btn, "clicked", G_CALLBACK(on_back_to_menu_clicked), NULL);
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 顯示暫停對話框
     gtk_window_present(GTK_WINDOW(pause_dialog));
@@ -873,7 +1248,7 @@ static void create_pause_dialog(void)
 static void on_resume_game(GtkButton* btn, gpointer user_data)
 {
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     paused = FALSE;
     if (pause_dialog) {
@@ -881,262 +1256,283 @@ static void on_resume_game(GtkButton* btn, gpointer user_data)
         pause_dialog = NULL;
     }
 
-    // 恢復遊戲背景音樂
-    if (game_background_music) {
-        gst_element_set_state(game_background_music->pipeline, GST_STATE_PLAYING);
-    }
-
     // 恢復倒數音效
     if (countdown_music) {
         gst_element_set_state(countdown_music->pipeline, GST_STATE_PLAYING);
     }
 
-    // 恢復倒數計時器 (如果遊戲尚未開始)
-    if (!game_started && (countdown > 0 || show_go == FALSE)) {
-        countdown_timer_id = g_timeout_add(500, countdown_tick, NULL);
-    }
+    // 以暫停前的剩餘時間恢復倒數與移動定時器
+    resume_game_timers();
 }
 
 //==============================================================
-// [障礙物]
+// [ 快速存檔 / 讀檔 ]
 //==============================================================
-// 檢查障礙物生成的位置是否有效，不與排除的位置重疊
-static gboolean is_obstacle_valid(int x, int y, int w, int h, GList* excluded_positions)
-{
-    // 與蛇初始位置不要太近
-    for (GList* iter = excluded_positions; iter; iter = iter->next) {
-        Point* p = (Point*)iter->data;
-        float obs_cx = x + (float)w / 2;
-        float obs_cy = y + (float)h / 2;
-        float dx = obs_cx - p->x;
-        float dy = obs_cy - p->y;
-        float dist2 = dx * dx + dy * dy;
-        if (dist2 < 16.0f) { // 距離平方小於16，表示距離小於4
-            return FALSE;
-        }
-    }
-    return TRUE;
+// 取得定時器距離下一次觸發的剩餘時間 (微秒)，未啟動時返回-1
+static gint64 game_timer_remaining(const GameTimer* timer)
+{
+    if (timer->suspended) return timer->remaining;
+    if (!timer->id) return -1;
+    gint64 remaining = timer->deadline - g_get_monotonic_time();
+    return remaining > 0 ? remaining : 0;
 }
 
-// 分區生成障礙物，每個區域生成一定數量的障礙物
-static void generate_obstacles(GList* initial_positions)
+// 以存檔時的剩餘時間重新排程定時器，觸發一次後恢復為原本的間隔
+static void game_timer_restore(GameTimer* timer, guint interval, GSourceFunc func, gint64 remaining)
 {
-    // 不重複呼叫 srand
-    // srand 已在 main 和其他地方呼叫過
-    // srand((unsigned)time(NULL));
+    game_timer_stop(timer);
+    if (remaining < 0) return;
+    timer->interval = interval;
+    timer->func = func;
+    timer->remaining = remaining;
+    timer->suspended = TRUE;
+    game_timer_resume(timer);
+}
 
-    int obstacles_per_zone = 2; // 每個區域生成的障礙物數量
-    int zone_count = 4;         // 總區域數量
+// 快照檔案的位置 (使用者資料目錄)
+static gchar* quick_save_path(void)
+{
+    return g_build_filename(g_get_user_data_dir(), "SnakeHero", "quicksave.snap", NULL);
+}
 
-    for (int zone = 0; zone < zone_count; zone++) {
-        int x_min, x_max, y_min, y_max;
-        switch (zone) {
-        case 0:
-            x_min = 0;  x_max = GRID_WIDTH / 2 - 1;  y_min = 0;   y_max = GRID_HEIGHT / 2 - 1;
-            break;
-        case 1:
-            x_min = GRID_WIDTH / 2; x_max = GRID_WIDTH - 1;  y_min = 0;   y_max = GRID_HEIGHT / 2 - 1;
-            break;
-        case 2:
-            x_min = 0;  x_max = GRID_WIDTH / 2 - 1;  y_min = GRID_HEIGHT / 2;  y_max = GRID_HEIGHT - 1;
-            break;
-        default:
-            x_min = GRID_WIDTH / 2; x_max = GRID_WIDTH - 1;  y_min = GRID_HEIGHT / 2;  y_max = GRID_HEIGHT - 1;
-            break;
-        }
+// 快速存檔
+static void quick_save(void)
+{
+    if ((current_mode != MODE_SINGLE && current_mode != MODE_MULTI) || game_over) return;
+    // 網路對戰中讀檔會使兩端不一致，觀戰的局面屬於伺服器，不論目前的模式都停用
+    if (net_enabled || spectate_enabled) return;
+    // 無盡模式的世界不在快照格式之內
+    if (endless_enabled) return;
+
+    // 死亡閃爍屬於介面效果，不在快照內，閃爍期間不存檔
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (flicker_timer_ids[i]) return;
+    }
+
+    GameSession session = { 0 };
+    session.mode = current_mode;
+    session.countdown = countdown;
+    session.show_go = show_go;
+    session.started = game_started;
+    session.countdown_remaining_us = game_timer_remaining(&countdown_timer);
+    if (current_mode == MODE_SINGLE) {
+        session.step_remaining_us[0] = game_timer_remaining(&single_timer);
+        session.step_remaining_us[1] = -1;
+    }
+    else {
+        session.step_remaining_us[0] = game_timer_remaining(&player1_timer);
+        session.step_remaining_us[1] = game_timer_remaining(&player2_timer);
+    }
 
-        for (int i = 0; i < obstacles_per_zone; i++) {
-            int attempts = 0;
-            int max_attempts = 500;
-            while (attempts < max_attempts) {
-                int w = rand() % 3 + 1; // 隨機寬度 1~3
-                int h = rand() % 3 + 1; // 隨機高度 1~3
-                if ((x_max - x_min + 1) < w || (y_max - y_min + 1) < h) {
-                    attempts++;
-                    continue;
-                }
-                int rx = x_min + rand() % ((x_max - x_min + 1) - w); // 隨機X位置
-                int ry = y_min + rand() % ((y_max - y_min + 1) - h); // 隨機Y位置
-
-                // 檢查障礙物位置是否有效
-                if (is_obstacle_valid(rx, ry, w, h, initial_positions)) {
-                    Obstacle* obs = (Obstacle*)malloc(sizeof(Obstacle));
-                    obs->x = rx;
-                    obs->y = ry;
-                    obs->width = w;
-                    obs->height = h;
-                    obstacles = g_list_append(obstacles, obs); // 添加到障礙物列表
-                    break;
-                }
-                attempts++;
-            }
-        }
+    gint64 start = g_get_monotonic_time();
+    gsize size = game_snapshot_size(&game);
+    gpointer buffer = g_malloc(size);
+    game_snapshot_write(&game, &session, buffer, size);
+
+    // 先寫入暫存檔再改名，存檔中途結束也不會損壞舊的快照
+    gchar* path = quick_save_path();
+    gchar* dir = g_path_get_dirname(path);
+    g_mkdir_with_parents(dir, 0755);
+    GError* error = NULL;
+    if (!g_file_set_contents(path, buffer, (gssize)size, &error)) {
+        g_printerr("Quick save failed: %s\n", error->message);
+        g_error_free(error);
+    }
+    else {
+        g_print("quick save: %" G_GSIZE_FORMAT " bytes in %.3f ms\n",
+            size, (g_get_monotonic_time() - start) / 1000.0);
     }
+    g_free(dir);
+    g_free(path);
+    g_free(buffer);
 }
 
-//==============================================================
-// [隨機方向生成函式]
-//==============================================================
-// 隨機選擇一個方向鍵，返回對應的GDK_KEY
-static int get_random_direction(void)
+// 快速讀檔 (主選單也可以讀檔，延續上次結束前的遊戲)
+static void quick_load(void)
 {
-    int directions[] = { GDK_KEY_Up, GDK_KEY_Down, GDK_KEY_Left, GDK_KEY_Right };
-    int index = rand() % 4; // 隨機索引
-    return directions[index];
-}
+    if (current_mode != MODE_MENU && current_mode != MODE_SINGLE && current_mode != MODE_MULTI) return;
+    if (paused) return;
+    // 設置 SNAKE_NET 時 (包含在主選單) 讀入的局面不會經過同步，兩端會不一致；
+    // 觀戰時讀入的本機局面會被串流的局面蓋住
+    if (net_enabled || spectate_enabled) return;
+    // 有邊界的單人快照不能載入無盡模式
+    if (endless_enabled) return;
+
+    gint64 start = g_get_monotonic_time();
+    gchar* path = quick_save_path();
+    GError* error = NULL;
+    GMappedFile* mapped = g_mapped_file_new(path, FALSE, &error);
+    g_free(path);
+    if (!mapped) {
+        g_printerr("Quick load failed: %s\n", error->message);
+        g_error_free(error);
+        return;
+    }
+
+    const void* data = g_mapped_file_get_contents(mapped);
+    gsize size = g_mapped_file_get_length(mapped);
+    const GameSnapshotHeader* header = game_snapshot_validate(data, size);
+
+    // 繪圖區域固定為 GRID_WIDTH x GRID_HEIGHT，模式必須與玩家數相符
+    if (!header || header->width != GRID_WIDTH || header->height != GRID_HEIGHT
+        || !((header->session.mode == MODE_SINGLE && header->player_count == 1)
+            || (header->session.mode == MODE_MULTI && header->player_count == 2)))
+    {
+        g_printerr("Quick load failed: invalid snapshot\n");
+        g_mapped_file_unref(mapped);
+        return;
+    }
 
-//==============================================================
-// [ 單人模式 ]
-//==============================================================
-// 初始化單人遊戲
-static void init_single_game(void)
-{
-    clear_game_data(); // 清理之前的遊戲資料
+    // 結束目前的遊戲 (或主選單音樂) 後載入快照
+    stop_main_menu_music();
+    clear_game_data();
 
-    // 蛇初始位置設置在網格中心
-    Point* h = (Point*)malloc(sizeof(Point));
-    h->x = GRID_WIDTH / 2;
-    h->y = GRID_HEIGHT / 2;
-    snake_single = g_list_append(snake_single, h); // 添加到蛇的鏈表
+    GameSession session;
+    gboolean loaded = game_snapshot_read(&game, &session, data, size);
+    g_mapped_file_unref(mapped);
+    if (!loaded) {
+        g_printerr("Quick load failed: invalid snapshot\n");
+        on_back_to_menu_clicked(NULL, NULL);
+        return;
+    }
 
-    // 隨機初始方向
-    direction_single = get_random_direction();
-    next_direction_single = direction_single;
-    score_single = 0;
+    current_mode = (GameMode)session.mode;
+    single_recordable = FALSE; // 讀檔後的對局不列入最高分紀錄
+    begin_game_metrics(current_mode == MODE_SINGLE ? "single_loaded" : "multi_loaded", 0);
+    game_bot_reset(&autopilot);
+    game_bot_reset(&opponent);
     game_over = FALSE;
     paused = FALSE;
+    countdown = session.countdown;
+    show_go = session.show_go;
+    game_started = session.started;
+    update_alloc_phase();
+    prepare_bots();
+
+    // 存檔時已死亡的蛇，閃爍早已結束
+    for (int i = 0; i < game.player_count; i++) {
+        if (!game.players[i].alive) {
+            snake_hidden[i] = TRUE;
+            flicker_done[i] = TRUE;
+        }
+    }
 
-    // 收集初始位置，避免障礙物生成在蛇附近
-    GList* initial_positions = NULL;
-    initial_positions = g_list_append(initial_positions, h);
+    // 以存檔時的剩餘時間重新排程倒數與移動定時器
+    game_timer_restore(&countdown_timer, 940, countdown_tick, session.countdown_remaining_us);
+    if (current_mode == MODE_SINGLE) {
+        game_timer_restore(&single_timer, game.players[0].interval, update_game_single,
+            session.step_remaining_us[0]);
+    }
+    else {
+        game_timer_restore(&player1_timer, game.players[0].interval, update_player1,
+            session.step_remaining_us[0]);
+        game_timer_restore(&player2_timer, game.players[1].interval, update_player2,
+            session.step_remaining_us[1]);
+    }
 
-    generate_obstacles(initial_positions); // 生成障礙物
-    generate_food_single();               // 生成食物
-    start_countdown();                    // 開始倒數計時
+    GtkWidget* canvas = (current_mode == MODE_SINGLE) ? canvas_single : canvas_multi;
+    gtk_widget_queue_draw(canvas);
+    gtk_stack_set_visible_child_name(GTK_STACK(stack),
+        current_mode == MODE_SINGLE ? "game_single" : "game_multi");
 
-    // 設置遊戲更新的定時器
-    single_timer_id = g_timeout_add(current_interval_single, update_game_single, NULL);
-    g_list_free(initial_positions); // 釋放初始位置鏈表
+    g_print("quick load: %" G_GSIZE_FORMAT " bytes in %.3f ms\n",
+        size, (g_get_monotonic_time() - start) / 1000.0);
 }
 
-// 生成單人模式下的食物
-static void generate_food_single(void)
+//==============================================================
+// [ 單人模式 ]
+//==============================================================
+// 初始化單人遊戲
+static void init_single_game(void)
 {
-    gboolean valid = FALSE;
-    while (!valid) {
-        food_single.x = rand() % GRID_WIDTH;  // 隨機X位置
-        food_single.y = rand() % GRID_HEIGHT; // 隨機Y位置
-        valid = TRUE;
+    clear_game_data(); // 清理之前的遊戲資料
 
-        // 檢查食物是否與蛇重疊
-        for (GList* iter = snake_single; iter; iter = iter->next) {
-            Point* seg = (Point*)iter->data;
-            if (seg->x == food_single.x && seg->y == food_single.y) {
-                valid = FALSE;
-                break;
-            }
-        }
-        // 檢查食物是否與障礙物重疊
-        if (valid) {
-            for (GList* iter = obstacles; iter; iter = iter->next) {
-                Obstacle* obs = (Obstacle*)iter->data;
-                if (food_single.x >= obs->x && food_single.x < obs->x + obs->width &&
-                    food_single.y >= obs->y && food_single.y < obs->y + obs->height) {
-                    valid = FALSE;
-                    break;
-                }
-            }
-        }
-    }
-}
+    // 每局使用新的種子 (地圖每局不同，成績中記錄種子以便重現；最佳成績以網格尺寸分組)
+    single_seed = (uint64_t)g_get_real_time() ^ game.rng_state;
+    game_seed(&game, single_seed);
+    single_recordable = !autopilot_enabled && !endless_enabled; // 排行榜以網格尺寸分組，無盡模式不列入
 
-// 檢查單人模式下的碰撞情況，包括自撞和撞到障礙物
-static gboolean check_collision_single(Point* head)
-{
-    // 自撞
-    for (GList* iter = snake_single->next; iter; iter = iter->next) {
-        Point* seg = (Point*)iter->data;
-        if (seg->x == head->x && seg->y == head->y) return TRUE;
+    // 設置蛇的初始位置與隨機方向，並生成障礙物和食物
+    game_new_single(&game);
+    if (endless_enabled) {
+        // 無盡模式的局面在 world 中，出生點周圍的區塊在此生成；統計摘要以 GameState 計算，不記錄
+        game_world_new(&world, single_seed);
+        metrics_game.mode = NULL;
     }
-    // 撞障礙物
-    for (GList* iter = obstacles; iter; iter = iter->next) {
-        Obstacle* obs = (Obstacle*)iter->data;
-        if (head->x >= obs->x && head->x < obs->x + obs->width &&
-            head->y >= obs->y && head->y < obs->y + obs->height) {
-            return TRUE;
-        }
+    else {
+        begin_game_metrics("single", single_seed);
     }
-    return FALSE;
+    game_bot_reset(&autopilot);
+    game_bot_reset(&opponent);
+    game_over = FALSE;
+    paused = FALSE;
+
+    start_countdown();                    // 開始倒數計時，倒數結束後才啟動移動定時器
 }
 
 // 單人模式下蛇死亡的處理函式
 static void kill_player_single(void)
 {
     // 播放蛇死亡音效
-    play_sound_effect("Musics/snake_die.mp3", FALSE, 1.0); // 不循環
+    queue_sound_effect(SOUND_SNAKE_DIE);
 
     // 啟動蛇的閃爍效果
-    start_flicker_snake(&snake_single, &player_single_alive, canvas_single);
+    start_flicker_snake(0, canvas_single);
 }
 
 // 更新單人遊戲狀態的定時器回調函式
 static gboolean update_game_single(gpointer data)
 {
-    // 如果當前模式不是單人模式，或者遊戲已結束、暫停，則不進行更新
-    if (current_mode != MODE_SINGLE || game_over || paused)
-        return G_SOURCE_CONTINUE;
-    if (!game_started)
-        return G_SOURCE_CONTINUE;
-
-    // 更新方向
-    direction_single = next_direction_single;
-
-    // 計算新的蛇頭位置
-    Point* head = (Point*)snake_single->data;
-    if (!head) { // 確保蛇頭存在
-        return G_SOURCE_CONTINUE;
-    }
-    Point nh = { head->x, head->y };
-    switch (direction_single) {
-    case GDK_KEY_Up:    nh.y--; break;
-    case GDK_KEY_Down:  nh.y++; break;
-    case GDK_KEY_Left:  nh.x--; break;
-    case GDK_KEY_Right: nh.x++; break;
-    }
-    // 處理邊界循環
-    if (nh.x < 0) nh.x = GRID_WIDTH - 1;
-    else if (nh.x >= GRID_WIDTH) nh.x = 0;
-    if (nh.y < 0) nh.y = GRID_HEIGHT - 1;
-    else if (nh.y >= GRID_HEIGHT) nh.y = 0;
-
-    // 檢查碰撞
-    if (check_collision_single(&nh)) {
+    // 沒有需要更新的內容時停止定時器 (暫停時定時器已被暫停，不會進入此處)
+    if (current_mode != MODE_SINGLE || game_over || paused || !game_started)
+        return G_SOURCE_REMOVE;
+
+    // 自動駕駛開啟時，由距離場決定這一步的方向
+    if (autopilot_enabled) {
+        int64_t trace_start = game_trace_begin();
+        game_turn(&game, 0, autopilot.decide(&game, 0, &autopilot));
+        game_trace_end("bot", "decide", trace_start, 0);
+    }
+
+    // 移動蛇並檢查碰撞與食物
+    GameEvent ev = game_step_player(&game, 0);
+    game_metrics_game_tick(&metrics_game, &game, 0, ev);
+    game_latency_tick(&input_latency, &game, 0, g_get_monotonic_time());
+    if (ev == GAME_EVENT_DIED) {
         kill_player_single();
-        if (single_timer_id) {
-            g_source_remove(single_timer_id);
-            single_timer_id = 0;
-        }
-        return G_SOURCE_CONTINUE;
+        game_timer_stop(&single_timer);
+        return G_SOURCE_REMOVE;
+    }
+    if (ev == GAME_EVENT_ATE) {
+        // 播放吃果實的音效
+        queue_sound_effect(SOUND_EAT_FRUIT);
     }
 
-    // 添加新的蛇頭
-    Point* new_seg = (Point*)malloc(sizeof(Point));
-    *new_seg = nh;
-    snake_single = g_list_prepend(snake_single, new_seg);
-
-    // 檢查是否吃到食物
-    if (nh.x == food_single.x && nh.y == food_single.y) {
-        score_single++; // 增加分數
-        generate_food_single(); // 生成新的食物
+    // 重繪畫布
+    gtk_widget_queue_draw(canvas_single);
+    return G_SOURCE_CONTINUE;
+}
 
-        // 播放吃果實的音效
-        play_sound_effect("Musics/eat_fruit.mp3", FALSE, 1.0); // 不循環
+// 更新無盡模式狀態的定時器回調函式
+static gboolean update_game_endless(gpointer data)
+{
+    // 沒有需要更新的內容時停止定時器 (暫停時定時器已被暫停，不會進入此處)
+    if (current_mode != MODE_SINGLE || !endless_enabled || game_over || paused || !game_started)
+        return G_SOURCE_REMOVE;
+
+    // 移動蛇並檢查碰撞與食物，鏡頭跨過區塊邊界時生成與移出區塊
+    int64_t trace_start = game_trace_begin();
+    GameEvent ev = game_world_step(&world);
+    game_trace_end("world", "step", trace_start, world.chunk_count);
+    game_latency_tick_direction(&input_latency, 0, world.direction, g_get_monotonic_time());
+    if (ev == GAME_EVENT_DIED) {
+        kill_player_single();
+        game_timer_stop(&single_timer);
+        return G_SOURCE_REMOVE;
     }
-    else {
-        // 移除蛇尾
-        Point* tail = (Point*)g_list_last(snake_single)->data;
-        snake_single = g_list_remove(snake_single, tail);
-        free(tail);
+    if (ev == GAME_EVENT_ATE) {
+        // 播放吃果實的音效
+        queue_sound_effect(SOUND_EAT_FRUIT);
     }
 
     // 重繪畫布
@@ -1148,219 +1544,235 @@ static gboolean update_game_single(gpointer data)
 static void show_game_over_screen_single(void)
 {
     GtkStack* stack_ptr = GTK_STACK(stack);
-    GtkWidget* existing_game_over_single = gtk_stack_get_child_by_name(stack_ptr, "game_over_single");
-    if (existing_game_over_single) {
-        gtk_stack_remove(stack_ptr, existing_game_over_single);
+    finish_game_metrics();
+
+    // 記錄成績
+    char record_text[96] = "";
+    if (single_recordable) {
+        single_recordable = FALSE;
+        GameScoreRecord record = { 0 };
+        record.seed = single_seed;
+        record.time = g_get_real_time() / G_USEC_PER_SEC;
+        record.score = game.players[0].score;
+        record.width = (uint16_t)game.width;
+        record.height = (uint16_t)game.height;
+        record.length = (uint16_t)game.players[0].body.length;
+        int previous_best = -1;
+        int rank = record_score(&record, &previous_best);
+        if (scores) {
+            int written = previous_best < 0 || record.score > previous_best
+                ? snprintf(record_text, sizeof(record_text), "\n個人最佳新紀錄！")
+                : snprintf(record_text, sizeof(record_text), "\n個人最佳: %d", previous_best);
+            if (rank > 0 && written > 0 && (size_t)written < sizeof(record_text)) {
+                snprintf(record_text + written, sizeof(record_text) - (size_t)written, "   總排行榜第 %d 名", rank);
+            }
+        }
     }
 
-    // 創建垂直容器
-    GtkWidget* game_over_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 20);
-    gtk_widget_set_halign(game_over_vbox, GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(game_over_vbox, GTK_ALIGN_CENTER);
-
-    // 創建結束遊戲的標籤，顯示最終得分
-    char buf[128];
-    snprintf(buf, sizeof(buf), "遊戲結束！\n最終得分: %d", score_single);
-    GtkWidget* label = gtk_label_new(buf);
-    gtk_box_append(GTK_BOX(game_over_vbox), label);
-
-    // 添加「返回主選單」按鈕
-    GtkWidget* back_btn = gtk_button_new_with_label("返回主選單");
-    gtk_box_append(GTK_BOX(game_over_vbox), back_btn);
-    g_signal_connect(back_btn, "clicked", G_CALLBACK(on_back_to_menu_clicked), NULL);
+    // 更新結束畫面的標籤，顯示最終得分
+    char buf[192];
+    if (endless_enabled) {
+        snprintf(buf, sizeof(buf), "遊戲結束！\n最終得分: %d\n最遠距離: %d", world.score, world.stats.max_distance);
+    }
+    else {
+        snprintf(buf, sizeof(buf), "遊戲結束！\n最終得分: %d%s", game.players[0].score, record_text);
+    }
+    gtk_label_set_text(GTK_LABEL(game_over_label_single), buf);
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
-    // 將結束畫面加入到GtkStack並顯示
-    gtk_stack_add_named(stack_ptr, game_over_vbox, "game_over_single");
+    // 顯示結束畫面，預設焦點在「再來一局」
     gtk_stack_set_visible_child_name(stack_ptr, "game_over_single");
+    gtk_widget_grab_focus(rematch_btn_single);
 }
 
 //==============================================================
-// [ 雙人模式(玩家 vs 玩家) ]
+// [ 遊戲統計 ]
 //==============================================================
-// 初始化雙人遊戲
-static void init_multi_game(void)
+// 開始本局的統計摘要
+static void begin_game_metrics(const char* mode, uint64_t seed)
 {
-    clear_game_data(); // 清理之前的遊戲資料
-
-    // 玩家1 初始位置設置在左側四分之一處
-    Point* h1 = (Point*)malloc(sizeof(Point));
-    h1->x = GRID_WIDTH / 4;
-    h1->y = GRID_HEIGHT / 2;
-    snake1 = g_list_append(snake1, h1);
-
-    // 玩家2 初始位置設置在右側四分之三處
-    Point* h2 = (Point*)malloc(sizeof(Point));
-    h2->x = (GRID_WIDTH * 3) / 4;
-    h2->y = GRID_HEIGHT / 2;
-    snake2 = g_list_append(snake2, h2);
-
-    // 隨機初始方向
-    direction1 = get_random_direction();
-    next_direction1 = direction1;
-    direction2 = get_random_direction();
-    next_direction2 = direction2;
-
-    // 初始化分數和生存狀態
-    score1 = 0;
-    score2 = 0;
-    player1_alive = TRUE;
-    player2_alive = TRUE;
-    winner = 0;
-
-    // 設置雙人模式的開始時間
-    start_time_multi = time(NULL);
-    dead_time_player1 = 0;
-    dead_time_player2 = 0;
-
-    game_over = FALSE;
-    paused = FALSE;
-
-    // 收集初始位置，避免障礙物生成在蛇附近
-    GList* initial_positions = NULL;
-    initial_positions = g_list_append(initial_positions, h1);
-    initial_positions = g_list_append(initial_positions, h2);
-
-    generate_obstacles(initial_positions); // 生成障礙物
-    generate_food_multi();               // 生成食物
-    start_countdown();                    // 開始倒數計時
+    game_metrics_game_begin(&metrics_game, mode, seed, game.player_count, g_get_real_time() / G_USEC_PER_SEC);
+}
 
-    // 設置玩家1和玩家2的獨立定時器
-    player1_timer_id = g_timeout_add(current_interval_player1, update_player1, NULL);
-    player2_timer_id = g_timeout_add(current_interval_player2, update_player2, NULL);
+// 結算本局的統計，設置 SNAKE_METRICS 時附加到該檔案
+static void finish_game_metrics(void)
+{
+    if (!metrics_game.mode || metrics_game.finished) return;
+    game_metrics_game_end(&metrics_game, &game);
+    if (metrics_path && !game_metrics_game_append(&metrics_game, metrics_path)) {
+        g_printerr("metrics: cannot append to %s\n", metrics_path);
+    }
+}
 
-    g_list_free(initial_positions); // 釋放初始位置鏈表
+//==============================================================
+// [ 最高分紀錄 ]
+//==============================================================
+// 背景執行緒載入完成：接手索引並加入載入期間結束的對局
+static gboolean scores_loaded(gpointer data)
+{
+    scores = (GameScores*)data;
+    for (guint i = 0; scores_pending && i < scores_pending->len; i++) {
+        game_scores_insert(scores, &g_array_index(scores_pending, GameScoreRecord, i));
+        scores->records++;
+    }
+    if (scores_pending) {
+        g_array_free(scores_pending, TRUE);
+        scores_pending = NULL;
+    }
+    return G_SOURCE_REMOVE;
 }
 
-// 生成雙人模式下的食物
-static void generate_food_multi(void)
+// 背景執行緒：載入紀錄檔，之後依序處理附加與壓縮
+static gpointer scores_worker(gpointer data)
 {
-    gboolean valid = FALSE;
-    while (!valid) {
-        food_multi.x = rand() % GRID_WIDTH;  // 隨機X位置
-        food_multi.y = rand() % GRID_HEIGHT; // 隨機Y位置
-        valid = TRUE;
-        // 檢查食物是否與玩家1的蛇重疊
-        for (GList* it = snake1; it; it = it->next) {
-            Point* seg = (Point*)it->data;
-            if (seg->x == food_multi.x && seg->y == food_multi.y) {
-                valid = FALSE;
-                break;
+    GameScores* loaded = g_new(GameScores, 1);
+    game_scores_init(loaded);
+    gint64 start = g_get_monotonic_time();
+    gboolean writable = game_scores_load(loaded, scores_path);
+    if (!writable) {
+        // 無法辨識的紀錄檔不覆寫，本次執行的成績只保留在記憶體
+        g_printerr("scores: cannot read %s, not recording to disk\n", scores_path);
+        game_scores_free(loaded);
+    }
+    else if (loaded->torn > 0) {
+        // 上次寫到一半就結束：先修復紀錄檔，之後附加的紀錄才會對齊
+        g_printerr("scores: dropped %ld torn bytes at the end of %s\n", loaded->torn, scores_path);
+        if (!game_scores_compact(loaded, scores_path)) writable = FALSE;
+    }
+    g_print("scores: %ld records loaded in %.1f ms\n", loaded->records, (g_get_monotonic_time() - start) / 1000.0);
+    g_idle_add(scores_loaded, loaded);
+
+    for (;;) {
+        ScoreJob* job = (ScoreJob*)g_async_queue_pop(scores_queue);
+        ScoreJobKind kind = job->kind;
+        if (kind == SCORE_JOB_APPEND && writable) {
+            if (!game_scores_append(scores_path, &job->record, TRUE)) {
+                g_printerr("scores: cannot append to %s\n", scores_path);
             }
         }
-        // 檢查食物是否與玩家2的蛇重疊
-        for (GList* it = snake2; it; it = it->next) {
-            Point* seg = (Point*)it->data;
-            if (seg->x == food_multi.x && seg->y == food_multi.y) {
-                valid = FALSE;
-                break;
-            }
-        }
-        // 檢查食物是否與障礙物重疊
-        if (valid) {
-            for (GList* iter = obstacles; iter; iter = iter->next) {
-                Obstacle* obs = (Obstacle*)iter->data;
-                if (food_multi.x >= obs->x && food_multi.x < obs->x + obs->width &&
-                    food_multi.y >= obs->y && food_multi.y < obs->y + obs->height) {
-                    valid = FALSE;
-                    break;
+        else if (kind == SCORE_JOB_COMPACT && writable) {
+            // 以紀錄檔重建暫時的索引後重寫，不需要與介面執行緒共用索引
+            GameScores temp;
+            game_scores_init(&temp);
+            long before = 0;
+            if (game_scores_load(&temp, scores_path)) {
+                before = temp.records;
+                if (game_scores_compact(&temp, scores_path)) {
+                    g_print("scores: compacted %ld -> %ld records\n", before, temp.records);
                 }
             }
+            game_scores_free(&temp);
         }
+        g_free(job);
+        if (kind == SCORE_JOB_QUIT) break;
     }
+    return NULL;
 }
 
-// 檢查蛇是否自撞
-static gboolean check_self_collision(Point* head, GList* snake)
+// 把工作交給背景執行緒
+static void scores_post(ScoreJobKind kind, const GameScoreRecord* record)
 {
-    for (GList* iter = snake->next; iter; iter = iter->next) {
-        Point* seg = (Point*)iter->data;
-        if (seg->x == head->x && seg->y == head->y) return TRUE;
-    }
-    return FALSE;
+    ScoreJob* job = g_new0(ScoreJob, 1);
+    job->kind = kind;
+    if (record) job->record = *record;
+    g_async_queue_push(scores_queue, job);
 }
 
-// 檢查蛇是否撞到另一條蛇
-static gboolean check_snake_collision(Point* head, GList* snake)
+// 記錄單人局的成績
+static int record_score(const GameScoreRecord* record, int* previous_best)
 {
-    for (GList* iter = snake; iter; iter = iter->next) {
-        Point* seg = (Point*)iter->data;
-        if (seg->x == head->x && seg->y == head->y) return TRUE;
-    }
-    return FALSE;
+    *previous_best = -1;
+    if (!scores_queue) return 0;
+    scores_post(SCORE_JOB_APPEND, record);
+
+    if (!scores) {
+        if (!scores_pending) scores_pending = g_array_new(FALSE, FALSE, sizeof(GameScoreRecord));
+        g_array_append_val(scores_pending, *record);
+        return 0;
+    }
+    const GameScoreRecord* best = game_scores_best(scores, record->width, record->height);
+    if (best) *previous_best = best->score;
+    int rank = game_scores_insert(scores, record);
+    scores->records++;
+
+    // 不需要的紀錄夠多時，由背景執行緒壓縮 (壓縮後的紀錄數等於索引保留的筆數)
+    if (game_scores_should_compact(scores)) {
+        scores_post(SCORE_JOB_COMPACT, NULL);
+        scores->records = game_scores_live(scores);
+    }
+    return rank > 0 ? rank : 0;
 }
 
-// 玩家1死亡的處理函式
-static void kill_player1(void)
+//==============================================================
+// [ 雙人模式(玩家 vs 玩家) ]
+//==============================================================
+// 初始化雙人遊戲
+static void init_multi_game(void)
 {
-    // 記錄玩家1存活的秒數 (死亡時的時間 - 遊戲開始時間)
-    if (dead_time_player1 == 0) {
-        dead_time_player1 = time(NULL) - start_time_multi;
+    clear_game_data(); // 清理之前的遊戲資料
+
+    // 設置兩條蛇的初始位置與隨機方向，並生成障礙物和食物
+    game_new_multi(&game);
+    game_bot_reset(&autopilot);
+    game_bot_reset(&opponent);
+    game_over = FALSE;
+    paused = FALSE;
+    if (spectate_enabled) metrics_game.mode = NULL; // 觀戰的局面屬於伺服器，不記錄
+    else begin_game_metrics(net_enabled ? (net_rollback > 0 ? "net_rollback" : "net")
+        : (autopilot_enabled ? "multi_bot" : "multi"), 0);
+
+    // 網路對戰：倒數期間就開始交換 HELLO，主機的種子決定本局
+    if (net_enabled) {
+        game_lockstep_init(&lockstep, &game, net_player, net_delay,
+            (uint64_t)g_get_real_time() ^ game.rng_state, net_match++);
+        if (!game_lockstep_set_rollback(&lockstep, net_rollback)) {
+            g_printerr("net: cannot allocate the rollback snapshots, using lockstep\n");
+        }
+        net_death_shown[0] = net_death_shown[1] = FALSE;
+        net_last_tick = g_get_monotonic_time();
+        game_timer_start(&net_timer, 10, update_network);
     }
 
-    // 播放蛇死亡音效
-    play_sound_effect("Musics/snake_die.mp3", FALSE, 1.0); // 不循環
+    // 觀戰：不需要倒數，畫面直接跟著伺服器的串流更新
+    if (spectate_enabled) {
+        spectate_joined = FALSE;
+        spectate_view.synced = FALSE;
+        spectate_watch_at = 0;
+        game_started = TRUE;
+        update_alloc_phase();
+        game_timer_start(&spectate_timer, 10, update_spectate);
+        return;
+    }
 
-    // 啟動蛇的閃爍效果
-    start_flicker_snake(&snake1, &player1_alive, canvas_multi);
+    start_countdown();                    // 開始倒數計時，倒數結束後才啟動兩位玩家的獨立定時器
 }
 
-// 玩家2死亡的處理函式
-static void kill_player2(void)
+// 玩家死亡的處理函式 (player: 0 為玩家1，1 為玩家2)
+static void kill_player_multi(int player)
 {
-    // 記錄玩家2存活的秒數 (死亡時的時間 - 遊戲開始時間)
-    if (dead_time_player2 == 0) {
-        dead_time_player2 = time(NULL) - start_time_multi;
-    }
-
     // 播放蛇死亡音效
-    play_sound_effect("Musics/snake_die.mp3", FALSE, 1.0); // 不循環
+    queue_sound_effect(SOUND_SNAKE_DIE);
 
-    // 啟動蛇的閃爍效果
-    start_flicker_snake(&snake2, &player2_alive, canvas_multi);
+    // 啟動蛇的閃爍效果，閃爍結束後才結算
+    start_flicker_snake(player, canvas_multi);
 }
 
 // 結束雙人遊戲的處理函式
 static void end_two_player_game(void)
 {
     // 若兩人都死亡，則結束遊戲並結算勝負
-    if (!player1_alive && !player2_alive) {
+    if (game_all_dead(&game)) {
         game_over = TRUE;
+        update_alloc_phase();
 
-        // 根據分數決定勝利者
-        if (score1 > score2) {
-            winner = 1;
-        }
-        else if (score2 > score1) {
-            winner = 2;
-        }
-        else {
-            // 分數相同，根據存活時間決定
-            if (dead_time_player1 > dead_time_player2) {
-                winner = 1;
-            }
-            else if (dead_time_player2 > dead_time_player1) {
-                winner = 2;
-            }
-            else {
-                // 分數和存活時間都相同，判定為平局
-                winner = 0; // 0 表示平局
-            }
-        }
+        // 優先比較分數，同分時比較存活時間
+        game_decide_winner(&game);
 
         // 移除玩家1和玩家2的定時器
-        if (player1_timer_id) { g_source_remove(player1_timer_id); player1_timer_id = 0; }
-        if (player2_timer_id) { g_source_remove(player2_timer_id); player2_timer_id = 0; }
-
-        // 停止遊戲背景音樂
-        if (game_background_music) {
-            gst_element_set_state(game_background_music->pipeline, GST_STATE_NULL);
-            gst_object_unref(game_background_music->pipeline);
-            free(game_background_music);
-            game_background_music = NULL;
-        }
+        game_timer_stop(&player1_timer);
+        game_timer_stop(&player2_timer);
 
         // 停止倒數音效
         if (countdown_music) {
@@ -1376,197 +1788,216 @@ static void end_two_player_game(void)
     }
 }
 
-// 更新玩家1狀態的定時器回調函式
-static gboolean update_player1(gpointer data)
+// 更新雙人模式中一位玩家的狀態 (player: 0 為玩家1，1 為玩家2)
+static gboolean update_player_multi(int player, GameTimer* timer, GSourceFunc func)
 {
-    // 如果當前模式不是雙人模式，或者遊戲已結束、暫停，或者玩家1已死亡，則不進行更新
-    if (current_mode != MODE_MULTI || game_over || paused || !player1_alive)
-        return G_SOURCE_CONTINUE;
-    if (!game_started)
-        return G_SOURCE_CONTINUE;
-
-    // 更新方向
-    direction1 = next_direction1;
-
-    // 計算新的蛇頭位置
-    Point* head = (Point*)snake1->data;
-    if (!head) { // 確保蛇頭存在
-        return G_SOURCE_CONTINUE;
-    }
-    Point nh = { head->x, head->y };
-    switch (direction1) {
-    case GDK_KEY_Up:    nh.y--; break;
-    case GDK_KEY_Down:  nh.y++; break;
-    case GDK_KEY_Left:  nh.x--; break;
-    case GDK_KEY_Right: nh.x++; break;
-    }
-    // 處理邊界循環
-    if (nh.x < 0) nh.x = GRID_WIDTH - 1;
-    else if (nh.x >= GRID_WIDTH) nh.x = 0;
-    if (nh.y < 0) nh.y = GRID_HEIGHT - 1;
-    else if (nh.y >= GRID_HEIGHT) nh.y = 0;
-
-    // 自撞檢查
-    if (check_self_collision(&nh, snake1)) {
-        kill_player1();
-        if (player1_timer_id) {
-            g_source_remove(player1_timer_id);
-            player1_timer_id = 0;
-        }
+    // 沒有需要更新的內容 (遊戲結束、未開始或玩家已死亡) 時停止定時器
+    if (current_mode != MODE_MULTI || game_over || paused || !game.players[player].alive || !game_started)
+        return G_SOURCE_REMOVE;
+
+    // 自動駕駛開啟時，玩家2的方向由樹搜尋決定
+    if (autopilot_enabled && player == 1) {
+        int64_t trace_start = game_trace_begin();
+        game_turn(&game, 1, opponent.decide(&game, 1, &opponent));
+        game_trace_end("bot", "decide", trace_start, 1);
+    }
+
+    // 移動蛇並檢查自撞、障礙物與另一條蛇
+    int old_interval = game.players[player].interval;
+    GameEvent ev = game_step_player(&game, player);
+    game_metrics_game_tick(&metrics_game, &game, player, ev);
+    game_latency_tick(&input_latency, &game, player, g_get_monotonic_time());
+    if (ev == GAME_EVENT_DIED) {
+        kill_player_multi(player);
+        game_timer_stop(timer);
         // 不立即調用 end_two_player_game，改由閃爍完成後調用
-        return G_SOURCE_CONTINUE;
-    }
-    // 撞障礙物檢查
-    for (GList* iter = obstacles; iter; iter = iter->next) {
-        Obstacle* obs = (Obstacle*)iter->data;
-        if (nh.x >= obs->x && nh.x < obs->x + obs->width &&
-            nh.y >= obs->y && nh.y < obs->y + obs->height) {
-            kill_player1();
-            if (player1_timer_id) {
-                g_source_remove(player1_timer_id);
-                player1_timer_id = 0;
-            }
-            return G_SOURCE_CONTINUE;
-        }
-    }
-    // 撞到另一條蛇的檢查
-    if (player2_alive) {
-        if (check_snake_collision(&nh, snake2)) {
-            kill_player1();
-            if (player1_timer_id) {
-                g_source_remove(player1_timer_id);
-                player1_timer_id = 0;
-            }
-            return G_SOURCE_CONTINUE;
-        }
+        return G_SOURCE_REMOVE;
     }
-
-    // 添加新的蛇頭
-    Point* new_seg = (Point*)malloc(sizeof(Point));
-    *new_seg = nh;
-    snake1 = g_list_prepend(snake1, new_seg);
-
-    // 檢查是否吃到食物
-    if (nh.x == food_multi.x && nh.y == food_multi.y) {
-        score1++; // 增加分數
-        generate_food_multi(); // 生成新的食物
-
+    if (ev == GAME_EVENT_ATE) {
         // 播放吃果實的音效
-        play_sound_effect("Musics/eat_fruit.mp3", FALSE, 1.0); // 不循環
+        queue_sound_effect(SOUND_EAT_FRUIT);
 
-        // 降低速度 (增加移動間隔)
-        if (current_interval_player1 < MAX_INTERVAL) { // 限制最大移動間隔
-            current_interval_player1 += 5;
-            if (player1_timer_id) g_source_remove(player1_timer_id);
-            player1_timer_id = g_timeout_add(current_interval_player1, update_player1, NULL);
+        // 吃到果實後速度降低 (移動間隔增加)，以新的間隔重新排程
+        if (game.players[player].interval != old_interval) {
+            game_timer_start(timer, game.players[player].interval, func);
         }
     }
-    else {
-        // 移除蛇尾
-        Point* tail = (Point*)g_list_last(snake1)->data;
-        snake1 = g_list_remove(snake1, tail);
-        free(tail);
-    }
 
     // 重繪畫布
     gtk_widget_queue_draw(canvas_multi);
     return G_SOURCE_CONTINUE;
 }
 
+// 更新玩家1狀態的定時器回調函式
+static gboolean update_player1(gpointer data)
+{
+    return update_player_multi(0, &player1_timer, update_player1);
+}
+
 // 更新玩家2狀態的定時器回調函式
 static gboolean update_player2(gpointer data)
 {
-    // 如果當前模式不是雙人模式，或者遊戲已結束、暫停，或者玩家2已死亡，則不進行更新
-    if (current_mode != MODE_MULTI || game_over || paused || !player2_alive)
-        return G_SOURCE_CONTINUE;
-    if (!game_started)
-        return G_SOURCE_CONTINUE;
-
-    // 更新方向
-    direction2 = next_direction2;
-
-    // 計算新的蛇頭位置
-    Point* head = (Point*)snake2->data;
-    if (!head) { // 確保蛇頭存在
-        return G_SOURCE_CONTINUE;
-    }
-    Point nh = { head->x, head->y };
-    switch (direction2) {
-    case GDK_KEY_Up:    nh.y--; break;
-    case GDK_KEY_Down:  nh.y++; break;
-    case GDK_KEY_Left:  nh.x--; break;
-    case GDK_KEY_Right: nh.x++; break;
-    }
-    // 處理邊界循環
-    if (nh.x < 0) nh.x = GRID_WIDTH - 1;
-    else if (nh.x >= GRID_WIDTH) nh.x = 0;
-    if (nh.y < 0) nh.y = GRID_HEIGHT - 1;
-    else if (nh.y >= GRID_HEIGHT) nh.y = 0;
-
-    // 自撞檢查
-    if (check_self_collision(&nh, snake2)) {
-        kill_player2();
-        if (player2_timer_id) {
-            g_source_remove(player2_timer_id);
-            player2_timer_id = 0;
+    return update_player_multi(1, &player2_timer, update_player2);
+}
+
+// 網路雙人模式的定時器回調函式
+static gboolean update_network(gpointer data)
+{
+    if (current_mode != MODE_MULTI || !net_enabled) return G_SOURCE_REMOVE;
+
+    // 倒數、暫停與結束畫面的時間不計入遊戲時間
+    gint64 now_us = g_get_monotonic_time();
+    double now = now_us / 1000.0;
+    if (!game_started || paused || game_over) {
+        game_lockstep_hold(&lockstep, (now_us - net_last_tick) / 1000.0);
+    }
+    net_last_tick = now_us;
+
+    uint8_t buffer[GAME_NET_MAX_PACKET];
+    int length;
+    while ((length = game_net_recv(&net_socket, buffer, sizeof(buffer), NULL)) >= 0) {
+        game_lockstep_read(&lockstep, buffer, length, now);
+    }
+
+    // 回溯模式：對方的實際輸入與預測不同時，先修正局面再推進
+    long rollbacks = lockstep.stats.rollbacks;
+    game_lockstep_reconcile(&lockstep);
+    gboolean redraw = lockstep.stats.rollbacks != rollbacks;
+
+    // 推進所有已到時間且兩端輸入都已知 (或可以預測) 的移動
+    GameEvent ev;
+    for (;;) {
+        if (autopilot_enabled && game.players[net_player].alive && game_lockstep_wait_ms(&lockstep, now) == 0.0) {
+            game_lockstep_set_input(&lockstep, autopilot.decide(&game, net_player, &autopilot));
         }
-        // 不立即調用 end_two_player_game，改由閃爍完成後調用
-        return G_SOURCE_CONTINUE;
-    }
-    // 撞障礙物檢查
-    for (GList* iter = obstacles; iter; iter = iter->next) {
-        Obstacle* obs = (Obstacle*)iter->data;
-        if (nh.x >= obs->x && nh.x < obs->x + obs->width &&
-            nh.y >= obs->y && nh.y < obs->y + obs->height) {
-            kill_player2();
-            if (player2_timer_id) {
-                g_source_remove(player2_timer_id);
-                player2_timer_id = 0;
-            }
-            return G_SOURCE_CONTINUE;
+        int player = game_lockstep_advance(&lockstep, now, &ev);
+        if (player < 0) break;
+        game_metrics_game_tick(&metrics_game, &game, player, ev);
+        if (player == net_player) game_latency_tick(&input_latency, &game, player, g_get_monotonic_time());
+        redraw = TRUE;
+        if (ev == GAME_EVENT_ATE) {
+            queue_sound_effect(SOUND_EAT_FRUIT);
         }
     }
-    // 撞到另一條蛇的檢查
-    if (player1_alive) {
-        if (check_snake_collision(&nh, snake1)) {
-            kill_player2();
-            if (player2_timer_id) {
-                g_source_remove(player2_timer_id);
-                player2_timer_id = 0;
+
+    // 依目前的局面啟動死亡閃爍；回溯讓蛇復活時取消閃爍 (死亡也可能出現在重新模擬的移動中)
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        gboolean dead = !game.players[i].alive;
+        if (dead && !net_death_shown[i]) {
+            net_death_shown[i] = TRUE;
+            kill_player_multi(i);
+        }
+        else if (!dead && net_death_shown[i]) {
+            net_death_shown[i] = FALSE;
+            if (flicker_timer_ids[i]) {
+                g_source_remove(flicker_timer_ids[i]);
+                flicker_timer_ids[i] = 0;
             }
-            return G_SOURCE_CONTINUE;
+            snake_hidden[i] = FALSE;
+            flicker_done[i] = FALSE;
         }
     }
 
-    // 添加新的蛇頭
-    Point* new_seg = (Point*)malloc(sizeof(Point));
-    *new_seg = nh;
-    snake2 = g_list_prepend(snake2, new_seg);
+    if (game_lockstep_should_send(&lockstep, now)) {
+        length = game_lockstep_write(&lockstep, buffer, now);
+        game_net_send(&net_socket, &net_peer, buffer, (size_t)length);
+    }
+    game_net_flush(&net_socket);
 
-    // 檢查是否吃到食物
-    if (nh.x == food_multi.x && nh.y == food_multi.y) {
-        score2++; // 增加分數
-        generate_food_multi(); // 生成新的食物
+    if (redraw) gtk_widget_queue_draw(canvas_multi);
 
-        // 播放吃果實的音效
-        play_sound_effect("Musics/eat_fruit.mp3", FALSE, 1.0); // 不循環
+    // 閃爍已結束、輸入也都確認後結算
+    if (lockstep.phase == LOCKSTEP_OVER && !game_over && flicker_done[0] && flicker_done[1]) {
+        end_two_player_game();
+    }
 
-        // 降低速度 (增加移動間隔)
-        if (current_interval_player2 < MAX_INTERVAL) { // 限制最大移動間隔
-            current_interval_player2 += 5;
-            if (player2_timer_id) g_source_remove(player2_timer_id);
-            player2_timer_id = g_timeout_add(current_interval_player2, update_player2, NULL);
+    // 兩端的局面雜湊不一致時無法繼續，以目前的局面結算
+    if (lockstep.phase == LOCKSTEP_DESYNC && !game_over) {
+        g_printerr("net: desync detected at move %ld\n", lockstep.stats.desync_frame);
+        game_over = TRUE;
+        update_alloc_phase();
+        game_decide_winner(&game);
+        gtk_widget_queue_draw(canvas_multi);
+        show_game_over_screen_multi();
+    }
+
+    // 對方已收到本機需要送出的所有輸入後停止，輸出本局的網路統計
+    if (game_over && game_lockstep_finished(&lockstep)) {
+        const GameLockstepStats* st = &lockstep.stats;
+        g_print("net: %ld moves, rtt %.1f ms (min %.1f, max %.1f), input delay %d moves = %.1f ms, "
+            "stalls %ld (%.1f ms), %.2f bytes/move sent\n",
+            lockstep.frame, st->rtt_ms, st->rtt_min_ms, st->rtt_max_ms, lockstep.delay, st->input_delay_ms,
+            st->stalls, st->stall_ms, lockstep.frame ? (double)st->bytes_sent / lockstep.frame : 0.0);
+        if (lockstep.rollback_frames > 0) {
+            g_print("net: rollback %ld times (depth avg %.1f, max %ld), %ld moves resimulated, "
+                "%ld visual corrections\n", st->rollbacks,
+                st->rollbacks ? (double)st->rollback_depth_total / st->rollbacks : 0.0, st->rollback_depth_max,
+                st->resim_frames, st->corrections);
         }
+        return G_SOURCE_REMOVE;
     }
-    else {
-        // 移除蛇尾
-        Point* tail = (Point*)g_list_last(snake2)->data;
-        snake2 = g_list_remove(snake2, tail);
-        free(tail);
+    return G_SOURCE_CONTINUE;
+}
+
+// 向伺服器要求觀看：尚未收到串流時送往大廳，之後送往房間所在的工作執行緒
+static void spectate_watch(uint8_t flags)
+{
+    uint8_t buffer[GAME_SPECTATE_WATCH_BYTES];
+    int length = spectate_joined
+        ? game_spectate_encode_watch(spectate_view.room, flags, buffer)
+        : game_spectate_encode_watch(spectate_room, flags, buffer);
+    game_net_send(&spectate_socket, spectate_joined ? &spectate_worker : &spectate_server, buffer, (size_t)length);
+    spectate_watch_at = g_get_monotonic_time();
+}
+
+// 觀戰模式的定時器回調函式
+static gboolean update_spectate(gpointer data)
+{
+    if (current_mode != MODE_MULTI || !spectate_enabled) return G_SOURCE_REMOVE;
+
+    gint64 now = g_get_monotonic_time();
+    gboolean redraw = FALSE;
+    uint8_t buffer[1024]; // 關鍵影格可能超過 GAME_NET_MAX_PACKET (接收不受此限制)
+    GameNetAddress from;
+    int length;
+    while ((length = game_net_recv(&spectate_socket, buffer, sizeof(buffer), &from)) >= 0) {
+        GameSpectateResult result = game_spectate_apply(&spectate_view, buffer, (size_t)length);
+        if (result == SPECTATE_INVALID || result == SPECTATE_IGNORED) continue;
+        spectate_worker = from;
+        spectate_joined = TRUE;
+        spectate_heard_at = now;
+        redraw = TRUE;
+        if (result == SPECTATE_GAP) {
+            // 遺漏了影格：畫面停在最後的局面，直到收到關鍵影格
+            if (now - spectate_watch_at >= SPECTATE_RETRY_US) spectate_watch(GAME_SPECTATE_WATCH_KEY);
+        }
+        else if (spectate_view.over) {
+            // 對局結束，改看大廳分配的另一個房間 (指定的房間已不存在)
+            g_print("spectate: room %u over at move %u, winner %d, %llu packets, %.1f bytes/packet, %llu gaps\n",
+                spectate_view.room, spectate_view.frame, spectate_view.game.winner,
+                (unsigned long long)spectate_view.packets,
+                spectate_view.packets ? (double)spectate_view.bytes / spectate_view.packets : 0.0,
+                (unsigned long long)spectate_view.gaps);
+            spectate_room = 0;
+            spectate_joined = FALSE;
+            spectate_watch(GAME_SPECTATE_WATCH_KEY);
+        }
     }
 
-    // 重繪畫布
-    gtk_widget_queue_draw(canvas_multi);
+    // 重送、續訂與逾時
+    if (spectate_joined && now - spectate_heard_at > SPECTATE_SILENCE_US) {
+        spectate_joined = FALSE;
+        spectate_watch(GAME_SPECTATE_WATCH_KEY);
+    }
+    else if (!spectate_joined && now - spectate_watch_at > SPECTATE_RESEND_US) {
+        spectate_watch(GAME_SPECTATE_WATCH_KEY);
+    }
+    else if (spectate_joined && now - spectate_watch_at > SPECTATE_RENEW_US) {
+        spectate_watch(spectate_view.synced ? 0 : GAME_SPECTATE_WATCH_KEY);
+    }
+    game_net_flush(&spectate_socket);
+
+    if (redraw) gtk_widget_queue_draw(canvas_multi);
     return G_SOURCE_CONTINUE;
 }
 
@@ -1574,22 +2005,14 @@ static gboolean update_player2(gpointer data)
 static void show_game_over_screen_multi(void)
 {
     GtkStack* stack_ptr = GTK_STACK(stack);
-    GtkWidget* existing_game_over_multi = gtk_stack_get_child_by_name(stack_ptr, "game_over_multi");
-    if (existing_game_over_multi) {
-        gtk_stack_remove(stack_ptr, existing_game_over_multi);
-    }
-
-    // 創建垂直容器
-    GtkWidget* game_over_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 20);
-    gtk_widget_set_halign(game_over_vbox, GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(game_over_vbox, GTK_ALIGN_CENTER);
+    finish_game_metrics();
 
     // 根據勝利者設置結果描述
     const char* res = NULL;
-    if (winner == 1) {
+    if (game.winner == 1) {
         res = "玩家1 (綠色) 獲勝！";
     }
-    else if (winner == 2) {
+    else if (game.winner == 2) {
         res = "玩家2 (橘色) 獲勝！";
     }
     else {
@@ -1597,203 +2020,54 @@ static void show_game_over_screen_multi(void)
         res = "平局！";
     }
 
-    // 創建結束遊戲的標籤，顯示分數和結果
+    // 更新結束畫面的標籤，顯示分數和結果
     char buf[256];
     snprintf(buf, sizeof(buf),
         "遊戲結束！\n玩家1:%d   玩家2:%d\n\n%s\n\n(玩家1存活: %ld 秒, 玩家2存活: %ld 秒)",
-        score1, score2, res, (long)dead_time_player1, (long)dead_time_player2);
-    GtkWidget* label = gtk_label_new(buf);
-    gtk_box_append(GTK_BOX(game_over_vbox), label);
-
-    // 添加「返回主選單」按鈕
-    GtkWidget* back_btn = gtk_button_new_with_label("返回主選單");
-    gtk_box_append(GTK_BOX(game_over_vbox), back_btn);
-    g_signal_connect(back_btn, "clicked", G_CALLBACK(on_back_to_menu_clicked), NULL);
+        game.players[0].score, game.players[1].score, res,
+        game_survival_seconds(game.players[0].survival_ms), game_survival_seconds(game.players[1].survival_ms));
+    gtk_label_set_text(GTK_LABEL(game_over_label_multi), buf);
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
-    // 將結束畫面加入到GtkStack並顯示
-    gtk_stack_add_named(stack_ptr, game_over_vbox, "game_over_multi");
+    // 顯示結束畫面，預設焦點在「再來一局」
     gtk_stack_set_visible_child_name(stack_ptr, "game_over_multi");
+    gtk_widget_grab_focus(rematch_btn_multi);
 }
 
 //==============================================================
-// [ 繪圖：蛇/牆/果實 ]
-//==============================================================
-// 繪製蛇的一個節點，包括身體和陰影
-static void draw_snake_segment(cairo_t* cr, double x, double y, double size,
-    GdkRGBA body, GdkRGBA shadow)
-{
-    // 繪製陰影
-    cairo_set_source_rgba(cr, shadow.red, shadow.green, shadow.blue, shadow.alpha);
-    double off = 2; // 偏移量，用於創建陰影效果
-    cairo_rectangle(cr, x + off, y + off, size, size);
-    cairo_fill(cr);
-
-    // 繪製蛇本體
-    cairo_set_source_rgba(cr, body.red, body.green, body.blue, body.alpha);
-    cairo_rectangle(cr, x, y, size, size);
-    cairo_fill(cr);
-}
-
-// 繪製食物，包括本體和陰影
-static void draw_food(cairo_t* cr, double x, double y, double size)
-{
-    // 繪製陰影
-    cairo_set_source_rgb(cr, 0.5, 0.0, 0.0); // 深紅色
-    cairo_rectangle(cr, x + 2, y + 2, size, size);
-    cairo_fill(cr);
-
-    // 繪製食物本體 (紅色)
-    cairo_set_source_rgb(cr, 1.0, 0.0, 0.0); // 紅色
-    cairo_rectangle(cr, x, y, size, size);
-    cairo_fill(cr);
-}
-
-// 繪製牆壁，包括本體和陰影
-static void draw_wall(cairo_t* cr, double x, double y, double w, double h)
-{
-    // 繪製陰影
-    cairo_set_source_rgb(cr, 0.2, 0.2, 0.2); // 灰色
-    cairo_rectangle(cr, x + 2, y + 2, w, h);
-    cairo_fill(cr);
-
-    // 繪製牆本體
-    cairo_set_source_rgb(cr, 0.5, 0.5, 0.5); // 較亮的灰色
-    cairo_rectangle(cr, x, y, w, h);
-    cairo_fill(cr);
-}
-
-//==============================================================
-// [ 繪製各模式 ]
+// [ 繪圖區域 DrawFunc ]
 //==============================================================
-// 繪製單人模式的遊戲畫面
-static void draw_single_mode(cairo_t* cr, int width, int height, double cell_size)
-{
-    // 設置背景顏色
-    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1); // 深灰色
-    cairo_paint(cr);
-
-    // 繪製食物
-    draw_food(cr, food_single.x * cell_size, food_single.y * cell_size, cell_size);
-
-    // 繪製障礙物
-    for (GList* iter = obstacles; iter; iter = iter->next) {
-        Obstacle* obs = (Obstacle*)iter->data;
-        draw_wall(cr, obs->x * cell_size, obs->y * cell_size,
-            obs->width * cell_size, obs->height * cell_size);
-    }
-
-    // 繪製蛇 (綠色)
-    GdkRGBA body_green = { 0.0,1.0,0.0,1.0 };      // 蛇身體顏色
-    GdkRGBA shadow_green = { 0.0,0.4,0.0,1.0 };    // 蛇陰影顏色
-    for (GList* iter = snake_single; iter; iter = iter->next) {
-        Point* seg = (Point*)iter->data;
-        if (seg) { // 確保節點存在
-            draw_snake_segment(cr, seg->x * cell_size, seg->y * cell_size,
-                cell_size, body_green, shadow_green);
-        }
-    }
-
-    // 繪製分數
-    cairo_set_source_rgb(cr, 1, 1, 1); // 白色
-    // 設置字體為 "Cubic 11"
-    cairo_select_font_face(cr, "Cubic 11",
-        CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 16);
-    char buf[64];
-    snprintf(buf, sizeof(buf), "分數: %d", score_single);
-    cairo_move_to(cr, 10, 25); // 設置文字位置
-    cairo_show_text(cr, buf);   // 顯示文字
-
-    // 繪製倒數
-    if (!game_started) {
-        cairo_set_source_rgb(cr, 1, 1, 1); // 白色
-        cairo_set_font_size(cr, 40);       // 大字體
-        if (countdown > 0) {
-            char cbuf[8];
-            snprintf(cbuf, sizeof(cbuf), "%d", countdown);
-            cairo_move_to(cr, width / 2 - 20, height / 2); // 設置文字位置
-            cairo_show_text(cr, cbuf);                     // 顯示倒數數字
-        }
-        else if (show_go && !game_started) {
-            cairo_move_to(cr, width / 2 - 30, height / 2);
-            cairo_show_text(cr, "開始！");                   // 顯示「開始！」字樣
-        }
-    }
-}
-
-// 繪製雙人模式的遊戲畫面
-static void draw_multi_mode(cairo_t* cr, int width, int height, double cell_size)
+// 記錄這個畫面繪製的轉向，並以畫面時鐘的呈現時間完成先前畫面的轉向
+static void track_latency_frame(GtkDrawingArea* area, gint64 drawn_at)
 {
-    // 設置背景顏色
-    cairo_set_source_rgb(cr, 0.12, 0.12, 0.12); // 深灰色
-    cairo_paint(cr);
-
-    // 繪製食物
-    draw_food(cr, food_multi.x * cell_size, food_multi.y * cell_size, cell_size);
-
-    // 繪製障礙物
-    for (GList* it = obstacles; it; it = it->next) {
-        Obstacle* obs = (Obstacle*)it->data;
-        draw_wall(cr, obs->x * cell_size, obs->y * cell_size,
-            obs->width * cell_size, obs->height * cell_size);
-    }
-
-    // 繪製玩家1的蛇 (綠色)
-    GdkRGBA b1 = { 0.0,1.0,0.0,1.0 };           // 蛇身體顏色
-    GdkRGBA s1 = { 0.0,0.4,0.0,1.0 };           // 蛇陰影顏色
-    for (GList* it = snake1; it; it = it->next) {
-        Point* seg = (Point*)it->data;
-        if (seg) { // 確保節點存在
-            draw_snake_segment(cr, seg->x * cell_size, seg->y * cell_size,
-                cell_size, b1, s1);
+    GdkFrameClock* clock = gtk_widget_get_frame_clock(GTK_WIDGET(area));
+    if (!clock) {
+        // 尚未顯示在視窗中：以繪製完成的時間代替
+        game_latency_frame(&input_latency, 0, drawn_at);
+        game_latency_present(&input_latency, 0, 0);
+        return;
+    }
+    gint64 counter = gdk_frame_clock_get_frame_counter(clock);
+    game_latency_frame(&input_latency, counter, drawn_at);
+
+    // 先前畫面的時序完成 (收到呈現時間或確定沒有) 後才結算；不在歷史中或太久未完成的畫面以預測或繪製的時間代替
+    gint64 frame;
+    while ((frame = game_latency_oldest_frame(&input_latency)) >= 0 && frame < counter) {
+        GdkFrameTimings* timings = gdk_frame_clock_get_timings(clock, frame);
+        gint64 presented = 0;
+        if (timings) {
+            if (!gdk_frame_timings_get_complete(timings) && counter - frame < LATENCY_PRESENT_WAIT_FRAMES) break;
+            presented = gdk_frame_timings_get_presentation_time(timings);
+            if (presented == 0) presented = gdk_frame_timings_get_predicted_presentation_time(timings);
         }
-    }
-
-    // 繪製玩家2的蛇 (橘色)
-    GdkRGBA b2 = { 1.0,0.5,0.0,1.0 };           // 蛇身體顏色
-    GdkRGBA s2 = { 0.4,0.2,0.0,1.0 };           // 蛇陰影顏色
-    for (GList* it = snake2; it; it = it->next) {
-        Point* seg = (Point*)it->data;
-        if (seg) { // 確保節點存在
-            draw_snake_segment(cr, seg->x * cell_size, seg->y * cell_size,
-                cell_size, b2, s2);
-        }
-    }
-
-    // 繪製分數
-    cairo_set_source_rgb(cr, 1, 1, 1); // 白色
-    // 設置字體為 "Cubic 11"
-    cairo_select_font_face(cr, "Cubic 11",
-        CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 16);
-    char buf[64];
-    snprintf(buf, sizeof(buf), "玩家1:%d   玩家2:%d", score1, score2);
-    cairo_move_to(cr, 10, 25); // 設置文字位置
-    cairo_show_text(cr, buf);   // 顯示分數
-
-    // 繪製倒數
-    if (!game_started) {
-        cairo_set_source_rgb(cr, 1, 1, 1); // 白色
-        cairo_set_font_size(cr, 40);       // 大字體
-        if (countdown > 0) {
-            char cbuf[8];
-            snprintf(cbuf, sizeof(cbuf), "%d", countdown);
-            cairo_move_to(cr, width / 2 - 20, height / 2); // 設置文字位置
-            cairo_show_text(cr, cbuf);                     // 顯示倒數數字
-        }
-        else if (show_go && !game_started) {
-            cairo_move_to(cr, width / 2 - 30, height / 2);
-            cairo_show_text(cr, "開始！");                   // 顯示「開始！」字樣
+        if (game_latency_present(&input_latency, frame, presented) > 0) {
+            game_perf_push(&perf, PERF_INPUT, input_latency.last_total_ms);
         }
     }
 }
 
-//==============================================================
-// [ 繪圖區域 DrawFunc ]
-//==============================================================
 // GtkDrawingArea的繪圖回調函式，根據當前遊戲模式調用不同的繪圖函式
 static void draw_game(GtkDrawingArea* area, cairo_t* cr, int width, int height, gpointer user_data)
 {
@@ -1801,16 +2075,80 @@ static void draw_game(GtkDrawingArea* area, cairo_t* cr, int width, int height,
         return; // 遊戲介紹模式不需要繪製
     }
 
+    int64_t trace_start = game_trace_begin();
+    gint64 frame_start = g_get_monotonic_time();
+    GameAllocSubsystem alloc_scope = game_alloc_enter(ALLOC_SUB_RENDER);
+
+    // 介面層的顯示狀態
+    GameDrawInfo info = { { snake_hidden[0], snake_hidden[1] }, game_started, countdown, show_go, NULL };
+
     switch (current_mode) {
     case MODE_SINGLE:
-        draw_single_mode(cr, width, height, CELL_SIZE); // 繪製單人模式
+        if (endless_enabled) {
+            info.badge = "   [無盡模式]";
+            game_draw_world(cr, &world, &info, width, height, CELL_SIZE); // 只繪製鏡頭內的區塊
+            break;
+        }
+        info.badge = autopilot_enabled ? "   [自動駕駛]" : NULL;
+        game_draw_single(cr, &game, &info, width, height, CELL_SIZE); // 繪製單人模式
         break;
     case MODE_MULTI:
-        draw_multi_mode(cr, width, height, CELL_SIZE);  // 繪製雙人模式
+        if (spectate_enabled) {
+            // 收到第一個關鍵影格前顯示本機的空局面；死亡的蛇不再繪製
+            if (spectate_view.game.width > 0) {
+                for (int i = 0; i < MAX_PLAYERS; i++) info.hidden[i] = !spectate_view.game.players[i].alive;
+                info.badge = spectate_view.synced ? " [觀戰]" : " [觀戰·同步中]";
+                game_draw_multi(cr, &spectate_view.game, &info, width, height, CELL_SIZE);
+            }
+            else {
+                info.badge = " [等待串流]";
+                game_draw_multi(cr, &game, &info, width, height, CELL_SIZE);
+            }
+            break;
+        }
+        if (net_enabled) {
+            info.badge = lockstep.phase == LOCKSTEP_CONNECTING ? " [等待連線]"
+                : (lockstep.rollback_frames > 0
+                    ? (autopilot_enabled ? " [網路回溯對戰·自動駕駛]" : " [網路回溯對戰]")
+                    : (autopilot_enabled ? " [網路對戰·自動駕駛]" : " [網路對戰]"));
+        }
+        else {
+            info.badge = autopilot_enabled ? " [電腦對手]" : NULL;
+        }
+        game_draw_multi(cr, &game, &info, width, height, CELL_SIZE);  // 繪製雙人模式
         break;
     default:
         break;
     }
+
+    // 效能疊加層：先記錄這個畫面，再繪製疊加層 (不計入畫面時間)
+    gint64 frame_end = g_get_monotonic_time();
+    game_perf_push(&perf, PERF_FRAME, (float)(frame_end - frame_start) / 1000.0f);
+    if (perf_last_frame_at) {
+        game_perf_push(&perf, PERF_FRAME_INTERVAL, (float)(frame_start - perf_last_frame_at) / 1000.0f);
+    }
+    perf_last_frame_at = frame_start;
+    track_latency_frame(area, frame_end);
+    if (perf.visible) game_draw_perf(cr, &perf, width, PERF_FRAME_BUDGET_MS);
+    game_alloc_leave(alloc_scope);
+
+    // 再來一局後的第一個倒數畫面：記錄反應時間並與一個畫面的時間比較
+    if (rematch_requested_at && !game_started) {
+        gint64 latency = g_get_monotonic_time() - rematch_requested_at;
+        gint64 frame_interval = 0;
+        GdkFrameClock* clock = gtk_widget_get_frame_clock(GTK_WIDGET(area));
+        if (clock) {
+            gdk_frame_clock_get_refresh_info(clock, gdk_frame_clock_get_frame_time(clock),
+                &frame_interval, NULL);
+        }
+        if (frame_interval <= 0) frame_interval = G_USEC_PER_SEC / 60; // 無法取得時以60Hz計算
+        if (latency > rematch_latency_max) rematch_latency_max = latency;
+        g_print("rematch: %.2f ms to first countdown frame (frame %.2f ms, max %.2f ms)%s\n",
+            latency / 1000.0, frame_interval / 1000.0, rematch_latency_max / 1000.0,
+            latency > frame_interval ? " [over budget]" : "");
+        rematch_requested_at = 0;
+    }
+    game_trace_end("frame", "draw", trace_start, (int32_t)current_mode);
 }
 
 //==============================================================
@@ -1821,30 +2159,85 @@ static gboolean on_key_press(GtkEventControllerKey* controller,
     guint keyval, guint keycode,
     GdkModifierType state,
     gpointer user_data)
+{
+    int64_t trace_start = game_trace_begin();
+    gint64 handled_at = g_get_monotonic_time();
+
+    // 記錄處理前的方向，處理後實際改變方向的按鍵交給延遲統計 (網路模式比較本機的輸入)
+    Direction before[MAX_PLAYERS];
+    for (int i = 0; i < MAX_PLAYERS; i++) before[i] = game.players[i].next_direction;
+    Direction net_before = lockstep.local_dir;
+    Direction world_before = world.next_direction;
+
+    gboolean handled = handle_key_press(keyval);
+
+    if ((current_mode == MODE_SINGLE || current_mode == MODE_MULTI) && game_started && !spectate_enabled) {
+        GdkEvent* event = gtk_event_controller_get_current_event(GTK_EVENT_CONTROLLER(controller));
+        bool stamped = false;
+        gint64 key_at = event
+            ? game_latency_event_time(gdk_event_get_time(event), handled_at, &stamped)
+            : handled_at;
+        for (int i = 0; i < (current_mode == MODE_SINGLE ? 1 : MAX_PLAYERS); i++) {
+            const Player* pl = &game.players[i];
+            GameLatencyMode mode = current_mode == MODE_SINGLE ? LATENCY_MODE_SINGLE : LATENCY_MODE_MULTI;
+            Direction dir = pl->next_direction;
+            gboolean turned = dir != before[i] && dir != pl->direction;
+            if (current_mode == MODE_SINGLE && endless_enabled) {
+                // 無盡模式的蛇在 world 中，以 game_world_turn 轉向
+                mode = LATENCY_MODE_ENDLESS;
+                dir = world.next_direction;
+                turned = dir != world_before && dir != world.direction;
+            }
+            else if (net_enabled) {
+                // 網路模式只有本機的蛇，轉向在輸入延遲之後才出現在局面中
+                if (i != net_player) continue;
+                mode = LATENCY_MODE_NET;
+                dir = lockstep.local_dir;
+                turned = dir != net_before && dir != pl->direction;
+            }
+            if (!turned) continue;
+            if (!stamped) input_latency.unstamped++;
+            game_latency_key(&input_latency, mode, i, dir, key_at, handled_at);
+        }
+    }
+    game_trace_end("input", "key", trace_start, (int32_t)keyval);
+    return handled;
+}
+
+// 依按鍵更新遊戲狀態
+static gboolean handle_key_press(guint keyval)
 {
     // 在遊戲開始後、非暫停、未結束時，才處理轉向
     if ((current_mode == MODE_SINGLE || current_mode == MODE_MULTI)
         && game_started && !paused && !game_over)
     {
-        // 單人模式下的方向控制
-        if (current_mode == MODE_SINGLE) {
+        // 單人模式下的方向控制 (自動駕駛開啟時忽略)
+        if (current_mode == MODE_SINGLE && endless_enabled) {
             switch (keyval) {
-            case GDK_KEY_Up:
-                if (next_direction_single != GDK_KEY_Down)
-                    next_direction_single = GDK_KEY_Up;
-                break;
-            case GDK_KEY_Down:
-                if (next_direction_single != GDK_KEY_Up)
-                    next_direction_single = GDK_KEY_Down;
-                break;
-            case GDK_KEY_Left:
-                if (next_direction_single != GDK_KEY_Right)
-                    next_direction_single = GDK_KEY_Left;
-                break;
-            case GDK_KEY_Right:
-                if (next_direction_single != GDK_KEY_Left)
-                    next_direction_single = GDK_KEY_Right;
-                break;
+            case GDK_KEY_Up:    game_world_turn(&world, DIR_UP);    break;
+            case GDK_KEY_Down:  game_world_turn(&world, DIR_DOWN);  break;
+            case GDK_KEY_Left:  game_world_turn(&world, DIR_LEFT);  break;
+            case GDK_KEY_Right: game_world_turn(&world, DIR_RIGHT); break;
+            }
+        }
+        else if (current_mode == MODE_SINGLE && !autopilot_enabled) {
+            switch (keyval) {
+            case GDK_KEY_Up:    game_turn(&game, 0, DIR_UP);    break;
+            case GDK_KEY_Down:  game_turn(&game, 0, DIR_DOWN);  break;
+            case GDK_KEY_Left:  game_turn(&game, 0, DIR_LEFT);  break;
+            case GDK_KEY_Right: game_turn(&game, 0, DIR_RIGHT); break;
+            }
+        }
+        // 觀戰模式：沒有可以控制的蛇
+        else if (current_mode == MODE_MULTI && spectate_enabled) {
+        }
+        // 網路雙人模式：WASD 與方向鍵都控制本機的蛇 (自動駕駛開啟時忽略)，在輸入延遲之後才套用
+        else if (current_mode == MODE_MULTI && net_enabled) {
+            switch (autopilot_enabled ? 0 : keyval) {
+            case GDK_KEY_w: case GDK_KEY_W: case GDK_KEY_Up:    game_lockstep_set_input(&lockstep, DIR_UP);    break;
+            case GDK_KEY_s: case GDK_KEY_S: case GDK_KEY_Down:  game_lockstep_set_input(&lockstep, DIR_DOWN);  break;
+            case GDK_KEY_a: case GDK_KEY_A: case GDK_KEY_Left:  game_lockstep_set_input(&lockstep, DIR_LEFT);  break;
+            case GDK_KEY_d: case GDK_KEY_D: case GDK_KEY_Right: game_lockstep_set_input(&lockstep, DIR_RIGHT); break;
             }
         }
         // 雙人模式下的方向控制
@@ -1853,43 +2246,91 @@ static gboolean on_key_press(GtkEventControllerKey* controller,
             switch (keyval) {
             case GDK_KEY_w:
             case GDK_KEY_W:
-                if (next_direction1 != GDK_KEY_Down)
-                    next_direction1 = GDK_KEY_Up;
+                game_turn(&game, 0, DIR_UP);
                 break;
             case GDK_KEY_s:
             case GDK_KEY_S:
-                if (next_direction1 != GDK_KEY_Up)
-                    next_direction1 = GDK_KEY_Down;
+                game_turn(&game, 0, DIR_DOWN);
                 break;
             case GDK_KEY_a:
             case GDK_KEY_A:
-                if (next_direction1 != GDK_KEY_Right)
-                    next_direction1 = GDK_KEY_Left;
+                game_turn(&game, 0, DIR_LEFT);
                 break;
             case GDK_KEY_d:
             case GDK_KEY_D:
-                if (next_direction1 != GDK_KEY_Left)
-                    next_direction1 = GDK_KEY_Right;
+                game_turn(&game, 0, DIR_RIGHT);
                 break;
             }
-            // 玩家2 => 方向鍵
-            switch (keyval) {
-            case GDK_KEY_Up:
-                if (next_direction2 != GDK_KEY_Down) next_direction2 = GDK_KEY_Up;
-                break;
-            case GDK_KEY_Down:
-                if (next_direction2 != GDK_KEY_Up)   next_direction2 = GDK_KEY_Down;
-                break;
-            case GDK_KEY_Left:
-                if (next_direction2 != GDK_KEY_Right) next_direction2 = GDK_KEY_Left;
-                break;
-            case GDK_KEY_Right:
-                if (next_direction2 != GDK_KEY_Left)  next_direction2 = GDK_KEY_Right;
-                break;
+            // 玩家2 => 方向鍵 (自動駕駛開啟時忽略)
+            switch (autopilot_enabled ? 0 : keyval) {
+            case GDK_KEY_Up:    game_turn(&game, 1, DIR_UP);    break;
+            case GDK_KEY_Down:  game_turn(&game, 1, DIR_DOWN);  break;
+            case GDK_KEY_Left:  game_turn(&game, 1, DIR_LEFT);  break;
+            case GDK_KEY_Right: game_turn(&game, 1, DIR_RIGHT); break;
             }
         }
     }
 
+    // P 鍵切換自動駕駛，開啟時距離場從目前的局面重新同步 (電腦玩家只會走有邊界的網格，無盡模式停用)
+    if (((current_mode == MODE_SINGLE && !endless_enabled) || (current_mode == MODE_MULTI && !spectate_enabled))
+        && !paused && !game_over && (keyval == GDK_KEY_p || keyval == GDK_KEY_P))
+    {
+        autopilot_enabled = !autopilot_enabled;
+        if (autopilot_enabled && current_mode == MODE_SINGLE) single_recordable = FALSE;
+        game_bot_reset(&autopilot);
+        game_bot_reset(&opponent);
+        prepare_bots();
+        gtk_widget_queue_draw(current_mode == MODE_SINGLE ? canvas_single : canvas_multi);
+        return TRUE;
+    }
+
+    // F5 快速存檔、F9 快速讀檔 (網路對戰、觀戰與無盡模式由 quick_save / quick_load 拒絕)
+    if (keyval == GDK_KEY_F5) {
+        quick_save();
+        return TRUE;
+    }
+    if (keyval == GDK_KEY_F9) {
+        quick_load();
+        return TRUE;
+    }
+
+    // F10 輸出目前的統計快照 (所有執行緒的分區加總)
+    if (keyval == GDK_KEY_F10) {
+        GameMetricsSnapshot snapshot;
+        game_metrics_read(&snapshot);
+        game_metrics_write_snapshot(&snapshot, stdout);
+        game_latency_write(&input_latency, stdout);
+        if (current_mode == MODE_SINGLE && endless_enabled) game_world_write_stats(&world, stdout);
+        if (game_alloc_enabled()) {
+            GameAllocSnapshot alloc_snapshot;
+            game_alloc_read(&alloc_snapshot);
+            game_alloc_write(&alloc_snapshot, stdout);
+        }
+        return TRUE;
+    }
+
+    // F3 切換效能疊加層
+    if (keyval == GDK_KEY_F3) {
+        perf.visible = !perf.visible;
+        if (current_mode == MODE_SINGLE) gtk_widget_queue_draw(canvas_single);
+        else if (current_mode == MODE_MULTI) gtk_widget_queue_draw(canvas_multi);
+        return TRUE;
+    }
+
+    // F12 寫出目前的效能追蹤 (設置 SNAKE_TRACE 時)
+    if (keyval == GDK_KEY_F12 && trace_path) {
+        dump_trace();
+        return TRUE;
+    }
+
+    // 遊戲結束畫面：R 鍵再來一局 (Enter 由預設焦點的「再來一局」按鈕處理)
+    if ((current_mode == MODE_SINGLE || current_mode == MODE_MULTI) && game_over
+        && (keyval == GDK_KEY_r || keyval == GDK_KEY_R))
+    {
+        on_rematch_clicked(NULL, NULL);
+        return TRUE;
+    }
+
     // ESC鍵用於暫停/繼續遊戲
     if ((current_mode == MODE_SINGLE || current_mode == MODE_MULTI)
         && !game_over)
@@ -1903,20 +2344,13 @@ static gboolean on_key_press(GtkEventControllerKey* controller,
                 gtk_window_destroy(GTK_WINDOW(pause_dialog));
                 pause_dialog = NULL;
 
-                // 恢復遊戲背景音樂
-                if (game_background_music) {
-                    gst_element_set_state(game_background_music->pipeline, GST_STATE_PLAYING);
-                }
-
                 // 恢復倒數音效
                 if (countdown_music) {
                     gst_element_set_state(countdown_music->pipeline, GST_STATE_PLAYING);
                 }
 
-                // 恢復倒數計時器 (如果遊戲尚未開始)
-                if (!game_started && (countdown > 0 || show_go == FALSE)) {
-                    countdown_timer_id = g_timeout_add(500, countdown_tick, NULL);
-                }
+                // 以暫停前的剩餘時間恢復倒數與移動定時器
+                resume_game_timers();
             }
             return TRUE; // 表示事件已處理
         }
@@ -1933,9 +2367,10 @@ static void on_single_mode_clicked(GtkButton* button, gpointer user_data)
 {
     GtkStack* stack_ptr = GTK_STACK(user_data);
     current_mode = MODE_SINGLE; // 設置當前模式為單人模式
+    endless_enabled = FALSE;
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 停止主選單背景音樂
     stop_main_menu_music();
@@ -1943,29 +2378,30 @@ static void on_single_mode_clicked(GtkButton* button, gpointer user_data)
     // 初始化單人遊戲
     init_single_game();
 
-    // 從GtkStack中移除之前的單人模式視圖（若存在）
-    GtkWidget* existing_game_single = gtk_stack_get_child_by_name(stack_ptr, "game_single");
-    if (existing_game_single) {
-        gtk_stack_remove(stack_ptr, existing_game_single);
-    }
+    // 顯示已建立好的單人模式視圖 (不重建繪圖區域)
+    gtk_widget_queue_draw(canvas_single);
+    gtk_stack_set_visible_child_name(stack_ptr, "game_single");
+}
 
-    // 創建新的繪圖區域
-    GtkWidget* new_canvas = gtk_drawing_area_new();
-    gtk_widget_set_size_request(new_canvas, 1800, 900); // 設置畫布大小
-    gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(new_canvas),
-        draw_game, NULL, NULL); // 設置繪圖回調函式
+// 無盡模式按鈕的回調函式
+static void on_endless_mode_clicked(GtkButton* button, gpointer user_data)
+{
+    GtkStack* stack_ptr = GTK_STACK(user_data);
+    current_mode = MODE_SINGLE; // 無盡模式使用單人模式的畫面與流程
+    endless_enabled = TRUE;
+    autopilot_enabled = FALSE;  // 無盡模式沒有自動駕駛
 
-    // 創建水平容器並添加畫布
-    GtkWidget* container = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
-    gtk_widget_set_hexpand(container, TRUE);
-    gtk_widget_set_vexpand(container, TRUE);
-    gtk_widget_set_halign(container, GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(container, GTK_ALIGN_CENTER);
-    gtk_box_append(GTK_BOX(container), new_canvas);
+    // 播放按鈕點擊音效
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
+
+    // 停止主選單背景音樂
+    stop_main_menu_music();
+
+    // 初始化無盡模式 (種子與倒數與單人模式相同)
+    init_single_game();
 
-    // 將新畫布加入到GtkStack並顯示
-    gtk_stack_add_named(stack_ptr, container, "game_single");
-    canvas_single = new_canvas;
+    // 顯示已建立好的單人模式視圖 (不重建繪圖區域)
+    gtk_widget_queue_draw(canvas_single);
     gtk_stack_set_visible_child_name(stack_ptr, "game_single");
 }
 
@@ -1976,7 +2412,7 @@ static void on_multi_mode_clicked(GtkButton* button, gpointer user_data)
     current_mode = MODE_MULTI; // 設置當前模式為雙人模式
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 停止主選單背景音樂
     stop_main_menu_music();
@@ -1984,30 +2420,33 @@ static void on_multi_mode_clicked(GtkButton* button, gpointer user_data)
     // 初始化雙人遊戲
     init_multi_game();
 
-    // 從GtkStack中移除之前的雙人模式視圖（若存在）
-    GtkWidget* existing_game_multi = gtk_stack_get_child_by_name(stack_ptr, "game_multi");
-    if (existing_game_multi) {
-        gtk_stack_remove(stack_ptr, existing_game_multi);
-    }
+    // 顯示已建立好的雙人模式視圖 (不重建繪圖區域)
+    gtk_widget_queue_draw(canvas_multi);
+    gtk_stack_set_visible_child_name(stack_ptr, "game_multi");
+}
 
-    // 創建新的繪圖區域
-    GtkWidget* new_canvas = gtk_drawing_area_new();
-    gtk_widget_set_size_request(new_canvas, 1800, 900); // 設置畫布大小
-    gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(new_canvas),
-        draw_game, NULL, NULL); // 設置繪圖回調函式
+// 再來一局：以相同模式重新開始，只重置遊戲狀態
+static void on_rematch_clicked(GtkButton* button, gpointer user_data)
+{
+    if (!game_over || (current_mode != MODE_SINGLE && current_mode != MODE_MULTI)) return;
 
-    // 創建水平容器並添加畫布
-    GtkWidget* container = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
-    gtk_widget_set_hexpand(container, TRUE);
-    gtk_widget_set_vexpand(container, TRUE);
-    gtk_widget_set_halign(container, GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(container, GTK_ALIGN_CENTER);
-    gtk_box_append(GTK_BOX(container), new_canvas);
+    // 從按下到第一個倒數畫面的時間，在 draw_game 中量測
+    rematch_requested_at = g_get_monotonic_time();
 
-    // 將新畫布加入到GtkStack並顯示
-    gtk_stack_add_named(stack_ptr, container, "game_multi");
-    canvas_multi = new_canvas;
-    gtk_stack_set_visible_child_name(stack_ptr, "game_multi");
+    // 播放按鈕點擊音效
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
+
+    GtkStack* stack_ptr = GTK_STACK(stack);
+    if (current_mode == MODE_SINGLE) {
+        init_single_game();
+        gtk_widget_queue_draw(canvas_single);
+        gtk_stack_set_visible_child_name(stack_ptr, "game_single");
+    }
+    else {
+        init_multi_game();
+        gtk_widget_queue_draw(canvas_multi);
+        gtk_stack_set_visible_child_name(stack_ptr, "game_multi");
+    }
 }
 
 // 遊戲介紹按鈕的回調函式
@@ -2017,7 +2456,7 @@ static void on_intro_mode_clicked(GtkButton* button, gpointer user_data)
     current_mode = MODE_INTRO; // 設置當前模式為遊戲介紹
 
     // 播放按鈕點擊音效
-    play_sound_effect("Musics/button_click.mp3", FALSE, 1.0); // 不循環
+    play_sound_effect(SOUND_BUTTON_CLICK, FALSE, 1.0); // 不循環
 
     // 停止主選單背景音樂
     stop_main_menu_music();
@@ -2045,6 +2484,7 @@ static void show_main_menu(void)
 static gboolean bus_call(GstBus* bus, GstMessage* msg, gpointer data)
 {
     SoundData* sound_data = (SoundData*)data;
+    GameAllocSubsystem alloc_scope = game_alloc_enter(ALLOC_SUB_AUDIO);
 
     switch (GST_MESSAGE_TYPE(msg)) {
     case GST_MESSAGE_EOS: // 當音效播放結束
@@ -2052,7 +2492,6 @@ static gboolean bus_call(GstBus* bus, GstMessage* msg, gpointer data)
             // 如果設定為循環，則重新播放
             gst_element_seek_simple(sound_data->pipeline, GST_FORMAT_TIME,
                 GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, 0);
-            g_print("Looping sound: Playing in loop\n");
         }
         else {
             // 否則停止播放並釋放資源
@@ -2092,120 +2531,174 @@ static gboolean bus_call(GstBus* bus, GstMessage* msg, gpointer data)
         break;
     }
 
+    game_alloc_leave(alloc_scope);
     return TRUE;
 }
 
-// 播放音效的函式
-static SoundData* play_sound_effect(const char* filename, gboolean loop, float volume_level)
+// 音效管線的同步訊息：串流執行緒開始時把它的配置歸入音效
+static GstBusSyncReply on_audio_sync_message(GstBus* bus, GstMessage* msg, gpointer data)
 {
-    // 檢查音效檔案是否存在
-    if (!g_file_test(filename, G_FILE_TEST_EXISTS)) {
-        g_printerr("Error: 音效檔案不存在: %s\n", filename);
-        return NULL;
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+        GstStreamStatusType type;
+        gst_message_parse_stream_status(msg, &type, NULL);
+        if (type == GST_STREAM_STATUS_TYPE_ENTER) game_alloc_enter(ALLOC_SUB_AUDIO);
     }
+    return GST_BUS_PASS;
+}
 
-    // 創建 SoundData 結構
-    SoundData* sound_data = (SoundData*)malloc(sizeof(SoundData));
-    if (!sound_data) {
-        g_printerr("Failed to allocate memory for SoundData.\n");
-        return NULL;
+// 載入所有內嵌音效，之後播放時直接使用快取的 GBytes
+static gboolean load_sound_assets(void)
+{
+    gboolean ok = TRUE;
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        GError* err = NULL;
+        sound_assets[i] = g_resources_lookup_data(sound_asset_paths[i],
+            G_RESOURCE_LOOKUP_FLAGS_NONE, &err);
+        if (!sound_assets[i]) {
+            g_printerr("Error: 找不到內嵌音效 %s: %s\n", sound_asset_paths[i], err->message);
+            g_error_free(err);
+            ok = FALSE;
+        }
     }
-    sound_data->loop = loop;
+    return ok;
+}
 
-    // 創建 GStreamer 的 Pipeline 元件
-    GstElement* pipeline = gst_pipeline_new(NULL);
-    if (!pipeline) {
-        g_printerr("Failed to create GStreamer pipeline.\n");
-        free(sound_data);
-        return NULL;
-    }
-    sound_data->pipeline = pipeline;
+// 播放音效的函式
+static SoundData* play_sound_effect(SoundAsset asset, gboolean loop, float volume_level)
+{
+    int64_t trace_start = game_trace_begin();
+    GameAllocSubsystem alloc_scope = game_alloc_enter(ALLOC_SUB_AUDIO);
+    SoundData* sound_data = create_sound_effect(asset, loop, volume_level);
+    game_alloc_leave(alloc_scope);
+    game_trace_end("audio", "pipeline", trace_start, (int32_t)asset);
+    return sound_data;
+}
 
-    // 創建必要的 GStreamer 元件
-    GstElement* filesrc = gst_element_factory_make("filesrc", "file-source");       // 檔案來源
-    GstElement* decodebin = gst_element_factory_make("decodebin", "decoder");      // 解碼器
-    GstElement* audioconvert = gst_element_factory_make("audioconvert", "converter"); // 音頻轉換器
-    GstElement* audioresample = gst_element_factory_make("audioresample", "resampler"); // 音頻重採樣器
-    GstElement* volume = gst_element_factory_make("volume", "volume");             // 音量控制器
-    GstElement* sink = gst_element_factory_make("autoaudiosink", "audio-output");  // 音頻輸出
+// 在移動定時器中要求播放音效的函式
+static void queue_sound_effect(SoundAsset asset)
+{
+    pending_sounds |= 1u << asset;
+}
 
-    if (!filesrc || !decodebin || !audioconvert || !audioresample || !volume || !sink) {
-        g_printerr("Failed to create GStreamer elements.\n");
-        gst_object_unref(pipeline);
-        free(sound_data);
-        return NULL;
+// 播放定時器中累積的音效的閒置回調
+static gboolean play_queued_sounds(gpointer data)
+{
+    guint sounds = pending_sounds;
+    pending_sounds = 0;
+    pending_sounds_source = 0;
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        if (sounds & (1u << i)) play_sound_effect((SoundAsset)i, FALSE, 1.0); // 不循環
     }
+    return G_SOURCE_REMOVE;
+}
 
-    // 設置檔案來源的屬性
-    g_object_set(G_OBJECT(filesrc), "location", filename, NULL);
-
-    // 設置音量
-    g_object_set(G_OBJECT(volume), "volume", volume_level, NULL);
-
-    // 將元素添加到 Pipeline 中
-    gst_bin_add_many(GST_BIN(pipeline), filesrc, decodebin, audioconvert, audioresample, volume, sink, NULL);
-
-    // 連接 filesrc 到 decodebin
-    if (!gst_element_link(filesrc, decodebin)) {
-        g_printerr("Failed to link filesrc to decodebin.\n");
-        gst_object_unref(pipeline);
-        free(sound_data);
+// 建立並啟動音效管線
+static SoundData* create_sound_effect(SoundAsset asset, gboolean loop, float volume_level)
+{
+    // 檢查音效資料是否已載入
+    GBytes* bytes = (asset >= 0 && asset < SOUND_COUNT) ? sound_assets[asset] : NULL;
+    if (!bytes) {
+        g_printerr("Error: 音效資源未載入: %d\n", (int)asset);
         return NULL;
     }
 
-    // 連接 decodebin 的 pad 到 audioconvert
-    g_signal_connect(decodebin, "pad-added", G_CALLBACK(on_pad_added), audioconvert);
+    // 創建 SoundData 結構
+    SoundData* sound_data = (SoundData*)malloc(sizeof(SoundData));
+    if (!sound_data) {
+        g_printerr("Failed to allocate memory for SoundData.\n");
+        return NULL;
+    }
+    sound_data->loop = loop;
+    sound_data->bytes = bytes;
+    sound_data->offset = 0;
 
-    // 連接 audioconvert -> audioresample -> volume -> sink
-    if (!gst_element_link_many(audioconvert, audioresample, volume, sink, NULL)) {
-        g_printerr("Failed to link audio elements to sink.\n");
-        gst_object_unref(pipeline);
+    // 建立 appsrc → 解碼 → 音量 → 音頻輸出的管線
+    if (!game_audio_pipeline_new(sound_data, volume_level, gst_element_factory_make("autoaudiosink", "audio-output"))) {
         free(sound_data);
         return NULL;
     }
+    GstElement* pipeline = sound_data->pipeline;
 
     // 獲取 Bus 並添加 bus watch 以處理訊息
     GstBus* bus = gst_element_get_bus(pipeline);
+    if (game_alloc_enabled()) gst_bus_set_sync_handler(bus, on_audio_sync_message, NULL, NULL);
     gst_bus_add_watch(bus, bus_call, sound_data);
     gst_object_unref(bus);
 
     // 開始播放
     GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
     if (ret == GST_STATE_CHANGE_FAILURE) {
-        g_printerr("Failed to set pipeline to PLAYING for file: %s\n", filename);
+        g_printerr("Failed to set pipeline to PLAYING for asset: %s\n", sound_asset_paths[asset]);
         gst_object_unref(pipeline);
         free(sound_data);
         return NULL;
     }
 
+    // 效能疊加層的音效數：管線最後一次釋放 (播放結束、出錯或停止背景音樂) 時減一
+    g_atomic_int_inc(&perf.voices);
+    g_object_weak_ref(G_OBJECT(pipeline), on_voice_finalized, NULL);
+
     // 返回 SoundData 結構
     return sound_data;
 }
 
-// 解碼器 pad 新增回調，用於動態連接解碼後的音頻流
-static void on_pad_added(GstElement* src, GstPad* new_pad, gpointer data)
+// 音效管線已釋放
+static void on_voice_finalized(gpointer data, GObject* pipeline)
 {
-    GstElement* audioconvert = (GstElement*)data; // 獲取 audioconvert 元件
-    GstPad* sink_pad = gst_element_get_static_pad(audioconvert, "sink"); // 獲取 sink pad
-    GstPadLinkReturn ret;
-
-    if (gst_pad_is_linked(sink_pad)) {
-        gst_object_unref(sink_pad);
-        return; // 如果已經連接，則不做任何操作
-    }
-
-    // 嘗試連接新 pad 到 audioconvert 的 sink pad
-    ret = gst_pad_link(new_pad, sink_pad);
-    if (GST_PAD_LINK_FAILED(ret)) {
-        g_printerr("Failed to link decodebin to audioconvert.\n");
-    }
-
-    gst_object_unref(sink_pad);
+    g_atomic_int_add(&perf.voices, -1);
 }
 
 //==============================================================
 // [ 程式入口點 activate & main ]
 //==============================================================
+// 建立遊戲畫面 (繪圖區域與容器)，只在啟動時建立一次
+static GtkWidget* create_game_page(GtkWidget** canvas_out)
+{
+    // 創建繪圖區域
+    GtkWidget* new_canvas = gtk_drawing_area_new();
+    gtk_widget_set_size_request(new_canvas, 1800, 900); // 設置畫布大小
+    gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(new_canvas),
+        draw_game, NULL, NULL); // 設置繪圖回調函式
+
+    // 創建水平容器並添加畫布
+    GtkWidget* container = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+    gtk_widget_set_hexpand(container, TRUE);
+    gtk_widget_set_vexpand(container, TRUE);
+    gtk_widget_set_halign(container, GTK_ALIGN_CENTER);
+    gtk_widget_set_valign(container, GTK_ALIGN_CENTER);
+    gtk_box_append(GTK_BOX(container), new_canvas);
+
+    *canvas_out = new_canvas;
+    return container;
+}
+
+// 建立遊戲結束畫面，結果文字在每局結束時更新
+static GtkWidget* create_game_over_page(GtkWidget** label_out, GtkWidget** rematch_out)
+{
+    // 創建垂直容器
+    GtkWidget* game_over_vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 20);
+    gtk_widget_set_halign(game_over_vbox, GTK_ALIGN_CENTER);
+    gtk_widget_set_valign(game_over_vbox, GTK_ALIGN_CENTER);
+
+    // 結果標籤
+    GtkWidget* label = gtk_label_new("");
+    gtk_box_append(GTK_BOX(game_over_vbox), label);
+
+    // 添加「再來一局」按鈕
+    GtkWidget* rematch_btn = gtk_button_new_with_label("再來一局 (Enter / R)");
+    gtk_box_append(GTK_BOX(game_over_vbox), rematch_btn);
+    g_signal_connect(rematch_btn, "clicked", G_CALLBACK(on_rematch_clicked), NULL);
+
+    // 添加「返回主選單」按鈕
+    GtkWidget* back_btn = gtk_button_new_with_label("返回主選單");
+    gtk_box_append(GTK_BOX(game_over_vbox), back_btn);
+    g_signal_connect(back_btn, "clicked", G_CALLBACK(on_back_to_menu_clicked), NULL);
+
+    *label_out = label;
+    *rematch_out = rematch_btn;
+    return game_over_vbox;
+}
+
 // GtkApplication的activate回調函式，負責創建和初始化主視窗及其他視圖
 static void activate(GtkApplication* app, gpointer user_data)
 {
@@ -2256,6 +2749,11 @@ static void activate(GtkApplication* app, gpointer user_data)
     gtk_box_append(GTK_BOX(main_menu), single_btn);
     g_signal_connect(single_btn, "clicked", G_CALLBACK(on_single_mode_clicked), stack);
 
+    // 添加「無盡模式」按鈕
+    GtkWidget* endless_btn = gtk_button_new_with_label("無盡模式");
+    gtk_box_append(GTK_BOX(main_menu), endless_btn);
+    g_signal_connect(endless_btn, "clicked", G_CALLBACK(on_endless_mode_clicked), stack);
+
     // 添加「雙人模式」按鈕
     GtkWidget* multi_btn = gtk_button_new_with_label("雙人模式 (玩家1 vs 玩家2)");
     gtk_box_append(GTK_BOX(main_menu), multi_btn);
@@ -2290,10 +2788,13 @@ static void activate(GtkApplication* app, gpointer user_data)
         "1. 蛇會自動移動，玩家需要透過改變方向來避開障礙物和蛇身。\n"
         "2. 撞到牆壁、障礙物或自身會導致蛇死亡遊戲結束。\n"
         "3. 單人模式與一般貪食蛇玩法相同。\n"
-        "4. 雙人模式吃越多果實，分數越高同時速度變慢。\n\n"
+        "4. 雙人模式吃越多果實，分數越高同時速度變慢。\n"
+        "5. 無盡模式沒有邊界，畫面跟著蛇移動，可以一直往任何方向前進。\n\n"
         "【操作說明】\n"
         "1. 單人模式： 玩家 (綠色蛇) 使用方向鍵控制。\n"
-        "2. 雙人模式：玩家1 (綠色蛇) 使用WASD鍵控制，玩家2 (橘色蛇) 使用方向鍵控制。\n\n"
+        "2. 雙人模式：玩家1 (綠色蛇) 使用WASD鍵控制，玩家2 (橘色蛇) 使用方向鍵控制。\n"
+        "3. P 鍵切換自動駕駛：單人模式由電腦接手，雙人模式由電腦 (樹搜尋) 擔任玩家2。\n"
+        "4. F5 快速存檔，F9 快速讀檔。\n\n"
         "【獲勝條件】\n"
         "1. 單人模式：盡可能的吃果實，打破自己的最佳紀錄吧！！。\n"
         "2. 雙人模式：優先以分數高的獲勝，同分數情況下，則以存活時間久的獲勝。\n\n"
@@ -2313,6 +2814,14 @@ static void activate(GtkApplication* app, gpointer user_data)
     // 將遊戲介紹視圖加入到GtkStack
     gtk_stack_add_named(GTK_STACK(stack), intro_vbox, "game_intro");
 
+    // 建立遊戲畫面與結束畫面，之後每局重複使用
+    gtk_stack_add_named(GTK_STACK(stack), create_game_page(&canvas_single), "game_single");
+    gtk_stack_add_named(GTK_STACK(stack), create_game_page(&canvas_multi), "game_multi");
+    gtk_stack_add_named(GTK_STACK(stack),
+        create_game_over_page(&game_over_label_single, &rematch_btn_single), "game_over_single");
+    gtk_stack_add_named(GTK_STACK(stack),
+        create_game_over_page(&game_over_label_multi, &rematch_btn_multi), "game_over_multi");
+
     // 設置預設顯示為主選單
     gtk_stack_set_visible_child_name(GTK_STACK(stack), "main_menu");
 
@@ -2322,23 +2831,161 @@ static void activate(GtkApplication* app, gpointer user_data)
     gtk_widget_add_controller(window, controller);
 
     // 播放主選單背景音樂 (循環，音量一半)
-    main_menu_music = play_sound_effect("Musics/main_menu_background.mp3", TRUE, 0.5); // 循環且音量一半
+    main_menu_music = play_sound_effect(SOUND_MAIN_MENU_BACKGROUND, TRUE, 0.5); // 循環且音量一半
 
     // 顯示主視窗
     gtk_window_present(GTK_WINDOW(window));
 }
 
+//==============================================================
+// [ 環境變數 ]
+//==============================================================
+// 解析環境變數中的一個整數欄位 (不使用 sscanf，MSVC 的 /sdl 把它視為錯誤)
+static gboolean parse_env_int(const gchar* text, int* out)
+{
+    gint64 value;
+    if (!text || !g_ascii_string_to_signed(text, 10, G_MININT, G_MAXINT, &value, NULL)) return FALSE;
+    *out = (int)value;
+    return TRUE;
+}
+
 //==============================================================
 // [ 程式入口點 WinMain ]
 //==============================================================
 // 程式的入口點，負責初始化和運行GTK應用程序
 int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
     setlocale(LC_ALL, ""); // 設置本地化環境
-    srand((unsigned int)time(NULL)); // 初始化隨機數生成器
+
+    // 設置 SNAKE_ALLOC_STATS 環境變數時記錄記憶體配置 (在其他初始化之前開始，包含 GTK 與 GStreamer 的配置)
+    if (g_getenv("SNAKE_ALLOC_STATS")) {
+        if (!game_alloc_start()) g_printerr("alloc: allocation hooks need a debug CRT build, only explicit records are counted\n");
+        game_alloc_enter(ALLOC_SUB_UI); // 主執行緒預設為介面
+    }
+
+    // 一次配置遊戲狀態的記憶體區塊，之後每局只重置
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) {
+        g_printerr("Failed to allocate game arena.\n");
+        return 1;
+    }
+    game_seed(&game, (uint64_t)time(NULL)); // 初始化隨機數生成器 (亂數狀態隨快照保存)
+    arena_stats_enabled = g_getenv("SNAKE_ARENA_STATS") != NULL;
+
+    // 自動駕駛每一步最多思考 1 毫秒，未完成的距離場更新留到下一步；電腦對手每一步搜尋 5 毫秒
+    game_bot_init(&autopilot, "autopilot");
+    autopilot.budget_us = 1000;
+    game_bot_init(&opponent, "mcts");
+    opponent.budget_us = 5000;
+    opponent.rng_state = (uint64_t)time(NULL) | 1;
 
     // 初始化GStreamer
     gst_init(NULL, NULL);
 
+    // 載入內嵌音效 (與工作目錄無關)
+    load_sound_assets();
+
+    // 在背景執行緒載入最高分紀錄
+    scores_path = g_build_filename(g_get_user_data_dir(), "SnakeHero", "scores.log", NULL);
+    gchar* scores_dir = g_path_get_dirname(scores_path);
+    g_mkdir_with_parents(scores_dir, 0755);
+    g_free(scores_dir);
+    scores_queue = g_async_queue_new();
+    scores_thread = g_thread_new("scores", scores_worker, NULL);
+
+    // 設置 SNAKE_METRICS 環境變數時，每局結束把統計摘要附加到該檔案 (.csv 或 JSON lines)
+    const gchar* metrics_env = g_getenv("SNAKE_METRICS");
+    if (metrics_env && *metrics_env) metrics_path = g_strdup(metrics_env);
+
+    // 設置 SNAKE_PERF_OVERLAY 環境變數時一開始就顯示效能疊加層 (F3 切換)
+    perf.visible = g_getenv("SNAKE_PERF_OVERLAY") != NULL;
+
+    // 設置 SNAKE_WAKEUP_STATS 環境變數時，每秒輸出一次喚醒統計
+    wakeup_stats_enabled = g_getenv("SNAKE_WAKEUP_STATS") != NULL;
+
+    // 設置 SNAKE_TRACE 環境變數時記錄效能追蹤，按 F12 或結束時寫到該路徑
+    const gchar* trace_env = g_getenv("SNAKE_TRACE");
+    if (trace_env && *trace_env) {
+        trace_path = g_strdup(trace_env);
+        game_trace_start(0);
+        game_trace_thread_name("main");
+    }
+
+    // 設置 SNAKE_NET 環境變數時，雙人模式改為網路對戰 (SNAKE_NET_SHIM=延遲:抖動:遺失率% 模擬網路狀況)
+    const gchar* net_env = g_getenv("SNAKE_NET");
+    if (net_env && *net_env) {
+        char host[64] = "";
+        int local_port = 0, remote_port = 0;
+        gchar** parts = g_strsplit(net_env, ":", 6);
+        guint fields = g_strv_length(parts);
+        gboolean parsed = (fields == 4 || fields == 5)
+            && parse_env_int(parts[0], &net_player)
+            && parse_env_int(parts[1], &local_port)
+            && *parts[2] && g_strlcpy(host, parts[2], sizeof(host)) < sizeof(host)
+            && parse_env_int(parts[3], &remote_port)
+            && (fields < 5 || parse_env_int(parts[4], &net_delay));
+        g_strfreev(parts);
+        if (parsed
+            && game_net_startup()
+            && game_net_open(&net_socket, local_port)
+            && game_net_resolve(host, remote_port, &net_peer))
+        {
+            net_player = net_player ? 1 : 0;
+            net_enabled = TRUE;
+            const gchar* shim = g_getenv("SNAKE_NET_SHIM");
+            int latency = 0, jitter = 0;
+            double loss = 0.0;
+            gchar** shim_parts = shim ? g_strsplit(shim, ":", 3) : NULL;
+            if (shim_parts && parse_env_int(shim_parts[0], &latency)) {
+                if (shim_parts[1]) parse_env_int(shim_parts[1], &jitter);
+                if (shim_parts[1] && shim_parts[2]) loss = g_ascii_strtod(shim_parts[2], NULL);
+                game_net_set_shim(&net_socket, latency, jitter, loss / 100.0, (uint64_t)time(NULL));
+            }
+            g_strfreev(shim_parts);
+            // 回溯模式不需要輸入延遲，沒有指定時本機輸入立即生效
+            const gchar* rollback = g_getenv("SNAKE_NET_ROLLBACK");
+            if (rollback && *rollback) {
+                int frames = 0;
+                if (parse_env_int(rollback, &frames) && frames >= 0 && frames <= GAME_LOCKSTEP_MAX_ROLLBACK) {
+                    net_rollback = frames;
+                    if (net_rollback > 0 && fields < 5) net_delay = 0;
+                }
+                else {
+                    g_printerr("Invalid SNAKE_NET_ROLLBACK (0..%d frames): %s\n", GAME_LOCKSTEP_MAX_ROLLBACK, rollback);
+                }
+            }
+            g_print("net: player %d on port %d, peer %s:%d, input delay %d moves%s\n",
+                net_player + 1, net_socket.port, host, remote_port, net_delay, net_rollback > 0 ? ", rollback" : "");
+        }
+        else {
+            g_printerr("Invalid SNAKE_NET (player:local_port:host:remote_port[:delay]): %s\n", net_env);
+        }
+    }
+
+    // 設置 SNAKE_SPECTATE 環境變數時 (且不是網路對戰)，雙人模式改為觀看伺服器上的對局
+    const gchar* spectate_env = g_getenv("SNAKE_SPECTATE");
+    if (!net_enabled && spectate_env && *spectate_env) {
+        char host[64] = "";
+        int port = 0, room = 0;
+        gchar** parts = g_strsplit(spectate_env, ":", 4);
+        guint fields = g_strv_length(parts);
+        gboolean parsed = (fields == 2 || fields == 3)
+            && *parts[0] && g_strlcpy(host, parts[0], sizeof(host)) < sizeof(host)
+            && parse_env_int(parts[1], &port)
+            && (fields < 3 || (parse_env_int(parts[2], &room) && room >= 0));
+        g_strfreev(parts);
+        if (parsed
+            && game_net_startup()
+            && game_net_open(&spectate_socket, 0)
+            && game_net_resolve(host, port, &spectate_server))
+        {
+            spectate_room = (uint32_t)room;
+            spectate_enabled = TRUE;
+            g_print("spectate: server %s:%d, room %u%s\n", host, port, spectate_room, spectate_room ? "" : " (any)");
+        }
+        else {
+            g_printerr("Invalid SNAKE_SPECTATE (host:port[:room]): %s\n", spectate_env);
+        }
+    }
+
     // 創建GtkApplication
     GtkApplication* app = gtk_application_new(
         "com.example.snakegame",
@@ -2350,5 +2997,53 @@ int APIENTRY WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
     // 運行應用程序
     int status = g_application_run(G_APPLICATION(app), 0, NULL);
     g_object_unref(app); // 釋放應用程序對象
+
+    // 等待背景執行緒寫完所有成績
+    scores_post(SCORE_JOB_QUIT, NULL);
+    g_thread_join(scores_thread);
+    g_async_queue_unref(scores_queue);
+    scores_queue = NULL;
+    if (scores) {
+        game_scores_free(scores);
+        g_free(scores);
+        scores = NULL;
+    }
+    g_free(scores_path);
+
+    // 結束時輸出整個執行期間的統計
+    if (metrics_path) {
+        GameMetricsSnapshot snapshot;
+        game_metrics_read(&snapshot);
+        game_metrics_write_snapshot(&snapshot, stdout);
+        g_free(metrics_path);
+        metrics_path = NULL;
+    }
+    game_metrics_shutdown();
+    game_latency_write(&input_latency, stdout);
+    if (game_alloc_enabled()) {
+        GameAllocSnapshot alloc_snapshot;
+        game_alloc_stop();
+        game_alloc_read(&alloc_snapshot);
+        game_alloc_write(&alloc_snapshot, stdout);
+    }
+    game_bot_free(&autopilot);
+    game_bot_free(&opponent);
+    game_state_free(&game);
+    if (net_enabled) {
+        game_lockstep_free(&lockstep);
+        game_net_close(&net_socket);
+        game_net_cleanup();
+    }
+    if (spectate_enabled) {
+        game_spectate_view_free(&spectate_view);
+        game_net_close(&spectate_socket);
+        game_net_cleanup();
+    }
+    if (trace_path) {
+        dump_trace();
+        game_trace_shutdown();
+        g_free(trace_path);
+        trace_path = NULL;
+    }
     return status;
 }
@@ -0,0 +1,177 @@
+// 遊戲迴圈零配置的回歸測試 (Linux，無介面)。
+// 以 -DGAME_ALLOC_INTERPOSE 建置 game_alloc，攔截整個程式的 malloc / calloc / realloc / free，
+// 依介面層的順序執行每一次移動要做的事 (電腦玩家思考、game_step_player、統計、延遲追蹤與效能疊加層的記錄)，
+// 每一次移動都包在 game_alloc_tick_begin / game_alloc_tick_end 之中；
+// 開局與結算在移動之外 (倒數與結束畫面階段，電腦玩家在開局時以 game_bot_prepare 預先配置)，只列入統計。
+// 任何一次移動之中有配置時列出該次移動並以狀態碼1結束。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -DGAME_ALLOC_INTERPOSE -Iinclude source/tools/alloc_check.c source/game_alloc.c source/game_metrics.c source/game_latency.c source/game_perf.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o alloc_check -lm
+//   ./alloc_check [-n 每個情境的移動數] [-s 種子]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_metrics.h"
+#include "game_latency.h"
+#include "game_perf.h"
+#include "game_alloc.h"
+
+// 列出的有配置的移動數
+#define REPORT_LIMIT 10
+// 一局的移動數上限 (電腦玩家不會死亡時也要經過開局，檢查重建障礙物的牆層)
+#define GAME_TICK_LIMIT 2000
+
+//========================[ 結構定義 ]========================
+// 測試情境
+typedef struct {
+    const char* name;
+    int players;              // 1: 單人，2: 雙人
+    const char* bots[2];      // 每位玩家的電腦玩家 (NULL 表示以隨機按鍵轉向)
+} CheckScenario;
+
+static const CheckScenario scenarios[] = {
+    { "single/keys", 1, { NULL, NULL } },
+    { "single/autopilot", 1, { "autopilot", NULL } },
+    { "multi/keys", 2, { NULL, NULL } },
+    { "multi/mcts", 2, { NULL, "mcts" } },
+};
+
+//==============================================================
+// [ 模擬 ]
+//==============================================================
+// 執行一個情境，返回有配置的移動數
+static long run_scenario(const CheckScenario* sc, long ticks, uint64_t seed, GameLatency* latency, GamePerf* perf)
+{
+    GameState game;
+    GameBot bots[2];
+    bool has_bot[2] = { false, false };
+    GameMetricsGame summary;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return -1;
+    for (int p = 0; p < sc->players; p++) {
+        if (sc->bots[p]) has_bot[p] = game_bot_init(&bots[p], sc->bots[p]);
+    }
+    if (has_bot[0]) bots[0].budget_us = 1000;
+    if (has_bot[1]) bots[1].budget_work = 200; // 以模擬次數限制，結果與機器速度無關
+    game_seed(&game, seed);
+    uint64_t rng = seed | 1;
+
+    long dirty = 0, games = 0, game_ticks = 0;
+    int64_t clock_us = 0;
+    for (long t = 0; t < ticks; t++) {
+        // 開局與結算在移動之外
+        if (t == 0 || game_all_dead(&game) || game_ticks >= GAME_TICK_LIMIT) {
+            if (t > 0) {
+                game_alloc_set_phase(ALLOC_PHASE_GAME_OVER);
+                game_metrics_game_end(&summary, &game);
+            }
+            game_alloc_set_phase(ALLOC_PHASE_COUNTDOWN);
+            if (sc->players == 1) game_new_single(&game);
+            else game_new_multi(&game);
+            game_metrics_game_begin(&summary, sc->name, seed, sc->players, 0);
+            game_latency_clear_inflight(latency);
+            for (int p = 0; p < sc->players; p++) {
+                if (!has_bot[p]) continue;
+                game_bot_reset(&bots[p]);
+                game_bot_prepare(&bots[p], &game);
+            }
+            game_alloc_set_phase(ALLOC_PHASE_PLAYING);
+            games++;
+            game_ticks = 0;
+        }
+        game_ticks++;
+
+        int player = sc->players == 1 ? 0 : (int)(t & 1);
+        if (!game.players[player].alive) player ^= 1;
+        clock_us += 50000;
+
+        // 移動之間的按鍵 (介面執行緒的事件處理，不在移動之中)
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        if (!has_bot[player] && (rng >> 60) < 4) {
+            Direction dir = (Direction)((rng >> 58) & 3);
+            Direction before = game.players[player].next_direction;
+            game_turn(&game, player, dir);
+            if (game.players[player].next_direction != before) {
+                game_latency_key(latency, sc->players == 1 ? LATENCY_MODE_SINGLE : LATENCY_MODE_MULTI,
+                    player, game.players[player].next_direction, clock_us, clock_us);
+            }
+        }
+
+        // 一次移動：與介面層的移動定時器相同的工作
+        GameAllocSubsystem previous = game_alloc_enter(ALLOC_SUB_SIM);
+        game_alloc_tick_begin();
+        if (has_bot[player]) game_turn(&game, player, bots[player].decide(&game, player, &bots[player]));
+        GameEvent ev = game_step_player(&game, player);
+        game_metrics_game_tick(&summary, &game, player, ev);
+        game_latency_tick(latency, &game, player, clock_us);
+        game_perf_push(perf, PERF_TICK, 0.1f);
+        uint64_t allocs = game_alloc_tick_end();
+        game_alloc_leave(previous);
+
+        // 繪製 (範圍外)：已套用的轉向在下一次垂直同步呈現
+        game_latency_frame(latency, t, clock_us);
+        game_latency_present(latency, t, clock_us + 16667);
+
+        if (allocs > 0) {
+            if (dirty < REPORT_LIMIT) {
+                printf("%s: tick %ld (game %ld, player %d, event %d, length %d) made %llu allocations\n",
+                    sc->name, t, games, player + 1, (int)ev, game.players[player].body.length,
+                    (unsigned long long)allocs);
+            }
+            dirty++;
+        }
+    }
+    for (int p = 0; p < sc->players; p++) {
+        if (has_bot[p]) game_bot_free(&bots[p]);
+    }
+    game_state_free(&game);
+    printf("%-18s %8ld ticks %6ld games %6ld ticks with allocations\n", sc->name, ticks, games, dirty);
+    return dirty;
+}
+
+//==============================================================
+// [ 主程式 ]
+//==============================================================
+int main(int argc, char** argv)
+{
+    long ticks = 20000;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) ticks = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "-s") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [-n ticks] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!game_alloc_start()) {
+        fprintf(stderr, "allocation hooks unavailable: build with -DGAME_ALLOC_INTERPOSE\n");
+        return 2;
+    }
+
+    // 延遲統計與效能疊加層在介面層是靜態配置
+    static GameLatency latency;
+    static GamePerf perf;
+    game_latency_init(&latency);
+
+    long dirty = 0;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        long d = run_scenario(&scenarios[i], ticks, seed + i, &latency, &perf);
+        if (d < 0) {
+            fprintf(stderr, "out of memory\n");
+            return 2;
+        }
+        dirty += d;
+    }
+
+    game_alloc_stop();
+    GameAllocSnapshot snapshot;
+    game_alloc_read(&snapshot);
+    game_alloc_write(&snapshot, stdout);
+    game_metrics_shutdown();
+    printf("%s\n", dirty == 0 ? "PASS: no allocations inside ticks" : "FAIL: allocations inside ticks");
+    return dirty == 0 ? 0 : 1;
+}
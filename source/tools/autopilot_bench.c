@@ -0,0 +1,160 @@
+// 自動駕駛的效能測試 (Linux，無介面)。
+// 在不同尺寸的網格上讓自動駕駛玩單人遊戲，量測每一步思考的時間 (平均、p99、最大)、
+// 更新結束時仍有未完成工作的比例與得分，並與每一步從食物完整重算距離場的時間比較。
+// 第一步包含配置與同步整個網格，另外列出；最大值同時列出執行緒 CPU 時間，
+// 牆鐘時間的突波通常是執行緒被系統排程搶占，而不是超過思考時間上限。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/autopilot_bench.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o autopilot_bench -lm
+//   ./autopilot_bench [-n 步數] [-b 每步時間上限(微秒，0 表示不限制)] [-s 種子] [寬度 高度 ...]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_pathfind.h"
+
+// 單調時鐘 (微秒)
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 目前執行緒的 CPU 時間 (微秒)
+static double cpu_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 以指定尺寸跑 steps 步 (死亡時以下一個種子重新開局)
+static int run_size(int width, int height, long steps, long budget_us, uint64_t seed)
+{
+    GameState game;
+    if (!game_state_init(&game, width, height)) {
+        fprintf(stderr, "%dx%d: allocation failed\n", width, height);
+        return 1;
+    }
+    GameBot bot;
+    game_bot_init(&bot, "autopilot");
+    bot.budget_us = budget_us;
+
+    double* samples = malloc(sizeof(double) * (size_t)steps);
+    if (!samples) {
+        game_state_free(&game);
+        return 1;
+    }
+
+    game_seed(&game, seed);
+    game_new_single(&game);
+    game_bot_reset(&bot);
+    long games = 1, eaten = 0, best_score = 0;
+    double total = 0.0, first = 0.0, max_cpu = 0.0;
+    for (long i = 0; i < steps; i++) {
+        double t0 = now_us(), c0 = cpu_us();
+        Direction dir = bot.decide(&game, 0, &bot);
+        double c = cpu_us() - c0;
+        samples[i] = now_us() - t0;
+        total += samples[i];
+        if (i == 0) first = samples[i];
+        else if (c > max_cpu) max_cpu = c;
+
+        game_turn(&game, 0, dir);
+        GameEvent ev = game_step_player(&game, 0);
+        if (ev == GAME_EVENT_ATE) eaten++;
+        if (game.players[0].score > best_score) best_score = game.players[0].score;
+        if (ev == GAME_EVENT_DIED) {
+            game_seed(&game, seed + (uint64_t)games);
+            game_new_single(&game);
+            game_bot_reset(&bot);
+            games++;
+        }
+    }
+
+    const PathField* field = (const PathField*)bot.data;
+    unsigned long updates = field ? field->updates : 0;
+    unsigned long unsettled = field ? field->unsettled : 0;
+    unsigned long rebuilds = field ? field->rebuilds : 0;
+
+    // 對照組：在最後的局面上從食物完整重算距離場 (不限工作量與時間)
+    PathField full;
+    double full_us = 0.0;
+    if (path_field_init(&full, width, height)) {
+        full.work_limit = 0x7FFFFFFF;
+        double t0 = now_us();
+        path_field_update(&full, &game);
+        full_us = now_us() - t0;
+        path_field_free(&full);
+    }
+
+    // 統計第一步以外的步數
+    long n = steps - 1;
+    double* rest = samples + 1;
+    if (n < 1) {
+        n = 1;
+        rest = samples;
+    }
+    qsort(rest, (size_t)n, sizeof(double), compare_double);
+    printf("%5dx%-5d  first %8.2f us  mean %7.2f us  p99 %8.2f us  max %8.2f us (cpu %8.2f us)  "
+        "full %10.2f us  unsettled %5.1f%%  rebuilds %5lu  games %4ld  eaten %6ld  best %5ld\n",
+        width, height, first, (total - first) / n, rest[(size_t)(n * 99 / 100)], rest[n - 1], max_cpu,
+        full_us, updates ? 100.0 * unsettled / updates : 0.0, rebuilds, games, eaten, best_score);
+
+    free(samples);
+    game_bot_free(&bot);
+    game_state_free(&game);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    long steps = 20000;
+    long budget_us = 1000;
+    uint64_t seed = 1;
+    int sizes[32][2];
+    int size_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) steps = atol(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) budget_us = atol(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (i + 1 < argc && size_count < 32) {
+            sizes[size_count][0] = atoi(argv[i]);
+            sizes[size_count][1] = atoi(argv[++i]);
+            size_count++;
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n steps] [-b budget_us] [-s seed] [width height ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (size_count == 0) {
+        static const int defaults[4][2] = { { 40, 20 }, { 256, 256 }, { 1024, 1024 }, { 2048, 2048 } };
+        memcpy(sizes, defaults, sizeof(defaults));
+        size_count = 4;
+    }
+    if (steps < 1) steps = 1;
+
+    printf("autopilot: %ld steps per size, budget %ld us per step\n", steps, budget_us);
+    for (int i = 0; i < size_count; i++) {
+        if (sizes[i][0] < 8 || sizes[i][1] < 8) {
+            fprintf(stderr, "invalid size %dx%d\n", sizes[i][0], sizes[i][1]);
+            return 2;
+        }
+        if (run_size(sizes[i][0], sizes[i][1], steps, budget_us, seed) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+// 批次模擬工具 (Linux，無介面)。
+// 每個執行緒擁有一個 GameBatch，同時推進數千局單人遊戲直到全部結束，
+// 輸出每秒完成的局數、每秒移動步數 (總計與每核心) 以及分數與存活時間，
+// 用來調整速度、障礙物與計分。開始前先抽查數百局，確認結果與 GameState 逐局一致。
+//
+// 建置與執行：
+//   gcc -std=c11 -O3 -pthread -Iinclude source/tools/batch_sim.c source/game_batch.c source/game_core.c -o batch_sim
+//   ./batch_sim [-g 每執行緒局數] [-t 執行緒數] [-r 回合數] [-m 最大步數]
+//               [-W 寬度] [-H 高度] [-p greedy|straight] [-s 種子] [--slow]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game_core.h"
+#include "game_batch.h"
+
+// 抽查與 GameState 一致性的局數
+#define VERIFY_GAMES 256
+
+//========================[ 設定 ]========================
+typedef struct {
+    int games;        // 每個執行緒的局數
+    int threads;      // 執行緒數
+    int rounds;       // 每個執行緒重新開局的次數
+    int max_ticks;    // 每回合的最大步數
+    int width, height;
+    int greedy;       // 1: 朝食物前進並避開障礙；0: 不轉向
+    int slow_on_eat;  // 吃到果實是否降低速度
+    uint64_t seed;
+} SimConfig;
+
+// 每個執行緒的結果
+typedef struct {
+    const SimConfig* cfg;
+    int index;
+    uint64_t games;
+    uint64_t ticks;
+    uint64_t score_sum;
+    uint64_t elapsed_sum;
+    int score_max;
+} SimWorker;
+
+// 單調時鐘 (秒)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//==============================================================
+// [ 策略 ]
+//==============================================================
+// 查詢格子是否會造成碰撞
+typedef bool (*BlockedFn)(const void* ctx, int x, int y);
+
+// 沿方向前進一格 (含邊界循環)
+static void step_point(int w, int h, int dir, int* x, int* y)
+{
+    *x += (dir == DIR_RIGHT) - (dir == DIR_LEFT);
+    *y += (dir == DIR_DOWN) - (dir == DIR_UP);
+    if (*x < 0) *x = w - 1; else if (*x >= w) *x = 0;
+    if (*y < 0) *y = h - 1; else if (*y >= h) *y = 0;
+}
+
+// 貪婪策略：依序嘗試朝食物的水平、垂直方向、目前方向與其他方向，選第一個不會碰撞的
+static Direction greedy_policy(int w, int h, int hx, int hy, int dir, int fx, int fy,
+    BlockedFn blocked, const void* ctx)
+{
+    static const int opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    int dx = fx - hx, dy = fy - hy;
+    if (dx > w / 2) dx -= w; else if (dx < -w / 2) dx += w; // 走邊界循環較近時反向
+    if (dy > h / 2) dy -= h; else if (dy < -h / 2) dy += h;
+
+    int order[7] = {
+        dx > 0 ? DIR_RIGHT : DIR_LEFT, dy > 0 ? DIR_DOWN : DIR_UP, dir,
+        DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT
+    };
+    if (dx == 0) order[0] = -1;
+    if (dy == 0) order[1] = -1;
+    for (int i = 0; i < 7; i++) {
+        int d = order[i];
+        if (d < 0 || d == opposite[dir]) continue;
+        int x = hx, y = hy;
+        step_point(w, h, d, &x, &y);
+        if (!blocked(ctx, x, y)) return (Direction)d;
+    }
+    return (Direction)dir;
+}
+
+// 批次版本的碰撞查詢
+typedef struct {
+    const GameBatch* batch;
+    int g;
+} BatchCtx;
+
+static bool batch_blocked(const void* ctx, int x, int y)
+{
+    const BatchCtx* c = (const BatchCtx*)ctx;
+    return game_batch_blocked(c->batch, c->g, x, y);
+}
+
+// GameState 版本的碰撞查詢
+static bool state_blocked(const void* ctx, int x, int y)
+{
+    Point p = { x, y };
+    return game_check_collision((const GameState*)ctx, 0, p);
+}
+
+// 為所有存活的遊戲決定下一步
+static void batch_apply_policy(GameBatch* batch)
+{
+    BatchCtx ctx = { batch, 0 };
+    for (int g = 0; g < batch->count; g++) {
+        if (!batch->alive[g]) continue;
+        ctx.g = g;
+        Direction d = greedy_policy(batch->width, batch->height, batch->head_x[g], batch->head_y[g],
+            batch->direction[g], batch->food_x[g], batch->food_y[g], batch_blocked, &ctx);
+        game_batch_turn(batch, g, d);
+    }
+}
+
+//==============================================================
+// [ 一致性抽查 ]
+//==============================================================
+// 以相同種子與策略分別跑 GameState 與 GameBatch，逐局比較結果
+static int verify_against_state(const SimConfig* cfg)
+{
+    GameBatch batch;
+    GameState game;
+    if (!game_batch_init(&batch, VERIFY_GAMES, cfg->width, cfg->height)) return 0;
+    if (!game_state_init(&game, cfg->width, cfg->height)) {
+        game_batch_free(&batch);
+        return 0;
+    }
+    batch.slow_on_eat = cfg->slow_on_eat;
+    game_batch_reset(&batch, cfg->seed);
+    for (int t = 0; t < cfg->max_ticks && batch.alive_count > 0; t++) {
+        if (cfg->greedy) batch_apply_policy(&batch);
+        game_batch_step(&batch);
+    }
+
+    int mismatches = 0;
+    for (int g = 0; g < VERIFY_GAMES; g++) {
+        game_seed(&game, cfg->seed + (uint64_t)g);
+        game_new_single(&game);
+        game.slow_on_eat = cfg->slow_on_eat;
+        Player* pl = &game.players[0];
+        for (int t = 0; t < cfg->max_ticks && pl->alive; t++) {
+            if (cfg->greedy) {
+                Point h = snake_body_at(&pl->body, 0);
+                game_turn(&game, 0, greedy_policy(game.width, game.height, h.x, h.y, pl->direction,
+                    game.food.x, game.food.y, state_blocked, &game));
+            }
+            // 蛇填滿所有空格時 GameState 無法再生成食物，批次版本會直接結束該局
+            if (pl->body.length + 1 >= batch.open_cells[g]) break;
+            game_step_player(&game, 0);
+        }
+        Point h = snake_body_at(&pl->body, 0);
+        if (pl->score != batch.score[g] || pl->body.length != batch.length[g]
+            || pl->elapsed_ms != batch.elapsed_ms[g] || pl->alive != (batch.alive[g] != 0)
+            || h.x != batch.head_x[g] || h.y != batch.head_y[g]) {
+            if (mismatches < 5) {
+                fprintf(stderr, "game %d differs: score %d/%d length %d/%d elapsed %ld/%d\n", g,
+                    pl->score, batch.score[g], pl->body.length, batch.length[g],
+                    pl->elapsed_ms, batch.elapsed_ms[g]);
+            }
+            mismatches++;
+        }
+    }
+    game_state_free(&game);
+    game_batch_free(&batch);
+    return mismatches == 0;
+}
+
+//==============================================================
+// [ 執行緒 ]
+//==============================================================
+static void* sim_thread(void* arg)
+{
+    SimWorker* wk = (SimWorker*)arg;
+    const SimConfig* cfg = wk->cfg;
+    GameBatch batch;
+    if (!game_batch_init(&batch, cfg->games, cfg->width, cfg->height)) {
+        fprintf(stderr, "thread %d: allocation failed\n", wk->index);
+        return NULL;
+    }
+    batch.slow_on_eat = cfg->slow_on_eat;
+
+    for (int r = 0; r < cfg->rounds; r++) {
+        uint64_t seed = cfg->seed + ((uint64_t)wk->index * cfg->rounds + r) * (uint64_t)cfg->games;
+        game_batch_reset(&batch, seed);
+        for (int t = 0; t < cfg->max_ticks && batch.alive_count > 0; t++) {
+            if (cfg->greedy) batch_apply_policy(&batch);
+            game_batch_step(&batch);
+        }
+        wk->games += (uint64_t)batch.count;
+        wk->ticks += batch.ticks;
+        for (int g = 0; g < batch.count; g++) {
+            wk->score_sum += (uint64_t)batch.score[g];
+            wk->elapsed_sum += (uint64_t)batch.elapsed_ms[g];
+            if (batch.score[g] > wk->score_max) wk->score_max = batch.score[g];
+        }
+    }
+    game_batch_free(&batch);
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    SimConfig cfg = { 4096, 0, 4, 5000, GRID_WIDTH, GRID_HEIGHT, 1, 0, 1 };
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        const char* v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--slow") == 0) { cfg.slow_on_eat = 1; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); return 2; }
+        if (strcmp(a, "-g") == 0) cfg.games = atoi(v);
+        else if (strcmp(a, "-t") == 0) cfg.threads = atoi(v);
+        else if (strcmp(a, "-r") == 0) cfg.rounds = atoi(v);
+        else if (strcmp(a, "-m") == 0) cfg.max_ticks = atoi(v);
+        else if (strcmp(a, "-W") == 0) cfg.width = atoi(v);
+        else if (strcmp(a, "-H") == 0) cfg.height = atoi(v);
+        else if (strcmp(a, "-s") == 0) cfg.seed = strtoull(v, NULL, 10);
+        else if (strcmp(a, "-p") == 0) cfg.greedy = strcmp(v, "straight") != 0;
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+        i++;
+    }
+    if (cfg.threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        cfg.threads = n > 0 ? (int)n : 1;
+    }
+
+    if (!verify_against_state(&cfg)) {
+        fprintf(stderr, "batch results differ from GameState\n");
+        return 1;
+    }
+    printf("verified %d games against GameState\n", VERIFY_GAMES);
+
+    SimWorker* workers = calloc((size_t)cfg.threads, sizeof(SimWorker));
+    pthread_t* tids = calloc((size_t)cfg.threads, sizeof(pthread_t));
+    double t0 = now_sec();
+    for (int i = 0; i < cfg.threads; i++) {
+        workers[i].cfg = &cfg;
+        workers[i].index = i;
+        pthread_create(&tids[i], NULL, sim_thread, &workers[i]);
+    }
+    SimWorker total = { 0 };
+    for (int i = 0; i < cfg.threads; i++) {
+        pthread_join(tids[i], NULL);
+        total.games += workers[i].games;
+        total.ticks += workers[i].ticks;
+        total.score_sum += workers[i].score_sum;
+        total.elapsed_sum += workers[i].elapsed_sum;
+        if (workers[i].score_max > total.score_max) total.score_max = workers[i].score_max;
+    }
+    double secs = now_sec() - t0;
+
+    printf("%dx%d, %d threads x %d games x %d rounds, policy %s%s\n",
+        cfg.width, cfg.height, cfg.threads, cfg.games, cfg.rounds,
+        cfg.greedy ? "greedy" : "straight", cfg.slow_on_eat ? ", slow on eat" : "");
+    printf("games: %llu in %.3f s  ->  %.0f games/s (%.0f per core)\n",
+        (unsigned long long)total.games, secs, total.games / secs, total.games / secs / cfg.threads);
+    printf("ticks: %llu  ->  %.3g ticks/s (%.3g per core)\n",
+        (unsigned long long)total.ticks, total.ticks / secs, total.ticks / secs / cfg.threads);
+    if (total.games > 0) {
+        printf("score: mean %.2f, max %d; survival: mean %.1f s\n",
+            (double)total.score_sum / total.games, total.score_max,
+            (double)total.elapsed_sum / total.games / 1000.0);
+    }
+
+    free(tids);
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,256 @@
+// 強化學習批次環境的吞吐量測試 (Linux，無介面)。
+// 每個執行緒擁有一個 GameEnv 與自己的觀測 / 獎勵緩衝區，以隨機動作推進，
+// 分別量測單人與雙人模式在單執行緒與多執行緒下每秒的環境步數 (env-steps/s)。
+// 開始前先抽查獎勵與分數變化、觀測平面與遊戲狀態是否一致。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/env_bench.c source/game_env.c source/game_core.c -o env_bench
+//   ./env_bench [-e 每執行緒環境數] [-t 執行緒數] [-n 每執行緒 step 次數] [-W 寬度] [-H 高度] [--no-obs]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game_core.h"
+#include "game_env.h"
+
+// 抽查一致性的 step 次數
+#define VERIFY_STEPS 2000
+
+//========================[ 設定 ]========================
+typedef struct {
+    int envs;         // 每個執行緒的環境數
+    int threads;      // 執行緒數
+    long steps;       // 每個執行緒的 step 次數
+    int width, height;
+    bool write_obs;   // 是否寫入觀測值
+} Config;
+
+typedef struct {
+    const Config* cfg;
+    int players;
+    int index;
+    uint64_t env_steps;
+    uint64_t episodes;
+    bool ok;
+} Worker;
+
+// 單調時鐘 (秒)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 隨機動作：約九成保持方向
+static void random_actions(uint8_t* actions, size_t n, uint64_t* rng)
+{
+    for (size_t k = 0; k < n; k++) {
+        int r = game_rng_next(rng, 40);
+        actions[k] = (uint8_t)(r < 4 ? r : GAME_ENV_NOOP);
+    }
+}
+
+//==============================================================
+// [ 一致性抽查 ]
+//==============================================================
+// 獎勵必須等於分數變化與死亡，觀測平面必須與遊戲狀態相同
+static bool verify(int players, int width, int height)
+{
+    const int count = 16;
+    GameEnv env;
+    if (!game_env_init(&env, count, players, width, height)) return false;
+    size_t words = game_env_obs_words(&env);
+    size_t agents = (size_t)count * players;
+    uint64_t* obs = malloc(agents * words * sizeof(uint64_t));
+    uint8_t* actions = malloc(agents);
+    float* rewards = malloc(agents * sizeof(float));
+    uint8_t* dones = malloc((size_t)count);
+    int* score = malloc(agents * sizeof(int));
+    bool* alive = malloc(agents * sizeof(bool));
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+    bool ok = obs && actions && rewards && dones && score && alive;
+
+    if (ok) game_env_reset(&env, 7, obs);
+    for (int s = 0; ok && s < VERIFY_STEPS; s++) {
+        for (int i = 0; i < count; i++) {
+            for (int p = 0; p < players; p++) {
+                score[i * players + p] = env.games[i].players[p].score;
+                alive[i * players + p] = env.games[i].players[p].alive;
+            }
+        }
+        random_actions(actions, agents, &rng);
+        game_env_step(&env, actions, rewards, dones, obs);
+
+        for (int i = 0; i < count && ok; i++) {
+            const GameState* g = &env.games[i];
+            for (int p = 0; p < players && !dones[i]; p++) {
+                const Player* pl = &g->players[p];
+                float expect = (float)(pl->score - score[i * players + p]) * env.reward_food;
+                if (alive[i * players + p] && !pl->alive) expect += env.reward_death;
+                if (rewards[i * players + p] != expect) {
+                    fprintf(stderr, "verify: env %d player %d step %d reward %.1f, expected %.1f\n",
+                        i, p, s, rewards[i * players + p], expect);
+                    ok = false;
+                }
+            }
+            // 每個格子的每個平面都與遊戲狀態比對
+            for (int p = 0; p < players && ok; p++) {
+                const uint64_t* planes = obs + ((size_t)i * players + p) * words;
+                for (int y = 0; y < height && ok; y++) {
+                    for (int x = 0; x < width && ok; x++) {
+                        Point c = { x, y };
+                        bool own = false, other = false, head = false;
+                        for (int q = 0; q < players; q++) {
+                            const Player* pl = &g->players[q];
+                            if (!pl->alive) continue;
+                            for (int k = 0; k < pl->body.length; k++) {
+                                Point b = snake_body_at(&pl->body, k);
+                                if (b.x != x || b.y != y) continue;
+                                if (q == p) own = true;
+                                else other = true;
+                                if (q == p && k == 0) head = true;
+                            }
+                        }
+                        bool expect[GAME_ENV_PLANES] = {
+                            game_hits_obstacle(g, c), own, other, g->food.x == x && g->food.y == y, head
+                        };
+                        for (int k = 0; k < GAME_ENV_PLANES; k++) {
+                            if (game_env_bit(planes + (size_t)k * env.plane_words, width, x, y) != expect[k]) {
+                                fprintf(stderr, "verify: env %d player %d plane %d mismatch at (%d, %d)\n",
+                                    i, p, k, x, y);
+                                ok = false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("verify %s mode: %s (%d steps x %d envs, %llu episodes)\n",
+        players == 1 ? "single" : "multi", ok ? "ok" : "FAILED", VERIFY_STEPS, count,
+        (unsigned long long)env.episodes);
+    free(alive);
+    free(score);
+    free(dones);
+    free(rewards);
+    free(actions);
+    free(obs);
+    game_env_free(&env);
+    return ok;
+}
+
+//==============================================================
+// [ 吞吐量 ]
+//==============================================================
+static void* worker_main(void* arg)
+{
+    Worker* wk = (Worker*)arg;
+    const Config* cfg = wk->cfg;
+    GameEnv env;
+    if (!game_env_init(&env, cfg->envs, wk->players, cfg->width, cfg->height)) return NULL;
+
+    // 所有緩衝區在開始前配置一次，step 期間不再配置
+    size_t agents = (size_t)cfg->envs * wk->players;
+    uint64_t* obs = cfg->write_obs ? malloc(agents * game_env_obs_words(&env) * sizeof(uint64_t)) : NULL;
+    uint8_t* actions = malloc(agents);
+    float* rewards = malloc(agents * sizeof(float));
+    uint8_t* dones = malloc((size_t)cfg->envs);
+    uint64_t rng = 0x2545F4914F6CDD1Dull * (2 * (uint64_t)wk->index + 1);
+
+    if ((!cfg->write_obs || obs) && actions && rewards && dones) {
+        game_env_reset(&env, 1 + (uint64_t)wk->index * (uint64_t)cfg->envs, obs);
+        for (long s = 0; s < cfg->steps; s++) {
+            random_actions(actions, agents, &rng);
+            game_env_step(&env, actions, rewards, dones, obs);
+        }
+        wk->env_steps = env.steps;
+        wk->episodes = env.episodes;
+        wk->ok = true;
+    }
+
+    free(dones);
+    free(rewards);
+    free(actions);
+    free(obs);
+    game_env_free(&env);
+    return NULL;
+}
+
+// 以指定的執行緒數量測，返回每秒環境步數
+static double run(const Config* cfg, int players, int threads)
+{
+    pthread_t* tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    Worker* workers = calloc((size_t)threads, sizeof(Worker));
+    double t0 = now_sec();
+    for (int t = 0; t < threads; t++) {
+        workers[t].cfg = cfg;
+        workers[t].players = players;
+        workers[t].index = t;
+        pthread_create(&tids[t], NULL, worker_main, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    double secs = now_sec() - t0;
+
+    uint64_t steps = 0, episodes = 0;
+    bool ok = true;
+    for (int t = 0; t < threads; t++) {
+        steps += workers[t].env_steps;
+        episodes += workers[t].episodes;
+        ok = ok && workers[t].ok;
+    }
+    free(workers);
+    free(tids);
+    if (!ok) {
+        fprintf(stderr, "allocation failed\n");
+        return 0.0;
+    }
+
+    double rate = steps / secs;
+    printf("%-6s %2d thread%s  %10llu env-steps in %6.3f s: %12.0f env-steps/s (%11.0f per thread), %8llu episodes\n",
+        players == 1 ? "single" : "multi", threads, threads == 1 ? " " : "s",
+        (unsigned long long)steps, secs, rate, rate / threads, (unsigned long long)episodes);
+    return rate;
+}
+
+int main(int argc, char** argv)
+{
+    Config cfg = { 256, 0, 20000, GRID_WIDTH, GRID_HEIGHT, true };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) cfg.envs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) cfg.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) cfg.steps = atol(argv[++i]);
+        else if (strcmp(argv[i], "-W") == 0 && i + 1 < argc) cfg.width = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) cfg.height = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--no-obs") == 0) cfg.write_obs = false;
+        else {
+            fprintf(stderr, "usage: %s [-e envs] [-t threads] [-n steps] [-W width] [-H height] [--no-obs]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (cfg.threads <= 0) cfg.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (cfg.threads <= 0) cfg.threads = 1;
+    if (cfg.envs <= 0 || cfg.steps <= 0 || cfg.width < 8 || cfg.height < 8) {
+        fprintf(stderr, "invalid arguments\n");
+        return 2;
+    }
+
+    if (!verify(1, cfg.width, cfg.height) || !verify(2, cfg.width, cfg.height)) return 1;
+
+    printf("%d envs per thread, %ld steps per thread, %dx%d board, observations %s\n",
+        cfg.envs, cfg.steps, cfg.width, cfg.height, cfg.write_obs ? "on" : "off");
+    for (int players = 1; players <= MAX_PLAYERS; players++) {
+        double one = run(&cfg, players, 1);
+        if (cfg.threads > 1) {
+            double many = run(&cfg, players, cfg.threads);
+            if (one > 0.0) printf("       speedup %.2fx on %d threads\n", many / one, cfg.threads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,515 @@
+// 黃金重播回歸測試 (Linux，無介面)。
+// 語料中的每個檔案是一局的重播 (game_replay 文字格式：網格、玩家數、種子與輸入序列)，
+// 之後接著每一次移動後的紀錄：移動的玩家、事件、新的蛇頭、長度、分數、移動間隔、食物與局面雜湊。
+// check 以所有核心平行播放整個語料，逐步與紀錄比較，
+// 回報每個檔案第一個不同的移動，列出紀錄與目前結果不同的欄位以及當時的完整局面。
+// 修改規則之後若結果應該改變，以 update 重新產生紀錄；record 以電腦玩家與隨機按鍵產生新的語料。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/golden_replay.c source/game_replay.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o golden_replay -lm
+//   ./golden_replay check  [-t 執行緒數] [目錄或檔案 ...]   (預設 source/tools/golden)
+//   ./golden_replay update [目錄或檔案 ...]                 (以目前的規則重新產生紀錄)
+//   ./golden_replay record [-o 目錄]                        (產生內建的語料)
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_replay.h"
+
+// 預設的語料目錄 (從專案根目錄執行)
+#define GOLDEN_DIR "source/tools/golden"
+#define GOLDEN_SUFFIX ".golden"
+#define GOLDEN_MAX_FILES 1024
+
+//========================[ 結構定義 ]========================
+// 一次移動後的紀錄
+typedef struct {
+    long step;
+    int mover;                // 玩家索引
+    char event;               // N: 移動, A: 吃到果實, D: 死亡
+    Point head;               // 移動後的蛇頭
+    int length, score;        // 移動後的長度與分數
+    int interval;             // 移動後的移動間隔
+    Point food;               // 移動後的食物
+    uint32_t hash;            // game_hash 折成 32 位元
+} GoldenRow;
+
+// 一個語料檔案
+typedef struct {
+    const char* path;
+    GameReplay replay;
+    GoldenRow* rows;
+    long row_count;
+    // 結果
+    bool loaded;
+    bool passed;
+    long steps;               // 實際播放的移動次數
+    char report[2048];        // 不同時的說明
+} GoldenFile;
+
+// 執行緒共用的狀態
+typedef struct {
+    pthread_mutex_t lock;
+    GoldenFile* files;
+    int count;
+    int next;
+} GoldenPool;
+
+// 單調時鐘 (秒)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char golden_events[3] = { 'N', 'A', 'D' };
+
+// 取得移動後的紀錄
+static GoldenRow make_row(const GameState* g, long step, int mover, GameEvent event)
+{
+    GoldenRow r;
+    const Player* pl = &g->players[mover];
+    uint64_t h = game_hash(g);
+    r.step = step;
+    r.mover = mover;
+    r.event = golden_events[event];
+    r.head = snake_body_at(&pl->body, 0);
+    r.length = pl->body.length;
+    r.score = pl->score;
+    r.interval = pl->interval;
+    r.food = g->food;
+    r.hash = (uint32_t)(h ^ (h >> 32));
+    return r;
+}
+
+//==============================================================
+// [ 檔案 ]
+//==============================================================
+// 讀取語料檔案：重播之後是 golden 區段
+static bool golden_load(GoldenFile* f)
+{
+    FILE* in = fopen(f->path, "r");
+    if (!in) {
+        snprintf(f->report, sizeof(f->report), "cannot open: %s", strerror(errno));
+        return false;
+    }
+    bool ok = game_replay_read(&f->replay, in);
+    long capacity = 0;
+    char line[256];
+    while (ok && fgets(line, sizeof(line), in)) {
+        if (line[0] == '#' || strncmp(line, "golden", 6) == 0 || line[0] == '\n') continue;
+        if (f->row_count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            GoldenRow* rows = (GoldenRow*)realloc(f->rows, (size_t)capacity * sizeof(GoldenRow));
+            if (!rows) {
+                ok = false;
+                break;
+            }
+            f->rows = rows;
+        }
+        GoldenRow* r = &f->rows[f->row_count];
+        unsigned hash;
+        if (sscanf(line, "%ld %d %c %d,%d %d %d %d %d,%d %x", &r->step, &r->mover, &r->event,
+                &r->head.x, &r->head.y, &r->length, &r->score, &r->interval, &r->food.x, &r->food.y, &hash) != 11
+            || r->step != f->row_count)
+        {
+            ok = false;
+            break;
+        }
+        r->mover--;
+        r->hash = hash;
+        f->row_count++;
+    }
+    fclose(in);
+    if (!ok) snprintf(f->report, sizeof(f->report), "malformed file");
+    f->loaded = ok;
+    return ok;
+}
+
+// 寫出語料檔案 (重播與以目前規則產生的紀錄)
+static bool golden_save(const char* path, const GameReplay* replay, const char* comment, long* steps)
+{
+    GameState game;
+    GameReplayCursor cursor;
+    if (!game_state_init(&game, replay->width, replay->height)) return false;
+    if (!game_replay_start(&cursor, replay, &game)) {
+        game_state_free(&game);
+        return false;
+    }
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        game_state_free(&game);
+        return false;
+    }
+    if (comment) fprintf(out, "# %s\n", comment);
+    game_replay_write(replay, out);
+    fprintf(out, "golden 1\n");
+    fprintf(out, "# step player event head length score interval food hash\n");
+    GameEvent event;
+    int p;
+    while ((p = game_replay_next(&cursor, &event)) >= 0) {
+        GoldenRow r = make_row(&game, cursor.step - 1, p, event);
+        fprintf(out, "%ld %d %c %d,%d %d %d %d %d,%d %08x\n", r.step, r.mover + 1, r.event,
+            r.head.x, r.head.y, r.length, r.score, r.interval, r.food.x, r.food.y, (unsigned)r.hash);
+    }
+    *steps = cursor.step;
+    bool ok = !ferror(out);
+    fclose(out);
+    game_state_free(&game);
+    return ok;
+}
+
+// 收集路徑：目錄中所有 .golden 檔案 (依名稱排序) 或單一檔案
+static int compare_str(const void* a, const void* b)
+{
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+static int collect(const char* path, char** out, int count)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return count;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        if (count < GOLDEN_MAX_FILES) out[count++] = strdup(path);
+        return count;
+    }
+    DIR* dir = opendir(path);
+    if (!dir) return count;
+    int first = count;
+    struct dirent* e;
+    while ((e = readdir(dir)) && count < GOLDEN_MAX_FILES) {
+        size_t n = strlen(e->d_name), k = strlen(GOLDEN_SUFFIX);
+        if (n <= k || strcmp(e->d_name + n - k, GOLDEN_SUFFIX) != 0) continue;
+        char* full = (char*)malloc(strlen(path) + n + 2);
+        if (!full) break;
+        sprintf(full, "%s/%s", path, e->d_name);
+        out[count++] = full;
+    }
+    closedir(dir);
+    qsort(out + first, (size_t)(count - first), sizeof(char*), compare_str);
+    return count;
+}
+
+//==============================================================
+// [ 比較 ]
+//==============================================================
+// 附加一段說明
+static void append(GoldenFile* f, const char* fmt, ...)
+{
+    size_t used = strlen(f->report);
+    if (used + 1 >= sizeof(f->report)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(f->report + used, sizeof(f->report) - used, fmt, ap);
+    va_end(ap);
+}
+
+// 列出紀錄與目前結果不同的欄位，以及目前的完整局面
+static void report_divergence(GoldenFile* f, const GameState* g, const GoldenRow* want, const GoldenRow* got)
+{
+    append(f, "first divergence after step %ld\n", want->step);
+    append(f, "  %-8s %-14s %-14s\n", "field", "golden", "now");
+#define FIELD(name, fmt, a, b) do { \
+        char x[32], y[32]; snprintf(x, sizeof(x), fmt, a); snprintf(y, sizeof(y), fmt, b); \
+        if (strcmp(x, y) != 0) append(f, "  %-8s %-14s %-14s\n", name, x, y); \
+    } while (0)
+#define POINT(name, a, b) do { \
+        char x[32], y[32]; snprintf(x, sizeof(x), "(%d,%d)", a.x, a.y); snprintf(y, sizeof(y), "(%d,%d)", b.x, b.y); \
+        if (strcmp(x, y) != 0) append(f, "  %-8s %-14s %-14s\n", name, x, y); \
+    } while (0)
+    FIELD("player", "%d", want->mover + 1, got->mover + 1);
+    FIELD("event", "%c", want->event, got->event);
+    POINT("head", want->head, got->head);
+    FIELD("length", "%d", want->length, got->length);
+    FIELD("score", "%d", want->score, got->score);
+    FIELD("interval", "%d", want->interval, got->interval);
+    POINT("food", want->food, got->food);
+    FIELD("hash", "%08x", (unsigned)want->hash, (unsigned)got->hash);
+#undef FIELD
+#undef POINT
+    if (want->mover == got->mover && want->event == got->event && want->head.x == got->head.x
+        && want->head.y == got->head.y && want->length == got->length && want->score == got->score
+        && want->interval == got->interval && want->food.x == got->food.x && want->food.y == got->food.y)
+    {
+        append(f, "  (only the hash differs: a direction, the timing, the obstacles or the RNG state changed)\n");
+    }
+
+    append(f, "  state now: food (%d,%d), rng %016llx, %d obstacles\n",
+        g->food.x, g->food.y, (unsigned long long)g->rng_state, g->obstacle_count);
+    for (int p = 0; p < g->player_count; p++) {
+        const Player* pl = &g->players[p];
+        Point h = snake_body_at(&pl->body, 0);
+        append(f, "  player %d: %s head (%d,%d) dir %d next %d length %d score %d interval %d elapsed %ld survival %ld\n",
+            p + 1, pl->alive ? "alive" : "dead ", h.x, h.y, pl->direction, pl->next_direction,
+            pl->body.length, pl->score, pl->interval, pl->elapsed_ms, pl->survival_ms);
+    }
+}
+
+// 播放一個檔案並與紀錄比較
+static void golden_check(GoldenFile* f, GameState* game)
+{
+    if (!golden_load(f)) return;
+    GameReplayCursor cursor;
+    if (!game_replay_start(&cursor, &f->replay, game)) {
+        snprintf(f->report, sizeof(f->report), "invalid replay settings");
+        return;
+    }
+    GameEvent event;
+    int p;
+    while ((p = game_replay_next(&cursor, &event)) >= 0) {
+        long step = cursor.step - 1;
+        GoldenRow got = make_row(game, step, p, event);
+        if (step >= f->row_count) {
+            append(f, "game continues past the golden record (%ld steps)\n", f->row_count);
+            report_divergence(f, game, &got, &got);
+            f->steps = cursor.step;
+            return;
+        }
+        const GoldenRow* want = &f->rows[step];
+        if (memcmp(&got.head, &want->head, sizeof(Point)) != 0 || got.mover != want->mover || got.event != want->event
+            || got.length != want->length || got.score != want->score || got.interval != want->interval
+            || got.hash != want->hash
+            || memcmp(&got.food, &want->food, sizeof(Point)) != 0)
+        {
+            report_divergence(f, game, want, &got);
+            f->steps = cursor.step;
+            return;
+        }
+    }
+    f->steps = cursor.step;
+    if (cursor.step != f->row_count) {
+        append(f, "game ended after %ld steps, golden record has %ld\n", cursor.step, f->row_count);
+        return;
+    }
+    f->passed = true;
+}
+
+static void* worker_main(void* arg)
+{
+    GoldenPool* pool = (GoldenPool*)arg;
+    GameState game;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return NULL;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        int i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        if (i >= pool->count) break;
+        golden_check(&pool->files[i], &game);
+    }
+    game_state_free(&game);
+    return NULL;
+}
+
+static int run_check(char** paths, int count, int threads)
+{
+    GoldenFile* files = (GoldenFile*)calloc((size_t)count, sizeof(GoldenFile));
+    if (!files) return 2;
+    for (int i = 0; i < count; i++) files[i].path = paths[i];
+
+    GoldenPool pool;
+    pthread_mutex_init(&pool.lock, NULL);
+    pool.files = files;
+    pool.count = count;
+    pool.next = 0;
+    if (threads > count) threads = count;
+    if (threads < 1) threads = 1;
+
+    double t0 = now_sec();
+    pthread_t* tids = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)threads);
+    if (!tids) return 2;
+    for (int t = 0; t < threads; t++) pthread_create(&tids[t], NULL, worker_main, &pool);
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    free(tids);
+    pthread_mutex_destroy(&pool.lock);
+    double elapsed = now_sec() - t0;
+
+    int failed = 0;
+    long steps = 0;
+    for (int i = 0; i < count; i++) {
+        GoldenFile* f = &files[i];
+        steps += f->steps;
+        if (f->passed) {
+            printf("ok   %-48s %6ld steps\n", f->path, f->steps);
+        }
+        else {
+            failed++;
+            printf("FAIL %s\n%s", f->path, f->report);
+            if (f->report[0] && f->report[strlen(f->report) - 1] != '\n') printf("\n");
+        }
+        game_replay_free(&f->replay);
+        free(f->rows);
+    }
+    printf("%d/%d replays match, %ld steps in %.3f s (%d threads)\n", count - failed, count, steps, elapsed, threads);
+    free(files);
+    return failed ? 1 : 0;
+}
+
+// 以目前的規則重新產生紀錄 (保留重播本身)
+static int run_update(char** paths, int count)
+{
+    int status = 0;
+    for (int i = 0; i < count; i++) {
+        GameReplay replay;
+        memset(&replay, 0, sizeof(replay));
+        FILE* in = fopen(paths[i], "r");
+        bool ok = in && game_replay_read(&replay, in);
+        if (in) fclose(in);
+        long steps = 0;
+        if (ok) ok = golden_save(paths[i], &replay, NULL, &steps);
+        printf("%s %s (%ld steps)\n", ok ? "updated" : "FAILED ", paths[i], steps);
+        if (!ok) status = 1;
+        game_replay_free(&replay);
+    }
+    return status;
+}
+
+//==============================================================
+// [ 產生語料 ]
+//==============================================================
+// 內建語料：不同的網格、模式與電腦玩家，另外混入隨機按鍵 (含連按兩次的迴轉)
+typedef struct {
+    const char* name;
+    int width, height;
+    int players;
+    const char* bots[MAX_PLAYERS];
+    uint64_t seed;
+    long max_steps;
+    int noise;                // 每步按下隨機方向的機率為 1/noise (0 表示不加)
+} GoldenSpec;
+
+static const GoldenSpec golden_specs[] = {
+    { "single_greedy",          GRID_WIDTH, GRID_HEIGHT, 1, { "greedy", NULL },        11, 1500, 0 },
+    { "single_autopilot",       GRID_WIDTH, GRID_HEIGHT, 1, { "autopilot", NULL },     12, 1500, 0 },
+    { "single_random_keys",     GRID_WIDTH, GRID_HEIGHT, 1, { "random", NULL },        13, 1500, 3 },
+    { "single_small_wrap",      10, 6,                   1, { "greedy", NULL },        14, 1200, 6 },
+    { "multi_greedy_random",    GRID_WIDTH, GRID_HEIGHT, 2, { "greedy", "random" },    21, 1500, 0 },
+    { "multi_autopilot_greedy", GRID_WIDTH, GRID_HEIGHT, 2, { "autopilot", "greedy" }, 22, 1500, 0 },
+    { "multi_straight_greedy",  GRID_WIDTH, GRID_HEIGHT, 2, { "straight", "greedy" },  23, 1500, 0 },
+    { "multi_random_keys",      GRID_WIDTH, GRID_HEIGHT, 2, { "random", "random" },    24, 1500, 4 },
+    { "multi_small_crowded",    7, 5,                    2, { "greedy", "greedy" },    25, 1200, 5 },
+    { "multi_tiny_grid",        6, 4,                    2, { "random", "greedy" },    26, 1200, 3 },
+};
+
+// 以電腦玩家與隨機按鍵進行一局並記錄輸入
+static bool record_spec(const GoldenSpec* spec, GameReplay* replay)
+{
+    GameState game;
+    if (!game_state_init(&game, spec->width, spec->height)) return false;
+    GameBot bots[MAX_PLAYERS];
+    for (int p = 0; p < spec->players; p++) {
+        game_bot_init(&bots[p], spec->bots[p]);
+        bots[p].rng_state = spec->seed * 2654435761u + (uint64_t)p + 1;
+    }
+    game_replay_init(replay, spec->width, spec->height, spec->players, spec->seed);
+    replay->steps = spec->max_steps;
+    uint64_t rng = spec->seed ^ 0xA5A5A5A5A5A5A5A5ull;
+
+    game_seed(&game, spec->seed);
+    if (spec->players == 1) game_new_single(&game);
+    else game_new_multi(&game);
+    bool ok = true;
+    for (long step = 0; step < spec->max_steps && ok; step++) {
+        int p = game_next_mover(&game);
+        if (p < 0) break;
+        // 任一玩家的隨機按鍵 (可能在同一步連按兩次)
+        if (spec->noise > 0 && game_rng_next(&rng, spec->noise) == 0) {
+            int q = game_rng_next(&rng, spec->players);
+            int presses = 1 + (game_rng_next(&rng, 4) == 0);
+            for (int k = 0; k < presses && ok; k++) {
+                Direction d = (Direction)game_rng_next(&rng, 4);
+                ok = game_replay_add(replay, step, q, d);
+                game_turn(&game, q, d);
+            }
+        }
+        // 沒有隨機按鍵時由電腦玩家決定
+        else {
+            Direction d = bots[p].decide(&game, p, &bots[p]);
+            if (d != game.players[p].next_direction) {
+                ok = game_replay_add(replay, step, p, d);
+                game_turn(&game, p, d);
+            }
+        }
+        game_step_player(&game, p);
+    }
+    for (int p = 0; p < spec->players; p++) game_bot_free(&bots[p]);
+    game_state_free(&game);
+    return ok;
+}
+
+static int run_record(const char* dir)
+{
+    mkdir(dir, 0755);
+    int status = 0;
+    for (size_t i = 0; i < sizeof(golden_specs) / sizeof(golden_specs[0]); i++) {
+        const GoldenSpec* spec = &golden_specs[i];
+        GameReplay replay;
+        char path[512], comment[160];
+        snprintf(path, sizeof(path), "%s/%s%s", dir, spec->name, GOLDEN_SUFFIX);
+        snprintf(comment, sizeof(comment), "%s: %s%s%s, random keys %s", spec->name, spec->bots[0],
+            spec->players > 1 ? " vs " : "", spec->players > 1 ? spec->bots[1] : "",
+            spec->noise ? "on" : "off");
+        long steps = 0;
+        bool ok = record_spec(spec, &replay) && golden_save(path, &replay, comment, &steps);
+        printf("%s %s (%d inputs, %ld steps)\n", ok ? "recorded" : "FAILED  ", path, replay.input_count, steps);
+        if (!ok) status = 1;
+        game_replay_free(&replay);
+    }
+    return status;
+}
+
+//==============================================================
+// [ 主程式 ]
+//==============================================================
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s check [-t threads] [paths...] | update [paths...] | record [-o dir]\n", argv[0]);
+        return 2;
+    }
+    const char* command = argv[1];
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char* out_dir = GOLDEN_DIR;
+    char* paths[GOLDEN_MAX_FILES];
+    int count = 0;
+    bool explicit_paths = false;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_dir = argv[++i];
+        else {
+            count = collect(argv[i], paths, count);
+            explicit_paths = true;
+        }
+    }
+
+    if (strcmp(command, "record") == 0) return run_record(out_dir);
+    if (!explicit_paths) count = collect(GOLDEN_DIR, paths, 0);
+    if (count == 0) {
+        fprintf(stderr, "no %s files found\n", GOLDEN_SUFFIX);
+        return 2;
+    }
+
+    int status;
+    if (strcmp(command, "check") == 0) status = run_check(paths, count, threads);
+    else if (strcmp(command, "update") == 0) status = run_update(paths, count);
+    else {
+        fprintf(stderr, "unknown command: %s\n", command);
+        status = 2;
+    }
+    for (int i = 0; i < count; i++) free(paths[i]);
+    return status;
+}
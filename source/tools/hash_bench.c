@@ -0,0 +1,203 @@
+// 局面雜湊的檢查與效能測試 (Linux，無介面)。
+// 1. 以隨機方向推進多局，每一步確認增量維護的雜湊與重新計算的結果相同，
+//    精簡狀態 (GameSim) 的雜湊與 GameState 相同，快照存讀後雜湊不變。
+// 2. 統計所有步驟的雜湊中是否出現碰撞 (不同步驟得到相同雜湊)。
+// 3. 量測 game_hash 與 game_rehash 的速度。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/hash_bench.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_snapshot.c source/game_core.c -o hash_bench -lm
+//   ./hash_bench [-g 局數] [-s 種子]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_sim.h"
+#include "game_snapshot.h"
+
+// 每局最多步數
+#define MAX_STEPS 4000
+
+// 單調時鐘 (微秒)
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+//==============================================================
+// [ 一致性檢查 ]
+//==============================================================
+// 隨機推進多局並逐步比較雜湊，記錄每一步的雜湊以檢查碰撞
+static bool verify(GameState* game, GameSim* sim, int games, uint64_t seed, uint64_t** hashes, long* count)
+{
+    size_t capacity = 1 << 16;
+    uint64_t* all = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    void* buffer = NULL;
+    size_t buffer_size = 0;
+    GameState loaded;
+    if (!all || !game_state_init(&loaded, GRID_WIDTH, GRID_HEIGHT)) return false;
+    long n = 0;
+    bool ok = true;
+
+    for (int g = 0; g < games && ok; g++) {
+        game_seed(game, seed + (uint64_t)g);
+        if (g % 2 == 0) game_new_multi(game);
+        else game_new_single(game);
+        GameSimWalls* walls = game_sim_walls_from_state(game);
+        game_sim_from_state(sim, game, walls);
+        game_sim_walls_release(walls);
+        uint64_t rng = seed * 131 + (uint64_t)g + 1;
+
+        for (int s = 0; s < MAX_STEPS; s++) {
+            int p = game_next_mover(game);
+            if (p < 0) break;
+            Direction d = (Direction)game_rng_next(&rng, 4);
+            if (game_rng_next(&rng, 4) == 0 || game_bot_safe(game, p, d)) {
+                game_turn(game, p, d);
+                game_sim_turn(sim, p, d);
+            }
+            game_step_player(game, p);
+            game_sim_step(sim, p);
+
+            uint64_t h = game_hash(game);
+            uint64_t incremental = game->body_hash;
+            if (game_rehash(game) != incremental) {
+                fprintf(stderr, "verify: game %d step %d: incremental body hash differs from recomputed\n", g, s);
+                ok = false;
+                break;
+            }
+            if (game_sim_hash(sim) != h) {
+                fprintf(stderr, "verify: game %d step %d: GameSim hash differs from GameState\n", g, s);
+                ok = false;
+                break;
+            }
+            // 每隔一段步數確認快照存讀後雜湊不變
+            if (s % 64 == 0) {
+                size_t size = game_snapshot_size(game);
+                if (size > buffer_size) {
+                    free(buffer);
+                    buffer = malloc(size);
+                    buffer_size = size;
+                }
+                if (!buffer || !game_snapshot_write(game, NULL, buffer, size)
+                    || !game_snapshot_read(&loaded, NULL, buffer, size) || game_hash(&loaded) != h) {
+                    fprintf(stderr, "verify: game %d step %d: hash changed across snapshot\n", g, s);
+                    ok = false;
+                    break;
+                }
+            }
+            if ((size_t)n == capacity) {
+                capacity *= 2;
+                uint64_t* grown = (uint64_t*)realloc(all, capacity * sizeof(uint64_t));
+                if (!grown) {
+                    ok = false;
+                    break;
+                }
+                all = grown;
+            }
+            all[n++] = h;
+        }
+        game_sim_release(sim);
+    }
+
+    free(buffer);
+    game_state_free(&loaded);
+    *hashes = all;
+    *count = n;
+    if (ok) printf("verify: %d games, %ld steps: incremental == recomputed, GameSim == GameState, snapshot stable\n", games, n);
+    return ok;
+}
+
+// 計算相同雜湊出現的次數 (隨機推進的局面幾乎不會重複，碰撞應為0)
+static void report_collisions(uint64_t* hashes, long count)
+{
+    qsort(hashes, (size_t)count, sizeof(uint64_t), compare_u64);
+    long dup = 0;
+    for (long i = 1; i < count; i++) {
+        if (hashes[i] == hashes[i - 1]) dup++;
+    }
+    printf("collisions: %ld duplicate hashes among %ld states\n", dup, count);
+}
+
+//==============================================================
+// [ 效能 ]
+//==============================================================
+static void bench(GameState* game)
+{
+    GameBot greedy;
+    game_bot_init(&greedy, "greedy");
+    game_seed(game, 7);
+    game_new_multi(game);
+    // 讓蛇長到一定的長度
+    for (int s = 0; s < 2000; s++) {
+        int p = game_next_mover(game);
+        if (p < 0) break;
+        game_turn(game, p, greedy.decide(game, p, &greedy));
+        game_step_player(game, p);
+    }
+    game_bot_free(&greedy);
+
+    const long n = 5000000;
+    uint64_t sink = 0;
+    double t0 = now_us();
+    for (long i = 0; i < n; i++) {
+        sink ^= game_hash(game);
+        game->rng_state += 1; // 避免編譯器把呼叫提出迴圈
+    }
+    double hash_us = now_us() - t0;
+
+    const long m = 200000;
+    t0 = now_us();
+    for (long i = 0; i < m; i++) sink ^= game_rehash(game);
+    double rehash_us = now_us() - t0;
+
+    printf("game_hash: %.1f ns   game_rehash: %.1f ns (snake lengths %d + %d)   [%016llx]\n",
+        hash_us * 1000.0 / n, rehash_us * 1000.0 / m,
+        game->players[0].body.length, game->players[1].body.length, (unsigned long long)sink);
+}
+
+int main(int argc, char** argv)
+{
+    int games = 400;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) games = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [-g games] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    GameState game;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return 1;
+    size_t size = game_sim_size(GRID_WIDTH, GRID_HEIGHT);
+    GameSim* sim = (GameSim*)calloc(size / sizeof(uint64_t), sizeof(uint64_t));
+    if (!sim) return 1;
+
+    uint64_t* hashes = NULL;
+    long count = 0;
+    int status = 0;
+    if (!verify(&game, sim, games, seed, &hashes, &count)) status = 1;
+    else {
+        report_collisions(hashes, count);
+        bench(&game);
+    }
+
+    free(hashes);
+    free(sim);
+    game_state_free(&game);
+    return status;
+}
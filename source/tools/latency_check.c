@@ -0,0 +1,249 @@
+// 輸入延遲的無介面測試 (Linux，無介面)。
+// 以虛擬時鐘模擬介面層的事件迴圈：移動定時器依每位玩家目前的移動間隔觸發 (可加上隨機的延遲)，
+// 畫面在垂直同步時開始繪製 (有待重繪時)，繪製完成後的下一次垂直同步呈現。
+// 合成的按鍵以隨機的間隔到達，經過隨機的排隊時間後交給介面執行緒處理，由貪婪玩家決定方向；
+// 改變方向的按鍵與介面層相同地交給 game_latency 追蹤，最後輸出每個模式與玩家的百分位數，
+// 並檢查內部的延遲預算：
+//   處理按鍵到套用轉向 ≤ 最長的移動間隔 + 定時器延遲，套用轉向到呈現 ≤ 2 個畫面 (剛好錯過一次垂直同步)。
+// 超出預算時以狀態碼1結束 (例如 -d 20 讓繪製超過一個畫面)。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/latency_check.c source/game_latency.c source/game_metrics.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o latency_check -lm
+//   ./latency_check [-m single|multi|all] [-n 每位玩家的按鍵數] [-r 更新率Hz] [-d 繪製毫秒] [-q 排隊毫秒] [-j 定時器延遲毫秒] [-s 種子]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_latency.h"
+
+// 按鍵之間的平均間隔 (微秒)
+#define KEY_MEAN_US 180000
+
+//========================[ 結構定義 ]========================
+// 模擬的參數
+typedef struct {
+    long keys;                // 每位玩家的按鍵數
+    int64_t frame_us;         // 垂直同步的間隔
+    int64_t draw_us;          // 繪製一個畫面的時間
+    int64_t queue_us;         // 事件到處理的最長排隊時間
+    int64_t jitter_us;        // 定時器最長的延遲
+    uint64_t seed;
+} CheckConfig;
+
+// 一個模式的模擬結果
+typedef struct {
+    int64_t max_interval_us;  // 模擬中出現過的最長移動間隔
+    long games;               // 開局次數
+} CheckRun;
+
+//==============================================================
+// [ 模擬 ]
+//==============================================================
+static uint64_t rng_state = 1;
+
+// 0~1 的亂數
+static double rand01(void)
+{
+    uint64_t z = (rng_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (double)((z ^ (z >> 31)) >> 11) / 9007199254740992.0;
+}
+
+// 0~max 的亂數 (微秒)
+static int64_t rand_us(int64_t max)
+{
+    return (int64_t)(rand01() * (double)max);
+}
+
+// 開新局
+static void new_game(GameState* game, int players, GameLatency* latency, CheckRun* run)
+{
+    if (players == 1) game_new_single(game);
+    else game_new_multi(game);
+    game_latency_clear_inflight(latency);
+    run->games++;
+}
+
+// 以虛擬時鐘模擬一個模式
+static void simulate(const CheckConfig* cfg, GameLatencyMode mode, GameLatency* latency, CheckRun* run)
+{
+    int players = mode == LATENCY_MODE_SINGLE ? 1 : 2;
+    GameState game;
+    GameBot bot;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT) || !game_bot_init(&bot, "greedy")) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    game_seed(&game, cfg->seed);
+    memset(run, 0, sizeof(*run));
+    new_game(&game, players, latency, run);
+
+    int64_t now = 0;
+    int64_t next_frame = cfg->frame_us;             // 下一次垂直同步
+    int64_t next_tick[MAX_PLAYERS];                 // 下一次移動
+    int64_t key_at[MAX_PLAYERS], handle_at[MAX_PLAYERS];
+    long keys_left[MAX_PLAYERS];
+    bool redraw = true;
+    int64_t frame = 0;
+    int64_t present_frame = -1, present_at = 0;     // 等待呈現的畫面
+    for (int p = 0; p < players; p++) {
+        next_tick[p] = (int64_t)game.players[p].interval * 1000;
+        key_at[p] = rand_us(2 * KEY_MEAN_US);
+        handle_at[p] = key_at[p] + rand_us(cfg->queue_us);
+        keys_left[p] = cfg->keys;
+    }
+
+    for (;;) {
+        bool pending = false;
+        for (int p = 0; p < players; p++) pending = pending || keys_left[p] > 0;
+        if (!pending && game_latency_oldest_frame(latency) < 0) break;
+
+        // 找出最早的事件：垂直同步、移動或按鍵
+        int64_t next = next_frame;
+        for (int p = 0; p < players; p++) {
+            if (next_tick[p] < next) next = next_tick[p];
+            if (keys_left[p] > 0 && handle_at[p] < next) next = handle_at[p];
+        }
+        now = next;
+
+        // 按鍵：與介面層相同，只追蹤實際改變方向的按鍵
+        for (int p = 0; p < players; p++) {
+            if (keys_left[p] <= 0 || handle_at[p] != now) continue;
+            Player* pl = &game.players[p];
+            Direction before = pl->next_direction;
+            game_turn(&game, p, bot.decide(&game, p, &bot));
+            if (pl->next_direction != before && pl->next_direction != pl->direction) {
+                bool ok;
+                int64_t key_us = game_latency_event_time((uint32_t)(key_at[p] / 1000), now, &ok);
+                if (!ok) latency->unstamped++;
+                game_latency_key(latency, mode, p, pl->next_direction, key_us, now);
+                keys_left[p]--;
+            }
+            key_at[p] = now + rand_us(2 * KEY_MEAN_US);
+            handle_at[p] = key_at[p] + rand_us(cfg->queue_us);
+        }
+
+        // 移動：依目前的移動間隔排程下一次，加上隨機的定時器延遲
+        for (int p = 0; p < players; p++) {
+            if (next_tick[p] != now) continue;
+            GameEvent ev = game_step_player(&game, p);
+            game_latency_tick(latency, &game, p, now);
+            redraw = true;
+            int64_t interval = (int64_t)game.players[p].interval * 1000;
+            if (interval > run->max_interval_us) run->max_interval_us = interval;
+            next_tick[p] = now + interval + rand_us(cfg->jitter_us);
+            if (ev == GAME_EVENT_DIED) {
+                new_game(&game, players, latency, run);
+                for (int q = 0; q < players; q++) next_tick[q] = now + (int64_t)game.players[q].interval * 1000;
+                break;
+            }
+        }
+
+        // 垂直同步：先呈現上一個畫面，再開始繪製新的畫面
+        if (now == next_frame) {
+            if (present_frame >= 0 && present_at <= now) {
+                game_latency_present(latency, present_frame, present_at);
+                present_frame = -1;
+            }
+            int64_t next_vsync = now + cfg->frame_us;
+            if (redraw && present_frame < 0) {
+                int64_t drawn = now + cfg->draw_us;
+                frame++;
+                game_latency_frame(latency, frame, drawn);
+                // 繪製完成後的下一次垂直同步呈現，繪製超過一個畫面時下一個畫面也跟著延後
+                present_frame = frame;
+                present_at = now + cfg->frame_us;
+                while (present_at < drawn) present_at += cfg->frame_us;
+                next_vsync = present_at;
+                redraw = false;
+            }
+            next_frame = next_vsync;
+        }
+    }
+    game_bot_free(&bot);
+    game_state_free(&game);
+}
+
+//==============================================================
+// [ 預算檢查 ]
+//==============================================================
+// 檢查一個模式的延遲預算
+static bool check_budget(const CheckConfig* cfg, const GameLatency* latency, GameLatencyMode mode,
+    int players, const CheckRun* run)
+{
+    int64_t tick_budget = run->max_interval_us + cfg->jitter_us;
+    int64_t frame_budget = 2 * cfg->frame_us;
+    bool ok = true;
+    for (int p = 0; p < players; p++) {
+        const GameMetricsHistogram* h = latency->histograms[mode][p];
+        uint64_t tick_max = h[LATENCY_STAGE_TICK].max, frame_max = h[LATENCY_STAGE_FRAME].max;
+        bool tick_ok = tick_max <= (uint64_t)tick_budget;
+        bool frame_ok = frame_max <= (uint64_t)frame_budget;
+        printf("%s player %d: %llu turns; tick max %.2f ms (budget %.2f) %s; frame max %.2f ms (budget %.2f) %s\n",
+            game_latency_mode_name(mode), p + 1, (unsigned long long)h[LATENCY_STAGE_TOTAL].count,
+            tick_max / 1000.0, tick_budget / 1000.0, tick_ok ? "ok" : "OVER",
+            frame_max / 1000.0, frame_budget / 1000.0, frame_ok ? "ok" : "OVER");
+        if (h[LATENCY_STAGE_TOTAL].count == 0) {
+            printf("%s player %d: no turn reached the screen\n", game_latency_mode_name(mode), p + 1);
+            ok = false;
+        }
+        ok = ok && tick_ok && frame_ok;
+    }
+    return ok;
+}
+
+//==============================================================
+// [ 主程式 ]
+//==============================================================
+int main(int argc, char** argv)
+{
+    CheckConfig cfg = { 5000, 16667, 2000, 2000, 0, 1 };
+    const char* modes = "all";
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            fprintf(stderr, "usage: %s [-m single|multi|all] [-n keys] [-r hz] [-d draw_ms] [-q queue_ms] [-j jitter_ms] [-s seed]\n", argv[0]);
+            return 2;
+        }
+        if (strcmp(arg, "-m") == 0) modes = value;
+        else if (strcmp(arg, "-n") == 0) cfg.keys = atol(value);
+        else if (strcmp(arg, "-r") == 0) cfg.frame_us = (int64_t)(1000000.0 / atof(value));
+        else if (strcmp(arg, "-d") == 0) cfg.draw_us = (int64_t)(atof(value) * 1000.0);
+        else if (strcmp(arg, "-q") == 0) cfg.queue_us = (int64_t)(atof(value) * 1000.0);
+        else if (strcmp(arg, "-j") == 0) cfg.jitter_us = (int64_t)(atof(value) * 1000.0);
+        else if (strcmp(arg, "-s") == 0) cfg.seed = strtoull(value, NULL, 10);
+        else {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return 2;
+        }
+        i++;
+    }
+    if (cfg.keys < 1 || cfg.frame_us < 1 || cfg.draw_us < 0 || cfg.queue_us < 0 || cfg.jitter_us < 0) {
+        fprintf(stderr, "invalid option value\n");
+        return 2;
+    }
+    rng_state = cfg.seed;
+
+    printf("frame %.2f ms, draw %.2f ms, queue <= %.2f ms, timer jitter <= %.2f ms, %ld turns per player\n",
+        cfg.frame_us / 1000.0, cfg.draw_us / 1000.0, cfg.queue_us / 1000.0, cfg.jitter_us / 1000.0, cfg.keys);
+
+    static GameLatency latency;
+    game_latency_init(&latency);
+    bool ok = true;
+    for (int m = LATENCY_MODE_SINGLE; m <= LATENCY_MODE_MULTI; m++) {
+        if (strcmp(modes, "all") != 0 && strcmp(modes, game_latency_mode_name((GameLatencyMode)m)) != 0) continue;
+        CheckRun run;
+        simulate(&cfg, (GameLatencyMode)m, &latency, &run);
+        printf("%s: %ld games, longest tick interval %.0f ms\n",
+            game_latency_mode_name((GameLatencyMode)m), run.games, run.max_interval_us / 1000.0);
+        ok = check_budget(&cfg, &latency, (GameLatencyMode)m, m == LATENCY_MODE_SINGLE ? 1 : 2, &run) && ok;
+    }
+    game_latency_write(&latency, stdout);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
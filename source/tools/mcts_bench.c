@@ -0,0 +1,236 @@
+// 蒙地卡羅樹搜尋的效能測試 (Linux，無介面)。
+// 1. 以隨機方向同時推進 GameState 與精簡狀態 (GameSim)，逐步確認兩者完全一致。
+// 2. 量測精簡狀態的複製速度 (每秒複製次數)。
+// 3. 在不同的時間上限下量測每步的決策延遲 (平均、p99、最大) 與每秒模擬次數。
+// 4. 以固定的模擬次數與 greedy、autopilot 對戰 (兩種座位)，輸出勝、平、負。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/mcts_bench.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o mcts_bench -lm
+//   ./mcts_bench [-m 對戰場數] [-i 對戰時每步模擬次數] [-s 種子]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_mcts.h"
+#include "game_sim.h"
+
+// 一致性檢查的局數與每局最多步數
+#define VERIFY_GAMES 200
+#define VERIFY_STEPS 2000
+// 量測決策延遲的步數
+#define LATENCY_STEPS 400
+// 對戰的遊戲時間上限 (毫秒)
+#define MATCH_MAX_MS 120000
+
+// 單調時鐘 (微秒)
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+//==============================================================
+// [ 一致性檢查 ]
+//==============================================================
+// 比較 GameState 與精簡狀態
+static bool same(const GameState* g, const GameSim* s)
+{
+    if (s->food != (uint32_t)(g->food.y * g->width + g->food.x) || s->rng_state != g->rng_state) return false;
+    for (int p = 0; p < g->player_count; p++) {
+        const Player* pl = &g->players[p];
+        const GameSimPlayer* sp = &s->players[p];
+        if (sp->alive != pl->alive || sp->score != pl->score || sp->interval != pl->interval
+            || sp->elapsed_ms != pl->elapsed_ms || sp->survival_ms != pl->survival_ms
+            || sp->direction != pl->direction || sp->next_direction != pl->next_direction
+            || sp->length != pl->body.length) return false;
+        for (int i = 0; i < pl->body.length; i++) {
+            Point c = snake_body_at(&pl->body, i);
+            if (game_sim_body_at(s, p, i) != c.y * g->width + c.x) return false;
+        }
+    }
+    return true;
+}
+
+static bool verify(GameState* game, GameSim* sim, uint64_t seed)
+{
+    long steps = 0;
+    for (int n = 0; n < VERIFY_GAMES; n++) {
+        game_seed(game, seed + (uint64_t)n);
+        if (n % 2 == 0) game_new_multi(game);
+        else game_new_single(game);
+        GameSimWalls* walls = game_sim_walls_from_state(game);
+        game_sim_from_state(sim, game, walls);
+        game_sim_walls_release(walls); // 精簡狀態仍持有一個參考
+        uint64_t rng = seed * 31 + (uint64_t)n + 1;
+
+        for (int s = 0; s < VERIFY_STEPS; s++) {
+            int p = game_sim_next_mover(sim);
+            if (p < 0) break;
+            Direction d = (Direction)game_rng_next(&rng, 4);
+            if (game_rng_next(&rng, 4) == 0) {
+                game_turn(game, p, d);
+                game_sim_turn(sim, p, d);
+            }
+            else if (game_bot_safe(game, p, d)) {
+                // 大多走安全的方向，讓蛇活得夠久、長得夠長
+                game_turn(game, p, d);
+                game_sim_turn(sim, p, d);
+            }
+            GameEvent a = game_step_player(game, p);
+            GameEvent b = game_sim_step(sim, p);
+            steps++;
+            if (a != b || !same(game, sim)) {
+                fprintf(stderr, "verify: game %d diverged at step %d (player %d)\n", n, s, p);
+                game_sim_release(sim);
+                return false;
+            }
+        }
+        game_sim_release(sim);
+    }
+    printf("verify: %d games, %ld steps identical to GameState\n", VERIFY_GAMES, steps);
+    return true;
+}
+
+//==============================================================
+// [ 效能 ]
+//==============================================================
+// 複製速度
+static void bench_copy(GameState* game, GameSim* a, GameSim* b)
+{
+    game_seed(game, 1);
+    game_new_multi(game);
+    GameSimWalls* walls = game_sim_walls_from_state(game);
+    game_sim_from_state(a, game, walls);
+    game_sim_walls_release(walls);
+
+    const long n = 2000000;
+    double t0 = now_us();
+    for (long i = 0; i < n; i++) {
+        game_sim_copy(b, a);
+        a->rng_state ^= b->rng_state; // 避免編譯器省略複製
+    }
+    double us = now_us() - t0;
+    printf("copy: %u-byte state, %.1f ns per copy, %.1f M copies/s\n",
+        a->size, us * 1000.0 / n, n / us);
+    game_sim_release(a);
+}
+
+// 在指定的時間上限下，讓 mcts 擔任玩家1 與 greedy 對戰，量測每一步的決策時間
+static void bench_latency(GameState* game, long budget_us, uint64_t seed)
+{
+    GameBot mcts, greedy;
+    game_bot_init(&mcts, "mcts");
+    game_bot_init(&greedy, "greedy");
+    mcts.budget_us = budget_us;
+    mcts.rng_state = seed | 1;
+
+    double samples[LATENCY_STEPS];
+    int count = 0;
+    uint64_t s = seed;
+    game_seed(game, s);
+    game_new_multi(game);
+    while (count < LATENCY_STEPS) {
+        int p = game_next_mover(game);
+        if (p < 0) {
+            game_seed(game, ++s);
+            game_new_multi(game);
+            continue;
+        }
+        GameBot* bot = (p == 0) ? &mcts : &greedy;
+        double t0 = now_us();
+        Direction d = bot->decide(game, p, bot);
+        if (p == 0) samples[count++] = now_us() - t0;
+        game_turn(game, p, d);
+        game_step_player(game, p);
+    }
+
+    const MctsSearch* search = (const MctsSearch*)mcts.data;
+    double mean = 0.0;
+    for (int i = 0; i < count; i++) mean += samples[i];
+    mean /= count;
+    qsort(samples, (size_t)count, sizeof(double), compare_double);
+    printf("budget %6ld us: latency mean %8.1f us  p99 %8.1f us  max %8.1f us  "
+        "%7.0f rollouts/decision  %9.0f rollouts/s\n",
+        budget_us, mean, samples[count * 99 / 100], samples[count - 1],
+        (double)search->rollouts / search->decisions, search->rollouts / (search->total_us / 1e6));
+    game_bot_free(&mcts);
+    game_bot_free(&greedy);
+}
+
+// 以固定模擬次數與對手對戰 (兩種座位各半)
+static void bench_strength(GameState* game, const char* opponent, int matches, long iterations, uint64_t seed)
+{
+    GameBot mcts, other;
+    game_bot_init(&mcts, "mcts");
+    game_bot_init(&other, opponent);
+    mcts.budget_work = iterations;
+
+    int win = 0, draw = 0, loss = 0;
+    double t0 = now_us();
+    for (int m = 0; m < matches; m++) {
+        int seat = m % 2;
+        GameBot* bots[MAX_PLAYERS];
+        bots[seat] = &mcts;
+        bots[1 - seat] = &other;
+        GameMatchResult r = game_play_match(game, seed + (uint64_t)m, bots, MATCH_MAX_MS);
+        if (r.winner == 0) draw++;
+        else if (r.winner == seat + 1) win++;
+        else loss++;
+    }
+    const MctsSearch* search = (const MctsSearch*)mcts.data;
+    printf("vs %-10s %3d matches, %ld rollouts/move: %3d wins %3d draws %3d losses  (%.1f s, %.0f rollouts/s)\n",
+        opponent, matches, iterations, win, draw, loss, (now_us() - t0) / 1e6,
+        search ? search->rollouts / (search->total_us / 1e6) : 0.0);
+    game_bot_free(&mcts);
+    game_bot_free(&other);
+}
+
+int main(int argc, char** argv)
+{
+    int matches = 40;
+    long iterations = 400;
+    uint64_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) matches = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) iterations = atol(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [-m matches] [-i iterations] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    GameState game;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return 1;
+    size_t size = game_sim_size(GRID_WIDTH, GRID_HEIGHT);
+    GameSim* a = (GameSim*)calloc(size / sizeof(uint64_t), sizeof(uint64_t));
+    GameSim* b = (GameSim*)calloc(size / sizeof(uint64_t), sizeof(uint64_t));
+    if (!a || !b) return 1;
+
+    int status = 0;
+    if (!verify(&game, a, seed)) status = 1;
+    else {
+        bench_copy(&game, a, b);
+        static const long budgets[] = { 1000, 5000, 20000 };
+        for (int i = 0; i < 3; i++) bench_latency(&game, budgets[i], seed);
+        bench_strength(&game, "greedy", matches, iterations, seed);
+        bench_strength(&game, "autopilot", matches, iterations, seed);
+    }
+
+    free(a);
+    free(b);
+    game_state_free(&game);
+    return status;
+}
@@ -0,0 +1,609 @@
+// 遊戲迴圈熱點的微基準測試 (Linux，無介面)。
+// 每個項目先校準批次大小 (每批至少 BENCH_BATCH_US 微秒)，暖機後量測 BENCH_SAMPLES 批，
+// 以每批的平均耗時作為樣本，輸出中位數、p99、最小值與平均每次操作的記憶體配置次數。
+// 配置次數由本程式替換的 malloc / calloc / realloc 計算 (glibc)，遊戲迴圈中應為0。
+// 項目：
+//   tick/len=N        單人一步 (game_step_player)，蛇長 N，碰撞檢查掃過整條蛇
+//   collision/len=N   碰撞檢查 (game_check_collision) 的最差情況
+//   food/fill=P       在 P% 的格子被蛇佔用時生成食物 (game_generate_food，拒絕取樣)
+//   new/single|multi  開新局 (含障礙物生成與第一個食物)
+//   obstacles/single  只有障礙物生成 (game_generate_obstacles，四區各自拒絕取樣)
+//   hash/..., snapshot/..., sim/...   局面雜湊、快照寫入、精簡狀態複製與移動
+//   loop/greedy|autopilot            含電腦玩家思考的完整一步 (死亡時重新開局)
+//   trace/off|on                     效能追蹤記錄點在未啟用 / 啟用時的成本 (game_trace)
+//   metrics/tick                     每次移動的統計記錄 (game_metrics_game_tick：計數器與蛇身長度直方圖)
+//   perf/push|format                 效能疊加層的樣本記錄 (每個畫面與移動都會呼叫) 與顯示時的統計 (game_perf)
+//   draw/single|multi                以 -DBENCH_CAIRO 建置時，繪製到離屏影像 (game_draw)
+//   audio/pipeline                   以 -DBENCH_GST 建置時，播放一次音效的成本：以 fakesink 建立管線 (game_audio)、
+//                                    切換到 PLAYING 後立即停止並釋放 (音效資料讀自 -a，預設為吃果實的音效)
+// -t 把 trace/on 記錄的事件寫成 Chrome trace JSON，用來檢查輸出格式。
+// -o 以 JSON Lines 寫出結果 (每行一個項目)，-c 讀入先前的結果並列出中位數的變化，供不同提交之間比較。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/micro_bench.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_snapshot.c source/game_trace.c source/game_metrics.c source/game_perf.c source/game_core.c -o micro_bench -lm
+//   (加上繪製：-DBENCH_CAIRO source/game_draw.c $(pkg-config --cflags --libs cairo))
+//   (加上音效管線：-DBENCH_GST source/game_audio.c $(pkg-config --cflags --libs gstreamer-app-1.0))
+//   ./micro_bench [-f 名稱過濾] [-o 結果.jsonl] [-c 基準.jsonl] [-n 樣本數] [-t trace.json] [-a 音效.mp3]
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_sim.h"
+#include "game_snapshot.h"
+#include "game_trace.h"
+#include "game_metrics.h"
+#include "game_perf.h"
+#ifdef BENCH_CAIRO
+#include "game_draw.h"
+#endif
+#ifdef BENCH_GST
+#include "game_audio.h"
+#endif
+
+// 每批的最短時間 (微秒) 與預設樣本數
+#define BENCH_BATCH_US 200.0
+#define BENCH_SAMPLES  101
+#define BENCH_MAX_RESULTS 64
+
+//==============================================================
+// [ 配置計數 ]
+//==============================================================
+// 以 glibc 的內部配置函式實作，計算整個程式的配置次數
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* p, size_t size);
+extern void  __libc_free(void* p);
+
+static unsigned long long alloc_count = 0;
+
+void* malloc(size_t size)
+{
+    alloc_count++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size)
+{
+    alloc_count++;
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, size_t size)
+{
+    alloc_count++;
+    return __libc_realloc(p, size);
+}
+
+void free(void* p)
+{
+    __libc_free(p);
+}
+
+//==============================================================
+// [ 量測 ]
+//==============================================================
+// 一個項目的結果
+typedef struct {
+    char name[48];
+    double median_ns, p99_ns, min_ns, mean_ns;
+    double allocs_per_op;
+    long batch;               // 每批的操作次數
+} BenchResult;
+
+// 執行 n 次操作
+typedef void (*BenchFn)(void* ctx, long n);
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static int sample_count = BENCH_SAMPLES;
+static const char* name_filter = NULL;
+
+// 單調時鐘 (奈秒)
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// 校準、暖機並量測一個項目
+static void bench(const char* name, BenchFn fn, void* ctx)
+{
+    if (name_filter && !strstr(name, name_filter)) return;
+    if (result_count == BENCH_MAX_RESULTS) return;
+
+    // 校準：批次大小加倍直到一批至少 BENCH_BATCH_US
+    long batch = 1;
+    for (;;) {
+        double t0 = now_ns();
+        fn(ctx, batch);
+        double t = now_ns() - t0;
+        if (t >= BENCH_BATCH_US * 1000.0 || batch >= (1L << 30)) break;
+        batch *= 2;
+    }
+    fn(ctx, batch); // 暖機
+
+    double samples[1024];
+    int n = sample_count < 1024 ? sample_count : 1024;
+    unsigned long long allocs = alloc_count;
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        double t0 = now_ns();
+        fn(ctx, batch);
+        samples[i] = (now_ns() - t0) / batch;
+        total += samples[i];
+    }
+    allocs = alloc_count - allocs;
+    qsort(samples, (size_t)n, sizeof(double), compare_double);
+
+    BenchResult* r = &results[result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->median_ns = samples[n / 2];
+    r->p99_ns = samples[(n * 99 + 99) / 100 - 1];
+    r->min_ns = samples[0];
+    r->mean_ns = total / n;
+    r->allocs_per_op = (double)allocs / ((double)batch * n);
+    r->batch = batch;
+}
+
+//==============================================================
+// [ 局面 ]
+//==============================================================
+// 在 width x 3 的網格中間一列放一條長 length、往右移動的蛇 (蛇頭追著蛇尾循環，永遠不會撞到)
+static void build_row_snake(GameState* g, int length)
+{
+    game_state_resize(g, length + 16, 3);
+    game_seed(g, 1);
+    game_begin(g, 1);
+    SnakeBody* body = &g->players[0].body;
+    for (int i = 0; i < length; i++) {
+        body->cells[i].x = length - 1 - i;
+        body->cells[i].y = 1;
+    }
+    body->head = 0;
+    body->length = length;
+    g->players[0].direction = g->players[0].next_direction = DIR_RIGHT;
+    g->players[0].score = length - 1;
+    g->food.x = 0;
+    g->food.y = 0; // 蛇只在中間一列移動，不會吃到
+    game_rehash(g);
+}
+
+// 在預設網格上以來回蛇行的方式放一條佔用 fill% 格子的蛇 (沒有障礙物)
+static void build_filled(GameState* g, int fill)
+{
+    game_state_resize(g, GRID_WIDTH, GRID_HEIGHT);
+    game_seed(g, 1);
+    game_begin(g, 1);
+    SnakeBody* body = &g->players[0].body;
+    int length = g->width * g->height * fill / 100;
+    for (int i = 0; i < length; i++) {
+        int y = i / g->width, x = i % g->width;
+        body->cells[i].x = (y % 2 == 0) ? x : g->width - 1 - x;
+        body->cells[i].y = y;
+    }
+    body->head = 0;
+    body->length = length;
+    g->players[0].score = length - 1;
+    game_rehash(g);
+}
+
+//==============================================================
+// [ 項目 ]
+//==============================================================
+typedef struct {
+    GameState* game;
+    GameSim* sim;
+    GameSim* scratch;
+    GameBot* bot;
+    GameMetricsGame* summary;
+    GamePerf* perf;
+    void* buffer;
+    size_t buffer_size;
+    uint64_t seed;
+    uint64_t sink;
+#ifdef BENCH_CAIRO
+    cairo_t* cr;
+    GameDrawInfo info;
+#endif
+#ifdef BENCH_GST
+    GBytes* sound;
+#endif
+} BenchCtx;
+
+static void op_tick(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) game_step_player(c->game, 0);
+}
+
+static void op_collision(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    Point free_cell = { 0, 2 };
+    for (long i = 0; i < n; i++) c->sink += game_check_collision(c->game, 0, free_cell);
+}
+
+static void op_food(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) game_generate_food(c->game);
+}
+
+static void op_new_single(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_seed(c->game, c->seed++);
+        game_new_single(c->game);
+    }
+}
+
+static void op_new_multi(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_seed(c->game, c->seed++);
+        game_new_multi(c->game);
+    }
+}
+
+static void op_obstacles(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    Point head = { c->game->width / 2, c->game->height / 2 };
+    for (long i = 0; i < n; i++) {
+        c->game->obstacle_count = 0;
+        game_generate_obstacles(c->game, &head, 1);
+    }
+}
+
+static void op_hash(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        c->sink ^= game_hash(c->game);
+        c->game->rng_state += 1; // 避免編譯器把呼叫提出迴圈
+    }
+}
+
+static void op_rehash(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) c->sink ^= game_rehash(c->game);
+}
+
+static void op_snapshot(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) c->sink += game_snapshot_write(c->game, NULL, c->buffer, c->buffer_size);
+}
+
+static void op_sim_copy(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_sim_copy(c->scratch, c->sim);
+        c->sink += c->scratch->rng_state;
+    }
+}
+
+static void op_sim_step(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) game_sim_step(c->sim, 0);
+}
+
+// 含電腦玩家思考的一步，所有玩家都死亡時以下一個種子重新開局
+static void op_loop(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    GameState* g = c->game;
+    for (long i = 0; i < n; i++) {
+        int q = game_next_mover(g);
+        if (q < 0) {
+            game_seed(g, c->seed++);
+            game_new_multi(g);
+            game_bot_reset(c->bot);
+            continue;
+        }
+        game_turn(g, q, c->bot->decide(g, q, c->bot));
+        game_step_player(g, q);
+    }
+}
+
+// 一個記錄點 (開始與結束)
+static void op_trace_span(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        int64_t start = game_trace_begin();
+        c->sink += (uint64_t)i;
+        game_trace_end("bench", "span", start, (int32_t)i);
+    }
+}
+
+// 一次移動的統計記錄
+static void op_metrics_tick(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_metrics_game_tick(c->summary, c->game, 0, (i & 15) == 0 ? GAME_EVENT_ATE : GAME_EVENT_NONE);
+    }
+}
+
+// 效能疊加層記錄一個樣本
+static void op_perf_push(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_perf_push(c->perf, PERF_FRAME, (float)(i & 1023) * 0.01f);
+    }
+}
+
+// 效能疊加層顯示時每個畫面的統計 (所有項目的視窗都已填滿)
+static void op_perf_format(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    char lines[GAME_PERF_MAX_LINES][GAME_PERF_LINE_BYTES];
+    for (long i = 0; i < n; i++) {
+        c->sink += (uint64_t)game_perf_format(c->perf, lines);
+    }
+}
+
+#ifdef BENCH_CAIRO
+static void op_draw_single(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_draw_single(c->cr, c->game, &c->info, GRID_WIDTH * 45, GRID_HEIGHT * 45, 45.0);
+    }
+}
+
+static void op_draw_multi(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        game_draw_multi(c->cr, c->game, &c->info, GRID_WIDTH * 45, GRID_HEIGHT * 45, 45.0);
+    }
+}
+#endif
+
+#ifdef BENCH_GST
+static void op_audio_pipeline(void* p, long n)
+{
+    BenchCtx* c = (BenchCtx*)p;
+    for (long i = 0; i < n; i++) {
+        GameSound sound = { NULL, FALSE, c->sound, 0 };
+        if (!game_audio_pipeline_new(&sound, 1.0f, gst_element_factory_make("fakesink", NULL))) continue;
+        gst_element_set_state(sound.pipeline, GST_STATE_PLAYING);
+        gst_element_set_state(sound.pipeline, GST_STATE_NULL);
+        gst_object_unref(sound.pipeline);
+    }
+}
+#endif
+
+//==============================================================
+// [ 結果 ]
+//==============================================================
+// 從先前的結果中找出同名項目的中位數 (找不到時返回0)
+static double baseline_median(const char* path, const char* name)
+{
+    FILE* in = fopen(path, "r");
+    if (!in) return 0.0;
+    char line[512], key[64];
+    double median = 0.0, value;
+    while (fgets(line, sizeof(line), in)) {
+        if (sscanf(line, "{\"name\":\"%63[^\"]\",\"median_ns\":%lf", key, &value) == 2 && strcmp(key, name) == 0) {
+            median = value;
+            break;
+        }
+    }
+    fclose(in);
+    return median;
+}
+
+static void report(const char* out_path, const char* baseline_path)
+{
+    printf("%-22s %12s %12s %12s %10s%s\n", "benchmark", "median ns", "p99 ns", "min ns", "allocs/op",
+        baseline_path ? "   vs baseline" : "");
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        printf("%-22s %12.1f %12.1f %12.1f %10.3f", r->name, r->median_ns, r->p99_ns, r->min_ns, r->allocs_per_op);
+        double base = baseline_path ? baseline_median(baseline_path, r->name) : 0.0;
+        if (base > 0.0) printf("   %+6.1f%%", (r->median_ns / base - 1.0) * 100.0);
+        printf("\n");
+    }
+
+    if (!out_path) return;
+    FILE* out = fopen(out_path, "w");
+    if (!out) {
+        perror(out_path);
+        return;
+    }
+    for (int i = 0; i < result_count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(out, "{\"name\":\"%s\",\"median_ns\":%.3f,\"p99_ns\":%.3f,\"min_ns\":%.3f,\"mean_ns\":%.3f,"
+            "\"allocs_per_op\":%.6f,\"batch\":%ld,\"samples\":%d}\n",
+            r->name, r->median_ns, r->p99_ns, r->min_ns, r->mean_ns, r->allocs_per_op, r->batch, sample_count);
+    }
+    fclose(out);
+    printf("results written to %s\n", out_path);
+}
+
+int main(int argc, char** argv)
+{
+    const char* out_path = NULL;
+    const char* baseline_path = NULL;
+    const char* trace_out = NULL;
+    const char* sound_path = "Snake_Hero_Game/Snake_Hero_Game/Musics/eat_fruit.mp3";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) name_filter = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) sample_count = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) trace_out = argv[++i];
+        else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) sound_path = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [-f filter] [-o results.jsonl] [-c baseline.jsonl] [-n samples] [-t trace.json] [-a sound.mp3]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (sample_count < 1) sample_count = 1;
+
+    GameState game;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return 1;
+    BenchCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.game = &game;
+    char name[48];
+
+    static const int lengths[] = { 4, 64, 512, 4096 };
+    for (int i = 0; i < 4; i++) {
+        build_row_snake(&game, lengths[i]);
+        snprintf(name, sizeof(name), "tick/len=%d", lengths[i]);
+        bench(name, op_tick, &ctx);
+        build_row_snake(&game, lengths[i]);
+        snprintf(name, sizeof(name), "collision/len=%d", lengths[i]);
+        bench(name, op_collision, &ctx);
+    }
+
+    static const int fills[] = { 10, 50, 90, 98 };
+    for (int i = 0; i < 4; i++) {
+        build_filled(&game, fills[i]);
+        snprintf(name, sizeof(name), "food/fill=%d", fills[i]);
+        bench(name, op_food, &ctx);
+    }
+
+    game_state_resize(&game, GRID_WIDTH, GRID_HEIGHT);
+    ctx.seed = 1;
+    bench("new/single", op_new_single, &ctx);
+    bench("new/multi", op_new_multi, &ctx);
+    game_new_single(&game);
+    bench("obstacles/single", op_obstacles, &ctx);
+
+    build_row_snake(&game, 64);
+    bench("hash/game_hash", op_hash, &ctx);
+    build_row_snake(&game, 512);
+    bench("hash/rehash len=512", op_rehash, &ctx);
+
+    ctx.buffer_size = game_snapshot_size(&game);
+    ctx.buffer = malloc(ctx.buffer_size);
+    if (ctx.buffer) bench("snapshot/len=512", op_snapshot, &ctx);
+    free(ctx.buffer);
+
+    size_t sim_size = game_sim_size(GRID_WIDTH, GRID_HEIGHT);
+    ctx.sim = (GameSim*)calloc(sim_size / sizeof(uint64_t), sizeof(uint64_t));
+    ctx.scratch = (GameSim*)calloc(sim_size / sizeof(uint64_t), sizeof(uint64_t));
+    if (ctx.sim && ctx.scratch) {
+        game_state_resize(&game, GRID_WIDTH, GRID_HEIGHT);
+        game_seed(&game, 3);
+        game_new_multi(&game);
+        GameSimWalls* walls = game_sim_walls_from_state(&game);
+        game_sim_from_state(ctx.sim, &game, walls);
+        game_sim_walls_release(walls);
+        bench("sim/copy", op_sim_copy, &ctx);
+        game_sim_release(ctx.sim);
+
+        build_row_snake(&game, 64);
+        walls = game_sim_walls_from_state(&game);
+        game_sim_from_state(ctx.sim, &game, walls);
+        game_sim_walls_release(walls);
+        bench("sim/step len=64", op_sim_step, &ctx);
+        game_sim_release(ctx.sim);
+    }
+    free(ctx.sim);
+    free(ctx.scratch);
+
+    static const char* const bots[] = { "greedy", "autopilot" };
+    for (int i = 0; i < 2; i++) {
+        GameBot bot;
+        game_bot_init(&bot, bots[i]);
+        ctx.bot = &bot;
+        game_state_resize(&game, GRID_WIDTH, GRID_HEIGHT);
+        game_seed(&game, 5);
+        game_new_multi(&game);
+        ctx.seed = 100;
+        snprintf(name, sizeof(name), "loop/%s", bots[i]);
+        bench(name, op_loop, &ctx);
+        game_bot_free(&bot);
+    }
+
+    bench("trace/off", op_trace_span, &ctx);
+    game_trace_start(0);
+    game_trace_thread_name("micro_bench");
+    bench("trace/on", op_trace_span, &ctx);
+    game_trace_stop();
+    if (trace_out) {
+        long events = game_trace_dump(trace_out);
+        if (events < 0) perror(trace_out);
+        else printf("trace: %ld events written to %s\n", events, trace_out);
+    }
+    game_trace_shutdown();
+
+    GameMetricsGame summary;
+    game_metrics_game_begin(&summary, "bench", 0, 1, 0);
+    ctx.summary = &summary;
+    game_state_resize(&game, GRID_WIDTH, GRID_HEIGHT);
+    build_row_snake(&game, 64);
+    bench("metrics/tick", op_metrics_tick, &ctx);
+    game_metrics_shutdown();
+
+    GamePerf* perf = (GamePerf*)calloc(1, sizeof(GamePerf));
+    if (perf) {
+        ctx.perf = perf;
+        bench("perf/push", op_perf_push, &ctx);
+        for (int s = 0; s < PERF_SERIES_COUNT; s++) {
+            for (int i = 0; i < GAME_PERF_RING; i++) game_perf_push(perf, (GamePerfSeries)s, (float)((i * 37) % 101) * 0.1f);
+        }
+        bench("perf/format", op_perf_format, &ctx);
+    }
+    free(perf);
+
+#ifdef BENCH_CAIRO
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, GRID_WIDTH * 45, GRID_HEIGHT * 45);
+    ctx.cr = cairo_create(surface);
+    ctx.info.started = true;
+    game_state_resize(&game, GRID_WIDTH, GRID_HEIGHT);
+    build_filled(&game, 10);
+    bench("draw/single len=80", op_draw_single, &ctx);
+    build_filled(&game, 50);
+    bench("draw/single len=400", op_draw_single, &ctx);
+    game_seed(&game, 7);
+    game_new_multi(&game);
+    bench("draw/multi", op_draw_multi, &ctx);
+    cairo_destroy(ctx.cr);
+    cairo_surface_destroy(surface);
+#endif
+
+#ifdef BENCH_GST
+    gst_init(NULL, NULL);
+    gchar* sound_data = NULL;
+    gsize sound_size = 0;
+    if (g_file_get_contents(sound_path, &sound_data, &sound_size, NULL)) {
+        ctx.sound = g_bytes_new_take(sound_data, sound_size);
+        bench("audio/pipeline", op_audio_pipeline, &ctx);
+        g_bytes_unref(ctx.sound);
+    }
+    else {
+        fprintf(stderr, "audio/pipeline skipped: cannot read %s\n", sound_path);
+    }
+#else
+    (void)sound_path;
+#endif
+
+    report(out_path, baseline_path);
+    game_state_free(&game);
+    return (int)(ctx.sink & 0); // 使用 sink，避免結果被省略
+}
@@ -0,0 +1,313 @@
+// 確定性同步網路對戰的測試端 (Linux，無介面)。
+// 每個行程是一位玩家，本機的方向由電腦玩家決定，經由 UDP 與另一個行程以 game_lockstep 同步。
+// 送出方向可加上延遲、抖動與遺失模擬 (game_net)，結束時輸出往返時間、輸入延遲、等待次數與頻寬，
+// 以及最後局面的雜湊；兩個行程的雜湊必須相同。以 -o 寫出重播，可用 golden_replay / rules_fuzz -r 重現。
+// --rollback 改用回溯模式 (主機決定，客戶端跟隨)，另外輸出回溯次數與深度、每秒重新模擬的移動數
+// 與畫面修正次數。
+// --pair 在同一個指令中分出第二個行程 (玩家1，埠號 +1)，結束後比對兩邊的雜湊。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/net_lockstep.c source/game_lockstep.c source/game_net.c source/game_replay.c source/game_snapshot.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o net_lockstep -lm
+//   ./net_lockstep -p 0 -l 7001 -r 127.0.0.1:7002 --latency 30 --loss 5 &
+//   ./net_lockstep -p 1 -l 7002 -r 127.0.0.1:7001 --latency 30 --loss 5
+//   ./net_lockstep --pair -l 7001 --latency 30 --jitter 10 --loss 5 -x 4
+//   ./net_lockstep --pair -l 7001 --latency 40 --jitter 10 --loss 5 --rollback 16 -d 0
+// 選項：
+//   -p 玩家 (0 為主機)  -l 本機埠號  -r 對方位址:埠號  -d 輸入延遲 (移動次數)  -s 種子
+//   -b 電腦玩家 (random,straight,greedy,autopilot,mcts)  -m 最多移動次數  -x 遊戲時間的倍速
+//   --latency 單向延遲(毫秒)  --jitter 抖動(毫秒)  --loss 遺失率(%)  -o 重播檔案  -t 逾時(秒)
+//   --rollback 回溯模式最多預測的格數
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+#include "game_net.h"
+#include "game_lockstep.h"
+#include "game_replay.h"
+
+// 對局結束後繼續回應對方的時間 (毫秒)，讓對方收到最後的確認
+#define LINGER_MS 300.0
+
+//========================[ 結構定義 ]========================
+typedef struct {
+    int player;
+    int port;
+    char remote_host[64];
+    int remote_port;
+    int delay;
+    uint64_t seed;
+    const char* bot;
+    long max_moves;
+    double speed;
+    int latency_ms, jitter_ms;
+    double loss;
+    const char* replay_path;
+    double timeout_s;
+    int rollback;
+} PeerOptions;
+
+// 一端的結果
+typedef struct {
+    bool ok;
+    uint64_t hash;
+    long frames;
+} PeerResult;
+
+static double now_ms(void)
+{
+    return (double)game_net_now_us() / 1000.0;
+}
+
+//==============================================================
+// [ 一端 ]
+//==============================================================
+static PeerResult run_peer(const PeerOptions* opt)
+{
+    PeerResult result = { false, 0, 0 };
+    const char* who = opt->player == 0 ? "host" : "client";
+
+    GameNet net;
+    GameNetAddress peer;
+    if (!game_net_open(&net, opt->port)) {
+        fprintf(stderr, "%s: cannot bind port %d\n", who, opt->port);
+        return result;
+    }
+    if (!game_net_resolve(opt->remote_host, opt->remote_port, &peer)) {
+        fprintf(stderr, "%s: cannot resolve %s\n", who, opt->remote_host);
+        game_net_close(&net);
+        return result;
+    }
+    game_net_set_shim(&net, opt->latency_ms, opt->jitter_ms, opt->loss, opt->seed * 31 + (uint64_t)opt->player);
+
+    GameState game;
+    GameBot bot;
+    GameReplay replay;
+    game_state_init(&game, GRID_WIDTH, GRID_HEIGHT);
+    game_bot_init(&bot, opt->bot);
+    bot.rng_state = opt->seed + (uint64_t)opt->player * 7919 + 1;
+    game_replay_init(&replay, GRID_WIDTH, GRID_HEIGHT, 2, 0);
+
+    GameLockstep ls;
+    ls.record = &replay;
+    ls.rollback_frames = 0;
+    ls.snapshots = NULL;
+    game_lockstep_init(&ls, &game, opt->player, opt->delay, opt->seed, 0);
+    if (opt->rollback > 0 && !game_lockstep_set_rollback(&ls, opt->rollback)) {
+        fprintf(stderr, "%s: cannot allocate the snapshot ring\n", who);
+        game_net_close(&net);
+        return result;
+    }
+
+    // 遊戲時鐘以倍速前進：傳給 game_lockstep 的時間乘上 speed
+    double start = now_ms();
+    double finished_at = -1.0;
+    double reconcile_ms = 0.0;
+    uint8_t buffer[GAME_NET_MAX_PACKET];
+    for (;;) {
+        double wall = now_ms();
+        double t = (wall - start) * opt->speed;
+        if (wall - start > opt->timeout_s * 1000.0) {
+            fprintf(stderr, "%s: timed out at move %ld (phase %d)\n", who, ls.frame, (int)ls.phase);
+            break;
+        }
+
+        int length;
+        while ((length = game_net_recv(&net, buffer, sizeof(buffer), NULL)) >= 0) {
+            game_lockstep_read(&ls, buffer, length, t);
+        }
+        // 先處理回溯，電腦玩家才會看到修正後的局面
+        if (ls.rollback_from >= 0) {
+            double before = now_ms();
+            game_lockstep_reconcile(&ls);
+            reconcile_ms += now_ms() - before;
+        }
+
+        // 可以移動時才讓電腦玩家思考，作為 delay 格之後的輸入
+        while (opt->max_moves <= 0 || ls.frame < opt->max_moves) {
+            if (game.players[opt->player].alive && game_lockstep_wait_ms(&ls, t) == 0.0) {
+                game_lockstep_set_input(&ls, bot.decide(&game, opt->player, &bot));
+            }
+            if (game_lockstep_advance(&ls, t, NULL) < 0) break;
+        }
+
+        if (game_lockstep_should_send(&ls, t)) {
+            length = game_lockstep_write(&ls, buffer, t);
+            game_net_send(&net, &peer, buffer, (size_t)length);
+        }
+
+        // 結束：兩位玩家都死亡 (或達到移動上限) 且對方已收到需要的輸入後，再回應一段時間
+        bool limit = opt->max_moves > 0 && ls.frame >= opt->max_moves && ls.remote_acked >= ls.frame;
+        if (finished_at < 0.0 && (game_lockstep_finished(&ls) || limit)) finished_at = wall;
+        if (finished_at >= 0.0 && wall - finished_at >= LINGER_MS && net.delayed_count == 0) {
+            result.ok = ls.phase != LOCKSTEP_DESYNC;
+            break;
+        }
+
+        double wait = game_lockstep_wait_ms(&ls, t);
+        int timeout = (wait < 0.0 || wait / opt->speed > 10.0) ? 10 : (int)(wait / opt->speed);
+        game_net_wait(&net, timeout);
+    }
+
+    // 重播記錄的輸入，確認與實際的局面相同
+    result.hash = game_hash(&game);
+    result.frames = ls.frame;
+    GameState check;
+    GameReplayCursor cursor;
+    game_state_init(&check, GRID_WIDTH, GRID_HEIGHT);
+    bool replay_ok = false;
+    if (game_replay_start(&cursor, &replay, &check)) {
+        while (game_replay_next(&cursor, NULL) >= 0) {}
+        replay_ok = game_hash(&check) == result.hash;
+    }
+    game_state_free(&check);
+
+    const GameLockstepStats* st = &ls.stats;
+    long frames = ls.frame > 0 ? ls.frame : 1;
+    printf("[%s] moves %ld, score %d:%d, %s\n", who, ls.frame, game.players[0].score, game.players[1].score,
+        ls.phase == LOCKSTEP_DESYNC ? "DESYNC" : (ls.phase == LOCKSTEP_OVER ? "game over" : "stopped"));
+    if (ls.phase == LOCKSTEP_DESYNC) printf("[%s] desync detected at move %ld\n", who, st->desync_frame);
+    // game_lockstep 的時間是倍速後的遊戲時間，往返與等待時間換算回實際時間
+    printf("[%s] rtt %.1f ms (min %.1f, max %.1f, %ld samples)\n", who, st->rtt_ms / opt->speed,
+        st->rtt_min_ms / opt->speed, st->rtt_max_ms / opt->speed, st->rtt_samples);
+    printf("[%s] input delay %d moves = %.1f ms game time, stalls %ld (%.1f ms)\n", who, ls.delay,
+        st->input_delay_ms, st->stalls, st->stall_ms / opt->speed);
+    if (ls.rollback_frames > 0) {
+        double seconds = (now_ms() - start) / 1000.0;
+        printf("[%s] rollback: %ld of %ld moves predicted, %ld rollbacks (depth avg %.1f, max %ld), "
+            "%ld visual corrections\n", who, st->predicted_frames, ls.frame, st->rollbacks,
+            st->rollbacks ? (double)st->rollback_depth_total / st->rollbacks : 0.0, st->rollback_depth_max,
+            st->corrections);
+        printf("[%s] resimulated %ld moves = %.1f moves/s over the match, %.2f ms total (%.0f moves/s while resimulating)\n",
+            who, st->resim_frames, seconds > 0.0 ? st->resim_frames / seconds : 0.0, reconcile_ms,
+            reconcile_ms > 0.0 ? st->resim_frames / (reconcile_ms / 1000.0) : 0.0);
+    }
+    printf("[%s] payload %.2f bytes/move sent, %.2f received; packets %ld sent (%llu dropped by shim), %ld received\n",
+        who, (double)st->bytes_sent / frames, (double)st->bytes_received / frames, st->packets_sent,
+        (unsigned long long)net.packets_dropped, st->packets_received);
+    printf("[%s] final hash %016llx, replay %s\n", who, (unsigned long long)result.hash,
+        replay_ok ? "matches" : "MISMATCH");
+    if (!replay_ok) result.ok = false;
+
+    if (opt->replay_path) {
+        FILE* out = fopen(opt->replay_path, "w");
+        if (out) {
+            fprintf(out, "# net_lockstep %s, delay %d\n", who, ls.delay);
+            game_replay_write(&replay, out);
+            fclose(out);
+        }
+        else perror(opt->replay_path);
+    }
+
+    game_lockstep_free(&ls);
+    game_replay_free(&replay);
+    game_bot_free(&bot);
+    game_state_free(&game);
+    game_net_close(&net);
+    return result;
+}
+
+//==============================================================
+// [ 入口 ]
+//==============================================================
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-p player] [-l port] [-r host:port] [-d delay] [-s seed] [-b bot] [-m moves]\n"
+        "          [-x speed] [--latency ms] [--jitter ms] [--loss pct] [-o replay] [-t timeout_s] [--rollback frames]\n"
+        "          [--pair]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    PeerOptions opt = { 0, 7001, "127.0.0.1", 7002, GAME_LOCKSTEP_DEFAULT_DELAY, 1, "greedy", 0, 1.0,
+        0, 0, 0.0, NULL, 600.0, 0 };
+    bool pair = false;
+    bool remote_set = false;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool has = i + 1 < argc;
+        if (strcmp(a, "--pair") == 0) pair = true;
+        else if (strcmp(a, "-p") == 0 && has) opt.player = atoi(argv[++i]) ? 1 : 0;
+        else if (strcmp(a, "-l") == 0 && has) opt.port = atoi(argv[++i]);
+        else if (strcmp(a, "-r") == 0 && has) {
+            const char* colon = strrchr(argv[++i], ':');
+            if (!colon || colon - argv[i] >= (long)sizeof(opt.remote_host)) {
+                usage(argv[0]);
+                return 2;
+            }
+            memcpy(opt.remote_host, argv[i], (size_t)(colon - argv[i]));
+            opt.remote_host[colon - argv[i]] = '\0';
+            opt.remote_port = atoi(colon + 1);
+            remote_set = true;
+        }
+        else if (strcmp(a, "-d") == 0 && has) opt.delay = atoi(argv[++i]);
+        else if (strcmp(a, "-s") == 0 && has) opt.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(a, "-b") == 0 && has) opt.bot = argv[++i];
+        else if (strcmp(a, "-m") == 0 && has) opt.max_moves = atol(argv[++i]);
+        else if (strcmp(a, "-x") == 0 && has) opt.speed = atof(argv[++i]);
+        else if (strcmp(a, "--latency") == 0 && has) opt.latency_ms = atoi(argv[++i]);
+        else if (strcmp(a, "--jitter") == 0 && has) opt.jitter_ms = atoi(argv[++i]);
+        else if (strcmp(a, "--loss") == 0 && has) opt.loss = atof(argv[++i]) / 100.0;
+        else if (strcmp(a, "-o") == 0 && has) opt.replay_path = argv[++i];
+        else if (strcmp(a, "-t") == 0 && has) opt.timeout_s = atof(argv[++i]);
+        else if (strcmp(a, "--rollback") == 0 && has) opt.rollback = atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (opt.speed <= 0.0) opt.speed = 1.0;
+    GameBot probe;
+    if (!game_bot_init(&probe, opt.bot)) {
+        fprintf(stderr, "unknown bot: %s\n", opt.bot);
+        return 2;
+    }
+    game_bot_free(&probe);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (!pair) {
+        if (!remote_set) opt.remote_port = opt.player == 0 ? opt.port + 1 : opt.port - 1;
+        return run_peer(&opt).ok ? 0 : 1;
+    }
+
+    // 兩個行程：子行程是玩家1，以管線回傳最後的雜湊
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    PeerOptions client = opt;
+    opt.player = 0;
+    opt.remote_port = opt.port + 1;
+    client.player = 1;
+    client.port = opt.port + 1;
+    client.remote_port = opt.port;
+    if (client.replay_path) client.replay_path = NULL; // 兩端的重播相同，只由主機寫出
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        PeerResult r = run_peer(&client);
+        if (write(fds[1], &r, sizeof(r)) != (ssize_t)sizeof(r)) _exit(1);
+        _exit(r.ok ? 0 : 1);
+    }
+    close(fds[1]);
+    PeerResult host = run_peer(&opt);
+    PeerResult other = { false, 0, 0 };
+    if (read(fds[0], &other, sizeof(other)) != (ssize_t)sizeof(other)) other.ok = false;
+    waitpid(pid, NULL, 0);
+
+    bool same = host.ok && other.ok && host.hash == other.hash && host.frames == other.frames;
+    printf("pair: %s (%ld moves, hash %016llx vs %016llx)\n", same ? "in sync" : "FAILED",
+        host.frames, (unsigned long long)host.hash, (unsigned long long)other.hash);
+    return same ? 0 : 1;
+}
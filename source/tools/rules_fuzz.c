@@ -0,0 +1,724 @@
+// 遊戲規則的性質測試 (fuzz，Linux，無介面)。
+// 以隨機的種子、網格尺寸與輸入序列 (含同一個移動間隔內連按兩次造成的 180 度迴轉) 產生大量重播，
+// 每一步之後檢查下列性質：
+//   - 移動的玩家是到期最早者 (相同時玩家1 優先)，經過時間與移動間隔符合規則
+//   - 蛇身逐節相連 (含邊界循環)，存活的蛇不重疊、不在障礙物上
+//   - 長度 = 1 + 分數，吃到果實、移動與死亡時長度與蛇頭的變化正確
+//   - 死亡與否和獨立計算的碰撞結果相同 (自己的蛇尾也算碰撞，死亡的蛇不阻擋)
+//   - 食物在空格上 (不在障礙物與存活的蛇上)
+//   - 增量雜湊與重新計算相同，精簡狀態 (GameSim) 與 GameState 逐步一致
+//   - 結束時的勝負與獨立計算相同，重複判定結果不變；同一個重播再播放一次結果完全相同
+// 發現失敗時自動縮小：截斷到失敗的那一步，再反覆移除輸入 (ddmin)，
+// 直到移除任何一段輸入都不再失敗，輸出最小的重播 (game_replay 文字格式)。
+// -p 可加入不屬於規則的額外性質，用來探索行為或示範縮小：
+//   -p score:N   任何玩家的分數不會達到 N
+//   -p reverse   蛇不會倒退進自己的第二節 (目前的規則允許在一個移動間隔內連按兩次迴轉)
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/rules_fuzz.c source/game_replay.c source/game_sim.c source/game_core.c -o rules_fuzz
+//   ./rules_fuzz [-n 局數] [-t 執行緒數] [-s 種子] [-m 每局最多移動次數] [-T 秒數]
+//                [-p score:N|reverse] [-o 最小重播輸出檔]
+//   ./rules_fuzz -r 重播檔             (檢查單一重播，例如縮小後的結果)
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game_core.h"
+#include "game_replay.h"
+#include "game_sim.h"
+
+// 每次從共用計數器取得的局數
+#define FUZZ_BATCH 64
+
+//========================[ 結構定義 ]========================
+// 違反的性質
+typedef enum {
+    FUZZ_OK = 0,
+    FUZZ_SETUP,        // 無法開始一局
+    FUZZ_MOVER,        // 移動的玩家不是到期最早者
+    FUZZ_TIMING,       // 經過時間、存活時間或移動間隔錯誤
+    FUZZ_CONTIGUITY,   // 蛇身不相連或超出網格
+    FUZZ_OVERLAP,      // 存活的蛇重疊或在障礙物上
+    FUZZ_LENGTH,       // 長度、分數或蛇頭的變化錯誤
+    FUZZ_COLLISION,    // 死亡與否和碰撞的計算不符
+    FUZZ_FOOD,         // 食物不在空格上或吃到食物的結果錯誤
+    FUZZ_HASH,         // 增量雜湊與重新計算不同
+    FUZZ_SIM,          // 精簡狀態與 GameState 不同
+    FUZZ_WINNER,       // 勝負判定錯誤或不穩定
+    FUZZ_DETERMINISM,  // 相同的重播得到不同的結果
+    FUZZ_SCORE,        // 額外性質 -p score:N
+    FUZZ_REVERSE,      // 額外性質 -p reverse
+    FUZZ_KIND_COUNT
+} FuzzKind;
+
+static const char* const fuzz_kind_names[FUZZ_KIND_COUNT] = {
+    "ok", "setup", "mover", "timing", "contiguity", "overlap", "length",
+    "collision", "food", "hash", "sim", "winner", "determinism", "score", "reverse",
+};
+
+// 失敗的內容
+typedef struct {
+    FuzzKind kind;
+    long step;            // 第幾次移動之後 (-1 為開局)
+    char message[192];
+} FuzzFailure;
+
+// 檢查選項
+typedef struct {
+    int score_limit;      // 額外性質：分數不會達到此值 (0 表示不檢查)
+    bool no_reverse;      // 額外性質：蛇不會倒退進自己的第二節
+} FuzzOptions;
+
+// 每個執行緒的檢查器 (緩衝區依網格大小重複使用)
+typedef struct {
+    GameState game;
+    GameState again;      // 確定性檢查用的第二份狀態
+    GameSim* sim;
+    size_t sim_capacity;
+    uint32_t* stamp;      // 存活的蛇佔用的格子 (等於 epoch 表示本次檢查已佔用)
+    uint8_t* wall;        // 障礙物
+    size_t cell_capacity;
+    uint32_t epoch;
+    int wall_cells;
+    long steps;           // 累計檢查的移動次數
+    long full_grids;      // 因網格將滿而提前結束的局數
+} Checker;
+
+// 執行緒共用的狀態
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t seed;
+    long runs;            // 總局數
+    long max_steps;
+    double deadline;      // 時間上限 (單調時鐘秒數，0 表示不限制)
+    const FuzzOptions* options;
+    long next_run;
+    long first_failure;   // 最小的失敗局編號 (-1 表示沒有)
+    long runs_done;
+    long steps;
+    long full_grids;
+} FuzzShared;
+
+// 單調時鐘 (秒)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool fail(FuzzFailure* f, FuzzKind kind, long step, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    f->kind = kind;
+    f->step = step;
+    vsnprintf(f->message, sizeof(f->message), fmt, ap);
+    va_end(ap);
+    return false;
+}
+
+//==============================================================
+// [ 檢查器 ]
+//==============================================================
+static void checker_free(Checker* c)
+{
+    game_state_free(&c->game);
+    game_state_free(&c->again);
+    free(c->sim);
+    free(c->stamp);
+    free(c->wall);
+    memset(c, 0, sizeof(*c));
+}
+
+// 確保緩衝區足夠容納 width x height 的網格
+static bool checker_reserve(Checker* c, int width, int height)
+{
+    size_t cells = (size_t)width * height;
+    if (cells > c->cell_capacity) {
+        free(c->stamp);
+        free(c->wall);
+        c->stamp = (uint32_t*)calloc(cells, sizeof(uint32_t));
+        c->wall = (uint8_t*)calloc(cells, 1);
+        c->cell_capacity = c->stamp && c->wall ? cells : 0;
+        c->epoch = 0;
+        if (!c->cell_capacity) return false;
+    }
+    size_t sim_size = game_sim_size(width, height);
+    if (sim_size > c->sim_capacity) {
+        free(c->sim);
+        c->sim = (GameSim*)calloc(sim_size / sizeof(uint64_t), sizeof(uint64_t));
+        c->sim_capacity = c->sim ? sim_size : 0;
+        if (!c->sim) return false;
+    }
+    return true;
+}
+
+// 兩格是否相鄰 (含邊界循環)
+static bool adjacent(const GameState* g, Point a, Point b)
+{
+    int dx = abs(a.x - b.x), dy = abs(a.y - b.y);
+    if (dx == g->width - 1) dx = 1;
+    if (dy == g->height - 1) dy = 1;
+    return dx + dy == 1;
+}
+
+// 從格子往方向前進一格 (含邊界循環)
+static Point advance(const GameState* g, Point p, Direction d)
+{
+    switch (d) {
+    case DIR_UP:    p.y = (p.y == 0) ? g->height - 1 : p.y - 1; break;
+    case DIR_DOWN:  p.y = (p.y == g->height - 1) ? 0 : p.y + 1; break;
+    case DIR_LEFT:  p.x = (p.x == 0) ? g->width - 1 : p.x - 1; break;
+    case DIR_RIGHT: p.x = (p.x == g->width - 1) ? 0 : p.x + 1; break;
+    }
+    return p;
+}
+
+// 檢查整個局面的結構性質，並以新的 epoch 記錄存活的蛇佔用的格子 (下一步的碰撞計算使用)
+static bool check_state(Checker* c, const GameState* g, long step, const FuzzOptions* opt, FuzzFailure* f)
+{
+    if (++c->epoch == 0) {
+        memset(c->stamp, 0, c->cell_capacity * sizeof(uint32_t));
+        c->epoch = 1;
+    }
+    for (int p = 0; p < g->player_count; p++) {
+        const Player* pl = &g->players[p];
+        const SnakeBody* body = &pl->body;
+        if (body->length < 1 || body->length != 1 + pl->score) {
+            return fail(f, FUZZ_LENGTH, step, "player %d: length %d with score %d", p + 1, body->length, pl->score);
+        }
+        int expected = START_INTERVAL;
+        if (g->slow_on_eat) {
+            expected += 5 * pl->score;
+            if (expected > MAX_INTERVAL) expected = MAX_INTERVAL;
+        }
+        if (pl->interval != expected) {
+            return fail(f, FUZZ_TIMING, step, "player %d: interval %d, expected %d after %d foods",
+                p + 1, pl->interval, expected, pl->score);
+        }
+        Point prev = snake_body_at(body, 0);
+        for (int i = 0; i < body->length; i++) {
+            Point s = snake_body_at(body, i);
+            if (s.x < 0 || s.x >= g->width || s.y < 0 || s.y >= g->height) {
+                return fail(f, FUZZ_CONTIGUITY, step, "player %d: segment %d at (%d,%d) is off the grid", p + 1, i, s.x, s.y);
+            }
+            if (i > 0 && !adjacent(g, prev, s)) {
+                return fail(f, FUZZ_CONTIGUITY, step, "player %d: segments %d (%d,%d) and %d (%d,%d) are not adjacent",
+                    p + 1, i - 1, prev.x, prev.y, i, s.x, s.y);
+            }
+            prev = s;
+            if (!pl->alive) continue;
+            int cell = s.y * g->width + s.x;
+            if (c->wall[cell]) {
+                return fail(f, FUZZ_OVERLAP, step, "player %d: segment %d at (%d,%d) is on an obstacle", p + 1, i, s.x, s.y);
+            }
+            if (c->stamp[cell] == c->epoch) {
+                return fail(f, FUZZ_OVERLAP, step, "player %d: segment %d at (%d,%d) overlaps a live snake", p + 1, i, s.x, s.y);
+            }
+            c->stamp[cell] = c->epoch;
+        }
+        if (opt->score_limit > 0 && pl->score >= opt->score_limit) {
+            return fail(f, FUZZ_SCORE, step, "player %d reached score %d", p + 1, pl->score);
+        }
+    }
+
+    Point food = g->food;
+    if (food.x < 0 || food.x >= g->width || food.y < 0 || food.y >= g->height) {
+        return fail(f, FUZZ_FOOD, step, "food at (%d,%d) is off the grid", food.x, food.y);
+    }
+    int fc = food.y * g->width + food.x;
+    if (c->wall[fc]) return fail(f, FUZZ_FOOD, step, "food at (%d,%d) is on an obstacle", food.x, food.y);
+    if (c->stamp[fc] == c->epoch) return fail(f, FUZZ_FOOD, step, "food at (%d,%d) is inside a live snake", food.x, food.y);
+
+    uint64_t incremental = g->body_hash;
+    if (game_rehash((GameState*)g) != incremental) {
+        return fail(f, FUZZ_HASH, step, "incremental body hash %016llx, recomputed %016llx",
+            (unsigned long long)incremental, (unsigned long long)g->body_hash);
+    }
+    return true;
+}
+
+// 獨立計算的勝負 (先比分數，再比存活秒數)
+static int expected_winner(const GameState* g)
+{
+    const Player* a = &g->players[0];
+    const Player* b = &g->players[1];
+    if (a->score != b->score) return a->score > b->score ? 1 : 2;
+    long sa = a->survival_ms / 1000, sb = b->survival_ms / 1000;
+    if (sa != sb) return sa > sb ? 1 : 2;
+    return 0;
+}
+
+// 播放一個重播並逐步檢查，成功時輸出最後的雜湊與移動次數
+static bool checker_run(Checker* c, const GameReplay* replay, const FuzzOptions* opt, FuzzFailure* f,
+    uint64_t* final_hash, long* final_steps)
+{
+    GameState* g = &c->game;
+    GameReplayCursor cursor;
+    if (!checker_reserve(c, replay->width, replay->height) || !game_replay_start(&cursor, replay, g)) {
+        return fail(f, FUZZ_SETUP, -1, "cannot start a %dx%d game with %d players",
+            replay->width, replay->height, replay->player_count);
+    }
+
+    // 障礙物格子
+    int cells = g->width * g->height;
+    memset(c->wall, 0, (size_t)cells);
+    c->wall_cells = 0;
+    for (int i = 0; i < g->obstacle_count; i++) {
+        const Obstacle* o = &g->obstacles[i];
+        for (int y = o->y; y < o->y + o->height; y++) {
+            for (int x = o->x; x < o->x + o->width; x++) {
+                if (!c->wall[y * g->width + x]) c->wall_cells++;
+                c->wall[y * g->width + x] = 1;
+            }
+        }
+    }
+    GameSimWalls* walls = game_sim_walls_from_state(g);
+    if (!walls) return fail(f, FUZZ_SETUP, -1, "out of memory");
+    game_sim_from_state(c->sim, g, walls);
+    game_sim_walls_release(walls);
+
+    bool ok = check_state(c, g, -1, opt, f);
+    while (ok) {
+        // 網格將滿時食物無處生成 (game_generate_food 會一直重試)，提前結束這一局
+        int free_cells = cells - c->wall_cells;
+        for (int p = 0; p < g->player_count; p++) {
+            if (g->players[p].alive) free_cells -= g->players[p].body.length;
+        }
+        if (free_cells <= 1) {
+            c->full_grids++;
+            break;
+        }
+
+        // 移動前的狀態
+        Player before[MAX_PLAYERS];
+        Point heads[MAX_PLAYERS];
+        int mover = -1;
+        long best = 0;
+        for (int p = 0; p < g->player_count; p++) {
+            before[p] = g->players[p];
+            heads[p] = snake_body_at(&g->players[p].body, 0);
+            if (!before[p].alive) continue;
+            long due = before[p].elapsed_ms + before[p].interval;
+            if (mover < 0 || due < best) {
+                mover = p;
+                best = due;
+            }
+        }
+        Point food = g->food;
+        long step = cursor.step;
+        int first_input = cursor.next_input;
+
+        GameEvent event = GAME_EVENT_NONE;
+        int p = game_replay_next(&cursor, &event);
+        if (p < 0) {
+            if (mover >= 0 && step < replay->steps) {
+                ok = fail(f, FUZZ_MOVER, step, "no player moved although player %d is alive", mover + 1);
+            }
+            break;
+        }
+        if (p != mover) {
+            ok = fail(f, FUZZ_MOVER, step, "player %d moved, expected player %d", p + 1, mover + 1);
+            break;
+        }
+
+        // 與 GameState 相同的輸入與移動
+        for (int i = first_input; i < cursor.next_input; i++) {
+            const GameReplayInput* in = &replay->inputs[i];
+            if (in->player < g->player_count) game_sim_turn(c->sim, in->player, (Direction)in->direction);
+        }
+        GameEvent sim_event = game_sim_step(c->sim, p);
+
+        const Player* pl = &g->players[p];
+        Point head = snake_body_at(&pl->body, 0);
+        Point target = advance(g, heads[p], pl->direction);
+        int tc = target.y * g->width + target.x;
+        bool blocked = c->wall[tc] || c->stamp[tc] == c->epoch;
+
+        static const Direction opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+        if (pl->direction != pl->next_direction) {
+            ok = fail(f, FUZZ_MOVER, step, "player %d moved %d but still has pending direction %d",
+                p + 1, pl->direction, pl->next_direction);
+        }
+        else if (pl->elapsed_ms != before[p].elapsed_ms + before[p].interval) {
+            ok = fail(f, FUZZ_TIMING, step, "player %d: elapsed %ld, expected %ld",
+                p + 1, pl->elapsed_ms, before[p].elapsed_ms + before[p].interval);
+        }
+        else if (opt->no_reverse && before[p].body.length >= 2 && pl->direction == opposite[before[p].direction]) {
+            ok = fail(f, FUZZ_REVERSE, step, "player %d reversed from direction %d into its own neck",
+                p + 1, before[p].direction);
+        }
+        else if ((event == GAME_EVENT_DIED) != blocked) {
+            ok = fail(f, FUZZ_COLLISION, step, "player %d moved to (%d,%d): %s, but the cell is %s",
+                p + 1, target.x, target.y, event == GAME_EVENT_DIED ? "died" : "survived",
+                blocked ? "blocked" : "free");
+        }
+        else if (event == GAME_EVENT_DIED) {
+            if (pl->alive || pl->survival_ms != pl->elapsed_ms || pl->body.length != before[p].body.length
+                || head.x != heads[p].x || head.y != heads[p].y)
+            {
+                ok = fail(f, FUZZ_COLLISION, step, "player %d died but its state changed (alive %d, survival %ld)",
+                    p + 1, pl->alive, pl->survival_ms);
+            }
+        }
+        else if (head.x != target.x || head.y != target.y) {
+            ok = fail(f, FUZZ_LENGTH, step, "player %d: head at (%d,%d), expected (%d,%d)",
+                p + 1, head.x, head.y, target.x, target.y);
+        }
+        else if ((event == GAME_EVENT_ATE) != (target.x == food.x && target.y == food.y)) {
+            ok = fail(f, FUZZ_FOOD, step, "player %d at (%d,%d) with food at (%d,%d): event %d",
+                p + 1, target.x, target.y, food.x, food.y, event);
+        }
+        else if (event == GAME_EVENT_ATE && (pl->body.length != before[p].body.length + 1 || pl->score != before[p].score + 1)) {
+            ok = fail(f, FUZZ_LENGTH, step, "player %d ate: length %d -> %d, score %d -> %d",
+                p + 1, before[p].body.length, pl->body.length, before[p].score, pl->score);
+        }
+        else if (event == GAME_EVENT_NONE && (pl->body.length != before[p].body.length || g->food.x != food.x || g->food.y != food.y)) {
+            ok = fail(f, FUZZ_LENGTH, step, "player %d moved without eating: length %d -> %d, food moved %s",
+                p + 1, before[p].body.length, pl->body.length, (g->food.x != food.x || g->food.y != food.y) ? "yes" : "no");
+        }
+        if (!ok) break;
+
+        for (int q = 0; q < g->player_count && ok; q++) {
+            const Player* o = &g->players[q];
+            if (q == p) continue;
+            if (o->alive != before[q].alive || o->elapsed_ms != before[q].elapsed_ms
+                || o->score != before[q].score || o->body.length != before[q].body.length)
+            {
+                ok = fail(f, FUZZ_MOVER, step, "player %d changed while player %d moved", q + 1, p + 1);
+            }
+        }
+        if (!ok || !check_state(c, g, step, opt, f)) {
+            ok = false;
+            break;
+        }
+        if (sim_event != event || game_sim_hash(c->sim) != game_hash(g)) {
+            ok = fail(f, FUZZ_SIM, step, "GameSim diverged (event %d vs %d)", sim_event, event);
+            break;
+        }
+    }
+    game_sim_release(c->sim);
+    c->steps += cursor.step;
+    if (!ok) return false;
+
+    if (g->player_count == 2) {
+        int expected = expected_winner(g);
+        int first = game_decide_winner(g);
+        int second = game_decide_winner(g);
+        if (first != expected || second != first) {
+            return fail(f, FUZZ_WINNER, cursor.step, "winner %d then %d, expected %d (scores %d-%d, survival %ld-%ld ms)",
+                first, second, expected, g->players[0].score, g->players[1].score,
+                g->players[0].survival_ms, g->players[1].survival_ms);
+        }
+    }
+    *final_hash = game_hash(g);
+    *final_steps = cursor.step;
+    return true;
+}
+
+// 在另一份狀態上再播放一次，確認結果與第一次完全相同
+static bool check_determinism(Checker* c, const GameReplay* replay, uint64_t hash, long steps, FuzzFailure* f)
+{
+    GameReplayCursor cursor;
+    if (!game_replay_start(&cursor, replay, &c->again)) return fail(f, FUZZ_SETUP, -1, "cannot restart the replay");
+    while (cursor.step < steps && game_replay_next(&cursor, NULL) >= 0) {}
+    if (cursor.step != steps || game_hash(&c->again) != hash) {
+        return fail(f, FUZZ_DETERMINISM, cursor.step, "second playback ended after %ld steps with hash %016llx, first after %ld with %016llx",
+            cursor.step, (unsigned long long)game_hash(&c->again), steps, (unsigned long long)hash);
+    }
+    return true;
+}
+
+// 檢查一個重播 (含確定性)
+static bool check_replay(Checker* c, const GameReplay* replay, const FuzzOptions* opt, FuzzFailure* f)
+{
+    uint64_t hash = 0;
+    long steps = 0;
+    if (!checker_run(c, replay, opt, f, &hash, &steps)) return false;
+    return check_determinism(c, replay, hash, steps, f);
+}
+
+//==============================================================
+// [ 產生重播 ]
+//==============================================================
+// 由種子與局編號產生重播：隨機的網格尺寸、玩家數與輸入 (偶爾在同一步連按兩次)
+static void generate(GameReplay* r, uint64_t seed, long run, long max_steps)
+{
+    static const int grids[][2] = { { GRID_WIDTH, GRID_HEIGHT }, { 16, 8 }, { 10, 6 }, { 7, 5 }, { 6, 4 } };
+    uint64_t rng = seed ^ ((uint64_t)run * 0x9E3779B97F4A7C15ull);
+    rng = (rng ^ (rng >> 31)) * 0xBF58476D1CE4E5B9ull;
+    if (rng == 0) rng = 1;
+
+    const int* grid = grids[game_rng_next(&rng, 5)];
+    r->width = grid[0];
+    r->height = grid[1];
+    r->player_count = 1 + game_rng_next(&rng, 2);
+    r->seed = rng;
+    r->steps = max_steps;
+    r->input_count = 0;
+    int quiet = 1 + game_rng_next(&rng, 8); // 每局不同的輸入密度
+    for (long s = 0; s < max_steps; s++) {
+        int k = game_rng_next(&rng, 4 * quiet);
+        if (k >= 2) continue;
+        int player = game_rng_next(&rng, r->player_count);
+        game_replay_add(r, s, player, (Direction)game_rng_next(&rng, 4));
+        if (k == 0) game_replay_add(r, s, player, (Direction)game_rng_next(&rng, 4));
+    }
+}
+
+//==============================================================
+// [ 縮小 ]
+//==============================================================
+// 重播是否仍以相同的性質失敗
+static bool still_fails(Checker* c, const GameReplay* r, const FuzzOptions* opt, FuzzKind kind, FuzzFailure* f)
+{
+    FuzzFailure tmp;
+    if (check_replay(c, r, opt, &tmp) || tmp.kind != kind) return false;
+    *f = tmp;
+    return true;
+}
+
+// 截斷到失敗的那一步，並移除之後的輸入
+static void truncate_to(GameReplay* r, const FuzzFailure* f)
+{
+    if (f->step >= 0 && f->step + 1 < r->steps) r->steps = f->step + 1;
+    while (r->input_count > 0 && r->inputs[r->input_count - 1].step >= (uint32_t)r->steps) r->input_count--;
+}
+
+// 反覆移除輸入區段 (ddmin)，直到移除任何一個輸入都不再以相同的性質失敗
+static void shrink(Checker* c, GameReplay* r, const FuzzOptions* opt, FuzzFailure* f)
+{
+    GameReplay candidate;
+    memset(&candidate, 0, sizeof(candidate));
+    truncate_to(r, f);
+    int tries = 0;
+    for (int chunk = r->input_count / 2 > 0 ? r->input_count / 2 : 1; chunk >= 1 && r->input_count > 0;) {
+        bool progress = false;
+        for (int i = 0; i < r->input_count;) {
+            if (!game_replay_copy(&candidate, r)) goto done;
+            int n = (i + chunk <= candidate.input_count) ? chunk : candidate.input_count - i;
+            memmove(&candidate.inputs[i], &candidate.inputs[i + n],
+                (size_t)(candidate.input_count - i - n) * sizeof(GameReplayInput));
+            candidate.input_count -= n;
+            tries++;
+            if (still_fails(c, &candidate, opt, f->kind, f)) {
+                truncate_to(&candidate, f);
+                game_replay_copy(r, &candidate);
+                progress = true;
+            }
+            else {
+                i += n;
+            }
+        }
+        if (!progress) {
+            if (chunk == 1) break;
+            chunk /= 2;
+        }
+        else if (chunk > r->input_count / 2 && r->input_count > 1) {
+            chunk = r->input_count / 2;
+        }
+    }
+done:
+    game_replay_free(&candidate);
+    printf("shrink: %d candidates tried, %d inputs and %ld steps remain\n", tries, r->input_count, r->steps);
+}
+
+//==============================================================
+// [ 執行緒 ]
+//==============================================================
+static void* worker_main(void* arg)
+{
+    FuzzShared* sh = (FuzzShared*)arg;
+    Checker c;
+    memset(&c, 0, sizeof(c));
+    GameReplay r;
+    memset(&r, 0, sizeof(r));
+    if (!game_state_init(&c.game, GRID_WIDTH, GRID_HEIGHT) || !game_state_init(&c.again, GRID_WIDTH, GRID_HEIGHT)) {
+        checker_free(&c);
+        return NULL;
+    }
+
+    long done = 0;
+    for (;;) {
+        pthread_mutex_lock(&sh->lock);
+        long begin = sh->next_run;
+        bool stop = begin >= sh->runs || (sh->first_failure >= 0 && begin > sh->first_failure)
+            || (sh->deadline > 0 && now_sec() > sh->deadline);
+        sh->next_run += FUZZ_BATCH;
+        pthread_mutex_unlock(&sh->lock);
+        if (stop) break;
+
+        long end = begin + FUZZ_BATCH < sh->runs ? begin + FUZZ_BATCH : sh->runs;
+        for (long run = begin; run < end; run++) {
+            generate(&r, sh->seed, run, sh->max_steps);
+            FuzzFailure f;
+            done++;
+            if (!check_replay(&c, &r, sh->options, &f)) {
+                pthread_mutex_lock(&sh->lock);
+                if (sh->first_failure < 0 || run < sh->first_failure) sh->first_failure = run;
+                pthread_mutex_unlock(&sh->lock);
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&sh->lock);
+    sh->runs_done += done;
+    sh->steps += c.steps;
+    sh->full_grids += c.full_grids;
+    pthread_mutex_unlock(&sh->lock);
+    game_replay_free(&r);
+    checker_free(&c);
+    return NULL;
+}
+
+//==============================================================
+// [ 主程式 ]
+//==============================================================
+static void print_failure(long run, const FuzzFailure* f)
+{
+    if (run >= 0) printf("FAIL run %ld: ", run);
+    else printf("FAIL: ");
+    printf("[%s] after step %ld: %s\n", fuzz_kind_names[f->kind], f->step, f->message);
+}
+
+// 檢查單一重播檔
+static int check_file(const char* path, const FuzzOptions* opt)
+{
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return 2;
+    }
+    GameReplay r;
+    memset(&r, 0, sizeof(r));
+    bool loaded = game_replay_read(&r, in);
+    fclose(in);
+    if (!loaded) {
+        fprintf(stderr, "%s: not a valid replay\n", path);
+        game_replay_free(&r);
+        return 2;
+    }
+
+    Checker c;
+    memset(&c, 0, sizeof(c));
+    game_state_init(&c.game, r.width, r.height);
+    game_state_init(&c.again, r.width, r.height);
+    FuzzFailure f;
+    uint64_t hash = 0;
+    long steps = 0;
+    int status = 0;
+    if (!checker_run(&c, &r, opt, &f, &hash, &steps) || !check_determinism(&c, &r, hash, steps, &f)) {
+        print_failure(-1, &f);
+        status = 1;
+    }
+    else {
+        printf("ok: %dx%d, %d players, %d inputs, %ld steps, final hash %016llx\n",
+            r.width, r.height, r.player_count, r.input_count, steps, (unsigned long long)hash);
+    }
+    checker_free(&c);
+    game_replay_free(&r);
+    return status;
+}
+
+int main(int argc, char** argv)
+{
+    long runs = 200000;
+    long max_steps = 3000;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = 1;
+    double seconds = 0;
+    const char* replay_path = NULL;
+    const char* out_path = NULL;
+    FuzzOptions opt = { 0, false };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) runs = atol(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) max_steps = atol(argv[++i]);
+        else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) replay_path = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            const char* p = argv[++i];
+            if (strncmp(p, "score:", 6) == 0) opt.score_limit = atoi(p + 6);
+            else if (strcmp(p, "reverse") == 0) opt.no_reverse = true;
+            else {
+                fprintf(stderr, "unknown property: %s\n", p);
+                return 2;
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n runs] [-t threads] [-s seed] [-m max-steps] [-T seconds]\n"
+                "       [-p score:N|reverse] [-o minimal-replay] | -r replay\n", argv[0]);
+            return 2;
+        }
+    }
+    if (replay_path) return check_file(replay_path, &opt);
+    if (threads < 1) threads = 1;
+    if (seconds > 0 && runs == 200000) runs = 1L << 40; // 只指定時間時不限制局數
+
+    FuzzShared sh;
+    memset(&sh, 0, sizeof(sh));
+    pthread_mutex_init(&sh.lock, NULL);
+    sh.seed = seed;
+    sh.runs = runs;
+    sh.max_steps = max_steps;
+    sh.options = &opt;
+    sh.first_failure = -1;
+    double t0 = now_sec();
+    if (seconds > 0) sh.deadline = t0 + seconds;
+
+    pthread_t* tids = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)threads);
+    if (!tids) return 1;
+    for (int t = 0; t < threads; t++) pthread_create(&tids[t], NULL, worker_main, &sh);
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    free(tids);
+    pthread_mutex_destroy(&sh.lock);
+
+    double elapsed = now_sec() - t0;
+    printf("fuzz: %ld runs, %ld steps in %.2f s (%d threads): %.2f M steps/s, %ld runs stopped on a full grid\n",
+        sh.runs_done, sh.steps, elapsed, threads, sh.steps / elapsed / 1e6, sh.full_grids);
+    if (sh.first_failure < 0) {
+        printf("no property violated\n");
+        return 0;
+    }
+
+    // 重新產生最小的失敗局，縮小並輸出
+    Checker c;
+    memset(&c, 0, sizeof(c));
+    game_state_init(&c.game, GRID_WIDTH, GRID_HEIGHT);
+    game_state_init(&c.again, GRID_WIDTH, GRID_HEIGHT);
+    GameReplay r;
+    memset(&r, 0, sizeof(r));
+    generate(&r, seed, sh.first_failure, max_steps);
+    FuzzFailure f;
+    if (check_replay(&c, &r, &opt, &f)) {
+        printf("run %ld failed on a worker but passes when replayed: nondeterministic failure\n", sh.first_failure);
+    }
+    else {
+        print_failure(sh.first_failure, &f);
+        shrink(&c, &r, &opt, &f);
+        print_failure(-1, &f);
+        FILE* out = out_path ? fopen(out_path, "w") : stdout;
+        if (!out) perror(out_path);
+        else {
+            fprintf(out, "# minimal replay: [%s] after step %ld: %s\n", fuzz_kind_names[f.kind], f.step, f.message);
+            game_replay_write(&r, out);
+            if (out != stdout) {
+                fclose(out);
+                printf("minimal replay written to %s\n", out_path);
+            }
+        }
+    }
+    game_replay_free(&r);
+    checker_free(&c);
+    return 1;
+}
@@ -0,0 +1,190 @@
+// 最高分紀錄的效能測試 (Linux，無介面)。
+// 以隨機的成績建立大型紀錄檔，量測附加 (有無等待寫到磁碟)、載入、查詢與壓縮的時間，
+// 並確認壓縮後重新載入的排行榜與原本相同、壓縮後的紀錄數有上限、截斷的檔尾會被偵測並修復。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/score_bench.c source/game_scores.c -o score_bench
+//   ./score_bench [紀錄數] [路徑]     (預設 2000000 筆，/tmp/score_bench.log)
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_scores.h"
+
+// 量測附加時間的筆數
+#define APPEND_RUNS 2000
+#define APPEND_SYNC_RUNS 200
+// 量測查詢時間的次數
+#define QUERY_RUNS 1000000
+// 成績分布在幾種網格尺寸
+#define BOARD_SIZES 3
+
+static const uint16_t board_sizes[BOARD_SIZES][2] = { { 40, 20 }, { 60, 30 }, { 80, 40 } };
+
+// 單調時鐘 (微秒)
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 簡單的亂數 (splitmix64)
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// 產生一局的成績：每局的種子都不同，網格尺寸從幾種中選一種
+static GameScoreRecord random_record(uint64_t* rng, long i)
+{
+    GameScoreRecord r = { 0 };
+    uint64_t x = next_random(rng);
+    r.seed = (uint64_t)i;
+    r.time = 1700000000 + i;
+    r.score = (int32_t)(next_random(rng) % 400);
+    r.width = board_sizes[x % BOARD_SIZES][0];
+    r.height = board_sizes[x % BOARD_SIZES][1];
+    r.length = (uint16_t)(3 + r.score);
+    return r;
+}
+
+// 比較兩個索引的排行榜
+static int same_top(const GameScores* a, const GameScores* b)
+{
+    int na, nb;
+    const GameScoreRecord* ta = game_scores_top(a, &na);
+    const GameScoreRecord* tb = game_scores_top(b, &nb);
+    if (na != nb) return 0;
+    for (int i = 0; i < na; i++) {
+        if (ta[i].seed != tb[i].seed || ta[i].score != tb[i].score || ta[i].time != tb[i].time) return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    long count = argc > 1 ? atol(argv[1]) : 2000000;
+    const char* path = argc > 2 ? argv[2] : "/tmp/score_bench.log";
+    if (count < 1) count = 1;
+    uint64_t rng = 12345;
+
+    // 建立索引並以壓縮寫出紀錄檔
+    GameScores built;
+    game_scores_init(&built);
+    double t0 = now_us();
+    for (long i = 0; i < count; i++) {
+        GameScoreRecord r = random_record(&rng, i);
+        if (game_scores_insert(&built, &r) < 0) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+    double insert_us = now_us() - t0;
+    remove(path);
+    t0 = now_us();
+    if (!game_scores_compact(&built, path)) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    double compact_us = now_us() - t0;
+    printf("index: %ld games, %zu board sizes, insert %.3f us/game; compact %ld records in %.1f ms\n",
+        count, built.best_count, insert_us / count, built.records, compact_us / 1000.0);
+
+    // 附加 (每局一次)
+    GameScoreRecord extra[APPEND_RUNS];
+    for (int i = 0; i < APPEND_RUNS; i++) extra[i] = random_record(&rng, count + i);
+    t0 = now_us();
+    for (int i = 0; i < APPEND_RUNS; i++) game_scores_append(path, &extra[i], false);
+    double append_us = (now_us() - t0) / APPEND_RUNS;
+    t0 = now_us();
+    for (int i = 0; i < APPEND_SYNC_RUNS; i++) game_scores_append(path, &extra[i], true);
+    double append_sync_us = (now_us() - t0) / APPEND_SYNC_RUNS;
+    printf("append: %.1f us/record, %.1f us/record with sync\n", append_us, append_sync_us);
+
+    // 載入
+    GameScores loaded;
+    game_scores_init(&loaded);
+    t0 = now_us();
+    if (!game_scores_load(&loaded, path)) {
+        fprintf(stderr, "cannot load %s\n", path);
+        return 1;
+    }
+    double load_us = now_us() - t0;
+    printf("load: %ld records in %.1f ms (%.1f M records/s)\n",
+        loaded.records, load_us / 1000.0, loaded.records / load_us);
+
+    // 查詢
+    volatile long sink = 0;
+    t0 = now_us();
+    for (long i = 0; i < QUERY_RUNS; i++) {
+        const uint16_t* size = board_sizes[next_random(&rng) % BOARD_SIZES];
+        const GameScoreRecord* best = game_scores_best(&loaded, size[0], size[1]);
+        if (best) sink += best->score;
+    }
+    double best_ns = (now_us() - t0) * 1000.0 / QUERY_RUNS;
+    t0 = now_us();
+    for (long i = 0; i < QUERY_RUNS; i++) {
+        int n;
+        const GameScoreRecord* top = game_scores_top(&loaded, &n);
+        sink += top[n - 1].score;
+    }
+    double top_ns = (now_us() - t0) * 1000.0 / QUERY_RUNS;
+    printf("query: best per board size %.1f ns, top %d %.1f ns\n", best_ns, GAME_SCORES_TOP, top_ns);
+
+    // 壓縮後的排行榜不變
+    for (int i = 0; i < APPEND_RUNS; i++) game_scores_insert(&built, &extra[i]);
+    for (int i = 0; i < APPEND_SYNC_RUNS; i++) game_scores_insert(&built, &extra[i]);
+    printf("check: top after reload %s\n", same_top(&built, &loaded) ? "ok" : "MISMATCH");
+
+    // 壓縮後只剩每個網格尺寸的最佳成績與總排行榜；像介面層一樣持續附加並在需要時壓縮，紀錄檔不會無限成長
+    long bound = BOARD_SIZES + GAME_SCORES_TOP;
+    long kept = built.records;
+    GameScores steady;
+    game_scores_init(&steady);
+    long peak = 0, compactions = 0;
+    for (long i = 0; i < GAME_SCORES_COMPACT_MIN * 4L; i++) {
+        GameScoreRecord r = random_record(&rng, count + APPEND_RUNS + i);
+        game_scores_insert(&steady, &r);
+        steady.records++;
+        if (steady.records > peak) peak = steady.records;
+        if (game_scores_should_compact(&steady)) {
+            steady.records = game_scores_live(&steady);
+            compactions++;
+        }
+    }
+    printf("check: %ld records after compaction (bound %ld) %s; %ld appends peak at %ld records with %ld compactions %s\n",
+        kept, bound, kept <= bound ? "ok" : "EXCEEDED", GAME_SCORES_COMPACT_MIN * 4L, peak, compactions,
+        peak <= bound + GAME_SCORES_COMPACT_MIN ? "ok" : "EXCEEDED");
+    game_scores_free(&steady);
+
+    // 模擬寫到一半就當機：截斷的檔尾被偵測，修復後排行榜不變
+    FILE* file = fopen(path, "ab");
+    if (file) {
+        fwrite(&extra[0], 1, sizeof(GameScoreRecord) / 2, file);
+        fclose(file);
+    }
+    GameScores torn;
+    game_scores_init(&torn);
+    game_scores_load(&torn, path);
+    long torn_bytes = torn.torn;
+    int repaired = game_scores_should_compact(&torn) && game_scores_compact(&torn, path);
+    GameScores again;
+    game_scores_init(&again);
+    game_scores_load(&again, path);
+    printf("check: torn tail %ld bytes detected, repaired %s, top %s, %ld records after repair\n",
+        torn_bytes, repaired ? "ok" : "FAILED", same_top(&built, &again) ? "ok" : "MISMATCH", again.records);
+
+    game_scores_free(&built);
+    game_scores_free(&loaded);
+    game_scores_free(&torn);
+    game_scores_free(&again);
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,642 @@
+// snake_server 的壓力測試 (Linux)：模擬大量客戶端，每個客戶端一個通訊端，
+// 送出 JOIN 後每隔一段隨機時間向左或向右轉，並在 MOVE 回應時間戳時量出輸入到廣播的往返時間。
+// 對局結束 (OVER) 後重新加入；UDP 的 JOIN 與未確認的輸入會重送，TCP 斷線後重新連線。
+// 客戶端平均分配給數個執行緒，每個執行緒以 epoll 等待自己的通訊端。
+// 另外可以加入觀眾：以 UDP 要求觀看任一房間，用 game_spectate 套用串流，偵測到遺漏時要求關鍵影格，
+// 對局結束後改看另一個房間；統計每位觀眾每個影格收到的位元組數。
+//
+// 建置與執行 (先啟動 snake_server)：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/server_load.c source/game_room.c source/game_spectate.c source/game_core.c -o server_load
+//   ./server_load -c 4000 -t 25 -d 30
+//   ./server_load -c 200 -v 8000 -d 30      (觀戰：少數房間、大量觀眾)
+// 選項：
+//   -h 伺服器位址 (預設 127.0.0.1)  -p 埠號  -c 客戶端數  -j 執行緒數  -t 使用 TCP 的百分比
+//   -d 執行秒數  -r 平均轉向間隔 (毫秒)  -R 開始時加入的分散時間 (毫秒)  -v 觀眾數
+
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include "game_core.h"
+#include "game_room.h"
+#include "game_spectate.h"
+
+//========================[ 常數 ]========================
+#define MAX_THREADS 64
+#define HIST_BUCKETS 512
+#define RESEND_MS 200.0           // 未確認的輸入重送間隔
+#define JOIN_RESEND_MS 1000.0     // 沒有收到 WELCOME 時重送 JOIN
+#define SILENCE_MS 5000.0         // 這麼久沒有收到訊息就重新加入
+#define SCAN_MS 5                 // 檢查要轉向或重送的間隔
+#define WATCH_RENEW_MS 2000.0     // 觀眾續訂的間隔
+#define WATCH_RETRY_MS 200.0      // 觀眾要求關鍵影格的最短間隔
+#define FEED_PACKET_BYTES 1024    // 觀戰封包的上限
+
+//========================[ 結構定義 ]========================
+typedef enum {
+    CLIENT_IDLE,                  // 尚未加入
+    CLIENT_JOINING,               // 等待 WELCOME (觀眾：等待第一個串流封包)
+    CLIENT_PLAYING                // 對局中 (觀眾：觀看中)
+} ClientState;
+
+typedef struct {
+    int fd;
+    bool tcp;
+    GameSpectateView* view;       // 觀眾的局面 (玩家為NULL)
+    ClientState state;
+    uint32_t id;
+    struct sockaddr_in worker;    // UDP：送出輸入的位址 (WELCOME 的來源；觀眾為串流的來源)
+    uint32_t room;
+    uint8_t player;
+    Direction direction;          // 自己的蛇目前的方向
+    bool alive;
+    uint16_t seq, acked;          // 最後送出與伺服器確認的序號
+    uint8_t last_dir;             // 最後送出的方向 (重送用)
+    uint32_t last_stamp;
+    double next_turn_ms, input_sent_ms, join_sent_ms, heard_ms;
+    int in_length;
+    uint8_t in[256];
+    uint64_t rng;
+} LoadClient;
+
+typedef struct {
+    uint64_t counts[HIST_BUCKETS];
+} Histogram;
+
+typedef struct {
+    int index;
+    pthread_t thread;
+    LoadClient* clients;
+    int count;
+    int epoll_fd;
+    // 統計
+    uint64_t games, moves, inputs, resends, rejoins, timeouts, errors;
+    uint64_t feed_packets, feed_bytes, feed_keyframes, feed_gaps, feed_overs; // 觀眾
+    Histogram rtt;                // 輸入送出到時間戳回應 (微秒)
+    Histogram join;               // JOIN 到 WELCOME (微秒)
+} LoadThread;
+
+static struct sockaddr_in server_addr;
+static double start_ms, end_ms, turn_ms = 250.0, ramp_ms = 1000.0;
+static volatile sig_atomic_t load_stop = 0;
+
+//==============================================================
+// [ 共用 ]
+//==============================================================
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+// 時間戳：微秒的低32位元
+static uint32_t stamp_now(void)
+{
+    return (uint32_t)(uint64_t)(now_ms() * 1000.0);
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    load_stop = 1;
+}
+
+static uint64_t next_random(uint64_t* state)
+{
+    uint64_t x = (*state += 0x9E3779B97F4A7C15ull);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// [0,1) 的亂數
+static double random_unit(uint64_t* state)
+{
+    return (double)(next_random(state) >> 11) / 9007199254740992.0;
+}
+
+static int hist_bucket(uint64_t v)
+{
+    if (v < 8) return (int)v;
+    int e = 63 - __builtin_clzll(v);
+    return (e - 2) * 8 + (int)((v >> (e - 3)) & 7);
+}
+
+static uint64_t hist_upper(int b)
+{
+    if (b < 8) return (uint64_t)b;
+    int e = b / 8 + 2;
+    return ((uint64_t)(8 + b % 8 + 1) << (e - 3)) - 1;
+}
+
+static uint64_t hist_percentile(const Histogram* h, double q)
+{
+    uint64_t total = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) total += h->counts[b];
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1, seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) return hist_upper(b);
+    }
+    return hist_upper(HIST_BUCKETS - 1);
+}
+
+static uint64_t hist_total(const Histogram* h)
+{
+    uint64_t total = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) total += h->counts[b];
+    return total;
+}
+
+//==============================================================
+// [ 客戶端 ]
+//==============================================================
+static bool client_send(LoadThread* t, LoadClient* c, const GameRoomMessage* m, const struct sockaddr_in* to)
+{
+    uint8_t buffer[GAME_ROOM_MAX_MESSAGE];
+    int length = game_room_encode(m, buffer);
+    ssize_t n = c->tcp ? send(c->fd, buffer, (size_t)length, MSG_NOSIGNAL)
+        : sendto(c->fd, buffer, (size_t)length, 0, (const struct sockaddr*)to, sizeof(*to));
+    if (n != length) {
+        t->errors++;
+        return false;
+    }
+    return true;
+}
+
+static void client_close(LoadThread* t, LoadClient* c)
+{
+    if (c->fd >= 0) {
+        epoll_ctl(t->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+        close(c->fd);
+    }
+    c->fd = -1;
+}
+
+// 開啟通訊端 (TCP 以阻塞方式連線，之後改為非阻塞)
+static bool client_open(LoadThread* t, LoadClient* c)
+{
+    c->fd = socket(AF_INET, c->tcp ? SOCK_STREAM : SOCK_DGRAM, 0);
+    if (c->fd < 0) {
+        t->errors++;
+        return false;
+    }
+    if (c->tcp) {
+        int on = 1;
+        setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        if (connect(c->fd, (const struct sockaddr*)&server_addr, sizeof(server_addr)) != 0) {
+            t->errors++;
+            close(c->fd);
+            c->fd = -1;
+            return false;
+        }
+    }
+    int flags = fcntl(c->fd, F_GETFL, 0);
+    fcntl(c->fd, F_SETFL, flags | O_NONBLOCK);
+    struct epoll_event ev = { EPOLLIN, { .u32 = (uint32_t)(c - t->clients) } };
+    epoll_ctl(t->epoll_fd, EPOLL_CTL_ADD, c->fd, &ev);
+    c->in_length = 0;
+    return true;
+}
+
+// 送出 JOIN (TCP 每次加入都是新的連線，UDP 重複使用同一個通訊端)
+static void client_join(LoadThread* t, LoadClient* c, double now)
+{
+    if (c->fd < 0 && !client_open(t, c)) {
+        c->state = CLIENT_IDLE;
+        c->next_turn_ms = now + JOIN_RESEND_MS; // 稍後再試
+        return;
+    }
+    GameRoomMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = ROOM_MSG_JOIN;
+    m.client_id = c->id;
+    client_send(t, c, &m, &server_addr);
+    c->state = CLIENT_JOINING;
+    c->join_sent_ms = c->heard_ms = now;
+}
+
+// 重新加入 (對局結束、斷線或逾時)
+static void client_rejoin(LoadThread* t, LoadClient* c, double now)
+{
+    if (c->tcp) client_close(t, c);
+    c->id++; // 新的客戶端編號，大廳不會當成重送的 JOIN
+    client_join(t, c, now);
+}
+
+// 送出目前的輸入 (新的轉向或重送)
+static void client_send_input(LoadThread* t, LoadClient* c, double now)
+{
+    GameRoomMessage m;
+    memset(&m, 0, sizeof(m));
+    m.type = ROOM_MSG_INPUT;
+    m.room = c->room;
+    m.player = c->player;
+    m.seq = c->seq;
+    m.direction = c->last_dir;
+    m.stamp = c->last_stamp;
+    client_send(t, c, &m, &c->worker);
+    c->input_sent_ms = now;
+}
+
+// 處理伺服器的訊息；返回false表示這個通訊端已經關閉 (重新加入)
+static bool client_receive(LoadThread* t, LoadClient* c, const GameRoomMessage* m,
+    const struct sockaddr_in* from, double now)
+{
+    c->heard_ms = now;
+    switch (m->type) {
+    case ROOM_MSG_WELCOME:
+        if (c->state != CLIENT_JOINING) break;
+        t->join.counts[hist_bucket((uint64_t)((now - c->join_sent_ms) * 1000.0))]++;
+        c->state = CLIENT_PLAYING;
+        c->room = m->room;
+        c->player = m->player;
+        if (from) c->worker = *from;
+        c->alive = true;
+        c->direction = (Direction)-1; // 由第一個自己的 MOVE 得知
+        c->seq = c->acked = 0;
+        c->next_turn_ms = now + GAME_ROOM_START_DELAY_MS + random_unit(&c->rng) * turn_ms;
+        break;
+    case ROOM_MSG_MOVE:
+        if (c->state != CLIENT_PLAYING) break;
+        t->moves++;
+        c->acked = m->seq;
+        if (m->player == c->player) {
+            c->direction = (Direction)m->direction;
+            if (m->event == GAME_EVENT_DIED) c->alive = false;
+            if (m->has_echo) t->rtt.counts[hist_bucket((uint32_t)(stamp_now() - m->stamp))]++;
+        }
+        break;
+    case ROOM_MSG_OVER:
+        if (c->state != CLIENT_PLAYING) break;
+        t->games++;
+        client_rejoin(t, c, now);
+        return !c->tcp;
+    default:
+        break;
+    }
+    return true;
+}
+
+//==============================================================
+// [ 觀眾 ]
+//==============================================================
+// 送出 WATCH：任一房間送到大廳，續訂與要求關鍵影格送到串流的來源
+static void viewer_watch(LoadThread* t, LoadClient* c, bool lobby, uint8_t flags, double now)
+{
+    if (c->fd < 0 && !client_open(t, c)) return;
+    uint8_t buffer[GAME_SPECTATE_WATCH_BYTES];
+    int length = game_spectate_encode_watch(lobby ? 0 : c->view->room, flags, buffer);
+    const struct sockaddr_in* to = lobby ? &server_addr : &c->worker;
+    if (sendto(c->fd, buffer, (size_t)length, 0, (const struct sockaddr*)to, sizeof(*to)) != length) t->errors++;
+    c->join_sent_ms = now;
+    if (lobby) {
+        c->state = CLIENT_JOINING;
+        c->heard_ms = now;
+    }
+}
+
+// 讀取串流並套用到觀眾的局面
+static void viewer_read(LoadThread* t, LoadClient* c, double now)
+{
+    for (;;) {
+        uint8_t data[FEED_PACKET_BYTES];
+        struct sockaddr_in from;
+        socklen_t length = sizeof(from);
+        ssize_t n = recvfrom(c->fd, data, sizeof(data), 0, (struct sockaddr*)&from, &length);
+        if (n < 0) return;
+        GameSpectateResult result = game_spectate_apply(c->view, data, (size_t)n);
+        if (result == SPECTATE_INVALID) {
+            t->errors++;
+            continue;
+        }
+        t->feed_packets++;
+        t->feed_bytes += (uint64_t)n;
+        if (data[0] == SPECTATE_KEYFRAME) t->feed_keyframes++;
+        if (result == SPECTATE_IGNORED) continue;
+        c->heard_ms = now;
+        c->worker = from;
+        c->state = CLIENT_PLAYING;
+        if (result == SPECTATE_GAP) {
+            // 遺漏了影格：向房間所在的工作執行緒要求關鍵影格
+            t->feed_gaps++;
+            if (now - c->input_sent_ms >= WATCH_RETRY_MS) {
+                viewer_watch(t, c, false, GAME_SPECTATE_WATCH_KEY, now);
+                c->input_sent_ms = now;
+            }
+        }
+        else if (c->view->over) {
+            // 對局結束，改看另一個房間
+            t->feed_overs++;
+            viewer_watch(t, c, true, GAME_SPECTATE_WATCH_KEY, now);
+        }
+    }
+}
+
+// 定期檢查：開始觀看、重送、續訂與逾時
+static void viewer_scan(LoadThread* t, LoadClient* c, double now)
+{
+    switch (c->state) {
+    case CLIENT_IDLE:
+        if (now >= c->next_turn_ms) viewer_watch(t, c, true, GAME_SPECTATE_WATCH_KEY, now);
+        break;
+    case CLIENT_JOINING:
+        if (now - c->join_sent_ms > JOIN_RESEND_MS) {
+            viewer_watch(t, c, true, GAME_SPECTATE_WATCH_KEY, now);
+            t->resends++;
+        }
+        break;
+    case CLIENT_PLAYING:
+        if (now - c->heard_ms > SILENCE_MS) {
+            t->timeouts++;
+            viewer_watch(t, c, true, GAME_SPECTATE_WATCH_KEY, now);
+        }
+        else if (now - c->join_sent_ms > WATCH_RENEW_MS) {
+            viewer_watch(t, c, false, c->view->synced ? 0 : GAME_SPECTATE_WATCH_KEY, now);
+        }
+        break;
+    }
+}
+
+//==============================================================
+// [ 讀取與定期檢查 ]
+//==============================================================
+// 讀取一個客戶端的通訊端
+static void client_read(LoadThread* t, LoadClient* c, double now)
+{
+    GameRoomMessage m;
+    if (c->view) {
+        viewer_read(t, c, now);
+        return;
+    }
+    if (!c->tcp) {
+        for (;;) {
+            uint8_t data[GAME_ROOM_MAX_MESSAGE];
+            struct sockaddr_in from;
+            socklen_t length = sizeof(from);
+            ssize_t n = recvfrom(c->fd, data, sizeof(data), 0, (struct sockaddr*)&from, &length);
+            if (n < 0) return;
+            if (game_room_decode(data, (int)n, &m) > 0) client_receive(t, c, &m, &from, now);
+        }
+    }
+    for (;;) {
+        ssize_t n = read(c->fd, c->in + c->in_length, sizeof(c->in) - (size_t)c->in_length);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        if (n <= 0) {
+            // 伺服器在 OVER 以外關閉連線 (例如房間已滿)
+            t->rejoins++;
+            client_rejoin(t, c, now);
+            return;
+        }
+        c->in_length += (int)n;
+        int offset = 0, used;
+        while ((used = game_room_decode(c->in + offset, c->in_length - offset, &m)) > 0) {
+            offset += used;
+            if (!client_receive(t, c, &m, NULL, now)) return;
+        }
+        if (used < 0) {
+            t->errors++;
+            client_rejoin(t, c, now);
+            return;
+        }
+        memmove(c->in, c->in + offset, (size_t)(c->in_length - offset));
+        c->in_length -= offset;
+    }
+}
+
+// 定期檢查：加入、轉向、重送與逾時
+static void client_scan(LoadThread* t, LoadClient* c, double now)
+{
+    if (c->view) {
+        viewer_scan(t, c, now);
+        return;
+    }
+    switch (c->state) {
+    case CLIENT_IDLE:
+        if (now >= c->next_turn_ms) client_join(t, c, now);
+        break;
+    case CLIENT_JOINING:
+        if (now - c->heard_ms > SILENCE_MS) {
+            t->timeouts++;
+            client_rejoin(t, c, now);
+        }
+        else if (!c->tcp && now - c->join_sent_ms > JOIN_RESEND_MS) {
+            // 重送同一個 JOIN (大廳以位址與客戶端編號忽略重複的)
+            GameRoomMessage m;
+            memset(&m, 0, sizeof(m));
+            m.type = ROOM_MSG_JOIN;
+            m.client_id = c->id;
+            client_send(t, c, &m, &server_addr);
+            c->join_sent_ms = now;
+            t->resends++;
+        }
+        break;
+    case CLIENT_PLAYING:
+        if (now - c->heard_ms > SILENCE_MS) {
+            t->timeouts++;
+            client_rejoin(t, c, now);
+        }
+        else if (c->alive && (int)c->direction >= 0 && now >= c->next_turn_ms) {
+            // 向左或向右轉 (與目前方向垂直)
+            bool vertical = c->direction == DIR_UP || c->direction == DIR_DOWN;
+            bool flip = (next_random(&c->rng) & 1) != 0;
+            c->last_dir = (uint8_t)(vertical ? (flip ? DIR_LEFT : DIR_RIGHT) : (flip ? DIR_UP : DIR_DOWN));
+            c->last_stamp = stamp_now();
+            c->seq++;
+            client_send_input(t, c, now);
+            c->next_turn_ms = now + turn_ms * (0.5 + random_unit(&c->rng));
+            t->inputs++;
+        }
+        else if (c->alive && !c->tcp && c->seq != c->acked && now - c->input_sent_ms > RESEND_MS) {
+            // 時間戳不變：往返時間包含遺失後重送的延遲
+            client_send_input(t, c, now);
+            t->resends++;
+        }
+        break;
+    }
+}
+
+static void* thread_main(void* arg)
+{
+    LoadThread* t = (LoadThread*)arg;
+    struct epoll_event events[256];
+    double next_scan = now_ms();
+    while (!load_stop) {
+        double now = now_ms();
+        if (now >= end_ms) break;
+        if (now >= next_scan) {
+            for (int i = 0; i < t->count; i++) client_scan(t, &t->clients[i], now);
+            next_scan = now + SCAN_MS;
+        }
+        int timeout = (int)(next_scan - now) + 1;
+        int n = epoll_wait(t->epoll_fd, events, 256, timeout > 0 ? timeout : 0);
+        now = now_ms();
+        for (int i = 0; i < n; i++) {
+            LoadClient* c = &t->clients[events[i].data.u32];
+            if (c->fd >= 0) client_read(t, c, now);
+        }
+    }
+    for (int i = 0; i < t->count; i++) client_close(t, &t->clients[i]);
+    close(t->epoll_fd);
+    return NULL;
+}
+
+//==============================================================
+// [ 入口 ]
+//==============================================================
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-h host] [-p port] [-c clients] [-j threads] [-t tcp_percent] [-d seconds]"
+        " [-r turn_ms] [-R ramp_ms] [-v viewers]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    const char* host = "127.0.0.1";
+    int port = 7300, clients = 2000, threads = 1, tcp_percent = 0, viewers = 0;
+    double duration = 20.0;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool has = i + 1 < argc;
+        if (strcmp(a, "-h") == 0 && has) host = argv[++i];
+        else if (strcmp(a, "-p") == 0 && has) port = atoi(argv[++i]);
+        else if (strcmp(a, "-c") == 0 && has) clients = atoi(argv[++i]);
+        else if (strcmp(a, "-j") == 0 && has) threads = atoi(argv[++i]);
+        else if (strcmp(a, "-t") == 0 && has) tcp_percent = atoi(argv[++i]);
+        else if (strcmp(a, "-d") == 0 && has) duration = atof(argv[++i]);
+        else if (strcmp(a, "-r") == 0 && has) turn_ms = atof(argv[++i]);
+        else if (strcmp(a, "-R") == 0 && has) ramp_ms = atof(argv[++i]);
+        else if (strcmp(a, "-v") == 0 && has) viewers = atoi(argv[++i]);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (clients < 2) clients = 2;
+    if (viewers < 0) viewers = 0;
+    if (threads < 1) threads = 1;
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if (turn_ms < 1.0) turn_ms = 1.0;
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "bad host %s\n", host);
+        return 2;
+    }
+
+    // 每個客戶端一個通訊端
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+
+    static LoadThread pool[MAX_THREADS];
+    int total_clients = clients + viewers;
+    LoadClient* all = (LoadClient*)calloc((size_t)total_clients, sizeof(LoadClient));
+    GameSpectateView* views = (GameSpectateView*)calloc((size_t)viewers + 1, sizeof(GameSpectateView));
+    if (!all || !views) return 1;
+    start_ms = now_ms();
+    end_ms = start_ms + duration * 1000.0;
+    int tcp_count = 0;
+    for (int i = 0; i < clients; i++) {
+        LoadClient* c = &all[i];
+        c->fd = -1;
+        c->id = (uint32_t)i << 12;
+        c->rng = 0x5EED0000ull + (uint64_t)i;
+        // TCP 客戶端平均分散
+        c->tcp = (i * tcp_percent) / 100 != ((i + 1) * tcp_percent) / 100;
+        tcp_count += c->tcp;
+        c->state = CLIENT_IDLE;
+        c->next_turn_ms = start_ms + random_unit(&c->rng) * ramp_ms;
+    }
+    // 觀眾在玩家之後加入，讓房間先建立
+    for (int i = clients; i < total_clients; i++) {
+        LoadClient* c = &all[i];
+        c->fd = -1;
+        c->view = &views[i - clients];
+        c->rng = 0x5EED0000ull + (uint64_t)i;
+        c->state = CLIENT_IDLE;
+        c->next_turn_ms = start_ms + ramp_ms + GAME_ROOM_START_DELAY_MS + random_unit(&c->rng) * ramp_ms;
+    }
+    int per = (total_clients + threads - 1) / threads;
+    for (int i = 0; i < threads; i++) {
+        LoadThread* t = &pool[i];
+        t->index = i;
+        t->clients = all + i * per;
+        t->count = total_clients - i * per < per ? total_clients - i * per : per;
+        if (t->count < 0) t->count = 0;
+        t->epoll_fd = epoll_create1(0);
+        pthread_create(&t->thread, NULL, thread_main, t);
+    }
+    for (int i = 0; i < threads; i++) pthread_join(pool[i].thread, NULL);
+    double wall = (now_ms() - start_ms) / 1000.0;
+
+    LoadThread total;
+    memset(&total, 0, sizeof(total));
+    int playing = 0;
+    for (int i = 0; i < threads; i++) {
+        LoadThread* t = &pool[i];
+        total.games += t->games;
+        total.moves += t->moves;
+        total.inputs += t->inputs;
+        total.resends += t->resends;
+        total.rejoins += t->rejoins;
+        total.timeouts += t->timeouts;
+        total.errors += t->errors;
+        total.feed_packets += t->feed_packets;
+        total.feed_bytes += t->feed_bytes;
+        total.feed_keyframes += t->feed_keyframes;
+        total.feed_gaps += t->feed_gaps;
+        total.feed_overs += t->feed_overs;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            total.rtt.counts[b] += t->rtt.counts[b];
+            total.join.counts[b] += t->join.counts[b];
+        }
+    }
+    int synced = 0;
+    for (int i = 0; i < clients; i++) playing += all[i].state == CLIENT_PLAYING;
+    for (int i = 0; i < viewers; i++) synced += views[i].synced;
+    printf("load: %d clients (%d tcp, %d udp), %d threads, %.1f s, %d playing at end\n",
+        clients, tcp_count, clients - tcp_count, threads, wall, playing);
+    printf("load: %llu games (%.1f/s), %.0f moves received/s, %.0f inputs/s, %llu resends, %llu rejoins, "
+        "%llu timeouts, %llu errors\n",
+        (unsigned long long)total.games / 2, (double)total.games / 2.0 / wall, (double)total.moves / wall,
+        (double)total.inputs / wall, (unsigned long long)total.resends, (unsigned long long)total.rejoins,
+        (unsigned long long)total.timeouts, (unsigned long long)total.errors);
+    printf("load: join->welcome p50 %.1f ms, p99 %.1f ms; input->echo rtt (%llu samples) p50 %.1f ms, "
+        "p99 %.1f ms, p99.9 %.1f ms\n",
+        hist_percentile(&total.join, 0.50) / 1000.0, hist_percentile(&total.join, 0.99) / 1000.0,
+        (unsigned long long)hist_total(&total.rtt), hist_percentile(&total.rtt, 0.50) / 1000.0,
+        hist_percentile(&total.rtt, 0.99) / 1000.0, hist_percentile(&total.rtt, 0.999) / 1000.0);
+    if (viewers > 0) {
+        printf("load: %d viewers (%d synced at end), %.0f feed pkts/s, %.1f bytes/tick/viewer, keyframes %.1f%%, "
+            "%llu gaps, %llu games watched to the end\n",
+            viewers, synced, (double)total.feed_packets / wall,
+            total.feed_packets ? (double)total.feed_bytes / (double)total.feed_packets : 0.0,
+            total.feed_packets ? 100.0 * (double)total.feed_keyframes / (double)total.feed_packets : 0.0,
+            (unsigned long long)total.feed_gaps, (unsigned long long)total.feed_overs);
+    }
+    for (int i = 0; i < viewers; i++) game_spectate_view_free(&views[i]);
+    free(views);
+    free(all);
+    return 0;
+}
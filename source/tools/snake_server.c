@@ -0,0 +1,1356 @@
+// 權威伺服器 (Linux，無介面、不使用 GTK / GStreamer)：在一個行程中同時執行大量雙人對戰房間。
+// 主執行緒是大廳：在同一個埠號接受 TCP 連線與 UDP 的 JOIN，每兩位玩家配成一個房間，
+// 依序交給工作執行緒。每個工作執行緒以 epoll 等待自己的 UDP 通訊端、TCP 連線、
+// 交接用的 eventfd 與 timerfd (設定為最早要移動的房間的時間)，房間依下一次移動的時間放在最小堆積中。
+// UDP 玩家的 WELCOME 由工作執行緒自己的通訊端送出，之後的輸入直接送到該工作執行緒。
+// 每次移動後把結果 (game_room 的 MOVE) 廣播給兩位玩家：UDP 以 sendmmsg 一批送出，TCP 每次迴圈合併寫出。
+// 定期輸出：房間數、每個 CPU 核心能承載的房間數 (房間數 / 行程使用的 CPU 時間比例)、
+// 移動時間的抖動 (實際執行減去預定時間) 與輸入到廣播的延遲 (收到輸入到該玩家下一次移動的廣播送出) 的百分位數。
+// 觀眾以 UDP 送出 game_spectate 的 WATCH (房間0為任一) 後，每次移動收到一個增量封包 (定期或要求時為關鍵影格)；
+// 封包每次移動只編碼一次，所有觀眾的 sendmmsg 項目都指向同一個緩衝區。觀眾每隔幾秒重送 WATCH 續訂。
+//
+// 建置與執行 (壓力測試見 server_load.c)：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/snake_server.c source/game_room.c source/game_spectate.c source/game_core.c -o snake_server
+//   ./snake_server -p 7300 -w 4 -d 60
+// 選項：
+//   -p 埠號 (TCP 與 UDP 大廳)  -w 工作執行緒數 (預設為 CPU 數)  -d 執行秒數 (0 為直到 Ctrl+C)
+//   -i 報告間隔 (秒)  -r 每個工作執行緒最多的房間數  -W/-H 網格尺寸  -s 種子
+
+#define _GNU_SOURCE // recvmmsg, sendmmsg, accept4
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "game_core.h"
+#include "game_room.h"
+#include "game_spectate.h"
+
+//========================[ 常數 ]========================
+#define MAX_WORKERS 64
+#define BATCH 64                  // 一次 epoll_wait / recvmmsg / sendmmsg 處理的數量
+#define TCP_OUT_BYTES 1024        // 每個 TCP 連線尚未送出的資料上限 (超過時斷線)
+#define TCP_IN_BYTES 64           // 每個 TCP 連線尚未解碼的資料上限
+#define LATENCY_PENDING 1024      // 等待送出後才記錄的延遲樣本數
+#define ROOM_SLOT_BITS 20         // 房間編號：低20位元是工作執行緒內的位置，接著6位元是工作執行緒，最高6位元是重複使用的世代
+#define ROOM_WORKER_BITS 6
+#define HIST_BUCKETS 512
+#define ASSIGNED_CAPACITY (1 << 16) // 大廳記住已配對的 UDP 客戶端，忽略重送的 JOIN
+#define FEED_BATCH 256            // 觀戰封包一次 sendmmsg 的數量
+#define FEED_ARENA (64 * 1024)    // 本次迴圈編碼的觀戰封包 (送出後整塊重用)
+#define FEED_DELTA_BYTES 64       // 一個增量封包的上限 (一次移動)
+#define VIEWER_TIMEOUT_MS 6000.0  // 觀眾這麼久沒有續訂就移除
+
+// epoll 的標記：工作執行緒
+#define TAG_EVENT  0
+#define TAG_TIMER  1
+#define TAG_UDP    2
+#define TAG_CLIENT 3              // 3 + 房間位置 * 2 + 玩家
+// epoll 的標記：大廳
+#define TAG_LISTEN 0
+#define TAG_LOBBY  1
+#define TAG_PENDING 2             // 2 + 尚未送出 JOIN 的 TCP 連線
+
+//========================[ 結構定義 ]========================
+// 對數直方圖 (微秒)：每個2的次方分成8格，誤差在12.5%以內
+typedef struct {
+    uint64_t counts[HIST_BUCKETS];
+} Histogram;
+
+// 工作執行緒的統計 (工作執行緒寫入、主執行緒讀取，皆為 relaxed 原子操作)
+typedef struct {
+    uint64_t moves;
+    uint64_t messages, bytes;     // 送出的訊息與位元組
+    uint64_t inputs;              // 採用的輸入
+    uint64_t rooms_started, rooms_finished;
+    uint64_t rooms_rejected;      // 房間已滿而拒絕
+    uint64_t clients_dropped;     // TCP 送出緩衝區已滿而斷線
+    int64_t rooms_active;
+    int64_t viewers;              // 目前的觀眾數
+    uint64_t feed_ticks;          // 有觀眾的移動次數 (每次編碼一次)
+    uint64_t feed_packets, feed_bytes, feed_keyframes; // 送給觀眾的封包 (每位觀眾各算一次)
+    Histogram jitter;             // 移動的實際執行時間減去預定時間
+    Histogram latency;            // 收到輸入到該玩家下一次移動的廣播送出
+} WorkerStats;
+
+// 要加入房間的玩家
+typedef struct {
+    bool tcp;
+    int fd;                       // TCP 連線
+    struct sockaddr_in addr;      // UDP 位址
+} Joiner;
+
+// 大廳交給工作執行緒的房間或觀看要求
+typedef struct {
+    bool watch;                   // 觀看要求 (who[0].addr 為觀眾的位址)
+    uint32_t room;                // 觀看的房間 (0 表示任一)
+    uint8_t flags;                // WATCH 旗標
+    uint64_t seed;
+    Joiner who[MAX_PLAYERS];
+} RoomRequest;
+
+// 一位觀眾
+typedef struct {
+    struct sockaddr_in addr;
+    double expires_ms;            // 沒有續訂時移除的時間
+    bool needs_key;               // 下一個封包送關鍵影格
+} Viewer;
+
+// 房間中的一位玩家
+typedef struct {
+    bool tcp;
+    int fd;                       // TCP 連線 (-1 表示 UDP 或已斷線)
+    bool closing;                 // 送出最後的資料後關閉
+    bool dirty;                   // 在待寫出的清單中
+    bool want_out;                // 已登記 EPOLLOUT
+    struct sockaddr_in addr;      // UDP 位址
+    int in_length;
+    uint8_t in[TCP_IN_BYTES];
+    int out_length;
+    uint8_t out[TCP_OUT_BYTES];
+} ServerClient;
+
+// 工作執行緒中的房間位置
+typedef struct {
+    GameRoom room;                // 遊戲狀態的記憶體在位置重複使用時保留
+    ServerClient clients[MAX_PLAYERS];
+    double due_ms;                // 下一次移動的時間
+    int heap_index;               // 在最小堆積中的位置 (-1 表示不在)
+    bool active;
+    uint32_t generation;
+    GameSpectateEncoder feed;     // 觀戰串流的編碼端
+    Viewer* viewers;
+    int viewer_count, viewer_capacity;
+    bool key_wanted;              // 有觀眾需要關鍵影格
+} ServerRoom;
+
+typedef struct Server Server;
+
+// 工作執行緒
+typedef struct {
+    Server* server;
+    int index;
+    pthread_t thread;
+    int epoll_fd, event_fd, timer_fd, udp_fd;
+    uint16_t udp_port;
+    double armed_ms;              // timerfd 目前設定的時間
+
+    pthread_mutex_t lock;         // 保護交接佇列
+    RoomRequest* requests;
+    int request_count, request_capacity;
+
+    ServerRoom* rooms;
+    int room_capacity;
+    int* free_slots;
+    int free_count;
+    int* heap;                    // 依 due_ms 排序的房間位置
+    int heap_count;
+    int* dirty;                   // 有待寫出資料的 TCP 玩家 (位置 * 2 + 玩家)
+    int dirty_count;
+
+    // UDP 送出批次
+    struct mmsghdr out_msgs[BATCH];
+    struct iovec out_iov[BATCH];
+    struct sockaddr_in out_addr[BATCH];
+    uint8_t out_data[BATCH][GAME_ROOM_MAX_MESSAGE];
+    int out_count;
+
+    // 觀戰封包的送出批次：同一次移動的項目都指向 feed_arena 中同一段資料
+    struct mmsghdr feed_msgs[FEED_BATCH];
+    struct iovec feed_iov[FEED_BATCH];
+    struct sockaddr_in feed_addr[FEED_BATCH];
+    int feed_count;
+    uint8_t* feed_arena;
+    size_t feed_used;
+    size_t key_capacity;          // 關鍵影格的最大位元組數
+    int watch_cursor;             // 觀看任一房間時下一個檢查的位置
+
+    // 送出後才記錄的延遲樣本 (收到輸入的時間)
+    double latency_pending[LATENCY_PENDING];
+    int latency_count;
+
+    WorkerStats stats;
+} Worker;
+
+// 整個伺服器
+struct Server {
+    int port;
+    int worker_count;
+    int rooms_per_worker;
+    int width, height;
+    uint64_t seed;
+    Worker workers[MAX_WORKERS];
+};
+
+static volatile sig_atomic_t server_stop = 0;
+
+//==============================================================
+// [ 共用 ]
+//==============================================================
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    server_stop = 1;
+}
+
+static void counter_add(uint64_t* counter, uint64_t n)
+{
+    __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+}
+
+static uint64_t counter_get(const uint64_t* counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static int hist_bucket(uint64_t v)
+{
+    if (v < 8) return (int)v;
+    int e = 63 - __builtin_clzll(v);
+    return (e - 2) * 8 + (int)((v >> (e - 3)) & 7);
+}
+
+// 格子的上限 (含)
+static uint64_t hist_upper(int b)
+{
+    if (b < 8) return (uint64_t)b;
+    int e = b / 8 + 2;
+    return ((uint64_t)(8 + b % 8 + 1) << (e - 3)) - 1;
+}
+
+static void hist_add(Histogram* h, double us)
+{
+    counter_add(&h->counts[hist_bucket(us > 0.0 ? (uint64_t)us : 0)], 1);
+}
+
+static uint64_t hist_percentile(const uint64_t* counts, double q)
+{
+    uint64_t total = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) total += counts[b];
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(total - 1)) + 1, seen = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank) return hist_upper(b);
+    }
+    return hist_upper(HIST_BUCKETS - 1);
+}
+
+static uint64_t hist_max(const uint64_t* counts)
+{
+    for (int b = HIST_BUCKETS - 1; b >= 0; b--) {
+        if (counts[b]) return hist_upper(b);
+    }
+    return 0;
+}
+
+static uint64_t splitmix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+//==============================================================
+// [ 工作執行緒：最小堆積 ]
+//==============================================================
+static void heap_swap(Worker* w, int a, int b)
+{
+    int t = w->heap[a];
+    w->heap[a] = w->heap[b];
+    w->heap[b] = t;
+    w->rooms[w->heap[a]].heap_index = a;
+    w->rooms[w->heap[b]].heap_index = b;
+}
+
+static void heap_fix(Worker* w, int i)
+{
+    while (i > 0 && w->rooms[w->heap[i]].due_ms < w->rooms[w->heap[(i - 1) / 2]].due_ms) {
+        heap_swap(w, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < w->heap_count && w->rooms[w->heap[l]].due_ms < w->rooms[w->heap[m]].due_ms) m = l;
+        if (r < w->heap_count && w->rooms[w->heap[r]].due_ms < w->rooms[w->heap[m]].due_ms) m = r;
+        if (m == i) break;
+        heap_swap(w, i, m);
+        i = m;
+    }
+}
+
+static void heap_push(Worker* w, int slot)
+{
+    w->heap[w->heap_count] = slot;
+    w->rooms[slot].heap_index = w->heap_count++;
+    heap_fix(w, w->heap_count - 1);
+}
+
+static void heap_remove(Worker* w, int slot)
+{
+    int i = w->rooms[slot].heap_index;
+    if (i < 0) return;
+    w->rooms[slot].heap_index = -1;
+    if (--w->heap_count == i) return;
+    w->heap[i] = w->heap[w->heap_count];
+    w->rooms[w->heap[i]].heap_index = i;
+    heap_fix(w, i);
+}
+
+//==============================================================
+// [ 工作執行緒：送出 ]
+//==============================================================
+// 送出 UDP 批次
+static void worker_flush_udp(Worker* w)
+{
+    int sent = 0;
+    while (sent < w->out_count) {
+        int n = sendmmsg(w->udp_fd, w->out_msgs + sent, (unsigned)(w->out_count - sent), 0);
+        if (n <= 0) break; // 送出緩衝區已滿視同遺失
+        sent += n;
+    }
+    w->out_count = 0;
+}
+
+// 寫出一位 TCP 玩家的資料
+static void worker_flush_client(Worker* w, int slot, int player)
+{
+    ServerClient* c = &w->rooms[slot].clients[player];
+    if (c->fd >= 0 && c->out_length > 0) {
+        ssize_t n = write(c->fd, c->out, (size_t)c->out_length);
+        if (n > 0) {
+            memmove(c->out, c->out + n, (size_t)(c->out_length - n));
+            c->out_length -= (int)n;
+        }
+        else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            c->out_length = 0;
+            c->closing = true;
+        }
+    }
+    if (c->fd >= 0 && (c->closing || c->out_length == 0) && c->want_out) {
+        struct epoll_event ev = { EPOLLIN, { .u64 = TAG_CLIENT + (uint64_t)slot * 2 + (uint64_t)player } };
+        epoll_ctl(w->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->want_out = false;
+    }
+    if (c->fd >= 0 && c->closing) {
+        close(c->fd); // 關閉時 epoll 自動移除
+        c->fd = -1;
+        c->out_length = 0;
+    }
+    else if (c->fd >= 0 && c->out_length > 0 && !c->want_out) {
+        // 對方接收得慢，等可以寫入時再送
+        struct epoll_event ev = { EPOLLIN | EPOLLOUT, { .u64 = TAG_CLIENT + (uint64_t)slot * 2 + (uint64_t)player } };
+        epoll_ctl(w->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->want_out = true;
+    }
+}
+
+// 送出觀戰封包的批次 (封包的資料仍在 feed_arena 中，由呼叫端決定何時重用)
+static void worker_flush_feed(Worker* w)
+{
+    int sent = 0;
+    while (sent < w->feed_count) {
+        int n = sendmmsg(w->udp_fd, w->feed_msgs + sent, (unsigned)(w->feed_count - sent), 0);
+        if (n <= 0) break; // 送出緩衝區已滿視同遺失，觀眾偵測到遺漏後要求關鍵影格
+        sent += n;
+    }
+    w->feed_count = 0;
+}
+
+// 送出本次迴圈累積的資料，再記錄延遲樣本
+static void worker_flush(Worker* w)
+{
+    worker_flush_udp(w);
+    worker_flush_feed(w);
+    w->feed_used = 0;
+    for (int i = 0; i < w->dirty_count; i++) {
+        int slot = w->dirty[i] / 2, player = w->dirty[i] % 2;
+        w->rooms[slot].clients[player].dirty = false;
+        worker_flush_client(w, slot, player);
+    }
+    w->dirty_count = 0;
+
+    if (w->latency_count > 0) {
+        double now = now_ms();
+        for (int i = 0; i < w->latency_count; i++) {
+            hist_add(&w->stats.latency, (now - w->latency_pending[i]) * 1000.0);
+        }
+        w->latency_count = 0;
+    }
+}
+
+// 把訊息送給房間中的一位玩家
+static void worker_send(Worker* w, int slot, int player, const GameRoomMessage* m)
+{
+    ServerClient* c = &w->rooms[slot].clients[player];
+    if (c->tcp) {
+        if (c->fd < 0 || c->closing) return;
+        if (c->out_length + GAME_ROOM_MAX_MESSAGE > TCP_OUT_BYTES) {
+            // 對方長時間沒有讀取，斷線
+            c->closing = true;
+            counter_add(&w->stats.clients_dropped, 1);
+        }
+        else {
+            int length = game_room_encode(m, c->out + c->out_length);
+            c->out_length += length;
+            counter_add(&w->stats.bytes, (uint64_t)length);
+        }
+        if (!c->dirty) {
+            c->dirty = true;
+            w->dirty[w->dirty_count++] = slot * 2 + player;
+        }
+    }
+    else {
+        if (w->out_count == BATCH) worker_flush_udp(w);
+        int i = w->out_count++;
+        int length = game_room_encode(m, w->out_data[i]);
+        w->out_addr[i] = c->addr;
+        w->out_iov[i].iov_base = w->out_data[i];
+        w->out_iov[i].iov_len = (size_t)length;
+        counter_add(&w->stats.bytes, (uint64_t)length);
+    }
+    counter_add(&w->stats.messages, 1);
+}
+
+//==============================================================
+// [ 工作執行緒：觀戰 ]
+//==============================================================
+// 把 feed_arena 中的封包排入觀眾的送出批次 (不複製資料)
+static void worker_feed_send(Worker* w, const struct sockaddr_in* addr, uint8_t* data, int length, bool keyframe)
+{
+    if (w->feed_count == FEED_BATCH) worker_flush_feed(w);
+    int i = w->feed_count++;
+    w->feed_addr[i] = *addr;
+    w->feed_iov[i].iov_base = data;
+    w->feed_iov[i].iov_len = (size_t)length;
+    counter_add(&w->stats.feed_packets, 1);
+    counter_add(&w->stats.feed_bytes, (uint64_t)length);
+    if (keyframe) counter_add(&w->stats.feed_keyframes, 1);
+}
+
+// 確保 feed_arena 還有 need 位元組，不足時先送出批次再重用
+static uint8_t* worker_feed_reserve(Worker* w, size_t need)
+{
+    if (w->feed_used + need > FEED_ARENA) {
+        worker_flush_feed(w);
+        w->feed_used = 0;
+    }
+    return w->feed_arena + w->feed_used;
+}
+
+// 移除房間的一位觀眾
+static void worker_remove_viewer(Worker* w, ServerRoom* r, int i)
+{
+    r->viewers[i] = r->viewers[--r->viewer_count];
+    __atomic_fetch_sub(&w->stats.viewers, 1, __ATOMIC_RELAXED);
+    if (r->viewer_count == 0) game_spectate_encoder_reset(&r->feed);
+}
+
+// 移動後把變化送給房間的觀眾：增量與關鍵影格各只編碼一次
+static void worker_feed(Worker* w, int slot, double now)
+{
+    ServerRoom* r = &w->rooms[slot];
+    if (r->viewer_count == 0) return;
+    uint32_t frame = (uint32_t)r->room.frame;
+    uint8_t* delta = NULL;
+    uint8_t* key = NULL;
+    int delta_length = -1, key_length = -1;
+
+    bool periodic = game_spectate_keyframe_due(&r->feed, frame);
+    if (!periodic) {
+        delta = worker_feed_reserve(w, FEED_DELTA_BYTES + w->key_capacity);
+        delta_length = game_spectate_encode_delta(&r->feed, &r->room.game, r->room.id, frame, delta, FEED_DELTA_BYTES);
+        if (delta_length < 0) periodic = true; // 無法以增量表示時所有觀眾改收關鍵影格
+        else w->feed_used += (size_t)delta_length;
+    }
+    if (periodic || r->key_wanted) {
+        key = worker_feed_reserve(w, w->key_capacity);
+        key_length = game_spectate_encode_keyframe(&r->feed, &r->room.game, r->room.id, frame, key, w->key_capacity);
+        if (key_length < 0) return;
+        w->feed_used += (size_t)key_length;
+    }
+    r->key_wanted = false;
+    counter_add(&w->stats.feed_ticks, 1);
+
+    for (int i = 0; i < r->viewer_count; ) {
+        Viewer* v = &r->viewers[i];
+        if (now > v->expires_ms) {
+            worker_remove_viewer(w, r, i);
+            continue;
+        }
+        bool send_key = periodic || v->needs_key;
+        worker_feed_send(w, &v->addr, send_key ? key : delta, send_key ? key_length : delta_length, send_key);
+        v->needs_key = false;
+        i++;
+    }
+}
+
+// 對局結束：通知觀眾並移除 (觀眾之後重新要求觀看)
+static void worker_feed_over(Worker* w, int slot)
+{
+    ServerRoom* r = &w->rooms[slot];
+    if (r->viewer_count == 0) return;
+    uint8_t* over = worker_feed_reserve(w, GAME_SPECTATE_OVER_BYTES);
+    int length = game_spectate_encode_over(r->room.id, (uint32_t)r->room.frame, r->room.game.winner, over);
+    w->feed_used += (size_t)length;
+    for (int i = 0; i < r->viewer_count; i++) worker_feed_send(w, &r->viewers[i].addr, over, length, false);
+    __atomic_fetch_sub(&w->stats.viewers, r->viewer_count, __ATOMIC_RELAXED);
+    r->viewer_count = 0;
+    game_spectate_encoder_reset(&r->feed);
+}
+
+// 加入或續訂觀眾
+static void worker_watch(Worker* w, uint32_t room, uint8_t flags, const struct sockaddr_in* addr, double now)
+{
+    int slot = -1;
+    if (room == 0) {
+        // 任一房間：從上次的位置往後找進行中的房間，讓觀眾平均分散
+        for (int n = 0; n < w->room_capacity && slot < 0; n++) {
+            int i = (w->watch_cursor + n) % w->room_capacity;
+            if (w->rooms[i].active) slot = i;
+        }
+        if (slot < 0) return;
+        w->watch_cursor = (slot + 1) % w->room_capacity;
+    }
+    else {
+        uint32_t i = room & ((1u << ROOM_SLOT_BITS) - 1);
+        if (i >= (uint32_t)w->room_capacity || !w->rooms[i].active || w->rooms[i].room.id != room) return;
+        slot = (int)i;
+    }
+
+    ServerRoom* r = &w->rooms[slot];
+    bool want_key = room == 0 || (flags & GAME_SPECTATE_WATCH_KEY);
+    for (int i = 0; i < r->viewer_count; i++) {
+        Viewer* v = &r->viewers[i];
+        if (v->addr.sin_addr.s_addr == addr->sin_addr.s_addr && v->addr.sin_port == addr->sin_port) {
+            v->expires_ms = now + VIEWER_TIMEOUT_MS;
+            v->needs_key |= want_key;
+            r->key_wanted |= want_key;
+            return;
+        }
+    }
+    if (r->viewer_count == r->viewer_capacity) {
+        int capacity = r->viewer_capacity ? r->viewer_capacity * 2 : 8;
+        Viewer* grown = (Viewer*)realloc(r->viewers, (size_t)capacity * sizeof(Viewer));
+        if (!grown) return;
+        r->viewers = grown;
+        r->viewer_capacity = capacity;
+    }
+    Viewer* v = &r->viewers[r->viewer_count++];
+    v->addr = *addr;
+    v->expires_ms = now + VIEWER_TIMEOUT_MS;
+    v->needs_key = true;
+    r->key_wanted = true;
+    __atomic_fetch_add(&w->stats.viewers, 1, __ATOMIC_RELAXED);
+}
+
+//==============================================================
+// [ 工作執行緒：房間 ]
+//==============================================================
+// 結束房間：送出 OVER，TCP 連線在寫出後關閉，位置在下一次交接時才會重複使用
+static void worker_close_room(Worker* w, int slot, bool send_over)
+{
+    ServerRoom* r = &w->rooms[slot];
+    if (send_over) {
+        GameRoomMessage m;
+        game_room_over_message(&r->room, &m);
+        for (int p = 0; p < MAX_PLAYERS; p++) worker_send(w, slot, p, &m);
+    }
+    worker_feed_over(w, slot);
+    for (int p = 0; p < MAX_PLAYERS; p++) {
+        ServerClient* c = &r->clients[p];
+        if (c->fd < 0) continue;
+        c->closing = true;
+        if (!c->dirty) {
+            c->dirty = true;
+            w->dirty[w->dirty_count++] = slot * 2 + p;
+        }
+    }
+    heap_remove(w, slot);
+    r->active = false;
+    w->free_slots[w->free_count++] = slot;
+    __atomic_fetch_sub(&w->stats.rooms_active, 1, __ATOMIC_RELAXED);
+    counter_add(&w->stats.rooms_finished, 1);
+}
+
+// 建立大廳交來的房間
+static void worker_take_requests(Worker* w)
+{
+    pthread_mutex_lock(&w->lock);
+    int count = w->request_count;
+    RoomRequest* requests = w->requests;
+    RoomRequest local[BATCH];
+    if (count > BATCH) count = BATCH; // 其餘的留到下一次 (eventfd 仍可讀)
+    memcpy(local, requests, (size_t)count * sizeof(RoomRequest));
+    memmove(requests, requests + count, (size_t)(w->request_count - count) * sizeof(RoomRequest));
+    w->request_count -= count;
+    if (w->request_count > 0) {
+        uint64_t one = 1;
+        if (write(w->event_fd, &one, sizeof(one)) < 0) {}
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    Server* s = w->server;
+    double now = now_ms();
+    for (int i = 0; i < count; i++) {
+        RoomRequest* q = &local[i];
+        if (q->watch) {
+            worker_watch(w, q->room, q->flags, &q->who[0].addr, now);
+            continue;
+        }
+        if (w->free_count == 0) {
+            // 房間已滿：關閉 TCP 連線，UDP 玩家等待逾時後重新加入
+            for (int p = 0; p < MAX_PLAYERS; p++) if (q->who[p].tcp) close(q->who[p].fd);
+            counter_add(&w->stats.rooms_rejected, 1);
+            continue;
+        }
+        int slot = w->free_slots[--w->free_count];
+        ServerRoom* r = &w->rooms[slot];
+        // 世代不為0，房間編號因此不會是0 (0 在觀看要求中表示任一房間)
+        r->generation = r->generation % ((1u << (32 - ROOM_SLOT_BITS - ROOM_WORKER_BITS)) - 1) + 1;
+        uint32_t id = (r->generation << (ROOM_SLOT_BITS + ROOM_WORKER_BITS))
+            | ((uint32_t)w->index << ROOM_SLOT_BITS) | (uint32_t)slot;
+        if (!game_room_start(&r->room, id, q->seed, s->width, s->height, now)) {
+            w->free_slots[w->free_count++] = slot;
+            for (int p = 0; p < MAX_PLAYERS; p++) if (q->who[p].tcp) close(q->who[p].fd);
+            counter_add(&w->stats.rooms_rejected, 1);
+            continue;
+        }
+        r->active = true;
+        r->key_wanted = false;
+        game_spectate_encoder_reset(&r->feed);
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            ServerClient* c = &r->clients[p];
+            c->tcp = q->who[p].tcp;
+            c->fd = c->tcp ? q->who[p].fd : -1;
+            c->addr = q->who[p].addr;
+            c->closing = c->dirty = c->want_out = false;
+            c->in_length = c->out_length = 0;
+            if (c->tcp) {
+                struct epoll_event ev = { EPOLLIN, { .u64 = TAG_CLIENT + (uint64_t)slot * 2 + (uint64_t)p } };
+                if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, c->fd, &ev) != 0) {
+                    close(c->fd);
+                    c->fd = -1;
+                }
+            }
+            GameRoomMessage m;
+            memset(&m, 0, sizeof(m));
+            m.type = ROOM_MSG_WELCOME;
+            m.room = id;
+            m.player = (uint8_t)p;
+            m.width = (uint8_t)s->width;
+            m.height = (uint8_t)s->height;
+            m.seed = q->seed;
+            worker_send(w, slot, p, &m);
+        }
+        r->due_ms = game_room_due_ms(&r->room);
+        heap_push(w, slot);
+        __atomic_fetch_add(&w->stats.rooms_active, 1, __ATOMIC_RELAXED);
+        counter_add(&w->stats.rooms_started, 1);
+    }
+}
+
+// 移動所有已到時間的房間並廣播結果
+static void worker_run_rooms(Worker* w)
+{
+    while (w->heap_count > 0) {
+        int slot = w->heap[0];
+        ServerRoom* r = &w->rooms[slot];
+        double now = now_ms();
+        if (r->due_ms > now) break;
+        hist_add(&w->stats.jitter, (now - r->due_ms) * 1000.0);
+
+        GameEvent ev = GAME_EVENT_NONE;
+        int mover = game_room_step(&r->room, now, &ev);
+        if (mover >= 0) {
+            counter_add(&w->stats.moves, 1);
+            for (int p = 0; p < MAX_PLAYERS; p++) {
+                GameRoomMessage m;
+                game_room_move_message(&r->room, mover, ev, p, &m);
+                worker_send(w, slot, p, &m);
+            }
+            // 該玩家的輸入在這一步生效，送出後記錄延遲
+            if (r->room.input_at_ms[mover] >= 0.0) {
+                if (w->latency_count == LATENCY_PENDING) worker_flush(w);
+                w->latency_pending[w->latency_count++] = r->room.input_at_ms[mover];
+                r->room.input_at_ms[mover] = -1.0;
+            }
+            worker_feed(w, slot, now);
+        }
+        if (r->room.over) {
+            worker_close_room(w, slot, true);
+            continue;
+        }
+        r->due_ms = game_room_due_ms(&r->room);
+        heap_fix(w, r->heap_index);
+    }
+}
+
+//==============================================================
+// [ 工作執行緒：接收 ]
+//==============================================================
+// 處理一位玩家的輸入
+static void worker_input(Worker* w, const GameRoomMessage* m, const ServerClient* from_tcp,
+    const struct sockaddr_in* from_udp, double now)
+{
+    uint32_t slot = m->room & ((1u << ROOM_SLOT_BITS) - 1);
+    if (slot >= (uint32_t)w->room_capacity) return;
+    ServerRoom* r = &w->rooms[slot];
+    if (!r->active || r->room.id != m->room) return;
+    const ServerClient* c = &r->clients[m->player];
+    // 只接受該玩家自己的連線或位址送來的輸入
+    if (from_tcp ? from_tcp != c
+        : (c->tcp || c->addr.sin_addr.s_addr != from_udp->sin_addr.s_addr || c->addr.sin_port != from_udp->sin_port)) return;
+    if (game_room_input(&r->room, m->player, m->seq, (Direction)m->direction, m->stamp, now)) {
+        counter_add(&w->stats.inputs, 1);
+    }
+}
+
+// 讀取 UDP 通訊端
+static void worker_read_udp(Worker* w, double now)
+{
+    struct mmsghdr msgs[BATCH];
+    struct iovec iov[BATCH];
+    struct sockaddr_in addrs[BATCH];
+    uint8_t data[BATCH][GAME_ROOM_MAX_MESSAGE];
+    for (;;) {
+        for (int i = 0; i < BATCH; i++) {
+            iov[i].iov_base = data[i];
+            iov[i].iov_len = sizeof(data[i]);
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
+        int n = recvmmsg(w->udp_fd, msgs, BATCH, MSG_DONTWAIT, NULL);
+        if (n <= 0) return;
+        for (int i = 0; i < n; i++) {
+            GameRoomMessage m;
+            uint32_t room;
+            uint8_t flags;
+            if (msgs[i].msg_len > 0 && data[i][0] == SPECTATE_WATCH) {
+                // 觀眾直接向房間所在的工作執行緒續訂
+                if (game_spectate_decode_watch(data[i], msgs[i].msg_len, &room, &flags)) {
+                    worker_watch(w, room, flags, &addrs[i], now);
+                }
+            }
+            else if (game_room_decode(data[i], (int)msgs[i].msg_len, &m) > 0 && m.type == ROOM_MSG_INPUT) {
+                worker_input(w, &m, NULL, &addrs[i], now);
+            }
+        }
+        if (n < BATCH) return;
+    }
+}
+
+// 讀取 TCP 連線
+static void worker_read_tcp(Worker* w, int slot, int player, double now)
+{
+    ServerRoom* r = &w->rooms[slot];
+    ServerClient* c = &r->clients[player];
+    if (!r->active || c->fd < 0) return;
+    for (;;) {
+        ssize_t n = read(c->fd, c->in + c->in_length, sizeof(c->in) - (size_t)c->in_length);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            // 斷線：該玩家之後不再轉向；兩位玩家都是 TCP 且都斷線時結束房間
+            close(c->fd);
+            c->fd = -1;
+            c->out_length = 0;
+            if (r->clients[0].tcp && r->clients[1].tcp && r->clients[0].fd < 0 && r->clients[1].fd < 0) {
+                worker_close_room(w, slot, false);
+            }
+            return;
+        }
+        if (n < 0) return;
+        c->in_length += (int)n;
+
+        int offset = 0, used;
+        GameRoomMessage m;
+        while ((used = game_room_decode(c->in + offset, c->in_length - offset, &m)) > 0) {
+            if (m.type == ROOM_MSG_INPUT) worker_input(w, &m, c, NULL, now);
+            offset += used;
+        }
+        if (used < 0) {
+            c->closing = true; // 格式錯誤
+            if (!c->dirty) {
+                c->dirty = true;
+                w->dirty[w->dirty_count++] = slot * 2 + player;
+            }
+            return;
+        }
+        memmove(c->in, c->in + offset, (size_t)(c->in_length - offset));
+        c->in_length -= offset;
+    }
+}
+
+// 把 timerfd 設為最早要移動的房間的時間
+static void worker_arm_timer(Worker* w)
+{
+    double due = w->heap_count > 0 ? w->rooms[w->heap[0]].due_ms : -1.0;
+    if (due == w->armed_ms) return;
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (due >= 0.0) {
+        double at = due > 0.001 ? due : 0.001;
+        spec.it_value.tv_sec = (time_t)(at / 1000.0);
+        spec.it_value.tv_nsec = (long)((at - (double)spec.it_value.tv_sec * 1000.0) * 1e6);
+        if (spec.it_value.tv_nsec >= 1000000000L) spec.it_value.tv_nsec = 999999999L;
+    }
+    timerfd_settime(w->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+    w->armed_ms = due;
+}
+
+// 工作執行緒的事件迴圈
+static void* worker_main(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    struct epoll_event events[BATCH];
+    while (!server_stop) {
+        worker_arm_timer(w);
+        int n = epoll_wait(w->epoll_fd, events, BATCH, 200);
+        double now = now_ms();
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            uint64_t value;
+            if (tag == TAG_EVENT) {
+                if (read(w->event_fd, &value, sizeof(value)) < 0) {}
+                worker_take_requests(w);
+            }
+            else if (tag == TAG_TIMER) {
+                if (read(w->timer_fd, &value, sizeof(value)) < 0) {}
+                w->armed_ms = -2.0; // 已觸發，下一次需要重新設定
+            }
+            else if (tag == TAG_UDP) {
+                worker_read_udp(w, now);
+            }
+            else {
+                int slot = (int)((tag - TAG_CLIENT) / 2), player = (int)((tag - TAG_CLIENT) % 2);
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) worker_read_tcp(w, slot, player, now);
+                if ((events[i].events & EPOLLOUT) && w->rooms[slot].clients[player].fd >= 0) {
+                    worker_flush_client(w, slot, player);
+                }
+            }
+        }
+        worker_run_rooms(w);
+        worker_flush(w);
+    }
+    return NULL;
+}
+
+// 建立工作執行緒的通訊端與房間位置
+static bool worker_init(Worker* w, Server* s, int index)
+{
+    memset(w, 0, sizeof(*w));
+    w->server = s;
+    w->index = index;
+    w->armed_ms = -1.0;
+    pthread_mutex_init(&w->lock, NULL);
+    w->room_capacity = s->rooms_per_worker;
+    w->rooms = (ServerRoom*)calloc((size_t)w->room_capacity, sizeof(ServerRoom));
+    w->free_slots = (int*)malloc((size_t)w->room_capacity * sizeof(int));
+    w->heap = (int*)malloc((size_t)w->room_capacity * sizeof(int));
+    w->dirty = (int*)malloc((size_t)w->room_capacity * MAX_PLAYERS * sizeof(int));
+    w->key_capacity = game_spectate_keyframe_capacity(s->width, s->height);
+    w->feed_arena = (uint8_t*)malloc(FEED_ARENA);
+    w->request_capacity = 1024;
+    w->requests = (RoomRequest*)malloc((size_t)w->request_capacity * sizeof(RoomRequest));
+    if (!w->rooms || !w->free_slots || !w->heap || !w->dirty || !w->requests || !w->feed_arena) return false;
+    for (int i = 0; i < w->room_capacity; i++) {
+        w->free_slots[i] = w->room_capacity - 1 - i;
+        w->rooms[i].heap_index = -1;
+        w->rooms[i].clients[0].fd = w->rooms[i].clients[1].fd = -1;
+    }
+    w->free_count = w->room_capacity;
+    for (int i = 0; i < BATCH; i++) {
+        w->out_msgs[i].msg_hdr.msg_iov = &w->out_iov[i];
+        w->out_msgs[i].msg_hdr.msg_iovlen = 1;
+        w->out_msgs[i].msg_hdr.msg_name = &w->out_addr[i];
+        w->out_msgs[i].msg_hdr.msg_namelen = sizeof(w->out_addr[i]);
+    }
+    for (int i = 0; i < FEED_BATCH; i++) {
+        w->feed_msgs[i].msg_hdr.msg_iov = &w->feed_iov[i];
+        w->feed_msgs[i].msg_hdr.msg_iovlen = 1;
+        w->feed_msgs[i].msg_hdr.msg_name = &w->feed_addr[i];
+        w->feed_msgs[i].msg_hdr.msg_namelen = sizeof(w->feed_addr[i]);
+    }
+
+    w->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    w->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    w->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    w->udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (w->epoll_fd < 0 || w->event_fd < 0 || w->timer_fd < 0 || w->udp_fd < 0) return false;
+    int buffer = 4 << 20;
+    setsockopt(w->udp_fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    setsockopt(w->udp_fd, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t length = sizeof(sa);
+    if (bind(w->udp_fd, (struct sockaddr*)&sa, sizeof(sa)) != 0
+        || getsockname(w->udp_fd, (struct sockaddr*)&sa, &length) != 0) return false;
+    w->udp_port = ntohs(sa.sin_port);
+
+    struct epoll_event ev = { EPOLLIN, { .u64 = TAG_EVENT } };
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->event_fd, &ev);
+    ev.data.u64 = TAG_TIMER;
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->timer_fd, &ev);
+    ev.data.u64 = TAG_UDP;
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, w->udp_fd, &ev);
+    return true;
+}
+
+static void worker_free(Worker* w)
+{
+    for (int i = 0; i < w->room_capacity; i++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) if (w->rooms[i].clients[p].fd >= 0) close(w->rooms[i].clients[p].fd);
+        game_room_free(&w->rooms[i].room);
+        free(w->rooms[i].viewers);
+    }
+    for (int i = 0; i < w->request_count; i++) {
+        for (int p = 0; p < MAX_PLAYERS; p++) if (w->requests[i].who[p].tcp) close(w->requests[i].who[p].fd);
+    }
+    free(w->rooms);
+    free(w->free_slots);
+    free(w->heap);
+    free(w->dirty);
+    free(w->requests);
+    free(w->feed_arena);
+    close(w->epoll_fd);
+    close(w->event_fd);
+    close(w->timer_fd);
+    close(w->udp_fd);
+    pthread_mutex_destroy(&w->lock);
+}
+
+//==============================================================
+// [ 報告 ]
+//==============================================================
+// 累計值的快照，報告時與上一次相減
+typedef struct {
+    double wall_ms, cpu_ms;
+    int64_t active, viewers;      // 目前值 (不相減)
+    uint64_t moves, messages, bytes, inputs, started, finished, rejected, dropped;
+    uint64_t feed_ticks, feed_packets, feed_bytes, feed_keyframes;
+    uint64_t jitter[HIST_BUCKETS], latency[HIST_BUCKETS];
+} Totals;
+
+static double cpu_ms(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000.0
+        + (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000.0;
+}
+
+static void collect(Server* s, Totals* t)
+{
+    memset(t, 0, sizeof(*t));
+    t->wall_ms = now_ms();
+    t->cpu_ms = cpu_ms();
+    for (int i = 0; i < s->worker_count; i++) {
+        WorkerStats* st = &s->workers[i].stats;
+        t->moves += counter_get(&st->moves);
+        t->messages += counter_get(&st->messages);
+        t->bytes += counter_get(&st->bytes);
+        t->inputs += counter_get(&st->inputs);
+        t->started += counter_get(&st->rooms_started);
+        t->finished += counter_get(&st->rooms_finished);
+        t->rejected += counter_get(&st->rooms_rejected);
+        t->dropped += counter_get(&st->clients_dropped);
+        t->feed_ticks += counter_get(&st->feed_ticks);
+        t->feed_packets += counter_get(&st->feed_packets);
+        t->feed_bytes += counter_get(&st->feed_bytes);
+        t->feed_keyframes += counter_get(&st->feed_keyframes);
+        t->active += __atomic_load_n(&st->rooms_active, __ATOMIC_RELAXED);
+        t->viewers += __atomic_load_n(&st->viewers, __ATOMIC_RELAXED);
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            t->jitter[b] += counter_get(&st->jitter.counts[b]);
+            t->latency[b] += counter_get(&st->latency.counts[b]);
+        }
+    }
+}
+
+// 輸出 now 與 before 之間的統計
+static void report(const Server* s, const Totals* now, const Totals* before, const char* label)
+{
+    int64_t active = now->active;
+    double wall = (now->wall_ms - before->wall_ms) / 1000.0;
+    if (wall <= 0.0) return;
+    double cores = (now->cpu_ms - before->cpu_ms) / 1000.0 / wall;
+    uint64_t jitter[HIST_BUCKETS], latency[HIST_BUCKETS];
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        jitter[b] = now->jitter[b] - before->jitter[b];
+        latency[b] = now->latency[b] - before->latency[b];
+    }
+    printf("%s rooms %lld (%.0f/worker), cpu %.2f cores -> %.0f rooms/core, %.0f moves/s, %.0f msgs/s (%.2f MB/s), "
+        "%.0f inputs/s, %llu started, %llu finished, %llu rejected, %llu dropped\n",
+        label, (long long)active, (double)active / s->worker_count, cores,
+        cores > 0.0 ? (double)active / cores : 0.0, (double)(now->moves - before->moves) / wall,
+        (double)(now->messages - before->messages) / wall, (double)(now->bytes - before->bytes) / wall / 1e6,
+        (double)(now->inputs - before->inputs) / wall,
+        (unsigned long long)(now->started - before->started), (unsigned long long)(now->finished - before->finished),
+        (unsigned long long)(now->rejected - before->rejected), (unsigned long long)(now->dropped - before->dropped));
+    printf("%s tick jitter p50 %.3f ms, p99 %.3f ms, max %.3f ms; input->broadcast p50 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+        label, hist_percentile(jitter, 0.50) / 1000.0, hist_percentile(jitter, 0.99) / 1000.0, hist_max(jitter) / 1000.0,
+        hist_percentile(latency, 0.50) / 1000.0, hist_percentile(latency, 0.99) / 1000.0, hist_max(latency) / 1000.0);
+    // 觀戰：每位觀眾每次移動收到一個封包，封包的平均大小就是每位觀眾每個影格的位元組數
+    uint64_t packets = now->feed_packets - before->feed_packets;
+    if (now->viewers > 0 || packets > 0) {
+        printf("%s viewers %lld -> %.0f viewers/core, feed %.0f ticks/s, %.0f pkts/s (%.2f MB/s), "
+            "%.1f bytes/tick/viewer, keyframes %.1f%%\n",
+            label, (long long)now->viewers, cores > 0.0 ? (double)now->viewers / cores : 0.0,
+            (double)(now->feed_ticks - before->feed_ticks) / wall, (double)packets / wall,
+            (double)(now->feed_bytes - before->feed_bytes) / wall / 1e6,
+            packets ? (double)(now->feed_bytes - before->feed_bytes) / (double)packets : 0.0,
+            packets ? 100.0 * (double)(now->feed_keyframes - before->feed_keyframes) / (double)packets : 0.0);
+    }
+}
+
+//==============================================================
+// [ 大廳 ]
+//==============================================================
+typedef struct {
+    Server* server;
+    int epoll_fd, listen_fd, udp_fd;
+    Joiner waiting;
+    bool has_waiting;
+    uint32_t waiting_client;
+    int next_worker;
+    int next_viewer_worker;
+    uint64_t rooms;
+    uint64_t* assigned;           // 已配對的 UDP 客戶端 (位址與客戶端編號的雜湊，開放定址)
+    int assigned_count;
+    uint8_t (*pending_in)[16];    // 依 fd 索引：尚未送出完整 JOIN 的 TCP 連線
+    int* pending_length;
+    int fd_limit;
+} Lobby;
+
+static uint64_t joiner_key(const struct sockaddr_in* addr, uint32_t client_id)
+{
+    return splitmix64(((uint64_t)addr->sin_addr.s_addr << 16 | addr->sin_port) ^ ((uint64_t)client_id << 48)) | 1;
+}
+
+// 記錄已配對的 UDP 客戶端；已記錄過時返回false
+static bool lobby_remember(Lobby* l, uint64_t key)
+{
+    if (l->assigned_count >= ASSIGNED_CAPACITY / 2) {
+        memset(l->assigned, 0, ASSIGNED_CAPACITY * sizeof(uint64_t));
+        l->assigned_count = 0;
+    }
+    size_t i = key & (ASSIGNED_CAPACITY - 1);
+    while (l->assigned[i]) {
+        if (l->assigned[i] == key) return false;
+        i = (i + 1) & (ASSIGNED_CAPACITY - 1);
+    }
+    l->assigned[i] = key;
+    l->assigned_count++;
+    return true;
+}
+
+static bool lobby_known(const Lobby* l, uint64_t key)
+{
+    size_t i = key & (ASSIGNED_CAPACITY - 1);
+    while (l->assigned[i]) {
+        if (l->assigned[i] == key) return true;
+        i = (i + 1) & (ASSIGNED_CAPACITY - 1);
+    }
+    return false;
+}
+
+// 把要求放進工作執行緒的交接佇列
+static void worker_enqueue(Worker* w, const RoomRequest* request)
+{
+    RoomRequest q = *request;
+    pthread_mutex_lock(&w->lock);
+    if (w->request_count == w->request_capacity) {
+        RoomRequest* grown = (RoomRequest*)realloc(w->requests, (size_t)w->request_capacity * 2 * sizeof(RoomRequest));
+        if (grown) {
+            w->requests = grown;
+            w->request_capacity *= 2;
+        }
+    }
+    bool queued = w->request_count < w->request_capacity;
+    if (queued) w->requests[w->request_count++] = q;
+    pthread_mutex_unlock(&w->lock);
+    if (!queued) {
+        for (int p = 0; p < MAX_PLAYERS; p++) if (q.who[p].tcp) close(q.who[p].fd);
+        return;
+    }
+    uint64_t one = 1;
+    if (write(w->event_fd, &one, sizeof(one)) < 0) {}
+}
+
+// 配對：和等待中的玩家組成房間，交給下一個工作執行緒
+static void lobby_match(Lobby* l, const Joiner* j, uint32_t client_id)
+{
+    if (!l->has_waiting) {
+        l->waiting = *j;
+        l->waiting_client = client_id;
+        l->has_waiting = true;
+        return;
+    }
+    Server* s = l->server;
+    RoomRequest q;
+    memset(&q, 0, sizeof(q));
+    q.seed = splitmix64(s->seed + l->rooms++);
+    q.who[0] = l->waiting;
+    q.who[1] = *j;
+    l->has_waiting = false;
+    worker_enqueue(&s->workers[l->next_worker], &q);
+    l->next_worker = (l->next_worker + 1) % s->worker_count;
+}
+
+// 觀看要求：指定房間時交給房間所在的工作執行緒，任一房間時依序分配
+static void lobby_watch(Lobby* l, uint32_t room, uint8_t flags, const struct sockaddr_in* from)
+{
+    Server* s = l->server;
+    int worker;
+    if (room == 0) {
+        worker = l->next_viewer_worker;
+        l->next_viewer_worker = (l->next_viewer_worker + 1) % s->worker_count;
+    }
+    else {
+        worker = (int)((room >> ROOM_SLOT_BITS) & ((1u << ROOM_WORKER_BITS) - 1));
+        if (worker >= s->worker_count) return;
+    }
+    RoomRequest q;
+    memset(&q, 0, sizeof(q));
+    q.watch = true;
+    q.room = room;
+    q.flags = flags;
+    q.who[0].addr = *from;
+    worker_enqueue(&s->workers[worker], &q);
+}
+
+// 讀取大廳的 UDP JOIN 與 WATCH
+static void lobby_read_udp(Lobby* l)
+{
+    uint8_t data[GAME_ROOM_MAX_MESSAGE];
+    struct sockaddr_in from;
+    for (;;) {
+        socklen_t length = sizeof(from);
+        ssize_t n = recvfrom(l->udp_fd, data, sizeof(data), MSG_DONTWAIT, (struct sockaddr*)&from, &length);
+        if (n < 0) return;
+        uint32_t room;
+        uint8_t flags;
+        if (n > 0 && data[0] == SPECTATE_WATCH) {
+            if (game_spectate_decode_watch(data, (size_t)n, &room, &flags)) lobby_watch(l, room, flags, &from);
+            continue;
+        }
+        GameRoomMessage m;
+        if (game_room_decode(data, (int)n, &m) <= 0 || m.type != ROOM_MSG_JOIN) continue;
+        // 重送的 JOIN：正在等待或已經配對
+        if (l->has_waiting && !l->waiting.tcp && l->waiting.addr.sin_addr.s_addr == from.sin_addr.s_addr
+            && l->waiting.addr.sin_port == from.sin_port) continue;
+        uint64_t key = joiner_key(&from, m.client_id);
+        if (lobby_known(l, key)) continue;
+        lobby_remember(l, key);
+        Joiner j = { false, -1, from };
+        lobby_match(l, &j, m.client_id);
+    }
+}
+
+// 接受 TCP 連線
+static void lobby_accept(Lobby* l)
+{
+    for (;;) {
+        int fd = accept4(l->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;
+        if (fd >= l->fd_limit) {
+            close(fd);
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        l->pending_length[fd] = 0;
+        struct epoll_event ev = { EPOLLIN, { .u64 = TAG_PENDING + (uint64_t)fd } };
+        if (epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) close(fd);
+    }
+}
+
+// 讀取尚未配對的 TCP 連線的 JOIN
+static void lobby_read_pending(Lobby* l, int fd)
+{
+    ssize_t n = read(fd, l->pending_in[fd] + l->pending_length[fd], sizeof(l->pending_in[fd]) - (size_t)l->pending_length[fd]);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+    GameRoomMessage m;
+    int used = n > 0 ? game_room_decode(l->pending_in[fd], l->pending_length[fd] += (int)n, &m) : -1;
+    if (used == 0) return; // 還不完整
+    epoll_ctl(l->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    if (used < 0 || m.type != ROOM_MSG_JOIN) {
+        if (l->has_waiting && l->waiting.tcp && l->waiting.fd == fd) l->has_waiting = false;
+        close(fd);
+        return;
+    }
+    Joiner j;
+    memset(&j, 0, sizeof(j));
+    j.tcp = true;
+    j.fd = fd;
+    lobby_match(l, &j, m.client_id);
+}
+
+static int open_listeners(Lobby* l, int port)
+{
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    sa.sin_port = htons((uint16_t)port);
+    int on = 1;
+    l->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    l->udp_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (l->listen_fd < 0 || l->udp_fd < 0) return -1;
+    setsockopt(l->listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    int buffer = 4 << 20;
+    setsockopt(l->udp_fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    if (bind(l->listen_fd, (struct sockaddr*)&sa, sizeof(sa)) != 0 || listen(l->listen_fd, 4096) != 0) return -1;
+    if (bind(l->udp_fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) return -1;
+    l->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = { EPOLLIN, { .u64 = TAG_LISTEN } };
+    epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, l->listen_fd, &ev);
+    ev.data.u64 = TAG_LOBBY;
+    epoll_ctl(l->epoll_fd, EPOLL_CTL_ADD, l->udp_fd, &ev);
+    return 0;
+}
+
+//==============================================================
+// [ 入口 ]
+//==============================================================
+static void usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [-p port] [-w workers] [-d seconds] [-i report_s] [-r rooms_per_worker]"
+        " [-W width] [-H height] [-s seed]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    static Server server;
+    Server* s = &server;
+    s->port = 7300;
+    s->worker_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    s->rooms_per_worker = 16384;
+    s->width = GRID_WIDTH;
+    s->height = GRID_HEIGHT;
+    s->seed = 1;
+    double duration = 0.0, interval = 5.0;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool has = i + 1 < argc;
+        if (strcmp(a, "-p") == 0 && has) s->port = atoi(argv[++i]);
+        else if (strcmp(a, "-w") == 0 && has) s->worker_count = atoi(argv[++i]);
+        else if (strcmp(a, "-d") == 0 && has) duration = atof(argv[++i]);
+        else if (strcmp(a, "-i") == 0 && has) interval = atof(argv[++i]);
+        else if (strcmp(a, "-r") == 0 && has) s->rooms_per_worker = atoi(argv[++i]);
+        else if (strcmp(a, "-W") == 0 && has) s->width = atoi(argv[++i]);
+        else if (strcmp(a, "-H") == 0 && has) s->height = atoi(argv[++i]);
+        else if (strcmp(a, "-s") == 0 && has) s->seed = strtoull(argv[++i], NULL, 10);
+        else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (s->worker_count < 1) s->worker_count = 1;
+    if (s->worker_count > MAX_WORKERS) s->worker_count = MAX_WORKERS;
+    if (s->rooms_per_worker < 1 || s->rooms_per_worker > (1 << ROOM_SLOT_BITS)) s->rooms_per_worker = 1 << ROOM_SLOT_BITS;
+    if (s->width < 8 || s->width > 255 || s->height < 8 || s->height > 255) {
+        fprintf(stderr, "grid must be between 8x8 and 255x255\n");
+        return 2;
+    }
+    if (interval <= 0.0) interval = 5.0;
+
+    // 每位玩家一個 TCP 連線：把可開啟的檔案數提高到上限
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        getrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    static Lobby lobby;
+    Lobby* l = &lobby;
+    l->server = s;
+    l->fd_limit = rl.rlim_cur > 1048576 ? 1048576 : (int)rl.rlim_cur;
+    l->assigned = (uint64_t*)calloc(ASSIGNED_CAPACITY, sizeof(uint64_t));
+    l->pending_in = calloc((size_t)l->fd_limit, sizeof(*l->pending_in));
+    l->pending_length = (int*)calloc((size_t)l->fd_limit, sizeof(int));
+    if (!l->assigned || !l->pending_in || !l->pending_length || open_listeners(l, s->port) != 0) {
+        fprintf(stderr, "cannot listen on port %d\n", s->port);
+        return 1;
+    }
+
+    for (int i = 0; i < s->worker_count; i++) {
+        if (!worker_init(&s->workers[i], s, i)) {
+            fprintf(stderr, "cannot start worker %d\n", i);
+            return 1;
+        }
+        pthread_create(&s->workers[i].thread, NULL, worker_main, &s->workers[i]);
+    }
+    printf("server: port %d (tcp+udp), %d workers, %d rooms/worker max, %dx%d grid, fd limit %d\n",
+        s->port, s->worker_count, s->rooms_per_worker, s->width, s->height, l->fd_limit);
+
+    Totals start, last, current;
+    collect(s, &start);
+    last = start;
+    double next_report = start.wall_ms + interval * 1000.0;
+    double end = duration > 0.0 ? start.wall_ms + duration * 1000.0 : -1.0;
+    struct epoll_event events[BATCH];
+    while (!server_stop) {
+        double now = now_ms();
+        if (end > 0.0 && now >= end) break;
+        if (now >= next_report) {
+            collect(s, &current);
+            char label[32];
+            snprintf(label, sizeof(label), "[%6.1fs]", (current.wall_ms - start.wall_ms) / 1000.0);
+            report(s, &current, &last, label);
+            last = current;
+            next_report += interval * 1000.0;
+        }
+        int timeout = (int)(next_report - now) + 1;
+        int n = epoll_wait(l->epoll_fd, events, BATCH, timeout > 0 ? timeout : 0);
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == TAG_LISTEN) lobby_accept(l);
+            else if (tag == TAG_LOBBY) lobby_read_udp(l);
+            else lobby_read_pending(l, (int)(tag - TAG_PENDING));
+        }
+    }
+
+    server_stop = 1;
+    for (int i = 0; i < s->worker_count; i++) pthread_join(s->workers[i].thread, NULL);
+    collect(s, &current);
+    report(s, &current, &start, "[total]");
+    for (int i = 0; i < s->worker_count; i++) worker_free(&s->workers[i]);
+    if (l->has_waiting && l->waiting.tcp) close(l->waiting.fd);
+    close(l->listen_fd);
+    close(l->udp_fd);
+    close(l->epoll_fd);
+    free(l->assigned);
+    free(l->pending_in);
+    free(l->pending_length);
+    return 0;
+}
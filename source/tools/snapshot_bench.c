@@ -0,0 +1,168 @@
+// 快照存讀檔的效能測試 (Linux，無介面)。
+// 在大型網格上建立很長的蛇，量測寫入記憶體、寫入檔案與映射後載入的時間。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/snapshot_bench.c source/game_snapshot.c source/game_core.c -o snapshot_bench
+//   ./snapshot_bench [寬度 高度 ...]     (預設 40x20、256x256、1024x1024、2048x2048)
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "game_core.h"
+#include "game_snapshot.h"
+
+// 每種尺寸重複量測的次數
+#define BENCH_RUNS 9
+
+// 單調時鐘 (微秒)
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// 取中位數
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double* v, int n)
+{
+    qsort(v, n, sizeof(double), compare_double);
+    return v[n / 2];
+}
+
+// 建立雙人局面：每條蛇以來回蛇行的方式佔滿半個網格，蛇頭放在環狀緩衝區中段以測試分段複製
+static void build_long_snakes(GameState* game)
+{
+    game_new_multi(game);
+    int half = game->height / 2;
+    for (int p = 0; p < 2; p++) {
+        SnakeBody* body = &game->players[p].body;
+        body->head = body->capacity / 3;
+        body->length = 0;
+        for (int y = 0; y < half; y++) {
+            for (int i = 0; i < game->width; i++) {
+                int x = (y % 2 == 0) ? i : game->width - 1 - i;
+                int idx = (body->head + body->length) % body->capacity;
+                body->cells[idx].x = x;
+                body->cells[idx].y = p * half + y;
+                body->length++;
+            }
+        }
+        game->players[p].score = body->length;
+    }
+    game_rehash(game);
+}
+
+// 比較兩個局面是否相同
+static int same_state(const GameState* a, const GameState* b)
+{
+    if (a->player_count != b->player_count || a->obstacle_count != b->obstacle_count) return 0;
+    if (a->rng_state != b->rng_state || a->food.x != b->food.x || a->food.y != b->food.y) return 0;
+    if (memcmp(a->obstacles, b->obstacles, (size_t)a->obstacle_count * sizeof(Obstacle)) != 0) return 0;
+    for (int p = 0; p < a->player_count; p++) {
+        const Player* pa = &a->players[p];
+        const Player* pb = &b->players[p];
+        if (pa->body.length != pb->body.length || pa->score != pb->score
+            || pa->direction != pb->direction || pa->next_direction != pb->next_direction) return 0;
+        for (int i = 0; i < pa->body.length; i++) {
+            Point x = snake_body_at(&pa->body, i), y = snake_body_at(&pb->body, i);
+            if (x.x != y.x || x.y != y.y) return 0;
+        }
+    }
+    return 1;
+}
+
+// 量測一種網格尺寸
+static int bench_size(int width, int height, const char* path)
+{
+    GameState game, loaded;
+    if (!game_state_init(&game, width, height) || !game_state_init(&loaded, GRID_WIDTH, GRID_HEIGHT)) {
+        fprintf(stderr, "%dx%d: allocation failed\n", width, height);
+        return 1;
+    }
+    game_seed(&game, 12345);
+    build_long_snakes(&game);
+
+    GameSession session = { 0 };
+    session.mode = 3;          // 介面層的 MODE_MULTI
+    session.started = 1;
+    session.countdown_remaining_us = -1;
+    session.step_remaining_us[0] = 40000;
+    session.step_remaining_us[1] = 70000;
+
+    size_t size = game_snapshot_size(&game);
+    void* buffer = malloc(size);
+    double t_mem[BENCH_RUNS], t_file[BENCH_RUNS], t_load[BENCH_RUNS];
+    int ok = 1;
+
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        // 寫入記憶體
+        double t0 = now_us();
+        game_snapshot_write(&game, &session, buffer, size);
+        t_mem[r] = now_us() - t0;
+
+        // 寫入檔案
+        t0 = now_us();
+        FILE* f = fopen(path, "wb");
+        if (!f || fwrite(buffer, 1, size, f) != size) ok = 0;
+        if (f) fclose(f);
+        t_file[r] = now_us() - t0 + t_mem[r];
+
+        // 映射後載入 (開檔、映射、檢查、複製、解除映射)
+        t0 = now_us();
+        int fd = open(path, O_RDONLY);
+        struct stat st;
+        fstat(fd, &st);
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        GameSession got;
+        if (map == MAP_FAILED || !game_snapshot_read(&loaded, &got, map, (size_t)st.st_size)) ok = 0;
+        if (map != MAP_FAILED) munmap(map, (size_t)st.st_size);
+        close(fd);
+        t_load[r] = now_us() - t0;
+    }
+    if (!same_state(&game, &loaded)) ok = 0;
+
+    double mb = size / (1024.0 * 1024.0);
+    double load = median(t_load, BENCH_RUNS);
+    printf("%5dx%-5d snake %9d x2  %9.2f MB  write(mem) %9.3f ms  save(file) %9.3f ms  load(mmap) %9.3f ms  %8.1f MB/s  %s\n",
+        width, height, game.players[0].body.length, mb,
+        median(t_mem, BENCH_RUNS) / 1000.0, median(t_file, BENCH_RUNS) / 1000.0, load / 1000.0,
+        mb / (load / 1e6), ok ? "ok" : "MISMATCH");
+
+    free(buffer);
+    game_state_free(&game);
+    game_state_free(&loaded);
+    unlink(path);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    static const int default_sizes[][2] = { { 40, 20 }, { 256, 256 }, { 1024, 1024 }, { 2048, 2048 } };
+    const char* path = "snapshot_bench.snap";
+    int failed = 0;
+
+    if (argc >= 3) {
+        for (int i = 1; i + 1 < argc; i += 2) {
+            failed |= bench_size(atoi(argv[i]), atoi(argv[i + 1]), path);
+        }
+    }
+    else {
+        for (size_t i = 0; i < sizeof(default_sizes) / sizeof(default_sizes[0]); i++) {
+            failed |= bench_size(default_sizes[i][0], default_sizes[i][1], path);
+        }
+    }
+    return failed;
+}
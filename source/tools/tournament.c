@@ -0,0 +1,354 @@
+// 電腦玩家循環賽 (Linux，無介面)。
+// 每一對電腦玩家以兩種座位各對戰 N 場，每場使用固定的種子，規則與勝負判定和雙人模式相同。
+// 對戰分配在工作竊取 (work-stealing) 的執行緒池上：每個執行緒從自己的佇列尾端取工作，
+// 佇列空了再從其他執行緒的佇列前端竊取。結果依對戰編號存放，與執行緒數無關。
+// 輸出勝場矩陣、平局矩陣與 Elo 評分 (Bradley-Terry 最大概似估計)。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -pthread -Iinclude source/tools/tournament.c source/game_bot.c source/game_pathfind.c source/game_mcts.c source/game_sim.c source/game_core.c -o tournament -lm
+//   ./tournament [-n 每種座位的場數] [-t 執行緒數] [-s 種子] [-m 每場遊戲時間上限(毫秒)]
+//                [-b random,straight,greedy,autopilot,mcts] [--scaling]
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "game_core.h"
+#include "game_bot.h"
+
+#define MAX_BOTS 16
+
+//========================[ 結構定義 ]========================
+// 一場對戰
+typedef struct {
+    int a, b;          // 玩家1與玩家2使用的電腦玩家索引
+    uint64_t seed;     // 本場的種子
+    int winner;        // 結果 (1, 2, 0: 平局)
+    long steps;        // 總步數
+} Match;
+
+// 工作佇列：擁有者從尾端取出，竊取者從前端取出
+typedef struct {
+    pthread_mutex_t lock;
+    int* items;
+    int head, tail;    // [head, tail) 為尚未執行的對戰
+} WorkDeque;
+
+// 執行緒池
+typedef struct {
+    int threads;
+    WorkDeque* deques;
+    Match* matches;
+    const char* const* bot_names;
+    int bot_count;
+    long max_ms;
+    long steals;       // 成功竊取的次數
+    pthread_mutex_t stats_lock;
+} Pool;
+
+typedef struct {
+    Pool* pool;
+    int index;
+} WorkerArg;
+
+// 單調時鐘 (秒)
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+//==============================================================
+// [ 工作竊取佇列 ]
+//==============================================================
+// 從自己的佇列尾端取出工作
+static int deque_pop(WorkDeque* dq)
+{
+    int item = -1;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail > dq->head) item = dq->items[--dq->tail];
+    pthread_mutex_unlock(&dq->lock);
+    return item;
+}
+
+// 從其他執行緒的佇列前端竊取工作
+static int deque_steal(WorkDeque* dq)
+{
+    int item = -1;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->tail > dq->head) item = dq->items[dq->head++];
+    pthread_mutex_unlock(&dq->lock);
+    return item;
+}
+
+// 取得下一個工作：先取自己的，再依序嘗試其他執行緒
+static int pool_next(Pool* pool, int self, long* steals)
+{
+    int item = deque_pop(&pool->deques[self]);
+    if (item >= 0) return item;
+    for (int k = 1; k < pool->threads; k++) {
+        item = deque_steal(&pool->deques[(self + k) % pool->threads]);
+        if (item >= 0) {
+            (*steals)++;
+            return item;
+        }
+    }
+    return -1; // 所有佇列都已清空 (工作不會再增加)
+}
+
+static void* worker_main(void* arg)
+{
+    WorkerArg* wa = (WorkerArg*)arg;
+    Pool* pool = wa->pool;
+
+    // 每個執行緒一個遊戲狀態與一組電腦玩家，對戰期間不再配置記憶體
+    GameState game;
+    if (!game_state_init(&game, GRID_WIDTH, GRID_HEIGHT)) return NULL;
+    GameBot bots[MAX_BOTS];
+    for (int i = 0; i < pool->bot_count; i++) game_bot_init(&bots[i], pool->bot_names[i]);
+    long steals = 0;
+
+    int m;
+    while ((m = pool_next(pool, wa->index, &steals)) >= 0) {
+        Match* match = &pool->matches[m];
+        GameBot* seats[MAX_PLAYERS] = { &bots[match->a], &bots[match->b] };
+        GameMatchResult r = game_play_match(&game, match->seed, seats, pool->max_ms);
+        match->winner = r.winner;
+        match->steps = r.steps;
+    }
+    for (int i = 0; i < pool->bot_count; i++) game_bot_free(&bots[i]);
+
+    pthread_mutex_lock(&pool->stats_lock);
+    pool->steals += steals;
+    pthread_mutex_unlock(&pool->stats_lock);
+    game_state_free(&game);
+    return NULL;
+}
+
+// 以指定的執行緒數執行所有對戰，返回花費的秒數
+static double run_pool(Match* matches, int match_count, const char* const* bot_names, int bot_count,
+    int threads, long max_ms, long* steals)
+{
+    Pool pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.threads = threads;
+    pool.matches = matches;
+    pool.bot_names = bot_names;
+    pool.bot_count = bot_count;
+    pool.max_ms = max_ms;
+    pthread_mutex_init(&pool.stats_lock, NULL);
+
+    // 依序平均分配到各執行緒的佇列 (同一對電腦玩家的對戰集中在同一個執行緒，負載不均時靠竊取平衡)
+    pool.deques = calloc((size_t)threads, sizeof(WorkDeque));
+    int* items = malloc(sizeof(int) * (size_t)match_count);
+    for (int i = 0; i < match_count; i++) items[i] = i;
+    for (int t = 0; t < threads; t++) {
+        WorkDeque* dq = &pool.deques[t];
+        pthread_mutex_init(&dq->lock, NULL);
+        dq->items = items;
+        dq->head = (int)((long)match_count * t / threads);
+        dq->tail = (int)((long)match_count * (t + 1) / threads);
+    }
+
+    pthread_t* tids = malloc(sizeof(pthread_t) * (size_t)threads);
+    WorkerArg* args = malloc(sizeof(WorkerArg) * (size_t)threads);
+    double t0 = now_sec();
+    for (int t = 0; t < threads; t++) {
+        args[t].pool = &pool;
+        args[t].index = t;
+        pthread_create(&tids[t], NULL, worker_main, &args[t]);
+    }
+    for (int t = 0; t < threads; t++) pthread_join(tids[t], NULL);
+    double secs = now_sec() - t0;
+
+    for (int t = 0; t < threads; t++) pthread_mutex_destroy(&pool.deques[t].lock);
+    pthread_mutex_destroy(&pool.stats_lock);
+    *steals = pool.steals;
+    free(args);
+    free(tids);
+    free(items);
+    free(pool.deques);
+    return secs;
+}
+
+//==============================================================
+// [ 評分 ]
+//==============================================================
+// Bradley-Terry 最大概似估計 (平局算半勝)，每位加上一場對虛擬對手的平局避免全勝或全敗時發散
+static void compute_elo(int n, double games[MAX_BOTS][MAX_BOTS], const double points[MAX_BOTS], double* elo)
+{
+    double gamma[MAX_BOTS];
+    for (int i = 0; i < n; i++) gamma[i] = 1.0;
+    for (int iter = 0; iter < 1000; iter++) {
+        double change = 0.0;
+        for (int i = 0; i < n; i++) {
+            double denom = 1.0 / (gamma[i] + 1.0); // 虛擬對手 (強度 1)
+            for (int j = 0; j < n; j++) {
+                if (j != i && games[i][j] > 0) denom += games[i][j] / (gamma[i] + gamma[j]);
+            }
+            double next = (points[i] + 0.5) / denom;
+            change += fabs(next - gamma[i]);
+            gamma[i] = next;
+        }
+        if (change < 1e-10) break;
+    }
+    double mean = 0.0;
+    for (int i = 0; i < n; i++) {
+        elo[i] = 400.0 * log10(gamma[i]);
+        mean += elo[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; i++) elo[i] = elo[i] - mean + 1500.0;
+}
+
+// 輸出勝場、平局矩陣與 Elo
+static void report(const Match* matches, int match_count, const char* const* names, int n)
+{
+    int wins[MAX_BOTS][MAX_BOTS] = { { 0 } };
+    int draws[MAX_BOTS][MAX_BOTS] = { { 0 } };
+    double games[MAX_BOTS][MAX_BOTS] = { { 0 } };
+    double points[MAX_BOTS] = { 0 };
+
+    for (int m = 0; m < match_count; m++) {
+        const Match* mt = &matches[m];
+        games[mt->a][mt->b] += 1.0;
+        games[mt->b][mt->a] += 1.0;
+        if (mt->winner == 1) { wins[mt->a][mt->b]++; points[mt->a] += 1.0; }
+        else if (mt->winner == 2) { wins[mt->b][mt->a]++; points[mt->b] += 1.0; }
+        else {
+            draws[mt->a][mt->b]++;
+            draws[mt->b][mt->a]++;
+            points[mt->a] += 0.5;
+            points[mt->b] += 0.5;
+        }
+    }
+
+    printf("\nwins (row beat column):\n%-10s", "");
+    for (int j = 0; j < n; j++) printf("%10s", names[j]);
+    printf("\n");
+    for (int i = 0; i < n; i++) {
+        printf("%-10s", names[i]);
+        for (int j = 0; j < n; j++) {
+            if (i == j) printf("%10s", "-");
+            else printf("%10d", wins[i][j]);
+        }
+        printf("\n");
+    }
+
+    printf("\ndraws:\n%-10s", "");
+    for (int j = 0; j < n; j++) printf("%10s", names[j]);
+    printf("\n");
+    for (int i = 0; i < n; i++) {
+        printf("%-10s", names[i]);
+        for (int j = 0; j < n; j++) {
+            if (i == j) printf("%10s", "-");
+            else printf("%10d", draws[i][j]);
+        }
+        printf("\n");
+    }
+
+    double elo[MAX_BOTS];
+    compute_elo(n, games, points, elo);
+    printf("\n%-10s %8s %8s %8s\n", "bot", "games", "points", "elo");
+    for (int i = 0; i < n; i++) {
+        double total = 0.0;
+        for (int j = 0; j < n; j++) total += games[i][j];
+        printf("%-10s %8.0f %8.1f %8.0f\n", names[i], total, points[i], elo[i]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int per_seat = 100;
+    int threads = 0;
+    uint64_t seed = 1;
+    long max_ms = 10 * 60 * 1000; // 每場最多10分鐘的遊戲時間
+    int scaling = 0;
+    char bot_list[256] = "random,straight,greedy,autopilot";
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--scaling") == 0) { scaling = 1; continue; }
+        if (i + 1 >= argc) { fprintf(stderr, "missing value for %s\n", a); return 2; }
+        const char* v = argv[++i];
+        if (strcmp(a, "-n") == 0) per_seat = atoi(v);
+        else if (strcmp(a, "-t") == 0) threads = atoi(v);
+        else if (strcmp(a, "-s") == 0) seed = strtoull(v, NULL, 10);
+        else if (strcmp(a, "-m") == 0) max_ms = atol(v);
+        else if (strcmp(a, "-b") == 0) snprintf(bot_list, sizeof(bot_list), "%s", v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 2; }
+    }
+    if (threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (int)n : 1;
+    }
+
+    // 解析電腦玩家清單
+    const char* names[MAX_BOTS];
+    int bot_count = 0;
+    for (char* tok = strtok(bot_list, ","); tok && bot_count < MAX_BOTS; tok = strtok(NULL, ",")) {
+        GameBot probe;
+        if (!game_bot_init(&probe, tok)) { fprintf(stderr, "unknown bot %s\n", tok); return 2; }
+        names[bot_count++] = tok;
+    }
+    if (bot_count < 2) { fprintf(stderr, "need at least two bots\n"); return 2; }
+
+    // 建立對戰清單：每一對以兩種座位各對戰 per_seat 場，同一場的兩種座位使用同一個種子
+    int match_count = bot_count * (bot_count - 1) * per_seat;
+    Match* matches = calloc((size_t)match_count, sizeof(Match));
+    int m = 0;
+    for (int i = 0; i < bot_count; i++) {
+        for (int j = 0; j < bot_count; j++) {
+            if (i == j) continue;
+            int lo = i < j ? i : j, hi = i < j ? j : i;
+            for (int k = 0; k < per_seat; k++) {
+                matches[m].a = i;
+                matches[m].b = j;
+                matches[m].seed = seed + ((uint64_t)(lo * MAX_BOTS + hi) << 32) + (uint64_t)k;
+                m++;
+            }
+        }
+    }
+
+    long steals = 0;
+    double secs;
+    if (scaling) {
+        // 以 1, 2, 4 ... 個執行緒各跑一次，檢查結果一致並輸出加速比
+        Match* reference = malloc(sizeof(Match) * (size_t)match_count);
+        double base = 0.0;
+        printf("%8s %10s %12s %10s %8s\n", "threads", "seconds", "matches/s", "speedup", "steals");
+        for (int t = 1; ; t = (t * 2 > threads && t < threads) ? threads : t * 2) {
+            secs = run_pool(matches, match_count, names, bot_count, t, max_ms, &steals);
+            if (t == 1) {
+                base = secs;
+                memcpy(reference, matches, sizeof(Match) * (size_t)match_count);
+            }
+            else if (memcmp(reference, matches, sizeof(Match) * (size_t)match_count) != 0) {
+                fprintf(stderr, "results differ with %d threads\n", t);
+                return 1;
+            }
+            printf("%8d %10.3f %12.0f %9.2fx %8ld\n", t, secs, match_count / secs, base / secs, steals);
+            if (t >= threads) break;
+        }
+        free(reference);
+    }
+    else {
+        secs = run_pool(matches, match_count, names, bot_count, threads, max_ms, &steals);
+    }
+
+    long total_steps = 0;
+    for (int i = 0; i < match_count; i++) total_steps += matches[i].steps;
+    printf("%d matches, %d threads, %.3f s: %.0f matches/s (%.0f per thread), %.3g steps/s, %ld steals\n",
+        match_count, threads, secs, match_count / secs, match_count / secs / threads,
+        total_steps / secs, steals);
+
+    report(matches, match_count, names, bot_count);
+    free(matches);
+    return 0;
+}
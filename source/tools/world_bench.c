@@ -0,0 +1,303 @@
+// 無盡模式的長距離測試 (Linux，無介面)。
+// 由簡單的電腦玩家駕駛蛇往外走很遠 (每段路線以東方為主，每四段往回走一次，讓再次接近的區塊從壓縮紀錄還原)，
+// 每個區間輸出蛇頭的距離、每一步 (game_world_step) 與每個畫面 (以 -DBENCH_CAIRO 建置時，game_draw_world 繪製到離屏影像)
+// 的平均與最長耗時、常駐的區塊數與壓縮紀錄數，以及世界狀態的位元組數；
+// 耗時與記憶體應不隨距離增加 (蛇長在吃到食物後增加，達到上限之前每一步的自撞檢查會變慢)。
+// 常駐區塊或壓縮紀錄超過上限，或常駐區塊的牆在碰撞判定中不成立時以狀態碼1結束。
+// 蛇死亡時以下一個種子重新開始 (距離歸零)，並計入死亡次數。
+//
+// 建置與執行：
+//   gcc -std=c11 -O2 -Iinclude source/tools/world_bench.c source/game_world.c source/game_core.c -o world_bench -lm
+//   (加上繪製：-DBENCH_CAIRO source/game_draw.c source/game_perf.c $(pkg-config --cflags --libs cairo))
+//   ./world_bench [-n 步數] [-r 每個區間的步數] [-s 種子]
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_core.h"
+#include "game_world.h"
+#ifdef BENCH_CAIRO
+#include "game_draw.h"
+#endif
+
+// 電腦玩家檢查空間的視窗 (格，以蛇頭為中心)
+#define BOT_WINDOW 64
+// 每隔幾步繪製一次
+#define DRAW_EVERY 10
+
+//========================[ 結構定義 ]========================
+// 電腦玩家
+typedef struct {
+    uint64_t rng;
+    Point target;               // 這段路線的終點
+    long leg_steps;             // 這段路線剩餘的步數
+    long legs;                  // 已走過的路線數
+    Point origin;               // 視窗左上角的世界座標
+    uint8_t blocked[BOT_WINDOW * BOT_WINDOW];
+    uint32_t seen[BOT_WINDOW * BOT_WINDOW];
+    uint32_t stamp;
+    int16_t queue[BOT_WINDOW * BOT_WINDOW];
+} WorldBot;
+
+// 一個區間的統計
+typedef struct {
+    long steps;
+    double step_ns, step_max_ns;
+    long draws;
+    double draw_us, draw_max_us;
+} BenchWindow;
+
+//==============================================================
+// [ 電腦玩家 ]
+//==============================================================
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int64_t rand_range(WorldBot* bot, int64_t lo, int64_t hi)
+{
+    uint64_t z = (bot->rng += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return lo + (int64_t)(z % (uint64_t)(hi - lo + 1));
+}
+
+static int manhattan(Point a, Point b)
+{
+    int dx = a.x - b.x, dy = a.y - b.y;
+    return (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy);
+}
+
+static Point step_point(Point p, Direction dir)
+{
+    switch (dir) {
+    case DIR_UP:    p.y--; break;
+    case DIR_DOWN:  p.y++; break;
+    case DIR_LEFT:  p.x--; break;
+    case DIR_RIGHT: p.x++; break;
+    }
+    return p;
+}
+
+// 選擇下一段路線：以東方為主，每四段往西走回頭路
+static void next_leg(WorldBot* bot, Point head)
+{
+    bot->legs++;
+    int64_t dx = (bot->legs % 4 == 0) ? -rand_range(bot, 300, 1500) : rand_range(bot, 500, 2500);
+    int64_t dy = rand_range(bot, -1500, 1500);
+    bot->target.x = head.x + (int)dx;
+    bot->target.y = head.y + (int)dy;
+    bot->leg_steps = 2 * (long)(llabs(dx) + llabs(dy)) + 200;
+}
+
+// 以常駐區塊的牆與蛇身建立視窗內的障礙
+static void build_window(WorldBot* bot, const GameWorld* world)
+{
+    Point h = game_world_body_at(world, 0);
+    bot->origin.x = h.x - BOT_WINDOW / 2;
+    bot->origin.y = h.y - BOT_WINDOW / 2;
+    memset(bot->blocked, 0, sizeof(bot->blocked));
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+        const WorldChunk* c = &world->chunks[i];
+        if (!c->used) continue;
+        for (int w = 0; w < c->wall_count; w++) {
+            const WorldWall* wall = &c->walls[w];
+            for (int y = 0; y < wall->height; y++) {
+                for (int x = 0; x < wall->width; x++) {
+                    int wx = c->cx * WORLD_CHUNK_SIZE + wall->x + x - bot->origin.x;
+                    int wy = c->cy * WORLD_CHUNK_SIZE + wall->y + y - bot->origin.y;
+                    if (wx >= 0 && wx < BOT_WINDOW && wy >= 0 && wy < BOT_WINDOW) bot->blocked[wy * BOT_WINDOW + wx] = 1;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < world->length; i++) {
+        Point seg = game_world_body_at(world, i);
+        int x = seg.x - bot->origin.x, y = seg.y - bot->origin.y;
+        if (x >= 0 && x < BOT_WINDOW && y >= 0 && y < BOT_WINDOW) bot->blocked[y * BOT_WINDOW + x] = 1;
+    }
+}
+
+// 從某格出發在視窗內可以到達的格子數 (最多 limit)
+static int flood(WorldBot* bot, Point start, int limit)
+{
+    int sx = start.x - bot->origin.x, sy = start.y - bot->origin.y;
+    if (sx < 0 || sx >= BOT_WINDOW || sy < 0 || sy >= BOT_WINDOW || bot->blocked[sy * BOT_WINDOW + sx]) return 0;
+    bot->stamp++;
+    int head = 0, tail = 0;
+    bot->queue[tail++] = (int16_t)(sy * BOT_WINDOW + sx);
+    bot->seen[sy * BOT_WINDOW + sx] = bot->stamp;
+    while (head < tail && tail < limit) {
+        int cell = bot->queue[head++];
+        int x = cell % BOT_WINDOW, y = cell / BOT_WINDOW;
+        static const int dx[4] = { 0, 0, -1, 1 }, dy[4] = { -1, 1, 0, 0 };
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], ny = y + dy[d];
+            if (nx < 0 || nx >= BOT_WINDOW || ny < 0 || ny >= BOT_WINDOW) continue;
+            int n = ny * BOT_WINDOW + nx;
+            if (bot->blocked[n] || bot->seen[n] == bot->stamp) continue;
+            bot->seen[n] = bot->stamp;
+            bot->queue[tail++] = (int16_t)n;
+        }
+    }
+    return tail;
+}
+
+// 往終點前進，避開空間不足的方向
+static Direction bot_decide(WorldBot* bot, const GameWorld* world)
+{
+    static const Direction opposite[4] = { DIR_DOWN, DIR_UP, DIR_RIGHT, DIR_LEFT };
+    Point h = game_world_body_at(world, 0);
+    if (--bot->leg_steps <= 0 || manhattan(h, bot->target) < 4) next_leg(bot, h);
+    build_window(bot, world);
+
+    // 依離終點的距離排序候選方向 (同距離時保持直行)
+    Direction order[3];
+    int dist[3], n = 0;
+    for (int d = 0; d < 4; d++) {
+        if ((Direction)d == opposite[world->direction]) continue;
+        int k = n++;
+        int m = manhattan(step_point(h, (Direction)d), bot->target) * 2 + ((Direction)d == world->direction ? 0 : 1);
+        while (k > 0 && dist[k - 1] > m) {
+            order[k] = order[k - 1];
+            dist[k] = dist[k - 1];
+            k--;
+        }
+        order[k] = (Direction)d;
+        dist[k] = m;
+    }
+
+    int limit = world->length + 32 < BOT_WINDOW * BOT_WINDOW / 4 ? world->length + 32 : BOT_WINDOW * BOT_WINDOW / 4;
+    Direction best = order[0];
+    int best_space = -1;
+    for (int i = 0; i < n; i++) {
+        int space = flood(bot, step_point(h, order[i]), limit);
+        if (space >= limit) return order[i];
+        if (space > best_space) {
+            best_space = space;
+            best = order[i];
+        }
+    }
+    return best;
+}
+
+//==============================================================
+// [ 檢查 ]
+//==============================================================
+// 常駐區塊與壓縮紀錄在上限之內，且常駐區塊的每一面牆在碰撞判定中都成立
+static bool check_world(const GameWorld* world)
+{
+    if (world->chunk_count > WORLD_ACTIVE_CHUNKS || world->packed_count > WORLD_PACKED_MAX) return false;
+    int used = 0;
+    for (int i = 0; i < WORLD_ACTIVE_CHUNKS; i++) {
+        const WorldChunk* c = &world->chunks[i];
+        if (!c->used) continue;
+        used++;
+        for (int w = 0; w < c->wall_count; w++) {
+            const WorldWall* wall = &c->walls[w];
+            Point p = { c->cx * WORLD_CHUNK_SIZE + wall->x, c->cy * WORLD_CHUNK_SIZE + wall->y };
+            if (game_world_collision_cause(world, p) == GAME_COLLISION_NONE) return false;
+        }
+    }
+    return used == world->chunk_count;
+}
+
+//==============================================================
+// [ 主程式 ]
+//==============================================================
+int main(int argc, char** argv)
+{
+    long steps = 1000000, report = 0;
+    uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) steps = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "-r") == 0) report = atol(argv[i + 1]);
+        else if (strcmp(argv[i], "-s") == 0) seed = strtoull(argv[i + 1], NULL, 10);
+        else {
+            fprintf(stderr, "usage: %s [-n steps] [-r report_steps] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (steps < 1) steps = 1;
+    if (report < 1) report = steps / 10 > 0 ? steps / 10 : 1;
+
+    // 世界狀態與電腦玩家都是固定大小
+    static GameWorld world;
+    static WorldBot bot;
+    game_world_new(&world, seed);
+    bot.rng = seed;
+    next_leg(&bot, game_world_body_at(&world, 0));
+
+#ifdef BENCH_CAIRO
+    int width = (int)(WORLD_VIEW_WIDTH * 45.0), height = (int)(WORLD_VIEW_HEIGHT * 45.0);
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+    cairo_t* cr = cairo_create(surface);
+    GameDrawInfo info = { { false, false }, true, 0, false, NULL };
+#endif
+
+    printf("world state %zu bytes (chunk %dx%d, %d active chunks, %d packed records, length cap %d)\n",
+        sizeof(GameWorld), WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE, WORLD_ACTIVE_CHUNKS, WORLD_PACKED_MAX, WORLD_MAX_LENGTH);
+    printf("%9s %8s %8s %6s %9s %9s %9s %9s %6s %7s %9s %9s\n", "steps", "distance", "max", "length",
+        "step ns", "max ns", "draw us", "max us", "active", "packed", "restored", "dropped");
+
+    BenchWindow win = { 0 };
+    long deaths = 0;
+    bool ok = true;
+    for (long t = 1; t <= steps; t++) {
+        game_world_turn(&world, bot_decide(&bot, &world));
+
+        int64_t start = now_ns();
+        GameEvent ev = game_world_step(&world);
+        double ns = (double)(now_ns() - start);
+        win.steps++;
+        win.step_ns += ns;
+        if (ns > win.step_max_ns) win.step_max_ns = ns;
+
+#ifdef BENCH_CAIRO
+        if (t % DRAW_EVERY == 0) {
+            int64_t draw_start = now_ns();
+            game_draw_world(cr, &world, &info, width, height, 45.0);
+            cairo_surface_flush(surface);
+            double us = (double)(now_ns() - draw_start) / 1000.0;
+            win.draws++;
+            win.draw_us += us;
+            if (us > win.draw_max_us) win.draw_max_us = us;
+        }
+#endif
+
+        if (ev == GAME_EVENT_DIED) {
+            deaths++;
+            game_world_new(&world, seed + (uint64_t)deaths);
+            next_leg(&bot, game_world_body_at(&world, 0));
+        }
+
+        if (t % report == 0 || t == steps) {
+            if (!check_world(&world)) {
+                printf("world invariant broken at step %ld\n", t);
+                ok = false;
+            }
+            printf("%9ld %8d %8d %6d %9.0f %9.0f %9.1f %9.1f %6d %7d %9ld %9ld\n", t,
+                game_world_distance(&world), world.stats.max_distance, world.length,
+                win.step_ns / (double)win.steps, win.step_max_ns,
+                win.draws ? win.draw_us / (double)win.draws : 0.0, win.draw_max_us,
+                world.chunk_count, world.packed_count, world.stats.restored, world.stats.dropped);
+            memset(&win, 0, sizeof(win));
+        }
+    }
+
+#ifdef BENCH_CAIRO
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+#endif
+    game_world_write_stats(&world, stdout);
+    printf("deaths: %ld\n", deaths);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}